@@ -199,6 +199,7 @@ CTX.INPUT['common'] = """
  UndoLog.cpp
  NValue.cpp
  MMAPMemoryManager.cpp
+ BlockAllocator.cpp
  RecoveryProtoMessage.cpp
  RecoveryProtoMessageBuilder.cpp
  DefaultTupleSerializer.cpp
@@ -212,9 +213,13 @@ CTX.INPUT['execution'] = """
 
 CTX.INPUT['executors'] = """
  abstractexecutor.cpp
+ columnarscanfilter.cpp
+ compiledpredicate.cpp
  deleteexecutor.cpp
  distinctexecutor.cpp
+ executorinput.cpp
  executorutil.cpp
+ hashjoinexecutor.cpp
  indexscanexecutor.cpp
  insertexecutor.cpp
  limitexecutor.cpp
@@ -222,16 +227,20 @@ CTX.INPUT['executors'] = """
  nestloopexecutor.cpp
  nestloopindexexecutor.cpp
  orderbyexecutor.cpp
+ parallelaggregation.cpp
  projectionexecutor.cpp
  receiveexecutor.cpp
  sendexecutor.cpp
  seqscanexecutor.cpp
+ typedhashaggregator.cpp
+ tuplehashset.cpp
  unionexecutor.cpp
  updateexecutor.cpp
 """
 
 CTX.INPUT['expressions'] = """
  abstractexpression.cpp
+ expressionprogram.cpp
  expressionutil.cpp
  tupleaddressexpression.cpp
 """
@@ -244,6 +253,7 @@ CTX.INPUT['plannodes'] = """
  aggregatenode.cpp
  deletenode.cpp
  distinctnode.cpp
+ hashjoinnode.cpp
  indexscannode.cpp
  insertnode.cpp
  limitnode.cpp
@@ -270,6 +280,7 @@ CTX.INPUT['indexes'] = """
 """
 
 CTX.INPUT['storage'] = """
+ ColumnarBlockStore.cpp
  constraintutil.cpp
  CopyOnWriteContext.cpp
  CopyOnWriteIterator.cpp
@@ -341,13 +352,26 @@ CTX.TESTS['common'] = """
  nvalue_test
  tupleschema_test
  tabletuple_test
+ block_allocator_test
 """
 
 CTX.TESTS['execution'] = """
  engine_test
 """
 
+CTX.TESTS['executors'] = """
+ compiled_predicate_test
+ hash_aggregate_test
+ hash_join_test
+ nestloopindex_test
+ order_by_test
+ parallel_aggregate_test
+ pipeline_test
+ set_operations_test
+"""
+
 CTX.TESTS['expressions'] = """
+ expression_program_test
  expression_test
 """
 
@@ -357,9 +381,15 @@ CTX.TESTS['indexes'] = """
  index_multikey_test
  index_scripted_test
  index_test
+ ints_btree_test
+ ints_hashtable_test
+ art_index_test
+ covering_index_test
 """
 
 CTX.TESTS['storage'] = """
+ bulk_load_test
+ columnar_scan_test
  CopyOnWriteTest
  constraint_test
  filter_test
@@ -368,6 +398,7 @@ CTX.TESTS['storage'] = """
  serialize_test
  StreamedTable_test
  table_and_indexes_test
+ table_compaction_test
  table_test
  tabletuple_export_test
  TupleStreamWrapper_test
@@ -383,6 +414,13 @@ CTX.TESTS['storage'] = """
 if CTX.STORAGE_MMAP:
     CTX.CPPFLAGS += " -DSTORAGE_MMAP"
 
+###############################################################################
+# STORAGE HUGE PAGES
+###############################################################################
+
+if CTX.STORAGE_HUGEPAGES:
+    CTX.CPPFLAGS += " -DSTORAGE_HUGEPAGES"
+
 ###############################################################################
 # ARIES
 ###############################################################################
@@ -409,11 +447,15 @@ if CTX.ANTICACHE_BUILD:
     if CTX.ANTICACHE_COUNTER:
         CTX.CPPFLAGS += " -DANTICACHE_COUNTER"
 
-    if CTX.ANTICACHE_TIMESTAMPS:
-        CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS"
+    # CLOCK replaces both the LRU chain and the timestamps
+    if CTX.ANTICACHE_CLOCK:
+        CTX.CPPFLAGS += " -DANTICACHE_CLOCK"
+    else:
+        if CTX.ANTICACHE_TIMESTAMPS:
+            CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS"
 
-    if CTX.ANTICACHE_TIMESTAMPS_PRIME:
-        CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS_PRIME"
+        if CTX.ANTICACHE_TIMESTAMPS_PRIME:
+            CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS_PRIME"
 
     # Bring in berkeleydb library
     CTX.SYSTEM_DIRS.append(os.path.join(CTX.OUTPUT_PREFIX, 'berkeleydb'))
@@ -428,9 +470,13 @@ if CTX.ANTICACHE_BUILD:
         FullBackingStoreException.cpp
         AntiCacheStats.cpp
         AntiCacheDB.cpp
+        AntiCacheWriteQueue.cpp
+        AntiCacheCompressor.cpp
         BerkeleyAntiCacheDB.cpp
         NVMAntiCacheDB.cpp
         AllocatorNVMAntiCacheDB.cpp
+        LogAntiCacheDB.cpp
+        AntiCacheKeyFilter.cpp
         AntiCacheEvictionManager.cpp
         EvictionIterator.cpp
         EvictedTable.cpp
@@ -441,6 +487,9 @@ if CTX.ANTICACHE_BUILD:
         anticachedb_test
         berkeleydb_test
         anticache_eviction_manager_test
+        anticache_write_queue_test
+        anticache_compressor_test
+        anticache_key_filter_test
     """
 
 ###############################################################################
@@ -41,6 +41,7 @@ class BuildContext:
         self.LOG_LEVEL = "DEBUG"
         self.VOLT_LOG_LEVEL = None
         self.STORAGE_MMAP = False
+        self.STORAGE_HUGEPAGES = False
         self.ANTICACHE_BUILD = True
         self.ANTICACHE_REVERSIBLE_LRU = True 
         self.ANTICACHE_NVM = False
@@ -49,6 +50,7 @@ class BuildContext:
         self.ANTICACHE_COUNTER = False
         self.ANTICACHE_TIMESTAMPS = True
         self.ANTICACHE_TIMESTAMPS_PRIME = True
+        self.ANTICACHE_CLOCK = False
 
         for arg in [x.strip().upper() for x in args]:
             if arg in ["DEBUG", "RELEASE", "MEMCHECK", "MEMCHECK_NOFREELIST"]:
@@ -66,6 +68,9 @@ class BuildContext:
             if arg.startswith("STORAGE_MMAP_SYNC_FREQUENCY="):
                 parts = arg.split("=")
                 if len(parts) > 1 and not (parts[1].startswith("${")): self.STORAGE_MMAP_SYNC_FREQUENCY = long(parts[1])
+            if arg.startswith("STORAGE_HUGEPAGES="):
+                parts = arg.split("=")
+                if len(parts) > 1 and not (parts[1].startswith("${")): self.STORAGE_HUGEPAGES = (parts[1] == "TRUE")
             if arg.startswith("ARIES="):
                 parts = arg.split("=")
                 if len(parts) > 1 and not (parts[1].startswith("${")): self.ARIES = bool(parts[1])
@@ -100,6 +105,10 @@ class BuildContext:
                 parts = arg.split("=")
                 if len(parts) > 1 and not parts[1].startswith("${"):
                     self.ANTICACHE_TIMESTAMPS_PRIME = bool(parts[1])
+            if arg.startswith("ANTICACHE_CLOCK="):
+                parts = arg.split("=")
+                if len(parts) > 1 and not parts[1].startswith("${"):
+                    self.ANTICACHE_CLOCK = (parts[1] == "TRUE")
                 
             if arg.startswith("LOG_LEVEL="):
                 parts = arg.split("=")
@@ -49,6 +49,8 @@ AllocatorNVMAntiCacheDB::AllocatorNVMAntiCacheDB(ExecutorContext *ctx, std::stri
 }
 
 AllocatorNVMAntiCacheDB::~AllocatorNVMAntiCacheDB() {
+    // write out the queued blocks first
+    setAsyncWrites(0);
     //shutdownDB();
 }
 
@@ -0,0 +1,533 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/AntiCacheCompressor.h"
+#include "common/debuglog.h"
+#include "common/FatalException.hpp"
+#include <algorithm>
+#include <string.h>
+#include <time.h>
+
+using namespace std;
+
+namespace voltdb {
+
+namespace {
+
+// no match starts in the last MF_LIMIT bytes of a block, and none runs
+// into the last LAST_LITERALS bytes
+const long MF_LIMIT = 12;
+const long LAST_LITERALS = 5;
+const int32_t NO_POSITION = INT32_MIN;
+
+// substrings counted by the dictionary trainer, and the segments it picks
+const long TRAIN_GRAM = 8;
+const long TRAIN_SEGMENT = 64;
+const int TRAIN_HASH_LOG = 18;
+
+inline uint32_t read32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hashPrefix(uint32_t prefix) {
+    return (prefix * 2654435761U) >> (32 - LZAntiCacheCodec::HASH_LOG);
+}
+
+inline uint32_t hashGram(const char* p) {
+    return (uint32_t)((read64(p) * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - TRAIN_HASH_LOG));
+}
+
+inline char* writeLength(char* op, long length) {
+    while (length >= 255) {
+        *op++ = (char)0xFF;
+        length -= 255;
+    }
+    *op++ = (char)length;
+    return op;
+}
+
+inline bool readLength(const unsigned char* &ip, const unsigned char* iend, long &length) {
+    unsigned char b;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+inline int64_t threadCpuMicros() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+struct TrainCandidate {
+    uint64_t score;
+    const char* segment;
+};
+
+inline bool betterCandidate(const TrainCandidate &a, const TrainCandidate &b) {
+    return (a.score > b.score);
+}
+
+/*
+ * Sum up the counts of the substrings of a segment that occur at least
+ * minFreq times, and count those substrings in repeated
+ */
+inline uint64_t segmentScore(const char* segment, const std::vector<uint32_t> &freq,
+                             uint32_t minFreq, long &repeated) {
+    uint64_t score = 0;
+    repeated = 0;
+    for (long p = 0; p + TRAIN_GRAM <= TRAIN_SEGMENT; p++) {
+        const uint32_t count = freq[hashGram(segment + p)];
+        if (count >= minFreq) {
+            score += count;
+            repeated++;
+        }
+    }
+    return score;
+}
+
+}
+
+// -----------------------------------------------------------------
+// LZAntiCacheCodec
+// -----------------------------------------------------------------
+
+LZAntiCacheCodec::LZAntiCacheCodec() :
+    m_hashTable(1 << HASH_LOG, NO_POSITION) {
+}
+
+long LZAntiCacheCodec::maxCompressedSize(long size) const {
+    return size + size / 255 + 16;
+}
+
+long LZAntiCacheCodec::compress(const char* src, long size, char* dst,
+                                const char* dict, long dictSize) {
+    if (dictSize > MAX_OFFSET) {
+        dict += dictSize - MAX_OFFSET;
+        dictSize = MAX_OFFSET;
+    }
+    const char* dictEnd = dict + dictSize;
+
+    // positions in the dictionary are negative, counting back from the block
+    std::fill(m_hashTable.begin(), m_hashTable.end(), NO_POSITION);
+    for (long p = 0; p + MIN_MATCH <= dictSize; p++) {
+        m_hashTable[hashPrefix(read32(dict + p))] = (int32_t)(p - dictSize);
+    }
+
+    char* op = dst;
+    long anchor = 0;
+    long ip = 0;
+    const long matchLimit = size - LAST_LITERALS;
+    const long searchLimit = size - MF_LIMIT;
+    while (ip < searchLimit) {
+        const uint32_t prefix = read32(src + ip);
+        const uint32_t h = hashPrefix(prefix);
+        const long ref = m_hashTable[h];
+        m_hashTable[h] = (int32_t)ip;
+        if (ref == NO_POSITION || ip - ref > MAX_OFFSET ||
+                read32(ref < 0 ? dictEnd + ref : src + ref) != prefix) {
+            // skip ahead faster the longer nothing matches
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        // extend the match forwards, first through the dictionary
+        long match = ref + MIN_MATCH;
+        long cur = ip + MIN_MATCH;
+        while (match < 0 && cur < matchLimit && dictEnd[match] == src[cur]) {
+            match++;
+            cur++;
+        }
+        if (match >= 0) {
+            while (cur < matchLimit) {
+                if (cur + 8 <= matchLimit) {
+                    const uint64_t diff = read64(src + match) ^ read64(src + cur);
+                    if (diff == 0) {
+                        match += 8;
+                        cur += 8;
+                        continue;
+                    }
+                    // the first differing byte (little-endian)
+                    cur += __builtin_ctzll(diff) >> 3;
+                    break;
+                }
+                if (src[match] != src[cur]) {
+                    break;
+                }
+                match++;
+                cur++;
+            }
+        }
+
+        // and backwards over the pending literals
+        long start = ip;
+        long back = ref;
+        while (start > anchor && back > -dictSize &&
+                (back > 0 ? src[back - 1] : dictEnd[back - 1]) == src[start - 1]) {
+            start--;
+            back--;
+        }
+
+        const long literals = start - anchor;
+        const long extra = cur - start - MIN_MATCH;
+        const long offset = start - back;
+        char* token = op++;
+        *token = (char)(((literals >= 15 ? 15 : literals) << 4) | (extra >= 15 ? 15 : extra));
+        if (literals >= 15) {
+            op = writeLength(op, literals - 15);
+        }
+        memcpy(op, src + anchor, literals);
+        op += literals;
+        *op++ = (char)(offset & 0xFF);
+        *op++ = (char)(offset >> 8);
+        if (extra >= 15) {
+            op = writeLength(op, extra - 15);
+        }
+
+        // index a position inside the match as well
+        m_hashTable[hashPrefix(read32(src + cur - 2))] = (int32_t)(cur - 2);
+        ip = cur;
+        anchor = cur;
+    } // WHILE
+
+    // the rest of the block goes out as literals
+    const long literals = size - anchor;
+    *op++ = (char)((literals >= 15 ? 15 : literals) << 4);
+    if (literals >= 15) {
+        op = writeLength(op, literals - 15);
+    }
+    memcpy(op, src + anchor, literals);
+    op += literals;
+    return (long)(op - dst);
+}
+
+bool LZAntiCacheCodec::decompress(const char* src, long size, char* dst, long rawSize,
+                                  const char* dict, long dictSize) {
+    if (dictSize > MAX_OFFSET) {
+        dict += dictSize - MAX_OFFSET;
+        dictSize = MAX_OFFSET;
+    }
+
+    const unsigned char* ip = reinterpret_cast<const unsigned char*>(src);
+    const unsigned char* const iend = ip + size;
+    char* op = dst;
+    char* const oend = dst + rawSize;
+    while (ip < iend) {
+        const unsigned char token = *ip++;
+        long literals = token >> 4;
+        if (literals == 15 && !readLength(ip, iend, literals)) {
+            return false;
+        }
+        if (literals > iend - ip || literals > oend - op) {
+            return false;
+        }
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        const long offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        long length = token & 15;
+        if (length == 15 && !readLength(ip, iend, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (offset == 0 || length > oend - op) {
+            return false;
+        }
+
+        const char* match = op - offset;
+        if (offset > op - dst) {
+            // the match starts in the dictionary and may run on into the block
+            const long back = offset - (op - dst);
+            if (back > dictSize) {
+                return false;
+            }
+            const long fromDict = (back < length ? back : length);
+            memcpy(op, dict + dictSize - back, fromDict);
+            op += fromDict;
+            length -= fromDict;
+            match = dst;
+        }
+        if (op - match >= length) {
+            memcpy(op, match, length);
+            op += length;
+        } else {
+            // overlapping match, which repeats the last bytes
+            while (length-- > 0) {
+                *op++ = *match++;
+            }
+        }
+    } // WHILE
+    return (op == oend);
+}
+
+// -----------------------------------------------------------------
+// AntiCacheCompressor
+// -----------------------------------------------------------------
+
+AntiCacheCompressor::AntiCacheCompressor() :
+    m_type(ANTICACHE_CODEC_NONE),
+    m_dictionaryBlocks(0) {
+}
+
+AntiCacheCompressor::~AntiCacheCompressor() {
+    std::map<AntiCacheCodecType, AntiCacheCodec*>::iterator itr;
+    for (itr = m_codecs.begin(); itr != m_codecs.end(); ++itr) {
+        delete itr->second;
+    }
+}
+
+AntiCacheCodec* AntiCacheCompressor::createCodec(AntiCacheCodecType type) {
+    switch (type) {
+        case ANTICACHE_CODEC_LZ:
+            return new LZAntiCacheCodec();
+        default:
+            return NULL;
+    }
+}
+
+AntiCacheCodec* AntiCacheCompressor::getCodec(AntiCacheCodecType type) {
+    std::map<AntiCacheCodecType, AntiCacheCodec*>::iterator itr = m_codecs.find(type);
+    if (itr != m_codecs.end()) {
+        return itr->second;
+    }
+    AntiCacheCodec* codec = createCodec(type);
+    if (codec != NULL) {
+        m_codecs[type] = codec;
+    }
+    return codec;
+}
+
+void AntiCacheCompressor::setCodec(AntiCacheCodecType type, int dictionaryBlocks) {
+    if (type != ANTICACHE_CODEC_NONE && getCodec(type) == NULL) {
+        throwFatalException("Invalid AntiCacheCodecType: %d", (int)type);
+    }
+    m_type = type;
+    m_dictionaryBlocks = (dictionaryBlocks > 0 ? dictionaryBlocks : 0);
+}
+
+bool AntiCacheCompressor::isPacked(const char* data, long size) {
+    return (size >= (long)sizeof(PackedBlockHeader) &&
+            (uint8_t)data[0] == PACKED_MAGIC);
+}
+
+const std::string* AntiCacheCompressor::getDictionary(const std::string &tableName) const {
+    std::map<std::string, TableDictionary>::const_iterator itr = m_tables.find(tableName);
+    if (itr == m_tables.end() || itr->second.id < 0) {
+        return NULL;
+    }
+    return &m_dictionaries[itr->second.id];
+}
+
+/*
+ * Add the block to the samples of its table until the dictionary is trained.
+ * Returns the table's dictionary, or NULL while it is still being sampled.
+ */
+const std::string* AntiCacheCompressor::sampleBlock(const std::string &tableName,
+                                                    const char* data, long size) {
+    std::map<std::string, TableDictionary>::iterator itr = m_tables.find(tableName);
+    if (itr == m_tables.end()) {
+        TableDictionary table;
+        table.id = -1;
+        itr = m_tables.insert(std::pair<std::string, TableDictionary>(tableName, table)).first;
+    }
+    TableDictionary &table = itr->second;
+    if (table.id < 0) {
+        table.samples.push_back(std::string(data, (size < SAMPLE_SIZE ? size : SAMPLE_SIZE)));
+        if ((int)table.samples.size() < m_dictionaryBlocks) {
+            return NULL;
+        }
+        m_dictionaries.push_back(trainDictionary(table.samples, DICTIONARY_SIZE));
+        table.id = (int32_t)m_dictionaries.size() - 1;
+        std::vector<std::string>().swap(table.samples);
+        VOLT_DEBUG("Trained a %ld byte dictionary for %s",
+                   (long)m_dictionaries.back().size(), tableName.c_str());
+    }
+    return &m_dictionaries[table.id];
+}
+
+char* AntiCacheCompressor::pack(const std::string &tableName, const char* data,
+                                long &size, int64_t &cpuMicros) {
+    AntiCacheCodec* codec = (m_type == ANTICACHE_CODEC_NONE ? NULL : getCodec(m_type));
+    if (codec == NULL) {
+        char* copy = new char[size];
+        memcpy(copy, data, size);
+        return copy;
+    }
+
+    const int64_t start = threadCpuMicros();
+    const std::string* dictionary = NULL;
+    if (m_dictionaryBlocks > 0) {
+        dictionary = sampleBlock(tableName, data, size);
+    }
+
+    const long headerSize = (long)sizeof(PackedBlockHeader);
+    char* packed = new char[headerSize + codec->maxCompressedSize(size)];
+    const long packedSize = codec->compress(data, size, packed + headerSize,
+                                            (dictionary == NULL ? NULL : dictionary->data()),
+                                            (dictionary == NULL ? 0 : (long)dictionary->size()));
+    char* result;
+    if (headerSize + packedSize < size) {
+        PackedBlockHeader header;
+        header.magic = PACKED_MAGIC;
+        header.codec = (uint8_t)m_type;
+        header.reserved = 0;
+        header.dictionaryId = (dictionary == NULL ? 0 :
+                               (uint32_t)(dictionary - &m_dictionaries[0]) + 1);
+        header.rawSize = (uint32_t)size;
+        header.packedSize = (uint32_t)packedSize;
+        memcpy(packed, &header, sizeof(header));
+        result = packed;
+        size = headerSize + packedSize;
+    } else {
+        // not worth it, keep the block as it is
+        delete [] packed;
+        result = new char[size];
+        memcpy(result, data, size);
+    }
+    cpuMicros += threadCpuMicros() - start;
+    return result;
+}
+
+char* AntiCacheCompressor::unpack(const char* data, long &size, int64_t &cpuMicros) {
+    if (!isPacked(data, size)) {
+        char* copy = new char[size];
+        memcpy(copy, data, size);
+        return copy;
+    }
+
+    const int64_t start = threadCpuMicros();
+    PackedBlockHeader header;
+    memcpy(&header, data, sizeof(header));
+    const long headerSize = (long)sizeof(PackedBlockHeader);
+    // some databases hand back the whole slot the block was stored in
+    if (headerSize + (long)header.packedSize > size) {
+        throwFatalException("Compressed anti-cache block of %ld bytes is truncated", size);
+    }
+    const std::string* dictionary = NULL;
+    if (header.dictionaryId != 0) {
+        if (header.dictionaryId > m_dictionaries.size()) {
+            throwFatalException("Unknown anti-cache dictionary %u", header.dictionaryId);
+        }
+        dictionary = &m_dictionaries[header.dictionaryId - 1];
+    }
+    AntiCacheCodec* codec = getCodec((AntiCacheCodecType)header.codec);
+    if (codec == NULL) {
+        throwFatalException("Invalid AntiCacheCodecType: %d", (int)header.codec);
+    }
+
+    char* raw = new char[header.rawSize];
+    if (!codec->decompress(data + headerSize, header.packedSize, raw, header.rawSize,
+                           (dictionary == NULL ? NULL : dictionary->data()),
+                           (dictionary == NULL ? 0 : (long)dictionary->size()))) {
+        delete [] raw;
+        throwFatalException("Corrupt compressed anti-cache block of %ld bytes", size);
+    }
+    size = header.rawSize;
+    cpuMicros += threadCpuMicros() - start;
+    return raw;
+}
+
+std::string AntiCacheCompressor::trainDictionary(const std::vector<std::string> &samples,
+                                                 long maxSize) {
+    // count every substring of TRAIN_GRAM bytes (well, its hash)
+    std::vector<uint32_t> freq(1 << TRAIN_HASH_LOG, 0);
+    long grams = 0;
+    for (int i = 0; i < (int)samples.size(); i++) {
+        const char* data = samples[i].data();
+        for (long p = 0; p + TRAIN_GRAM <= (long)samples[i].size(); p++) {
+            freq[hashGram(data + p)]++;
+            grams++;
+        }
+    }
+    // a substring has to show up more often than hash collisions alone
+    // would make it
+    const uint32_t minFreq = (uint32_t)(2 + (grams >> TRAIN_HASH_LOG));
+
+    // score the overlapping segments of the samples by how common their
+    // substrings are. A segment that is mostly unique is of no use.
+    std::vector<TrainCandidate> candidates;
+    const long half = (TRAIN_SEGMENT - TRAIN_GRAM + 1) / 2;
+    long repeated;
+    for (int i = 0; i < (int)samples.size(); i++) {
+        const char* data = samples[i].data();
+        for (long p = 0; p + TRAIN_SEGMENT <= (long)samples[i].size(); p += TRAIN_SEGMENT / 2) {
+            TrainCandidate candidate;
+            candidate.score = segmentScore(data + p, freq, minFreq, repeated);
+            candidate.segment = data + p;
+            if (repeated >= half) {
+                candidates.push_back(candidate);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), betterCandidate);
+
+    // take the best segments, skipping the ones whose substrings are mostly
+    // in the dictionary already
+    std::vector<const char*> chosen;
+    long total = 0;
+    for (int i = 0; i < (int)candidates.size() && total + TRAIN_SEGMENT <= maxSize; i++) {
+        const char* segment = candidates[i].segment;
+        const uint64_t score = segmentScore(segment, freq, minFreq, repeated);
+        if (repeated < half || score * 2 < candidates[i].score) {
+            continue;
+        }
+        chosen.push_back(segment);
+        total += TRAIN_SEGMENT;
+        for (long p = 0; p + TRAIN_GRAM <= TRAIN_SEGMENT; p++) {
+            freq[hashGram(segment + p)] = 0;
+        }
+    } // FOR
+
+    // the best segments go last, closest to the block
+    std::string dictionary;
+    dictionary.reserve(total);
+    for (int i = (int)chosen.size() - 1; i >= 0; i--) {
+        dictionary.append(chosen[i], TRAIN_SEGMENT);
+    }
+    return dictionary;
+}
+
+}
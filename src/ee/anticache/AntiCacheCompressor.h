@@ -0,0 +1,204 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREANTICACHECOMPRESSOR_H
+#define HSTOREANTICACHECOMPRESSOR_H
+
+#include "common/types.h"
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace voltdb {
+
+/**
+ * A compression algorithm for evicted blocks. A dictionary is a buffer of
+ * bytes that the codec may refer back to as if it came right before the
+ * block, so the same dictionary has to be given to both calls.
+ */
+class AntiCacheCodec {
+    public:
+        virtual ~AntiCacheCodec() {};
+
+        virtual AntiCacheCodecType getType() const = 0;
+
+        /**
+         * Return the largest size compress() can produce for a block of the
+         * given size
+         */
+        virtual long maxCompressedSize(long size) const = 0;
+
+        /**
+         * Compress a block into dst, which has room for maxCompressedSize()
+         * bytes. Returns the compressed size.
+         */
+        virtual long compress(const char* src, long size, char* dst,
+                              const char* dict, long dictSize) = 0;
+
+        /**
+         * Decompress a block into dst, which has room for exactly rawSize
+         * bytes. Returns false if the block is corrupt.
+         */
+        virtual bool decompress(const char* src, long size, char* dst, long rawSize,
+                                const char* dict, long dictSize) = 0;
+};
+
+/**
+ * LZ77 with LZ4-style sequences: a token with the literal and match lengths,
+ * the literals, and a two byte offset back into the block (or dictionary).
+ * Matches are found through a single hash table of four byte prefixes, so
+ * compression runs at a few hundred MB/s and decompression is mostly memcpy.
+ */
+class LZAntiCacheCodec : public AntiCacheCodec {
+    public:
+        LZAntiCacheCodec();
+
+        AntiCacheCodecType getType() const {
+            return ANTICACHE_CODEC_LZ;
+        }
+
+        long maxCompressedSize(long size) const;
+
+        long compress(const char* src, long size, char* dst,
+                      const char* dict, long dictSize);
+
+        bool decompress(const char* src, long size, char* dst, long rawSize,
+                        const char* dict, long dictSize);
+
+        static const int MIN_MATCH = 4;
+        static const int MAX_OFFSET = 65535;
+        static const int HASH_LOG = 14;
+
+    private:
+        std::vector<int32_t> m_hashTable;
+};
+
+/**
+ * Compresses the blocks of the eviction manager with a pluggable codec.
+ * A packed block starts with a header that names its codec and dictionary,
+ * so blocks stay readable after the codec is changed or turned off. Since a
+ * serialized block starts with its (big-endian, small) number of tables,
+ * its first byte is never the header's magic.
+ *
+ * With dictionaries enabled, the first blocks evicted from every table are
+ * sampled and a dictionary of their most common substrings is trained from
+ * them. Later blocks of the table are compressed against that dictionary,
+ * which pays off for tables with many small, similar tuples.
+ */
+class AntiCacheCompressor {
+    public:
+        AntiCacheCompressor();
+        ~AntiCacheCompressor();
+
+        /**
+         * Compress the blocks evicted from now on with the given codec. With
+         * dictionaryBlocks > 0, a dictionary is trained for every table from
+         * its first dictionaryBlocks blocks.
+         */
+        void setCodec(AntiCacheCodecType type, int dictionaryBlocks);
+
+        inline AntiCacheCodecType getCodecType() const {
+            return m_type;
+        }
+
+        inline int getDictionaryBlocks() const {
+            return m_dictionaryBlocks;
+        }
+
+        /**
+         * Return a copy (allocated with new[]) of a serialized block of the
+         * given table, compressed if that makes it smaller. Updates size, and
+         * adds the thread CPU time spent in the codec to cpuMicros.
+         */
+        char* pack(const std::string &tableName, const char* data, long &size, int64_t &cpuMicros);
+
+        /**
+         * Return a copy (allocated with new[]) of a block returned by pack(),
+         * decompressed. Updates size, and adds the thread CPU time spent in
+         * the codec to cpuMicros.
+         */
+        char* unpack(const char* data, long &size, int64_t &cpuMicros);
+
+        /**
+         * Return whether the block was compressed by pack()
+         */
+        static bool isPacked(const char* data, long size);
+
+        /**
+         * Return the trained dictionary of a table, or NULL if it has none
+         */
+        const std::string* getDictionary(const std::string &tableName) const;
+
+        /**
+         * Build a dictionary of at most maxSize bytes out of the segments of
+         * the samples that share the most substrings with the others
+         */
+        static std::string trainDictionary(const std::vector<std::string> &samples, long maxSize);
+
+        static AntiCacheCodec* createCodec(AntiCacheCodecType type);
+
+        static const int DICTIONARY_SIZE = 32 * 1024;
+
+        /**
+         * Bytes sampled from the start of each block for the dictionary
+         */
+        static const int SAMPLE_SIZE = 128 * 1024;
+
+    private:
+        struct PackedBlockHeader {
+            uint8_t magic;
+            uint8_t codec;
+            uint16_t reserved;
+            // zero without a dictionary, otherwise its index plus one
+            uint32_t dictionaryId;
+            uint32_t rawSize;
+            uint32_t packedSize;
+        };
+
+        struct TableDictionary {
+            // index into m_dictionaries, -1 until trained
+            int32_t id;
+            std::vector<std::string> samples;
+        };
+
+        static const uint8_t PACKED_MAGIC = 0xAC;
+
+        AntiCacheCodec* getCodec(AntiCacheCodecType type);
+        const std::string* sampleBlock(const std::string &tableName, const char* data, long size);
+
+        AntiCacheCodecType m_type;
+        int m_dictionaryBlocks;
+        std::map<AntiCacheCodecType, AntiCacheCodec*> m_codecs;
+
+        std::map<std::string, TableDictionary> m_tables;
+        // dictionaries are never dropped, since blocks may still need them
+        std::vector<std::string> m_dictionaries;
+};
+
+}
+
+#endif
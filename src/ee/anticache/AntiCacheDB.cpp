@@ -26,6 +26,7 @@
 #include "anticache/AntiCacheDB.h"
 #include "anticache/UnknownBlockAccessException.h"
 #include "anticache/AntiCacheStats.h"
+#include "anticache/AntiCacheWriteQueue.h"
 #include "common/debuglog.h"
 #include "common/FatalException.hpp"
 #include "common/executorcontext.hpp"
@@ -55,7 +56,9 @@ AntiCacheDB::AntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSiz
     m_nextBlockId(0),
     m_blockSize(blockSize),
     m_totalBlocks(0),
-    m_block_merge(1)
+    m_block_merge(1),
+    m_writeQueue(NULL),
+    m_queuedBlocks(0)
     { 
         // MJG: TODO: HACK: Come up with a better way to make a maxsize when one isn't given
         if (maxSize == -1) {
@@ -67,6 +70,10 @@ AntiCacheDB::AntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSiz
         m_blocksEvicted = 0;
         m_bytesUnevicted = 0;
         m_blocksUnevicted = 0;
+        m_bytesUncompressed = 0;
+        m_bytesCompressed = 0;
+        m_compressMicros = 0;
+        m_decompressMicros = 0;
 
         m_stats = new AntiCacheStats(NULL, this);
         if (ctx != NULL)
@@ -81,6 +88,8 @@ AntiCacheDB::AntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSiz
 }
 
 AntiCacheDB::~AntiCacheDB() {
+    // the subclass has to stop the writer while it can still write
+    assert(m_writeQueue == NULL);
     delete m_stats;
     //tupleInBlock.clear();
     //evictedTupleInBlock.clear();
@@ -136,6 +145,88 @@ uint32_t AntiCacheDB::popBlockLRU() {
     return blockId;
 }
 
+void AntiCacheDB::submitBlock(const std::string tableName,
+                              uint32_t blockId,
+                              const int tupleCount,
+                              char* data,
+                              const long size, const int evictedBytes) {
+    if (m_writeQueue != NULL) {
+        m_writeQueue->push(tableName, blockId, tupleCount, data, size, evictedBytes);
+        return;
+    }
+    try {
+        writeBlock(tableName, blockId, tupleCount, data, size, evictedBytes);
+    } catch (...) {
+        delete [] data;
+        throw;
+    }
+    delete [] data;
+}
+
+AntiCacheBlock* AntiCacheDB::fetchBlock(uint32_t blockId, bool isMigrate) {
+    if (m_writeQueue != NULL) {
+        return m_writeQueue->read(blockId, isMigrate);
+    }
+    return readBlock(blockId, isMigrate);
+}
+
+void AntiCacheDB::readBlocks(const std::vector<uint32_t> &blockIds, bool isMigrate,
+                             std::vector<AntiCacheBlock*> &blocks) {
+    // fail before any block has been taken out of the database
+    for (int i = 0; i < (int)blockIds.size(); i++) {
+        if (!validateBlock(blockIds[i])) {
+            throw UnknownBlockAccessException(blockIds[i]);
+        }
+    }
+    for (int i = 0; i < (int)blockIds.size(); i++) {
+        blocks.push_back(readBlock(blockIds[i], isMigrate));
+    }
+}
+
+void AntiCacheDB::fetchBlocks(const std::vector<uint32_t> &blockIds, bool isMigrate,
+                              std::vector<AntiCacheBlock*> &blocks) {
+    if (m_writeQueue == NULL) {
+        readBlocks(blockIds, isMigrate, blocks);
+        return;
+    }
+    for (int i = 0; i < (int)blockIds.size(); i++) {
+        if (!m_writeQueue->contains(blockIds[i])) {
+            throw UnknownBlockAccessException(blockIds[i]);
+        }
+    }
+    for (int i = 0; i < (int)blockIds.size(); i++) {
+        blocks.push_back(m_writeQueue->read(blockIds[i], isMigrate));
+    }
+}
+
+bool AntiCacheDB::hasBlock(uint32_t blockId) {
+    if (m_writeQueue != NULL) {
+        return m_writeQueue->contains(blockId);
+    }
+    return validateBlock(blockId);
+}
+
+void AntiCacheDB::setAsyncWrites(int maxQueuedBlocks) {
+    if (m_writeQueue != NULL) {
+        if (m_writeQueue->getMaxBlocks() == maxQueuedBlocks) {
+            return;
+        }
+        delete m_writeQueue;
+        m_writeQueue = NULL;
+    }
+    if (maxQueuedBlocks > 0) {
+        VOLT_INFO("Writing anti-cache blocks of ACID %d in the background [maxQueuedBlocks=%d]",
+                  m_ACID, maxQueuedBlocks);
+        m_writeQueue = new AntiCacheWriteQueue(this, maxQueuedBlocks);
+    }
+}
+
+void AntiCacheDB::drainWrites() {
+    if (m_writeQueue != NULL) {
+        m_writeQueue->drain();
+    }
+}
+
 void AntiCacheDB::setStatsSource() {
     //m_stats = new AntiCacheStats(NULL, this);
 }
@@ -48,6 +48,7 @@ namespace voltdb {
 class ExecutorContext;
 class AntiCacheDB;
 class AntiCacheStats;
+class AntiCacheWriteQueue;
 
 /**
  * Wrapper class for an evicted block that has been read back in 
@@ -98,6 +99,7 @@ class AntiCacheBlock {
 }; // CLASS
 
 class AntiCacheDB {
+    friend class AntiCacheWriteQueue;
         
     public: 
        
@@ -117,6 +119,13 @@ class AntiCacheDB {
          */
         virtual AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate) = 0;
 
+        /**
+         * Read several (distinct) blocks at once, in the order they are
+         * given. Databases that can batch their reads override this.
+         */
+        virtual void readBlocks(const std::vector<uint32_t> &blockIds, bool isMigrate,
+                                std::vector<AntiCacheBlock*> &blocks);
+
         virtual bool validateBlock(uint32_t blockId) = 0;
 
 
@@ -124,6 +133,52 @@ class AntiCacheDB {
          * Flush the buffered blocks to disk.
          */
         virtual void flushBlocks() = 0;
+
+        /**
+         * Hand a block of serialized tuples over to the database. With
+         * asynchronous writes it is queued for the writer thread, otherwise
+         * it is written right away. The database owns the data (allocated
+         * with new[]) from now on.
+         */
+        void submitBlock(const std::string tableName,
+                         uint32_t blockId,
+                         const int tupleCount,
+                         char* data,
+                         const long size, const int evictedBytes);
+
+        /**
+         * readBlock() that also finds the blocks still waiting to be written
+         */
+        AntiCacheBlock* fetchBlock(uint32_t blockId, bool isMigrate);
+
+        /**
+         * readBlocks() that also finds the blocks still waiting to be written
+         */
+        void fetchBlocks(const std::vector<uint32_t> &blockIds, bool isMigrate,
+                         std::vector<AntiCacheBlock*> &blocks);
+
+        /**
+         * validateBlock() that also knows about the blocks still waiting to
+         * be written
+         */
+        bool hasBlock(uint32_t blockId);
+
+        /**
+         * Write the submitted blocks on a background thread, with at most
+         * maxQueuedBlocks of them waiting. Zero goes back to writing them
+         * synchronously once the queue has drained.
+         */
+        void setAsyncWrites(int maxQueuedBlocks);
+
+        /**
+         * Wait until every submitted block is written and flushed. Nothing
+         * else touches the database afterwards until the next submitBlock().
+         */
+        void drainWrites();
+
+        inline AntiCacheWriteQueue* getWriteQueue() const {
+            return m_writeQueue;
+        }
         
         virtual void setStatsSource();
 
@@ -163,10 +218,11 @@ class AntiCacheDB {
             return (int)(m_maxDBSize/m_blockSize);
         }
         /**
-         * Return the number of free (available) blocks
+         * Return the number of free (available) blocks, leaving room for the
+         * blocks that are still waiting to be written
          */
         inline int getFreeBlocks() {
-            return getMaxBlocks()-getNumBlocks();
+            return getMaxBlocks()-getNumBlocks()-m_queuedBlocks;
         }
         /**
          * Return the LRU block from the database. This *removes* the block
@@ -295,6 +351,36 @@ class AntiCacheDB {
             m_bytesUnevicted = 0;
         }
         
+        /*
+         * Account for a block of this database that went through the
+         * anti-cache codec: its size before and after, and the CPU time
+         */
+        inline void recordCompression(int64_t bytesUncompressed, int64_t bytesCompressed, int64_t micros) {
+            m_bytesUncompressed += bytesUncompressed;
+            m_bytesCompressed += bytesCompressed;
+            m_compressMicros += micros;
+        }
+
+        inline void recordDecompression(int64_t micros) {
+            m_decompressMicros += micros;
+        }
+
+        inline int64_t getBytesUncompressed() {
+            return m_bytesUncompressed;
+        }
+
+        inline int64_t getBytesCompressed() {
+            return m_bytesCompressed;
+        }
+
+        inline int64_t getCompressMicros() {
+            return m_compressMicros;
+        }
+
+        inline int64_t getDecompressMicros() {
+            return m_decompressMicros;
+        }
+
         /*
          * Set to block merge
          */
@@ -352,12 +438,22 @@ class AntiCacheDB {
         int32_t m_blocksEvicted;
         int64_t m_bytesUnevicted;
         int32_t m_blocksUnevicted;
+        int64_t m_bytesUncompressed;
+        int64_t m_bytesCompressed;
+        int64_t m_compressMicros;
+        int64_t m_decompressMicros;
 
         //std::map<uint32_t, int> tupleInBlock;
         //std::map <uint32_t, int> evictedTupleInBlock;
         //std::map <uint32_t, long> blockSize;
 
         voltdb::AntiCacheStats* m_stats;
+
+        /*
+         * Background writer, NULL if blocks are written synchronously
+         */
+        AntiCacheWriteQueue* m_writeQueue;
+        int m_queuedBlocks;
         
         /* we need to test whether a deque or list is better. If we push/pop more than we
          * remove, this is better. otherwise, let's use a list
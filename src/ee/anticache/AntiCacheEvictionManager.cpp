@@ -40,6 +40,7 @@
 #include "anticache/UnknownBlockAccessException.h"
 #include "anticache/FullBackingStoreException.h"
 #include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheKeyFilter.h"
 #include "anticache/BerkeleyAntiCacheDB.h"
 
 #include <string>
@@ -152,7 +153,7 @@ bool AntiCacheEvictionManager::updateUnevictedTuple(PersistentTable* table, Tabl
     if(table->getEvictedTable() == NULL || table->isBatchEvicted())  // no need to maintain chain for non-evictable tables or batch evicted tables
         return true;
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     int tuples_in_chain;
     int current_tuple_id = table->getTupleID(tuple->address()); // scan blocks for this tuple
     
@@ -183,9 +184,15 @@ bool AntiCacheEvictionManager::updateUnevictedTuple(PersistentTable* table, Tabl
     tuples_in_chain = table->getNumTuplesInEvictionChain(); 
     ++tuples_in_chain; 
     table->setNumTuplesInEvictionChain(tuples_in_chain); 
-#else
+#elif defined(ANTICACHE_TIMESTAMPS)
     // set timestamp to the coldest
     tuple->setColdTimeStamp();
+#else
+    // clear the reference bit, the clock hand takes it on its next pass
+    int current_tuple_id = table->getTupleID(tuple->address());
+    if (current_tuple_id < 0)
+        return false;
+    table->clearReferenced(current_tuple_id);
 #endif
     
     return true; 
@@ -197,7 +204,7 @@ bool AntiCacheEvictionManager::updateTuple(PersistentTable* table, TableTuple* t
         return true; 
 
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     int SAMPLE_RATE = 100; // aLRU sampling rate
 
     int tuples_in_chain;
@@ -268,16 +275,22 @@ bool AntiCacheEvictionManager::updateTuple(PersistentTable* table, TableTuple* t
     ++tuples_in_chain; 
 
     table->setNumTuplesInEvictionChain(tuples_in_chain);
-#else
+#elif defined(ANTICACHE_TIMESTAMPS)
     // set timestamp to the hotest
     TableTuple update_tuple(tuple->address(), table->m_schema);
     update_tuple.setTimeStamp();
+#else
+    // set the reference bit, the tuple itself is not written to
+    int update_tuple_id = table->getTupleID(tuple->address());
+    if (update_tuple_id < 0)
+        return false;
+    table->setReferenced(update_tuple_id);
 #endif
         
     return true; 
 }
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
 bool AntiCacheEvictionManager::removeTuple(PersistentTable* table, TableTuple* tuple) {
     int current_tuple_id = table->getTupleID(tuple->address());
     
@@ -570,6 +583,10 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
     evict_itr.reserve((int64_t)block_size * num_blocks);
 #endif
 
+    // Every block records the primary keys of its tuples, if there is one
+    bool record_keys = table->hasEvictedKeyFingerprints();
+    std::vector<uint32_t> fingerprints;
+
     for(int i = 0; i < num_blocks; i++)
     {
 
@@ -586,7 +603,7 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
                 if(!evict_itr.next(tuple))
                     break;
 
-                #ifndef ANTICACHE_TIMESTAMPS
+                #if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
                 // remove the tuple from the eviction chain
                 removeTuple(table, &tuple);
                 #endif
@@ -672,9 +689,13 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
                 _block_id,
                 num_tuples_evicted);
         int initSize = block.getSerializedSize();
+        fingerprints.clear();
 
+        // Leave room for the keys at the end of the block
         VOLT_DEBUG("Starting evictable tuple iterator for %s", table->name().c_str());
-        while (evict_itr.hasNext() && (block.getSerializedSize() + MAX_EVICTED_TUPLE_SIZE < block_size)) {
+        while (evict_itr.hasNext() &&
+               (block.getSerializedSize() + MAX_EVICTED_TUPLE_SIZE +
+                AntiCacheKeyFilter::serializedSize(num_tuples_evicted + 1) < block_size)) {
             if(!evict_itr.next(tuple))
                 break;
 
@@ -686,7 +707,7 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
 
             //current_tuple_start_position = out.position();
 
-            #ifndef ANTICACHE_TIMESTAMPS
+            #if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
             // remove the tuple from the eviction chain
             removeTuple(table, &tuple);
             #endif
@@ -715,6 +736,9 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
             table->setEntryToNewAddressForAllIndexes(&tuple, evicted_tuple_address, tuple.address());
 
             block.addTuple(tuple);
+            if (record_keys) {
+                fingerprints.push_back(table->getEvictedKeyFingerprint(tuple));
+            }
             //if (block.getSerializedSize() - initSize - (int32_t)ValuePeeker::peekInteger(evicted_tuple.getNValue(1)) > 1053)
             //    printf("BIG SIZE: %d\n", block.getSerializedSize() - initSize - (int32_t)ValuePeeker::peekInteger(evicted_tuple.getNValue(1)));
 
@@ -737,6 +761,12 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
             numTuples.push_back(num_tuples_evicted);
             block.writeHeader(numTuples);
             int64_t bytesWritten = block.getSerializedSize() - initSize;
+            if (record_keys) {
+                block.addKeyFingerprints(fingerprints);
+                table->getEvictedKeyFilter().addBlock(block_id, fingerprints);
+            } else {
+                table->getEvictedKeyFilter().addUnfilteredBlock(block_id);
+            }
             
             #ifdef VOLT_INFO_ENABLED
             VOLT_INFO("Evicted %d tuples / %d bytes.", num_tuples_evicted, block.getSerializedSize());
@@ -746,8 +776,7 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
 
             long blocksize = block.getSerializedSize();
 
-            char* blockdata = new char[blocksize];
-            memcpy(blockdata, block.getSerializedData(), blocksize);
+            char* blockdata = packBlock(table, antiCacheDB, block.getSerializedData(), blocksize);
             /*
             for (int i = 0; i < blocksize; i++) {
                 printf( "%x", blockdata[i]);
@@ -758,13 +787,13 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
             // block.flush();
             //  antiCacheDB->writeBlock(block);
             VOLT_DEBUG("about to write block %x to acid %d", _block_id, antiCacheDB->getACID());
-            antiCacheDB->writeBlock(table->name(),
-                                    _block_id,
-                                    num_tuples_evicted,
-                                    blockdata,
-                                    blocksize,
-                                    (int32_t)bytesWritten
-                                    );
+            antiCacheDB->submitBlock(table->name(),
+                                     _block_id,
+                                     num_tuples_evicted,
+                                     blockdata,
+                                     blocksize,
+                                     (int32_t)bytesWritten
+                                     );
             
             // MJG: We need to check whether we're reusing a blockID.
 
@@ -816,7 +845,8 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
 
     }  // FOR
 
-    if (needs_flush) {
+    // With asynchronous writes the writer thread flushes once it catches up
+    if (needs_flush && antiCacheDB->getWriteQueue() == NULL) {
         #ifdef VOLT_INFO_ENABLED
         boost::timer timer;
         #endif
@@ -994,7 +1024,7 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
             }
             parentTuples++;
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
             // remove the tuple from the eviction chain
             removeTuple(table, &tuple);
 #endif
@@ -1106,15 +1136,22 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
             //          antiCacheDB->writeBlock(block);
 
 
-            antiCacheDB->writeBlock(table->name(),
+            long blocksize = block.getSerializedSize();
+            char* blockdata = packBlock(table, antiCacheDB, block.getSerializedData(), blocksize);
+            antiCacheDB->submitBlock(table->name(),
                     _block_id,
                     num_tuples_evicted,
-                    block.getSerializedData(),
-                    block.getSerializedSize(),
+                    blockdata,
+                    blocksize,
                     (int32_t)(parentBytes + childBytes)
                     );
             needs_flush = true;
 
+            // The keys of the tuples in a block with more than one table
+            // are not recorded
+            table->getEvictedKeyFilter().addUnfilteredBlock(block_id);
+            childTable->getEvictedKeyFilter().addUnfilteredBlock(block_id);
+
 
             // store pointer to AntiCacheDB associated with this block
             //m_db_lookup_table.insert(std::pair<uint32_t, AntiCacheDB*>(block_id, antiCacheDB));
@@ -1165,7 +1202,8 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
 
     }  // FOR
 
-    if (needs_flush) {
+    // With asynchronous writes the writer thread flushes once it catches up
+    if (needs_flush && antiCacheDB->getWriteQueue() == NULL) {
         //     #ifdef VOLT_INFO_ENABLED
         //   boost::timer timer;
         //    #endif
@@ -1264,7 +1302,7 @@ bool AntiCacheEvictionManager::readEvictedBlock(PersistentTable *table, int32_t
     //    return false;
     //}
 
-    if (!antiCacheDB->validateBlock(_block_id)) {
+    if (!antiCacheDB->hasBlock(_block_id)) {
         // TODO:This is a hack!!
         if (_block_id >= antiCacheDB->nextBlockId()) {
             throw UnknownBlockAccessException(_block_id);
@@ -1318,56 +1356,9 @@ bool AntiCacheEvictionManager::readEvictedBlock(PersistentTable *table, int32_t
     try {
         VOLT_DEBUG("BLOCK %u %d - unevicted blocks size is %d",
                    _block_id, block_id, static_cast<int>(table->unevictedBlocksSize()));
-        AntiCacheBlock* value = antiCacheDB->readBlock(_block_id, 0);
-
-        // allocate the memory for this block
-        char* unevicted_tuples = new char[value->getSize()];
-        memcpy(unevicted_tuples, value->getData(), value->getSize());
-        /*
-        for (int i = 0; i < 200; i++) {
-            printf( "%X", unevicted_tuples[i]);
-        }
-        cout << "\n";*/
-        VOLT_DEBUG("***************** READ EVICTED BLOCK %d *****************", _block_id);
-        VOLT_DEBUG("Block Size = %ld / Table = %s", value->getSize(), table->name().c_str());
-        ReferenceSerializeInput in(unevicted_tuples, value->getSize());
-        
-        // Read in all the block meta-data
-        int num_tables = in.readInt();
-        VOLT_DEBUG("num tables is %d", num_tables);
-        std::vector<std::string> tableNames;
-        std::vector<int> numTuples;
-        for(int j = 0; j < num_tables; j++){
-            std::string name = in.readTextString();
-            tableNames.push_back(name);
-            VOLT_DEBUG("tableName is %s", name.c_str());
-            int tuples = in.readInt();
-            numTuples.push_back(tuples);
-            VOLT_DEBUG("num tuples is %d", tuples);
-        }
-
-        //pthread_mutex_lock(&lock);
-        table->insertUnevictedBlock(unevicted_tuples, table->m_read_pivot);
-        table->insertTupleOffset(tuple_offset, table->m_read_pivot);
-        table->insertBlockID(block_id, table->m_read_pivot);
-
-        if (table->m_read_pivot == ANTICACHE_MERGE_BUFFER_SIZE - 1) {
-            table->m_read_pivot = 0;
-        }
-        else
-            table->m_read_pivot++;
-        //pthread_mutex_unlock(&lock);
-
-        //if (table->m_read_pivot % 10000 == 0) 
-            
-            //printf("pivot: %d!\n", table->m_read_pivot);
-
-        //table->insertUnevictedBlockID(std::pair<int32_t,int32_t>(block_id, table->unevictedBlocksSize()));
-        VOLT_DEBUG("after insert: alreadyUnevicted %d - IDs size %ld", table->isAlreadyUnEvicted(block_id), table->getUnevictedBlockIDs().size());
-        
-        VOLT_DEBUG("BLOCK %u TUPLE %d - unevicted blocks size is %d",
-                block_id, tuple_offset, static_cast<int>(table->unevictedBlocksSize()));
+        AntiCacheBlock* value = antiCacheDB->fetchBlock(_block_id, 0);
 
+        insertUnevictedBlock(table, value, block_id, tuple_offset);
         delete value;
     } catch (UnknownBlockAccessException e) {
         throw e;
@@ -1382,6 +1373,169 @@ bool AntiCacheEvictionManager::readEvictedBlock(PersistentTable *table, int32_t
 }
 
 
+/*
+ * Copy a serialized block for the AntiCacheDB, compressed if that is enabled
+ */
+char* AntiCacheEvictionManager::packBlock(PersistentTable *table, AntiCacheDB *antiCacheDB,
+                                          const char* data, long &size) {
+    if (m_compressor.getCodecType() == ANTICACHE_CODEC_NONE) {
+        char* copy = new char[size];
+        memcpy(copy, data, size);
+        return copy;
+    }
+    const long rawSize = size;
+    int64_t micros = 0;
+    char* packed = m_compressor.pack(table->name(), data, size, micros);
+    table->recordCompression(rawSize, size, micros);
+    antiCacheDB->recordCompression(rawSize, size, micros);
+    VOLT_DEBUG("Compressed %s block from %ld to %ld bytes", table->name().c_str(), rawSize, size);
+    return packed;
+}
+
+/*
+ * Copy the tuples out of a block that has been read from an AntiCacheDB,
+ * decompressing them if needed. The table may be NULL.
+ */
+char* AntiCacheEvictionManager::unpackBlock(PersistentTable *table, AntiCacheDB *antiCacheDB,
+                                            AntiCacheBlock* value, long &size) {
+    int64_t micros = 0;
+    size = value->getSize();
+    const bool packed = AntiCacheCompressor::isPacked(value->getData(), size);
+    char* data = m_compressor.unpack(value->getData(), size, micros);
+    if (packed) {
+        if (table != NULL) {
+            table->recordDecompression(micros);
+        }
+        antiCacheDB->recordDecompression(micros);
+    }
+    return data;
+}
+
+/*
+ * Hand a block that has been read from an AntiCacheDB over to the table, which
+ * merges its tuples later on
+ */
+void AntiCacheEvictionManager::insertUnevictedBlock(PersistentTable *table, AntiCacheBlock* value,
+                                                    int32_t block_id, int32_t tuple_offset) {
+    // allocate the memory for this block
+    long size = value->getSize();
+    char* unevicted_tuples = unpackBlock(table, m_db_lookup[(int16_t)((block_id & 0xE0000000) >> 29)], value, size);
+    /*
+    for (int i = 0; i < 200; i++) {
+        printf( "%X", unevicted_tuples[i]);
+    }
+    cout << "\n";*/
+    VOLT_DEBUG("***************** READ EVICTED BLOCK %d *****************", block_id & 0x0FFFFFFF);
+    VOLT_DEBUG("Block Size = %ld / Table = %s", size, table->name().c_str());
+    ReferenceSerializeInput in(unevicted_tuples, size);
+    
+    // Read in all the block meta-data
+    int num_tables = in.readInt();
+    VOLT_DEBUG("num tables is %d", num_tables);
+    std::vector<std::string> tableNames;
+    std::vector<int> numTuples;
+    for(int j = 0; j < num_tables; j++){
+        std::string name = in.readTextString();
+        tableNames.push_back(name);
+        VOLT_DEBUG("tableName is %s", name.c_str());
+        int tuples = in.readInt();
+        numTuples.push_back(tuples);
+        VOLT_DEBUG("num tuples is %d", tuples);
+    }
+
+    //pthread_mutex_lock(&lock);
+    table->insertUnevictedBlock(unevicted_tuples, table->m_read_pivot);
+    table->insertTupleOffset(tuple_offset, table->m_read_pivot);
+    table->insertBlockID(block_id, table->m_read_pivot);
+
+    if (table->m_read_pivot == ANTICACHE_MERGE_BUFFER_SIZE - 1) {
+        table->m_read_pivot = 0;
+    }
+    else
+        table->m_read_pivot++;
+    //pthread_mutex_unlock(&lock);
+
+    //if (table->m_read_pivot % 10000 == 0) 
+        
+        //printf("pivot: %d!\n", table->m_read_pivot);
+
+    //table->insertUnevictedBlockID(std::pair<int32_t,int32_t>(block_id, table->unevictedBlocksSize()));
+    VOLT_DEBUG("after insert: alreadyUnevicted %d - IDs size %ld", table->isAlreadyUnEvicted(block_id), table->getUnevictedBlockIDs().size());
+    
+    VOLT_DEBUG("BLOCK %u TUPLE %d - unevicted blocks size is %d",
+            block_id, tuple_offset, static_cast<int>(table->unevictedBlocksSize()));
+}
+
+/*
+ * readEvictedBlock() for a batch of requests. The blocks are read once each,
+ * and every AntiCacheDB gets all of its blocks in one call so that it can
+ * batch the reads.
+ */
+bool AntiCacheEvictionManager::readEvictedBlocks(PersistentTable *table, int numBlocks,
+                                                 int32_t blockIds[], int32_t tupleOffsets[]) {
+    std::map<int16_t, std::vector<uint32_t> > dbBlockIds;
+    std::map<int16_t, std::vector<int32_t> > dbRequests;
+    // keyed by the block id without the blocking bit
+    std::map<int32_t, AntiCacheBlock*> blocks;
+    for (int i = 0; i < numBlocks; i++) {
+        const int32_t key = (int32_t)(blockIds[i] & 0xEFFFFFFF);
+        if (blocks.find(key) != blocks.end()) {
+            continue;
+        }
+        uint32_t _block_id = (uint32_t)(blockIds[i] & 0x0FFFFFFF);
+        int16_t ACID = (int16_t)((blockIds[i] & 0xE0000000) >> 29);
+        AntiCacheDB* antiCacheDB = m_db_lookup[ACID];
+
+        if (!antiCacheDB->hasBlock(_block_id)) {
+            // TODO:This is a hack!!
+            if (_block_id >= antiCacheDB->nextBlockId()) {
+                throw UnknownBlockAccessException(_block_id);
+            }
+            VOLT_WARN("Block %d has already been read from another table.", blockIds[i]);
+            continue;
+        }
+        blocks[key] = NULL;
+        dbBlockIds[ACID].push_back(_block_id);
+        dbRequests[ACID].push_back(key);
+    } // FOR
+
+    std::map<int16_t, std::vector<uint32_t> >::iterator db_itr;
+    try {
+        for (db_itr = dbBlockIds.begin(); db_itr != dbBlockIds.end(); ++db_itr) {
+            std::vector<AntiCacheBlock*> values;
+            m_db_lookup[db_itr->first]->fetchBlocks(db_itr->second, 0, values);
+            const std::vector<int32_t> &requests = dbRequests[db_itr->first];
+            for (int i = 0; i < (int)values.size(); i++) {
+                blocks[requests[i]] = values[i];
+            }
+        }
+    } catch (...) {
+        for (std::map<int32_t, AntiCacheBlock*>::iterator itr = blocks.begin(); itr != blocks.end(); ++itr) {
+            delete itr->second;
+        }
+        throw;
+    }
+
+    for (int i = 0; i < numBlocks; i++) {
+        std::map<int32_t, AntiCacheBlock*>::iterator itr = blocks.find((int32_t)(blockIds[i] & 0xEFFFFFFF));
+        if (itr == blocks.end() || itr->second == NULL) {
+            continue;
+        }
+        insertUnevictedBlock(table, itr->second, blockIds[i], tupleOffsets[i]);
+        // with block merge the block is gone from the database after the
+        // first read, with tuple merge every request gets its own copy
+        if (m_db_lookup[(int16_t)((blockIds[i] & 0xE0000000) >> 29)]->isBlockMerge()) {
+            delete itr->second;
+            itr->second = NULL;
+        }
+    } // FOR
+    for (std::map<int32_t, AntiCacheBlock*>::iterator itr = blocks.begin(); itr != blocks.end(); ++itr) {
+        delete itr->second;
+    }
+    return true;
+}
+
+
 // stub method that may either be implemented by plug in policies
 // or via class inheritance.
 
@@ -1484,6 +1638,10 @@ int32_t AntiCacheEvictionManager::migrateBlock(int32_t block_id, AntiCacheDB* ds
     bool blocking = (bool)((block_id & 0x10000000) >> 28);
     AntiCacheDB* srcDB = m_db_lookup[acid];
 
+    // Migration goes around the write queues
+    srcDB->drainWrites();
+    dstDB->drainWrites();
+
     // garbage. remove later MJG
     if (blocking != srcDB->isBlocking()) {
         VOLT_WARN("blocking != srcDB->isBlocking(). Investigate!");
@@ -1527,6 +1685,7 @@ int32_t AntiCacheEvictionManager::migrateBlock(int32_t block_id, AntiCacheDB* ds
                 }
             }
             VOLT_INFO("updated %u migrated tuples [#%8x -> #%8x]", updated, block_id, new_block_id);
+            table->getEvictedKeyFilter().renameBlock(block_id, new_block_id);
         } else {
             VOLT_WARN("No evicted table! If this is an EE test, shouldn't be a problem");
         }
@@ -1552,6 +1711,10 @@ int32_t AntiCacheEvictionManager::migrateLRUBlock(AntiCacheDB* srcDB, AntiCacheD
     int16_t new_acid;
     int32_t new_block_id = 0;
 
+    // Migration goes around the write queues
+    srcDB->drainWrites();
+    dstDB->drainWrites();
+
     if (dstDB->getFreeBlocks() == 0) {
         return (int32_t) _new_block_id;
     }
@@ -1651,6 +1814,10 @@ AntiCacheDB* AntiCacheEvictionManager::getAntiCacheDB(int acid) {
     }
 }    
 
+void AntiCacheEvictionManager::setCompression(AntiCacheCodecType type, int dictionaryBlocks) {
+    m_compressor.setCodec(type, dictionaryBlocks);
+}
+
 /*
  * Merges the unevicted block into the regular data table
  */
@@ -1683,7 +1850,7 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
     TableTuple evicted_tuple = table->getEvictedTable()->tempTuple();
 
     //int active_tuple_count = (int)table->activeTupleCount();
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     //int tuples_in_eviction_chain = (int)table->getNumTuplesInEvictionChain();
 #endif
 
@@ -1736,6 +1903,10 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
             if(!table->mergeStrategy()) {
                 int64_t current_unevicted = tableInBlock->unevictTuple(&in, merge_tuple_offset, merge_tuple_offset, (bool)table->mergeStrategy());
                 bytes_unevicted += current_unevicted;
+                if (current_unevicted > 0 && tableInBlock->hasEvictedKeyFingerprints()) {
+                    std::vector<uint32_t> fingerprints(1, tableInBlock->getEvictedKeyFingerprint(*tableInBlock->getTempTarget1()));
+                    tableInBlock->getEvictedKeyFilter().removeKeys(block_id, fingerprints);
+                }
                 antiCacheDB->removeSingleTupleStats(_block_id, current_unevicted);
                 //printf("Add back: %u %u\n", ACID, _block_id);
             } else {
@@ -1780,6 +1951,17 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
                 }
                  */
                 }
+
+                // The whole block is back in memory. Its keys were written
+                // right after its tuples.
+                AntiCacheKeyFilter &filter = tableInBlock->getEvictedKeyFilter();
+                if (num_tables == 1 && filter.hasBlock(block_id)) {
+                    std::vector<uint32_t> fingerprints;
+                    if (AntiCacheKeyFilter::deserializeFrom(in, fingerprints)) {
+                        filter.removeKeys(block_id, fingerprints);
+                    }
+                }
+                filter.removeBlock(block_id);
             }
             if(tableInBlock->mergeStrategy())
                 tuplesRead += num_tuples_in_block;
@@ -1828,7 +2010,7 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
     VOLT_DEBUG("unevicted blocks size %d", static_cast<int>(table->unevictedBlocksSize()));
 
     //VOLT_ERROR("Active Tuple Count: %d -- %d", (int)active_tuple_count, (int)table->activeTupleCount());
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     VOLT_INFO("Tuples in Eviction Chain: %d -- %d", (int)tuples_in_eviction_chain, (int)table->getNumTuplesInEvictionChain());
 #endif
 
@@ -1907,13 +2089,12 @@ void AntiCacheEvictionManager::recordEvictedAccess(catalog::Table* catalogTable,
 
 
             AntiCacheDB* antiCacheDB = m_db_lookup[ACID]; 
-            AntiCacheBlock* value = antiCacheDB->readBlock(_block_id, 0);
-            //char* unevicted_tuples = new char[value->getSize()];
-            //memcpy(unevicted_tuples, value->getData(), value->getSize());
-            char* unevicted_tuples = value->getData();
+            AntiCacheBlock* value = antiCacheDB->fetchBlock(_block_id, 0);
+            long size;
+            char* unevicted_tuples = unpackBlock(NULL, antiCacheDB, value, size);
 
             VOLT_DEBUG("***************** READ EVICTED BLOCK %d *****************", _block_id);
-            VOLT_DEBUG("Block Size = %ld / Table = %s", value->getSize(), catalogTable->name().c_str());
+            VOLT_DEBUG("Block Size = %ld / Table = %s", size, catalogTable->name().c_str());
             ReferenceSerializeInput in(unevicted_tuples, 10485760);
             //printf("%d %d %d %d\n", unevicted_tuples[0], unevicted_tuples[1], unevicted_tuples[2], unevicted_tuples[3]);
             // Read in all the block meta-data
@@ -1950,6 +2131,7 @@ void AntiCacheEvictionManager::recordEvictedAccess(catalog::Table* catalogTable,
 
             VOLT_TRACE("Read directly from anticacheDB.\n");
 
+            delete [] unevicted_tuples;
             delete value;
             return;
         }
@@ -2090,9 +2272,7 @@ bool AntiCacheEvictionManager::blockingMerge() {
         
         bool final_result = true;
         try {
-            for(int i = 0; i < num_blocks; i++) {
-                final_result = readEvictedBlock(table, block_ids[i], tuple_ids[i]) && final_result;
-            }
+            final_result = readEvictedBlocks(table, num_blocks, block_ids, tuple_ids);
         } catch (SerializableEEException &e) {
             VOLT_ERROR("blocking read failed to read %d blocks for table '%s'\n%s",
                     num_blocks, table->name().c_str(), e.message().c_str());
@@ -2117,7 +2297,7 @@ bool AntiCacheEvictionManager::blockingMerge() {
     return false;
 }     
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
 
 // -----------------------------------------
 // Debugging Unility Methods
@@ -35,6 +35,7 @@
 #include "common/NValue.hpp"
 #include "common/ValuePeeker.hpp"
 #include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheCompressor.h"
 #include "mmh3/MurmurHash3.h"
 
 #include <vector>
@@ -79,6 +80,7 @@ public:
     // Table* readBlocks(PersistentTable *table, int numBlocks, int16_t blockIds[], int32_t tuple_offsets[]);
     bool mergeUnevictedTuples(PersistentTable *table);
     bool readEvictedBlock(PersistentTable *table, int32_t block_id, int32_t tuple_offset);
+    bool readEvictedBlocks(PersistentTable *table, int numBlocks, int32_t blockIds[], int32_t tupleOffsets[]);
     //int numTuplesInEvictionList(); 
 
     int chooseDB();
@@ -91,6 +93,16 @@ public:
     int16_t addAntiCacheDB(AntiCacheDB* acdb);
     AntiCacheDB* getAntiCacheDB(int acid);
 
+    /**
+     * Compress the blocks evicted from now on with the given codec, with
+     * a dictionary per table trained from its first dictionaryBlocks blocks
+     * (none if zero)
+     */
+    void setCompression(AntiCacheCodecType type, int dictionaryBlocks);
+    inline AntiCacheCompressor* getCompressor() {
+        return &m_compressor;
+    }
+
     // -----------------------------------------
     // Evicted Access Tracking Methods
     // -----------------------------------------
@@ -135,6 +147,9 @@ protected:
     bool removeTupleDoubleLinkedList(PersistentTable* table, TableTuple* tuple_to_remove, uint32_t removal_id);
 
     void printLRUChain(PersistentTable* table, int max, bool forward);
+    void insertUnevictedBlock(PersistentTable *table, AntiCacheBlock* value, int32_t block_id, int32_t tuple_offset);
+    char* packBlock(PersistentTable *table, AntiCacheDB *antiCacheDB, const char* data, long &size);
+    char* unpackBlock(PersistentTable *table, AntiCacheDB *antiCacheDB, AntiCacheBlock* value, long &size);
     char *itoa(uint32_t i);
 
     Table *m_evictResultTable;
@@ -167,6 +182,8 @@ protected:
     bool m_migrate;
     //std::map<int16_t, AntiCacheDB*> m_db_lookup_table;
 
+    AntiCacheCompressor m_compressor;
+
 
 }; // AntiCacheEvictionManager class
 
@@ -0,0 +1,248 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/AntiCacheKeyFilter.h"
+#include "common/debuglog.h"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace voltdb {
+
+// The summary never gets smaller than this
+static const int64_t MIN_SUMMARY_BITS = 1024;
+
+/**
+ * Spread the bits of a hash over all 64 bits (the MurmurHash3 finalizer).
+ * boost::hash_combine leaves small integer keys almost as they are.
+ */
+static inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+AntiCacheKeyFilter::AntiCacheKeyFilter() :
+    m_numKeys(0),
+    m_summaryMask(0),
+    m_summaryCapacity(0),
+    m_summaryStale(0),
+    m_summaryDirty(false),
+    m_summaryRebuilds(0) {
+}
+
+uint32_t AntiCacheKeyFilter::fingerprint(const TableTuple &tuple, const std::vector<int> &columns) {
+    std::size_t seed = 0;
+    for (std::vector<int>::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+        tuple.getNValue(*it).hashCombine(seed);
+    }
+    return (uint32_t)mix(seed);
+}
+
+uint32_t AntiCacheKeyFilter::fingerprint(const std::vector<NValue> &key) {
+    std::size_t seed = 0;
+    for (std::vector<NValue>::const_iterator it = key.begin(); it != key.end(); ++it) {
+        it->hashCombine(seed);
+    }
+    return (uint32_t)mix(seed);
+}
+
+void AntiCacheKeyFilter::addBlock(int32_t blockId, const std::vector<uint32_t> &fingerprints) {
+    std::vector<uint32_t> &keys = m_blocks[blockId];
+    keys.insert(keys.end(), fingerprints.begin(), fingerprints.end());
+    std::sort(keys.begin(), keys.end());
+    m_numKeys += (int64_t)fingerprints.size();
+
+    if (m_summaryDirty) {
+        return;
+    }
+    if (m_numKeys + m_summaryStale > m_summaryCapacity) {
+        m_summaryDirty = true;
+        return;
+    }
+    for (std::vector<uint32_t>::const_iterator it = fingerprints.begin(); it != fingerprints.end(); ++it) {
+        addToSummary(*it);
+    }
+}
+
+void AntiCacheKeyFilter::addUnfilteredBlock(int32_t blockId) {
+    m_unfilteredBlocks.insert(blockId);
+}
+
+void AntiCacheKeyFilter::removeKeys(int32_t blockId, const std::vector<uint32_t> &fingerprints) {
+    std::map<int32_t, std::vector<uint32_t> >::iterator block = m_blocks.find(blockId);
+    if (block == m_blocks.end()) {
+        return;
+    }
+    std::vector<uint32_t> &keys = block->second;
+    int64_t removed = 0;
+    for (std::vector<uint32_t>::const_iterator it = fingerprints.begin(); it != fingerprints.end(); ++it) {
+        std::vector<uint32_t>::iterator key = std::lower_bound(keys.begin(), keys.end(), *it);
+        if (key != keys.end() && *key == *it) {
+            keys.erase(key);
+            removed++;
+        }
+    }
+    if (keys.empty()) {
+        m_blocks.erase(block);
+    }
+    keysRemoved(removed);
+}
+
+void AntiCacheKeyFilter::removeBlock(int32_t blockId) {
+    m_unfilteredBlocks.erase(blockId);
+    std::map<int32_t, std::vector<uint32_t> >::iterator block = m_blocks.find(blockId);
+    if (block == m_blocks.end()) {
+        return;
+    }
+    int64_t removed = (int64_t)block->second.size();
+    m_blocks.erase(block);
+    keysRemoved(removed);
+}
+
+void AntiCacheKeyFilter::renameBlock(int32_t oldBlockId, int32_t newBlockId) {
+    if (m_unfilteredBlocks.erase(oldBlockId) > 0) {
+        m_unfilteredBlocks.insert(newBlockId);
+    }
+    std::map<int32_t, std::vector<uint32_t> >::iterator block = m_blocks.find(oldBlockId);
+    if (block == m_blocks.end()) {
+        return;
+    }
+    m_blocks[newBlockId].swap(block->second);
+    m_blocks.erase(block);
+}
+
+bool AntiCacheKeyFilter::mayContain(uint32_t fingerprint) {
+    if (!m_unfilteredBlocks.empty()) {
+        return (true);
+    }
+    if (m_numKeys == 0) {
+        return (false);
+    }
+    if (m_summaryDirty) {
+        rebuildSummary();
+    }
+    return summaryContains(fingerprint);
+}
+
+bool AntiCacheKeyFilter::mayContain(int32_t blockId, uint32_t fingerprint) const {
+    std::map<int32_t, std::vector<uint32_t> >::const_iterator block = m_blocks.find(blockId);
+    if (block == m_blocks.end()) {
+        // We can only rule out the blocks that we know the keys of
+        return (true);
+    }
+    return std::binary_search(block->second.begin(), block->second.end(), fingerprint);
+}
+
+void AntiCacheKeyFilter::serializeTo(ReferenceSerializeOutput &out, const std::vector<uint32_t> &fingerprints) {
+    out.writeInt(SERIALIZED_MAGIC);
+    out.writeInt((int32_t)fingerprints.size());
+    for (std::vector<uint32_t>::const_iterator it = fingerprints.begin(); it != fingerprints.end(); ++it) {
+        out.writeInt((int32_t)*it);
+    }
+}
+
+bool AntiCacheKeyFilter::deserializeFrom(ReferenceSerializeInput &in, std::vector<uint32_t> &fingerprints) {
+    if (in.readInt() != SERIALIZED_MAGIC) {
+        return (false);
+    }
+    int32_t count = in.readInt();
+    fingerprints.reserve(fingerprints.size() + count);
+    for (int32_t i = 0; i < count; i++) {
+        fingerprints.push_back((uint32_t)in.readInt());
+    }
+    return (true);
+}
+
+void AntiCacheKeyFilter::keysRemoved(int64_t count) {
+    m_numKeys -= count;
+    if (m_numKeys == 0) {
+        // Nothing left to summarize
+        std::fill(m_summary.begin(), m_summary.end(), 0);
+        m_summaryStale = 0;
+        m_summaryDirty = false;
+        return;
+    }
+    m_summaryStale += count;
+    // Once most of the summary is stale it turns down too few keys
+    if (m_summaryStale > m_numKeys) {
+        m_summaryDirty = true;
+    }
+}
+
+void AntiCacheKeyFilter::rebuildSummary() {
+    int64_t bits = MIN_SUMMARY_BITS;
+    while (bits < m_numKeys * BITS_PER_KEY) {
+        bits *= 2;
+    }
+    m_summary.assign(bits / 64, 0);
+    m_summaryMask = (uint64_t)(bits - 1);
+    m_summaryCapacity = bits / BITS_PER_KEY;
+    m_summaryStale = 0;
+    m_summaryDirty = false;
+    m_summaryRebuilds++;
+
+    for (std::map<int32_t, std::vector<uint32_t> >::const_iterator block = m_blocks.begin();
+         block != m_blocks.end(); ++block) {
+        for (std::vector<uint32_t>::const_iterator it = block->second.begin(); it != block->second.end(); ++it) {
+            addToSummary(*it);
+        }
+    }
+    VOLT_DEBUG("Rebuilt evicted key summary [keys=%ld, bits=%ld]", (long)m_numKeys, (long)bits);
+}
+
+// The NUM_HASHES bits of a key come from two hashes of its fingerprint
+// (Kirsch and Mitzenmacher)
+
+void AntiCacheKeyFilter::addToSummary(uint32_t fingerprint) {
+    uint64_t h = mix(fingerprint);
+    uint64_t h1 = h & 0xFFFFFFFF;
+    uint64_t h2 = (h >> 32) | 1;
+    for (int i = 0; i < NUM_HASHES; i++) {
+        uint64_t bit = (h1 + i * h2) & m_summaryMask;
+        m_summary[bit >> 6] |= (1ULL << (bit & 63));
+    }
+}
+
+bool AntiCacheKeyFilter::summaryContains(uint32_t fingerprint) const {
+    uint64_t h = mix(fingerprint);
+    uint64_t h1 = h & 0xFFFFFFFF;
+    uint64_t h2 = (h >> 32) | 1;
+    for (int i = 0; i < NUM_HASHES; i++) {
+        uint64_t bit = (h1 + i * h2) & m_summaryMask;
+        if ((m_summary[bit >> 6] & (1ULL << (bit & 63))) == 0) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+}
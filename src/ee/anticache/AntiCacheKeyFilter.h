@@ -0,0 +1,166 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREANTICACHEKEYFILTER_H
+#define HSTOREANTICACHEKEYFILTER_H
+
+#include "common/NValue.hpp"
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace voltdb {
+
+class ReferenceSerializeInput;
+class ReferenceSerializeOutput;
+class TableTuple;
+
+/**
+ * Filter over the primary keys of the tuples that a table has evicted to
+ * its EvictedTable. Each evicted block records a 32-bit fingerprint of the
+ * key of every tuple in it, which is written out at the end of the block
+ * and kept here sorted per block. A Bloom filter over all fingerprints
+ * summarizes the table, so that most keys that were never evicted are
+ * turned down without looking at any block. The summary cannot forget
+ * keys, so it is rebuilt from the blocks once it is full or once most of
+ * the keys in it have been merged back.
+ *
+ * Blocks whose keys are not known (e.g. blocks that hold tuples from more
+ * than one table) are added as unfiltered, and then every key may be in
+ * them until they are merged back.
+ */
+class AntiCacheKeyFilter {
+    public:
+        AntiCacheKeyFilter();
+
+        /**
+         * Fingerprint of the key made of the given columns of a tuple
+         */
+        static uint32_t fingerprint(const TableTuple &tuple, const std::vector<int> &columns);
+
+        /**
+         * Fingerprint of a key. The values must have the types of the key
+         * columns for it to match the fingerprint of the tuple.
+         */
+        static uint32_t fingerprint(const std::vector<NValue> &key);
+
+        void addBlock(int32_t blockId, const std::vector<uint32_t> &fingerprints);
+        void addUnfilteredBlock(int32_t blockId);
+
+        /**
+         * Forget one key per given fingerprint of a block, as its tuples
+         * are merged back into the table
+         */
+        void removeKeys(int32_t blockId, const std::vector<uint32_t> &fingerprints);
+        void removeBlock(int32_t blockId);
+
+        /**
+         * A block got a new id when it was migrated to another AntiCacheDB
+         */
+        void renameBlock(int32_t oldBlockId, int32_t newBlockId);
+
+        /**
+         * Return false if no evicted tuple can have a key with the given
+         * fingerprint
+         */
+        bool mayContain(uint32_t fingerprint);
+
+        /**
+         * Return false if no tuple in the given block can have a key with
+         * the given fingerprint
+         */
+        bool mayContain(int32_t blockId, uint32_t fingerprint) const;
+
+        /**
+         * Return true if the keys of the given block are known
+         */
+        inline bool hasBlock(int32_t blockId) const {
+            return (m_blocks.find(blockId) != m_blocks.end());
+        }
+
+        inline int64_t getKeyCount() const {
+            return m_numKeys;
+        }
+
+        inline int32_t getSummaryRebuilds() const {
+            return m_summaryRebuilds;
+        }
+
+        /**
+         * Number of bytes that serializeTo() writes for the given number
+         * of keys
+         */
+        inline static int serializedSize(int numKeys) {
+            return (int)((2 + numKeys) * sizeof(int32_t));
+        }
+
+        /**
+         * Write the fingerprints of a block after its tuples
+         */
+        static void serializeTo(ReferenceSerializeOutput &out, const std::vector<uint32_t> &fingerprints);
+
+        /**
+         * Read the fingerprints written by serializeTo(). Returns false if
+         * there are none where the input is.
+         */
+        static bool deserializeFrom(ReferenceSerializeInput &in, std::vector<uint32_t> &fingerprints);
+
+        /**
+         * The summary gets at least this many bits for every key in it
+         */
+        static const int BITS_PER_KEY = 10;
+
+        /**
+         * Bits of the summary that every key sets
+         */
+        static const int NUM_HASHES = 7;
+
+    private:
+        static const int32_t SERIALIZED_MAGIC = 0x414b4650;
+
+        void rebuildSummary();
+        void addToSummary(uint32_t fingerprint);
+        bool summaryContains(uint32_t fingerprint) const;
+        void keysRemoved(int64_t count);
+
+        std::map<int32_t, std::vector<uint32_t> > m_blocks;
+        std::set<int32_t> m_unfilteredBlocks;
+        int64_t m_numKeys;
+
+        // The Bloom filter summary. It has room for m_summaryCapacity keys,
+        // m_summaryStale of the ones added to it have since been removed.
+        std::vector<uint64_t> m_summary;
+        uint64_t m_summaryMask;
+        int64_t m_summaryCapacity;
+        int64_t m_summaryStale;
+        bool m_summaryDirty;
+        int32_t m_summaryRebuilds;
+};
+
+}
+
+#endif
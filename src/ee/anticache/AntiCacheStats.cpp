@@ -49,6 +49,16 @@ vector<string> AntiCacheStats::generateAntiCacheStatsColumnNames() {
     columnNames.push_back("ANTICACHE_BYTES_STORED");
     columnNames.push_back("ANTICACHE_BLOCKS_FREE");
     columnNames.push_back("ANTICACHE_BYTES_FREE");
+
+    columnNames.push_back("ANTICACHE_WRITES_QUEUED");
+    columnNames.push_back("ANTICACHE_AVG_WRITE_LATENCY");
+    columnNames.push_back("ANTICACHE_MAX_WRITE_LATENCY");
+
+    columnNames.push_back("ANTICACHE_BYTES_UNCOMPRESSED");
+    columnNames.push_back("ANTICACHE_BYTES_COMPRESSED");
+    columnNames.push_back("ANTICACHE_COMPRESSION_RATIO");
+    columnNames.push_back("ANTICACHE_COMPRESS_TIME");
+    columnNames.push_back("ANTICACHE_DECOMPRESS_TIME");
     
     return columnNames;
 }
@@ -133,6 +143,46 @@ void AntiCacheStats::populateAntiCacheStatsSchema(
     types.push_back(VALUE_TYPE_BIGINT); 
     columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); 
     allowNull.push_back(false);
+
+    //ANTICACHE_WRITES_QUEUED
+    types.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+
+    //ANTICACHE_AVG_WRITE_LATENCY
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_MAX_WRITE_LATENCY
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_BYTES_UNCOMPRESSED
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_BYTES_COMPRESSED
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_COMPRESSION_RATIO
+    types.push_back(VALUE_TYPE_DOUBLE);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+    allowNull.push_back(false);
+
+    //ANTICACHE_COMPRESS_TIME
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_DECOMPRESS_TIME
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
 }
 
 Table*
@@ -189,6 +239,10 @@ AntiCacheStats::AntiCacheStats(Table* table, AntiCacheDB* acdb)
     m_currentEvictedBytes = 0;
     m_currentFreeBlocks = 0;
     m_currentFreeBytes = 0;
+
+    m_writesQueued = 0;
+    m_avgWriteLatency = 0;
+    m_maxWriteLatency = 0;
 }
 
 /**
@@ -254,6 +308,21 @@ void AntiCacheStats::updateStatsTuple(TableTuple *tuple) {
     //m_currentFreeBytes = acdb->getMaxDBSize() - m_currentEvictedBytes;
     m_currentFreeBytes = (int64_t)m_currentFreeBlocks * acdb->getBlockSize();
 
+    // blocks written by the background writer since the last update
+    m_writesQueued = 0;
+    m_avgWriteLatency = 0;
+    m_maxWriteLatency = 0;
+    AntiCacheWriteQueue* writeQueue = acdb->getWriteQueue();
+    if (writeQueue != NULL) {
+        int32_t blocksWritten;
+        int64_t writeMicros;
+        m_writesQueued = writeQueue->getQueuedBlocks();
+        writeQueue->getWriteLatency(&blocksWritten, &writeMicros, &m_maxWriteLatency);
+        if (blocksWritten > 0) {
+            m_avgWriteLatency = writeMicros / blocksWritten;
+        }
+    }
+
 
     tuple->setNValue(
             StatsSource::m_columnName2Index["ANTICACHE_ID"],
@@ -297,6 +366,35 @@ void AntiCacheStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue(
             StatsSource::m_columnName2Index["ANTICACHE_BYTES_FREE"],
             ValueFactory::getBigIntValue(m_currentFreeBytes));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_WRITES_QUEUED"],
+            ValueFactory::getIntegerValue(m_writesQueued));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_AVG_WRITE_LATENCY"],
+            ValueFactory::getBigIntValue(m_avgWriteLatency));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_MAX_WRITE_LATENCY"],
+            ValueFactory::getBigIntValue(m_maxWriteLatency));
+
+    // blocks compressed for this level in total
+    const int64_t bytesUncompressed = acdb->getBytesUncompressed();
+    const int64_t bytesCompressed = acdb->getBytesCompressed();
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_BYTES_UNCOMPRESSED"],
+            ValueFactory::getBigIntValue(bytesUncompressed));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_BYTES_COMPRESSED"],
+            ValueFactory::getBigIntValue(bytesCompressed));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_COMPRESSION_RATIO"],
+            ValueFactory::getDoubleValue(bytesCompressed > 0 ?
+                    (double)bytesUncompressed / (double)bytesCompressed : 0.0));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_COMPRESS_TIME"],
+            ValueFactory::getBigIntValue(acdb->getCompressMicros()));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_DECOMPRESS_TIME"],
+            ValueFactory::getBigIntValue(acdb->getDecompressMicros()));
 }
 
 /**
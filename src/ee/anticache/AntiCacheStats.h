@@ -24,6 +24,7 @@
 #include "storage/table.h"
 #include "anticache/AntiCacheDB.h"
 #include "anticache/AntiCacheEvictionManager.h"
+#include "anticache/AntiCacheWriteQueue.h"
 #include <vector>
 #include <string>
 
@@ -136,6 +137,12 @@ private:
     int64_t m_currentEvictedBytes;
     int32_t m_currentFreeBlocks;
     int64_t m_currentFreeBytes;
+
+    // blocks waiting for the background writer, and the microseconds it
+    // took to write one in the last interval
+    int32_t m_writesQueued;
+    int64_t m_avgWriteLatency;
+    int64_t m_maxWriteLatency;
 };
 
 }
@@ -0,0 +1,295 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/AntiCacheWriteQueue.h"
+#include "common/debuglog.h"
+#include "common/FatalException.hpp"
+#include "common/SerializableEEException.h"
+#include <sys/time.h>
+#include <string.h>
+
+using namespace std;
+
+namespace voltdb {
+
+QueuedAntiCacheBlock::QueuedAntiCacheBlock(uint32_t blockId, const std::string &tableName,
+                                           char* data, long size, AntiCacheDBType blockType) :
+    AntiCacheBlock(blockId) {
+
+    payload p;
+    p.blockId = blockId;
+    p.tableName = tableName;
+    p.data = data;
+    p.size = size;
+    m_payload = p;
+    m_size = static_cast<int32_t>(size);
+    m_block = data;
+    m_buf = NULL;
+    m_blockType = blockType;
+}
+
+QueuedAntiCacheBlock::~QueuedAntiCacheBlock() {
+    delete [] m_block;
+}
+
+AntiCacheWriteQueue::AntiCacheWriteQueue(AntiCacheDB *db, int maxBlocks) :
+    m_db(db),
+    m_maxBlocks(maxBlocks),
+    m_writing(NULL),
+    m_stopping(false),
+    m_blocksWritten(0),
+    m_writeMicros(0),
+    m_maxWriteMicros(0),
+    m_queueHits(0),
+    m_failedWrites(0) {
+
+    assert(maxBlocks > 0);
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_queued, NULL);
+    pthread_cond_init(&m_written, NULL);
+    pthread_mutex_init(&m_dbMutex, NULL);
+    if (pthread_create(&m_thread, NULL, run, this) != 0) {
+        throwFatalException("Failed to start the anti-cache writer thread for '%s'",
+                            m_db->getDBDir().c_str());
+    }
+}
+
+AntiCacheWriteQueue::~AntiCacheWriteQueue() {
+    pthread_mutex_lock(&m_mutex);
+    m_stopping = true;
+    pthread_cond_signal(&m_queued);
+    pthread_mutex_unlock(&m_mutex);
+    pthread_join(m_thread, NULL);
+
+    for (size_t i = 0; i < m_failed.size(); i++) {
+        VOLT_ERROR("Dropping anti-cache block %u that could not be written", m_failed[i]->blockId);
+        delete [] m_failed[i]->data;
+        delete m_failed[i];
+    }
+    pthread_mutex_destroy(&m_dbMutex);
+    pthread_cond_destroy(&m_written);
+    pthread_cond_destroy(&m_queued);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void AntiCacheWriteQueue::push(const std::string &tableName, uint32_t blockId, int tupleCount,
+                               char* data, long size, int evictedBytes) {
+    PendingBlock *block = new PendingBlock();
+    block->tableName = tableName;
+    block->blockId = blockId;
+    block->tupleCount = tupleCount;
+    block->data = data;
+    block->size = size;
+    block->evictedBytes = evictedBytes;
+
+    pthread_mutex_lock(&m_mutex);
+    while ((int)m_pending.size() >= m_maxBlocks) {
+        VOLT_DEBUG("Anti-cache write queue is full, waiting to queue block %u", blockId);
+        pthread_cond_wait(&m_written, &m_mutex);
+    }
+    m_pending.push_back(block);
+    m_db->m_queuedBlocks++;
+    pthread_cond_signal(&m_queued);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+AntiCacheBlock* AntiCacheWriteQueue::read(uint32_t blockId, bool isMigrate) {
+    pthread_mutex_lock(&m_mutex);
+    while (true) {
+        // Reading the block takes it out of the database, so there is no
+        // need to write it anymore
+        const bool remove = (isMigrate || m_db->isBlockMerge());
+        PendingBlock *pending = find(blockId, remove);
+        if (pending != NULL) {
+            char* data = pending->data;
+            if (!remove) {
+                data = new char[pending->size];
+                memcpy(data, pending->data, pending->size);
+            }
+            m_queueHits++;
+            AntiCacheBlock* block = new QueuedAntiCacheBlock(blockId, pending->tableName, data,
+                                                             pending->size, m_db->getDBType());
+            if (remove) {
+                delete pending;
+            }
+            pthread_mutex_unlock(&m_mutex);
+            VOLT_DEBUG("Read anti-cache block %u from the write queue", blockId);
+            return (block);
+        }
+        if (m_writing == NULL || m_writing->blockId != blockId) {
+            break;
+        }
+        // the block is being written right now
+        pthread_cond_wait(&m_written, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_mutex_lock(&m_dbMutex);
+    try {
+        AntiCacheBlock* block = m_db->readBlock(blockId, isMigrate);
+        pthread_mutex_unlock(&m_dbMutex);
+        return (block);
+    } catch (...) {
+        pthread_mutex_unlock(&m_dbMutex);
+        throw;
+    }
+}
+
+bool AntiCacheWriteQueue::contains(uint32_t blockId) {
+    pthread_mutex_lock(&m_mutex);
+    bool found = (find(blockId, false) != NULL ||
+                  (m_writing != NULL && m_writing->blockId == blockId));
+    pthread_mutex_unlock(&m_mutex);
+    if (!found) {
+        pthread_mutex_lock(&m_dbMutex);
+        found = m_db->validateBlock(blockId);
+        pthread_mutex_unlock(&m_dbMutex);
+    }
+    return (found);
+}
+
+void AntiCacheWriteQueue::drain() {
+    pthread_mutex_lock(&m_mutex);
+    while (!m_pending.empty() || m_writing != NULL) {
+        pthread_cond_wait(&m_written, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+int AntiCacheWriteQueue::getQueuedBlocks() {
+    pthread_mutex_lock(&m_mutex);
+    int queued = (int)m_pending.size() + (m_writing != NULL ? 1 : 0);
+    pthread_mutex_unlock(&m_mutex);
+    return (queued);
+}
+
+void AntiCacheWriteQueue::getWriteLatency(int32_t *blocks, int64_t *totalMicros, int64_t *maxMicros) {
+    pthread_mutex_lock(&m_mutex);
+    *blocks = m_blocksWritten;
+    *totalMicros = m_writeMicros;
+    *maxMicros = m_maxWriteMicros;
+    m_blocksWritten = 0;
+    m_writeMicros = 0;
+    m_maxWriteMicros = 0;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+AntiCacheWriteQueue::PendingBlock* AntiCacheWriteQueue::find(uint32_t blockId, bool remove) {
+    for (std::deque<PendingBlock*>::iterator it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if ((*it)->blockId == blockId) {
+            PendingBlock *block = *it;
+            if (remove) {
+                m_pending.erase(it);
+                m_db->m_queuedBlocks--;
+                pthread_cond_broadcast(&m_written);
+            }
+            return (block);
+        }
+    }
+    for (std::vector<PendingBlock*>::iterator it = m_failed.begin(); it != m_failed.end(); ++it) {
+        if ((*it)->blockId == blockId) {
+            PendingBlock *block = *it;
+            if (remove) {
+                m_failed.erase(it);
+            }
+            return (block);
+        }
+    }
+    return (NULL);
+}
+
+void* AntiCacheWriteQueue::run(void *arg) {
+    static_cast<AntiCacheWriteQueue*>(arg)->writeBlocks();
+    return NULL;
+}
+
+void AntiCacheWriteQueue::writeBlocks() {
+    pthread_mutex_lock(&m_mutex);
+    while (true) {
+        while (m_pending.empty() && !m_stopping) {
+            pthread_cond_wait(&m_queued, &m_mutex);
+        }
+        if (m_pending.empty()) {
+            break;
+        }
+        m_writing = m_pending.front();
+        m_pending.pop_front();
+        // the backend counts the block itself from here on
+        m_db->m_queuedBlocks--;
+        // flush once the queue has run dry rather than after every block
+        const bool flush = m_pending.empty();
+        pthread_cond_broadcast(&m_written);
+        pthread_mutex_unlock(&m_mutex);
+
+        struct timeval start;
+        gettimeofday(&start, NULL);
+        const bool written = write(m_writing, flush);
+        struct timeval end;
+        gettimeofday(&end, NULL);
+        const int64_t micros = (int64_t)(end.tv_sec - start.tv_sec) * 1000000 +
+                               (end.tv_usec - start.tv_usec);
+
+        pthread_mutex_lock(&m_mutex);
+        if (written) {
+            m_blocksWritten++;
+            m_writeMicros += micros;
+            if (micros > m_maxWriteMicros) {
+                m_maxWriteMicros = micros;
+            }
+            delete [] m_writing->data;
+            delete m_writing;
+        } else {
+            m_failedWrites++;
+            m_failed.push_back(m_writing);
+        }
+        m_writing = NULL;
+        pthread_cond_broadcast(&m_written);
+    } // WHILE
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool AntiCacheWriteQueue::write(PendingBlock *block, bool flush) {
+    bool written = true;
+    pthread_mutex_lock(&m_dbMutex);
+    try {
+        m_db->writeBlock(block->tableName, block->blockId, block->tupleCount,
+                         block->data, block->size, block->evictedBytes);
+        if (flush) {
+            m_db->flushBlocks();
+        }
+    } catch (SerializableEEException &e) {
+        VOLT_ERROR("Failed to write anti-cache block %u of table '%s': %s",
+                   block->blockId, block->tableName.c_str(), e.message().c_str());
+        written = false;
+    } catch (...) {
+        VOLT_ERROR("Failed to write anti-cache block %u of table '%s'",
+                   block->blockId, block->tableName.c_str());
+        written = false;
+    }
+    pthread_mutex_unlock(&m_dbMutex);
+    return (written);
+}
+
+}
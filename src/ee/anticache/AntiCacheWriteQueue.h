@@ -0,0 +1,173 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREANTICACHEWRITEQUEUE_H
+#define HSTOREANTICACHEWRITEQUEUE_H
+
+#include "common/types.h"
+#include "anticache/AntiCacheDB.h"
+
+#include <pthread.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace voltdb {
+
+/**
+ * A block that was handed back before the background writer got to it
+ */
+class QueuedAntiCacheBlock : public AntiCacheBlock {
+    friend class AntiCacheWriteQueue;
+
+    public:
+        ~QueuedAntiCacheBlock();
+
+    private:
+        QueuedAntiCacheBlock(uint32_t blockId, const std::string &tableName,
+                             char* data, long size, AntiCacheDBType blockType);
+}; // CLASS
+
+/**
+ * Writes the evicted blocks of an AntiCacheDB on a background thread, so
+ * that the partition's thread only has to serialize them.
+ *
+ * The queue holds at most maxBlocks blocks and push() waits while it is
+ * full. A block is immutable once it is queued. Reading a block that is
+ * still waiting returns it from memory, and if the read takes the block
+ * out of the database (block merge or migration) it is never written.
+ *
+ * Every call into the AntiCacheDB from either thread goes through the
+ * queue's database lock. Blocks that fail to be written stay in memory
+ * and are still returned by read(), since their tuples are gone from the
+ * table by then.
+ */
+class AntiCacheWriteQueue {
+    public:
+        AntiCacheWriteQueue(AntiCacheDB *db, int maxBlocks);
+
+        /**
+         * Writes out the blocks that are still queued before stopping the
+         * writer thread
+         */
+        ~AntiCacheWriteQueue();
+
+        /**
+         * Queue a block for writeBlock(). The queue takes the data, which
+         * must have been allocated with new[].
+         */
+        void push(const std::string &tableName, uint32_t blockId, int tupleCount,
+                  char* data, long size, int evictedBytes);
+
+        /**
+         * readBlock() from memory if the block has not been written yet, or
+         * else from the database once the writer is done with it
+         */
+        AntiCacheBlock* read(uint32_t blockId, bool isMigrate);
+
+        /**
+         * validateBlock() that also knows about the queued blocks
+         */
+        bool contains(uint32_t blockId);
+
+        /**
+         * Wait until every queued block is written and flushed
+         */
+        void drain();
+
+        inline int getMaxBlocks() const {
+            return m_maxBlocks;
+        }
+
+        /**
+         * Blocks that are queued or being written
+         */
+        int getQueuedBlocks();
+
+        /**
+         * Return the number of blocks written and the time that took in
+         * microseconds since the last call, and the longest write in that
+         * interval
+         */
+        void getWriteLatency(int32_t *blocks, int64_t *totalMicros, int64_t *maxMicros);
+
+        inline int32_t getQueueHits() const {
+            return m_queueHits;
+        }
+
+        inline int32_t getFailedWrites() const {
+            return m_failedWrites;
+        }
+
+    private:
+        struct PendingBlock {
+            std::string tableName;
+            uint32_t blockId;
+            int tupleCount;
+            char* data;
+            long size;
+            int evictedBytes;
+        };
+
+        static void* run(void *arg);
+        void writeBlocks();
+        bool write(PendingBlock *block, bool flush);
+
+        /**
+         * Find the block among the ones that are queued or failed. Must hold
+         * m_mutex.
+         */
+        PendingBlock* find(uint32_t blockId, bool remove);
+
+        AntiCacheDB *m_db;
+        const int m_maxBlocks;
+
+        pthread_t m_thread;
+        // guards everything below
+        pthread_mutex_t m_mutex;
+        // signalled when a block is queued or the writer has to stop
+        pthread_cond_t m_queued;
+        // signalled when a block leaves the queue or has been written
+        pthread_cond_t m_written;
+        // serializes the calls into the AntiCacheDB
+        pthread_mutex_t m_dbMutex;
+
+        std::deque<PendingBlock*> m_pending;
+        PendingBlock* m_writing;
+        std::vector<PendingBlock*> m_failed;
+        bool m_stopping;
+
+        /*
+         * stats
+         */
+        int32_t m_blocksWritten;
+        int64_t m_writeMicros;
+        int64_t m_maxWriteMicros;
+        int32_t m_queueHits;
+        int32_t m_failedWrites;
+}; // CLASS
+
+}
+#endif
@@ -120,6 +120,8 @@ void BerkeleyAntiCacheDB::shutdownDB() {
 }
 
 BerkeleyAntiCacheDB::~BerkeleyAntiCacheDB() {
+    // write out the queued blocks first
+    setAsyncWrites(0);
     shutdownDB();
 }
 
@@ -5,6 +5,7 @@
 
 #include "common/debuglog.h"
 #include "common/DefaultTupleSerializer.h"
+#include "anticache/AntiCacheKeyFilter.h"
 
 #include <map>
 #include <vector>
@@ -64,6 +65,11 @@ public:
         }
     }
 
+    inline void addKeyFingerprints(const std::vector<uint32_t> &fingerprints){
+        // the primary keys of the tuples go after them (see AntiCacheKeyFilter)
+        AntiCacheKeyFilter::serializeTo(out, fingerprints);
+    }
+
     inline int getSerializedSize(){
         return (int)out.size();
     }
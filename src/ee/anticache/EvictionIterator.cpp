@@ -263,7 +263,10 @@ bool EvictionIterator::hasNext()
     if(ptable->usedTupleCount() == 0)
         return false; 
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_CLOCK)
+    if (ptable->activeTupleCount() == 0)
+        return false;
+#elif !defined(ANTICACHE_TIMESTAMPS)
     if(current_tuple_id == ptable->getNewestTupleID())
         return false;
     if(ptable->getNumTuplesInEvictionChain() == 0) { // there are no tuples in the chain
@@ -280,7 +283,33 @@ bool EvictionIterator::hasNext()
 
 bool EvictionIterator::next(TableTuple &tuple)
 {    
-#ifndef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_CLOCK)
+    PersistentTable* ptable = static_cast<PersistentTable*>(table);
+    uint32_t used_tuples = (uint32_t)ptable->usedTupleCount();
+    uint32_t hand = ptable->getClockHand();
+
+    // Sweep the clock hand over the tuple slots. A referenced tuple gets its
+    // bit cleared and a second chance, so two turns are enough to find a victim.
+    for (uint32_t swept = 0; swept < 2 * used_tuples; swept++) {
+        if (hand >= used_tuples)
+            hand = 0;
+        uint32_t tuple_id = hand++;
+
+        current_tuple->move(ptable->dataPtrForTuple(tuple_id));
+        if (!current_tuple->isActive() || current_tuple->isEvicted())
+            continue;
+        if (ptable->clearReferenced(tuple_id))
+            continue;
+
+        ptable->setClockHand(hand);
+        tuple.move(current_tuple->address());
+        VOLT_DEBUG("current_tuple_id = %u", tuple_id);
+        return true;
+    }
+    ptable->setClockHand(hand);
+    VOLT_DEBUG("No unreferenced tuples left.");
+    return false;
+#elif !defined(ANTICACHE_TIMESTAMPS)
     PersistentTable* ptable = static_cast<PersistentTable*>(table);
 
     if(current_tuple_id == ptable->getNewestTupleID()) // we've already returned the last tuple in the chain
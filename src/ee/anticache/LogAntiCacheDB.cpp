@@ -0,0 +1,605 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "anticache/AntiCacheDB.h"
+#include "anticache/LogAntiCacheDB.h"
+#include "anticache/UnknownBlockAccessException.h"
+#include "anticache/FullBackingStoreException.h"
+#include "common/debuglog.h"
+#include "common/FatalException.hpp"
+#include "common/executorcontext.hpp"
+#include "common/types.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+
+namespace voltdb {
+
+LogAntiCacheBlock::LogAntiCacheBlock(uint32_t blockId, const std::string &tableName,
+                                     const char* data, long size) :
+    AntiCacheBlock(blockId) {
+
+    m_block = new char[size];
+    memcpy(m_block, data, size);
+    m_buf = NULL;
+
+    payload p;
+    p.tableName = tableName;
+    p.blockId = blockId;
+    p.data = m_block;
+    p.size = size;
+
+    m_payload = p;
+    m_size = static_cast<int32_t>(size);
+    m_blockType = ANTICACHEDB_LOG;
+
+    VOLT_DEBUG("LogAntiCacheBlock #%u from table: %s [size=%d]",
+               blockId, m_payload.tableName.c_str(), m_size);
+}
+
+LogAntiCacheBlock::~LogAntiCacheBlock() {
+    delete [] m_block;
+}
+
+LogAntiCacheDB::LogAntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSize, long maxSize) :
+    AntiCacheDB(ctx, db_dir, blockSize, maxSize),
+    m_shutdown(false) {
+
+    m_dbType = ANTICACHEDB_LOG;
+    initializeDB();
+}
+
+LogAntiCacheDB::~LogAntiCacheDB() {
+    // write out the queued blocks first
+    setAsyncWrites(0);
+    shutdownDB();
+}
+
+void LogAntiCacheDB::initializeDB() {
+    // use executor context to figure out which partition we are at
+    // if there is no executor context, assume this is a test and let it go
+    if (!m_executorContext) {
+        VOLT_WARN("LogAntiCacheDB has no executor context. If this is an EE test, don't worry\n");
+        m_partition = 0;
+    } else {
+        m_partition = (int)m_executorContext->getPartitionId();
+    }
+
+    m_directIO = true;
+    m_segmentSize = SEGMENT_BLOCKS * alignUp(m_blockSize + sizeof(LogRecordHeader));
+    m_activeSegment = NULL;
+    m_nextSegmentId = 0;
+    m_stopping = false;
+
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_cleanable, NULL);
+
+    VOLT_INFO("Creating anti-cache log in %s [segmentSize=%ld]", m_dbDir.c_str(), (long)m_segmentSize);
+    openSegment();
+
+    if (pthread_create(&m_cleaner, NULL, runCleaner, this) != 0) {
+        throwFatalException("Failed to start the anti-cache log cleaner for '%s'", m_dbDir.c_str());
+    }
+}
+
+void LogAntiCacheDB::shutdownDB() {
+    if (m_shutdown) {
+        return;
+    }
+    m_shutdown = true;
+
+    pthread_mutex_lock(&m_lock);
+    m_stopping = true;
+    pthread_cond_signal(&m_cleanable);
+    pthread_mutex_unlock(&m_lock);
+    pthread_join(m_cleaner, NULL);
+
+    // the blocks are gone with the EE, so are their segments
+    while (!m_segments.empty()) {
+        dropSegment(m_segments.begin()->second);
+    }
+    m_activeSegment = NULL;
+    m_directory.clear();
+
+    pthread_cond_destroy(&m_cleanable);
+    pthread_mutex_destroy(&m_lock);
+}
+
+std::string LogAntiCacheDB::segmentFileName(uint32_t id) {
+    char name[64];
+    snprintf(name, sizeof(name), "/anticache-%d-%06u.log", m_partition, id);
+    return (m_dbDir + name);
+}
+
+void LogAntiCacheDB::openSegment() {
+    const uint32_t id = m_nextSegmentId++;
+    const std::string fileName = segmentFileName(id);
+
+    int fd = -1;
+    if (m_directIO) {
+        fd = open(fileName.c_str(), O_CREAT | O_TRUNC | O_RDWR | O_DIRECT, 0644);
+        if (fd < 0 && errno == EINVAL) {
+            VOLT_WARN("The file system of %s does not support O_DIRECT, the anti-cache log "
+                      "goes through the page cache", m_dbDir.c_str());
+            m_directIO = false;
+        }
+    }
+    if (fd < 0) {
+        fd = open(fileName.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        VOLT_ERROR("Failed to open anti-cache log segment %s: %s", fileName.c_str(), strerror(errno));
+        throwFatalException("Failed to open anti-cache log segment in directory %s.", m_dbDir.c_str());
+    }
+
+    LogSegment *segment = new LogSegment();
+    segment->id = id;
+    segment->fd = fd;
+    segment->size = 0;
+    segment->writtenBlocks = 0;
+    m_segments[id] = segment;
+
+    // seal the previous segment
+    LogSegment *sealed = m_activeSegment;
+    m_activeSegment = segment;
+    if (sealed != NULL) {
+        if (sealed->liveBlocks.empty()) {
+            dropSegment(sealed);
+        } else {
+            pthread_cond_signal(&m_cleanable);
+        }
+    }
+    VOLT_DEBUG("Opened anti-cache log segment %s", fileName.c_str());
+}
+
+void LogAntiCacheDB::dropSegment(LogSegment *segment) {
+    assert(segment->liveBlocks.empty() || m_stopping);
+    close(segment->fd);
+    const std::string fileName = segmentFileName(segment->id);
+    if (unlink(fileName.c_str()) != 0) {
+        VOLT_WARN("Failed to delete anti-cache log segment %s: %s", fileName.c_str(), strerror(errno));
+    }
+    m_segments.erase(segment->id);
+    delete segment;
+}
+
+void LogAntiCacheDB::append(uint32_t blockId, const std::string &tableName,
+                            const char* data, long size, LogEntry &entry) {
+    const int64_t length = sizeof(LogRecordHeader) + tableName.size() + size;
+    const int64_t alignedLength = alignUp(length);
+    if (m_activeSegment->size > 0 && m_activeSegment->size + alignedLength > m_segmentSize) {
+        openSegment();
+    }
+
+    char *record = NULL;
+    if (posix_memalign((void**)&record, IO_ALIGNMENT, alignedLength) != 0) {
+        throwFatalException("Failed to allocate %ld bytes for anti-cache block %u",
+                            (long)alignedLength, blockId);
+    }
+    LogRecordHeader header;
+    header.magic = RECORD_MAGIC;
+    header.blockId = blockId;
+    header.nameLength = static_cast<int32_t>(tableName.size());
+    header.dataLength = static_cast<int32_t>(size);
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), tableName.data(), tableName.size());
+    memcpy(record + sizeof(header) + tableName.size(), data, size);
+    memset(record + length, 0, alignedLength - length);
+
+    LogSegment *segment = m_activeSegment;
+    int64_t written = 0;
+    while (written < alignedLength) {
+        ssize_t ret = pwrite(segment->fd, record + written, alignedLength - written,
+                             segment->size + written);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            const int error = errno;
+            free(record);
+            VOLT_ERROR("Failed to write anti-cache block %u to log segment %u: %s",
+                       blockId, segment->id, strerror(error));
+            if (error == ENOSPC) {
+                throw FullBackingStoreException(((int32_t)m_ACID << 16) & blockId, 0);
+            }
+            throwFatalException("Failed to write to the anti-cache log in directory %s.", m_dbDir.c_str());
+        }
+        written += ret;
+    }
+    free(record);
+
+    entry.segment = segment;
+    entry.offset = segment->size;
+    entry.length = static_cast<int32_t>(length);
+    segment->size += alignedLength;
+    segment->writtenBlocks++;
+    segment->liveBlocks.insert(blockId);
+}
+
+char* LogAntiCacheDB::readExtent(LogSegment *segment, int64_t offset, int64_t length) {
+    char *buffer = NULL;
+    if (posix_memalign((void**)&buffer, IO_ALIGNMENT, length) != 0) {
+        throwFatalException("Failed to allocate %ld bytes to read the anti-cache log", (long)length);
+    }
+    int64_t done = 0;
+    while (done < length) {
+        ssize_t ret = pread(segment->fd, buffer + done, length - done, offset + done);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            const int error = errno;
+            free(buffer);
+            VOLT_ERROR("Failed to read %ld bytes at %ld of anti-cache log segment %u: %s",
+                       (long)length, (long)offset, segment->id, ret < 0 ? strerror(error) : "end of file");
+            throwFatalException("Failed to read from the anti-cache log in directory %s.", m_dbDir.c_str());
+        }
+        done += ret;
+    }
+    return (buffer);
+}
+
+AntiCacheBlock* LogAntiCacheDB::parseRecord(uint32_t blockId, const char* record) {
+    LogRecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    if (header.magic != RECORD_MAGIC || header.blockId != blockId) {
+        throwFatalException("Corrupt anti-cache log record for block %u", blockId);
+    }
+    const std::string tableName(record + sizeof(header), header.nameLength);
+    return (new LogAntiCacheBlock(blockId, tableName, record + sizeof(header) + header.nameLength,
+                                  header.dataLength));
+}
+
+void LogAntiCacheDB::flushBlocks() {
+    pthread_mutex_lock(&m_lock);
+    // O_DIRECT skips the page cache, but not the drive's own cache or the
+    // file metadata
+    if (fdatasync(m_activeSegment->fd) != 0) {
+        VOLT_WARN("Failed to sync anti-cache log segment %u: %s", m_activeSegment->id, strerror(errno));
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void LogAntiCacheDB::writeBlock(const std::string tableName,
+                                uint32_t blockId,
+                                const int tupleCount,
+                                const char* data,
+                                const long size,
+                                const int evictedBytes) {
+
+    pthread_mutex_lock(&m_lock);
+    if (getFreeBlocks() == 0) {
+        pthread_mutex_unlock(&m_lock);
+        VOLT_WARN("No free space in ACID %d for blockid %u with blocksize %ld",
+                  m_ACID, blockId, size);
+        throw FullBackingStoreException(((int32_t)m_ACID << 16) & blockId, 0);
+    }
+
+    LogEntry entry;
+    try {
+        append(blockId, tableName, data, size, entry);
+    } catch (...) {
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    m_directory[blockId] = entry;
+
+    VOLT_DEBUG("Writing log block: ID = %u, segment = %u, offset = %ld, tupleCount = %d, size = %d, tableName = %s",
+               blockId, entry.segment->id, (long)entry.offset, tupleCount, entry.length, tableName.c_str());
+
+    m_blocksEvicted++;
+    if (!isBlockMerge()) {
+        if (evictedBytes >= 0)
+            m_bytesEvicted += static_cast<int32_t>((int64_t)evictedBytes);
+        else
+            m_bytesEvicted += static_cast<int32_t>((int64_t)size);
+    }
+    else {
+        m_bytesEvicted += entry.length;
+    }
+
+    if (m_executorContext == NULL || m_executorContext->getAntiCacheLevels() > 1)
+        pushBlockLRU(blockId);
+    else
+        m_totalBlocks++;
+    pthread_mutex_unlock(&m_lock);
+}
+
+bool LogAntiCacheDB::validateBlock(uint32_t blockId) {
+    pthread_mutex_lock(&m_lock);
+    bool found = (m_directory.find(blockId) != m_directory.end());
+    pthread_mutex_unlock(&m_lock);
+    return (found);
+}
+
+AntiCacheBlock* LogAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate) {
+    pthread_mutex_lock(&m_lock);
+    std::map<uint32_t, LogEntry>::iterator itr = m_directory.find(blockId);
+    if (itr == m_directory.end()) {
+        pthread_mutex_unlock(&m_lock);
+        VOLT_ERROR("Invalid anti-cache blockId '%u'", blockId);
+        throw UnknownBlockAccessException(blockId);
+    }
+
+    AntiCacheBlock* block = NULL;
+    try {
+        const LogEntry &entry = itr->second;
+        char *record = readExtent(entry.segment, entry.offset, alignUp(entry.length));
+        VOLT_DEBUG("Reading log block: ID = %u, segment = %u, offset = %ld, size = %d, isMigrate = %d",
+                   blockId, entry.segment->id, (long)entry.offset, entry.length, isMigrate);
+        try {
+            block = parseRecord(blockId, record);
+        } catch (...) {
+            free(record);
+            throw;
+        }
+        free(record);
+    } catch (...) {
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    releaseBlock(itr, isMigrate);
+    pthread_mutex_unlock(&m_lock);
+    return (block);
+}
+
+namespace {
+    struct LogRead {
+        int index;
+        uint32_t segment;
+        int64_t offset;
+    };
+
+    bool logOrder(const LogRead &a, const LogRead &b) {
+        if (a.segment != b.segment) {
+            return (a.segment < b.segment);
+        }
+        return (a.offset < b.offset);
+    }
+}
+
+void LogAntiCacheDB::readBlocks(const std::vector<uint32_t> &blockIds, bool isMigrate,
+                                std::vector<AntiCacheBlock*> &blocks) {
+    const int numBlocks = (int)blockIds.size();
+    pthread_mutex_lock(&m_lock);
+
+    // fail before any block has been taken out of the database
+    std::vector<LogRead> reads(numBlocks);
+    for (int i = 0; i < numBlocks; i++) {
+        std::map<uint32_t, LogEntry>::iterator itr = m_directory.find(blockIds[i]);
+        if (itr == m_directory.end()) {
+            pthread_mutex_unlock(&m_lock);
+            VOLT_ERROR("Invalid anti-cache blockId '%u'", blockIds[i]);
+            throw UnknownBlockAccessException(blockIds[i]);
+        }
+        reads[i].index = i;
+        reads[i].segment = itr->second.segment->id;
+        reads[i].offset = itr->second.offset;
+    }
+    std::sort(reads.begin(), reads.end(), logOrder);
+
+    // one read for every run of blocks that lie back to back in a segment
+    std::vector<AntiCacheBlock*> result(numBlocks, (AntiCacheBlock*)NULL);
+    int runs = 0;
+    try {
+        int first = 0;
+        while (first < numBlocks) {
+            const LogEntry &start = m_directory[blockIds[reads[first].index]];
+            int64_t end = start.offset + alignUp(start.length);
+            int last = first + 1;
+            while (last < numBlocks && reads[last].segment == reads[first].segment &&
+                   reads[last].offset == end) {
+                end += alignUp(m_directory[blockIds[reads[last].index]].length);
+                last++;
+            }
+
+            char *extent = readExtent(start.segment, start.offset, end - start.offset);
+            try {
+                for (int i = first; i < last; i++) {
+                    const int index = reads[i].index;
+                    result[index] = parseRecord(blockIds[index], extent + (reads[i].offset - start.offset));
+                }
+            } catch (...) {
+                free(extent);
+                throw;
+            }
+            free(extent);
+            runs++;
+            first = last;
+        } // WHILE
+    } catch (...) {
+        for (int i = 0; i < numBlocks; i++) {
+            delete result[i];
+        }
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    VOLT_DEBUG("Read %d anti-cache blocks from the log with %d reads", numBlocks, runs);
+
+    for (int i = 0; i < numBlocks; i++) {
+        std::map<uint32_t, LogEntry>::iterator itr = m_directory.find(blockIds[i]);
+        if (itr != m_directory.end()) {
+            releaseBlock(itr, isMigrate);
+        }
+        blocks.push_back(result[i]);
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void LogAntiCacheDB::releaseBlock(std::map<uint32_t, LogEntry>::iterator itr, bool isMigrate) {
+    const uint32_t blockId = itr->first;
+    LogSegment *segment = itr->second.segment;
+    const int32_t length = itr->second.length;
+
+    if (!isBlockMerge() && !isMigrate) {
+        if (m_executorContext == NULL || m_executorContext->getAntiCacheLevels() > 1)
+            if (rand() % 100 == 0) {
+                removeBlockLRU(blockId);
+                pushBlockLRU(blockId);
+            }
+        return;
+    }
+
+    // the record stays in its segment until the cleaner gets to it
+    m_directory.erase(itr);
+    segment->liveBlocks.erase(blockId);
+
+    if (isBlockMerge()) {
+        if (m_executorContext == NULL || m_executorContext->getAntiCacheLevels() > 1)
+            removeBlockLRU(blockId);
+        else
+            m_totalBlocks--;
+
+        m_bytesUnevicted += length;
+        m_blocksUnevicted++;
+    } else {
+        removeBlockLRU(blockId);
+
+        if ((m_blocksEvicted - m_blocksUnevicted) != 0)
+            m_bytesUnevicted += m_bytesEvicted / (m_blocksEvicted - m_blocksUnevicted);
+        m_blocksUnevicted++;
+    }
+
+    if (segment != m_activeSegment) {
+        if (segment->liveBlocks.empty()) {
+            dropSegment(segment);
+        } else if (isCleanable(segment)) {
+            pthread_cond_signal(&m_cleanable);
+        }
+    }
+}
+
+LogAntiCacheDB::LogSegment* LogAntiCacheDB::findCleanableSegment() {
+    for (std::map<uint32_t, LogSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+        LogSegment *segment = it->second;
+        if (segment != m_activeSegment && isCleanable(segment)) {
+            return (segment);
+        }
+    }
+    return (NULL);
+}
+
+bool LogAntiCacheDB::relocateBlock() {
+    LogSegment *segment = findCleanableSegment();
+    if (segment == NULL) {
+        return (false);
+    }
+    const uint32_t blockId = *segment->liveBlocks.begin();
+    LogEntry &entry = m_directory[blockId];
+    assert(entry.segment == segment);
+
+    char *record = readExtent(segment, entry.offset, alignUp(entry.length));
+    LogRecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    if (header.magic != RECORD_MAGIC || header.blockId != blockId) {
+        free(record);
+        throwFatalException("Corrupt anti-cache log record for block %u", blockId);
+    }
+    const std::string tableName(record + sizeof(header), header.nameLength);
+    LogEntry moved;
+    try {
+        append(blockId, tableName, record + sizeof(header) + header.nameLength, header.dataLength, moved);
+    } catch (...) {
+        free(record);
+        throw;
+    }
+    free(record);
+
+    entry = moved;
+    segment->liveBlocks.erase(blockId);
+    VOLT_DEBUG("Moved anti-cache block %u from log segment %u to %u",
+               blockId, segment->id, moved.segment->id);
+    if (segment->liveBlocks.empty()) {
+        VOLT_DEBUG("Cleaned anti-cache log segment %u", segment->id);
+        dropSegment(segment);
+    }
+    return (true);
+}
+
+void LogAntiCacheDB::cleanSegments() {
+    pthread_mutex_lock(&m_lock);
+    try {
+        while (relocateBlock());
+    } catch (...) {
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void* LogAntiCacheDB::runCleaner(void *arg) {
+    static_cast<LogAntiCacheDB*>(arg)->cleanLoop();
+    return NULL;
+}
+
+void LogAntiCacheDB::cleanLoop() {
+    pthread_mutex_lock(&m_lock);
+    while (!m_stopping) {
+        bool moved = false;
+        try {
+            moved = relocateBlock();
+        } catch (SerializableEEException &e) {
+            VOLT_ERROR("Failed to clean the anti-cache log in %s: %s", m_dbDir.c_str(), e.message().c_str());
+        } catch (...) {
+            VOLT_ERROR("Failed to clean the anti-cache log in %s", m_dbDir.c_str());
+        }
+        if (moved) {
+            // let the EE in between two blocks
+            pthread_mutex_unlock(&m_lock);
+            pthread_mutex_lock(&m_lock);
+        } else {
+            pthread_cond_wait(&m_cleanable, &m_lock);
+        }
+    } // WHILE
+    pthread_mutex_unlock(&m_lock);
+}
+
+int LogAntiCacheDB::getNumSegments() {
+    pthread_mutex_lock(&m_lock);
+    int segments = (int)m_segments.size();
+    pthread_mutex_unlock(&m_lock);
+    return (segments);
+}
+
+int64_t LogAntiCacheDB::getLogSize() {
+    pthread_mutex_lock(&m_lock);
+    int64_t size = 0;
+    for (std::map<uint32_t, LogSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+        size += it->second->size;
+    }
+    pthread_mutex_unlock(&m_lock);
+    return (size);
+}
+
+}
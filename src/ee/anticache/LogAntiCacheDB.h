@@ -0,0 +1,215 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LOGHSTOREANTICACHE_H
+#define LOGHSTOREANTICACHE_H
+
+#include "common/types.h"
+#include "common/debuglog.h"
+#include "anticache/AntiCacheDB.h"
+
+#include <pthread.h>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+namespace voltdb {
+
+class ExecutorContext;
+class AntiCacheDB;
+
+class LogAntiCacheBlock : public AntiCacheBlock {
+    friend class LogAntiCacheDB;
+
+    public:
+        ~LogAntiCacheBlock();
+
+    private:
+        LogAntiCacheBlock(uint32_t blockId, const std::string &tableName, const char* data, long size);
+}; // CLASS
+
+/**
+ * Anti-cache database that appends the evicted blocks to a log of segment
+ * files, written and read with O_DIRECT. An in-memory directory maps every
+ * block to its place in the log. Reading a block out of the database only
+ * updates the directory; a cleaner thread later copies the blocks that are
+ * still live out of the segments that have lost most of theirs, and then
+ * deletes those segments.
+ */
+class LogAntiCacheDB : public AntiCacheDB {
+    public:
+        LogAntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSize, long maxSize);
+        ~LogAntiCacheDB();
+
+        void initializeDB();
+
+        inline uint32_t nextBlockId() {
+            return m_nextBlockId++;
+        }
+
+        AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate);
+
+        /**
+         * Read the given (distinct) blocks with one read per run of blocks
+         * that lie next to each other in the log
+         */
+        void readBlocks(const std::vector<uint32_t> &blockIds, bool isMigrate,
+                        std::vector<AntiCacheBlock*> &blocks);
+
+        void shutdownDB();
+
+        void flushBlocks();
+
+        void writeBlock(const std::string tableName,
+                        uint32_t blockId,
+                        const int tupleCount,
+                        const char* data,
+                        const long size,
+                        const int evictedTupleCount);
+
+        bool validateBlock(uint32_t blockId);
+
+        /**
+         * Clean every segment that is due, right now
+         */
+        void cleanSegments();
+
+        /**
+         * Return the number of segment files in the log
+         */
+        int getNumSegments();
+
+        /**
+         * Return the number of bytes the log takes up on disk
+         */
+        int64_t getLogSize();
+
+        /**
+         * Return whether the segments are written with O_DIRECT. It is not
+         * supported by every file system (e.g. tmpfs).
+         */
+        inline bool isDirectIO() const {
+            return m_directIO;
+        }
+
+        /**
+         * O_DIRECT needs the offset, length and buffer of every read and
+         * write aligned to the logical block size of the device
+         */
+        static const int IO_ALIGNMENT = 4096;
+
+        /**
+         * Blocks per segment
+         */
+        static const int SEGMENT_BLOCKS = 16;
+
+        /**
+         * A sealed segment is cleaned once less than this percentage of the
+         * blocks written to it are still in the database
+         */
+        static const int CLEAN_LIVE_PERCENT = 50;
+
+    private:
+        struct LogSegment {
+            uint32_t id;
+            int fd;
+            int64_t size;
+            // blocks written to the segment, and those still in the database
+            int32_t writtenBlocks;
+            std::set<uint32_t> liveBlocks;
+        };
+
+        struct LogEntry {
+            LogSegment* segment;
+            int64_t offset;
+            int32_t length;
+        };
+
+        struct LogRecordHeader {
+            uint32_t magic;
+            uint32_t blockId;
+            int32_t nameLength;
+            int32_t dataLength;
+        };
+
+        static const uint32_t RECORD_MAGIC = 0x41434c47;
+
+        static void* runCleaner(void *arg);
+        void cleanLoop();
+
+        /**
+         * Copy one live block out of a segment that is due for cleaning.
+         * Returns false if there is nothing to clean.
+         */
+        bool relocateBlock();
+        LogSegment* findCleanableSegment();
+
+        void append(uint32_t blockId, const std::string &tableName,
+                    const char* data, long size, LogEntry &entry);
+        void openSegment();
+        void dropSegment(LogSegment *segment);
+        std::string segmentFileName(uint32_t id);
+
+        char* readExtent(LogSegment *segment, int64_t offset, int64_t length);
+        AntiCacheBlock* parseRecord(uint32_t blockId, const char* record);
+
+        /**
+         * Update the directory, the LRU and the stats for a block that has
+         * been read, which may take it out of the database
+         */
+        void releaseBlock(std::map<uint32_t, LogEntry>::iterator itr, bool isMigrate);
+
+        inline static bool isCleanable(const LogSegment *segment) {
+            return ((int64_t)segment->liveBlocks.size() * 100 <
+                    (int64_t)segment->writtenBlocks * CLEAN_LIVE_PERCENT);
+        }
+
+        inline static int64_t alignUp(int64_t size) {
+            return (size + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT;
+        }
+
+        bool m_directIO;
+        int m_partition;
+        int64_t m_segmentSize;
+
+        std::map<uint32_t, LogEntry> m_directory;
+        std::map<uint32_t, LogSegment*> m_segments;
+        LogSegment* m_activeSegment;
+        uint32_t m_nextSegmentId;
+
+        /**
+         * Serializes the database calls and the cleaner thread
+         */
+        pthread_mutex_t m_lock;
+        pthread_cond_t m_cleanable;
+        pthread_t m_cleaner;
+        bool m_stopping;
+        bool m_shutdown;
+};
+
+}
+#endif
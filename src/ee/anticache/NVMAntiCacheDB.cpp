@@ -88,6 +88,8 @@ NVMAntiCacheDB::NVMAntiCacheDB(ExecutorContext *ctx, std::string db_dir, long bl
 }
 
 NVMAntiCacheDB::~NVMAntiCacheDB() {
+    // write out the queued blocks first
+    setAsyncWrites(0);
     shutdownDB();
 }
 
@@ -237,7 +239,6 @@ void NVMAntiCacheDB::writeBlock(const std::string tableName,
     }
 
     m_blockMap.insert(std::pair<uint32_t, std::pair<int, int32_t> >(blockId, std::pair<uint32_t, int32_t>(index, static_cast<int32_t>(bufsize))));
-    m_monoBlockID++;
     
     if (m_executorContext == NULL || m_executorContext->getAntiCacheLevels() > 1)
         pushBlockLRU(blockId);
@@ -58,7 +58,9 @@ class NVMAntiCacheDB : public AntiCacheDB {
 
         inline uint32_t nextBlockId() {
             //return (int16_t)getFreeNVMBlockIndex(); 
-            return m_monoBlockID;
+            // handed out here rather than in writeBlock(), which may run
+            // after the next block has been built
+            return m_monoBlockID++;
            
         }
 
@@ -68,7 +68,7 @@ class NVMEvictedTable : public PersistentTable {
                 throwFatalException("Failed to map file.");
             }
 
-            m_data.push_back(memory);
+            addBlock(memory);
 
 
             m_allocatedTuples += m_tuplesPerBlock;
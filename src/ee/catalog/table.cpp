@@ -48,6 +48,7 @@ Table::Table(Catalog *catalog, CatalogType *parent, const string &path, const st
     m_fields["mapreduce"] = value;
     m_fields["evictable"] = value;
     m_fields["batchEvicted"] = value;
+    m_fields["columnar"] = value;
 }
 
 Table::~Table() {
@@ -90,6 +91,7 @@ void Table::update() {
     m_mapreduce = m_fields["mapreduce"].intValue;
     m_evictable = m_fields["evictable"].intValue;
     m_batchEvicted = m_fields["batchEvicted"].intValue;
+    m_columnar = m_fields["columnar"].intValue;
 }
 
 CatalogType * Table::addChild(const std::string &collectionName, const std::string &childName) {
@@ -197,3 +199,7 @@ bool Table::batchEvicted() const {
     return m_batchEvicted;
 }
 
+bool Table::columnar() const {
+    return m_columnar;
+}
+
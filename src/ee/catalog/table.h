@@ -53,6 +53,7 @@ protected:
     bool m_mapreduce;
     bool m_evictable;
     bool m_batchEvicted;
+    bool m_columnar;
 
     virtual void update();
 
@@ -87,6 +88,8 @@ public:
     bool evictable() const;
     /** GETTER: Are contents of this table evicted only along with a parent table and not by itself? */
     bool batchEvicted() const;
+    /** GETTER: Should this table keep a columnar (PAX) copy of its numeric columns for scans? */
+    bool columnar() const;
 };
 
 } // namespace catalog
@@ -0,0 +1,202 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "common/BlockAllocator.h"
+#include "common/debuglog.h"
+#include "common/FatalException.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef LINUX
+#include <sys/syscall.h>
+#endif
+
+// numaif.h is not always installed, so mbind() is called directly
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+using namespace voltdb;
+
+BlockAllocator* BlockAllocator::getDefault() {
+#ifdef STORAGE_HUGEPAGES
+    static BlockAllocator *allocator = new HugePageBlockAllocator();
+#else
+    static BlockAllocator *allocator = new HeapBlockAllocator();
+#endif
+    return (allocator);
+}
+
+HugePageBlockAllocator::HugePageBlockAllocator(bool explicitHugePages, int numaNode) :
+    m_explicitHugePages(explicitHugePages), m_numaNode(numaNode),
+    m_hugePages(0), m_transparentHugePages(0), m_smallPageBytes(0),
+    m_hugePageFailures(0), m_numaBindFailures(0)
+{
+    pthread_mutex_init(&m_lock, NULL);
+}
+
+HugePageBlockAllocator::~HugePageBlockAllocator() {
+    pthread_mutex_destroy(&m_lock);
+}
+
+int HugePageBlockAllocator::currentNumaNode() {
+#if defined(LINUX) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return -1;
+}
+
+char* HugePageBlockAllocator::mapExplicit(std::size_t length) {
+#ifdef MAP_HUGETLB
+    void *memory = ::mmap(NULL, length, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+        return static_cast<char*>(memory);
+    }
+#endif
+    return NULL;
+}
+
+char* HugePageBlockAllocator::mapAligned(std::size_t length) {
+    // Map one huge page more than needed and trim the ends so that the
+    // block starts on a huge page boundary
+    void *memory = ::mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+    char *start = static_cast<char*>(memory);
+    char *aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(start) + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (aligned > start) {
+        ::munmap(start, aligned - start);
+    }
+    char *end = start + length + HUGE_PAGE_SIZE;
+    if (end > aligned + length) {
+        ::munmap(aligned + length, end - (aligned + length));
+    }
+    return aligned;
+}
+
+void HugePageBlockAllocator::bindToNode(char *block, std::size_t length) {
+    const int node = (m_numaNode >= 0 ? m_numaNode : currentNumaNode());
+    if (node < 0) return;
+#if defined(LINUX) && defined(SYS_mbind)
+    // Before the first touch, so the pages come from that node
+    unsigned long nodemask = 1UL << node;
+    if (node < static_cast<int>(sizeof(nodemask) * 8) &&
+        syscall(SYS_mbind, block, length, MPOL_PREFERRED, &nodemask,
+                sizeof(nodemask) * 8, 0) == 0) {
+        return;
+    }
+#endif
+    __sync_fetch_and_add(&m_numaBindFailures, 1);
+}
+
+char* HugePageBlockAllocator::allocate(std::size_t bytes) {
+    if (bytes < HUGE_PAGE_SIZE) {
+        return new char[bytes];
+    }
+    const std::size_t length = roundUp(bytes);
+
+    PageType type = PAGES_HUGE;
+    char *block = NULL;
+    if (m_explicitHugePages) {
+        block = mapExplicit(length);
+        if (block == NULL) {
+            __sync_fetch_and_add(&m_hugePageFailures, 1);
+        }
+    }
+    if (block == NULL) {
+        block = mapAligned(length);
+        if (block == NULL) {
+            throwFatalException("Failed to map %ld bytes for a storage block: %s",
+                                (long)length, strerror(errno));
+        }
+        type = PAGES_SMALL;
+#ifdef MADV_HUGEPAGE
+        if (::madvise(block, length, MADV_HUGEPAGE) == 0) {
+            type = PAGES_TRANSPARENT_HUGE;
+        }
+#endif
+    }
+    bindToNode(block, length);
+
+    pthread_mutex_lock(&m_lock);
+    m_blocks[block] = type;
+    switch (type) {
+        case PAGES_HUGE:
+            m_hugePages += length / HUGE_PAGE_SIZE;
+            break;
+        case PAGES_TRANSPARENT_HUGE:
+            m_transparentHugePages += length / HUGE_PAGE_SIZE;
+            break;
+        default:
+            m_smallPageBytes += length;
+    }
+    pthread_mutex_unlock(&m_lock);
+    VOLT_DEBUG("Mapped %ld byte block %p with page type %d", (long)length, block, (int)type);
+    return block;
+}
+
+void HugePageBlockAllocator::release(char *block, std::size_t bytes) {
+    if (bytes < HUGE_PAGE_SIZE) {
+        delete[] block;
+        return;
+    }
+    const std::size_t length = roundUp(bytes);
+
+    pthread_mutex_lock(&m_lock);
+    std::map<const char*, PageType>::iterator iter = m_blocks.find(block);
+    assert(iter != m_blocks.end());
+    switch (iter->second) {
+        case PAGES_HUGE:
+            m_hugePages -= length / HUGE_PAGE_SIZE;
+            break;
+        case PAGES_TRANSPARENT_HUGE:
+            m_transparentHugePages -= length / HUGE_PAGE_SIZE;
+            break;
+        default:
+            m_smallPageBytes -= length;
+    }
+    m_blocks.erase(iter);
+    pthread_mutex_unlock(&m_lock);
+    ::munmap(block, length);
+}
+
+BlockAllocator::PageType HugePageBlockAllocator::pageType(const char *block) const {
+    pthread_mutex_lock(&m_lock);
+    std::map<const char*, PageType>::const_iterator iter = m_blocks.find(block);
+    PageType type = (iter == m_blocks.end() ? PAGES_HEAP : iter->second);
+    pthread_mutex_unlock(&m_lock);
+    return type;
+}
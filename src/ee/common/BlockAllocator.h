@@ -0,0 +1,139 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_BLOCKALLOCATOR_H
+#define HSTORE_BLOCKALLOCATOR_H
+
+#include <cstddef>
+#include <map>
+#include <pthread.h>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * Source of the large, long-lived memory blocks behind persistent table
+ * storage and Pool chunks. A block must be released with the size it was
+ * allocated with.
+ */
+class BlockAllocator {
+public:
+    enum PageType {
+        PAGES_HEAP,             // from new[]
+        PAGES_SMALL,            // mapped, regular pages
+        PAGES_TRANSPARENT_HUGE, // mapped, the kernel was asked for huge pages
+        PAGES_HUGE              // mapped from the explicit huge page pool
+    };
+
+    virtual ~BlockAllocator() {}
+
+    virtual char* allocate(std::size_t bytes) = 0;
+    virtual void release(char *block, std::size_t bytes) = 0;
+
+    /** How a block handed out by this allocator is backed */
+    virtual PageType pageType(const char *block) const { return PAGES_HEAP; }
+
+    /**
+     * The allocator for table blocks. Builds with STORAGE_HUGEPAGES use a
+     * HugePageBlockAllocator shared by all partitions of the process.
+     */
+    static BlockAllocator* getDefault();
+};
+
+/**
+ * Plain new[]/delete[]
+ */
+class HeapBlockAllocator : public BlockAllocator {
+public:
+    char* allocate(std::size_t bytes) { return new char[bytes]; }
+    void release(char *block, std::size_t bytes) { delete[] block; }
+};
+
+/**
+ * Backs blocks of at least one huge page (2MB) with huge pages that are
+ * bound to the NUMA node of the allocating thread, which is the node of
+ * the partition's pinned core. It first tries the explicit huge page pool
+ * (MAP_HUGETLB), then transparent huge pages, then regular pages. Smaller
+ * blocks come from the heap.
+ */
+class HugePageBlockAllocator : public BlockAllocator {
+public:
+    static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * @param explicitHugePages whether to try the MAP_HUGETLB pool first
+     * @param numaNode node to bind blocks to, or -1 for the node of the
+     *                 CPU that the allocating thread is running on
+     */
+    HugePageBlockAllocator(bool explicitHugePages = true, int numaNode = -1);
+    ~HugePageBlockAllocator();
+
+    char* allocate(std::size_t bytes);
+    void release(char *block, std::size_t bytes);
+    PageType pageType(const char *block) const;
+
+    // ------------------------------------------------------------------
+    // STATS
+    // ------------------------------------------------------------------
+    /** 2MB pages in use from the explicit huge page pool */
+    int64_t getHugePages() const { return m_hugePages; }
+    /** 2MB pages in use that were advised for transparent huge pages */
+    int64_t getTransparentHugePages() const { return m_transparentHugePages; }
+    /** Bytes in use that were mapped with regular pages */
+    int64_t getSmallPageBytes() const { return m_smallPageBytes; }
+    /** Allocations that wanted explicit huge pages and did not get them */
+    int64_t getHugePageFailures() const { return m_hugePageFailures; }
+    /** Allocations that could not be bound to their NUMA node */
+    int64_t getNumaBindFailures() const { return m_numaBindFailures; }
+
+    /** NUMA node of the CPU the calling thread runs on, or -1 */
+    static int currentNumaNode();
+
+private:
+    static inline std::size_t roundUp(std::size_t bytes) {
+        return ((bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+    }
+
+    char* mapExplicit(std::size_t length);
+    char* mapAligned(std::size_t length);
+    void bindToNode(char *block, std::size_t length);
+
+    bool m_explicitHugePages;
+    const int m_numaNode;
+
+    // page type of every mapped block
+    std::map<const char*, PageType> m_blocks;
+    mutable pthread_mutex_t m_lock;
+
+    int64_t m_hugePages;
+    int64_t m_transparentHugePages;
+    int64_t m_smallPageBytes;
+    int64_t m_hugePageFailures;
+    int64_t m_numaBindFailures;
+};
+
+}
+
+#endif // HSTORE_BLOCKALLOCATOR_H
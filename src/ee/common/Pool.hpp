@@ -28,6 +28,7 @@
 #include "common/debuglog.h"
 #include "common/FatalException.hpp"
 #include "common/MMAPMemoryManager.h"
+#include "common/BlockAllocator.h"
 
 namespace voltdb {
 #ifndef MEMCHECK
@@ -76,7 +77,8 @@ namespace voltdb {
             Pool() :
                 m_allocationSize(65536), m_maxChunkCount(1), m_currentChunkIndex(0),
                 m_enableMMAP(false),
-                m_pool_manager(NULL)
+                m_pool_manager(NULL),
+                m_blockAllocator(NULL)
         {
             VOLT_TRACE("MALLOC Pool Storage Request :: %d %d ",static_cast<int>(m_allocationSize), static_cast<int>(m_maxChunkCount));
 
@@ -89,19 +91,37 @@ namespace voltdb {
                 m_maxChunkCount(static_cast<std::size_t>(maxChunkCount)),
                 m_currentChunkIndex(0),
                 m_enableMMAP(false),
-                m_pool_manager(NULL)
+                m_pool_manager(NULL),
+                m_blockAllocator(NULL)
         {
             char *storage = new char[allocationSize];
             m_chunks.push_back(Chunk(allocationSize, storage));
         }
 
+            /**
+             * Chunks come from the given allocator, e.g. to back a large
+             * pool with huge pages
+             */
+            Pool(uint64_t allocationSize, uint64_t maxChunkCount, BlockAllocator *blockAllocator) :
+                m_allocationSize(allocationSize),
+                m_maxChunkCount(static_cast<std::size_t>(maxChunkCount)),
+                m_currentChunkIndex(0),
+                m_enableMMAP(false),
+                m_pool_manager(NULL),
+                m_blockAllocator(blockAllocator)
+        {
+            char *storage = allocateChunk(static_cast<std::size_t>(allocationSize));
+            m_chunks.push_back(Chunk(allocationSize, storage));
+        }
+
             Pool(uint64_t allocationSize, uint64_t maxChunkCount, std::string fileName, bool enableMMAP) :
                 m_allocationSize(allocationSize),
                 m_maxChunkCount(static_cast<std::size_t>(maxChunkCount)),
                 m_currentChunkIndex(0),
                 m_enableMMAP(enableMMAP),
                 m_name(fileName),
-                m_pool_manager(NULL)
+                m_pool_manager(NULL),
+                m_blockAllocator(NULL)
         {
 
 
@@ -130,10 +150,10 @@ namespace voltdb {
             ~Pool() {
                 if(m_enableMMAP == false){
                     for (std::size_t ii = 0; ii < m_chunks.size(); ii++) {
-                        delete [] m_chunks[ii].m_chunkData;
+                        releaseChunk(m_chunks[ii]);
                     }
                     for (std::size_t ii = 0; ii < m_oversizeChunks.size(); ii++) {
-                        delete [] m_oversizeChunks[ii].m_chunkData;
+                        releaseChunk(m_oversizeChunks[ii]);
                     }
                 }
                 /**
@@ -159,7 +179,7 @@ namespace voltdb {
                          * Allocate an oversize chunk that will not be reused.
                          */
                         if(m_enableMMAP == false){
-                            char *storage = new char[size];
+                            char *storage = allocateChunk(size);
                             m_oversizeChunks.push_back(Chunk(size, storage));
                         }
                         else{
@@ -171,7 +191,7 @@ namespace voltdb {
                             m_oversizeChunks.push_back(Chunk(size, memory));
                         }
 
-                        Chunk *newChunk = &(*(m_oversizeChunks.end()));
+                        Chunk *newChunk = &m_oversizeChunks.back();
                         newChunk->m_offset = size;
                         return newChunk->m_chunkData;
                     }
@@ -193,7 +213,7 @@ namespace voltdb {
                         //                  "into structuring our pool sizes and allocations so the this doesn't "
                         //                  "happen frequently" << std::endl;
                         if(m_enableMMAP == false){
-                            char *storage = new char[m_allocationSize];
+                            char *storage = allocateChunk(static_cast<std::size_t>(m_allocationSize));
                             m_chunks.push_back(Chunk(m_allocationSize, storage));
                         }
                         else{
@@ -234,7 +254,7 @@ namespace voltdb {
                 const std::size_t numOversizeChunks = m_oversizeChunks.size();
                 for (std::size_t ii = 0; ii < numOversizeChunks; ii++) {
                     if(m_enableMMAP == false){
-                        delete [] m_oversizeChunks[ii].m_chunkData;
+                        releaseChunk(m_oversizeChunks[ii]);
                     }
                     /**
                      * MMAP'ed pool will be cleaned up by its own destructor
@@ -253,8 +273,8 @@ namespace voltdb {
                  */
                 if (numChunks > m_maxChunkCount) {
                     for (std::size_t ii = m_maxChunkCount; ii < numChunks; ii++) {
-                        if(m_enableMMAP){
-                            delete []m_chunks[ii].m_chunkData;
+                        if(m_enableMMAP == false){
+                            releaseChunk(m_chunks[ii]);
                         }
                         /**
                          * MMAP'ed pool will be cleaned up by its own destructor
@@ -274,6 +294,21 @@ namespace voltdb {
             }
 
         private:
+            inline char* allocateChunk(std::size_t size) {
+                if (m_blockAllocator != NULL) {
+                    return m_blockAllocator->allocate(size);
+                }
+                return new char[size];
+            }
+
+            inline void releaseChunk(const Chunk &chunk) {
+                if (m_blockAllocator != NULL) {
+                    m_blockAllocator->release(chunk.m_chunkData, static_cast<std::size_t>(chunk.m_size));
+                } else {
+                    delete [] chunk.m_chunkData;
+                }
+            }
+
             const uint64_t m_allocationSize;
             std::size_t m_maxChunkCount;
             std::size_t m_currentChunkIndex;
@@ -290,6 +325,9 @@ namespace voltdb {
             std::string m_name ;
             MMAPMemoryManager* m_pool_manager;
 
+            /** Source of the chunks, or NULL for new[] */
+            BlockAllocator *m_blockAllocator;
+
             // No implicit copies
             Pool(const Pool&);
             Pool& operator=(const Pool&);
@@ -308,6 +346,10 @@ namespace voltdb {
             {
             }
 
+            Pool(uint64_t allocationSize, uint64_t maxChunkCount, BlockAllocator *blockAllocator)
+            {
+            }
+
             ~Pool() {
                 for (std::size_t ii = 0; ii < m_allocations.size(); ii++) {
                     delete [] m_allocations[ii];
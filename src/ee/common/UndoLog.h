@@ -41,6 +41,13 @@ namespace voltdb
          */
         void clear();
 
+        /**
+         * Number of undo quantums that have been neither undone nor released
+         */
+        inline size_t getSize() const {
+            return m_undoQuantums.size();
+        }
+
         inline UndoQuantum* generateUndoQuantum(int64_t nextUndoToken) {
             VOLT_TRACE("Generating token %ld / lastUndo:%ld / lastRelease:%ld / undoQuantums:%ld",
                        (long int)nextUndoToken, (long int)m_lastUndoToken, (long int)m_lastReleaseToken, (long int)m_undoQuantums.size());
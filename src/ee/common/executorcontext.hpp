@@ -27,12 +27,17 @@
 #include "anticache/BerkeleyAntiCacheDB.h"
 #include "anticache/NVMAntiCacheDB.h"
 #include "anticache/AllocatorNVMAntiCacheDB.h"
+#include "anticache/LogAntiCacheDB.h"
 #include "anticache/AntiCacheEvictionManager.h"
 #include "execution/VoltDBEngine.h"
 #define MAX_LEVELS 5
 
 #endif
 
+// tuples that a fragment has to scan before it is worth splitting across
+// threads, when parallel scans are enabled
+#define PARALLEL_SCAN_MIN_TUPLES 1000000
+
 namespace voltdb {
     
     class ReadWriteTrackerManager;
@@ -86,8 +91,11 @@ namespace voltdb {
             m_MMAPEnabled = false;
             m_ARIESEnabled = false;
             m_antiCacheDBs = 0;
+            m_parallelScanThreads = 1;
+            m_parallelScanMinTuples = PARALLEL_SCAN_MIN_TUPLES;
             #ifdef ANTICACHE
             m_antiCacheEvictionManager = NULL;
+            m_antiCacheWriteQueueSize = 0;
             #endif
 
         }
@@ -265,12 +273,15 @@ namespace voltdb {
          * The input parameter is the directory where our disk-based storage
          * will write out evicted blocks of tuples for this partition
          */
-        void enableAntiCache(const VoltDBEngine *engine, std::string &dbDir, long blockSize, AntiCacheDBType dbType, bool blocking, long maxSize, bool blockMerge) {
+        void enableAntiCache(const VoltDBEngine *engine, std::string &dbDir, long blockSize, AntiCacheDBType dbType, bool blocking, long maxSize, bool blockMerge,
+                             int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) {
             assert(m_antiCacheEnabled == false);
             m_antiCacheEnabled = true;
             m_levels = 0;
             m_blockMergeSystem = blockMerge;
+            m_antiCacheWriteQueueSize = maxQueuedBlocks;
             m_antiCacheEvictionManager = new AntiCacheEvictionManager(engine);
+            m_antiCacheEvictionManager->setCompression(codecType, dictionaryBlocks);
             addAntiCacheDB(dbDir, blockSize, dbType, blocking, maxSize, blockMerge);
         }
 
@@ -287,16 +298,20 @@ namespace voltdb {
             } else if (dbType == ANTICACHEDB_ALLOCATORNVM) {
                 m_antiCacheDB[m_levels] = new AllocatorNVMAntiCacheDB(this, dbDir, blockSize, maxSize);
                 //m_antiCacheEvictionManager->addAntiCacheDB(new NVMAntiCacheDB(this, dbDir, blockSize, maxSize));
+            } else if (dbType == ANTICACHEDB_LOG) {
+                m_antiCacheDB[m_levels] = new LogAntiCacheDB(this, dbDir, blockSize, maxSize);
             } else {
                 VOLT_ERROR("Invalid AntiCacheDBType: %d! Aborting...", (int)dbType);
                 assert(m_antiCacheEnabled == false);
             }  
             m_antiCacheDB[m_levels]->setBlocking(blocking);
             m_antiCacheDB[m_levels]->setBlockMerge(blockMerge);
+            m_antiCacheDB[m_levels]->setAsyncWrites(m_antiCacheWriteQueueSize);
             m_blockMerge[m_levels] = blockMerge;
             m_antiCacheEvictionManager->addAntiCacheDB(m_antiCacheDB[m_levels]);
             m_levels++;
         }
+
         #endif
 
         // ------------------------------------------------------------------
@@ -365,6 +380,30 @@ namespace voltdb {
             m_trackingManager = new ReadWriteTrackerManager(this);
         }
 
+        // ------------------------------------------------------------------
+        // PARALLEL SCANS
+        // ------------------------------------------------------------------
+
+        /**
+         * Let read-only fragments that scan and aggregate at least minTuples
+         * tuples split the scan across the given number of threads (the
+         * partition's own thread included). One thread, the default, keeps
+         * every fragment single-threaded.
+         */
+        void setParallelScans(int threads, int64_t minTuples) {
+            assert(threads >= 1);
+            m_parallelScanThreads = threads;
+            m_parallelScanMinTuples = minTuples;
+        }
+
+        inline int getParallelScanThreads() const {
+            return (m_parallelScanThreads);
+        }
+
+        inline int64_t getParallelScanMinTuples() const {
+            return (m_parallelScanMinTuples);
+        }
+
     private:
         Topend *m_topEnd;
         UndoQuantum *m_undoQuantum;
@@ -377,6 +416,8 @@ namespace voltdb {
         int16_t m_levels;
         bool m_blockMerge[MAX_LEVELS];
         bool m_blockMergeSystem;
+        // blocks that may wait for the writer thread of each level
+        int m_antiCacheWriteQueueSize;
         #endif
 
         #ifdef STORAGE_MMAP
@@ -392,6 +433,10 @@ namespace voltdb {
         bool m_trackingEnabled;
         ReadWriteTrackerManager *m_trackingManager;
 
+        /** Parallel Scans */
+        int m_parallelScanThreads;
+        int64_t m_parallelScanMinTuples;
+
     public:
         int64_t m_lastCommittedTxnId;
         int64_t m_lastTickTime;
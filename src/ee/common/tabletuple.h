@@ -84,10 +84,17 @@ namespace voltdb {
  |  flags (1 byte)  |  time stamp (4 bytes) | tuple data  |
  ----------------------------------------------------------
 
+ (e). Anti-Caching with CLOCK (the reference bits are kept by the table)
+ -----------------------------------
+ |  flags (1 byte)  |  tuple data  |
+ -----------------------------------
+
  */
 
 #ifdef ANTICACHE
-    #ifdef ANTICACHE_TIMESTAMPS
+    #if defined(ANTICACHE_CLOCK)
+        #define TUPLE_HEADER_SIZE 1
+    #elif defined(ANTICACHE_TIMESTAMPS)
     	#define TUPLE_HEADER_SIZE 5
     #else
     	#ifdef ANTICACHE_REVERSIBLE_LRU
@@ -303,7 +310,7 @@ public:
     }
     
 #ifdef ANTICACHE
-	#ifndef ANTICACHE_TIMESTAMPS
+	#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     	inline uint32_t getNextTupleInChain() {
         	uint32_t tuple_id = 0;
 	        memcpy(&tuple_id, m_data+TUPLE_HEADER_SIZE-4, 4);
@@ -326,7 +333,7 @@ public:
         	memcpy(m_data+TUPLE_HEADER_SIZE-8, &prev, 4);
     	}
 
-	#else
+	#elif defined(ANTICACHE_TIMESTAMPS)
     	inline uint32_t getTimeStamp() {
         	uint32_t time_stamp = 0;
 	        memcpy(&time_stamp, m_data+TUPLE_HEADER_SIZE-4, 4);
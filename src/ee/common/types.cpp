@@ -247,6 +247,44 @@ JoinType stringToJoin(string str )
     return JOIN_TYPE_INVALID;
 }
 
+string unionToString(UnionType type)
+{
+    switch (type) {
+    case UNION_TYPE_INVALID: {
+        return "INVALID";
+    }
+    case UNION_TYPE_UNION: {
+        return "UNION";
+    }
+    case UNION_TYPE_UNION_ALL: {
+        return "UNION_ALL";
+    }
+    case UNION_TYPE_INTERSECT: {
+        return "INTERSECT";
+    }
+    case UNION_TYPE_EXCEPT: {
+        return "EXCEPT";
+    }
+    }
+    return "INVALID";
+}
+
+UnionType stringToUnion(string str )
+{
+    if (str == "INVALID") {
+        return UNION_TYPE_INVALID;
+    } else if (str == "UNION") {
+        return UNION_TYPE_UNION;
+    } else if (str == "UNION_ALL") {
+        return UNION_TYPE_UNION_ALL;
+    } else if (str == "INTERSECT") {
+        return UNION_TYPE_INTERSECT;
+    } else if (str == "EXCEPT") {
+        return UNION_TYPE_EXCEPT;
+    }
+    return UNION_TYPE_INVALID;
+}
+
 string sortDirectionToString(SortDirectionType type)
 {
     switch (type) {
@@ -293,6 +331,9 @@ string planNodeToString(PlanNodeType type)
     case PLAN_NODE_TYPE_NESTLOOPINDEX: {
         return "NESTLOOPINDEX";
     }
+    case PLAN_NODE_TYPE_HASHJOIN: {
+        return "HASHJOIN";
+    }
     case PLAN_NODE_TYPE_UPDATE: {
         return "UPDATE";
     }
@@ -351,6 +392,8 @@ PlanNodeType stringToPlanNode(string str )
         return PLAN_NODE_TYPE_NESTLOOP;
     } else if (str == "NESTLOOPINDEX") {
         return PLAN_NODE_TYPE_NESTLOOPINDEX;
+    } else if (str == "HASHJOIN") {
+        return PLAN_NODE_TYPE_HASHJOIN;
     } else if (str == "UPDATE") {
         return PLAN_NODE_TYPE_UPDATE;
     } else if (str == "INSERT") {
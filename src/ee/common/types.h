@@ -125,6 +125,17 @@ enum JoinType {
     JOIN_TYPE_RIGHT         = 4,
 };
 
+// ------------------------------------------------------------------
+// Union Type
+// ------------------------------------------------------------------
+enum UnionType {
+    UNION_TYPE_INVALID      = 0,
+    UNION_TYPE_UNION        = 1,
+    UNION_TYPE_UNION_ALL    = 2,
+    UNION_TYPE_INTERSECT    = 3,
+    UNION_TYPE_EXCEPT       = 4,
+};
+
 // ------------------------------------------------------------------
 // Constraint Type
 // ------------------------------------------------------------------
@@ -163,6 +174,7 @@ enum PlanNodeType {
     //
     PLAN_NODE_TYPE_NESTLOOP         = 20,
     PLAN_NODE_TYPE_NESTLOOPINDEX    = 21,
+    PLAN_NODE_TYPE_HASHJOIN         = 22,
 
     //
     // Operator Nodes
@@ -283,6 +295,7 @@ enum TableIndexType {
     BALANCED_TREE_INDEX     = 1,
     HASH_TABLE_INDEX        = 2,
     ARRAY_INDEX             = 3,
+    RADIX_TREE_INDEX        = 5,
 };
 
 // ------------------------------------------------------------------
@@ -365,7 +378,25 @@ enum AntiCacheDBType {
     /*
      * NVM allocator-based store
      */
-    ANTICACHEDB_ALLOCATORNVM = 3
+    ANTICACHEDB_ALLOCATORNVM = 3,
+    /*
+     * Log-structured store of segment files
+     */
+    ANTICACHEDB_LOG = 4
+};
+
+// -----------------------------------------------------------------
+// AntiCache Block Codecs
+// -----------------------------------------------------------------
+enum AntiCacheCodecType {
+    /*
+     * Blocks are written as they are serialized
+     */
+    ANTICACHE_CODEC_NONE = 0,
+    /*
+     * Byte-oriented LZ77 (LZ4-style sequences)
+     */
+    ANTICACHE_CODEC_LZ = 1
 };
 
 // ------------------------------------------------------------------
@@ -383,6 +414,9 @@ ValueType stringToValue(std::string str );
 std::string joinToString(JoinType type);
 JoinType stringToJoin(std::string str );
 
+std::string unionToString(UnionType type);
+UnionType stringToUnion(std::string str );
+
 std::string sortDirectionToString(SortDirectionType type);
 SortDirectionType stringToSortDirection(std::string str );
 
@@ -136,6 +136,7 @@ VoltDBEngine::VoltDBEngine(Topend *topend, LogProxy *logProxy) :
 
     // init the number of planfragments executed
     m_pfCount = 0;
+    m_fragmentCompileThreshold = FRAGMENT_COMPILE_THRESHOLD;
 
     // require a site id, at least, to inititalize.
     m_executorContext = NULL;
@@ -328,6 +329,13 @@ int VoltDBEngine::executeQuery(int64_t planfragmentId,
     assert(iter != m_executorMap.end());
     boost::shared_ptr<ExecutorVector> execsForFrag = iter->second;
 
+    // Compile the executors once the fragment has turned out to be hot
+    ++execsForFrag->invocations;
+    if (!execsForFrag->compiled && m_fragmentCompileThreshold >= 0 &&
+        execsForFrag->invocations >= m_fragmentCompileThreshold) {
+        compilePlanFragment(planfragmentId, *execsForFrag);
+    }
+
     // Read/Write Set Tracking
     ReadWriteTracker *tracker = NULL;
     if (m_executorContext->isTrackingEnabled()) {
@@ -372,6 +380,10 @@ int VoltDBEngine::executeQuery(int64_t planfragmentId,
         AbstractExecutor *executor = execsForFrag->list[ctr];
         assert(executor);
 
+        // A pipelined executor runs inside of its parent
+        if (executor->isPipelined())
+            continue;
+
         if (executor->needsPostExecuteClear())
             cleanUpTable =
                     dynamic_cast<Table*>(executor->getPlanNode()->getOutputTable());
@@ -987,6 +999,8 @@ bool VoltDBEngine::initPlanFragment(const int64_t fragId,
     boost::shared_ptr<ExecutorVector> ev = boost::shared_ptr<ExecutorVector>(
             new ExecutorVector());
     ev->tempTableMemoryInBytes = 0;
+    ev->invocations = 0;
+    ev->compiled = false;
 
 
     // Initialize each node!
@@ -1007,11 +1021,62 @@ bool VoltDBEngine::initPlanFragment(const int64_t fragId,
             ctr++) {
         ev->list.push_back(pnf->getExecuteList()[ctr]->getExecutor());
     }
+
+    // Let executors pull their input straight from the children that can
+    // produce it on demand, so that those never fill their output tables
+    for (int ctr = 0, cnt = (int) ev->list.size(); ctr < cnt; ctr++) {
+        ev->list[ctr]->initPipelines();
+    }
+    if (m_fragmentCompileThreshold == 0) {
+        compilePlanFragment(fragId, *ev);
+    }
     m_executorMap[fragId] = ev;
 
     return true;
 }
 
+void VoltDBEngine::compilePlanFragment(const int64_t fragId, ExecutorVector &ev) {
+    int compiled = 0;
+    for (int ctr = 0, cnt = (int) ev.list.size(); ctr < cnt; ctr++) {
+        if (ev.list[ctr]->compile()) {
+            compiled++;
+        }
+    }
+    ev.compiled = true;
+    VOLT_DEBUG("Compiled %d of %d executors for PlanFragment '%jd' after %jd"
+               " executions", compiled, (int) ev.list.size(), (intmax_t) fragId,
+               (intmax_t) ev.invocations);
+}
+
+void VoltDBEngine::setFragmentCompileThreshold(int64_t threshold) {
+    m_fragmentCompileThreshold = threshold;
+    map<int64_t, boost::shared_ptr<ExecutorVector> >::iterator iter;
+    for (iter = m_executorMap.begin(); iter != m_executorMap.end(); iter++) {
+        ExecutorVector &ev = *(iter->second);
+        if (threshold < 0 && ev.compiled) {
+            for (int ctr = 0, cnt = (int) ev.list.size(); ctr < cnt; ctr++) {
+                ev.list[ctr]->uncompile();
+            }
+            ev.compiled = false;
+        } else if (threshold >= 0 && !ev.compiled && ev.invocations >= threshold) {
+            compilePlanFragment(iter->first, ev);
+        }
+    }
+}
+
+int VoltDBEngine::getCompiledFragmentCount() const {
+    int count = 0;
+    map<int64_t, boost::shared_ptr<ExecutorVector> >::const_iterator iter;
+    for (iter = m_executorMap.begin(); iter != m_executorMap.end(); iter++) {
+        if (iter->second->compiled) count++;
+    }
+    return count;
+}
+
+void VoltDBEngine::setParallelScans(int threads, int64_t minTuples) {
+    m_executorContext->setParallelScans(threads, minTuples);
+}
+
 bool VoltDBEngine::initPlanNode(const int64_t fragId, AbstractPlanNode* node,
         int* tempTableMemoryInBytes) {
     assert(node);
@@ -1196,6 +1261,23 @@ void VoltDBEngine::tick(int64_t timeInMillis, int64_t lastCommittedTxnId) {
     BOOST_FOREACH (TablePair table, m_exportingTables){
     table.second->flushOldTuples(timeInMillis);
 }
+    compactTables(TABLE_COMPACTION_BYTES_PER_TICK);
+}
+
+int64_t VoltDBEngine::compactTables(int64_t maxBytes) {
+    // Undo actions hold on to tuple addresses
+    if (m_undoLog.getSize() > 0) {
+        return 0;
+    }
+    int64_t bytesMoved = 0;
+    typedef pair<int32_t, Table*> TablePair;
+    BOOST_FOREACH (TablePair table, m_tables) {
+        PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(table.second);
+        if (persistentTable == NULL) continue;
+        bytesMoved += persistentTable->compactTuples(maxBytes - bytesMoved);
+        if (bytesMoved >= maxBytes) break;
+    }
+    return bytesMoved;
 }
 
 /** For now, bring the Export system to a steady state with no buffers with content */
@@ -2080,10 +2162,13 @@ int VoltDBEngine::trackingTupleSet(int64_t txnId, bool writes) {
 // -------------------------------------------------
 
 #ifdef ANTICACHE
-void VoltDBEngine::antiCacheInitialize(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge) const {
-    VOLT_INFO("Enabling type %d (blocking: %d/blockMerge: %d) Anti-Cache at Partition %d: dir=%s / blockSize=%ld max=%ld", 
-            (int)dbType, (int)blocking, (int)blockMerge, m_partitionId, dbDir.c_str(), blockSize, maxSize);
-    m_executorContext->enableAntiCache(this, dbDir, blockSize, dbType, blocking, maxSize, blockMerge);
+void VoltDBEngine::antiCacheInitialize(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge,
+                                       int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) const {
+    VOLT_INFO("Enabling type %d (blocking: %d/blockMerge: %d) Anti-Cache at Partition %d: dir=%s / blockSize=%ld max=%ld / queuedBlocks=%d / codec=%d (dictionary after %d blocks)", 
+            (int)dbType, (int)blocking, (int)blockMerge, m_partitionId, dbDir.c_str(), blockSize, maxSize, maxQueuedBlocks,
+            (int)codecType, dictionaryBlocks);
+    m_executorContext->enableAntiCache(this, dbDir, blockSize, dbType, blocking, maxSize, blockMerge, maxQueuedBlocks,
+                                       codecType, dictionaryBlocks);
 }
 
 void VoltDBEngine::antiCacheAddDB(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge) const {
@@ -2120,25 +2205,7 @@ int VoltDBEngine::antiCacheReadBlocks(int32_t tableId, int numBlocks, int32_t bl
     AntiCacheEvictionManager* eviction_manager = m_executorContext->getAntiCacheEvictionManager();
     //std::map <int32_t, set <int32_t> > filter;
     try {
-        for (int i = 0; i < numBlocks; i++) {
-            VOLT_TRACE("inengine: %d", i);
-            /*
-            if (filter.find(blockIds[i]) != filter.end())
-                if (filter[blockIds[i]].find(tupleOffsets[i]) != filter[blockIds[i]].end()) {
-                    VOLT_WARN("skipping %d %d", blockIds[i], tupleOffsets[i]);
-                    continue;
-                }
-
-            (filter[blockIds[i]]).insert(tupleOffsets[i]);
-            */
-            VOLT_DEBUG("reading %d %d", blockIds[i], tupleOffsets[i]);
-            //pthread_mutex_lock(&(eviction_manager->lock));
-            //eviction_manager->prio_lock_low(&eviction_manager->prio_lock);
-            finalResult = eviction_manager->readEvictedBlock(table, blockIds[i], tupleOffsets[i]) && finalResult;
-            //eviction_manager->prio_unlock_low(&eviction_manager->prio_lock);
-            //pthread_mutex_unlock(&(eviction_manager->lock));
-        } // FOR
-
+        finalResult = eviction_manager->readEvictedBlocks(table, numBlocks, blockIds, tupleOffsets);
     } catch (SerializableEEException &e) {
         VOLT_ERROR("antiCacheReadBlocks: Failed to read %d evicted blocks for table '%s'\n%s",
                    numBlocks, table->name().c_str(), e.message().c_str());
@@ -84,6 +84,14 @@
 #define MAX_BATCH_COUNT 1000
 #define MAX_PARAM_COUNT 1000 // or whatever
 
+// bytes of tuple data that tick() may move to compact tables
+#define TABLE_COMPACTION_BYTES_PER_TICK (1024 * 1024)
+
+// executions after which the scan predicates of a plan fragment are
+// compiled, unless the site sets another threshold
+// (site.exec_compile_threshold)
+#define FRAGMENT_COMPILE_THRESHOLD 100
+
 namespace boost {
 template <typename T> class shared_ptr;
 }
@@ -257,6 +265,13 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         /** Perform once per second, non-transactional work. */
         void tick(int64_t timeInMillis, int64_t lastCommittedTxnId);
 
+        /**
+         * Move tuples out of the sparse blocks at the end of the tables,
+         * up to maxBytes in total. Only runs when no transaction has undo
+         * actions that refer to tuples. Returns the number of bytes moved.
+         */
+        int64_t compactTables(int64_t maxBytes);
+
         /** flush active work (like EL buffers) */
         void quiesce(int64_t lastCommittedTxnId);
 
@@ -295,7 +310,15 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         // -------------------------------------------------
         // ANTI-CACHE FUNCTIONS
         // -------------------------------------------------
-        void antiCacheInitialize(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge) const;
+        /**
+         * Enable the anti-cache with its first level. Evicted blocks are
+         * written on a background thread per level, with at most
+         * maxQueuedBlocks blocks waiting. Zero writes them synchronously.
+         * They are compressed with the given codec, with a dictionary per
+         * table trained from its first dictionaryBlocks blocks.
+         */
+        void antiCacheInitialize(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge,
+                                 int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) const;
 
         #ifdef ANTICACHE
         void antiCacheAddDB(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge) const;
@@ -340,6 +363,38 @@ class __attribute__((visibility("default"))) VoltDBEngine {
             m_ARIESEnabled = status;
         }
 
+        // -------------------------------------------------
+        // Compiled Plan Fragments
+        // -------------------------------------------------
+
+        /**
+         * Number of times that a plan fragment has to be executed before
+         * its scan predicates are compiled. Zero compiles every plan fragment as
+         * soon as it is loaded. A negative value turns compilation off and
+         * goes back to interpreting the fragments that were compiled, so
+         * that the two can be compared.
+         */
+        void setFragmentCompileThreshold(int64_t threshold);
+
+        inline int64_t getFragmentCompileThreshold() const {
+            return m_fragmentCompileThreshold;
+        }
+
+        /** Number of loaded plan fragments that are compiled */
+        int getCompiledFragmentCount() const;
+
+        // -------------------------------------------------
+        // Parallel Scans
+        // -------------------------------------------------
+
+        /**
+         * Split the scans of read-only fragments that aggregate at least
+         * minTuples tuples across the given number of threads. The
+         * partition stays locked for the fragment, so the threads only
+         * ever read. See ExecutorContext::setParallelScans().
+         */
+        void setParallelScans(int threads, int64_t minTuples);
+
 
         // -------------------------------------------------
         // Debug functions
@@ -518,8 +573,12 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         struct ExecutorVector {
             std::vector<AbstractExecutor*> list;
             int tempTableMemoryInBytes;
+            /** number of times that this fragment was executed */
+            int64_t invocations;
+            bool compiled;
         };
         std::map<int64_t, boost::shared_ptr<ExecutorVector> > m_executorMap;
+        void compilePlanFragment(const int64_t fragId, ExecutorVector &ev);
 
         voltdb::UndoLog m_undoLog;
         voltdb::UndoQuantum *m_currentUndoQuantum;
@@ -619,6 +678,9 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         /** number of plan fragments executed so far */
         int m_pfCount;
 
+        /** see setFragmentCompileThreshold() */
+        int64_t m_fragmentCompileThreshold;
+
         // used for sending and recieving deps
         // set by the executeQuery / executeFrag type methods
         int m_currentOutputDepId;
@@ -145,6 +145,36 @@ bool AbstractExecutor::init(VoltDBEngine *engine, const catalog::Database* catal
     return true;
 }
 
+void AbstractExecutor::initPipelines() {
+    for (int ctr = 0, cnt = (int)abstract_node->getChildren().size(); ctr < cnt; ctr++) {
+        AbstractExecutor *child = abstract_node->getChildren()[ctr]->getExecutor();
+        if (child == NULL || !child->supportsPipelining())
+            continue;
+        // The child's output must not be needed by anybody else
+        if (child->abstract_node->getParents().size() > 1)
+            continue;
+        if (acceptsPipelinedInput(ctr, child->producesStableTuples())) {
+            VOLT_DEBUG("Pipelining PlanNode '%s' into PlanNode '%s'",
+                       child->abstract_node->debug().c_str(),
+                       abstract_node->debug().c_str());
+            child->m_pipelined = true;
+        }
+    }
+}
+
+bool AbstractExecutor::compile() {
+    m_compiled = p_compile();
+    VOLT_DEBUG("Compiled PlanNode '%s': %s", abstract_node->debug().c_str(),
+               (m_compiled ? "true" : "false"));
+    return (m_compiled);
+}
+
+bool AbstractExecutor::p_open(const NValueArray &params, ReadWriteTracker *tracker) {
+    VOLT_ERROR("PlanNode '%s' does not support pipelined execution",
+               abstract_node->debug().c_str());
+    return false;
+}
+
 AbstractExecutor::~AbstractExecutor() {}
 
 }
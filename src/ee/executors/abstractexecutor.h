@@ -50,6 +50,7 @@
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "common/executorcontext.hpp"
+#include "common/tabletuple.h"
 #include "storage/table.h"
 #include "storage/temptable.h"
 #include "storage/ReadWriteTracker.h"
@@ -93,12 +94,79 @@ class AbstractExecutor {
      * Returns the plannode that generated this executor.
      */
     inline AbstractPlanNode* getPlanNode() { return abstract_node; }
+
+    // ------------------------------------------------------------------
+    // PIPELINED EXECUTION
+    // ------------------------------------------------------------------
+
+    /**
+     * Returns true if this executor can hand its output tuples to its
+     * parent one at a time through open()/next()/close() instead of
+     * filling its output table. <b>Default is false</b>.
+     */
+    virtual bool supportsPipelining() const { return false; }
+
+    /**
+     * Returns true if the tuples from next() stay valid until the end of
+     * the plan fragment. Otherwise a tuple is only valid until the
+     * following call to next().
+     */
+    virtual bool producesStableTuples() const { return false; }
+
+    /**
+     * Returns true if this executor reads the output of the given child
+     * through an ExecutorInput, and so can pull it straight from the child
+     * executor. stable tells whether the child's tuples stay valid.
+     * <b>Default is false</b>.
+     */
+    virtual bool acceptsPipelinedInput(int child, bool stable) const { return false; }
+
+    /**
+     * Pipeline the children that this executor can pull its input from.
+     * Invoked once all executors of a PF are initialized, in execution
+     * order, so that the children have already made their own choice.
+     */
+    void initPipelines();
+
+    /**
+     * A pipelined executor is not executed on its own. Its parent pulls
+     * the output tuples from it while it executes.
+     */
+    inline bool isPipelined() const { return (m_pipelined); }
+
+    /** Prepare to produce tuples for a pipelined parent */
+    inline bool open(const NValueArray &params, ReadWriteTracker *tracker) {
+        return this->p_open(params, tracker);
+    }
+    /** Returns false once there are no more tuples */
+    inline bool next(TableTuple &tuple) { return this->p_next(tuple); }
+    /** Invoked when the parent has stopped pulling tuples */
+    inline void close() { this->p_close(); }
+
+    // ------------------------------------------------------------------
+    // COMPILED EXECUTION
+    // ------------------------------------------------------------------
+
+    /**
+     * Specialize this executor for the plan that it runs, e.g. by turning
+     * its expressions into code that is bound to the schema of its input.
+     * The engine does this once the plan fragment has been executed often
+     * enough. Returns true if the executor has a compiled form.
+     */
+    bool compile();
+
+    /** Go back to interpreting the plan, e.g. to compare against it */
+    inline void uncompile() { m_compiled = false; }
+
+    inline bool isCompiled() const { return (m_compiled); }
     
   protected:
     AbstractExecutor(VoltDBEngine *engine, AbstractPlanNode *abstract_node) {
         this->abstract_node = abstract_node;
         tmp_output_table = NULL;
         this->force_send_tuple_count = false;
+        m_pipelined = false;
+        m_compiled = false;
     }
 
     /** Concrete executor classes implement initialization in p_init() */
@@ -107,6 +175,22 @@ class AbstractExecutor {
     /** Concrete executor classes impelmenet execution in p_execute() */
     virtual bool p_execute(const NValueArray &params, ReadWriteTracker *tracker) = 0;
 
+    /**
+     * Executors that support pipelining implement it with p_open(),
+     * p_next() and p_close(). p_execute() is then usually just a loop
+     * that inserts the tuples from p_next() into the output table.
+     */
+    virtual bool p_open(const NValueArray &params, ReadWriteTracker *tracker);
+    virtual bool p_next(TableTuple &tuple) { return false; }
+    virtual void p_close() {}
+
+    /**
+     * Executors that have a compiled form build it in p_compile() and
+     * check isCompiled() when they execute. <b>Default is to have no
+     * compiled form</b>.
+     */
+    virtual bool p_compile() { return false; }
+
     /**
      * Returns true if the output table for the plannode must be
      * cleared before p_execute().  <b>Default is true (clear each
@@ -132,6 +216,10 @@ class AbstractExecutor {
     // PAVLO: If this is set to true, then we won't execute the plan
     // node and will force the EE to send back the # of tuples modified
     bool force_send_tuple_count;
+
+  private:
+    bool m_pipelined;
+    bool m_compiled;
 };
 
 /**
@@ -58,10 +58,16 @@
 #include "common/valuevector.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
+#include "common/executorcontext.hpp"
 #include "executors/abstractexecutor.h"
+#include "executors/executorinput.h"
+#include "executors/parallelaggregation.h"
+#include "executors/seqscanexecutor.h"
+#include "executors/typedhashaggregator.h"
 #include "expressions/abstractexpression.h"
 #include "plannodes/aggregatenode.h"
 #include "plannodes/projectionnode.h"
+#include "storage/persistenttable.h"
 #include "storage/table.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
@@ -366,15 +372,44 @@ class AggregateExecutor : public AbstractExecutor
 {
 public:
     AggregateExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
-        AbstractExecutor(engine, abstract_node), m_groupByKeySchema(NULL)
+        AbstractExecutor(engine, abstract_node), m_groupByKeySchema(NULL),
+        m_typedAggregator(NULL), m_typedAggregation(true)
     { };
     ~AggregateExecutor();
 
+    /**
+     * Use the TypedHashAggregator when the plan allows it (the default).
+     * Turning this off forces the generic aggregation, which is only
+     * useful for testing and benchmarking.
+     */
+    inline void setTypedAggregation(bool typedAggregation) {
+        m_typedAggregation = typedAggregation;
+    }
+
+    /** Whether the next execution uses the TypedHashAggregator */
+    inline bool usesTypedAggregation() const {
+        return (m_typedAggregator != NULL && m_typedAggregation);
+    }
+
+    /**
+     * The groups keep pointing at their first input tuple, and the sorted
+     * aggregation looks back at the previous one
+     */
+    bool acceptsPipelinedInput(int child, bool stable) const { return stable; }
+
 protected:
     bool p_init(AbstractPlanNode* abstract_node,
                 const catalog::Database *catalog_db, int* tempTableMemoryInBytes);
     bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
 
+    /**
+     * Run the typed hash aggregation over the (opened) input on several
+     * threads if parallel scans are enabled and the input is a big enough
+     * table, or a scan of one that its parent may take over. Returns false
+     * if the aggregation still has to be done the usual way.
+     */
+    bool aggregateInParallel(ExecutorInput &input);
+
     /*
      * List of mappings of columns from the output table that are
      * passing through the value from a column in the input table and
@@ -383,6 +418,13 @@ protected:
     PassThroughColType m_passThroughColumns;
     Pool m_memoryPool;
     TupleSchema* m_groupByKeySchema;
+
+    /*
+     * Specialized hash aggregation, only set for a HASHAGGREGATE whose
+     * group by key and aggregates it supports.
+     */
+    TypedHashAggregator* m_typedAggregator;
+    bool m_typedAggregation;
 };
 
 /*
@@ -618,7 +660,8 @@ public:
         {
             VOLT_TRACE("no record. outputting a NULL row..");
             Agg** aggregates =
-                static_cast<Agg**>(m_memoryPool->allocate(sizeof(void*)));
+                static_cast<Agg**>(m_memoryPool->allocate(sizeof(void*) *
+                                                          m_colTypes->size()));
             for (int i = 0; i < m_colTypes->size(); i++)
             {
                 // It is necessary to look up the mapping between the
@@ -967,6 +1010,18 @@ AggregateExecutor<aggregateType>::p_init(AbstractPlanNode *abstract_node,
                                                    groupByColumnAllowNull,
                                                    true);
         delete[] columnNames;
+
+        if (aggregateType == PLAN_NODE_TYPE_HASHAGGREGATE)
+        {
+            m_typedAggregator = new TypedHashAggregator();
+            if (!m_typedAggregator->init(childSchema, groupByColumns,
+                                         node->getAggregates(),
+                                         node->getAggregateColumns()))
+            {
+                delete m_typedAggregator;
+                m_typedAggregator = NULL;
+            }
+        }
     }
     return true;
 }
@@ -987,6 +1042,33 @@ bool AggregateExecutor<aggregateType>::p_execute(const NValueArray &params, Read
     assert(input_table);
     VOLT_DEBUG("%s Input Table\n%s", node->debug().c_str(), input_table->debug().c_str());
 
+    ExecutorInput input(node, 0);
+    if (!input.open(params, tracker))
+    {
+        return false;
+    }
+
+    if (usesTypedAggregation())
+    {
+        if (tracker == NULL && aggregateInParallel(input))
+        {
+            if (!m_typedAggregator->finish(output_table,
+                                           node->getAggregateOutputColumns(),
+                                           m_passThroughColumns))
+            {
+                return false;
+            }
+        }
+        else if (!m_typedAggregator->execute(input, output_table,
+                                             node->getAggregateOutputColumns(),
+                                             m_passThroughColumns))
+        {
+            return false;
+        }
+        input.close();
+        return true;
+    }
+
     std::vector<ExpressionType> agg_types = node->getAggregates();
     std::vector<ValueType> col_types(node->getAggregateColumns().size());
     for (int i = 0; i < col_types.size(); i++)
@@ -995,8 +1077,6 @@ bool AggregateExecutor<aggregateType>::p_execute(const NValueArray &params, Read
             input_table->schema()->columnType(node->getAggregateColumns()[i]);
     }
 
-    TableIterator it(input_table);
-
     std::vector<int> groupByColumns = node->getGroupByColumns();
     TableTuple prev(input_table->schema());
 
@@ -1007,7 +1087,7 @@ bool AggregateExecutor<aggregateType>::p_execute(const NValueArray &params, Read
                                          &groupByColumns, &col_types);
 
     VOLT_TRACE("looping..");
-    for (TableTuple cur(input_table->schema()); it.next(cur);
+    for (TableTuple cur(input_table->schema()); input.next(cur);
          prev.move(cur.address()))
     {
         if (!aggregator.nextTuple( cur, prev))
@@ -1015,6 +1095,7 @@ bool AggregateExecutor<aggregateType>::p_execute(const NValueArray &params, Read
             return false;
         }
     }
+    input.close();
     VOLT_TRACE("finalizing..");
     if (!aggregator.finalize(prev))
         return false;
@@ -1025,12 +1106,56 @@ bool AggregateExecutor<aggregateType>::p_execute(const NValueArray &params, Read
     return true;
 }
 
+template<PlanNodeType aggregateType>
+bool AggregateExecutor<aggregateType>::aggregateInParallel(ExecutorInput &input)
+{
+    const int threads = executor_context->getParallelScanThreads();
+    if (threads <= 1)
+    {
+        return false;
+    }
+
+    // Either the materialized output of the child, or the table that a
+    // pipelined SeqScan would hand out tuple by tuple
+    Table* table = input.getTable();
+    PersistentTable* scanned = NULL;
+    const CompiledPredicate* predicate = NULL;
+    if (input.getProducer() != NULL)
+    {
+        SeqScanExecutor* scan = dynamic_cast<SeqScanExecutor*>(input.getProducer());
+        if (scan == NULL || !scan->getParallelScan(&scanned, &predicate))
+        {
+            return false;
+        }
+        table = scanned;
+    }
+    if (table->activeTupleCount() < executor_context->getParallelScanMinTuples())
+    {
+        return false;
+    }
+
+    int64_t tuplesScanned;
+    if (!ParallelAggregation::execute(*m_typedAggregator, table, predicate,
+                                      threads, &tuplesScanned))
+    {
+        VOLT_DEBUG("Parallel aggregation of table '%s' failed, aggregating"
+                   " it again on one thread", table->name().c_str());
+        return false;
+    }
+    if (scanned != NULL)
+    {
+        scanned->updateTupleAccessCount(tuplesScanned);
+    }
+    return true;
+}
+
 template<PlanNodeType aggregateType>
 AggregateExecutor<aggregateType>::~AggregateExecutor()
 {
     if (m_groupByKeySchema != NULL) {
         TupleSchema::freeTupleSchema(m_groupByKeySchema);
     }
+    delete m_typedAggregator;
 }
 }
 
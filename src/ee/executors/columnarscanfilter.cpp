@@ -0,0 +1,671 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include "executors/columnarscanfilter.h"
+#include "common/debuglog.h"
+#include "common/NValue.hpp"
+#include "common/ValuePeeker.hpp"
+#include "expressions/abstractexpression.h"
+#include "expressions/tuplevalueexpression.h"
+#include "storage/table.h"
+#include "storage/ColumnarBlockStore.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace voltdb {
+
+// ----------------------------------------------------------------------------
+// SCALAR COMPARISONS
+// These must produce exactly what NValue::compare() would for the same values
+// ----------------------------------------------------------------------------
+
+template <typename T>
+static inline int64_t integerKey(T value, T nullValue) {
+    return (value == nullValue ? INT64_NULL : static_cast<int64_t>(value));
+}
+
+template <typename T>
+static inline double doubleKey(T value, T nullValue) {
+    // NValue::castAsDouble() turns an integer NULL into a double NULL,
+    // which NValue::setNull() stores as DOUBLE_MIN
+    return (value == nullValue ? DOUBLE_MIN : static_cast<double>(value));
+}
+
+template <>
+inline double doubleKey<double>(double value, double nullValue) {
+    // DOUBLE columns are compared on their raw value
+    return (value);
+}
+
+template <typename K>
+static inline int compareKeys(K lhs, K rhs) {
+    if (lhs == rhs) {
+        return VALUE_COMPARE_EQUAL;
+    } else if (lhs > rhs) {
+        return VALUE_COMPARE_GREATERTHAN;
+    } else {
+        return VALUE_COMPARE_LESSTHAN;
+    }
+}
+
+template <typename T>
+static void compareIntegerColumn(const char *column, uint32_t tupleCount, T nullValue,
+                                 int64_t constant, bool constantOnLeft, const bool accept[3],
+                                 uint64_t *out) {
+    const T *values = reinterpret_cast<const T*>(column);
+    for (uint32_t i = 0; i < tupleCount; i++) {
+        const int64_t key = integerKey<T>(values[i], nullValue);
+        const int cmp = (constantOnLeft ? compareKeys<int64_t>(constant, key) :
+                                          compareKeys<int64_t>(key, constant));
+        if (accept[cmp + 1]) {
+            out[i >> 6] |= (static_cast<uint64_t>(1) << (i & 63));
+        }
+    } // FOR
+}
+
+template <typename T>
+static void compareDoubleColumn(const char *column, uint32_t tupleCount, T nullValue,
+                                double constant, bool constantOnLeft, const bool accept[3],
+                                uint64_t *out) {
+    const T *values = reinterpret_cast<const T*>(column);
+    for (uint32_t i = 0; i < tupleCount; i++) {
+        const double key = doubleKey<T>(values[i], nullValue);
+        const int cmp = (constantOnLeft ? compareKeys<double>(constant, key) :
+                                          compareKeys<double>(key, constant));
+        if (accept[cmp + 1]) {
+            out[i >> 6] |= (static_cast<uint64_t>(1) << (i & 63));
+        }
+    } // FOR
+}
+
+static void activeBitmap(const char *active, uint32_t tupleCount, uint64_t *out) {
+    for (uint32_t i = 0; i < tupleCount; i++) {
+        if (active[i] != 0) {
+            out[i >> 6] |= (static_cast<uint64_t>(1) << (i & 63));
+        }
+    } // FOR
+}
+
+// ----------------------------------------------------------------------------
+// SIMD COMPARISONS
+// Each Lanes class wraps the compares for one vector width and value type.
+// equal() and greater() return one bit per lane, like movemask.
+// ----------------------------------------------------------------------------
+
+/**
+ * Compare a whole column array against a constant, LANES values at a time.
+ * This reads up to the next multiple of LANES past tupleCount, which is
+ * always inside the (padded) minipage. Those extra bits are cleared by the
+ * active bitmap later on.
+ *
+ * Because the compares are ordered, a NaN is neither equal nor greater, and
+ * so is treated as less than, which is what compareKeys() does too.
+ */
+template <typename Lanes>
+static void compareLanes(const char *column, uint32_t tupleCount,
+                         typename Lanes::Constant constant, bool constantOnLeft,
+                         const bool accept[3], uint64_t *out) {
+    const typename Lanes::Value *values = reinterpret_cast<const typename Lanes::Value*>(column);
+    const typename Lanes::Vector c = Lanes::broadcast(constant);
+    const uint32_t laneMask = (1u << Lanes::LANES) - 1;
+    const uint32_t acceptLess = (accept[0] ? laneMask : 0);
+    const uint32_t acceptEqual = (accept[1] ? laneMask : 0);
+    const uint32_t acceptGreater = (accept[2] ? laneMask : 0);
+
+    for (uint32_t i = 0; i < tupleCount; i += Lanes::LANES) {
+        const typename Lanes::Vector v = Lanes::load(values + i);
+        const uint32_t eq = Lanes::equal(v, c);
+        const uint32_t gt = (constantOnLeft ? Lanes::greater(c, v) : Lanes::greater(v, c));
+        const uint32_t lt = ~(eq | gt) & laneMask;
+        const uint32_t bits = (lt & acceptLess) | (eq & acceptEqual) | (gt & acceptGreater);
+        out[i >> 6] |= (static_cast<uint64_t>(bits) << (i & 63));
+    } // FOR
+}
+
+#ifdef __SSE2__
+class SSEInt8Lanes {
+public:
+    typedef __m128i Vector;
+    typedef int8_t Value;
+    typedef int64_t Constant;
+    static const uint32_t LANES = 16;
+    static inline Vector broadcast(Constant c) { return _mm_set1_epi8(static_cast<char>(c)); }
+    static inline Vector load(const Value *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(a, b)));
+    }
+};
+
+class SSEInt16Lanes {
+public:
+    typedef __m128i Vector;
+    typedef int16_t Value;
+    typedef int64_t Constant;
+    static const uint32_t LANES = 8;
+    static inline Vector broadcast(Constant c) { return _mm_set1_epi16(static_cast<short>(c)); }
+    static inline Vector load(const Value *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static inline uint32_t mask(Vector m) {
+        // narrow each 16-bit lane mask to a byte so movemask gives one bit per lane
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(m, _mm_setzero_si128())));
+    }
+    static inline uint32_t equal(Vector a, Vector b) { return mask(_mm_cmpeq_epi16(a, b)); }
+    static inline uint32_t greater(Vector a, Vector b) { return mask(_mm_cmpgt_epi16(a, b)); }
+};
+
+class SSEInt32Lanes {
+public:
+    typedef __m128i Vector;
+    typedef int32_t Value;
+    typedef int64_t Constant;
+    static const uint32_t LANES = 4;
+    static inline Vector broadcast(Constant c) { return _mm_set1_epi32(static_cast<int>(c)); }
+    static inline Vector load(const Value *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, b))));
+    }
+};
+
+class SSEDoubleLanes {
+public:
+    typedef __m128d Vector;
+    typedef double Value;
+    typedef double Constant;
+    static const uint32_t LANES = 2;
+    static inline Vector broadcast(Constant c) { return _mm_set1_pd(c); }
+    static inline Vector load(const Value *p) { return _mm_loadu_pd(p); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_pd(_mm_cmpeq_pd(a, b)));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_pd(_mm_cmpgt_pd(a, b)));
+    }
+};
+#endif
+
+#if defined(__SSE4_2__) && !defined(__AVX2__)
+class SSEInt64Lanes {
+public:
+    typedef __m128i Vector;
+    typedef int64_t Value;
+    typedef int64_t Constant;
+    static const uint32_t LANES = 2;
+    static inline Vector broadcast(Constant c) { return _mm_set1_epi64x(c); }
+    static inline Vector load(const Value *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(a, b))));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(a, b))));
+    }
+};
+#endif
+
+#ifdef __AVX2__
+class AVXInt32Lanes {
+public:
+    typedef __m256i Vector;
+    typedef int32_t Value;
+    typedef int64_t Constant;
+    static const uint32_t LANES = 8;
+    static inline Vector broadcast(Constant c) { return _mm256_set1_epi32(static_cast<int>(c)); }
+    static inline Vector load(const Value *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b))));
+    }
+};
+
+class AVXInt64Lanes {
+public:
+    typedef __m256i Vector;
+    typedef int64_t Value;
+    typedef int64_t Constant;
+    static const uint32_t LANES = 4;
+    static inline Vector broadcast(Constant c) { return _mm256_set1_epi64x(c); }
+    static inline Vector load(const Value *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b))));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(a, b))));
+    }
+};
+
+class AVXDoubleLanes {
+public:
+    typedef __m256d Vector;
+    typedef double Value;
+    typedef double Constant;
+    static const uint32_t LANES = 4;
+    static inline Vector broadcast(Constant c) { return _mm256_set1_pd(c); }
+    static inline Vector load(const Value *p) { return _mm256_loadu_pd(p); }
+    static inline uint32_t equal(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)));
+    }
+    static inline uint32_t greater(Vector a, Vector b) {
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)));
+    }
+};
+#endif
+
+/**
+ * The SIMD kernels compare the raw stored values, so the constant has to be
+ * mapped into the column's own domain first. That only works when every
+ * stored value keeps its order relative to the constant, i.e. the constant
+ * is the SQL NULL (which maps to the column's NULL sentinel) or strictly
+ * above the sentinel and not above the type's maximum.
+ */
+template <typename T>
+static inline bool narrowIntegerConstant(int64_t constant, T nullValue, T maxValue, int64_t &narrowed) {
+    if (constant == INT64_NULL) {
+        narrowed = static_cast<int64_t>(nullValue);
+        return (true);
+    }
+    if (constant > static_cast<int64_t>(nullValue) && constant <= static_cast<int64_t>(maxValue)) {
+        narrowed = constant;
+        return (true);
+    }
+    return (false);
+}
+
+static inline bool isIntegerType(ValueType type) {
+    switch (type) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            return (true);
+        default:
+            return (false);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+ColumnarScanFilter::ColumnarScanFilter() :
+        m_table(NULL),
+        m_store(NULL),
+        m_vectorized(true),
+        m_root(-1),
+        m_bitmapWords(0),
+        m_blockIndex(0),
+        m_rowData(NULL),
+        m_tupleLength(0),
+        m_matchPosition(0),
+        m_scannedCount(0) {
+}
+
+bool ColumnarScanFilter::init(Table *table, const AbstractExpression *predicate) {
+#ifdef MEMCHECK_NOFREELIST
+    // Blocks can be released out of order in this build
+    return (false);
+#else
+    m_table = table;
+    m_store = table->columnarStore();
+    if (m_store == NULL || predicate == NULL) {
+        return (false);
+    }
+    m_clauses.clear();
+    m_nodes.clear();
+    m_root = bindExpression(predicate);
+    if (m_root < 0) {
+        return (false);
+    }
+
+    m_bitmapWords = (table->tuplesPerBlock() + 63) / 64;
+    m_bitmaps.resize((m_nodes.size() + 1) * m_bitmapWords);
+    m_blockIndex = 0;
+    m_rowData = NULL;
+    m_tupleLength = m_store->tupleLength();
+    m_matches.clear();
+    m_matches.reserve(table->tuplesPerBlock());
+    m_matchPosition = 0;
+    m_scannedCount = 0;
+    VOLT_DEBUG("Using columnar scan on %s [clauses=%d, nodes=%d, vectorized=%d]",
+               table->name().c_str(), (int)m_clauses.size(), (int)m_nodes.size(), m_vectorized);
+    return (true);
+#endif
+}
+
+int ColumnarScanFilter::bindExpression(const AbstractExpression *expr) {
+    Node node;
+    node.type = expr->getExpressionType();
+    node.clause = -1;
+    node.left = -1;
+    node.right = -1;
+
+    if (node.type == EXPRESSION_TYPE_CONJUNCTION_AND ||
+        node.type == EXPRESSION_TYPE_CONJUNCTION_OR) {
+        if (expr->getLeft() == NULL || expr->getRight() == NULL) {
+            return (-1);
+        }
+        node.left = bindExpression(expr->getLeft());
+        if (node.left < 0) return (-1);
+        node.right = bindExpression(expr->getRight());
+        if (node.right < 0) return (-1);
+    } else {
+        Clause clause;
+        if (bindComparison(expr, clause) == false) {
+            return (-1);
+        }
+        node.clause = static_cast<int>(m_clauses.size());
+        m_clauses.push_back(clause);
+    }
+    m_nodes.push_back(node);
+    return (static_cast<int>(m_nodes.size()) - 1);
+}
+
+bool ColumnarScanFilter::bindComparison(const AbstractExpression *expr, Clause &clause) {
+    // Three-way comparison results that make each operator true.
+    // Index 0 is LESSTHAN, 1 is EQUAL and 2 is GREATERTHAN
+    bool *accept = clause.accept;
+    switch (expr->getExpressionType()) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            accept[0] = false; accept[1] = true;  accept[2] = false; break;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            accept[0] = true;  accept[1] = false; accept[2] = true;  break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            accept[0] = true;  accept[1] = false; accept[2] = false; break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            accept[0] = false; accept[1] = false; accept[2] = true;  break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            accept[0] = true;  accept[1] = true;  accept[2] = false; break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            accept[0] = false; accept[1] = true;  accept[2] = true;  break;
+        default:
+            return (false);
+    } // SWITCH
+
+    const AbstractExpression *left = expr->getLeft();
+    const AbstractExpression *right = expr->getRight();
+    if (left == NULL || right == NULL) {
+        return (false);
+    }
+
+    const AbstractExpression *column = NULL;
+    const AbstractExpression *constant = NULL;
+    if (left->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+        column = left;
+        constant = right;
+        clause.constantOnLeft = false;
+    } else if (right->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+        column = right;
+        constant = left;
+        clause.constantOnLeft = true;
+    } else {
+        return (false);
+    }
+    if (constant->getExpressionType() != EXPRESSION_TYPE_VALUE_CONSTANT &&
+        constant->getExpressionType() != EXPRESSION_TYPE_VALUE_PARAMETER) {
+        return (false);
+    }
+
+    const TupleValueExpressionMarker *tve = dynamic_cast<const TupleValueExpressionMarker*>(column);
+    if (tve == NULL) {
+        return (false);
+    }
+    clause.columnIndex = tve->getColumnId();
+    if (clause.columnIndex < 0 || clause.columnIndex >= m_table->columnCount() ||
+        m_store->hasColumn(clause.columnIndex) == false) {
+        return (false);
+    }
+    clause.columnType = m_table->schema()->columnType(clause.columnIndex);
+
+    // Constants and (substituted) parameters do not look at the tuple
+    const NValue value = constant->eval(NULL, NULL);
+    const ValueType constantType = ValuePeeker::peekValueType(value);
+    if (isIntegerType(constantType) == false && constantType != VALUE_TYPE_DOUBLE) {
+        return (false);
+    }
+
+    clause.integerConstant = 0;
+    clause.doubleConstant = 0;
+    clause.compareAsDouble = (clause.columnType == VALUE_TYPE_DOUBLE || constantType == VALUE_TYPE_DOUBLE);
+    if (clause.compareAsDouble) {
+        if (constantType == VALUE_TYPE_DOUBLE) {
+            clause.doubleConstant = ValuePeeker::peekDouble(value);
+        } else if (value.isNull()) {
+            clause.doubleConstant = DOUBLE_MIN;
+        } else {
+            clause.doubleConstant = static_cast<double>(ValuePeeker::peekAsRawInt64(value));
+        }
+    } else {
+        clause.integerConstant = ValuePeeker::peekAsBigInt(value);
+    }
+    return (true);
+}
+
+bool ColumnarScanFilter::evaluateClauseVectorized(const Clause &clause, const char *column,
+                                                  uint32_t tupleCount, uint64_t *out) {
+    int64_t narrowed = 0;
+    if (clause.compareAsDouble) {
+        // Integer columns need a conversion (and NULL mapping) per value
+        if (clause.columnType != VALUE_TYPE_DOUBLE) return (false);
+#if defined(__AVX2__)
+        compareLanes<AVXDoubleLanes>(column, tupleCount, clause.doubleConstant,
+                                     clause.constantOnLeft, clause.accept, out);
+        return (true);
+#elif defined(__SSE2__)
+        compareLanes<SSEDoubleLanes>(column, tupleCount, clause.doubleConstant,
+                                     clause.constantOnLeft, clause.accept, out);
+        return (true);
+#else
+        return (false);
+#endif
+    }
+
+    switch (clause.columnType) {
+#ifdef __SSE2__
+        case VALUE_TYPE_TINYINT:
+            if (narrowIntegerConstant<int8_t>(clause.integerConstant, INT8_NULL, INT8_MAX, narrowed) == false) break;
+            compareLanes<SSEInt8Lanes>(column, tupleCount, narrowed, clause.constantOnLeft, clause.accept, out);
+            return (true);
+        case VALUE_TYPE_SMALLINT:
+            if (narrowIntegerConstant<int16_t>(clause.integerConstant, INT16_NULL, INT16_MAX, narrowed) == false) break;
+            compareLanes<SSEInt16Lanes>(column, tupleCount, narrowed, clause.constantOnLeft, clause.accept, out);
+            return (true);
+        case VALUE_TYPE_INTEGER:
+            if (narrowIntegerConstant<int32_t>(clause.integerConstant, INT32_NULL, INT32_MAX, narrowed) == false) break;
+#ifdef __AVX2__
+            compareLanes<AVXInt32Lanes>(column, tupleCount, narrowed, clause.constantOnLeft, clause.accept, out);
+#else
+            compareLanes<SSEInt32Lanes>(column, tupleCount, narrowed, clause.constantOnLeft, clause.accept, out);
+#endif
+            return (true);
+#endif
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+#if defined(__AVX2__)
+            compareLanes<AVXInt64Lanes>(column, tupleCount, clause.integerConstant,
+                                        clause.constantOnLeft, clause.accept, out);
+            return (true);
+#elif defined(__SSE4_2__)
+            compareLanes<SSEInt64Lanes>(column, tupleCount, clause.integerConstant,
+                                        clause.constantOnLeft, clause.accept, out);
+            return (true);
+#else
+            // SSE2 has no 64-bit compares
+            break;
+#endif
+        default:
+            break;
+    } // SWITCH
+    return (false);
+}
+
+void ColumnarScanFilter::evaluateClause(const Clause &clause, const char *minipage,
+                                        uint32_t tupleCount, uint64_t *out) {
+    const char *column = m_store->columnData(minipage, clause.columnIndex);
+    if (m_vectorized && evaluateClauseVectorized(clause, column, tupleCount, out)) {
+        return;
+    }
+
+    switch (clause.columnType) {
+        case VALUE_TYPE_TINYINT:
+            if (clause.compareAsDouble) {
+                compareDoubleColumn<int8_t>(column, tupleCount, INT8_NULL, clause.doubleConstant,
+                                            clause.constantOnLeft, clause.accept, out);
+            } else {
+                compareIntegerColumn<int8_t>(column, tupleCount, INT8_NULL, clause.integerConstant,
+                                             clause.constantOnLeft, clause.accept, out);
+            }
+            break;
+        case VALUE_TYPE_SMALLINT:
+            if (clause.compareAsDouble) {
+                compareDoubleColumn<int16_t>(column, tupleCount, INT16_NULL, clause.doubleConstant,
+                                             clause.constantOnLeft, clause.accept, out);
+            } else {
+                compareIntegerColumn<int16_t>(column, tupleCount, INT16_NULL, clause.integerConstant,
+                                              clause.constantOnLeft, clause.accept, out);
+            }
+            break;
+        case VALUE_TYPE_INTEGER:
+            if (clause.compareAsDouble) {
+                compareDoubleColumn<int32_t>(column, tupleCount, INT32_NULL, clause.doubleConstant,
+                                             clause.constantOnLeft, clause.accept, out);
+            } else {
+                compareIntegerColumn<int32_t>(column, tupleCount, INT32_NULL, clause.integerConstant,
+                                              clause.constantOnLeft, clause.accept, out);
+            }
+            break;
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            if (clause.compareAsDouble) {
+                compareDoubleColumn<int64_t>(column, tupleCount, INT64_NULL, clause.doubleConstant,
+                                             clause.constantOnLeft, clause.accept, out);
+            } else {
+                compareIntegerColumn<int64_t>(column, tupleCount, INT64_NULL, clause.integerConstant,
+                                              clause.constantOnLeft, clause.accept, out);
+            }
+            break;
+        case VALUE_TYPE_DOUBLE:
+            compareDoubleColumn<double>(column, tupleCount, DOUBLE_MIN, clause.doubleConstant,
+                                        clause.constantOnLeft, clause.accept, out);
+            break;
+        default:
+            assert(false);
+    } // SWITCH
+}
+
+void ColumnarScanFilter::evaluateNode(int nodeIndex, const char *minipage,
+                                      uint32_t tupleCount, uint64_t *out) {
+    const Node &node = m_nodes[nodeIndex];
+    const uint32_t words = (tupleCount + 63) / 64;
+    ::memset(out, 0, words * sizeof(uint64_t));
+
+    if (node.clause >= 0) {
+        evaluateClause(m_clauses[node.clause], minipage, tupleCount, out);
+        return;
+    }
+
+    uint64_t *left = &m_bitmaps[node.left * m_bitmapWords];
+    uint64_t *right = &m_bitmaps[node.right * m_bitmapWords];
+    evaluateNode(node.left, minipage, tupleCount, left);
+    evaluateNode(node.right, minipage, tupleCount, right);
+    if (node.type == EXPRESSION_TYPE_CONJUNCTION_AND) {
+        for (uint32_t w = 0; w < words; w++) {
+            out[w] = left[w] & right[w];
+        }
+    } else {
+        for (uint32_t w = 0; w < words; w++) {
+            out[w] = left[w] | right[w];
+        }
+    }
+}
+
+void ColumnarScanFilter::filterBlock(int blockIndex) {
+    uint32_t tupleCount = 0;
+    const char *minipage = m_table->getColumnarBlock(blockIndex, m_rowData, tupleCount);
+
+    m_matches.clear();
+    m_matchPosition = 0;
+    if (m_rowData == NULL || tupleCount == 0) {
+        return;
+    }
+
+    const uint32_t words = (tupleCount + 63) / 64;
+    uint64_t *active = &m_bitmaps[m_nodes.size() * m_bitmapWords];
+    ::memset(active, 0, words * sizeof(uint64_t));
+    const char *activeFlags = m_store->activeFlags(minipage);
+#ifdef __SSE2__
+    if (m_vectorized) {
+        // Slots past tupleCount are always zero in the minipage
+        const __m128i zero = _mm_setzero_si128();
+        for (uint32_t i = 0; i < tupleCount; i += 16) {
+            __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(activeFlags + i));
+            uint32_t bits = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(flags, zero))) & 0xFFFF;
+            active[i >> 6] |= (static_cast<uint64_t>(bits) << (i & 63));
+        } // FOR
+    } else {
+        activeBitmap(activeFlags, tupleCount, active);
+    }
+#else
+    activeBitmap(activeFlags, tupleCount, active);
+#endif
+
+    uint64_t *selected = &m_bitmaps[m_root * m_bitmapWords];
+    evaluateNode(m_root, minipage, tupleCount, selected);
+
+    for (uint32_t w = 0; w < words; w++) {
+        m_scannedCount += __builtin_popcountll(active[w]);
+        uint64_t bits = selected[w] & active[w];
+        while (bits != 0) {
+            m_matches.push_back((w << 6) + static_cast<uint32_t>(__builtin_ctzll(bits)));
+            bits &= (bits - 1);
+        } // WHILE
+    } // FOR
+}
+
+bool ColumnarScanFilter::next(TableTuple &out) {
+    while (m_matchPosition >= m_matches.size()) {
+        if (m_blockIndex >= m_table->blockCount()) {
+            return (false);
+        }
+        filterBlock(m_blockIndex++);
+    } // WHILE
+    out.move(m_rowData + (m_matches[m_matchPosition++] * m_tupleLength));
+    assert(out.isActive());
+    return (true);
+}
+
+}
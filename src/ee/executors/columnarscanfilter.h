@@ -0,0 +1,144 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORECOLUMNARSCANFILTER_H
+#define HSTORECOLUMNARSCANFILTER_H
+
+#include <vector>
+#include "common/types.h"
+#include "common/tabletuple.h"
+
+namespace voltdb {
+
+class AbstractExpression;
+class ColumnarBlockStore;
+class Table;
+
+/**
+ * Scan a table that has columnar (PAX) blocks and return only the tuples
+ * that satisfy a simple predicate. The predicate is evaluated one block at
+ * a time directly on the column arrays and produces a selection bitmap,
+ * so the row-major tuples are only touched for the tuples that qualify.
+ *
+ * Supported predicates are AND/OR trees whose leaves have the form
+ * <column> <op> <constant/parameter> (or reversed) on a fixed-width
+ * numeric column. Leaves are evaluated with SSE2 (or AVX2, when the EE is
+ * compiled for it) compares where the column and constant types allow it,
+ * and with a scalar loop otherwise. The result of every comparison is
+ * identical to NValue::compare() for those types, including the handling
+ * of NULLs.
+ */
+class ColumnarScanFilter {
+public:
+    ColumnarScanFilter();
+
+    /**
+     * Bind the filter to the given table and predicate. The predicate must
+     * already have had its parameters substituted. Returns false if the
+     * table has no columnar blocks or if the predicate cannot be evaluated
+     * on them, in which case the caller must fall back to a TableIterator.
+     */
+    bool init(Table *table, const AbstractExpression *predicate);
+
+    /**
+     * Updates the given tuple so that it points to the next tuple that
+     * satisfies the predicate. Returns false when the table is exhausted.
+     */
+    bool next(TableTuple &out);
+
+    /** Number of active tuples that the predicate was evaluated on */
+    inline int64_t getScannedCount() const {
+        return (m_scannedCount);
+    }
+
+    /**
+     * Use the SIMD kernels when possible (the default). Turning this off
+     * forces the scalar loops, which is only useful for testing and
+     * benchmarking.
+     */
+    inline void setVectorized(bool vectorized) {
+        m_vectorized = vectorized;
+    }
+
+private:
+    /**
+     * A single <column> <op> <constant> comparison
+     */
+    struct Clause {
+        int columnIndex;
+        ValueType columnType;
+        bool constantOnLeft;
+        bool compareAsDouble;
+        int64_t integerConstant;
+        double doubleConstant;
+        // whether a three-way comparison result of (LT, EQ, GT) qualifies
+        bool accept[3];
+    };
+
+    /**
+     * A node in the predicate tree. Leaves point at a Clause, conjunctions
+     * point at their two children.
+     */
+    struct Node {
+        ExpressionType type;
+        int clause;
+        int left;
+        int right;
+    };
+
+    int bindExpression(const AbstractExpression *expr);
+    bool bindComparison(const AbstractExpression *expr, Clause &clause);
+
+    void filterBlock(int blockIndex);
+    void evaluateNode(int nodeIndex, const char *minipage, uint32_t tupleCount, uint64_t *out);
+    void evaluateClause(const Clause &clause, const char *minipage, uint32_t tupleCount, uint64_t *out);
+    bool evaluateClauseVectorized(const Clause &clause, const char *column, uint32_t tupleCount, uint64_t *out);
+
+    Table *m_table;
+    ColumnarBlockStore *m_store;
+    bool m_vectorized;
+
+    // the bound predicate tree
+    std::vector<Clause> m_clauses;
+    std::vector<Node> m_nodes;
+    int m_root;
+
+    // one selection bitmap per node, plus one for the active flags
+    uint32_t m_bitmapWords;
+    std::vector<uint64_t> m_bitmaps;
+
+    // the current block
+    int m_blockIndex;
+    char *m_rowData;
+    uint32_t m_tupleLength;
+    std::vector<uint32_t> m_matches;
+    size_t m_matchPosition;
+
+    int64_t m_scannedCount;
+};
+
+}
+
+#endif
@@ -0,0 +1,250 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include "executors/compiledpredicate.h"
+#include "common/debuglog.h"
+#include "common/NValue.hpp"
+#include "common/TupleSchema.h"
+#include "common/ValuePeeker.hpp"
+#include "expressions/abstractexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+namespace voltdb {
+
+// ----------------------------------------------------------------------------
+// COMPARE FUNCTIONS
+// These must produce exactly what NValue::compare() would for the same values
+// ----------------------------------------------------------------------------
+
+template <typename K>
+static inline int compareKeys(K lhs, K rhs) {
+    if (lhs == rhs) {
+        return VALUE_COMPARE_EQUAL;
+    } else if (lhs > rhs) {
+        return VALUE_COMPARE_GREATERTHAN;
+    } else {
+        return VALUE_COMPARE_LESSTHAN;
+    }
+}
+
+template <typename T, int64_t NULL_VALUE>
+int CompiledPredicate::compareInteger(const char *data, const Leaf &leaf) {
+    const T value = *reinterpret_cast<const T*>(data);
+    const int64_t key = (value == static_cast<T>(NULL_VALUE) ? INT64_NULL : static_cast<int64_t>(value));
+    return (leaf.constantOnLeft ? compareKeys<int64_t>(leaf.integerConstant, key) :
+                                  compareKeys<int64_t>(key, leaf.integerConstant));
+}
+
+template <typename T, int64_t NULL_VALUE>
+int CompiledPredicate::compareIntegerAsDouble(const char *data, const Leaf &leaf) {
+    const T value = *reinterpret_cast<const T*>(data);
+    // NValue::castAsDouble() turns an integer NULL into a double NULL,
+    // which NValue::setNull() stores as DOUBLE_MIN
+    const double key = (value == static_cast<T>(NULL_VALUE) ? DOUBLE_MIN : static_cast<double>(value));
+    return (leaf.constantOnLeft ? compareKeys<double>(leaf.doubleConstant, key) :
+                                  compareKeys<double>(key, leaf.doubleConstant));
+}
+
+int CompiledPredicate::compareDouble(const char *data, const Leaf &leaf) {
+    // DOUBLE columns are compared on their raw value
+    const double key = *reinterpret_cast<const double*>(data);
+    return (leaf.constantOnLeft ? compareKeys<double>(leaf.doubleConstant, key) :
+                                  compareKeys<double>(key, leaf.doubleConstant));
+}
+
+static inline bool isIntegerType(ValueType type) {
+    switch (type) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            return (true);
+        default:
+            return (false);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+CompiledPredicate::CompiledPredicate() : m_root(-1) {
+}
+
+bool CompiledPredicate::compile(const AbstractExpression *predicate, const TupleSchema *schema) {
+    m_leaves.clear();
+    m_nodes.clear();
+    m_root = (predicate == NULL ? -1 : compileExpression(predicate, schema));
+    if (m_root < 0) {
+        m_leaves.clear();
+        m_nodes.clear();
+        return (false);
+    }
+    VOLT_DEBUG("Compiled predicate [leaves=%d, nodes=%d]",
+               (int)m_leaves.size(), (int)m_nodes.size());
+    return (true);
+}
+
+int CompiledPredicate::compileExpression(const AbstractExpression *expr, const TupleSchema *schema) {
+    Node node;
+    node.type = expr->getExpressionType();
+    node.leaf = -1;
+    node.left = -1;
+    node.right = -1;
+
+    if (node.type == EXPRESSION_TYPE_CONJUNCTION_AND ||
+        node.type == EXPRESSION_TYPE_CONJUNCTION_OR) {
+        if (expr->getLeft() == NULL || expr->getRight() == NULL) {
+            return (-1);
+        }
+        node.left = compileExpression(expr->getLeft(), schema);
+        if (node.left < 0) return (-1);
+        node.right = compileExpression(expr->getRight(), schema);
+        if (node.right < 0) return (-1);
+    } else {
+        Leaf leaf;
+        if (compileComparison(expr, schema, leaf) == false) {
+            return (-1);
+        }
+        node.leaf = static_cast<int>(m_leaves.size());
+        m_leaves.push_back(leaf);
+    }
+    m_nodes.push_back(node);
+    return (static_cast<int>(m_nodes.size()) - 1);
+}
+
+bool CompiledPredicate::compileComparison(const AbstractExpression *expr, const TupleSchema *schema,
+                                          Leaf &leaf) {
+    // Three-way comparison results that make each operator true.
+    // Index 0 is LESSTHAN, 1 is EQUAL and 2 is GREATERTHAN
+    bool *accept = leaf.accept;
+    switch (expr->getExpressionType()) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            accept[0] = false; accept[1] = true;  accept[2] = false; break;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            accept[0] = true;  accept[1] = false; accept[2] = true;  break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            accept[0] = true;  accept[1] = false; accept[2] = false; break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            accept[0] = false; accept[1] = false; accept[2] = true;  break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            accept[0] = true;  accept[1] = true;  accept[2] = false; break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            accept[0] = false; accept[1] = true;  accept[2] = true;  break;
+        default:
+            return (false);
+    } // SWITCH
+
+    const AbstractExpression *left = expr->getLeft();
+    const AbstractExpression *right = expr->getRight();
+    if (left == NULL || right == NULL) {
+        return (false);
+    }
+
+    const AbstractExpression *column = NULL;
+    if (left->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+        column = left;
+        leaf.constant = right;
+        leaf.constantOnLeft = false;
+    } else if (right->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+        column = right;
+        leaf.constant = left;
+        leaf.constantOnLeft = true;
+    } else {
+        return (false);
+    }
+    if (leaf.constant->getExpressionType() != EXPRESSION_TYPE_VALUE_CONSTANT &&
+        leaf.constant->getExpressionType() != EXPRESSION_TYPE_VALUE_PARAMETER) {
+        return (false);
+    }
+
+    const TupleValueExpressionMarker *tve = dynamic_cast<const TupleValueExpressionMarker*>(column);
+    if (tve == NULL) {
+        return (false);
+    }
+    const int columnIndex = tve->getColumnId();
+    if (columnIndex < 0 || columnIndex >= schema->columnCount()) {
+        return (false);
+    }
+    leaf.columnType = schema->columnType(columnIndex);
+    if (isIntegerType(leaf.columnType) == false && leaf.columnType != VALUE_TYPE_DOUBLE) {
+        return (false);
+    }
+    leaf.offset = schema->columnOffset(columnIndex) + TUPLE_HEADER_SIZE;
+    leaf.compare = NULL;
+    leaf.integerConstant = 0;
+    leaf.doubleConstant = 0;
+    return (true);
+}
+
+bool CompiledPredicate::bind() {
+    assert(m_root >= 0);
+    for (std::vector<Leaf>::iterator leaf = m_leaves.begin(); leaf != m_leaves.end(); leaf++) {
+        // Constants and (substituted) parameters do not look at the tuple
+        const NValue value = leaf->constant->eval(NULL, NULL);
+        const ValueType constantType = ValuePeeker::peekValueType(value);
+        if (isIntegerType(constantType) == false && constantType != VALUE_TYPE_DOUBLE) {
+            return (false);
+        }
+
+        if (leaf->columnType == VALUE_TYPE_DOUBLE || constantType == VALUE_TYPE_DOUBLE) {
+            if (constantType == VALUE_TYPE_DOUBLE) {
+                leaf->doubleConstant = ValuePeeker::peekDouble(value);
+            } else if (value.isNull()) {
+                leaf->doubleConstant = DOUBLE_MIN;
+            } else {
+                leaf->doubleConstant = static_cast<double>(ValuePeeker::peekAsRawInt64(value));
+            }
+            switch (leaf->columnType) {
+                case VALUE_TYPE_TINYINT:
+                    leaf->compare = &compareIntegerAsDouble<int8_t, INT8_NULL>; break;
+                case VALUE_TYPE_SMALLINT:
+                    leaf->compare = &compareIntegerAsDouble<int16_t, INT16_NULL>; break;
+                case VALUE_TYPE_INTEGER:
+                    leaf->compare = &compareIntegerAsDouble<int32_t, INT32_NULL>; break;
+                case VALUE_TYPE_BIGINT:
+                case VALUE_TYPE_TIMESTAMP:
+                    leaf->compare = &compareIntegerAsDouble<int64_t, INT64_NULL>; break;
+                default:
+                    leaf->compare = &compareDouble;
+            } // SWITCH
+        } else {
+            leaf->integerConstant = ValuePeeker::peekAsBigInt(value);
+            switch (leaf->columnType) {
+                case VALUE_TYPE_TINYINT:
+                    leaf->compare = &compareInteger<int8_t, INT8_NULL>; break;
+                case VALUE_TYPE_SMALLINT:
+                    leaf->compare = &compareInteger<int16_t, INT16_NULL>; break;
+                case VALUE_TYPE_INTEGER:
+                    leaf->compare = &compareInteger<int32_t, INT32_NULL>; break;
+                default:
+                    leaf->compare = &compareInteger<int64_t, INT64_NULL>;
+            } // SWITCH
+        }
+    } // FOR
+    return (true);
+}
+
+}
@@ -0,0 +1,147 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORECOMPILEDPREDICATE_H
+#define HSTORECOMPILEDPREDICATE_H
+
+#include <vector>
+#include "common/types.h"
+#include "common/tabletuple.h"
+
+namespace voltdb {
+
+class AbstractExpression;
+class TupleSchema;
+
+/**
+ * A predicate that has been specialized for the schema of the tuples it
+ * is evaluated on. The expression tree is flattened into an array of
+ * nodes when the plan fragment is compiled, and every comparison reads
+ * its column straight out of the tuple storage at an offset that is
+ * resolved once, through a compare function that is instantiated for the
+ * column's type. This avoids the virtual eval() calls and the NValues
+ * that the AbstractExpression tree creates for every tuple.
+ *
+ * Supported predicates are the same as for the ColumnarScanFilter: AND/OR
+ * trees whose leaves have the form <column> <op> <constant/parameter> (or
+ * reversed) on a fixed-width numeric column of the first tuple. The
+ * result is identical to AbstractExpression::eval(tuple, NULL).isTrue().
+ */
+class CompiledPredicate {
+public:
+    CompiledPredicate();
+
+    /**
+     * Compile the predicate for tuples with the given schema. Returns
+     * false if the predicate cannot be compiled, in which case it has to
+     * be evaluated through the AbstractExpression tree.
+     */
+    bool compile(const AbstractExpression *predicate, const TupleSchema *schema);
+
+    /**
+     * Pick up the values of the constants and parameters for the next
+     * execution. The predicate must already have had its parameters
+     * substituted. Returns false if one of the values has a type that the
+     * compiled predicate cannot compare, in which case the caller has to
+     * fall back to the AbstractExpression tree for this execution.
+     */
+    bool bind();
+
+    /** Returns true if the given tuple satisfies the predicate */
+    inline bool eval(const TableTuple &tuple) const {
+        assert(m_root >= 0);
+        return (evaluateNode(m_root, tuple.address()));
+    }
+
+    inline bool isCompiled() const {
+        return (m_root >= 0);
+    }
+
+private:
+    struct Leaf;
+    typedef int (*CompareFunction)(const char *data, const Leaf &leaf);
+
+    /**
+     * A single <column> <op> <constant> comparison
+     */
+    struct Leaf {
+        // from the start of the tuple, header included
+        uint32_t offset;
+        ValueType columnType;
+        const AbstractExpression *constant;
+        bool constantOnLeft;
+        // whether a three-way comparison result of (LT, EQ, GT) qualifies
+        bool accept[3];
+
+        // set by bind()
+        CompareFunction compare;
+        int64_t integerConstant;
+        double doubleConstant;
+    };
+
+    /**
+     * A node in the predicate tree. Leaves point at a Leaf, conjunctions
+     * point at their two children.
+     */
+    struct Node {
+        ExpressionType type;
+        int leaf;
+        int left;
+        int right;
+    };
+
+    // The compare functions for each column type. They return the
+    // three-way comparison of the leaf's column with its constant.
+    template <typename T, int64_t NULL_VALUE>
+    static int compareInteger(const char *data, const Leaf &leaf);
+    template <typename T, int64_t NULL_VALUE>
+    static int compareIntegerAsDouble(const char *data, const Leaf &leaf);
+    static int compareDouble(const char *data, const Leaf &leaf);
+
+    int compileExpression(const AbstractExpression *expr, const TupleSchema *schema);
+    bool compileComparison(const AbstractExpression *expr, const TupleSchema *schema, Leaf &leaf);
+
+    inline bool evaluateNode(int nodeIndex, const char *data) const {
+        const Node &node = m_nodes[nodeIndex];
+        switch (node.type) {
+            case EXPRESSION_TYPE_CONJUNCTION_AND:
+                return (evaluateNode(node.left, data) && evaluateNode(node.right, data));
+            case EXPRESSION_TYPE_CONJUNCTION_OR:
+                return (evaluateNode(node.left, data) || evaluateNode(node.right, data));
+            default: {
+                const Leaf &leaf = m_leaves[node.leaf];
+                return (leaf.accept[leaf.compare(data + leaf.offset, leaf) + 1]);
+            }
+        }
+    }
+
+    std::vector<Leaf> m_leaves;
+    std::vector<Node> m_nodes;
+    int m_root;
+};
+
+}
+
+#endif
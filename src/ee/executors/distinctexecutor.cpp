@@ -76,20 +76,33 @@ bool DistinctExecutor::p_init(AbstractPlanNode*, const catalog::Database* catalo
         /*
          * Has to be a cleaner way to enforce this so the planner doesn't generate plans that will fail this assertion.
          */
-        int index =
-            child_node->getColumnIndexFromGuid(node->getDistinctColumnGuid(),
-                                               catalog_db);
-        assert(index != -1);
-        if (index == -1) {
-            return false;
+        std::vector<int> guids = node->getDistinctColumnGuids();
+        if (guids.empty()) {
+            guids.push_back(node->getDistinctColumnGuid());
         }
-        node->setDistinctColumn(index);
+        std::vector<int> columns;
+        for (int ii = 0; ii < guids.size(); ii++) {
+            int index = child_node->getColumnIndexFromGuid(guids[ii], catalog_db);
+            assert(index != -1);
+            if (index == -1) {
+                return false;
+            }
+            columns.push_back(index);
+        }
+        node->setDistinctColumns(columns);
 
         node->setOutputTable(TableFactory::getCopiedTempTable(node->databaseId(), node->getInputTables()[0]->name(), node->getInputTables()[0], tempTableMemoryInBytes));
 
         assert(node->getDistinctColumn() >= 0);
         this->distinct_column = node->getDistinctColumn();
         this->distinct_column_type = node->getInputTables()[0]->schema()->columnType(this->distinct_column);
+
+        m_hashed = m_found.init(node->getInputTables()[0]->schema(), columns);
+        if (!m_hashed && columns.size() > 1) {
+            VOLT_ERROR("Cannot hash the %d distinct columns of %s",
+                       (int)columns.size(), node->debug().c_str());
+            return false;
+        }
     }
     return (true);
 }
@@ -104,9 +117,25 @@ bool DistinctExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tr
 
     TableIterator iterator = input_table->tableIterator();
     TableTuple tuple(input_table->schema());
-    //
-    // HACK: Use BIGINT for now...
-    //
+
+    if (m_hashed) {
+        m_found.clear();
+        while (iterator.next(tuple)) {
+            bool inserted;
+            m_found.insert(tuple, &inserted);
+            if (inserted && !output_table->insertTuple(tuple)) {
+                VOLT_ERROR("Failed to insert tuple from input table '%s' into"
+                           " output table '%s'",
+                           input_table->name().c_str(),
+                           output_table->name().c_str());
+                return false;
+            }
+        }
+        // the keys are only needed while the input is read
+        m_found.clear();
+        return true;
+    }
+
     std::set<NValue, NValue::ltNValue> found_values;
     while (iterator.next(tuple)) {
         //
@@ -49,6 +49,7 @@
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
+#include "executors/tuplehashset.h"
 #include "plannodes/distinctnode.h"
 
 namespace voltdb {
@@ -64,6 +65,7 @@ class DistinctExecutor : public AbstractExecutor {
         DistinctExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) : AbstractExecutor(engine, abstract_node) {
             this->distinct_column = -1;
             this->distinct_column_type = VALUE_TYPE_INVALID;
+            m_hashed = false;
         }
         ~DistinctExecutor();
     protected:
@@ -72,6 +74,11 @@ class DistinctExecutor : public AbstractExecutor {
 
         int distinct_column;
         ValueType distinct_column_type;
+
+        // Tells the tuples apart by the distinct columns, unless one of them
+        // has a type it cannot hash
+        TupleHashSet m_found;
+        bool m_hashed;
 };
 
 }
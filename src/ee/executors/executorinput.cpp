@@ -0,0 +1,67 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include "executors/executorinput.h"
+#include "common/debuglog.h"
+#include "plannodes/abstractplannode.h"
+#include "storage/table.h"
+
+namespace voltdb {
+
+ExecutorInput::ExecutorInput(AbstractPlanNode *node, int child) :
+    m_table(node->getInputTables()[child]),
+    m_child(node->getChildren()[child]->getExecutor()),
+    m_producer(NULL),
+    m_iterator(node->getInputTables()[child])
+{
+    assert(m_table);
+}
+
+bool ExecutorInput::open(const NValueArray &params, ReadWriteTracker *tracker) {
+    if (m_child != NULL && m_child->isPipelined()) {
+        m_producer = m_child;
+        return m_producer->open(params, tracker);
+    }
+    m_producer = NULL;
+    m_iterator = TableIterator(m_table);
+    return true;
+}
+
+void ExecutorInput::close() {
+    if (m_producer != NULL) {
+        m_producer->close();
+    }
+}
+
+bool ExecutorInput::producesStableTuples() const {
+    // Tuples in a materialized output table stay where they are
+    if (m_child == NULL || !m_child->isPipelined()) {
+        return true;
+    }
+    return m_child->producesStableTuples();
+}
+
+}
@@ -0,0 +1,87 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREEXECUTORINPUT_H
+#define HSTOREEXECUTORINPUT_H
+
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "executors/abstractexecutor.h"
+#include "storage/tableiterator.h"
+
+namespace voltdb {
+
+class AbstractPlanNode;
+class ReadWriteTracker;
+class Table;
+
+/**
+ * The tuples that one child of a plan node feeds into the node's executor.
+ * If the child's executor is pipelined, the tuples are pulled from it one
+ * at a time while it produces them, and they never go through its output
+ * table. Otherwise they are read back from the output table after the
+ * child has executed.
+ */
+class ExecutorInput {
+public:
+    ExecutorInput(AbstractPlanNode *node, int child = 0);
+
+    /** Start reading. For a pipelined child this runs its setup. */
+    bool open(const NValueArray &params, ReadWriteTracker *tracker);
+
+    /**
+     * Updates the given tuple so that it points to the next input tuple.
+     * Returns false once the input is exhausted.
+     */
+    inline bool next(TableTuple &out) {
+        return (m_producer != NULL ? m_producer->next(out) : m_iterator.next(out));
+    }
+
+    /**
+     * Stop reading. This may throw for a pipelined child, like its
+     * p_execute() would have (e.g., for accesses to evicted tuples).
+     */
+    void close();
+
+    /** The child's output table, which has the schema of the input tuples */
+    inline Table* getTable() const { return (m_table); }
+
+    /** The pipelined child that produces the tuples, NULL if it is the table */
+    inline AbstractExecutor* getProducer() const { return (m_producer); }
+
+    /** Whether a tuple stays valid after the following call to next() */
+    bool producesStableTuples() const;
+
+private:
+    Table *m_table;
+    AbstractExecutor *m_child;
+    // the child's executor when it is pipelined, NULL otherwise
+    AbstractExecutor *m_producer;
+    TableIterator m_iterator;
+};
+
+}
+
+#endif
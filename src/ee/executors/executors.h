@@ -52,6 +52,7 @@
 #include "executors/aggregateexecutor.hpp"
 #include "executors/deleteexecutor.h"
 #include "executors/distinctexecutor.h"
+#include "executors/hashjoinexecutor.h"
 #include "executors/indexscanexecutor.h"
 #include "executors/insertexecutor.h"
 #include "executors/limitexecutor.h"
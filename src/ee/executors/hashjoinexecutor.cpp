@@ -0,0 +1,316 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include "hashjoinexecutor.h"
+#include "nestloopexecutor.h"
+#include "common/debuglog.h"
+#include "common/common.h"
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
+#include "common/FatalException.hpp"
+#include "expressions/abstractexpression.h"
+#include "expressions/tuplevalueexpression.h"
+#include "storage/table.h"
+#include "storage/temptable.h"
+#include "storage/tableiterator.h"
+#include "storage/tablefactory.h"
+#include "plannodes/hashjoinnode.h"
+
+namespace voltdb {
+
+namespace {
+
+/** Point every tuple value expression in the tree at the given tuple */
+void setTupleIndexes(AbstractExpression *expression, int tupleIndex) {
+    if (expression == NULL) return;
+    if (expression->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+        dynamic_cast<TupleValueExpression*>(expression)->setTupleIndex(tupleIndex);
+    }
+    setTupleIndexes(const_cast<AbstractExpression*>(expression->getLeft()), tupleIndex);
+    setTupleIndexes(const_cast<AbstractExpression*>(expression->getRight()), tupleIndex);
+}
+
+/** Same as the NestLoopExecutor: resolve predicate columns by table name */
+bool assignPredicateTupleIndexes(AbstractExpression *expression,
+                                 const std::string &oname,
+                                 const std::string &iname) {
+    if (expression == NULL) return true;
+    if (expression->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+        return assignTupleValueIndex(expression, oname, iname);
+    }
+    return (assignPredicateTupleIndexes(const_cast<AbstractExpression*>(expression->getLeft()), oname, iname) &&
+            assignPredicateTupleIndexes(const_cast<AbstractExpression*>(expression->getRight()), oname, iname));
+}
+
+}
+
+bool HashJoinExecutor::p_init(AbstractPlanNode* abstract_node, const catalog::Database* catalog_db, int* tempTableMemoryInBytes) {
+    VOLT_TRACE("init HashJoin Executor");
+    assert(tempTableMemoryInBytes);
+
+    HashJoinPlanNode* node = dynamic_cast<HashJoinPlanNode*>(abstract_node);
+    assert(node);
+
+    // produce the fully joined schema relying on a later projection
+    // to narrow the output later as required.
+    assert(node->getInputTables().size() == 2);
+    const TupleSchema *first = node->getInputTables()[0]->schema();
+    const TupleSchema *second = node->getInputTables()[1]->schema();
+    TupleSchema *schema = TupleSchema::createTupleSchema(first, second);
+
+    int combinedColumnCount = first->columnCount() + second->columnCount();
+    std::string *columnNames = new std::string[combinedColumnCount];
+    std::vector<int> outputColumnGuids;
+    int index = 0;
+
+    for (int ctr = 0; ctr < 2; ctr++) {
+        assert(node->getInputTables()[ctr]);
+        for (int col_ctr = 0, col_cnt = node->getInputTables()[ctr]->columnCount();
+             col_ctr < col_cnt;
+             col_ctr++, index++)
+        {
+            outputColumnGuids.
+                push_back(node->getChildren()[ctr]->getOutputColumnGuids()[col_ctr]);
+            columnNames[index] = node->getInputTables()[ctr]->columnName(col_ctr);
+        }
+    }
+
+    // Set the mapping of column names to column indexes in output tables
+    node->setOutputColumnGuids(outputColumnGuids);
+
+    // create the output table
+    node->setOutputTable(
+        TableFactory::getTempTable(
+            node->getInputTables()[0]->databaseId(), "temp", schema, columnNames, tempTableMemoryInBytes));
+    delete[] columnNames;
+
+    if (node->getJoinType() != JOIN_TYPE_INNER && node->getJoinType() != JOIN_TYPE_LEFT) {
+        VOLT_ERROR("Unsupported join type %s for a hash join",
+                   joinToString(node->getJoinType()).c_str());
+        return false;
+    }
+
+    // The key expressions are split by side, so they need no table
+    // names. By convention eval()'s first tuple is the outer one.
+    const std::vector<AbstractExpression*> &outerKeys = node->getOuterKeyExpressions();
+    const std::vector<AbstractExpression*> &innerKeys = node->getInnerKeyExpressions();
+    if (outerKeys.empty() || outerKeys.size() != innerKeys.size()) {
+        VOLT_ERROR("HashJoin needs the same number of outer and inner key expressions");
+        return false;
+    }
+    for (int i = 0; i < outerKeys.size(); i++) {
+        setTupleIndexes(outerKeys[i], 0);
+        setTupleIndexes(innerKeys[i], 1);
+    }
+    if (!assignPredicateTupleIndexes(node->getPredicate(),
+                                     node->getInputTables()[0]->name(),
+                                     node->getInputTables()[1]->name())) {
+        return false;
+    }
+
+    m_keySize = static_cast<int>(outerKeys.size());
+    m_probeKey.resize(m_keySize);
+    delete m_hashTable;
+    m_hashTable = new HashJoinMapType(16, HashJoinKeyHasher(m_keySize), HashJoinKeyEqualityChecker(m_keySize));
+    return true;
+}
+
+bool HashJoinExecutor::evalKey(const std::vector<AbstractExpression*> &expressions,
+                               const TableTuple &outer, const TableTuple &inner, NValue *values) const {
+    for (int i = 0; i < m_keySize; i++) {
+        NValue value = expressions[i]->eval(&outer, &inner);
+        if (value.isNull()) return false;
+        // integer keys of different widths must hash alike
+        switch (ValuePeeker::peekValueType(value)) {
+            case VALUE_TYPE_TINYINT:
+            case VALUE_TYPE_SMALLINT:
+            case VALUE_TYPE_INTEGER:
+                values[i] = value.castAs(VALUE_TYPE_BIGINT);
+                break;
+            default:
+                values[i] = value;
+        }
+    }
+    return true;
+}
+
+bool HashJoinExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker) {
+    VOLT_DEBUG("executing HashJoin...");
+
+    HashJoinPlanNode* node = dynamic_cast<HashJoinPlanNode*>(abstract_node);
+    assert(node);
+    assert(node->getInputTables().size() == 2);
+
+    // output table must be a temp table
+    TempTable* output_table = dynamic_cast<TempTable*>(node->getOutputTable());
+    assert(output_table);
+
+    Table* outer_table = node->getInputTables()[0];
+    assert(outer_table);
+    Table* inner_table = node->getInputTables()[1];
+    assert(inner_table);
+
+    AbstractExpression *predicate = node->getPredicate();
+    if (predicate) {
+        predicate->substitute(params);
+        VOLT_TRACE ("predicate: %s", predicate->debug(true).c_str());
+    }
+    for (int i = 0; i < m_keySize; i++) {
+        node->getOuterKeyExpressions()[i]->substitute(params);
+        node->getInnerKeyExpressions()[i]->substitute(params);
+    }
+
+    const bool leftJoin = (node->getJoinType() == JOIN_TYPE_LEFT);
+    const int outer_cols = outer_table->columnCount();
+    const int inner_cols = inner_table->columnCount();
+    TableTuple outer_tuple(outer_table->schema());
+    TableTuple inner_tuple(inner_table->schema());
+    TableTuple &joined = output_table->tempTuple();
+
+    // Build on the smaller input
+    const bool buildOuter = (outer_table->activeTupleCount() < inner_table->activeTupleCount());
+    Table *build_table = (buildOuter ? outer_table : inner_table);
+    Table *probe_table = (buildOuter ? inner_table : outer_table);
+    TableTuple &build_tuple = (buildOuter ? outer_tuple : inner_tuple);
+    TableTuple &probe_tuple = (buildOuter ? inner_tuple : outer_tuple);
+    const std::vector<AbstractExpression*> &buildKeys =
+        (buildOuter ? node->getOuterKeyExpressions() : node->getInnerKeyExpressions());
+    const std::vector<AbstractExpression*> &probeKeys =
+        (buildOuter ? node->getInnerKeyExpressions() : node->getOuterKeyExpressions());
+    VOLT_TRACE("building on the %s table", (buildOuter ? "outer" : "inner"));
+
+    // An earlier execution that threw may have left its entries behind,
+    // with keys in the pool that is about to be reused
+    m_hashTable->clear();
+    m_entries.clear();
+    m_keyPool.purge();
+
+    //
+    // Build
+    //
+    m_hashTable->rehash(static_cast<std::size_t>(build_table->activeTupleCount()));
+    TableIterator buildIterator(build_table);
+    while (buildIterator.next(build_tuple)) {
+        HashJoinEntry *entry = static_cast<HashJoinEntry*>(m_keyPool.allocate(sizeof(HashJoinEntry)));
+        entry->m_tuple = build_tuple.address();
+        entry->m_next = NULL;
+        entry->m_matched = false;
+        // unmatched outer tuples are emitted at the end of a left join
+        if (buildOuter && leftJoin) {
+            m_entries.push_back(entry);
+        }
+
+        NValue *values = static_cast<NValue*>(m_keyPool.allocate(sizeof(NValue) * m_keySize));
+        for (int i = 0; i < m_keySize; i++) {
+            new (&values[i]) NValue();
+        }
+        if (!evalKey(buildKeys, outer_tuple, inner_tuple, values)) {
+            continue;
+        }
+        HashJoinKey key = { values };
+        std::pair<HashJoinMapType::iterator, bool> result =
+            m_hashTable->insert(HashJoinMapType::value_type(key, entry));
+        if (!result.second) {
+            entry->m_next = result.first->second;
+            result.first->second = entry;
+        }
+    }
+
+    //
+    // Probe
+    //
+    TableIterator probeIterator(probe_table);
+    while (probeIterator.next(probe_tuple)) {
+        HashJoinEntry *entry = NULL;
+        if (evalKey(probeKeys, outer_tuple, inner_tuple, &m_probeKey[0])) {
+            HashJoinKey key = { &m_probeKey[0] };
+            HashJoinMapType::const_iterator iter = m_hashTable->find(key);
+            if (iter != m_hashTable->end()) {
+                entry = iter->second;
+            }
+        }
+
+        bool match = false;
+        for (; entry != NULL; entry = entry->m_next) {
+            build_tuple.move(entry->m_tuple);
+            if (predicate == NULL || predicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                match = true;
+                entry->m_matched = true;
+                for (int col_ctr = 0; col_ctr < outer_cols; col_ctr++) {
+                    joined.setNValue(col_ctr, outer_tuple.getNValue(col_ctr));
+                }
+                for (int col_ctr = 0; col_ctr < inner_cols; col_ctr++) {
+                    joined.setNValue(col_ctr + outer_cols, inner_tuple.getNValue(col_ctr));
+                }
+                output_table->insertTupleNonVirtual(joined);
+            }
+        }
+
+        //
+        // Left Outer Join
+        //
+        if (!match && leftJoin && !buildOuter) {
+            for (int col_ctr = 0; col_ctr < outer_cols; col_ctr++) {
+                joined.setNValue(col_ctr, outer_tuple.getNValue(col_ctr));
+            }
+            for (int col_ctr = 0; col_ctr < inner_cols; col_ctr++) {
+                NValue value = joined.getNValue(col_ctr + outer_cols);
+                value.setNull();
+                joined.setNValue(col_ctr + outer_cols, value);
+            }
+            output_table->insertTupleNonVirtual(joined);
+        }
+    }
+
+    // Outer tuples that were built on and never matched
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (m_entries[i]->m_matched) continue;
+        outer_tuple.move(m_entries[i]->m_tuple);
+        for (int col_ctr = 0; col_ctr < outer_cols; col_ctr++) {
+            joined.setNValue(col_ctr, outer_tuple.getNValue(col_ctr));
+        }
+        for (int col_ctr = 0; col_ctr < inner_cols; col_ctr++) {
+            NValue value = joined.getNValue(col_ctr + outer_cols);
+            value.setNull();
+            joined.setNValue(col_ctr + outer_cols, value);
+        }
+        output_table->insertTupleNonVirtual(joined);
+    }
+
+    m_hashTable->clear();
+    m_entries.clear();
+    m_keyPool.purge();
+
+    VOLT_TRACE ("result table:\n %s", output_table->debug().c_str());
+    return (true);
+}
+
+HashJoinExecutor::~HashJoinExecutor() {
+    delete m_hashTable;
+}
+
+}
@@ -0,0 +1,121 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREHASHJOINEXECUTOR_H
+#define HSTOREHASHJOINEXECUTOR_H
+
+#include <vector>
+#include "boost/unordered_map.hpp"
+#include "common/common.h"
+#include "common/Pool.hpp"
+#include "common/valuevector.h"
+#include "executors/abstractexecutor.h"
+
+namespace voltdb {
+
+class AbstractExpression;
+
+/**
+ * A join key: the values of the key expressions for one tuple. The values
+ * of the build side live in the executor's key pool.
+ */
+struct HashJoinKey {
+    const NValue *m_values;
+};
+
+struct HashJoinKeyHasher : std::unary_function<HashJoinKey, std::size_t> {
+    HashJoinKeyHasher(int keySize) : m_keySize(keySize) {}
+    inline std::size_t operator()(const HashJoinKey &key) const {
+        std::size_t seed = 0;
+        for (int i = 0; i < m_keySize; i++) {
+            key.m_values[i].hashCombine(seed);
+        }
+        return seed;
+    }
+    int m_keySize;
+};
+
+struct HashJoinKeyEqualityChecker {
+    HashJoinKeyEqualityChecker(int keySize) : m_keySize(keySize) {}
+    inline bool operator()(const HashJoinKey &lhs, const HashJoinKey &rhs) const {
+        for (int i = 0; i < m_keySize; i++) {
+            if (lhs.m_values[i].compare(rhs.m_values[i]) != 0) return false;
+        }
+        return true;
+    }
+    int m_keySize;
+};
+
+/**
+ * A build side tuple. Tuples with the same key are chained.
+ */
+struct HashJoinEntry {
+    char *m_tuple;
+    HashJoinEntry *m_next;
+    bool m_matched;
+};
+
+typedef boost::unordered_map<HashJoinKey,
+                             HashJoinEntry*,
+                             HashJoinKeyHasher,
+                             HashJoinKeyEqualityChecker> HashJoinMapType;
+
+/**
+ * Hash join of two temp tables. The smaller input is loaded into a hash
+ * table on its join keys and the other one probes it, so an equi-join costs
+ * O(N+M) instead of the nested loop's O(N*M). Supports inner and left
+ * outer joins.
+ */
+class HashJoinExecutor : public AbstractExecutor {
+    public:
+        HashJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
+            : AbstractExecutor(engine, abstract_node), m_keySize(0), m_hashTable(NULL) { }
+        ~HashJoinExecutor();
+    protected:
+        bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
+        bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
+
+    private:
+        /**
+         * Evaluate the key expressions into values. Returns false if one
+         * of them is NULL, which never equals anything.
+         */
+        bool evalKey(const std::vector<AbstractExpression*> &expressions,
+                     const TableTuple &outer, const TableTuple &inner, NValue *values) const;
+
+        int m_keySize;
+
+        // build side keys and entries, emptied after each execution
+        Pool m_keyPool;
+        HashJoinMapType *m_hashTable;
+        std::vector<HashJoinEntry*> m_entries;
+
+        // key of the probe side tuple
+        std::vector<NValue> m_probeKey;
+};
+
+}
+
+#endif
@@ -72,6 +72,42 @@
 
 using namespace voltdb;
 
+/**
+ * Returns true if the expression can be evaluated on a tuple in which
+ * only the key and included columns of the index are set
+ */
+static bool coveredByIndex(const AbstractExpression *expr, const TableIndex *index)
+{
+    if (expr == NULL) {
+        return true;
+    }
+    switch (expr->getExpressionType()) {
+        case EXPRESSION_TYPE_VALUE_TUPLE:
+            return index->coversColumn(static_cast<const TupleValueExpression*>(expr)->getColumnId());
+        case EXPRESSION_TYPE_VALUE_CONSTANT:
+        case EXPRESSION_TYPE_VALUE_PARAMETER:
+            return true;
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+        case EXPRESSION_TYPE_CONJUNCTION_AND:
+        case EXPRESSION_TYPE_CONJUNCTION_OR:
+        case EXPRESSION_TYPE_OPERATOR_NOT:
+        case EXPRESSION_TYPE_OPERATOR_PLUS:
+        case EXPRESSION_TYPE_OPERATOR_MINUS:
+        case EXPRESSION_TYPE_OPERATOR_MULTIPLY:
+        case EXPRESSION_TYPE_OPERATOR_DIVIDE:
+            return (coveredByIndex(expr->getLeft(), index) &&
+                    coveredByIndex(expr->getRight(), index));
+        default:
+            // don't know which columns it reads
+            return false;
+    }
+}
+
 bool IndexScanExecutor::p_init(AbstractPlanNode *abstractNode,
                                const catalog::Database* catalogDb, int* tempTableMemoryInBytes)
 {
@@ -330,6 +366,23 @@ bool IndexScanExecutor::p_init(AbstractPlanNode *abstractNode,
             m_targetTable->schema()->columnType(m_aggregateColumnIdx);
     }
 
+    //
+    // INDEX-ONLY SCAN
+    // When everything that we read of a tuple is in the index entry, the
+    // scan is answered from the index without touching the tuples, which
+    // also saves their LRU updates and evicted accesses in the anti-cache
+    //
+    m_coveringScan = canScanIndexOnly();
+    if (m_coveringScan)
+    {
+        const int length = m_targetTable->schema()->tupleLength() + TUPLE_HEADER_SIZE;
+        m_coveredTupleBackingStore = new char[length];
+        ::memset(m_coveredTupleBackingStore, 0, length);
+        m_coveredTuple = TableTuple(m_coveredTupleBackingStore, m_targetTable->schema());
+        VOLT_DEBUG("Index-only scan of %s.%s", m_targetTable->name().c_str(),
+                   m_index->getName().c_str());
+    }
+
     //
     // Miscellanous Information
     //
@@ -339,7 +392,115 @@ bool IndexScanExecutor::p_init(AbstractPlanNode *abstractNode,
     return true;
 }
 
+bool IndexScanExecutor::canScanIndexOnly() const
+{
+    // Without a projection we would have to hand out whole tuples, and
+    // the inline aggregate keeps the address of its tuple
+    if (!m_index->supportsCoveringReads() ||
+        m_projectionNode == NULL || m_aggregateNode != NULL) {
+        return false;
+    }
+    if (m_distinctNode != NULL && !m_index->coversColumn(m_distinctColumn)) {
+        return false;
+    }
+    for (int ctr = 0; ctr < m_numOfColumns; ctr++) {
+        if (!coveredByIndex(m_projectionExpressions[ctr], m_index)) {
+            return false;
+        }
+    }
+    return (coveredByIndex(m_node->getEndExpression(), m_index) &&
+            coveredByIndex(m_node->getPredicate(), m_index));
+}
+
+bool IndexScanExecutor::supportsPipelining() const
+{
+    // The inline aggregate only has its answer at the very end
+    return (m_aggregateNode == NULL);
+}
+
+bool IndexScanExecutor::producesStableTuples() const
+{
+#ifdef ANTICACHE_COUNTER
+    // A merged tuple is a copy that is freed on the next call
+    return false;
+#else
+    // We hand out the tuples of the TargetTable unless we project them
+    return (m_projectionNode == NULL);
+#endif
+}
+
+bool IndexScanExecutor::p_compile()
+{
+    // Both expressions are evaluated on the tuples of the TargetTable
+    const TupleSchema *schema = m_targetTable->schema();
+    bool compiled = false;
+    if (m_compiledEndExpression.compile(m_node->getEndExpression(), schema) ||
+        m_endProgram.compile(m_node->getEndExpression(), schema)) {
+        compiled = true;
+    }
+    if (m_compiledPostExpression.compile(m_node->getPredicate(), schema) ||
+        m_postProgram.compile(m_node->getPredicate(), schema)) {
+        compiled = true;
+    }
+    return (compiled);
+}
+
 bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
+{
+    if (!p_open(params, tracker))
+    {
+        return false;
+    }
+
+    TableTuple tuple(m_outputTable->schema());
+    while (p_next(tuple))
+    {
+        m_outputTable->insertTupleNonVirtual(tuple);
+    }
+
+    //
+    // Inline Aggregate
+    //
+    if (m_aggregateNode != NULL && m_aggregateIsSet) {
+        m_tuple.move(m_aggregateTupleAddress);
+        //
+        // Inline Projection
+        //
+        if (m_projectionNode != NULL) {
+            TableTuple &temp_tuple = m_outputTable->tempTuple();
+            if (m_projectionAllTupleArray != NULL) {
+                for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
+                    temp_tuple.setNValue(ctr,
+                                         m_tuple.getNValue(m_projectionAllTupleArray[ctr]));
+                }
+            } else {
+                for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
+                    temp_tuple.setNValue(ctr,
+                                         m_projectionExpressions[ctr]->eval(&m_tuple, NULL));
+                }
+            }
+            m_outputTable->insertTupleNonVirtual(temp_tuple);
+        //
+        // Straight Insert
+        //
+        } else {
+            m_outputTable->insertTupleNonVirtual(m_tuple);
+        }
+        #ifdef ANTICACHE
+        if (m_hasEvictedTable) {
+            // update the tuple in the LRU eviction chain
+            m_targetTable->m_executorContext->getAntiCacheEvictionManager()->
+                updateTuple(m_targetTable, &m_tuple, false);
+        }
+        #endif
+    }
+
+    p_close();
+    VOLT_TRACE("Index Scanned :\n %s", m_outputTable->debug().c_str());
+    return true;
+}
+
+bool IndexScanExecutor::p_open(const NValueArray &params, ReadWriteTracker *tracker)
 {
     assert(m_node);
     assert(m_node == dynamic_cast<IndexScanPlanNode*>(abstract_node));
@@ -349,6 +510,7 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
     assert(m_targetTable == m_node->getTargetTable());
     VOLT_TRACE("IndexScan: %s.%s", m_targetTable->name().c_str(),
                m_index->getName().c_str());
+    m_tracker = tracker;
 
     // INLINE PROJECTION
     // Set params to expression tree via substitute()
@@ -371,9 +533,9 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
     // We can also perform a really simple inline aggregate to get a
     // single min or max value of the input table.
     //
-    bool aggregate_isset = false;
-    NValue aggregate_value;
-    void* aggregate_tuple_address = NULL;
+    m_aggregateIsSet = false;
+    m_aggregateValue = NValue();
+    m_aggregateTupleAddress = NULL;
 
     //
     // INLINE DISTINCT
@@ -427,31 +589,47 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
     //
     // END EXPRESSION
     //
-    AbstractExpression* end_expression = m_node->getEndExpression();
-    if (end_expression != NULL)
+    // The compiled programs read the parameters straight from params
+    m_params = &params;
+    m_useEndProgram = (isCompiled() && m_endProgram.isCompiled());
+    m_usePostProgram = (isCompiled() && m_postProgram.isCompiled());
+
+    m_endExpression = m_node->getEndExpression();
+    if (m_endExpression != NULL)
     {
-        if (m_needsSubstituteEndExpression) {
-            end_expression->substitute(params);
+        if (m_needsSubstituteEndExpression && !m_useEndProgram) {
+            m_endExpression->substitute(params);
         }
-        VOLT_TRACE("End Expression:\n%s", end_expression->debug(true).c_str());
+        VOLT_TRACE("End Expression:\n%s", m_endExpression->debug(true).c_str());
     }
 
     //
     // POST EXPRESSION
     //
-    AbstractExpression* post_expression = m_node->getPredicate();
-    if (post_expression != NULL)
+    m_postExpression = m_node->getPredicate();
+    if (m_postExpression != NULL)
     {
-        if (m_needsSubstitutePostExpression) {
-            post_expression->substitute(params);
+        if (m_needsSubstitutePostExpression && !m_usePostProgram) {
+            m_postExpression->substitute(params);
         }
-        VOLT_DEBUG("Post Expression:\n%s", post_expression->debug(true).c_str());
+        VOLT_DEBUG("Post Expression:\n%s", m_postExpression->debug(true).c_str());
     }
 
+    // Once this fragment has been compiled, evaluate both of them
+    // directly on the tuple storage (unless this execution's parameters
+    // have types that the compiled form cannot compare)
+    m_useCompiledEndExpression = (isCompiled() &&
+                                  m_compiledEndExpression.isCompiled() &&
+                                  m_compiledEndExpression.bind());
+    m_useCompiledPostExpression = (isCompiled() &&
+                                   m_compiledPostExpression.isCompiled() &&
+                                   m_compiledPostExpression.bind());
+
     assert (m_index);
     assert (m_index == m_targetTable->index(m_node->getTargetIndexName()));
 
-    int tuples_written = 0;
+    m_tuplesWritten = 0;
+    m_scanDone = false;
 
     //
     // An index scan has three parts:
@@ -460,10 +638,9 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
     //  end_expression is false.
     //  If it is, then we stop scanning. Otherwise...
     //  (3) Check whether the tuple satisfies the post expression.
-    //      If it does, then add it to the output table
+    //      If it does, then hand it out in p_next()
     //
     // Use our search key to prime the index iterator
-    // Now loop through each tuple given to us by the iterator
     //
     if (m_numOfSearchkeys > 0)
     {
@@ -508,8 +685,36 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
     // Anti-Cache Variables
     #ifdef ANTICACHE
     AntiCacheEvictionManager* eviction_manager = m_targetTable->m_executorContext->getAntiCacheEvictionManager();
-    bool hasEvictedTable = (eviction_manager != NULL && m_targetTable->getEvictedTable() != NULL);
-    bool blockingMergeSuccessful = false;
+    m_hasEvictedTable = (eviction_manager != NULL && m_targetTable->getEvictedTable() != NULL);
+    m_blockingMergeSuccessful = false;
+    #ifdef ANTICACHE_COUNTER
+    m_freeMergedTuple = false;
+    #endif
+    #endif
+
+    return true;
+}
+
+bool IndexScanExecutor::p_next(TableTuple &out)
+{
+#if defined(ANTICACHE) && defined(ANTICACHE_COUNTER)
+    // The merged copy that we handed out last time is not needed anymore
+    if (m_freeMergedTuple) {
+        delete[] m_tuple.address();
+        m_freeMergedTuple = false;
+    }
+#endif
+
+    //
+    // INLINE LIMIT
+    //
+    if (m_scanDone || (m_limitNode != NULL && m_tuplesWritten >= m_limitSize)) {
+        VOLT_DEBUG("Hit limit of %d tuples. Halting scan", m_tuplesWritten);
+        return false;
+    }
+
+    #ifdef ANTICACHE
+    AntiCacheEvictionManager* eviction_manager = m_targetTable->m_executorContext->getAntiCacheEvictionManager();
     #endif
 
     //
@@ -520,20 +725,20 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
            ((m_lookupType != INDEX_LOOKUP_TYPE_EQ || m_numOfSearchkeys == 0) &&
             !(m_tuple = m_index->nextValue()).isNullTuple()))
     {
-        blockingMergeSuccessful = false;
         m_targetTable->updateTupleAccessCount();
         
         // Read/Write Set Tracking
-        if (tracker != NULL) {
-            tracker->markTupleRead(m_targetTable, &m_tuple);
+        if (m_tracker != NULL) {
+            m_tracker->markTupleRead(m_targetTable, &m_tuple);
         }
         
         #ifdef ANTICACHE
+        m_blockingMergeSuccessful = false;
 #ifdef ANTICACHE_COUNTER
         m_tuple.setTempMergedFalse();
 #endif
         // We are pointing to an entry for an evicted tuple
-        if (hasEvictedTable && m_tuple.isEvicted()) {
+        if (m_hasEvictedTable && !m_coveringScan && m_tuple.isEvicted()) {
             VOLT_DEBUG("Tuple in index scan on %s is evicted. Current txn will have to be restarted...",
                        m_targetTable->name().c_str());      
 
@@ -555,10 +760,10 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
 #ifdef ANTICACHE_COUNTER
                 if (eviction_manager->m_update_access)
 #endif
-                    blockingMergeSuccessful = eviction_manager->blockingMerge();
+                    m_blockingMergeSuccessful = eviction_manager->blockingMerge();
             } else {
-                //blockingMergeSuccessful = eviction_manager->blockingMerge();
-                blockingMergeSuccessful = false;
+                //m_blockingMergeSuccessful = eviction_manager->blockingMerge();
+                m_blockingMergeSuccessful = false;
                 continue;
             }
         }
@@ -566,7 +771,7 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
         // MJG TEST: If we merged, maybe we need to grab the tuple again. Let's try
         // we need to check again which way we want to get the index based upon the 
         // INDEX_LOOKUP_TYPE. 
-        if (blockingMergeSuccessful) {
+        if (m_blockingMergeSuccessful) {
             //printf("Scan from merge.\n");
             VOLT_TRACE("grabbing tuple again");
             if (m_lookupType == INDEX_LOOKUP_TYPE_EQ) {
@@ -591,26 +796,40 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
 
         VOLT_TRACE("Merged Tuple: %s", m_tuple.debug(m_targetTable->name()).c_str());
         #endif        
+
+        // An index-only scan reads the columns from the index entry
+        if (m_coveringScan) {
+            m_index->copyCoveredValues(&m_coveredTuple);
+        }
+        const TableTuple &tuple = (m_coveringScan ? m_coveredTuple : m_tuple);
+
         //
         // First check whether the end_expression is now false
         //
-        if (end_expression != NULL &&
-            end_expression->eval(&m_tuple, NULL).isFalse()) {
+        if (m_endExpression != NULL &&
+            (m_useCompiledEndExpression ? !m_compiledEndExpression.eval(tuple) :
+             m_useEndProgram ? !m_endProgram.evalPredicate(&tuple, NULL, *m_params) :
+                               m_endExpression->eval(&tuple, NULL).isFalse())) {
             VOLT_DEBUG("End Expression evaluated to false, stopping scan");
-            break;
+            m_scanDone = true;
+            return false;
         }
         
-        if (blockingMergeSuccessful) {
+        #ifdef ANTICACHE
+        if (m_blockingMergeSuccessful) {
             VOLT_DEBUG("tuple merged and End Expression evaluated to true, continuing scan");
         }
+        #endif
         //
         // Then apply our post-predicate to do further filtering
         //
-        if (post_expression == NULL ||
-            post_expression->eval(&m_tuple, NULL).isTrue()) {
+        if (m_postExpression == NULL ||
+            (m_useCompiledPostExpression ? m_compiledPostExpression.eval(tuple) :
+             m_usePostProgram ? m_postProgram.evalPredicate(&tuple, NULL, *m_params) :
+                                m_postExpression->eval(&tuple, NULL).isTrue())) {
 
             #ifdef ANTICACHE
-            if (hasEvictedTable) {
+            if (m_hasEvictedTable && !m_coveringScan) {
                 // update the tuple in the LRU eviction chain
                 eviction_manager->updateTuple(m_targetTable, &m_tuple, false);
             }
@@ -620,7 +839,7 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
             // Inline Distinct
             //
             if (m_distinctNode != NULL) {
-                NValue value = m_tuple.getNValue(m_distinctColumn);
+                NValue value = tuple.getNValue(m_distinctColumn);
                 // insert returns a pair<iterator, bool_succeeded>.
                 // Don't want to continue if insert failed (value
                 // was already present).
@@ -635,14 +854,14 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
                 // search for a min or max value.
                 // m_aggregateCompareValue is either "greater-than" or
                 // "less-than".
-                if (aggregate_isset == false ||
+                if (m_aggregateIsSet == false ||
                     m_aggregateCompareValue == VALUE_COMPARE_LESSTHAN ?
-                    m_tuple.getNValue(m_aggregateColumnIdx).op_lessThan(aggregate_value).isTrue() :
-                    m_tuple.getNValue(m_aggregateColumnIdx).op_greaterThan(aggregate_value).isTrue())
+                    m_tuple.getNValue(m_aggregateColumnIdx).op_lessThan(m_aggregateValue).isTrue() :
+                    m_tuple.getNValue(m_aggregateColumnIdx).op_greaterThan(m_aggregateValue).isTrue())
                 {
-                    aggregate_value = m_tuple.getNValue(m_aggregateColumnIdx);
-                    aggregate_tuple_address = m_tuple.address();
-                    aggregate_isset = true;
+                    m_aggregateValue = m_tuple.getNValue(m_aggregateColumnIdx);
+                    m_aggregateTupleAddress = m_tuple.address();
+                    m_aggregateIsSet = true;
                 }
             //
             // Inline Projection
@@ -654,33 +873,30 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
                     VOLT_DEBUG("sweet, all tuples");
                     for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
                         temp_tuple.setNValue(ctr,
-                                             m_tuple.getNValue(m_projectionAllTupleArray[ctr]));
+                                             tuple.getNValue(m_projectionAllTupleArray[ctr]));
                     }
                 } else {
                     for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
                         temp_tuple.setNValue(ctr,
-                                             m_projectionExpressions[ctr]->eval(&m_tuple, NULL));
+                                             m_projectionExpressions[ctr]->eval(&tuple, NULL));
                     }
                 }
-                m_outputTable->insertTupleNonVirtual(temp_tuple);
-                tuples_written++;
+                out = temp_tuple;
+                m_tuplesWritten++;
+#if defined(ANTICACHE) && defined(ANTICACHE_COUNTER)
+                m_freeMergedTuple = m_tuple.isTempMerged();
+#endif
+                return true;
             //
-            // Straight Insert
+            // Straight Hand Out
             //
             } else {
-                //
-                // Try to put the tuple into our output table
-                //
-                m_outputTable->insertTupleNonVirtual(m_tuple);
-                tuples_written++;
-            }
-            
-            //
-            // INLINE LIMIT
-            //
-            if (m_limitNode != NULL && tuples_written >= m_limitSize) {
-                VOLT_DEBUG("Hit limit of %d tuples. Halting scan", tuples_written);
-                break;
+                out = m_tuple;
+                m_tuplesWritten++;
+#if defined(ANTICACHE) && defined(ANTICACHE_COUNTER)
+                m_freeMergedTuple = m_tuple.isTempMerged();
+#endif
+                return true;
             }
         }
 #if defined(ANTICACHE) && defined(ANTICACHE_COUNTER)
@@ -691,61 +907,31 @@ bool IndexScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *t
 #endif
     } // WHILE
 
-    //
-    // Inline Aggregate
-    //
-    if (m_aggregateNode != NULL && aggregate_isset) {
-        m_tuple.move(aggregate_tuple_address);
-        //
-        // Inline Projection
-        //
-        if (m_projectionNode != NULL) {
-            TableTuple &temp_tuple = m_outputTable->tempTuple();
-            if (m_projectionAllTupleArray != NULL) {
-                for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
-                    temp_tuple.setNValue(ctr,
-                                         m_tuple.getNValue(m_projectionAllTupleArray[ctr]));
-                }
-            } else {
-                for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
-                    temp_tuple.setNValue(ctr,
-                                         m_projectionExpressions[ctr]->eval(&m_tuple, NULL));
-                }
-            }
-            m_outputTable->insertTupleNonVirtual(temp_tuple);
-            #ifdef ANTICACHE
-            if (hasEvictedTable) {
-                // update the tuple in the LRU eviction chain
-                eviction_manager->updateTuple(m_targetTable, &m_tuple, false);
-            }
-            #endif
-        //
-        // Straight Insert
-        //
-        } else {
-            m_outputTable->insertTupleNonVirtual(m_tuple);
-            #ifdef ANTICACHE
-            if (hasEvictedTable) {
-                // update the tuple in the LRU eviction chain
-                eviction_manager->updateTuple(m_targetTable, &m_tuple, false);
-            }
-            #endif
-        }
+    m_scanDone = true;
+    return false;
+}
+
+void IndexScanExecutor::p_close()
+{
+#if defined(ANTICACHE) && defined(ANTICACHE_COUNTER)
+    if (m_freeMergedTuple) {
+        delete[] m_tuple.address();
+        m_freeMergedTuple = false;
     }
-    
+#endif
+
     #ifdef ANTICACHE
     // throw exception indicating evicted blocks are needed
-    if (hasEvictedTable && !blockingMergeSuccessful && eviction_manager->hasEvictedAccesses()) {
+    AntiCacheEvictionManager* eviction_manager = m_targetTable->m_executorContext->getAntiCacheEvictionManager();
+    if (m_hasEvictedTable && !m_blockingMergeSuccessful && eviction_manager->hasEvictedAccesses()) {
         VOLT_DEBUG("Throwing EvictedaccessException\n");
         eviction_manager->throwEvictedAccessException();
     }
     #endif
-    
-    VOLT_TRACE("Index Scanned :\n %s", m_outputTable->debug().c_str());
-    return true;
 }
 
 IndexScanExecutor::~IndexScanExecutor() {
     delete [] m_searchKeyBackingStore;
+    delete [] m_coveredTupleBackingStore;
     delete [] m_projectionExpressions;
 }
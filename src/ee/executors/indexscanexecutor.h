@@ -51,6 +51,8 @@
 #include "catalog/catalogtype.h"
 #include "catalog/table.h"
 #include "executors/abstractexecutor.h"
+#include "executors/compiledpredicate.h"
+#include "expressions/expressionprogram.h"
 
 #include "boost/shared_array.hpp"
 #include "boost/unordered_set.hpp"
@@ -77,15 +79,28 @@ class IndexScanExecutor : public AbstractExecutor
 {
 public:
     IndexScanExecutor(VoltDBEngine* engine, AbstractPlanNode* abstractNode)
-        : AbstractExecutor(engine, abstractNode), m_searchKeyBackingStore(NULL)
+        : AbstractExecutor(engine, abstractNode), m_searchKeyBackingStore(NULL),
+          m_coveredTupleBackingStore(NULL)
     {
         m_projectionExpressions = NULL;
+#if defined(ANTICACHE) && defined(ANTICACHE_COUNTER)
+        m_freeMergedTuple = false;
+#endif
     }
     ~IndexScanExecutor();
 
+    bool supportsPipelining() const;
+    bool producesStableTuples() const;
+
 protected:
     bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
     bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
+    bool p_compile();
+    bool p_open(const NValueArray &params, ReadWriteTracker *tracker);
+    bool p_next(TableTuple &out);
+    void p_close();
+
+    bool canScanIndexOnly() const;
 
     // Data in this class is arranged roughly in the order it is read for
     // p_execute(). Please don't reshuffle it only in the name of beauty.
@@ -141,6 +156,41 @@ protected:
     TableTuple m_dummy;
     TableTuple m_tuple;
 
+    // Index-only scan: the key and included columns of the entries are
+    // copied into m_coveredTuple, which has the schema of the TargetTable
+    bool m_coveringScan;
+    TableTuple m_coveredTuple;
+
+    // Scan state between p_open() and p_close()
+    ReadWriteTracker* m_tracker;
+    AbstractExpression* m_endExpression;
+    AbstractExpression* m_postExpression;
+    bool m_useCompiledEndExpression;
+    bool m_useCompiledPostExpression;
+    bool m_useEndProgram;
+    bool m_usePostProgram;
+    const NValueArray* m_params;
+    int m_tuplesWritten;
+    bool m_scanDone;
+    bool m_aggregateIsSet;
+    NValue m_aggregateValue;
+    void* m_aggregateTupleAddress;
+#ifdef ANTICACHE
+    bool m_hasEvictedTable;
+    bool m_blockingMergeSuccessful;
+#ifdef ANTICACHE_COUNTER
+    // the tuple handed out last is a merged copy that we have to free
+    bool m_freeMergedTuple;
+#endif
+#endif
+
+    // Compiled forms of the end and post expressions. The programs are
+    // only used for the expressions that CompiledPredicate can't handle.
+    CompiledPredicate m_compiledEndExpression;
+    CompiledPredicate m_compiledPostExpression;
+    ExpressionProgram m_endProgram;
+    ExpressionProgram m_postProgram;
+
     // arrange the memory mgmt aids at the bottom to try to maximize
     // cache hits (by keeping them out of the way of useful runtime data)
     boost::shared_array<bool> m_needsSubstituteSearchKeyPtr;
@@ -151,6 +201,7 @@ protected:
     boost::shared_array<int> m_searchKeyAllParamArrayPtr;
     // So Valgrind doesn't complain:
     char* m_searchKeyBackingStore;
+    char* m_coveredTupleBackingStore;
 };
 
 }
@@ -47,6 +47,7 @@
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
+#include "executors/executorinput.h"
 #include "plannodes/limitnode.h"
 #include "storage/table.h"
 #include "storage/temptable.h"
@@ -79,50 +80,98 @@ LimitExecutor::p_init(AbstractPlanNode* abstract_node,
                                               node->getInputTables()[0]->name(),
                                               node->getInputTables()[0],
                                               tempTableMemoryInBytes));
+        m_input = new ExecutorInput(node, 0);
     }
     return true;
 }
 
+bool LimitExecutor::supportsPipelining() const
+{
+    return !abstract_node->isInline();
+}
+
+bool LimitExecutor::producesStableTuples() const
+{
+    // We hand out our input tuples as they are
+    return m_input->producesStableTuples();
+}
+
 bool
 LimitExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
 {
-    LimitPlanNode* node = dynamic_cast<LimitPlanNode*>(abstract_node);
-    assert(node);
-    Table* output_table = node->getOutputTable();
+    Table* output_table = abstract_node->getOutputTable();
     assert(output_table);
-    Table* input_table = node->getInputTables()[0];
-    assert(input_table);
 
     //
-    // Grab the iterator for our input table, and loop through until
-    // we have copy enough tuples for the limit specified by the node
+    // Loop through our input until we have copied enough tuples for
+    // the limit specified by the node
     //
-    TableTuple tuple(input_table->schema());
-    TableIterator iterator(input_table);
-    int tuple_ctr = 0;
+    if (!p_open(params, tracker))
+    {
+        return false;
+    }
+    TableTuple tuple(output_table->schema());
+    while (p_next(tuple))
+    {
+        if (!output_table->insertTuple(tuple))
+        {
+            VOLT_ERROR("Failed to insert tuple from input table '%s' into"
+                       " output table '%s'",
+                       m_input->getTable()->name().c_str(),
+                       output_table->name().c_str());
+            return false;
+        }
+    }
+    p_close();
+
+    return true;
+}
+
+bool
+LimitExecutor::p_open(const NValueArray &params, ReadWriteTracker *tracker)
+{
+    LimitPlanNode* node = dynamic_cast<LimitPlanNode*>(abstract_node);
+    assert(node);
+    assert(m_input);
 
-    int limit = 0, offset = 0;
-    bool start = (node->getOffset() == 0);
-    node->getLimitAndOffsetByReference(params, limit, offset);
+    m_limit = 0;
+    m_offset = 0;
+    node->getLimitAndOffsetByReference(params, m_limit, m_offset);
+    m_tupleCount = 0;
+    return m_input->open(params, tracker);
+}
 
-    while (iterator.next(tuple) && (tuple_ctr < limit))
+bool
+LimitExecutor::p_next(TableTuple &tuple)
+{
+    if (m_tupleCount >= m_limit)
+    {
+        return false;
+    }
+    // Skip the first offset tuples
+    while (m_offset > 0)
     {
-        // TODO: need a way to skip / iterate N items.
-        if (start) {
-            if (!output_table->insertTuple(tuple))
-            {
-                VOLT_ERROR("Failed to insert tuple from input table '%s' into"
-                           " output table '%s'",
-                           input_table->name().c_str(),
-                           output_table->name().c_str());
-                return false;
-            }
-            tuple_ctr++;
-        } else
+        if (!m_input->next(tuple))
         {
-            start = (iterator.getLocation() >= offset);
+            return false;
         }
+        m_offset--;
     }
-
+    if (!m_input->next(tuple))
+    {
+        return false;
+    }
+    m_tupleCount++;
     return true;
 }
+
+void
+LimitExecutor::p_close()
+{
+    m_input->close();
+}
+
+LimitExecutor::~LimitExecutor()
+{
+    delete m_input;
+}
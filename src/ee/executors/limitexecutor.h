@@ -54,6 +54,7 @@ namespace voltdb
 {
     class UndoLog;
     class ReadWriteSet;
+    class ExecutorInput;
 
     /**
      *
@@ -64,14 +65,27 @@ namespace voltdb
         LimitExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node)
             : AbstractExecutor(engine, abstract_node)
         {
+            m_input = NULL;
         }
 
-        ~LimitExecutor() {
-        }
+        ~LimitExecutor();
+
+        bool supportsPipelining() const;
+        bool producesStableTuples() const;
+        bool acceptsPipelinedInput(int child, bool stable) const { return true; }
 
     protected:
         bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
         bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
+        bool p_open(const NValueArray &params, ReadWriteTracker *tracker);
+        bool p_next(TableTuple &tuple);
+        void p_close();
+
+    private:
+        ExecutorInput* m_input;
+        int m_limit;
+        int m_offset;
+        int m_tupleCount;
     };
 
 }
@@ -187,6 +187,14 @@ bool NestLoopExecutor::p_init(AbstractPlanNode* abstract_node, const catalog::Da
 }
 
 
+bool NestLoopExecutor::p_compile() {
+    // The outer tuple is the first one and the inner tuple the second
+    NestLoopPlanNode* node = static_cast<NestLoopPlanNode*>(abstract_node);
+    return m_predicateProgram.compile(node->getPredicate(),
+                                      node->getInputTables()[0]->schema(),
+                                      node->getInputTables()[1]->schema());
+}
+
 bool NestLoopExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker) {
     VOLT_DEBUG("executing NestLoop...");
 
@@ -214,7 +222,8 @@ bool NestLoopExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tr
     // Join Expression
     //
     AbstractExpression *predicate = node->getPredicate();
-    if (predicate) {
+    const bool useProgram = (isCompiled() && m_predicateProgram.isCompiled());
+    if (predicate && !useProgram) {
         predicate->substitute(params);
         VOLT_TRACE ("predicate: %s", predicate == NULL ?
                     "NULL" : predicate->debug(true).c_str());
@@ -238,7 +247,9 @@ bool NestLoopExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tr
 
         TableIterator iterator1(inner_table);
         while (iterator1.next(inner_tuple)) {
-            if (predicate == NULL || predicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+            if (predicate == NULL ||
+                (useProgram ? m_predicateProgram.evalPredicate(&outer_tuple, &inner_tuple, params) :
+                              predicate->eval(&outer_tuple, &inner_tuple).isTrue())) {
                 // Matched! Complete the joined tuple with the inner column values.
                 for (int col_ctr = 0; col_ctr < inner_cols; col_ctr++) {
                     joined.setNValue(col_ctr + outer_cols, inner_tuple.getNValue(col_ctr));
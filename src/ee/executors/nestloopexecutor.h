@@ -49,11 +49,21 @@
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
+#include "expressions/expressionprogram.h"
 
 namespace voltdb {
 
 class UndoLog;
 class ReadWriteSet;
+class AbstractExpression;
+
+/**
+ * Point a tuple value expression of a join predicate at the outer (0) or
+ * inner (1) tuple, going by its table name
+ */
+bool assignTupleValueIndex(AbstractExpression *ae,
+                           const std::string &oname,
+                           const std::string &iname);
 
 /**
  *
@@ -64,6 +74,10 @@ class NestLoopExecutor : public AbstractExecutor {
     protected:
         bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
         bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
+        bool p_compile();
+
+    private:
+        ExpressionProgram m_predicateProgram;
 };
 
 }
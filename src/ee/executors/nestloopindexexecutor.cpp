@@ -43,9 +43,11 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include "nestloopindexexecutor.h"
+#include "executorinput.h"
 #include "common/debuglog.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
@@ -66,6 +68,65 @@
 
 using namespace voltdb;
 
+namespace {
+
+/**
+ * Order of the outer tuples of a batch by their search keys, so that
+ * probes for nearby keys follow each other and equal keys are probed back
+ * to back. Ties keep the order of the input.
+ */
+struct SearchKeyLess {
+    SearchKeyLess(const std::vector<TableTuple> &keys, int columns) :
+        m_keys(keys), m_columns(columns) {}
+
+    bool operator()(int lhs, int rhs) const {
+        for (int ctr = 0; ctr < m_columns; ctr++) {
+            const int cmp = m_keys[lhs].getNValue(ctr).compare(m_keys[rhs].getNValue(ctr));
+            if (cmp != 0) {
+                return (cmp < 0);
+            }
+        }
+        return (lhs < rhs);
+    }
+
+    const std::vector<TableTuple> &m_keys;
+    const int m_columns;
+};
+
+bool searchKeysEqual(const TableTuple &lhs, const TableTuple &rhs, int columns) {
+    for (int ctr = 0; ctr < columns; ctr++) {
+        if (lhs.getNValue(ctr).compare(rhs.getNValue(ctr)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool searchKeyHasNull(const TableTuple &key, int columns) {
+    for (int ctr = 0; ctr < columns; ctr++) {
+        if (key.getNValue(ctr).isNull()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Compare the key of an inner tuple in the index with a search key
+ */
+int compareToSearchKey(const TableTuple &tuple, const std::vector<int> &columns,
+                       const TableTuple &key) {
+    for (int ctr = 0; ctr < (int)columns.size(); ctr++) {
+        const int cmp = tuple.getNValue(columns[ctr]).compare(key.getNValue(ctr));
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+    return 0;
+}
+
+}
+
 bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstract_node,
                                    const catalog::Database* catalog_db, int* tempTableMemoryInBytes)
 {
@@ -173,7 +234,7 @@ bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstract_node,
 
     inner_table = dynamic_cast<PersistentTable*>(inline_node->getTargetTable());
     assert(inner_table);
-    inner_catalogTable = catalog_db->tables().get(inner_table->name());
+    inner_catalogTable = (catalog_db != NULL ? catalog_db->tables().get(inner_table->name()) : NULL);
 
     assert(node->getInputTables().size() == 1);
     outer_table = node->getInputTables()[0];
@@ -197,9 +258,33 @@ bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstract_node,
     index_values.move( index_values_backing_store - TUPLE_HEADER_SIZE);
     index_values.setAllNulls();
 
+    //
+    // Space for a batch of outer tuples and their search keys
+    //
+    const int outerLength = outer_table->schema()->tupleLength() + TUPLE_HEADER_SIZE;
+    const int keyLength = index->getKeySchema()->tupleLength() + TUPLE_HEADER_SIZE;
+    m_batchOuterBackingStore = new char[NESTLOOPINDEX_BATCH_SIZE * outerLength];
+    m_batchKeysBackingStore = new char[NESTLOOPINDEX_BATCH_SIZE * keyLength];
+    ::memset(m_batchKeysBackingStore, 0, NESTLOOPINDEX_BATCH_SIZE * keyLength);
+    m_batchOuter.assign(NESTLOOPINDEX_BATCH_SIZE, TableTuple(outer_table->schema()));
+    m_batchKeys.clear();
+    for (int ctr = 0; ctr < NESTLOOPINDEX_BATCH_SIZE; ctr++) {
+        m_batchKeys.push_back(TableTuple(m_batchKeysBackingStore + (ctr * keyLength),
+                                         index->getKeySchema()));
+        m_batchKeys.back().setAllNulls();
+    }
+    m_batchOrder.resize(NESTLOOPINDEX_BATCH_SIZE);
+    m_lastMatchesComplete = false;
+    m_rangeStart = 0;
+
     return true;
 }
 
+void NestLoopIndexExecutor::setBatchSize(int size)
+{
+    m_batchSize = std::max(1, std::min(size, NESTLOOPINDEX_BATCH_SIZE));
+}
+
 bool NestLoopIndexExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
 {
     VOLT_TRACE ("executing NestLoopIndex...");
@@ -264,13 +349,35 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params, ReadWriteTracke
     //
     TableTuple outer_tuple(outer_table->schema());
     TableTuple inner_tuple(inner_table->schema());
-    TableIterator outer_iterator(outer_table);
+    ExecutorInput outer_input(node, 0);
+    if (!outer_input.open(params, tracker)) {
+        return false;
+    }
+
+    //
+    // Unless an evicted tuple has to be merged in the middle of a scan,
+    // the inner index is probed for a batch of outer tuples at a time
+    //
+    bool batched = (m_batchSize > 1 &&
+                    (m_lookupType == INDEX_LOOKUP_TYPE_EQ ||
+                     m_lookupType == INDEX_LOOKUP_TYPE_GT ||
+                     m_lookupType == INDEX_LOOKUP_TYPE_GTE));
+    #ifdef ANTICACHE
+    batched = (batched && !hasEvictedTable);
+    #endif
+    if (batched) {
+        executeBatched(outer_input, end_expression, post_expression);
+        outer_input.close();
+        VOLT_TRACE ("result table:\n %s", output_table->debug().c_str());
+        return (true);
+    }
+
     int num_of_outer_cols = outer_table->columnCount();
     int num_of_inner_cols = inner_table->columnCount();
     assert (outer_tuple.sizeInValues() == outer_table->columnCount());
     assert (inner_tuple.sizeInValues() == inner_table->columnCount());
     TableTuple &join_tuple = output_table->tempTuple();
-    while (outer_iterator.next(outer_tuple)) {
+    while (outer_input.next(outer_tuple)) {
         VOLT_TRACE("outer_tuple:%s",
                    outer_tuple.debug(outer_table->name()).c_str());
         outer_table->updateTupleAccessCount();
@@ -455,6 +562,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params, ReadWriteTracke
             output_table->insertTupleNonVirtual(join_tuple);
         }
     } // WHILE
+    outer_input.close();
     
     #ifdef ANTICACHE
     // throw exception indicating evicted blocks are needed
@@ -467,6 +575,220 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params, ReadWriteTracke
     return (true);
 }
 
+void NestLoopIndexExecutor::executeBatched(ExecutorInput &outer_input,
+                                           AbstractExpression* end_expression,
+                                           AbstractExpression* post_expression)
+{
+    int num_of_searchkeys = (int)inline_node->getSearchKeyExpressions().size();
+    const bool stable = outer_input.producesStableTuples();
+    const int outerLength = outer_table->schema()->tupleLength() + TUPLE_HEADER_SIZE;
+    TableTuple outer_tuple(outer_table->schema());
+
+    bool more = true;
+    while (more) {
+        //
+        // Collect a batch of outer tuples and their search keys. A tuple
+        // that the input may overwrite on the next call is copied.
+        //
+        int count = 0;
+        while (count < m_batchSize && (more = outer_input.next(outer_tuple))) {
+            VOLT_TRACE("outer_tuple:%s",
+                       outer_tuple.debug(outer_table->name()).c_str());
+            outer_table->updateTupleAccessCount();
+            if (stable) {
+                m_batchOuter[count] = outer_tuple;
+            } else {
+                m_batchOuter[count].move(m_batchOuterBackingStore + (count * outerLength));
+                m_batchOuter[count].copy(outer_tuple);
+            }
+            for (int ctr = num_of_searchkeys - 1; ctr >= 0 ; --ctr) {
+                m_batchKeys[count].
+                  setNValue(ctr,
+                            inline_node->getSearchKeyExpressions()[ctr]->eval(&outer_tuple, NULL));
+            }
+            m_batchOrder[count] = count;
+            count++;
+        }
+        if (count > 0) {
+            probeBatch(count, end_expression, post_expression);
+        }
+    } // WHILE
+}
+
+void NestLoopIndexExecutor::probeBatch(int count,
+                                       AbstractExpression* end_expression,
+                                       AbstractExpression* post_expression)
+{
+    int num_of_searchkeys = (int)inline_node->getSearchKeyExpressions().size();
+    int num_of_outer_cols = outer_table->columnCount();
+    int num_of_inner_cols = inner_table->columnCount();
+    // the index hands back tuples without a schema at the end of a scan, so
+    // the ones taken again get theirs from here
+    const TupleSchema *inner_schema = inner_table->schema();
+    TableTuple inner_tuple(inner_schema);
+    TableTuple &join_tuple = output_table->tempTuple();
+
+    //
+    // Let the index start loading what all the probes of the batch will
+    // read, so that their cache misses overlap
+    //
+    if (m_sortProbes) {
+        std::sort(m_batchOrder.begin(), m_batchOrder.begin() + count,
+                  SearchKeyLess(m_batchKeys, num_of_searchkeys));
+    }
+    index->prefetchKeys(&m_batchKeys[0], count);
+
+    //
+    // A range probe can only pick up where the last one left off if the
+    // search keys cover the whole index key. Otherwise the index decides
+    // how the missing columns compare.
+    //
+    const std::vector<int> &keyColumns = index->getColumnIndices();
+    const bool reuseRange = (m_lookupType != INDEX_LOOKUP_TYPE_EQ &&
+                             num_of_searchkeys == (int)keyColumns.size());
+    const int stopAt = (m_lookupType == INDEX_LOOKUP_TYPE_GT ? 0 : -1);
+    int previous = -1;
+    for (int ctr = 0; ctr < count; ctr++) {
+        const int position = m_batchOrder[ctr];
+        const TableTuple &outer_tuple = m_batchOuter[position];
+        const TableTuple &search_key = m_batchKeys[position];
+        VOLT_TRACE("Searching %s", search_key.debug("").c_str());
+
+        for (int col_ctr = 0; col_ctr < num_of_outer_cols; ++col_ctr) {
+            join_tuple.setNValue(col_ctr, outer_tuple.getNValue(col_ctr));
+        }
+
+        //
+        // An EQ probe for the same key as the one before finds the same
+        // inner tuples, so they are taken from the last probe instead
+        //
+        bool replay = (m_lookupType == INDEX_LOOKUP_TYPE_EQ && m_lastMatchesComplete &&
+                       previous >= 0 &&
+                       searchKeysEqual(m_batchKeys[previous], search_key, num_of_searchkeys));
+
+        //
+        // A range probe for a key that is not below the one before starts
+        // inside the inner tuples that the last probe read. The ones below
+        // the new key are skipped and the rest are taken again before the
+        // index cursor carries on from where it stopped. Where a NULL key
+        // starts is up to the index.
+        //
+        if (reuseRange && previous >= 0 &&
+            !searchKeyHasNull(m_batchKeys[previous], num_of_searchkeys) &&
+            !SearchKeyLess(m_batchKeys, num_of_searchkeys)(position, previous)) {
+            while (m_rangeStart < m_lastMatches.size()) {
+                inner_tuple = TableTuple(static_cast<char*>(const_cast<void*>(m_lastMatches[m_rangeStart])),
+                                         inner_schema);
+                if (compareToSearchKey(inner_tuple, keyColumns, search_key) > stopAt) break;
+                m_rangeStart++;
+            }
+            replay = (m_rangeStart < m_lastMatches.size() || m_lastMatchesComplete);
+            if (replay) m_rangeProbesReused++;
+        }
+        if (!replay) {
+            m_lastMatches.clear();
+            m_lastMatchesComplete = false;
+            m_rangeStart = 0;
+            if (m_lookupType == INDEX_LOOKUP_TYPE_EQ) {
+                index->moveToKey(&search_key);
+            } else if (m_lookupType == INDEX_LOOKUP_TYPE_GT) {
+                index->moveToGreaterThanKey(&search_key);
+            } else {
+                index->moveToKeyOrGreater(&search_key);
+            }
+        }
+        previous = position;
+
+        bool match = false;
+        size_t next = m_rangeStart;
+        while (true) {
+            if (m_lookupType == INDEX_LOOKUP_TYPE_EQ) {
+                if (replay) {
+                    if (next == m_lastMatches.size()) break;
+                    inner_tuple = TableTuple(static_cast<char*>(const_cast<void*>(m_lastMatches[next++])),
+                                             inner_schema);
+                } else {
+                    inner_tuple = index->nextValueAtKey();
+                    if (inner_tuple.isNullTuple()) {
+                        m_lastMatchesComplete = true;
+                        break;
+                    }
+                    m_lastMatches.push_back(inner_tuple.address());
+                }
+            } else if (next < m_lastMatches.size()) {
+                inner_tuple = TableTuple(static_cast<char*>(const_cast<void*>(m_lastMatches[next++])),
+                                         inner_schema);
+            } else {
+                if (m_lastMatchesComplete) break;
+                inner_tuple = index->nextValue();
+                if (inner_tuple.isNullTuple()) {
+                    m_lastMatchesComplete = true;
+                    break;
+                }
+                if (reuseRange) {
+                    m_lastMatches.push_back(inner_tuple.address());
+                    next++;
+                }
+            }
+            match = true;
+            inner_table->updateTupleAccessCount();
+
+            for (int col_ctr = 0; col_ctr < num_of_inner_cols; ++col_ctr) {
+                join_tuple.setNValue(col_ctr + num_of_outer_cols,
+                                     inner_tuple.getNValue(col_ctr));
+            }
+
+            if (end_expression != NULL &&
+                end_expression->eval(&join_tuple, NULL).isFalse()) {
+                VOLT_TRACE("End Expression evaluated to false, stopping scan");
+                break;
+            }
+            if (post_expression == NULL ||
+                post_expression->eval(&join_tuple, NULL).isTrue()) {
+                VOLT_TRACE("MATCH: %s",
+                           join_tuple.debug(output_table->name()).c_str());
+                output_table->insertTupleNonVirtual(join_tuple);
+            }
+        } // WHILE
+
+        //
+        // Left Outer Join
+        //
+        if (!match && join_type == JOIN_TYPE_LEFT) {
+            for (int col_ctr = 0; col_ctr < num_of_inner_cols; ++col_ctr) {
+                join_tuple.setNValue(col_ctr + num_of_outer_cols,
+                                     NValue::getNullValue(inner_table->schema()->columnType(col_ctr)));
+            }
+            output_table->insertTupleNonVirtual(join_tuple);
+        }
+    } // FOR
+}
+
+bool NestLoopIndexExecutor::acceptsPipelinedInput(int child, bool stable) const {
+    // We only need each outer tuple while we probe the inner index with
+    // it. But an outer pipeline that scans our inner index would have its
+    // position in the index moved by our probes.
+    AbstractPlanNode *producer = node->getChildren()[child];
+    while (producer != NULL) {
+        IndexScanPlanNode *scan = dynamic_cast<IndexScanPlanNode*>(producer);
+        if (scan != NULL && scan->getTargetTable() == inner_table &&
+            scan->getTargetIndexName() == index->getName()) {
+            return false;
+        }
+        AbstractPlanNode *next = NULL;
+        for (int ctr = 0, cnt = (int)producer->getChildren().size(); ctr < cnt; ctr++) {
+            AbstractExecutor *executor = producer->getChildren()[ctr]->getExecutor();
+            if (executor != NULL && executor->isPipelined()) {
+                next = producer->getChildren()[ctr];
+            }
+        }
+        producer = next;
+    }
+    return true;
+}
+
 NestLoopIndexExecutor::~NestLoopIndexExecutor() {
     delete [] index_values_backing_store;
+    delete [] m_batchOuterBackingStore;
+    delete [] m_batchKeysBackingStore;
 }
@@ -46,6 +46,7 @@
 #ifndef HSTORENESTLOOPINDEXEXECUTOR_H
 #define HSTORENESTLOOPINDEXEXECUTOR_H
 
+#include <vector>
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "common/tabletuple.h"
@@ -54,8 +55,12 @@
 #include "executors/abstractexecutor.h"
 
 
+// Outer tuples whose index probes are done together, see p_execute()
+#define NESTLOOPINDEX_BATCH_SIZE 64
+
 namespace voltdb {
 
+class ExecutorInput;
 class NestLoopIndexPlanNode;
 class IndexScanPlanNode;
 class PersistentTable;
@@ -76,7 +81,14 @@ class NestLoopIndexExecutor : public AbstractExecutor
 public:
     NestLoopIndexExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
         : AbstractExecutor(engine, abstract_node),
-        index_values_backing_store(NULL)
+        index_values_backing_store(NULL),
+        m_batchSize(NESTLOOPINDEX_BATCH_SIZE),
+        m_sortProbes(false),
+        m_batchOuterBackingStore(NULL),
+        m_batchKeysBackingStore(NULL),
+        m_lastMatchesComplete(false),
+        m_rangeStart(0),
+        m_rangeProbesReused(0)
     {
         node = NULL;
         inline_node = NULL;
@@ -89,10 +101,40 @@ public:
 
     ~NestLoopIndexExecutor();
 
+    bool acceptsPipelinedInput(int child, bool stable) const;
+
+    /**
+     * Number of outer tuples whose index probes are batched, at most
+     * NESTLOOPINDEX_BATCH_SIZE. 1 probes for every outer tuple on its own.
+     */
+    void setBatchSize(int size);
+
+    /**
+     * Whether the probes of a batch are made in search key order. This
+     * puts probes for equal and nearby keys next to each other, and lets
+     * GT/GTE probes carry on from the position of the one before. It pays
+     * off when the outer keys repeat or cluster, or their ranges overlap,
+     * but is wasted on keys that are spread over the whole index.
+     */
+    void setSortProbes(bool sort) { m_sortProbes = sort; }
+
+    /**
+     * Number of GT/GTE probes that carried on from the position of the
+     * probe before instead of searching the index again
+     */
+    int64_t getRangeProbesReused() const { return m_rangeProbesReused; }
+
 protected:
     bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
     bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
 
+    void executeBatched(ExecutorInput &outer_input,
+                        AbstractExpression* end_expression,
+                        AbstractExpression* post_expression);
+    void probeBatch(int count,
+                    AbstractExpression* end_expression,
+                    AbstractExpression* post_expression);
+
     NestLoopIndexPlanNode* node;
     IndexScanPlanNode* inline_node;
     IndexLookupType m_lookupType;
@@ -106,6 +148,25 @@ protected:
 
     //So valgrind doesn't report the data as lost.
     char *index_values_backing_store;
+
+    // Batched probes: the outer tuples of a batch (or copies of them if
+    // the input doesn't keep them), their search keys, and the order in
+    // which they are probed
+    int m_batchSize;
+    bool m_sortProbes;
+    std::vector<TableTuple> m_batchOuter;
+    std::vector<TableTuple> m_batchKeys;
+    std::vector<int> m_batchOrder;
+    char *m_batchOuterBackingStore;
+    char *m_batchKeysBackingStore;
+    // inner tuples read since the last time the index was searched. An EQ
+    // probe for the same key uses them again instead of another probe, and
+    // a range probe for a greater key starts at m_rangeStart among them.
+    // Complete means the index cursor has nothing more to return.
+    std::vector<const void*> m_lastMatches;
+    bool m_lastMatchesComplete;
+    size_t m_rangeStart;
+    int64_t m_rangeProbesReused;
 };
 
 }
@@ -44,12 +44,14 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include "orderbyexecutor.h"
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
+#include "indexes/indexkey.h"
 #include "plannodes/orderbynode.h"
 #include "plannodes/limitnode.h"
 #include "storage/table.h"
@@ -132,20 +134,27 @@ public:
 
     bool operator()(TableTuple ta, TableTuple tb)
     {
-        for (size_t i = 0; i < m_keyCount; ++i)
+        return compare(ta, tb, 0) < 0;
+    }
+
+    /**
+     * Compare the tuples on the sort columns from the given one on, in
+     * sort order
+     */
+    int compare(const TableTuple& ta, const TableTuple& tb, size_t first) const
+    {
+        for (size_t i = first; i < m_keyCount; ++i)
         {
             int k = m_keys[i];
             SortDirectionType dir = m_dirs[i];
             int cmp = ta.getNValue(k).compare(tb.getNValue(k));
             if (dir == SORT_DIRECTION_TYPE_ASC)
             {
-                if (cmp < 0) return true;
-                if (cmp > 0) return false;
+                if (cmp != 0) return cmp;
             }
             else if (dir == SORT_DIRECTION_TYPE_DESC)
             {
-                if (cmp < 0) return false;
-                if (cmp > 0) return true;
+                if (cmp != 0) return -cmp;
             }
             else
             {
@@ -154,7 +163,7 @@ public:
                                               " SORT_DIRECTION_TYPE_INVALID");
             }
         }
-        return false; // ta == tb on these keys
+        return 0; // ta == tb on these keys
     }
 
 private:
@@ -163,6 +172,140 @@ private:
     size_t m_keyCount;
 };
 
+/*
+ * Bytes of normalized sort key kept with each tuple. Two BIGINT columns
+ * or a string of up to 8 bytes fit whole.
+ */
+#define SORT_KEY_PREFIX_LENGTH 16
+
+/**
+ * A tuple to sort and the first bytes of its sort key, encoded like a
+ * normalized index key (see NormalizedKeyEncoder) with the bytes of the
+ * DESC columns inverted, so that memcmp of two prefixes gives the sort
+ * order whenever they differ.
+ */
+struct SortEntry
+{
+    char key[SORT_KEY_PREFIX_LENGTH];
+    // sort columns whose whole encoding is in the key
+    int32_t columns;
+    char* address;
+};
+
+/**
+ * Sort columns of these types can be compared through their normalized
+ * keys. NValue::compare() does not handle the others.
+ */
+static bool isNormalizable(ValueType type)
+{
+    switch (type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+    case VALUE_TYPE_DOUBLE:
+    case VALUE_TYPE_DECIMAL:
+    case VALUE_TYPE_VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Builds the sort entries of tuples
+ */
+class SortKeyBuilder
+{
+public:
+    SortKeyBuilder(const vector<int>& keys,
+                   const vector<SortDirectionType>& dirs)
+        : m_keys(keys), m_dirs(dirs),
+          m_keyCount(static_cast<int32_t>(keys.size()))
+    {
+    }
+
+    void build(SortEntry& entry, const TableTuple& tuple)
+    {
+        char* out = entry.key;
+        char* const end = entry.key + SORT_KEY_PREFIX_LENGTH;
+        entry.columns = 0;
+        entry.address = tuple.address();
+        for (int32_t i = 0; i < m_keyCount && out < end; ++i)
+        {
+            const NValue value = tuple.getNValue(m_keys[i]);
+            const int32_t length = NormalizedKeyEncoder::length(value);
+            char* start = out;
+            if (length <= end - out)
+            {
+                out = NormalizedKeyEncoder::encode(out, value);
+                entry.columns++;
+            }
+            else
+            {
+                // only the start of this column fits
+                if (m_overflow.size() < static_cast<size_t>(length))
+                {
+                    m_overflow.resize(length);
+                }
+                NormalizedKeyEncoder::encode(&m_overflow[0], value);
+                ::memcpy(out, &m_overflow[0], end - out);
+                out = end;
+            }
+            if (m_dirs[i] == SORT_DIRECTION_TYPE_DESC)
+            {
+                for (char* p = start; p < out; ++p)
+                {
+                    *p = static_cast<char>(~*p);
+                }
+            }
+        }
+        ::memset(out, 0, end - out);
+    }
+
+private:
+    const vector<int>& m_keys;
+    const vector<SortDirectionType>& m_dirs;
+    int32_t m_keyCount;
+    // encoding of a column that does not fit in the key
+    vector<char> m_overflow;
+};
+
+class SortEntryComparer
+{
+public:
+    SortEntryComparer(const TupleComparer& comparer, size_t keyCount,
+                      const TupleSchema* schema)
+        : m_comparer(comparer), m_keyCount(static_cast<int32_t>(keyCount)),
+          m_schema(schema)
+    {
+    }
+
+    bool operator()(const SortEntry& ea, const SortEntry& eb) const
+    {
+        int cmp = ::memcmp(ea.key, eb.key, SORT_KEY_PREFIX_LENGTH);
+        if (cmp != 0)
+        {
+            return cmp < 0;
+        }
+        // the columns that both keys hold whole are equal
+        const int32_t first = std::min(ea.columns, eb.columns);
+        if (first == m_keyCount)
+        {
+            return false;
+        }
+        return m_comparer.compare(TableTuple(ea.address, m_schema),
+                                  TableTuple(eb.address, m_schema),
+                                  first) < 0;
+    }
+
+private:
+    const TupleComparer& m_comparer;
+    int32_t m_keyCount;
+    const TupleSchema* m_schema;
+};
+
 bool
 OrderByExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
 {
@@ -175,19 +318,31 @@ OrderByExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
 
     //
     // OPTIMIZATION: NESTED LIMIT
-    // How nice! We can also cut off our scanning with a nested limit!
+    // With a limit only the first limit + offset tuples in sort order are
+    // kept, in a bounded heap, instead of sorting the whole input.
     //
     int limit = -1;
-    int offset = -1;
+    int offset = 0;
     if (limit_node != NULL)
     {
         limit_node->getLimitAndOffsetByReference(params, limit, offset);
-        if (offset > 0)
+    }
+
+    const vector<int>& keys = node->getSortColumns();
+    const vector<SortDirectionType>& dirs = node->getSortDirections();
+    TupleComparer comparer(keys, dirs);
+    bool normalizable = true;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (dirs[i] != SORT_DIRECTION_TYPE_ASC &&
+            dirs[i] != SORT_DIRECTION_TYPE_DESC)
         {
-            VOLT_ERROR("Nested Limit Offset is not yet supported for PlanNode"
-                       " '%s'", node->debug().c_str());
-            return false;
+            throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                          "Attempted to sort using"
+                                          " SORT_DIRECTION_TYPE_INVALID");
         }
+        normalizable = normalizable &&
+            isNormalizable(input_table->schema()->columnType(keys[i]));
     }
 
     VOLT_TRACE("Running OrderBy '%s'", abstract_node->debug().c_str());
@@ -195,21 +350,82 @@ OrderByExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
     TableIterator iterator(input_table);
     TableTuple tuple(input_table->schema());
     vector<TableTuple> xs;
-    while (iterator.next(tuple))
+    if (!normalizable)
     {
-        assert(tuple.isActive());
-        xs.push_back(tuple);
+        while (iterator.next(tuple))
+        {
+            assert(tuple.isActive());
+            xs.push_back(tuple);
+        }
+        sort(xs.begin(), xs.end(), comparer);
+    }
+    else
+    {
+        SortKeyBuilder builder(keys, dirs);
+        SortEntryComparer less(comparer, keys.size(), input_table->schema());
+        vector<SortEntry> entries;
+        const int64_t wanted = (limit >= 0 ? static_cast<int64_t>(limit) + offset : -1);
+        if (wanted >= 0 && wanted < input_table->activeTupleCount())
+        {
+            // Top-N: a max-heap of the best tuples so far, the last of
+            // them in sort order at the front
+            entries.reserve(static_cast<size_t>(wanted));
+            SortEntry candidate;
+            while (wanted > 0 && iterator.next(tuple))
+            {
+                assert(tuple.isActive());
+                builder.build(candidate, tuple);
+                if (static_cast<int64_t>(entries.size()) < wanted)
+                {
+                    entries.push_back(candidate);
+                    push_heap(entries.begin(), entries.end(), less);
+                }
+                else if (less(candidate, entries.front()))
+                {
+                    pop_heap(entries.begin(), entries.end(), less);
+                    entries.back() = candidate;
+                    push_heap(entries.begin(), entries.end(), less);
+                }
+            }
+            sort_heap(entries.begin(), entries.end(), less);
+        }
+        else
+        {
+            entries.resize(static_cast<size_t>(input_table->activeTupleCount()));
+            size_t count = 0;
+            while (iterator.next(tuple))
+            {
+                assert(tuple.isActive());
+                if (count == entries.size())
+                {
+                    entries.resize(count + 1);
+                }
+                builder.build(entries[count++], tuple);
+            }
+            entries.resize(count);
+            sort(entries.begin(), entries.end(), less);
+        }
+        xs.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            xs.push_back(TableTuple(entries[i].address, input_table->schema()));
+        }
     }
-    VOLT_TRACE("\n***** Input Table PreSort:\n '%s'",
-               input_table->debug().c_str());
-    sort(xs.begin(), xs.end(), TupleComparer(node->getSortColumns(),
-                                             node->getSortDirections()));
 
     int tuple_ctr = 0;
-    for (vector<TableTuple>::iterator it = xs.begin(); it != xs.end(); it++)
+    vector<TableTuple>::iterator it = xs.begin();
+    if (offset > 0)
+    {
+        it += std::min(static_cast<size_t>(offset), xs.size());
+    }
+    for (; it != xs.end(); it++)
     {
-        VOLT_TRACE("\n***** Input Table PostSort:\n '%s'",
-                   input_table->debug().c_str());
+        //
+        // Check whether we have gone past our limit
+        //
+        if (limit >= 0 && tuple_ctr++ >= limit) {
+            break;
+        }
         if (!output_table->insertTuple(*it))
         {
             VOLT_ERROR("Failed to insert order-by tuple from input table '%s'"
@@ -218,12 +434,6 @@ OrderByExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker)
                        output_table->name().c_str());
             return false;
         }
-        //
-        // Check whether we have gone past our limit
-        //
-        if (limit >= 0 && ++tuple_ctr >= limit) {
-            break;
-        }
     }
     VOLT_TRACE("Result of OrderBy:\n '%s'", output_table->debug().c_str());
 
@@ -0,0 +1,137 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <vector>
+#include "executors/parallelaggregation.h"
+#include "executors/compiledpredicate.h"
+#include "executors/typedhashaggregator.h"
+#include "common/debuglog.h"
+#include "common/tabletuple.h"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+
+namespace voltdb {
+
+namespace {
+
+/**
+ * Work shared by the threads of ParallelAggregation::execute()
+ */
+struct AggregationWork {
+    const Table *table;
+    const CompiledPredicate *predicate;
+    uint32_t morselTuples;
+    int morselCount;
+    int nextMorsel;
+    // one partial aggregation per thread, handed out by nextPartial
+    vector<TypedHashAggregator> *partials;
+    int nextPartial;
+    int64_t tuplesScanned;
+    bool failed;
+};
+
+void* aggregateMorsels(void *arg) {
+    AggregationWork *work = static_cast<AggregationWork*>(arg);
+    TypedHashAggregator &partial = (*work->partials)[__sync_fetch_and_add(&work->nextPartial, 1)];
+    const CompiledPredicate *predicate = work->predicate;
+    int64_t scanned = 0;
+    try {
+        partial.reset();
+        TableTuple tuple(work->table->schema());
+        int morsel;
+        while ((morsel = __sync_fetch_and_add(&work->nextMorsel, 1)) < work->morselCount) {
+            const uint32_t start = static_cast<uint32_t>(morsel) * work->morselTuples;
+            TableIterator iterator(work->table, start, start + work->morselTuples);
+            while (iterator.next(tuple)) {
+                scanned++;
+                if (predicate == NULL || predicate->eval(tuple)) {
+                    partial.add(tuple.address());
+                }
+            }
+        } // WHILE
+        partial.flush();
+    } catch (...) {
+        // the caller aggregates again on its own thread, which reports the
+        // error the way it would have without the other threads
+        work->failed = true;
+    }
+    __sync_fetch_and_add(&work->tuplesScanned, scanned);
+    return NULL;
+}
+
+}
+
+bool ParallelAggregation::execute(TypedHashAggregator &aggregator, const Table *table,
+                                  const CompiledPredicate *predicate, int threads,
+                                  int64_t *tuplesScanned) {
+    AggregationWork work;
+    work.table = table;
+    work.predicate = predicate;
+    work.morselTuples = table->tuplesPerBlock();
+    work.morselCount = static_cast<int>((table->usedTupleCount() + work.morselTuples - 1) / work.morselTuples);
+    work.nextMorsel = 0;
+    work.nextPartial = 0;
+    work.tuplesScanned = 0;
+    work.failed = false;
+    if (threads > work.morselCount) {
+        threads = work.morselCount;
+    }
+    vector<TypedHashAggregator> partials(threads < 1 ? 1 : threads, aggregator);
+    work.partials = &partials;
+
+    vector<pthread_t> workers;
+    for (int i = 1; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, aggregateMorsels, &work) != 0) break;
+        workers.push_back(thread);
+    }
+    aggregateMorsels(&work);
+    for (size_t i = 0; i < workers.size(); i++) {
+        pthread_join(workers[i], NULL);
+    }
+    VOLT_DEBUG("Aggregated %d morsels of table '%s' on %d threads",
+               work.morselCount, table->name().c_str(), (int)workers.size() + 1);
+
+    aggregator.reset();
+    if (work.failed) {
+        return false;
+    }
+    try {
+        for (int i = 0; i < work.nextPartial; i++) {
+            aggregator.merge(partials[i]);
+        }
+    } catch (...) {
+        // adding up the partial sums overflowed
+        aggregator.reset();
+        return false;
+    }
+    *tuplesScanned = work.tuplesScanned;
+    return true;
+}
+
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREPARALLELAGGREGATION_H
+#define HSTOREPARALLELAGGREGATION_H
+
+#include <stdint.h>
+
+namespace voltdb {
+
+class CompiledPredicate;
+class Table;
+class TypedHashAggregator;
+
+/**
+ * Morsel-driven scan and hash aggregation of one table on several
+ * threads, for the long read-only fragments that would otherwise hold up
+ * the partition for seconds.
+ *
+ * The slots of the table are cut into morsels of one block each. Every
+ * thread keeps taking the next morsel that nobody has scanned yet, and
+ * feeds the tuples that satisfy the predicate into its own copy of the
+ * aggregator. The partial aggregations are merged on the calling thread
+ * at the end.
+ *
+ * The threads only read the table and the predicate, so the fragment
+ * still runs as if it was alone on the partition. The groups come out in
+ * a different order than from a single-threaded scan, and a SUM or AVG of
+ * doubles may differ in the last bits because it adds in another order.
+ */
+class ParallelAggregation {
+public:
+    /**
+     * Aggregate the tuples of the table that satisfy the predicate (all
+     * of them if it is NULL) into the aggregator, which must have had its
+     * init(). Returns false if one of the threads failed, e.g. because a
+     * SUM overflowed, in which case the caller has to aggregate the table
+     * by itself to report the error the way it would have. Otherwise the
+     * aggregator holds the merged groups, ready for finish(), and
+     * tuplesScanned the number of tuples that were read.
+     */
+    static bool execute(TypedHashAggregator &aggregator, const Table *table,
+                        const CompiledPredicate *predicate, int threads,
+                        int64_t *tuplesScanned);
+};
+
+}
+
+#endif
@@ -44,6 +44,7 @@
  */
 
 #include "projectionexecutor.h"
+#include "executorinput.h"
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
@@ -111,21 +112,52 @@ bool ProjectionExecutor::p_init(AbstractPlanNode *abstract_node,
     if (!node->isInline()) {
         input_table = node->getInputTables()[0];
         tuple = TableTuple(input_table->schema());
+        m_input = new ExecutorInput(node, 0);
     }
     return true;
 }
 
+bool ProjectionExecutor::supportsPipelining() const {
+    return (!abstract_node->isInline());
+}
+
 bool ProjectionExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker) {
+    assert (output_table == dynamic_cast<TempTable*>(abstract_node->getOutputTable()));
+    assert (output_table);
+
+    if (!p_open(params, tracker)) {
+        return (false);
+    }
+    TableTuple temp_tuple(output_table->schema());
+    while (p_next(temp_tuple)) {
+        output_table->insertTupleNonVirtual(temp_tuple);
+        /*if (!output_table->insertTupleNonVirtual(temp_tuple)) {
+            // TODO: DEBUG
+            VOLT_ERROR("Failed to insert projection tuple from input table '%s' into output table '%s'", input_table->name().c_str(), output_table->name().c_str());
+            return (false);
+        }*/
+    }
+    p_close();
+
+    //VOLT_TRACE("PROJECTED TABLE: %s\n", output_table->debug().c_str());
+    //#ifdef ARIES
+    // std::string logString = output_table->debug();
+    // LogManager::getThreadLogger(LOGGERID_MM_ARIES)->log(LOGLEVEL_INFO, ("Table after projection " + logString).c_str());
+    //#endif
+
+    return (true);
+}
+
+bool ProjectionExecutor::p_open(const NValueArray &params, ReadWriteTracker *tracker) {
 #ifndef NDEBUG
     ProjectionPlanNode* node = dynamic_cast<ProjectionPlanNode*>(abstract_node);
 #endif
     assert (node);
     assert (!node->isInline()); // inline projection's execute() should not be
                                 // called
-    assert (output_table == dynamic_cast<TempTable*>(node->getOutputTable()));
-    assert (output_table);
     assert (input_table == node->getInputTables()[0]);
     assert (input_table);
+    assert (m_input);
 
     VOLT_TRACE("INPUT TABLE: %s\n", input_table->debug().c_str());
 
@@ -143,67 +175,66 @@ bool ProjectionExecutor::p_execute(const NValueArray &params, ReadWriteTracker *
                        expression_array[ctr]->debug(true).c_str());
         }
     }
+    m_params = &params;
+    return m_input->open(params, tracker);
+}
 
+bool ProjectionExecutor::p_next(TableTuple &out) {
     //
-    // Now loop through all the tuples and push them through our output
-    // expression This will generate new tuple values that we will insert into
-    // our output table
+    // Pull the next input tuple and push it through our output expressions.
+    // This generates the values of the output tuple, which is handed out
+    // in our output table's temp tuple
     //
-    TableIterator iterator(input_table);
     assert (tuple.sizeInValues() == input_table->columnCount());
-    while (iterator.next(tuple)) {
-        //
-        // Project (or replace) values from input tuple
-        //
-        TableTuple &temp_tuple = output_table->tempTuple();
-        if (all_tuple_array != NULL) {
-            VOLT_TRACE("sweet, all tuples");
-            for (int ctr = num_of_columns - 1; ctr >= 0; --ctr) {
-                try {
-                    temp_tuple.setNValue(ctr, tuple.getNValue(all_tuple_array[ctr]));
-                } catch (SerializableEEException &e) {
-                    VOLT_ERROR("[Type0] Failed to project column #%02d: %s", ctr, e.message().c_str());
-                    throw e;
-                }
-            } // FOR
-        } else if (all_param_array != NULL) {
-            VOLT_TRACE("sweet, all params");
-            for (int ctr = num_of_columns - 1; ctr >= 0; --ctr) {
-                try {
-                    temp_tuple.setNValue(ctr, params[all_param_array[ctr]]);
-                } catch (SerializableEEException &e) {
-                    VOLT_ERROR("[Type1] Failed to project column #%02d: %s", ctr, e.message().c_str());
-                    throw e;
-                }   
-            } // FOR
-        } else {
-            for (int ctr = num_of_columns - 1; ctr >= 0; --ctr) {
-                try {
-                    temp_tuple.setNValue(ctr, expression_array[ctr]->eval(&tuple, NULL));
-                } catch (SerializableEEException &e) {
-                    VOLT_ERROR("[Type2] Failed to project column #%02d: %s", ctr, e.message().c_str());
-                    throw e;
-                }
-            } // FOR
-        }
-        output_table->insertTupleNonVirtual(temp_tuple);
-        /*if (!output_table->insertTupleNonVirtual(temp_tuple)) {
-            // TODO: DEBUG
-            VOLT_ERROR("Failed to insert projection tuple from input table '%s' into output table '%s'", input_table->name().c_str(), output_table->name().c_str());
-            return (false);
-        }*/
+    if (!m_input->next(tuple)) {
+        return (false);
     }
 
-    //VOLT_TRACE("PROJECTED TABLE: %s\n", output_table->debug().c_str());
-    //#ifdef ARIES
-    // std::string logString = output_table->debug();
-    // LogManager::getThreadLogger(LOGGERID_MM_ARIES)->log(LOGLEVEL_INFO, ("Table after projection " + logString).c_str());
-    //#endif
-
+    //
+    // Project (or replace) values from input tuple
+    //
+    TableTuple &temp_tuple = output_table->tempTuple();
+    if (all_tuple_array != NULL) {
+        VOLT_TRACE("sweet, all tuples");
+        for (int ctr = num_of_columns - 1; ctr >= 0; --ctr) {
+            try {
+                temp_tuple.setNValue(ctr, tuple.getNValue(all_tuple_array[ctr]));
+            } catch (SerializableEEException &e) {
+                VOLT_ERROR("[Type0] Failed to project column #%02d: %s", ctr, e.message().c_str());
+                throw e;
+            }
+        } // FOR
+    } else if (all_param_array != NULL) {
+        VOLT_TRACE("sweet, all params");
+        const NValueArray &params = *m_params;
+        for (int ctr = num_of_columns - 1; ctr >= 0; --ctr) {
+            try {
+                temp_tuple.setNValue(ctr, params[all_param_array[ctr]]);
+            } catch (SerializableEEException &e) {
+                VOLT_ERROR("[Type1] Failed to project column #%02d: %s", ctr, e.message().c_str());
+                throw e;
+            }   
+        } // FOR
+    } else {
+        for (int ctr = num_of_columns - 1; ctr >= 0; --ctr) {
+            try {
+                temp_tuple.setNValue(ctr, expression_array[ctr]->eval(&tuple, NULL));
+            } catch (SerializableEEException &e) {
+                VOLT_ERROR("[Type2] Failed to project column #%02d: %s", ctr, e.message().c_str());
+                throw e;
+            }
+        } // FOR
+    }
+    out = temp_tuple;
     return (true);
 }
 
+void ProjectionExecutor::p_close() {
+    m_input->close();
+}
+
 ProjectionExecutor::~ProjectionExecutor() {
+    delete m_input;
 }
 
 }
@@ -56,6 +56,7 @@
 namespace voltdb {
 
 class AbstractExpression;
+class ExecutorInput;
 class TempTable;
 class Table;
 
@@ -66,15 +67,25 @@ class ProjectionExecutor : public AbstractExecutor {
     public:
         ProjectionExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) : AbstractExecutor(engine, abstract_node) {
             output_table = NULL;
+            m_input = NULL;
+            m_params = NULL;
         }
         ~ProjectionExecutor();
+
+        bool supportsPipelining() const;
+        bool acceptsPipelinedInput(int child, bool stable) const { return true; }
     protected:
         bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
         bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
+        bool p_open(const NValueArray &params, ReadWriteTracker *tracker);
+        bool p_next(TableTuple &out);
+        void p_close();
 
     private:
         TempTable* output_table;
         Table* input_table;
+        ExecutorInput* m_input;
+        const NValueArray* m_params;
         int num_of_columns;
         boost::shared_array<int> all_tuple_array_ptr;
         int* all_tuple_array;
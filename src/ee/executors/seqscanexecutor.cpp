@@ -45,11 +45,13 @@
 
 #include <iostream>
 #include "seqscanexecutor.h"
+#include "columnarscanfilter.h"
 #include "common/debuglog.h"
 #include "common/common.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
 #include "expressions/abstractexpression.h"
+#include "expressions/expressionutil.h"
 #include "plannodes/seqscannode.h"
 #include "plannodes/projectionnode.h"
 #include "plannodes/limitnode.h"
@@ -61,6 +63,12 @@
 
 #ifdef ANTICACHE
 #include "anticache/AntiCacheEvictionManager.h"
+#include "anticache/AntiCacheKeyFilter.h"
+#include "common/SQLException.h"
+#include "common/ValuePeeker.hpp"
+#include "expressions/parametervalueexpression.h"
+#include "expressions/tuplevalueexpression.h"
+#include "indexes/tableindex.h"
 #endif
 
 using namespace voltdb;
@@ -70,8 +78,9 @@ bool SeqScanExecutor::p_init(AbstractPlanNode *abstract_node,
                              int* tempTableMemoryInBytes) {
     VOLT_TRACE("init SeqScan Executor");
 
-    SeqScanPlanNode* node = dynamic_cast<SeqScanPlanNode*>(abstract_node);
-    assert(node);
+    m_node = dynamic_cast<SeqScanPlanNode*>(abstract_node);
+    assert(m_node);
+    SeqScanPlanNode* node = m_node;
     PersistentTable* target_table = static_cast<PersistentTable*>(node->getTargetTable());
     assert(target_table);
 
@@ -136,43 +145,125 @@ bool SeqScanExecutor::needsOutputTableClear() {
     return node->needsOutputTableClear();
 }
 
+bool SeqScanExecutor::supportsPipelining() const {
+    // Without a predicate or inline nodes our output table is the
+    // TargetTable itself, so there is nothing to save
+    return (abstract_node->getOutputTable() !=
+            static_cast<SeqScanPlanNode*>(abstract_node)->getTargetTable());
+}
+
+bool SeqScanExecutor::producesStableTuples() const {
+    // We hand out the tuples of the TargetTable unless we project them
+    return (abstract_node->getInlinePlanNode(PLAN_NODE_TYPE_PROJECTION) == NULL);
+}
+
 bool SeqScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tracker) {
-    SeqScanPlanNode* node = dynamic_cast<SeqScanPlanNode*>(abstract_node);
-    assert(node);
+    SeqScanPlanNode* node = m_node;
     Table* output_table = node->getOutputTable();
     assert(output_table);
     PersistentTable* target_table = static_cast<PersistentTable*>(node->getTargetTable());
     assert(target_table);
+
+    // Anti-Cache Variables
+    // PAVLO 2014-07-17
+    // I am flying on a plane back from Seattle. We also need to check whether
+    // we are looking a table that has evicted tuples. If so, then we cannot
+    // just pass through because then other things will break later on.
+    bool hasEvictedTable = false;
+    #ifdef ANTICACHE
+    AntiCacheEvictionManager* eviction_manager = executor_context->getAntiCacheEvictionManager();
+    hasEvictedTable = (eviction_manager != NULL && target_table->getEvictedTable() != NULL);
+    #endif
+
+    // OPTIMIZATION:
+    // If there is no predicate and no Projection for this SeqScan,
+    // then we have already set the node's OutputTable to just point
+    // at the TargetTable. Therefore, there is nothing we more we need
+    // to do here
+    if (hasEvictedTable || node->getPredicate() != NULL ||
+        node->getInlinePlanNode(PLAN_NODE_TYPE_PROJECTION) != NULL ||
+        node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT) != NULL) {
+        // Just walk through the table and insert each tuple that
+        // satisfies our predicate into the output table.
+        if (!p_open(params, tracker)) {
+            return false;
+        }
+        TableTuple tuple(output_table->schema());
+        while (p_next(tuple)) {
+            if (!output_table->insertTuple(tuple)) {
+                VOLT_ERROR("Failed to insert tuple from table '%s' into"
+                           " output table '%s'",
+                           target_table->name().c_str(),
+                           output_table->name().c_str());
+                return false;
+            }
+        }
+        p_close();
+    }
+    VOLT_TRACE("\n%s\n", output_table->debug().c_str());
+    VOLT_DEBUG("Finished Seq scanning");
+
+    return true;
+}
+
+bool SeqScanExecutor::p_compile() {
+    // The predicate is evaluated on the tuples of the TargetTable
+    const TupleSchema *schema = m_node->getTargetTable()->schema();
+    bool compiled = m_compiledPredicate.compile(m_node->getPredicate(), schema);
+    if (!compiled) {
+        compiled = m_predicateProgram.compile(m_node->getPredicate(), schema);
+    }
+
+    // An inline projection that only picks columns can copy them without
+    // evaluating its expressions
+    ProjectionPlanNode* projection_node =
+        static_cast<ProjectionPlanNode*>(m_node->getInlinePlanNode(PLAN_NODE_TYPE_PROJECTION));
+    m_projectionColumns.reset();
+    if (projection_node != NULL) {
+        m_projectionColumns =
+            expressionutil::convertIfAllTupleValues(projection_node->getOutputColumnExpressions());
+        compiled = compiled || (m_projectionColumns.get() != NULL);
+    }
+    return (compiled);
+}
+
+bool SeqScanExecutor::p_open(const NValueArray &params, ReadWriteTracker *tracker) {
+    SeqScanPlanNode* node = m_node;
+    m_outputTable = node->getOutputTable();
+    assert(m_outputTable);
+    m_targetTable = static_cast<PersistentTable*>(node->getTargetTable());
+    assert(m_targetTable);
+    m_tracker = tracker;
     //cout << "SeqScanExecutor: node id" << node->getPlanNodeId() << endl;
     VOLT_TRACE("Sequential Scanning table :\n %s",
-               target_table->debug().c_str());
+               m_targetTable->debug().c_str());
     VOLT_DEBUG("Sequential Scanning table : %s which has %d active, %d"
                " allocated tuples, %d evicted tuples",
-               target_table->name().c_str(),
-               (int)target_table->activeTupleCount(),
-               (int)target_table->allocatedTupleCount(),
-               (int)target_table->getTuplesEvicted());
+               m_targetTable->name().c_str(),
+               (int)m_targetTable->activeTupleCount(),
+               (int)m_targetTable->allocatedTupleCount(),
+               (int)m_targetTable->getTuplesEvicted());
 
     // OPTIMIZATION: NESTED PROJECTION
     // Since we have the input params, we need to call substitute to
     // change any nodes in our expression tree to be ready for the
     // projection operations in execute
-    int num_of_columns = (int)output_table->columnCount();
-    ProjectionPlanNode* projection_node = dynamic_cast<ProjectionPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_PROJECTION));
-    if (projection_node != NULL) {
+    int num_of_columns = (int)m_outputTable->columnCount();
+    m_projectionNode = dynamic_cast<ProjectionPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_PROJECTION));
+    if (m_projectionNode != NULL) {
         for (int ctr = 0; ctr < num_of_columns; ctr++) {
-            assert(projection_node->getOutputColumnExpressions()[ctr]);
-            projection_node->getOutputColumnExpressions()[ctr]->substitute(params);
+            assert(m_projectionNode->getOutputColumnExpressions()[ctr]);
+            m_projectionNode->getOutputColumnExpressions()[ctr]->substitute(params);
         }
     }
     
     // OPTIMIZATION: NESTED LIMIT
     // How nice! We can also cut off our scanning with a nested limit!
-    int limit = -1;
+    m_limit = -1;
     int offset = -1;
     LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
     if (limit_node != NULL) {
-        limit_node->getLimitAndOffsetByReference(params, limit, offset);
+        limit_node->getLimitAndOffsetByReference(params, m_limit, offset);
         if (offset > 0) {
             VOLT_ERROR("Nested Limit Offset is not yet supported for PlanNode"
                        " '%s'", node->debug().c_str());
@@ -180,154 +271,286 @@ bool SeqScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tra
         }
     }
     
-    // Anti-Cache Variables
-    // PAVLO 2014-07-17
-    // I am flying on a plane back from Seattle. We also need to check whether
-    // we are looking a table that has evicted tuples. If so, then we cannot
-    // just pass through because then other things will break later on.
-    bool hasEvictedTable = false;
+    m_hasEvictedTable = false;
     #ifdef ANTICACHE
     AntiCacheEvictionManager* eviction_manager = executor_context->getAntiCacheEvictionManager();
-    hasEvictedTable = (eviction_manager != NULL && target_table->getEvictedTable() != NULL);
+    m_hasEvictedTable = (eviction_manager != NULL && m_targetTable->getEvictedTable() != NULL);
     #endif
-        
-    // OPTIMIZATION:
-    // If there is no predicate and no Projection for this SeqScan,
-    // then we have already set the node's OutputTable to just point
-    // at the TargetTable. Therefore, there is nothing we more we need
-    // to do here
-    if (hasEvictedTable || node->getPredicate() != NULL || projection_node != NULL || limit_node != NULL) {
-        // Just walk through the table using our iterator and apply
-        // the predicate to each tuple. For each tuple that satisfies
-        // our expression, we'll insert them into the output table.
-        TableTuple tuple(target_table->schema());
-        TableIterator iterator(target_table);
-        
-        AbstractExpression *predicate = node->getPredicate();
-        if (predicate) {
-            VOLT_DEBUG("SCAN PREDICATE A:\n%s\n", predicate->debug(true).c_str());
-            predicate->substitute(params);
-            assert(predicate != NULL);
-            VOLT_DEBUG("SCAN PREDICATE B:\n%s\n",
-                       predicate->debug(true).c_str());
+
+    // A compiled predicate program reads the parameters from params, so
+    // there is nothing to substitute
+    m_predicate = node->getPredicate();
+    m_params = &params;
+    m_usePredicateProgram = (isCompiled() && m_predicateProgram.isCompiled());
+    if (m_predicate && !m_usePredicateProgram) {
+        VOLT_DEBUG("SCAN PREDICATE A:\n%s\n", m_predicate->debug(true).c_str());
+        m_predicate->substitute(params);
+        assert(m_predicate != NULL);
+        VOLT_DEBUG("SCAN PREDICATE B:\n%s\n",
+                   m_predicate->debug(true).c_str());
+    }
+
+    // OPTIMIZATION: COLUMNAR SCAN
+    // If the table keeps columnar (PAX) blocks and the predicate is a
+    // simple comparison on one of those columns, then we can evaluate
+    // it on the column arrays and only visit the tuples that qualify.
+    // We can't do this when tracking the read set because that needs
+    // to see every tuple that the predicate looked at.
+    m_useColumnar = (!m_usePredicateProgram && tracker == NULL &&
+                     m_columnarFilter.init(m_targetTable, m_predicate));
+
+    // OPTIMIZATION: COMPILED PREDICATE
+    // Otherwise, once this fragment has been compiled, we evaluate the
+    // predicate directly on the tuple storage unless one of this
+    // execution's parameters has a type that it cannot compare
+    m_useCompiledPredicate = (isCompiled() && !m_useColumnar &&
+                              m_compiledPredicate.isCompiled() && m_compiledPredicate.bind());
+    m_useCompiledProjection = (isCompiled() && m_projectionNode != NULL &&
+                               m_projectionColumns.get() != NULL);
+    m_iterator.reset(new TableIterator(m_targetTable));
+    m_tuple = TableTuple(m_targetTable->schema());
+    m_tupleCount = 0;
+    return true;
+}
+
+bool SeqScanExecutor::getParallelScan(PersistentTable **table, const CompiledPredicate **predicate) {
+    // Read set tracking, the eviction chain and the limit need to see the
+    // tuples one at a time, in order
+    if (m_tracker != NULL || m_hasEvictedTable || m_limit >= 0 || m_projectionNode != NULL) {
+        return false;
+    }
+    *table = m_targetTable;
+    *predicate = NULL;
+    if (m_predicate == NULL) {
+        return true;
+    }
+    if (!m_useCompiledPredicate) {
+        // the columnar filter may have been picked instead
+        if (!isCompiled() || !m_compiledPredicate.isCompiled() || !m_compiledPredicate.bind()) {
+            return false;
         }
+    }
+    *predicate = &m_compiledPredicate;
+    return true;
+}
 
-        int tuple_ctr = 0;
-        while (iterator.next(tuple)) {
-            target_table->updateTupleAccessCount();
-            
-            // Read/Write Set Tracking
-            if (tracker != NULL) {
-                tracker->markTupleRead(target_table, &tuple);
-            }
-            
-            // No tuple that we find here should *ever* be evicted!!
-            #ifdef ANTICACHE
-            assert(tuple.isEvicted() == false);
-            #endif
-            
-            VOLT_DEBUG("INPUT TUPLE: %s, %d/%d\n",
-                       tuple.debug(target_table->name()).c_str(), tuple_ctr,
-                       (int)target_table->activeTupleCount());
+bool SeqScanExecutor::p_next(TableTuple &out) {
+    // Check whether we have gone past our limit
+    if (m_limit >= 0 && m_tupleCount >= m_limit) {
+        return false;
+    }
+
+    while (m_useColumnar ? m_columnarFilter.next(m_tuple) : m_iterator->next(m_tuple)) {
+        m_targetTable->updateTupleAccessCount();
+        
+        // Read/Write Set Tracking
+        if (m_tracker != NULL) {
+            m_tracker->markTupleRead(m_targetTable, &m_tuple);
+        }
+        
+        // No tuple that we find here should *ever* be evicted!!
+        #ifdef ANTICACHE
+        assert(m_tuple.isEvicted() == false);
+        #endif
+        
+        VOLT_DEBUG("INPUT TUPLE: %s, %d/%d\n",
+                   m_tuple.debug(m_targetTable->name()).c_str(), m_tupleCount,
+                   (int)m_targetTable->activeTupleCount());
+        //
+        // For each tuple we need to evaluate it against our predicate
+        //
+        if (m_useColumnar || m_predicate == NULL ||
+            (m_useCompiledPredicate ? m_compiledPredicate.eval(m_tuple) :
+             m_usePredicateProgram ? m_predicateProgram.evalPredicate(&m_tuple, NULL, *m_params) :
+                                     m_predicate->eval(&m_tuple, NULL).isTrue())) {
             //
-            // For each tuple we need to evaluate it against our predicate
+            // Nested Projection
+            // Project (or replace) values from input tuple
             //
-            if (predicate == NULL || predicate->eval(&tuple, NULL).isTrue()) {
-                //
-                // Nested Projection
-                // Project (or replace) values from input tuple
-                //
-                if (projection_node != NULL) {
-                    TableTuple &temp_tuple = output_table->tempTuple();
-                    for (int ctr = 0; ctr < num_of_columns; ctr++) {
-                        NValue value =
-                            projection_node->
-                          getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
-                        temp_tuple.setNValue(ctr, value);
-                    }
-                    if (!output_table->insertTuple(temp_tuple)) {
-                        VOLT_ERROR("Failed to insert tuple from table '%s' into"
-                                   " output table '%s'",
-                                   target_table->name().c_str(),
-                                   output_table->name().c_str());
-                        return false;
+            if (m_projectionNode != NULL) {
+                TableTuple &temp_tuple = m_outputTable->tempTuple();
+                if (m_useCompiledProjection) {
+                    for (int ctr = 0, cnt = (int)m_outputTable->columnCount(); ctr < cnt; ctr++) {
+                        temp_tuple.setNValue(ctr, m_tuple.getNValue(m_projectionColumns[ctr]));
                     }
                 } else {
-                    //
-                    // Insert the tuple into our output table
-                    //
-                    if (!output_table->insertTuple(tuple)) {
-                        VOLT_ERROR("Failed to insert tuple from table '%s' into"
-                                   " output table '%s'",
-                                   target_table->name().c_str(),
-                                   output_table->name().c_str());
-                        return false;
+                    for (int ctr = 0, cnt = (int)m_outputTable->columnCount(); ctr < cnt; ctr++) {
+                        NValue value =
+                            m_projectionNode->
+                          getOutputColumnExpressions()[ctr]->eval(&m_tuple, NULL);
+                        temp_tuple.setNValue(ctr, value);
                     }
                 }
-                ++tuple_ctr;
-                
-                #ifdef ANTICACHE
-                if (hasEvictedTable) {
-                    // update the tuple in the LRU eviction chain
-                    eviction_manager->updateTuple(target_table, &tuple, false);
-                }
-                #endif
-                
-                // Check whether we have gone past our limit
-                if (limit >= 0 && tuple_ctr >= limit) {
-                    break;
+                out = temp_tuple;
+            } else {
+                out = m_tuple;
+            }
+            ++m_tupleCount;
+            
+            #ifdef ANTICACHE
+            if (m_hasEvictedTable) {
+                // update the tuple in the LRU eviction chain
+                executor_context->getAntiCacheEvictionManager()->updateTuple(m_targetTable, &m_tuple, false);
+            }
+            #endif
+            return true;
+        }
+    } // WHILE
+    return false;
+}
+
+void SeqScanExecutor::p_close() {
+    #ifdef ANTICACHE
+    if (!m_hasEvictedTable) {
+        return;
+    }
+    AntiCacheEvictionManager* eviction_manager = executor_context->getAntiCacheEvictionManager();
+
+    // PAVLO 2014-07-17
+    // If we have an EvictedTable for our target table, then we need
+    // to create a second iterator to walk through the evicted tuples.
+    // We cannot use nested TableIterators because the schema for the
+    // we could jump to incorrect offsets. We can skip all of this 
+    // if we've already reached past our limit
+    if (!(m_limit >= 0 && m_tupleCount >= m_limit)) {
+        Table *evictedTable = m_targetTable->getEvictedTable();
+        TableTuple evictedTuple(evictedTable->schema());
+        TableIterator evictedIterator(evictedTable);
+        VOLT_DEBUG("Created EvictedTable iterator for %s", evictedTable->name().c_str());
+
+        // OPTIMIZATION: EVICTED KEY FILTER
+        // If the predicate pins down the primary key, then only the evicted
+        // tuple with that key can match, and we can skip the blocks that
+        // don't have it. Most of the time no block has it.
+        uint32_t key_fingerprint = 0;
+        bool filter_keys = getPredicateKeyFingerprint(key_fingerprint);
+        AntiCacheKeyFilter &key_filter = m_targetTable->getEvictedKeyFilter();
+        bool skip_evicted = (filter_keys && key_filter.mayContain(key_fingerprint) == false);
+        if (skip_evicted) {
+            VOLT_DEBUG("No evicted tuple from %s has the key in the predicate",
+                       m_targetTable->name().c_str());
+        }
+
+        int num_evicted = 0;
+        while (skip_evicted == false && evictedIterator.next(evictedTuple)) {
+            assert(evictedTuple.isEvicted());
+            // VOLT_INFO("Tuple in seq scan is evicted %s", m_catalogTable->name().c_str());      
+            if (filter_keys) {
+                int32_t block_id = ValuePeeker::peekInteger(evictedTuple.getNValue(0));
+                if (key_filter.mayContain(block_id, key_fingerprint) == false) {
+                    continue;
                 }
             }
+
+            // Tell the EvictionManager's internal tracker that we touched this mofo
+            eviction_manager->recordEvictedAccess(m_catalogTable, &evictedTuple);
+            
+            m_tupleCount++;
+            num_evicted++;
+            if (m_limit >= 0 && m_tupleCount >= m_limit) {
+                break;
+            }
         } // WHILE
-        
-        #ifdef ANTICACHE
-        // PAVLO 2014-07-17
-        // If we have an EvictedTable for our target table, then we need
-        // to create a second iterator to walk through the evicted tuples.
-        // We cannot use nested TableIterators because the schema for the
-        // we could jump to incorrect offsets. We can skip all of this 
-        // if we've already reached past our limit
-        if (hasEvictedTable && !(limit >= 0 && tuple_ctr >= limit)) {
-            Table *evictedTable = target_table->getEvictedTable();
-            TableTuple evictedTuple(evictedTable->schema());
-            TableIterator evictedIterator(evictedTable);
-            VOLT_DEBUG("Created EvictedTable iterator for %s", evictedTable->name().c_str());
-
-            int num_evicted = 0;
-            while (evictedIterator.next(evictedTuple)) {
-                assert(evictedTuple.isEvicted());
-                // VOLT_INFO("Tuple in seq scan is evicted %s", m_catalogTable->name().c_str());      
-
-                // Tell the EvictionManager's internal tracker that we touched this mofo
-                eviction_manager->recordEvictedAccess(m_catalogTable, &evictedTuple);
-                
-                tuple_ctr++;
-                num_evicted++;
-                if (limit >= 0 && tuple_ctr >= limit) {
-                    break;
-                }
-            } // WHILE
-            VOLT_DEBUG("Found %d evicted tuples from table %s", num_evicted, target_table->name().c_str());
+        VOLT_DEBUG("Found %d evicted tuples from table %s", num_evicted, m_targetTable->name().c_str());
+    }
+    
+    // throw exception indicating evicted blocks are needed
+    if (eviction_manager->hasEvictedAccesses()) {
+        // MJG: 2014-02-20
+        // If we can merge now, let's merge
+        // TODO: possibly an alternate codepath that simply looks through all the tuples
+        // for evicted tuples and then see if we have any non-blockable accesses
+        if (eviction_manager->hasBlockableEvictedAccesses()) {
+            //VOLT_ERROR("From seqscan!");
+            eviction_manager->blockingMerge();
+        } else {
+            //eviction_manager->blockingMerge();
+            eviction_manager->throwEvictedAccessException();
+        } 
+    }
+    #endif
+}
+
+#ifdef ANTICACHE
+bool SeqScanExecutor::getPredicateKeyFingerprint(uint32_t &fingerprint) {
+    TableIndex *pkey_index = m_targetTable->primaryKeyIndex();
+    if (m_predicate == NULL || pkey_index == NULL) {
+        return (false);
+    }
+    const std::vector<int> &columns = pkey_index->getColumnIndices();
+    std::vector<NValue> key(columns.size());
+    std::vector<bool> bound(columns.size(), false);
+    bindKeyColumns(m_predicate, columns, key, bound);
+    for (int i = 0; i < (int)bound.size(); i++) {
+        if (bound[i] == false) {
+            return (false);
         }
-        
-        // throw exception indicating evicted blocks are needed
-        if (hasEvictedTable && eviction_manager->hasEvictedAccesses()) {
-            // MJG: 2014-02-20
-            // If we can merge now, let's merge
-            // TODO: possibly an alternate codepath that simply looks through all the tuples
-            // for evicted tuples and then see if we have any non-blockable accesses
-            if (eviction_manager->hasBlockableEvictedAccesses()) {
-                //VOLT_ERROR("From seqscan!");
-                eviction_manager->blockingMerge();
-            } else {
-                //eviction_manager->blockingMerge();
-                eviction_manager->throwEvictedAccessException();
-            } 
+    }
+    fingerprint = AntiCacheKeyFilter::fingerprint(key);
+    return (true);
+}
+
+void SeqScanExecutor::bindKeyColumns(const AbstractExpression *expr, const std::vector<int> &columns,
+                                     std::vector<NValue> &key, std::vector<bool> &bound) {
+    // Only the equalities that every matching tuple satisfies
+    if (expr->getExpressionType() == EXPRESSION_TYPE_CONJUNCTION_AND) {
+        if (expr->getLeft() != NULL) bindKeyColumns(expr->getLeft(), columns, key, bound);
+        if (expr->getRight() != NULL) bindKeyColumns(expr->getRight(), columns, key, bound);
+        return;
+    }
+    if (expr->getExpressionType() != EXPRESSION_TYPE_COMPARE_EQUAL ||
+        expr->getLeft() == NULL || expr->getRight() == NULL) {
+        return;
+    }
+
+    const AbstractExpression *column = expr->getLeft();
+    const AbstractExpression *constant = expr->getRight();
+    if (column->getExpressionType() != EXPRESSION_TYPE_VALUE_TUPLE) {
+        std::swap(column, constant);
+    }
+    const TupleValueExpressionMarker *tve = dynamic_cast<const TupleValueExpressionMarker*>(column);
+    if (tve == NULL) {
+        return;
+    }
+    int position = -1;
+    for (int i = 0; i < (int)columns.size(); i++) {
+        if (columns[i] == tve->getColumnId()) {
+            position = i;
+            break;
         }
-        #endif
     }
-    VOLT_TRACE("\n%s\n", output_table->debug().c_str());
-    VOLT_DEBUG("Finished Seq scanning");
+    if (position < 0) {
+        return;
+    }
 
-    return true;
+    // The predicate program reads the parameters itself, so they are not
+    // always substituted into the predicate
+    NValue value;
+    if (constant->getExpressionType() == EXPRESSION_TYPE_VALUE_CONSTANT) {
+        value = constant->eval(NULL, NULL);
+    } else if (constant->getExpressionType() == EXPRESSION_TYPE_VALUE_PARAMETER) {
+        const ParameterValueExpressionMarker *param =
+            dynamic_cast<const ParameterValueExpressionMarker*>(constant);
+        if (param == NULL) {
+            return;
+        }
+        value = (*m_params)[param->getParameterId()];
+    } else {
+        return;
+    }
+
+    // The key has to hash like the column values do. Doubles that are
+    // equal can still hash differently (0.0 and -0.0).
+    const ValueType column_type = m_targetTable->schema()->columnType(tve->getColumnId());
+    if (column_type == VALUE_TYPE_DOUBLE || value.isNull()) {
+        return;
+    }
+    try {
+        key[position] = value.castAs(column_type);
+        bound[position] = true;
+    } catch (SQLException &ex) {
+        // No value of the column can be equal to it, but leave that to
+        // the predicate
+    }
 }
+#endif
@@ -46,28 +46,93 @@
 #ifndef HSTORESEQSCANEXECUTOR_H
 #define HSTORESEQSCANEXECUTOR_H
 
+#include "boost/scoped_ptr.hpp"
+#include "boost/shared_array.hpp"
 #include "common/common.h"
 #include "common/valuevector.h"
+#include "common/tabletuple.h"
 #include "executors/abstractexecutor.h"
+#include "executors/columnarscanfilter.h"
+#include "executors/compiledpredicate.h"
+#include "expressions/expressionprogram.h"
+#include "storage/tableiterator.h"
 #include "catalog/table.h"
 
 namespace voltdb
 {
     class UndoLog;
     class ReadWriteSet;
+    class AbstractExpression;
+    class PersistentTable;
+    class ProjectionPlanNode;
+    class SeqScanPlanNode;
+    class Table;
 
     class SeqScanExecutor : public AbstractExecutor {
     public:
         SeqScanExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
             : AbstractExecutor(engine, abstract_node)
         {}
+
+        bool supportsPipelining() const;
+        bool producesStableTuples() const;
+
+        /**
+         * Once opened as a pipelined child, tell whether the parent may
+         * scan the TargetTable itself, e.g. on several threads, instead of
+         * pulling the tuples through next(). That is the case when every
+         * tuple is handed out as is and the predicate, if any, is compiled
+         * into a CompiledPredicate, which is returned in predicate.
+         */
+        bool getParallelScan(PersistentTable **table, const CompiledPredicate **predicate);
     protected:
         bool p_init(AbstractPlanNode* abstract_node,
                     const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
         bool p_execute(const NValueArray& params, ReadWriteTracker *tracker);
+        bool p_compile();
+        bool p_open(const NValueArray& params, ReadWriteTracker *tracker);
+        bool p_next(TableTuple &out);
+        void p_close();
         bool needsOutputTableClear();
         
         catalog::Table* m_catalogTable;
+
+    private:
+#ifdef ANTICACHE
+        // If the predicate pins down every primary key column of the
+        // TargetTable, return the fingerprint of that key so that the
+        // evicted tuples that cannot match are left alone
+        bool getPredicateKeyFingerprint(uint32_t &fingerprint);
+        void bindKeyColumns(const AbstractExpression *expr, const std::vector<int> &columns,
+                            std::vector<NValue> &key, std::vector<bool> &bound);
+#endif
+
+        SeqScanPlanNode* m_node;
+
+        // Compiled form of the predicate and the inline projection. A
+        // predicate that is not simple enough for a CompiledPredicate is
+        // compiled into an ExpressionProgram.
+        CompiledPredicate m_compiledPredicate;
+        ExpressionProgram m_predicateProgram;
+        boost::shared_array<int> m_projectionColumns;
+
+        // Scan state between p_open() and p_close()
+        PersistentTable* m_targetTable;
+        Table* m_outputTable;
+        AbstractExpression* m_predicate;
+        ProjectionPlanNode* m_projectionNode;
+        ReadWriteTracker* m_tracker;
+        int m_limit;
+        int m_tupleCount;
+        bool m_hasEvictedTable;
+        bool m_useColumnar;
+        bool m_useCompiledPredicate;
+        bool m_usePredicateProgram;
+        const NValueArray* m_params;
+        bool m_useCompiledProjection;
+        ColumnarScanFilter m_columnarFilter;
+        boost::scoped_ptr<TableIterator> m_iterator;
+        TableTuple m_tuple;
     };
 }
 
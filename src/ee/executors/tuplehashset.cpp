@@ -0,0 +1,180 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "executors/tuplehashset.h"
+#include "common/NValue.hpp"
+#include "common/TupleSchema.h"
+#include "indexes/indexkey.h"
+
+using namespace std;
+
+namespace voltdb {
+
+// slots of an empty set
+static const size_t INITIAL_SLOTS = 64;
+
+static inline uint64_t mix(uint64_t h) {
+    // murmur3 finalizer
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint64_t hashBytes(const char *bytes, int32_t length) {
+    uint64_t h = static_cast<uint64_t>(length);
+    int32_t ii = 0;
+    for (; ii + 8 <= length; ii += 8) {
+        uint64_t word;
+        ::memcpy(&word, bytes + ii, sizeof(word));
+        h = mix(h ^ (word * 0x9E3779B97F4A7C15ULL));
+    }
+    if (ii < length) {
+        uint64_t word = 0;
+        ::memcpy(&word, bytes + ii, static_cast<size_t>(length - ii));
+        h = mix(h ^ (word * 0x9E3779B97F4A7C15ULL));
+    }
+    return h;
+}
+
+TupleHashSet::TupleHashSet() : m_mask(0), m_keyLength(0) {
+}
+
+bool TupleHashSet::init(const TupleSchema *schema, const vector<int> &columns) {
+    for (size_t ii = 0; ii < columns.size(); ii++) {
+        switch (schema->columnType(columns[ii])) {
+            case VALUE_TYPE_TINYINT:
+            case VALUE_TYPE_SMALLINT:
+            case VALUE_TYPE_INTEGER:
+            case VALUE_TYPE_BIGINT:
+            case VALUE_TYPE_TIMESTAMP:
+            case VALUE_TYPE_DOUBLE:
+            case VALUE_TYPE_DECIMAL:
+            case VALUE_TYPE_VARCHAR:
+            case VALUE_TYPE_VARBINARY:
+                break;
+            default:
+                return false;
+        }
+    }
+    m_columns = columns;
+    clear();
+    return true;
+}
+
+void TupleHashSet::clear() {
+    m_slots.assign(INITIAL_SLOTS, Slot());
+    for (size_t ii = 0; ii < m_slots.size(); ii++) {
+        m_slots[ii].entry = -1;
+    }
+    m_mask = m_slots.size() - 1;
+    m_entries.clear();
+    m_keyPool.purge();
+}
+
+uint64_t TupleHashSet::encode(const TableTuple &tuple) {
+    int32_t length = 0;
+    for (size_t ii = 0; ii < m_columns.size(); ii++) {
+        length += NormalizedKeyEncoder::length(tuple.getNValue(m_columns[ii]));
+    }
+    if (static_cast<size_t>(length) > m_key.size()) {
+        m_key.resize(static_cast<size_t>(length));
+    }
+    char *out = &m_key[0];
+    for (size_t ii = 0; ii < m_columns.size(); ii++) {
+        out = NormalizedKeyEncoder::encode(out, tuple.getNValue(m_columns[ii]));
+    }
+    m_keyLength = length;
+    return hashBytes(&m_key[0], length);
+}
+
+uint64_t TupleHashSet::findSlot(uint64_t hash) const {
+    for (uint64_t position = hash & m_mask; ; position = (position + 1) & m_mask) {
+        const Slot &slot = m_slots[position];
+        if (slot.entry < 0) {
+            return position;
+        }
+        if (slot.hash == hash) {
+            const Entry &entry = m_entries[slot.entry];
+            if (entry.length == m_keyLength && ::memcmp(entry.key, &m_key[0], m_keyLength) == 0) {
+                return position;
+            }
+        }
+    }
+}
+
+int32_t TupleHashSet::insert(const TableTuple &tuple, bool *inserted) {
+    const uint64_t hash = encode(tuple);
+    Slot &slot = m_slots[findSlot(hash)];
+    if (slot.entry >= 0) {
+        *inserted = false;
+        return slot.entry;
+    }
+
+    Entry entry;
+    char *key = static_cast<char*>(m_keyPool.allocate(m_keyLength));
+    ::memcpy(key, &m_key[0], m_keyLength);
+    entry.key = key;
+    entry.length = m_keyLength;
+    entry.mark = 0;
+    entry.tuple = tuple.address();
+    slot.hash = hash;
+    slot.entry = static_cast<int32_t>(m_entries.size());
+    m_entries.push_back(entry);
+    *inserted = true;
+
+    // keep the table at most half full
+    if (m_entries.size() * 2 > m_slots.size()) {
+        grow();
+    }
+    return static_cast<int32_t>(m_entries.size() - 1);
+}
+
+int32_t TupleHashSet::find(const TableTuple &tuple) {
+    const uint64_t hash = encode(tuple);
+    return m_slots[findSlot(hash)].entry;
+}
+
+void TupleHashSet::grow() {
+    vector<Slot> slots(m_slots.size() * 2);
+    m_slots.swap(slots);
+    m_mask = m_slots.size() - 1;
+    for (size_t ii = 0; ii < m_slots.size(); ii++) {
+        m_slots[ii].entry = -1;
+    }
+    for (size_t ii = 0; ii < slots.size(); ii++) {
+        if (slots[ii].entry < 0) continue;
+        uint64_t position = slots[ii].hash & m_mask;
+        while (m_slots[position].entry >= 0) {
+            position = (position + 1) & m_mask;
+        }
+        m_slots[position] = slots[ii];
+    }
+}
+
+}
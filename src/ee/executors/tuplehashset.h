@@ -0,0 +1,129 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORETUPLEHASHSET_H
+#define HSTORETUPLEHASHSET_H
+
+#include <vector>
+#include "common/Pool.hpp"
+#include "common/tabletuple.h"
+
+namespace voltdb {
+
+class TupleSchema;
+
+/**
+ * Set of tuples that are told apart by a list of their columns, for
+ * DISTINCT and the UNION/INTERSECT/EXCEPT set operations.
+ *
+ * The values of the columns are encoded one after the other with the
+ * NormalizedKeyEncoder of the indexes, so two keys are equal exactly when
+ * their bytes are (two NULLs included). The encoded keys are copied into a
+ * Pool arena and found through a flat open-addressing table of hashes, so
+ * adding a key costs no allocation of its own and no NValue comparisons.
+ *
+ * Every key has an entry that remembers the first tuple it was added with
+ * and a mark that the caller can use, e.g. to count the inputs a key was
+ * seen in. The entries keep the order in which the keys were added.
+ */
+class TupleHashSet {
+public:
+    TupleHashSet();
+
+    /**
+     * Tell apart the tuples of the given schema by the given columns.
+     * Returns false if the type of a column cannot be hashed.
+     */
+    bool init(const TupleSchema *schema, const std::vector<int> &columns);
+
+    /**
+     * Add the key of the tuple. Returns the entry of the key, and whether
+     * the key is new in inserted. The tuple of a new entry must stay valid
+     * as long as the entry is used.
+     */
+    int32_t insert(const TableTuple &tuple, bool *inserted);
+
+    /** The entry of the key of the tuple, or -1 if there is none */
+    int32_t find(const TableTuple &tuple);
+
+    /** Storage of the first tuple that was added with the key of the entry */
+    inline char* entryTuple(int32_t entry) const {
+        return m_entries[entry].tuple;
+    }
+
+    inline int32_t getMark(int32_t entry) const {
+        return m_entries[entry].mark;
+    }
+
+    inline void setMark(int32_t entry, int32_t mark) {
+        m_entries[entry].mark = mark;
+    }
+
+    /** Keys in the set, which are entries 0 to size() - 1 */
+    inline int32_t size() const {
+        return static_cast<int32_t>(m_entries.size());
+    }
+
+    /** Remove every key and release the memory of the keys */
+    void clear();
+
+private:
+    struct Entry {
+        const char *key;
+        int32_t length;
+        int32_t mark;
+        char *tuple;
+    };
+
+    struct Slot {
+        uint64_t hash;
+        // index of the entry, or -1 if the slot is empty
+        int32_t entry;
+    };
+
+    /** Encode the key of the tuple into m_key and return its hash */
+    uint64_t encode(const TableTuple &tuple);
+    /** The slot of the key in m_key, which is either empty or holds it */
+    uint64_t findSlot(uint64_t hash) const;
+    void grow();
+
+    std::vector<int> m_columns;
+
+    // the hash table, with a power of two size
+    std::vector<Slot> m_slots;
+    uint64_t m_mask;
+
+    std::vector<Entry> m_entries;
+    // the bytes of the keys of the entries
+    Pool m_keyPool;
+
+    // the key being looked up
+    std::vector<char> m_key;
+    int32_t m_keyLength;
+};
+
+}
+
+#endif
@@ -0,0 +1,495 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include "executors/typedhashaggregator.h"
+#include "executors/executorinput.h"
+#include "common/debuglog.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/TupleSchema.h"
+#include "storage/table.h"
+
+using namespace std;
+
+namespace voltdb {
+
+// slots in the hash table of an empty aggregation
+static const uint64_t INITIAL_SLOT_COUNT = 1024;
+
+static inline bool isIntegerType(ValueType type) {
+    return (type == VALUE_TYPE_TINYINT || type == VALUE_TYPE_SMALLINT ||
+            type == VALUE_TYPE_INTEGER || type == VALUE_TYPE_BIGINT);
+}
+
+static inline uint64_t hashKey(const uint64_t *words) {
+    // murmur3 finalizer over both words
+    uint64_t h = words[0] ^ (words[1] * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * sum += value, with the overflow checking of NValue::op_add(). Like the
+ * generic SumAgg, a sum that became NULL stays NULL.
+ */
+static inline void addBigInt(int64_t &sum, int64_t value) {
+    if (sum == INT64_NULL) return;
+    const int64_t result = static_cast<int64_t>(static_cast<uint64_t>(sum) + static_cast<uint64_t>(value));
+    if (((sum ^ result) & (value ^ result)) < 0) {
+        // throws the overflow exception
+        ValueFactory::getBigIntValue(sum).op_add(ValueFactory::getBigIntValue(value));
+    }
+    sum = result;
+}
+
+static inline void addDouble(double &sum, double value) {
+    if (sum <= DOUBLE_NULL) return;
+    const double result = sum + value;
+    if (CHECK_FPE(result)) {
+        // throws the overflow exception
+        ValueFactory::getDoubleValue(sum).op_add(ValueFactory::getDoubleValue(value));
+    }
+    sum = result;
+}
+
+TypedHashAggregator::TypedHashAggregator() : m_inputSchema(NULL), m_mask(0), m_rowCount(0) {
+}
+
+bool TypedHashAggregator::init(const TupleSchema *inputSchema,
+                               const vector<int> &groupByColumns,
+                               const vector<ExpressionType> &aggregateTypes,
+                               const vector<int> &aggregateColumns) {
+    assert(aggregateTypes.size() == aggregateColumns.size());
+    m_inputSchema = inputSchema;
+    m_keyColumns.clear();
+    m_aggregates.clear();
+
+    uint32_t keyLength = 0;
+    for (size_t ii = 0; ii < groupByColumns.size(); ii++) {
+        const ValueType type = inputSchema->columnType(groupByColumns[ii]);
+        if (!isIntegerType(type) && type != VALUE_TYPE_TIMESTAMP) {
+            return false;
+        }
+        KeyColumn column;
+        column.offset = TUPLE_HEADER_SIZE + inputSchema->columnOffset(groupByColumns[ii]);
+        column.width = static_cast<uint32_t>(NValue::getTupleStorageSize(type));
+        column.keyOffset = keyLength;
+        keyLength += column.width;
+        if (keyLength > sizeof(GroupKey)) {
+            return false;
+        }
+        m_keyColumns.push_back(column);
+    }
+
+    for (size_t ii = 0; ii < aggregateTypes.size(); ii++) {
+        Aggregate aggregate;
+        aggregate.type = aggregateTypes[ii];
+        aggregate.columnType = inputSchema->columnType(aggregateColumns[ii]);
+        aggregate.offset = TUPLE_HEADER_SIZE + inputSchema->columnOffset(aggregateColumns[ii]);
+        switch (aggregate.type) {
+            case EXPRESSION_TYPE_AGGREGATE_COUNT_STAR:
+                break;
+            case EXPRESSION_TYPE_AGGREGATE_COUNT:
+            case EXPRESSION_TYPE_AGGREGATE_SUM:
+            case EXPRESSION_TYPE_AGGREGATE_AVG:
+            case EXPRESSION_TYPE_AGGREGATE_MIN:
+            case EXPRESSION_TYPE_AGGREGATE_MAX:
+                if (!isIntegerType(aggregate.columnType) && aggregate.columnType != VALUE_TYPE_DOUBLE) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+        m_aggregates.push_back(aggregate);
+    }
+    VOLT_DEBUG("Typed hash aggregation with a %d byte group key and %d aggregates",
+               (int)keyLength, (int)m_aggregates.size());
+    return true;
+}
+
+bool TypedHashAggregator::execute(ExecutorInput &input, Table *outputTable,
+                                  const vector<int> &aggregateOutputColumns,
+                                  const vector<pair<int, int> > &passThroughColumns) {
+    Table *inputTable = input.getTable();
+    assert(inputTable->schema()->columnCount() == m_inputSchema->columnCount());
+    reset();
+    TableTuple tuple(inputTable->schema());
+    while (input.next(tuple)) {
+        add(tuple.address());
+    }
+    flush();
+    return finish(outputTable, aggregateOutputColumns, passThroughColumns);
+}
+
+void TypedHashAggregator::reset() {
+    Slot empty;
+    ::memset(&empty, 0, sizeof(empty));
+    empty.group = -1;
+    m_slots.assign(INITIAL_SLOT_COUNT, empty);
+    m_mask = INITIAL_SLOT_COUNT - 1;
+    m_groupRows.clear();
+    m_states.clear();
+    m_rowCount = 0;
+}
+
+void TypedHashAggregator::flush() {
+    if (m_rowCount > 0) {
+        processBatch(m_rows, m_rowCount);
+        m_rowCount = 0;
+    }
+}
+
+bool TypedHashAggregator::finish(Table *outputTable,
+                                 const vector<int> &aggregateOutputColumns,
+                                 const vector<pair<int, int> > &passThroughColumns) {
+    assert(m_rowCount == 0);
+    TableTuple groupTuple(m_inputSchema);
+    for (size_t group = 0; group < m_groupRows.size(); group++) {
+        groupTuple.move(m_groupRows[group]);
+        if (!insertGroup(outputTable, static_cast<int32_t>(group), groupTuple,
+                         aggregateOutputColumns, passThroughColumns)) {
+            return false;
+        }
+    }
+
+    // Without a GROUP BY an empty input still gives one row
+    if (m_keyColumns.empty() && m_groupRows.empty()) {
+        m_states.resize(m_aggregates.size());
+        ::memset(&m_states[0], 0, sizeof(AggState) * m_states.size());
+        if (!insertGroup(outputTable, 0, TableTuple(), aggregateOutputColumns, passThroughColumns)) {
+            return false;
+        }
+        m_states.clear();
+    }
+    return true;
+}
+
+void TypedHashAggregator::merge(const TypedHashAggregator &other) {
+    assert(m_rowCount == 0 && other.m_rowCount == 0);
+    assert(other.m_aggregates.size() == m_aggregates.size());
+    const size_t stride = m_aggregates.size();
+    GroupKey key;
+    for (size_t otherGroup = 0; otherGroup < other.m_groupRows.size(); otherGroup++) {
+        char *row = other.m_groupRows[otherGroup];
+        packKey(row, key);
+        const int32_t group = findGroup(key, row);
+        AggState *states = &m_states[group * stride];
+        const AggState *otherStates = &other.m_states[otherGroup * stride];
+        for (size_t aa = 0; aa < stride; aa++) {
+            AggState &state = states[aa];
+            const AggState &otherState = otherStates[aa];
+            if (otherState.count == 0) {
+                continue;
+            }
+            const Aggregate &aggregate = m_aggregates[aa];
+            const bool isDouble = (aggregate.columnType == VALUE_TYPE_DOUBLE);
+            switch (aggregate.type) {
+                case EXPRESSION_TYPE_AGGREGATE_COUNT:
+                case EXPRESSION_TYPE_AGGREGATE_COUNT_STAR:
+                    break;
+                case EXPRESSION_TYPE_AGGREGATE_SUM:
+                case EXPRESSION_TYPE_AGGREGATE_AVG:
+                    if (state.count == 0) {
+                        state.integer = otherState.integer;
+                    } else if (isDouble) {
+                        addDouble(state.real, otherState.real);
+                    } else {
+                        addBigInt(state.integer, otherState.integer);
+                    }
+                    break;
+                case EXPRESSION_TYPE_AGGREGATE_MIN:
+                    if (state.count == 0 ||
+                        (isDouble ? otherState.real < state.real : otherState.integer < state.integer)) {
+                        state.integer = otherState.integer;
+                    }
+                    break;
+                default:
+                    assert(aggregate.type == EXPRESSION_TYPE_AGGREGATE_MAX);
+                    if (state.count == 0 ||
+                        (isDouble ? otherState.real > state.real : otherState.integer > state.integer)) {
+                        state.integer = otherState.integer;
+                    }
+            }
+            state.count += otherState.count;
+        }
+    }
+}
+
+void TypedHashAggregator::packKey(const char *row, GroupKey &key) const {
+    ::memset(&key, 0, sizeof(key));
+    for (size_t cc = 0; cc < m_keyColumns.size(); cc++) {
+        const KeyColumn &column = m_keyColumns[cc];
+        ::memcpy(reinterpret_cast<char*>(key.words) + column.keyOffset,
+                 row + column.offset, column.width);
+    }
+}
+
+void TypedHashAggregator::processBatch(char **rows, int count) {
+    // pack the group keys one column at a time
+    ::memset(m_keys, 0, sizeof(GroupKey) * count);
+    for (size_t cc = 0; cc < m_keyColumns.size(); cc++) {
+        const KeyColumn &column = m_keyColumns[cc];
+        for (int ii = 0; ii < count; ii++) {
+            ::memcpy(reinterpret_cast<char*>(m_keys[ii].words) + column.keyOffset,
+                     rows[ii] + column.offset, column.width);
+        }
+    }
+    for (int ii = 0; ii < count; ii++) {
+        m_groups[ii] = findGroup(m_keys[ii], rows[ii]);
+    }
+
+    // then advance one aggregate at a time
+    for (size_t aa = 0; aa < m_aggregates.size(); aa++) {
+        const Aggregate &aggregate = m_aggregates[aa];
+        const int index = static_cast<int>(aa);
+        if (aggregate.type == EXPRESSION_TYPE_AGGREGATE_COUNT_STAR) {
+            const size_t stride = m_aggregates.size();
+            for (int ii = 0; ii < count; ii++) {
+                m_states[m_groups[ii] * stride + aa].count++;
+            }
+            continue;
+        }
+        switch (aggregate.columnType) {
+            case VALUE_TYPE_TINYINT:
+                advanceIntegers<int8_t>(aggregate, index, rows, count);
+                break;
+            case VALUE_TYPE_SMALLINT:
+                advanceIntegers<int16_t>(aggregate, index, rows, count);
+                break;
+            case VALUE_TYPE_INTEGER:
+                advanceIntegers<int32_t>(aggregate, index, rows, count);
+                break;
+            case VALUE_TYPE_BIGINT:
+                advanceIntegers<int64_t>(aggregate, index, rows, count);
+                break;
+            default:
+                assert(aggregate.columnType == VALUE_TYPE_DOUBLE);
+                advanceDoubles(aggregate, index, rows, count);
+        }
+    }
+}
+
+template <typename T> static inline T nullValue();
+template <> inline int8_t nullValue<int8_t>() { return INT8_NULL; }
+template <> inline int16_t nullValue<int16_t>() { return INT16_NULL; }
+template <> inline int32_t nullValue<int32_t>() { return INT32_NULL; }
+template <> inline int64_t nullValue<int64_t>() { return INT64_NULL; }
+
+template <typename T>
+void TypedHashAggregator::advanceIntegers(const Aggregate &aggregate, int index,
+                                          char **rows, int count) {
+    const T null = nullValue<T>();
+    const size_t stride = m_aggregates.size();
+    AggState *states = &m_states[index];
+    T value;
+    switch (aggregate.type) {
+        case EXPRESSION_TYPE_AGGREGATE_COUNT:
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(T));
+                if (value != null) states[m_groups[ii] * stride].count++;
+            }
+            break;
+        case EXPRESSION_TYPE_AGGREGATE_SUM:
+        case EXPRESSION_TYPE_AGGREGATE_AVG:
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(T));
+                if (value == null) continue;
+                AggState &state = states[m_groups[ii] * stride];
+                if (state.count++ == 0) {
+                    state.integer = value;
+                } else {
+                    addBigInt(state.integer, value);
+                }
+            }
+            break;
+        case EXPRESSION_TYPE_AGGREGATE_MIN:
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(T));
+                if (value == null) continue;
+                AggState &state = states[m_groups[ii] * stride];
+                if (state.count++ == 0 || value < state.integer) {
+                    state.integer = value;
+                }
+            }
+            break;
+        default:
+            assert(aggregate.type == EXPRESSION_TYPE_AGGREGATE_MAX);
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(T));
+                if (value == null) continue;
+                AggState &state = states[m_groups[ii] * stride];
+                if (state.count++ == 0 || value > state.integer) {
+                    state.integer = value;
+                }
+            }
+    }
+}
+
+void TypedHashAggregator::advanceDoubles(const Aggregate &aggregate, int index,
+                                         char **rows, int count) {
+    const size_t stride = m_aggregates.size();
+    AggState *states = &m_states[index];
+    double value;
+    switch (aggregate.type) {
+        case EXPRESSION_TYPE_AGGREGATE_COUNT:
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(double));
+                if (value > DOUBLE_NULL) states[m_groups[ii] * stride].count++;
+            }
+            break;
+        case EXPRESSION_TYPE_AGGREGATE_SUM:
+        case EXPRESSION_TYPE_AGGREGATE_AVG:
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(double));
+                if (value <= DOUBLE_NULL) continue;
+                AggState &state = states[m_groups[ii] * stride];
+                if (state.count++ == 0) {
+                    state.real = value;
+                } else {
+                    addDouble(state.real, value);
+                }
+            }
+            break;
+        case EXPRESSION_TYPE_AGGREGATE_MIN:
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(double));
+                if (value <= DOUBLE_NULL) continue;
+                AggState &state = states[m_groups[ii] * stride];
+                if (state.count++ == 0 || value < state.real) {
+                    state.real = value;
+                }
+            }
+            break;
+        default:
+            assert(aggregate.type == EXPRESSION_TYPE_AGGREGATE_MAX);
+            for (int ii = 0; ii < count; ii++) {
+                ::memcpy(&value, rows[ii] + aggregate.offset, sizeof(double));
+                if (value <= DOUBLE_NULL) continue;
+                AggState &state = states[m_groups[ii] * stride];
+                if (state.count++ == 0 || value > state.real) {
+                    state.real = value;
+                }
+            }
+    }
+}
+
+int32_t TypedHashAggregator::findGroup(const GroupKey &key, char *row) {
+    for (uint64_t position = hashKey(key.words) & m_mask; ; position = (position + 1) & m_mask) {
+        Slot &slot = m_slots[position];
+        if (slot.group < 0) {
+            const int32_t group = static_cast<int32_t>(m_groupRows.size());
+            slot.key = key;
+            slot.group = group;
+            m_groupRows.push_back(row);
+            AggState state;
+            state.integer = 0;
+            state.count = 0;
+            m_states.resize(m_states.size() + m_aggregates.size(), state);
+            // keep the table at most half full
+            if (m_groupRows.size() * 2 > m_slots.size()) {
+                grow();
+            }
+            return group;
+        }
+        if (slot.key.words[0] == key.words[0] && slot.key.words[1] == key.words[1]) {
+            return slot.group;
+        }
+    }
+}
+
+void TypedHashAggregator::grow() {
+    vector<Slot> slots(m_slots.size() * 2);
+    m_slots.swap(slots);
+    m_mask = m_slots.size() - 1;
+    for (size_t ii = 0; ii < m_slots.size(); ii++) {
+        m_slots[ii].group = -1;
+    }
+    for (size_t ii = 0; ii < slots.size(); ii++) {
+        if (slots[ii].group < 0) continue;
+        uint64_t position = hashKey(slots[ii].key.words) & m_mask;
+        while (m_slots[position].group >= 0) {
+            position = (position + 1) & m_mask;
+        }
+        m_slots[position] = slots[ii];
+    }
+}
+
+NValue TypedHashAggregator::finalizeAggregate(const Aggregate &aggregate, const AggState &state) const {
+    // the same operations as the generic Agg classes
+    const bool isDouble = (aggregate.columnType == VALUE_TYPE_DOUBLE);
+    switch (aggregate.type) {
+        case EXPRESSION_TYPE_AGGREGATE_COUNT:
+        case EXPRESSION_TYPE_AGGREGATE_COUNT_STAR:
+            return ValueFactory::getBigIntValue(state.count);
+        case EXPRESSION_TYPE_AGGREGATE_AVG:
+            if (state.count == 0) {
+                return ValueFactory::getNullValue();
+            }
+            return (isDouble ? ValueFactory::getDoubleValue(state.real) :
+                               ValueFactory::getBigIntValue(state.integer)).
+                op_divide(ValueFactory::getDoubleValue(static_cast<double>(state.count)));
+        default:
+            if (state.count == 0) {
+                return ValueFactory::getNullValue();
+            }
+            return (isDouble ? ValueFactory::getDoubleValue(state.real) :
+                               ValueFactory::getBigIntValue(state.integer));
+    }
+}
+
+bool TypedHashAggregator::insertGroup(Table *outputTable, int32_t group, const TableTuple &groupTuple,
+                                      const vector<int> &aggregateOutputColumns,
+                                      const vector<pair<int, int> > &passThroughColumns) {
+    TableTuple &tmptup = outputTable->tempTuple();
+    const AggState *states = &m_states[group * m_aggregates.size()];
+    for (size_t ii = 0; ii < m_aggregates.size(); ii++) {
+        const int columnIndex = aggregateOutputColumns[ii];
+        tmptup.setNValue(columnIndex,
+                         finalizeAggregate(m_aggregates[ii], states[ii]).castAs(tmptup.getType(columnIndex)));
+    }
+    for (size_t ii = 0; ii < passThroughColumns.size(); ii++) {
+        const int columnIndex = passThroughColumns[ii].first;
+        if (groupTuple.isNullTuple()) {
+            tmptup.setNValue(columnIndex, NValue::getNullValue(tmptup.getType(columnIndex)));
+        } else {
+            tmptup.setNValue(columnIndex, groupTuple.getNValue(passThroughColumns[ii].second));
+        }
+    }
+    if (!outputTable->insertTuple(tmptup)) {
+        VOLT_ERROR("Failed to insert aggregate tuple into output table '%s'",
+                   outputTable->name().c_str());
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,189 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORETYPEDHASHAGGREGATOR_H
+#define HSTORETYPEDHASHAGGREGATOR_H
+
+#include <utility>
+#include <vector>
+#include "common/types.h"
+#include "common/tabletuple.h"
+
+namespace voltdb {
+
+class ExecutorInput;
+class NValue;
+class Table;
+class TupleSchema;
+
+/**
+ * Hash aggregation specialized for the common shapes of GROUP BY queries:
+ * group keys made of integer columns that pack into 16 bytes, and
+ * SUM/COUNT/MIN/MAX/AVG over integer or double columns (plus COUNT(*)
+ * over anything).
+ *
+ * Groups live in a flat open-addressing table keyed on the packed key
+ * bytes. The state of every aggregate is a fixed-width typed slot, so the
+ * values are read straight from the tuple storage instead of going
+ * through NValue and a virtual Agg::advance(). The input is processed in
+ * batches: the group of every tuple in a batch is looked up first, then
+ * each aggregate runs one tight loop over the batch.
+ *
+ * The results are identical to the generic Agg classes: the final values
+ * are computed with the same NValue operations, and a sum that overflows
+ * throws the same exception.
+ */
+class TypedHashAggregator {
+public:
+    TypedHashAggregator();
+
+    /**
+     * Bind the aggregator to the input schema and the aggregates of a
+     * plan node. Returns false if a group by column or an aggregate is
+     * not supported, in which case the caller must use the generic
+     * aggregation.
+     */
+    bool init(const TupleSchema *inputSchema,
+              const std::vector<int> &groupByColumns,
+              const std::vector<ExpressionType> &aggregateTypes,
+              const std::vector<int> &aggregateColumns);
+
+    /**
+     * Aggregate the whole (opened) input and insert one row per group in
+     * the output table. The input tuples must stay valid until the end. The results of aggregate i go to output column
+     * aggregateOutputColumns[i], and the pass through columns are copied
+     * from the first tuple of each group.
+     */
+    bool execute(ExecutorInput &input, Table *outputTable,
+                 const std::vector<int> &aggregateOutputColumns,
+                 const std::vector<std::pair<int, int> > &passThroughColumns);
+
+    // The parts of execute(), for callers that feed the tuples themselves
+    // (e.g., one partial aggregation per thread that are merged at the end)
+
+    /** Forget the groups of the last aggregation */
+    void reset();
+
+    /** Aggregate the tuple with the given storage, which must stay valid */
+    inline void add(char *row) {
+        m_rows[m_rowCount++] = row;
+        if (m_rowCount == BATCH_SIZE) {
+            flush();
+        }
+    }
+
+    /** Aggregate the tuples that add() is still holding back */
+    void flush();
+
+    /**
+     * Fold the groups of another aggregator with the same init() into this
+     * one. Both have to be flushed. Groups that are new to this one keep
+     * the first tuple of the other one.
+     */
+    void merge(const TypedHashAggregator &other);
+
+    /** Insert one row per group in the output table, like execute() */
+    bool finish(Table *outputTable,
+                const std::vector<int> &aggregateOutputColumns,
+                const std::vector<std::pair<int, int> > &passThroughColumns);
+
+    /** Groups found by the last execute() */
+    inline int64_t getGroupCount() const {
+        return static_cast<int64_t>(m_groupRows.size());
+    }
+
+    /** Tuples handed to the aggregates at a time */
+    static const int BATCH_SIZE = 1024;
+
+private:
+    struct GroupKey {
+        uint64_t words[2];
+    };
+
+    struct Slot {
+        GroupKey key;
+        // index of the group, or -1 if the slot is empty
+        int32_t group;
+    };
+
+    /** Running state of one aggregate of one group */
+    struct AggState {
+        union {
+            int64_t integer;
+            double real;
+        };
+        // values advanced so far
+        int64_t count;
+    };
+
+    struct KeyColumn {
+        uint32_t offset;
+        uint32_t width;
+        uint32_t keyOffset;
+    };
+
+    struct Aggregate {
+        ExpressionType type;
+        ValueType columnType;
+        uint32_t offset;
+    };
+
+    void packKey(const char *row, GroupKey &key) const;
+    void processBatch(char **rows, int count);
+    int32_t findGroup(const GroupKey &key, char *row);
+    void grow();
+    NValue finalizeAggregate(const Aggregate &aggregate, const AggState &state) const;
+    bool insertGroup(Table *outputTable, int32_t group, const TableTuple &groupTuple,
+                     const std::vector<int> &aggregateOutputColumns,
+                     const std::vector<std::pair<int, int> > &passThroughColumns);
+
+    template <typename T> void advanceIntegers(const Aggregate &aggregate, int index,
+                                               char **rows, int count);
+    void advanceDoubles(const Aggregate &aggregate, int index, char **rows, int count);
+
+    const TupleSchema *m_inputSchema;
+    std::vector<KeyColumn> m_keyColumns;
+    std::vector<Aggregate> m_aggregates;
+
+    // the hash table, with a power of two size
+    std::vector<Slot> m_slots;
+    uint64_t m_mask;
+
+    // per group: the first tuple, and the aggregate states
+    std::vector<char*> m_groupRows;
+    std::vector<AggState> m_states;
+
+    // per tuple of the current batch
+    GroupKey m_keys[BATCH_SIZE];
+    int32_t m_groups[BATCH_SIZE];
+
+    // tuples given to add() that are not aggregated yet
+    char *m_rows[BATCH_SIZE];
+    int m_rowCount;
+};
+
+}
+
+#endif
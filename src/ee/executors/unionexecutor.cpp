@@ -119,6 +119,22 @@ bool UnionExecutor::p_init(AbstractPlanNode *abstract_node,
             node->getInputTables()[0]->name(),
             node->getInputTables()[0],
             tempTableMemoryInBytes));
+
+    //
+    // The set operations tell the tuples apart by all of their columns
+    //
+    if (node->getUnionType() != UNION_TYPE_UNION_ALL) {
+        std::vector<int> columns;
+        for (int col_ctr = 0, col_cnt = table0Schema->columnCount(); col_ctr < col_cnt; col_ctr++) {
+            columns.push_back(col_ctr);
+        }
+        if (!m_found.init(table0Schema, columns)) {
+            VOLT_ERROR("Cannot hash the tuples of table '%s' for %s",
+                       node->getInputTables()[0]->name().c_str(),
+                       unionToString(node->getUnionType()).c_str());
+            return false;
+        }
+    }
     return true;
 }
 
@@ -128,12 +144,19 @@ bool UnionExecutor::p_execute(const NValueArray &params, ReadWriteTracker *track
     Table* output_table = node->getOutputTable();
     assert(output_table);
 
+    if (node->getUnionType() == UNION_TYPE_UNION_ALL) {
+        return executeUnionAll(output_table, node->getInputTables());
+    }
+    return executeSetOperation(node->getUnionType(), output_table, node->getInputTables());
+}
+
+bool UnionExecutor::executeUnionAll(Table *output_table, const std::vector<Table*> &input_tables) {
     //
     // For each input table, grab their TableIterator and then append all of its tuples
     // to our ouput table
     //
-    for (int ctr = 0, cnt = (int)node->getInputTables().size(); ctr < cnt; ctr++) {
-        Table* input_table = node->getInputTables()[ctr];
+    for (int ctr = 0, cnt = (int)input_tables.size(); ctr < cnt; ctr++) {
+        Table* input_table = input_tables[ctr];
         assert(input_table);
         TableIterator iterator(input_table);
         TableTuple tuple(input_table->schema());
@@ -152,4 +175,73 @@ bool UnionExecutor::p_execute(const NValueArray &params, ReadWriteTracker *track
     return (true);
 }
 
+bool UnionExecutor::executeSetOperation(UnionType union_type, Table *output_table, const std::vector<Table*> &input_tables) {
+    const int cnt = (int)input_tables.size();
+    m_found.clear();
+
+    //
+    // UNION emits each tuple the first time it is seen in any input. For the
+    // others the first input is the candidate set, and the mark of an entry
+    // records what the later inputs did to it: for INTERSECT the last input
+    // in a row that contained it, for EXCEPT whether any input contained it.
+    //
+    for (int ctr = 0; ctr < cnt; ctr++) {
+        Table* input_table = input_tables[ctr];
+        assert(input_table);
+        TableIterator iterator(input_table);
+        TableTuple tuple(input_table->schema());
+        while (iterator.next(tuple)) {
+            if (union_type == UNION_TYPE_UNION || ctr == 0) {
+                bool inserted;
+                m_found.insert(tuple, &inserted);
+                if (inserted && union_type == UNION_TYPE_UNION &&
+                    !output_table->insertTuple(tuple)) {
+                    VOLT_ERROR("Failed to insert tuple from input table '%s' into"
+                               " output table '%s'",
+                               input_table->name().c_str(),
+                               output_table->name().c_str());
+                    return false;
+                }
+                continue;
+            }
+
+            int32_t entry = m_found.find(tuple);
+            if (entry < 0) {
+                continue;
+            }
+            if (union_type == UNION_TYPE_INTERSECT) {
+                if (m_found.getMark(entry) == ctr - 1) {
+                    m_found.setMark(entry, ctr);
+                }
+            } else {
+                m_found.setMark(entry, 1);
+            }
+        }
+    }
+
+    if (union_type != UNION_TYPE_UNION) {
+        // INTERSECT keeps the tuples that every input contained, EXCEPT
+        // the ones that no later input did
+        const int32_t keep = (union_type == UNION_TYPE_INTERSECT) ? cnt - 1 : 0;
+        TableTuple tuple(input_tables[0]->schema());
+        for (int32_t entry = 0; entry < m_found.size(); entry++) {
+            if (m_found.getMark(entry) != keep) {
+                continue;
+            }
+            tuple.move(m_found.entryTuple(entry));
+            if (!output_table->insertTuple(tuple)) {
+                VOLT_ERROR("Failed to insert tuple from input table '%s' into"
+                           " output table '%s'",
+                           input_tables[0]->name().c_str(),
+                           output_table->name().c_str());
+                return false;
+            }
+        }
+    }
+
+    // the keys are only needed while the inputs are read
+    m_found.clear();
+    return (true);
+}
+
 }
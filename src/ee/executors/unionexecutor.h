@@ -49,6 +49,7 @@
 #include "common/common.h"
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
+#include "executors/tuplehashset.h"
 
 namespace voltdb {
 
@@ -56,7 +57,8 @@ class UndoLog;
 class ReadWriteSet;
 
 /**
- *
+ * Appends its inputs (UNION ALL), or combines them as sets by hashing
+ * whole tuples (UNION, INTERSECT and EXCEPT).
  */
 class UnionExecutor : public AbstractExecutor {
     public:
@@ -64,6 +66,12 @@ class UnionExecutor : public AbstractExecutor {
     protected:
         bool p_init(AbstractPlanNode*, const catalog::Database* catalog_db, int* tempTableMemoryInBytes);
         bool p_execute(const NValueArray &params, ReadWriteTracker *tracker);
+
+        bool executeUnionAll(Table *output_table, const std::vector<Table*> &input_tables);
+        bool executeSetOperation(UnionType union_type, Table *output_table, const std::vector<Table*> &input_tables);
+
+        // the distinct tuples of the set operations
+        TupleHashSet m_found;
 };
 
 }
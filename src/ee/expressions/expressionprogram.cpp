@@ -0,0 +1,298 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "expressions/expressionprogram.h"
+#include "common/debuglog.h"
+#include "common/TupleSchema.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/parametervalueexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+namespace voltdb {
+
+ExpressionProgram::ExpressionProgram() :
+        m_compiled(false),
+        m_returnsBoolean(false) {
+    m_schemas[0] = NULL;
+    m_schemas[1] = NULL;
+    ::memset(m_flags, 0, sizeof(m_flags));
+}
+
+bool ExpressionProgram::compile(const AbstractExpression *expression,
+                                const TupleSchema *schema1, const TupleSchema *schema2) {
+    m_code.clear();
+    m_constants.clear();
+    m_schemas[0] = schema1;
+    m_schemas[1] = schema2;
+    m_compiled = false;
+    if (expression == NULL) {
+        return (false);
+    }
+
+    switch (expression->getExpressionType()) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+        case EXPRESSION_TYPE_CONJUNCTION_AND:
+        case EXPRESSION_TYPE_CONJUNCTION_OR:
+        case EXPRESSION_TYPE_OPERATOR_NOT:
+            m_returnsBoolean = true;
+            m_compiled = compileBoolean(expression, 0);
+            break;
+        default:
+            m_returnsBoolean = false;
+            m_compiled = compileValue(expression, 0, m_result);
+    } // SWITCH
+
+    if (!m_compiled) {
+        m_code.clear();
+        m_constants.clear();
+        return (false);
+    }
+    VOLT_DEBUG("Compiled expression into %d instructions [constants=%d]",
+               (int)m_code.size(), (int)m_constants.size());
+    return (true);
+}
+
+void ExpressionProgram::emit(Opcode opcode, int dst, const Operand &left, const Operand &right) {
+    Instruction instruction;
+    instruction.opcode = opcode;
+    instruction.dst = dst;
+    instruction.left = left;
+    instruction.right = right;
+    instruction.target = -1;
+    m_code.push_back(instruction);
+}
+
+bool ExpressionProgram::compileValue(const AbstractExpression *expression, int reg, Operand &out) {
+    if (expression == NULL || reg >= MAX_REGISTERS) {
+        return (false);
+    }
+    out.kind = OPERAND_REGISTER;
+    out.index = reg;
+    out.tuple = 0;
+    out.type = VALUE_TYPE_INVALID;
+    out.inlined = false;
+
+    Opcode opcode;
+    switch (expression->getExpressionType()) {
+        case EXPRESSION_TYPE_VALUE_TUPLE: {
+            const TupleValueExpression *tve = dynamic_cast<const TupleValueExpression*>(expression);
+            if (tve == NULL) return (false);
+            const int tuple = tve->getTupleIndex();
+            const int column = tve->getColumnId();
+            if (tuple < 0 || tuple > 1 || m_schemas[tuple] == NULL ||
+                column < 0 || column >= m_schemas[tuple]->columnCount()) {
+                return (false);
+            }
+            out.kind = OPERAND_COLUMN;
+            out.index = m_schemas[tuple]->columnOffset(column) + TUPLE_HEADER_SIZE;
+            out.tuple = tuple;
+            out.type = m_schemas[tuple]->columnType(column);
+            out.inlined = m_schemas[tuple]->columnIsInlined(column);
+            return (true);
+        }
+        case EXPRESSION_TYPE_VALUE_CONSTANT:
+            // Constants do not look at the tuples
+            out.kind = OPERAND_CONSTANT;
+            out.index = static_cast<uint32_t>(m_constants.size());
+            m_constants.push_back(expression->eval(NULL, NULL));
+            return (true);
+        case EXPRESSION_TYPE_VALUE_PARAMETER: {
+            const ParameterValueExpressionMarker *param =
+                dynamic_cast<const ParameterValueExpressionMarker*>(expression);
+            if (param == NULL) return (false);
+            out.kind = OPERAND_PARAMETER;
+            out.index = param->getParameterId();
+            return (true);
+        }
+        case EXPRESSION_TYPE_OPERATOR_PLUS:
+            opcode = OP_ADD;
+            break;
+        case EXPRESSION_TYPE_OPERATOR_MINUS:
+            opcode = OP_SUBTRACT;
+            break;
+        case EXPRESSION_TYPE_OPERATOR_MULTIPLY:
+            opcode = OP_MULTIPLY;
+            break;
+        case EXPRESSION_TYPE_OPERATOR_DIVIDE:
+            opcode = OP_DIVIDE;
+            break;
+        default:
+            return (false);
+    } // SWITCH
+
+    // The left side may use this register, the right side the ones above
+    Operand left, right;
+    if (!compileValue(expression->getLeft(), reg, left) ||
+        !compileValue(expression->getRight(), reg + 1, right)) {
+        return (false);
+    }
+    emit(opcode, reg, left, right);
+    return (true);
+}
+
+bool ExpressionProgram::compileBoolean(const AbstractExpression *expression, int reg) {
+    if (expression == NULL || reg >= MAX_REGISTERS) {
+        return (false);
+    }
+
+    Opcode opcode;
+    switch (expression->getExpressionType()) {
+        case EXPRESSION_TYPE_CONJUNCTION_AND:
+        case EXPRESSION_TYPE_CONJUNCTION_OR: {
+            // The right side only runs if the left side does not decide
+            if (!compileBoolean(expression->getLeft(), reg)) {
+                return (false);
+            }
+            const size_t jump = m_code.size();
+            Operand none;
+            none.kind = OPERAND_REGISTER;
+            none.index = 0;
+            emit(expression->getExpressionType() == EXPRESSION_TYPE_CONJUNCTION_AND ?
+                     OP_JUMP_IF_FALSE : OP_JUMP_IF_TRUE, reg, none, none);
+            if (!compileBoolean(expression->getRight(), reg)) {
+                return (false);
+            }
+            m_code[jump].target = static_cast<int>(m_code.size());
+            return (true);
+        }
+        case EXPRESSION_TYPE_OPERATOR_NOT: {
+            if (!compileBoolean(expression->getLeft(), reg)) {
+                return (false);
+            }
+            Operand none;
+            none.kind = OPERAND_REGISTER;
+            none.index = 0;
+            emit(OP_NOT, reg, none, none);
+            return (true);
+        }
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            opcode = OP_COMPARE_EQUAL;
+            break;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            opcode = OP_COMPARE_NOTEQUAL;
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            opcode = OP_COMPARE_LESSTHAN;
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            opcode = OP_COMPARE_GREATERTHAN;
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            opcode = OP_COMPARE_LESSTHANOREQUALTO;
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            opcode = OP_COMPARE_GREATERTHANOREQUALTO;
+            break;
+        default:
+            return (false);
+    } // SWITCH
+
+    Operand left, right;
+    if (!compileValue(expression->getLeft(), reg, left) ||
+        !compileValue(expression->getRight(), reg + 1, right)) {
+        return (false);
+    }
+    emit(opcode, reg, left, right);
+    return (true);
+}
+
+void ExpressionProgram::run(const TableTuple *tuple1, const TableTuple *tuple2,
+                            const NValueArray &params) {
+    const int size = static_cast<int>(m_code.size());
+    int pc = 0;
+    while (pc < size) {
+        const Instruction &instruction = m_code[pc++];
+        switch (instruction.opcode) {
+            case OP_JUMP_IF_FALSE:
+                if (!m_flags[instruction.dst]) pc = instruction.target;
+                break;
+            case OP_JUMP_IF_TRUE:
+                if (m_flags[instruction.dst]) pc = instruction.target;
+                break;
+            case OP_NOT:
+                m_flags[instruction.dst] = !m_flags[instruction.dst];
+                break;
+            case OP_ADD:
+                m_values[instruction.dst] =
+                    fetch(instruction.left, tuple1, tuple2, params).op_add(
+                        fetch(instruction.right, tuple1, tuple2, params));
+                break;
+            case OP_SUBTRACT:
+                m_values[instruction.dst] =
+                    fetch(instruction.left, tuple1, tuple2, params).op_subtract(
+                        fetch(instruction.right, tuple1, tuple2, params));
+                break;
+            case OP_MULTIPLY:
+                m_values[instruction.dst] =
+                    fetch(instruction.left, tuple1, tuple2, params).op_multiply(
+                        fetch(instruction.right, tuple1, tuple2, params));
+                break;
+            case OP_DIVIDE:
+                m_values[instruction.dst] =
+                    fetch(instruction.left, tuple1, tuple2, params).op_divide(
+                        fetch(instruction.right, tuple1, tuple2, params));
+                break;
+            default: {
+                // The comparisons are the same as the NValue::op_*() ones
+                const int cmp = fetch(instruction.left, tuple1, tuple2, params).compare(
+                                    fetch(instruction.right, tuple1, tuple2, params));
+                bool result;
+                switch (instruction.opcode) {
+                    case OP_COMPARE_EQUAL:
+                        result = (cmp == 0); break;
+                    case OP_COMPARE_NOTEQUAL:
+                        result = (cmp != 0); break;
+                    case OP_COMPARE_LESSTHAN:
+                        result = (cmp < 0); break;
+                    case OP_COMPARE_GREATERTHAN:
+                        result = (cmp > 0); break;
+                    case OP_COMPARE_LESSTHANOREQUALTO:
+                        result = (cmp <= 0); break;
+                    default:
+                        result = (cmp >= 0);
+                } // SWITCH
+                m_flags[instruction.dst] = result;
+            }
+        } // SWITCH
+    } // WHILE
+}
+
+NValue ExpressionProgram::eval(const TableTuple *tuple1, const TableTuple *tuple2,
+                               const NValueArray &params) {
+    assert(m_compiled);
+    run(tuple1, tuple2, params);
+    if (m_returnsBoolean) {
+        return (m_flags[0] ? NValue::getTrue() : NValue::getFalse());
+    }
+    return (fetch(m_result, tuple1, tuple2, params));
+}
+
+}
@@ -0,0 +1,186 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREEXPRESSIONPROGRAM_H
+#define HSTOREEXPRESSIONPROGRAM_H
+
+#include <vector>
+#include "common/common.h"
+#include "common/NValue.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+
+namespace voltdb {
+
+class AbstractExpression;
+class TupleSchema;
+
+/**
+ * An expression tree compiled into a flat array of register-based
+ * instructions. It computes the same result as AbstractExpression::eval()
+ * without a virtual call per node:
+ *
+ *  - Column, constant and parameter operands are encoded in the
+ *    instructions that use them. Columns are read straight out of the
+ *    tuple storage at an offset that is resolved when compiling.
+ *  - Parameters are read from the NValueArray that is passed to eval(),
+ *    so the expression tree does not have to be substitute()'d and is
+ *    never modified.
+ *  - Comparisons and conjunctions work on a file of boolean registers,
+ *    and AND/OR jump over their right side when the left side decides.
+ *    Arithmetic works on a file of NValue registers. Both are allocated
+ *    like a stack, so a program uses at most MAX_REGISTERS of each.
+ *
+ * Supported expressions are comparisons (except LIKE), AND, OR, NOT,
+ * + - * / and tuple value, constant and parameter values. A program holds
+ * on to the values of the constants, so it must not outlive its tree.
+ * A program keeps its registers in itself, so one program must not be
+ * evaluated by two threads at the same time.
+ */
+class ExpressionProgram {
+public:
+    static const int MAX_REGISTERS = 8;
+
+    ExpressionProgram();
+
+    /**
+     * Compile the given expression tree for tuples with the given
+     * schemas. A tuple value expression with tuple index 1 reads from
+     * the second tuple (e.g. the inner one of a join). Returns false if
+     * the tree cannot be compiled.
+     */
+    bool compile(const AbstractExpression *expression,
+                 const TupleSchema *schema1, const TupleSchema *schema2 = NULL);
+
+    inline bool isCompiled() const {
+        return (m_compiled);
+    }
+
+    /** Returns the value of the expression */
+    NValue eval(const TableTuple *tuple1, const TableTuple *tuple2, const NValueArray &params);
+
+    /** Returns true if the expression is true */
+    inline bool evalPredicate(const TableTuple *tuple1, const TableTuple *tuple2,
+                              const NValueArray &params) {
+        assert(m_compiled);
+        run(tuple1, tuple2, params);
+        if (m_returnsBoolean) {
+            return (m_flags[0]);
+        }
+        return (fetch(m_result, tuple1, tuple2, params).isTrue());
+    }
+
+    /** Number of instructions, for testing */
+    inline int size() const {
+        return (static_cast<int>(m_code.size()));
+    }
+
+private:
+    enum Opcode {
+        // flags[dst] = left <op> right
+        OP_COMPARE_EQUAL,
+        OP_COMPARE_NOTEQUAL,
+        OP_COMPARE_LESSTHAN,
+        OP_COMPARE_GREATERTHAN,
+        OP_COMPARE_LESSTHANOREQUALTO,
+        OP_COMPARE_GREATERTHANOREQUALTO,
+        // continue at target if flags[dst] is false/true
+        OP_JUMP_IF_FALSE,
+        OP_JUMP_IF_TRUE,
+        // flags[dst] = !flags[dst]
+        OP_NOT,
+        // values[dst] = left <op> right
+        OP_ADD,
+        OP_SUBTRACT,
+        OP_MULTIPLY,
+        OP_DIVIDE
+    };
+
+    enum OperandKind {
+        OPERAND_REGISTER,
+        OPERAND_COLUMN,
+        OPERAND_CONSTANT,
+        OPERAND_PARAMETER
+    };
+
+    struct Operand {
+        OperandKind kind;
+        // register number, constant or parameter index, or column offset
+        uint32_t index;
+        // for columns
+        int tuple;
+        ValueType type;
+        bool inlined;
+    };
+
+    struct Instruction {
+        Opcode opcode;
+        int dst;
+        Operand left;
+        Operand right;
+        int target;
+    };
+
+    bool compileValue(const AbstractExpression *expression, int reg, Operand &out);
+    bool compileBoolean(const AbstractExpression *expression, int reg);
+    void emit(Opcode opcode, int dst, const Operand &left, const Operand &right);
+
+    void run(const TableTuple *tuple1, const TableTuple *tuple2, const NValueArray &params);
+
+    inline NValue fetch(const Operand &operand, const TableTuple *tuple1,
+                        const TableTuple *tuple2, const NValueArray &params) const {
+        switch (operand.kind) {
+            case OPERAND_COLUMN: {
+                const TableTuple *tuple = (operand.tuple == 0 ? tuple1 : tuple2);
+                assert(tuple != NULL);
+                return NValue::deserializeFromTupleStorage(tuple->address() + operand.index,
+                                                           operand.type, operand.inlined);
+            }
+            case OPERAND_CONSTANT:
+                return (m_constants[operand.index]);
+            case OPERAND_PARAMETER:
+                assert(operand.index < params.size());
+                return (params[operand.index]);
+            default:
+                return (m_values[operand.index]);
+        }
+    }
+
+    std::vector<Instruction> m_code;
+    std::vector<NValue> m_constants;
+    const TupleSchema *m_schemas[2];
+    bool m_compiled;
+    bool m_returnsBoolean;
+    // where a value result is when there are no instructions to compute it
+    Operand m_result;
+
+    // the register files
+    NValue m_values[MAX_REGISTERS];
+    bool m_flags[MAX_REGISTERS];
+};
+
+}
+
+#endif
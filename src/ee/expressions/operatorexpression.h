@@ -63,9 +63,10 @@ namespace voltdb {
 
 class OperatorNotExpression : public AbstractExpression {
 public:
+    // The child is kept by AbstractExpression, so that substitute() and
+    // getLeft() see it
     OperatorNotExpression(AbstractExpression *left)
-        : AbstractExpression(EXPRESSION_TYPE_OPERATOR_NOT) {
-        m_left = left;
+        : AbstractExpression(EXPRESSION_TYPE_OPERATOR_NOT, left, NULL) {
     };
 
     NValue eval(const TableTuple *tuple1, const TableTuple *tuple2) const {
@@ -76,9 +77,6 @@ public:
     std::string debugInfo(const std::string &spacer) const {
         return (spacer + "OptimizedOperatorNotExpression");
     }
-
-private:
-    AbstractExpression *m_left;
 };
 
 
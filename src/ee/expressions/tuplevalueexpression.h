@@ -99,6 +99,10 @@ class TupleValueExpression : public AbstractExpression, public TupleValueExpress
         tuple_idx = idx;
     }
 
+    int getTupleIndex() const {
+        return tuple_idx;
+    }
+
   protected:
 
     int tuple_idx;           // which tuple. defaults to tuple1
@@ -0,0 +1,335 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_ARTINDEX_H
+#define HSTORE_ARTINDEX_H
+
+#include <iostream>
+#include <vector>
+#include "common/debuglog.h"
+#include "common/tabletuple.h"
+#include "indexes/tableindex.h"
+#include "indexes/indexkey.h"
+#include "indexes/ArtTree.h"
+
+namespace voltdb {
+
+/**
+ * Ordered index on any mix of column types backed by an adaptive radix
+ * tree over the normalized (memcmp-comparable) key encoding. Shared key
+ * prefixes such as common string prefixes are only stored once in the
+ * inner nodes. In a non-unique index every key is extended with the tuple
+ * address, like IntsBTreeIndex does.
+ * @see TableIndex
+ */
+template<bool unique>
+class ArtIndex : public TableIndex
+{
+    friend class TableIndexFactory;
+
+    typedef ArtTree::Iterator Iterator;
+
+public:
+
+    ~ArtIndex() {
+        delete m_entries;
+    };
+
+    bool addEntry(const TableTuple *tuple)
+    {
+        ++m_inserts;
+        setFromTuple(m_key, tuple);
+        setAddress(m_key, tuple->address());
+        return m_entries->insert(&m_key[0], length(m_key), tuple->address());
+    }
+
+    bool deleteEntry(const TableTuple *tuple)
+    {
+        ++m_deletes;
+        setFromTuple(m_key, tuple);
+        setAddress(m_key, tuple->address());
+        return m_entries->erase(&m_key[0], length(m_key));
+    }
+
+    bool replaceEntry(const TableTuple *oldTupleValue,
+                      const TableTuple *newTupleValue)
+    {
+        setFromTuple(m_key, oldTupleValue);
+        setFromTuple(m_otherKey, newTupleValue);
+        if (m_key == m_otherKey)
+        {
+            // no update is needed for this index
+            return true;
+        }
+
+        // Like BinaryTreeMultiMapIndex, the old entry of a non-unique
+        // index is found through the address of the new tuple
+        setAddress(m_key, newTupleValue->address());
+        setAddress(m_otherKey, newTupleValue->address());
+        bool deleted = m_entries->erase(&m_key[0], length(m_key));
+        bool inserted = m_entries->insert(&m_otherKey[0], length(m_otherKey), newTupleValue->address());
+        ++m_updates;
+        return (deleted && inserted);
+    }
+
+    bool setEntryToNewAddress(const TableTuple *tuple, const void* address, const void *oldAddress) {
+        ++m_updates;
+        setFromTuple(m_key, tuple);
+        if (unique) {
+            return m_entries->update(&m_key[0], length(m_key), address);
+        }
+        setAddress(m_key, oldAddress);
+        if (m_entries->erase(&m_key[0], length(m_key)) == false) {
+            VOLT_INFO("Tuple not found.");
+            return false;
+        }
+        m_key.resize(m_key.size() - sizeof(uint64_t));
+        setAddress(m_key, address);
+        return m_entries->insert(&m_key[0], length(m_key), address);
+    }
+
+    bool checkForIndexChange(const TableTuple *lhs, const TableTuple *rhs)
+    {
+        setFromTuple(m_key, lhs);
+        setFromTuple(m_otherKey, rhs);
+        return (m_key != m_otherKey);
+    }
+
+    bool exists(const TableTuple* values)
+    {
+        ++m_lookups;
+        setFromTuple(m_key, values);
+        if (unique) {
+            return (m_entries->find(&m_key[0], length(m_key)) != NULL);
+        }
+        Iterator iter = m_entries->lowerBound(&m_key[0], length(m_key));
+        return (iter.atEnd() == false && matchesKey(iter, m_key));
+    }
+
+    bool moveToKey(const TableTuple *searchKey)
+    {
+        setFromKey(m_currentKey, searchKey);
+        return moveToCurrentKey();
+    }
+
+    bool moveToTuple(const TableTuple *searchTuple)
+    {
+        setFromTuple(m_currentKey, searchTuple);
+        return moveToCurrentKey();
+    }
+
+    void moveToKeyOrGreater(const TableTuple *searchKey)
+    {
+        ++m_lookups;
+        m_begin = true;
+        setFromKey(m_key, searchKey);
+        m_seqIter = m_entries->lowerBound(&m_key[0], length(m_key));
+    }
+
+    void moveToGreaterThanKey(const TableTuple *searchKey)
+    {
+        ++m_lookups;
+        m_begin = true;
+        setFromKey(m_key, searchKey);
+        setAddress(m_key, reinterpret_cast<const void*>(UINTPTR_MAX));
+        m_seqIter = m_entries->upperBound(&m_key[0], length(m_key));
+    }
+
+    void moveToEnd(bool begin)
+    {
+        ++m_lookups;
+        m_begin = begin;
+        m_seqIter = (begin ? m_entries->begin() : m_entries->rbegin());
+        m_keyIter = m_seqIter;
+    }
+
+    TableTuple nextValue()
+    {
+        TableTuple retval(m_tupleSchema);
+        if (m_seqIter.atEnd())
+            return TableTuple();
+        retval.move(const_cast<void*>(m_seqIter.value()));
+        if (m_begin)
+            m_seqIter.next();
+        else
+            m_seqIter.prev();
+        return retval;
+    }
+
+    TableTuple nextValueAtKey()
+    {
+        if (m_match.isNullTuple()) return m_match;
+        TableTuple retval = m_match;
+        if (unique) {
+            m_match.move(NULL);
+        } else {
+            m_keyIter.next();
+            if (m_keyIter.atEnd() || matchesKey(m_keyIter, m_currentKey) == false)
+                m_match.move(NULL);
+            else
+                m_match.move(const_cast<void*>(m_keyIter.value()));
+        }
+        return retval;
+    }
+
+    bool advanceToNextKey()
+    {
+        if (unique) {
+            if (m_keyIter.atEnd() == false) {
+                if (m_begin)
+                    m_keyIter.next();
+                else
+                    m_keyIter.prev();
+            }
+        } else {
+            // Skip over the rest of the entries for the current key
+            setAddress(m_currentKey, reinterpret_cast<const void*>(UINTPTR_MAX));
+            m_keyIter = m_entries->upperBound(&m_currentKey[0], length(m_currentKey));
+        }
+        if (m_keyIter.atEnd()) {
+            m_match.move(NULL);
+            return false;
+        }
+        m_currentKey.assign(m_keyIter.key(), m_keyIter.key() + m_keyIter.keyLength());
+        if (!unique) {
+            m_currentKey.resize(m_currentKey.size() - sizeof(uint64_t));
+        }
+        m_match.move(const_cast<void*>(m_keyIter.value()));
+        return !m_match.isNullTuple();
+    }
+
+    size_t getSize() const { return m_entries->size(); }
+
+    int64_t getMemoryEstimate() const {
+        return m_memoryEstimate;
+    }
+
+    std::string getTypeName() const { return (unique ? "ArtUniqueIndex" : "ArtMultiMapIndex"); };
+
+    std::string debug() const
+    {
+        std::ostringstream buffer;
+        buffer << TableIndex::debug() << std::endl;
+
+        for (Iterator i = m_entries->begin(); i.atEnd() == false; i.next()) {
+            TableTuple retval(m_tupleSchema);
+            retval.move(const_cast<void*>(i.value()));
+            buffer << retval.debugNoHeader() << std::endl;
+        }
+        std::string ret(buffer.str());
+        return (ret);
+    }
+
+protected:
+    typedef std::vector<unsigned char> KeyBuffer;
+
+    ArtIndex(const TableIndexScheme &scheme) :
+        TableIndex(scheme),
+        m_begin(true)
+    {
+        m_match = TableTuple(m_tupleSchema);
+        m_entries = new ArtTree(&m_memoryEstimate);
+    }
+
+    /** Normalized key of the index columns of a table tuple */
+    inline void setFromTuple(KeyBuffer &key, const TableTuple *tuple)
+    {
+        int32_t size = 0;
+        for (int ii = 0; ii < colCount_; ii++) {
+            size += NormalizedKeyEncoder::length(tuple->getNValue(column_indices_[ii]));
+        }
+        key.resize(size);
+        char *out = reinterpret_cast<char*>(&key[0]);
+        for (int ii = 0; ii < colCount_; ii++) {
+            out = NormalizedKeyEncoder::encode(out, tuple->getNValue(column_indices_[ii]));
+        }
+    }
+
+    /** Normalized key of a tuple in the key schema */
+    inline void setFromKey(KeyBuffer &key, const TableTuple *searchKey)
+    {
+        const int columnCount = searchKey->getSchema()->columnCount();
+        int32_t size = 0;
+        for (int ii = 0; ii < columnCount; ii++) {
+            size += NormalizedKeyEncoder::length(searchKey->getNValue(ii));
+        }
+        key.resize(size);
+        char *out = reinterpret_cast<char*>(&key[0]);
+        for (int ii = 0; ii < columnCount; ii++) {
+            out = NormalizedKeyEncoder::encode(out, searchKey->getNValue(ii));
+        }
+    }
+
+    /** A non-unique index appends the tuple address (big-endian) to the key */
+    inline void setAddress(KeyBuffer &key, const void *address)
+    {
+        if (unique) return;
+        const uint64_t value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address));
+        for (int ii = 7; ii >= 0; ii--) {
+            key.push_back(static_cast<unsigned char>(value >> (ii * 8)));
+        }
+    }
+
+    static inline uint32_t length(const KeyBuffer &key)
+    {
+        return static_cast<uint32_t>(key.size());
+    }
+
+    /** Whether the entry at the iterator has the given (address-less) key */
+    static inline bool matchesKey(const Iterator &iter, const KeyBuffer &key)
+    {
+        const size_t expected = key.size() + (unique ? 0 : sizeof(uint64_t));
+        return (iter.keyLength() == expected &&
+                ::memcmp(iter.key(), &key[0], key.size()) == 0);
+    }
+
+    bool moveToCurrentKey()
+    {
+        ++m_lookups;
+        m_begin = true;
+        m_keyIter = m_entries->lowerBound(&m_currentKey[0], length(m_currentKey));
+        if (m_keyIter.atEnd() || matchesKey(m_keyIter, m_currentKey) == false) {
+            m_match.move(NULL);
+            return false;
+        }
+        m_match.move(const_cast<void*>(m_keyIter.value()));
+        return !m_match.isNullTuple();
+    }
+
+    ArtTree *m_entries;
+    KeyBuffer m_key;
+    KeyBuffer m_otherKey;
+
+    // iteration stuff
+    bool m_begin;
+    KeyBuffer m_currentKey;
+    Iterator m_keyIter;
+    Iterator m_seqIter;
+    TableTuple m_match;
+};
+
+}
+
+#endif // HSTORE_ARTINDEX_H
@@ -0,0 +1,887 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_ARTTREE_H
+#define HSTORE_ARTTREE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace voltdb {
+
+// Number of prefix bytes stored in an inner node. Longer prefixes are
+// checked against a leaf of the node's subtree.
+#define ART_MAX_PREFIX 10
+
+/**
+ * Adaptive radix tree (Leis et al., "The Adaptive Radix Tree: ARTful
+ * Indexing for Main-Memory Databases", ICDE 2013) from binary keys to
+ * tuple addresses.
+ *
+ * Inner nodes have 4, 16, 48 or 256 children and grow or shrink as
+ * children come and go. A chain of nodes with a single child is collapsed
+ * into the prefix of the node below it, so a string key only costs a node
+ * where keys actually branch. Leaves hold a copy of the whole key and the
+ * value, and are told apart from inner nodes by the low bit of the
+ * pointer.
+ *
+ * No key may be a prefix of another key in the tree. This holds for the
+ * normalized encoding of full index keys (see NormalizedKeyEncoder). A
+ * search key can be shorter than the keys in the tree.
+ */
+class ArtTree {
+private:
+    enum NodeType { NODE4 = 0, NODE16, NODE48, NODE256 };
+
+    struct Node {
+        uint8_t type;
+        uint16_t count;
+        uint32_t prefixLength;
+        unsigned char prefix[ART_MAX_PREFIX];
+    };
+
+    struct Node4 : Node {
+        unsigned char keys[4];
+        void *children[4];
+    };
+
+    struct Node16 : Node {
+        unsigned char keys[16];
+        void *children[16];
+    };
+
+    struct Node48 : Node {
+        // slot + 1 of the child for each byte, 0 if there is none
+        unsigned char index[256];
+        void *children[48];
+    };
+
+    struct Node256 : Node {
+        void *children[256];
+    };
+
+    struct Leaf {
+        const void *value;
+        uint32_t length;
+        unsigned char key[1];
+    };
+
+    struct Frame {
+        const Node *node;
+        int pos;
+    };
+
+public:
+    /**
+     * Position in the tree. The stack holds every inner node above the
+     * current leaf together with the position of the child that was taken,
+     * so that next() and prev() can continue from there.
+     */
+    class Iterator {
+        friend class ArtTree;
+    public:
+        Iterator() : m_leaf(NULL) {}
+
+        inline bool atEnd() const { return (m_leaf == NULL); }
+        inline const void* value() const { return (m_leaf->value); }
+        inline const unsigned char* key() const { return (m_leaf->key); }
+        inline uint32_t keyLength() const { return (m_leaf->length); }
+
+        void next() {
+            while (m_stack.empty() == false) {
+                Frame &top = m_stack.back();
+                const int pos = nextPos(top.node, top.pos);
+                if (pos >= 0) {
+                    top.pos = pos;
+                    descend(childAt(top.node, pos), true);
+                    return;
+                }
+                m_stack.pop_back();
+            } // WHILE
+            m_leaf = NULL;
+        }
+
+        void prev() {
+            while (m_stack.empty() == false) {
+                Frame &top = m_stack.back();
+                const int pos = prevPos(top.node, top.pos);
+                if (pos >= 0) {
+                    top.pos = pos;
+                    descend(childAt(top.node, pos), false);
+                    return;
+                }
+                m_stack.pop_back();
+            } // WHILE
+            m_leaf = NULL;
+        }
+
+    private:
+        /** Go down to the first (or last) leaf below the given child */
+        void descend(const void *child, bool first) {
+            while (isLeaf(child) == false) {
+                const Node *node = static_cast<const Node*>(child);
+                Frame frame;
+                frame.node = node;
+                frame.pos = (first ? nextPos(node, -1) : prevPos(node, 256));
+                m_stack.push_back(frame);
+                child = childAt(node, frame.pos);
+            } // WHILE
+            m_leaf = toLeaf(child);
+        }
+
+        std::vector<Frame> m_stack;
+        const Leaf *m_leaf;
+    };
+
+    ArtTree(int64_t *memorySize) : m_memorySize(memorySize), m_root(NULL), m_size(0) {}
+
+    ~ArtTree() {
+        destroy(m_root);
+    }
+
+    inline size_t size() const {
+        return (m_size);
+    }
+
+    /**
+     * Return the value stored for the key, or NULL if there is none
+     */
+    const void* find(const unsigned char *key, uint32_t length) const {
+        const void *child = m_root;
+        uint32_t depth = 0;
+        while (child != NULL) {
+            if (isLeaf(child)) {
+                const Leaf *leaf = toLeaf(child);
+                return (leafMatches(leaf, key, length) ? leaf->value : NULL);
+            }
+            const Node *node = static_cast<const Node*>(child);
+            if (node->prefixLength > 0) {
+                if (storedPrefixMatches(node, key, length, depth) == false) return (NULL);
+                depth += node->prefixLength;
+            }
+            if (depth >= length) return (NULL);
+            void * const *ref = findChild(node, key[depth]);
+            child = (ref != NULL ? *ref : NULL);
+            depth++;
+        } // WHILE
+        return (NULL);
+    }
+
+    /**
+     * Add the key. Returns false if it is already in the tree.
+     */
+    bool insert(const unsigned char *key, uint32_t length, const void *value) {
+        if (insertRecursive(&m_root, key, length, value, 0) == false) return (false);
+        m_size++;
+        return (true);
+    }
+
+    /**
+     * Change the value stored for the key. Returns false if there is none.
+     */
+    bool update(const unsigned char *key, uint32_t length, const void *value) {
+        Iterator iter = lowerBound(key, length);
+        if (iter.atEnd() || leafMatches(iter.m_leaf, key, length) == false) return (false);
+        const_cast<Leaf*>(iter.m_leaf)->value = value;
+        return (true);
+    }
+
+    /**
+     * Remove the key. Returns false if it is not in the tree.
+     */
+    bool erase(const unsigned char *key, uint32_t length) {
+        if (eraseRecursive(&m_root, key, length, 0) == false) return (false);
+        m_size--;
+        return (true);
+    }
+
+    Iterator begin() const {
+        Iterator iter;
+        if (m_root != NULL) iter.descend(m_root, true);
+        return (iter);
+    }
+
+    Iterator rbegin() const {
+        Iterator iter;
+        if (m_root != NULL) iter.descend(m_root, false);
+        return (iter);
+    }
+
+    /** First key that is not less than the given key */
+    inline Iterator lowerBound(const unsigned char *key, uint32_t length) const {
+        return (search(key, length, false));
+    }
+
+    /** First key that is greater than the given key */
+    inline Iterator upperBound(const unsigned char *key, uint32_t length) const {
+        return (search(key, length, true));
+    }
+
+private:
+    // ----------------------------------------------------------------
+    // Pointers and node layout
+    // ----------------------------------------------------------------
+
+    static inline bool isLeaf(const void *child) {
+        return ((reinterpret_cast<uintptr_t>(child) & 1) != 0);
+    }
+
+    static inline const Leaf* toLeaf(const void *child) {
+        return (reinterpret_cast<const Leaf*>(reinterpret_cast<uintptr_t>(child) & ~static_cast<uintptr_t>(1)));
+    }
+
+    static inline void* fromLeaf(const Leaf *leaf) {
+        return (reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(leaf) | 1));
+    }
+
+    static inline size_t nodeSize(uint8_t type) {
+        switch (type) {
+            case NODE4: return (sizeof(Node4));
+            case NODE16: return (sizeof(Node16));
+            case NODE48: return (sizeof(Node48));
+            default: return (sizeof(Node256));
+        }
+    }
+
+    static inline size_t leafSize(uint32_t length) {
+        return (offsetof(Leaf, key) + length);
+    }
+
+    Node* allocateNode(uint8_t type) {
+        const size_t size = nodeSize(type);
+        Node *node = static_cast<Node*>(::operator new(size));
+        ::memset(node, 0, size);
+        node->type = type;
+        *m_memorySize += static_cast<int64_t>(size);
+        return (node);
+    }
+
+    void freeNode(Node *node) {
+        *m_memorySize -= static_cast<int64_t>(nodeSize(node->type));
+        ::operator delete(node);
+    }
+
+    void* makeLeaf(const unsigned char *key, uint32_t length, const void *value) {
+        const size_t size = leafSize(length);
+        Leaf *leaf = static_cast<Leaf*>(::operator new(size));
+        leaf->value = value;
+        leaf->length = length;
+        ::memcpy(leaf->key, key, length);
+        *m_memorySize += static_cast<int64_t>(size);
+        return (fromLeaf(leaf));
+    }
+
+    void freeLeaf(const void *child) {
+        const Leaf *leaf = toLeaf(child);
+        *m_memorySize -= static_cast<int64_t>(leafSize(leaf->length));
+        ::operator delete(const_cast<Leaf*>(leaf));
+    }
+
+    void destroy(void *child) {
+        if (child == NULL) return;
+        if (isLeaf(child)) {
+            freeLeaf(child);
+            return;
+        }
+        Node *node = static_cast<Node*>(child);
+        for (int pos = nextPos(node, -1); pos >= 0; pos = nextPos(node, pos)) {
+            destroy(childAt(node, pos));
+        } // FOR
+        freeNode(node);
+    }
+
+    // ----------------------------------------------------------------
+    // Children in key order. A position is the slot in a Node4/Node16 and
+    // the key byte in a Node48/Node256.
+    // ----------------------------------------------------------------
+
+    static inline int nextPos(const Node *node, int pos) {
+        switch (node->type) {
+            case NODE4:
+            case NODE16:
+                return (pos + 1 < node->count ? pos + 1 : -1);
+            case NODE48: {
+                const Node48 *n = static_cast<const Node48*>(node);
+                for (int b = pos + 1; b < 256; b++) {
+                    if (n->index[b] != 0) return (b);
+                }
+                return (-1);
+            }
+            default: {
+                const Node256 *n = static_cast<const Node256*>(node);
+                for (int b = pos + 1; b < 256; b++) {
+                    if (n->children[b] != NULL) return (b);
+                }
+                return (-1);
+            }
+        }
+    }
+
+    static inline int prevPos(const Node *node, int pos) {
+        switch (node->type) {
+            case NODE4:
+            case NODE16:
+                if (pos > node->count) pos = node->count;
+                return (pos - 1);
+            case NODE48: {
+                const Node48 *n = static_cast<const Node48*>(node);
+                for (int b = pos - 1; b >= 0; b--) {
+                    if (n->index[b] != 0) return (b);
+                }
+                return (-1);
+            }
+            default: {
+                const Node256 *n = static_cast<const Node256*>(node);
+                for (int b = pos - 1; b >= 0; b--) {
+                    if (n->children[b] != NULL) return (b);
+                }
+                return (-1);
+            }
+        }
+    }
+
+    static inline void* childAt(const Node *node, int pos) {
+        switch (node->type) {
+            case NODE4: return (static_cast<const Node4*>(node)->children[pos]);
+            case NODE16: return (static_cast<const Node16*>(node)->children[pos]);
+            case NODE48: {
+                const Node48 *n = static_cast<const Node48*>(node);
+                return (n->children[n->index[pos] - 1]);
+            }
+            default: return (static_cast<const Node256*>(node)->children[pos]);
+        }
+    }
+
+    static inline unsigned char byteAt(const Node *node, int pos) {
+        switch (node->type) {
+            case NODE4: return (static_cast<const Node4*>(node)->keys[pos]);
+            case NODE16: return (static_cast<const Node16*>(node)->keys[pos]);
+            default: return (static_cast<unsigned char>(pos));
+        }
+    }
+
+    /**
+     * Position of the first child whose byte is not less than the given
+     * byte, or -1 if there is none
+     */
+    static inline int lowerPos(const Node *node, unsigned char byte) {
+        switch (node->type) {
+            case NODE4: {
+                const Node4 *n = static_cast<const Node4*>(node);
+                for (int i = 0; i < n->count; i++) {
+                    if (n->keys[i] >= byte) return (i);
+                }
+                return (-1);
+            }
+            case NODE16: {
+                const Node16 *n = static_cast<const Node16*>(node);
+#ifdef __SSE2__
+                // unsigned compare through a signed one with the top bit flipped
+                const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+                const __m128i keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)), flip);
+                const __m128i search = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(byte)), flip);
+                const uint32_t less = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmplt_epi8(keys, search))) &
+                                      ((1u << n->count) - 1);
+                const int pos = __builtin_popcount(less);
+                return (pos < n->count ? pos : -1);
+#else
+                for (int i = 0; i < n->count; i++) {
+                    if (n->keys[i] >= byte) return (i);
+                }
+                return (-1);
+#endif
+            }
+            default:
+                return (nextPos(node, static_cast<int>(byte) - 1));
+        }
+    }
+
+    static void* const* findChild(const Node *node, unsigned char byte) {
+        switch (node->type) {
+            case NODE4: {
+                const Node4 *n = static_cast<const Node4*>(node);
+                for (int i = 0; i < n->count; i++) {
+                    if (n->keys[i] == byte) return (&n->children[i]);
+                }
+                return (NULL);
+            }
+            case NODE16: {
+                const Node16 *n = static_cast<const Node16*>(node);
+#ifdef __SSE2__
+                const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys));
+                const uint32_t match = static_cast<uint32_t>(_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(byte))))) & ((1u << n->count) - 1);
+                return (match != 0 ? &n->children[__builtin_ctz(match)] : NULL);
+#else
+                for (int i = 0; i < n->count; i++) {
+                    if (n->keys[i] == byte) return (&n->children[i]);
+                }
+                return (NULL);
+#endif
+            }
+            case NODE48: {
+                const Node48 *n = static_cast<const Node48*>(node);
+                return (n->index[byte] != 0 ? &n->children[n->index[byte] - 1] : NULL);
+            }
+            default: {
+                const Node256 *n = static_cast<const Node256*>(node);
+                return (n->children[byte] != NULL ? &n->children[byte] : NULL);
+            }
+        }
+    }
+
+    static inline void** findChild(Node *node, unsigned char byte) {
+        return (const_cast<void**>(findChild(static_cast<const Node*>(node), byte)));
+    }
+
+    // ----------------------------------------------------------------
+    // Keys and prefixes
+    // ----------------------------------------------------------------
+
+    static inline bool leafMatches(const Leaf *leaf, const unsigned char *key, uint32_t length) {
+        return (leaf->length == length && ::memcmp(leaf->key, key, length) == 0);
+    }
+
+    static inline int compareLeaf(const Leaf *leaf, const unsigned char *key, uint32_t length) {
+        const uint32_t common = (leaf->length < length ? leaf->length : length);
+        const int diff = ::memcmp(leaf->key, key, common);
+        if (diff != 0) return (diff);
+        return (leaf->length < length ? -1 : (leaf->length > length ? 1 : 0));
+    }
+
+    /** Any leaf below the node, which has the node's full prefix */
+    static inline const Leaf* anyLeaf(const Node *node) {
+        const void *child = node;
+        while (isLeaf(child) == false) {
+            const Node *n = static_cast<const Node*>(child);
+            child = childAt(n, nextPos(n, -1));
+        } // WHILE
+        return (toLeaf(child));
+    }
+
+    /** Compare only the prefix bytes stored in the node */
+    static inline bool storedPrefixMatches(const Node *node, const unsigned char *key, uint32_t length,
+                                           uint32_t depth) {
+        const uint32_t stored = (node->prefixLength < ART_MAX_PREFIX ? node->prefixLength : ART_MAX_PREFIX);
+        if (depth + stored > length) return (false);
+        return (::memcmp(node->prefix, key + depth, stored) == 0);
+    }
+
+    /**
+     * Number of leading bytes of the node's prefix that match the key at
+     * depth
+     */
+    static uint32_t prefixMismatch(const Node *node, const unsigned char *key, uint32_t length, uint32_t depth) {
+        const uint32_t limit = (node->prefixLength < length - depth ? node->prefixLength : length - depth);
+        const uint32_t stored = (limit < ART_MAX_PREFIX ? limit : ART_MAX_PREFIX);
+        uint32_t i = 0;
+        for (; i < stored; i++) {
+            if (node->prefix[i] != key[depth + i]) return (i);
+        } // FOR
+        if (limit > ART_MAX_PREFIX) {
+            const Leaf *leaf = anyLeaf(node);
+            for (; i < limit; i++) {
+                if (leaf->key[depth + i] != key[depth + i]) return (i);
+            } // FOR
+        }
+        return (i);
+    }
+
+    /**
+     * Compare the node's full prefix with the key bytes at depth. A key
+     * that ends inside the prefix is less than every key below the node.
+     */
+    static int comparePrefix(const Node *node, const unsigned char *key, uint32_t length, uint32_t depth) {
+        const unsigned char *prefix = node->prefix;
+        if (node->prefixLength > ART_MAX_PREFIX) {
+            prefix = anyLeaf(node)->key + depth;
+        }
+        const uint32_t available = length - depth;
+        const uint32_t common = (available < node->prefixLength ? available : node->prefixLength);
+        const int diff = ::memcmp(prefix, key + depth, common);
+        if (diff != 0) return (diff);
+        return (common < node->prefixLength ? 1 : 0);
+    }
+
+    // ----------------------------------------------------------------
+    // Search
+    // ----------------------------------------------------------------
+
+    Iterator search(const unsigned char *key, uint32_t length, bool strict) const {
+        Iterator iter;
+        iter.m_stack.reserve(16);
+        const void *child = m_root;
+        uint32_t depth = 0;
+        if (child == NULL) return (iter);
+
+        while (true) {
+            if (isLeaf(child)) {
+                iter.m_leaf = toLeaf(child);
+                const int diff = compareLeaf(iter.m_leaf, key, length);
+                if (diff < 0 || (strict && diff == 0)) iter.next();
+                return (iter);
+            }
+            const Node *node = static_cast<const Node*>(child);
+            if (node->prefixLength > 0) {
+                const int diff = comparePrefix(node, key, length, depth);
+                if (diff > 0) {
+                    iter.descend(node, true);
+                    return (iter);
+                } else if (diff < 0) {
+                    iter.descend(node, false);
+                    iter.next();
+                    return (iter);
+                }
+                depth += node->prefixLength;
+            }
+            // every key below is longer than the search key
+            if (depth >= length) {
+                iter.descend(node, true);
+                return (iter);
+            }
+            const unsigned char byte = key[depth];
+            const int pos = lowerPos(node, byte);
+            if (pos < 0) {
+                iter.descend(node, false);
+                iter.next();
+                return (iter);
+            }
+            Frame frame;
+            frame.node = node;
+            frame.pos = pos;
+            iter.m_stack.push_back(frame);
+            child = childAt(node, pos);
+            if (byteAt(node, pos) != byte) {
+                iter.descend(child, true);
+                return (iter);
+            }
+            depth++;
+        } // WHILE
+    }
+
+    // ----------------------------------------------------------------
+    // Insert
+    // ----------------------------------------------------------------
+
+    bool insertRecursive(void **ref, const unsigned char *key, uint32_t length, const void *value,
+                         uint32_t depth) {
+        void *child = *ref;
+        if (child == NULL) {
+            *ref = makeLeaf(key, length, value);
+            return (true);
+        }
+
+        if (isLeaf(child)) {
+            const Leaf *leaf = toLeaf(child);
+            if (leafMatches(leaf, key, length)) return (false);
+
+            // Split the leaf with a new node for the bytes they share
+            uint32_t common = 0;
+            const uint32_t limit = (leaf->length < length ? leaf->length : length);
+            while (depth + common < limit && leaf->key[depth + common] == key[depth + common]) {
+                common++;
+            } // WHILE
+            assert(depth + common < limit);
+            Node4 *node = static_cast<Node4*>(allocateNode(NODE4));
+            node->prefixLength = common;
+            ::memcpy(node->prefix, key + depth, (common < ART_MAX_PREFIX ? common : ART_MAX_PREFIX));
+            addChild4(node, leaf->key[depth + common], child);
+            addChild4(node, key[depth + common], makeLeaf(key, length, value));
+            *ref = node;
+            return (true);
+        }
+
+        Node *node = static_cast<Node*>(child);
+        if (node->prefixLength > 0) {
+            const uint32_t match = prefixMismatch(node, key, length, depth);
+            if (match < node->prefixLength) {
+                // (a key that ends inside the prefix would be a prefix of
+                // the keys below the node)
+                assert(depth + match < length);
+                // The key leaves the prefix: split it at the first byte
+                // that differs
+                Node4 *parent = static_cast<Node4*>(allocateNode(NODE4));
+                parent->prefixLength = match;
+                ::memcpy(parent->prefix, node->prefix, (match < ART_MAX_PREFIX ? match : ART_MAX_PREFIX));
+                if (node->prefixLength <= ART_MAX_PREFIX) {
+                    addChild4(parent, node->prefix[match], node);
+                    node->prefixLength -= (match + 1);
+                    ::memmove(node->prefix, node->prefix + match + 1,
+                              (node->prefixLength < ART_MAX_PREFIX ? node->prefixLength : ART_MAX_PREFIX));
+                } else {
+                    const Leaf *leaf = anyLeaf(node);
+                    addChild4(parent, leaf->key[depth + match], node);
+                    node->prefixLength -= (match + 1);
+                    ::memcpy(node->prefix, leaf->key + depth + match + 1,
+                             (node->prefixLength < ART_MAX_PREFIX ? node->prefixLength : ART_MAX_PREFIX));
+                }
+                addChild4(parent, key[depth + match], makeLeaf(key, length, value));
+                *ref = parent;
+                return (true);
+            }
+            depth += node->prefixLength;
+        }
+
+        assert(depth < length);
+        void **next = findChild(node, key[depth]);
+        if (next != NULL) {
+            return (insertRecursive(next, key, length, value, depth + 1));
+        }
+        addChild(ref, node, key[depth], makeLeaf(key, length, value));
+        return (true);
+    }
+
+    static void addChild4(Node4 *node, unsigned char byte, void *child) {
+        int pos = 0;
+        while (pos < node->count && node->keys[pos] < byte) pos++;
+        ::memmove(node->keys + pos + 1, node->keys + pos, node->count - pos);
+        ::memmove(node->children + pos + 1, node->children + pos, (node->count - pos) * sizeof(void*));
+        node->keys[pos] = byte;
+        node->children[pos] = child;
+        node->count++;
+    }
+
+    static void addChild16(Node16 *node, unsigned char byte, void *child) {
+        int pos = 0;
+        while (pos < node->count && node->keys[pos] < byte) pos++;
+        ::memmove(node->keys + pos + 1, node->keys + pos, node->count - pos);
+        ::memmove(node->children + pos + 1, node->children + pos, (node->count - pos) * sizeof(void*));
+        node->keys[pos] = byte;
+        node->children[pos] = child;
+        node->count++;
+    }
+
+    static void addChild48(Node48 *node, unsigned char byte, void *child) {
+        int slot = 0;
+        while (node->children[slot] != NULL) slot++;
+        node->children[slot] = child;
+        node->index[byte] = static_cast<unsigned char>(slot + 1);
+        node->count++;
+    }
+
+    static inline void copyHeader(Node *to, const Node *from) {
+        to->count = from->count;
+        to->prefixLength = from->prefixLength;
+        ::memcpy(to->prefix, from->prefix, ART_MAX_PREFIX);
+    }
+
+    /** Add a child, replacing the node with a bigger one if it is full */
+    void addChild(void **ref, Node *node, unsigned char byte, void *child) {
+        switch (node->type) {
+            case NODE4: {
+                Node4 *n = static_cast<Node4*>(node);
+                if (n->count < 4) {
+                    addChild4(n, byte, child);
+                    return;
+                }
+                Node16 *bigger = static_cast<Node16*>(allocateNode(NODE16));
+                copyHeader(bigger, n);
+                ::memcpy(bigger->keys, n->keys, 4);
+                ::memcpy(bigger->children, n->children, 4 * sizeof(void*));
+                addChild16(bigger, byte, child);
+                *ref = bigger;
+                freeNode(n);
+                return;
+            }
+            case NODE16: {
+                Node16 *n = static_cast<Node16*>(node);
+                if (n->count < 16) {
+                    addChild16(n, byte, child);
+                    return;
+                }
+                Node48 *bigger = static_cast<Node48*>(allocateNode(NODE48));
+                copyHeader(bigger, n);
+                ::memcpy(bigger->children, n->children, 16 * sizeof(void*));
+                for (int i = 0; i < 16; i++) {
+                    bigger->index[n->keys[i]] = static_cast<unsigned char>(i + 1);
+                } // FOR
+                addChild48(bigger, byte, child);
+                *ref = bigger;
+                freeNode(n);
+                return;
+            }
+            case NODE48: {
+                Node48 *n = static_cast<Node48*>(node);
+                if (n->count < 48) {
+                    addChild48(n, byte, child);
+                    return;
+                }
+                Node256 *bigger = static_cast<Node256*>(allocateNode(NODE256));
+                copyHeader(bigger, n);
+                for (int b = 0; b < 256; b++) {
+                    if (n->index[b] != 0) bigger->children[b] = n->children[n->index[b] - 1];
+                } // FOR
+                bigger->children[byte] = child;
+                bigger->count++;
+                *ref = bigger;
+                freeNode(n);
+                return;
+            }
+            default: {
+                Node256 *n = static_cast<Node256*>(node);
+                n->children[byte] = child;
+                n->count++;
+                return;
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------
+    // Erase
+    // ----------------------------------------------------------------
+
+    bool eraseRecursive(void **ref, const unsigned char *key, uint32_t length, uint32_t depth) {
+        void *child = *ref;
+        if (child == NULL) return (false);
+        if (isLeaf(child)) {
+            // only reached for a leaf at the root
+            if (leafMatches(toLeaf(child), key, length) == false) return (false);
+            freeLeaf(child);
+            *ref = NULL;
+            return (true);
+        }
+
+        Node *node = static_cast<Node*>(child);
+        if (node->prefixLength > 0) {
+            if (storedPrefixMatches(node, key, length, depth) == false) return (false);
+            depth += node->prefixLength;
+        }
+        if (depth >= length) return (false);
+
+        void **next = findChild(node, key[depth]);
+        if (next == NULL) return (false);
+        if (isLeaf(*next)) {
+            if (leafMatches(toLeaf(*next), key, length) == false) return (false);
+            freeLeaf(*next);
+            removeChild(ref, node, key[depth], next);
+            return (true);
+        }
+        return (eraseRecursive(next, key, length, depth + 1));
+    }
+
+    /** Remove a child, replacing the node with a smaller one if it gets sparse */
+    void removeChild(void **ref, Node *node, unsigned char byte, void **slot) {
+        switch (node->type) {
+            case NODE4: {
+                Node4 *n = static_cast<Node4*>(node);
+                const int pos = static_cast<int>(slot - n->children);
+                ::memmove(n->keys + pos, n->keys + pos + 1, n->count - pos - 1);
+                ::memmove(n->children + pos, n->children + pos + 1, (n->count - pos - 1) * sizeof(void*));
+                n->count--;
+                if (n->count == 1) {
+                    // Merge the node into its only child
+                    void *only = n->children[0];
+                    if (isLeaf(only) == false) {
+                        Node *below = static_cast<Node*>(only);
+                        unsigned char merged[ART_MAX_PREFIX];
+                        uint32_t used = (n->prefixLength < ART_MAX_PREFIX ? n->prefixLength : ART_MAX_PREFIX);
+                        ::memcpy(merged, n->prefix, used);
+                        if (used < ART_MAX_PREFIX) merged[used++] = n->keys[0];
+                        const uint32_t rest = (below->prefixLength < ART_MAX_PREFIX - used ?
+                                               below->prefixLength : ART_MAX_PREFIX - used);
+                        ::memcpy(merged + used, below->prefix, rest);
+                        used += rest;
+                        ::memcpy(below->prefix, merged, used);
+                        below->prefixLength += n->prefixLength + 1;
+                    }
+                    *ref = only;
+                    freeNode(n);
+                }
+                return;
+            }
+            case NODE16: {
+                Node16 *n = static_cast<Node16*>(node);
+                const int pos = static_cast<int>(slot - n->children);
+                ::memmove(n->keys + pos, n->keys + pos + 1, n->count - pos - 1);
+                ::memmove(n->children + pos, n->children + pos + 1, (n->count - pos - 1) * sizeof(void*));
+                n->count--;
+                if (n->count == 3) {
+                    Node4 *smaller = static_cast<Node4*>(allocateNode(NODE4));
+                    copyHeader(smaller, n);
+                    ::memcpy(smaller->keys, n->keys, 3);
+                    ::memcpy(smaller->children, n->children, 3 * sizeof(void*));
+                    *ref = smaller;
+                    freeNode(n);
+                }
+                return;
+            }
+            case NODE48: {
+                Node48 *n = static_cast<Node48*>(node);
+                n->children[n->index[byte] - 1] = NULL;
+                n->index[byte] = 0;
+                n->count--;
+                if (n->count == 12) {
+                    Node16 *smaller = static_cast<Node16*>(allocateNode(NODE16));
+                    copyHeader(smaller, n);
+                    smaller->count = 0;
+                    for (int b = 0; b < 256; b++) {
+                        if (n->index[b] == 0) continue;
+                        smaller->keys[smaller->count] = static_cast<unsigned char>(b);
+                        smaller->children[smaller->count] = n->children[n->index[b] - 1];
+                        smaller->count++;
+                    } // FOR
+                    *ref = smaller;
+                    freeNode(n);
+                }
+                return;
+            }
+            default: {
+                Node256 *n = static_cast<Node256*>(node);
+                n->children[byte] = NULL;
+                n->count--;
+                if (n->count == 37) {
+                    Node48 *smaller = static_cast<Node48*>(allocateNode(NODE48));
+                    copyHeader(smaller, n);
+                    smaller->count = 0;
+                    for (int b = 0; b < 256; b++) {
+                        if (n->children[b] == NULL) continue;
+                        smaller->children[smaller->count] = n->children[b];
+                        smaller->index[b] = static_cast<unsigned char>(smaller->count + 1);
+                        smaller->count++;
+                    } // FOR
+                    *ref = smaller;
+                    freeNode(n);
+                }
+                return;
+            }
+        }
+    }
+
+    int64_t *m_memorySize;
+    void *m_root;
+    size_t m_size;
+};
+
+}
+
+#endif
@@ -47,8 +47,11 @@
 #define BINARYTREEMULTIMAPINDEX_H_
 
 #include <map>
+#include <algorithm>
+#include <vector>
 #include <iostream>
 #include "indexes/tableindex.h"
+#include "indexes/indexkey.h"
 #include "common/tabletuple.h"
 #include "stx/btree_multimap.h"
 
@@ -83,10 +86,31 @@ public:
 
     bool addEntry(const TableTuple *tuple)
     {
-        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        setEntryKey(m_tmp1, tuple);
         return addEntryPrivate(tuple, m_tmp1);
     }
 
+    bool addEntries(const std::vector<const void*> &tuples)
+    {
+        if (m_entries->empty() == false) {
+            return TableIndex::addEntries(tuples);
+        }
+
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(tuples.size());
+        TableTuple tuple(m_tupleSchema);
+        for (size_t i = 0; i < tuples.size(); i++) {
+            tuple.move(const_cast<void*>(tuples[i]));
+            setEntryKey(m_tmp1, &tuple);
+            entries.push_back(std::pair<KeyType, const void*>(m_tmp1, tuples[i]));
+        }
+        // stable, so that equal keys stay in the order addEntry() would give
+        std::stable_sort(entries.begin(), entries.end(), EntryComparator(m_entries->key_comp()));
+        m_entries->bulk_load(entries.begin(), entries.end());
+        m_inserts += static_cast<int>(entries.size());
+        return true;
+    }
+
     bool deleteEntry(const TableTuple *tuple)
     {
         m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
@@ -98,8 +122,8 @@ public:
     {
         // this can probably be optimized
         m_tmp1.setFromTuple(oldTupleValue, column_indices_, m_keySchema);
-        m_tmp2.setFromTuple(newTupleValue, column_indices_, m_keySchema);
-        if (m_eq(m_tmp1, m_tmp2))
+        setEntryKey(m_tmp2, newTupleValue);
+        if (m_eq(m_tmp1, m_tmp2) && !includedValuesChanged(oldTupleValue, newTupleValue))
         {
             // no update is needed for this index
             return true;
@@ -118,7 +142,7 @@ public:
     }
     
     bool setEntryToNewAddress(const TableTuple *tuple, const void* address, const void *oldAddress) {
-        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        setEntryKey(m_tmp1, tuple);
         ++m_updates; 
         
 //        int i = 0; 
@@ -209,11 +233,13 @@ public:
             if (m_seqIter == m_entries->end())
                 return TableTuple();
             retval.move(const_cast<void*>(m_seqIter->second));
+            m_lastKey = &m_seqIter.key();
             ++m_seqIter;
         } else {
             if (m_seqRIter == (typename MapType::const_reverse_iterator) m_entries->rend())
                 return TableTuple();
             retval.move(const_cast<void*>(m_seqRIter->second));
+            m_lastKey = &m_seqRIter.key();
             ++m_seqRIter;
         }
 
@@ -224,6 +250,7 @@ public:
     {
         if (m_match.isNullTuple()) return m_match;
         TableTuple retval = m_match;
+        m_lastKey = &m_keyIter.first.key();
         ++(m_keyIter.first);
         if (m_keyIter.first == m_keyIter.second)
             m_match.move(NULL);
@@ -239,6 +266,17 @@ public:
         return moveToKey(m_keyIter.second->first);
     }
 
+    bool supportsCoveringReads() const { return m_coveringReads; }
+
+    void copyCoveredValues(TableTuple *tuple) const
+    {
+        assert(m_coveringReads && m_lastKey != NULL);
+        m_lastKey->copyToTuple(tuple, column_indices_, m_keySchema, 0);
+        if (m_includeSchema != NULL) {
+            m_lastKey->copyToTuple(tuple, m_includeColumns, m_includeSchema, m_includeOffset);
+        }
+    }
+
     size_t getSize() const { return m_entries->size(); }
     
     int64_t getMemoryEstimate() const {
@@ -251,11 +289,39 @@ protected:
     BinaryTreeMultiMapIndex(const TableIndexScheme &scheme) :
         TableIndex(scheme),
         m_begin(true),
-        m_eq(m_keySchema)
+        m_eq(m_keySchema),
+        m_includeOffset(NormalizedKeyEncoder::maxLength(m_keySchema)),
+        m_coveringReads(NormalizedKeyEncoder::decodable(m_keySchema)),
+        m_lastKey(NULL)
     {
         m_match = TableTuple(m_tupleSchema);
         m_allocator = new AllocatorType(&m_memoryEstimate);
         m_entries = new MapType(KeyComparator(m_keySchema), (*m_allocator));
+        // every key in the map is a copy of one of these
+        trackKeyMemory(m_tmp1, &m_memoryEstimate);
+        trackKeyMemory(m_tmp2, &m_memoryEstimate);
+    }
+
+    /** Orders (key, tuple) pairs by key for addEntries() */
+    struct EntryComparator {
+        EntryComparator(const KeyComparator &comparator) : m_comparator(comparator) {}
+        inline bool operator()(const std::pair<KeyType, const void*> &lhs,
+                               const std::pair<KeyType, const void*> &rhs) const {
+            return m_comparator(lhs.first, rhs.first);
+        }
+        KeyComparator m_comparator;
+    };
+
+    /**
+     * Build the key of an entry, with the included columns encoded
+     * behind the key columns
+     */
+    inline void setEntryKey(KeyType &key, const TableTuple *tuple)
+    {
+        key.setFromTuple(tuple, column_indices_, m_keySchema);
+        if (m_includeSchema != NULL) {
+            key.setIncludedValues(tuple, m_includeColumns, m_includeSchema, m_includeOffset);
+        }
     }
 
     inline bool addEntryPrivate(const TableTuple *tuple, const KeyType &key)
@@ -312,6 +378,13 @@ protected:
 
     // comparison stuff
     KeyEqualityChecker m_eq;
+
+    // the included columns follow the longest encoding of the key
+    const int32_t m_includeOffset;
+    // only numeric keys can be decoded for copyCoveredValues()
+    const bool m_coveringReads;
+    // key of the entry that was returned last, for copyCoveredValues()
+    const KeyType *m_lastKey;
 };
 
 }
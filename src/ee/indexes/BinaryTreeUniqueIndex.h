@@ -49,10 +49,13 @@
 //#include <map>
 #include "stx/btree_map.h"
 #include "stx/btree.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include "common/debuglog.h"
 #include "common/tabletuple.h"
 #include "indexes/tableindex.h"
+#include "indexes/indexkey.h"
 
 namespace voltdb {
 
@@ -78,10 +81,38 @@ public:
 
     bool addEntry(const TableTuple* tuple)
     {
-        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        setEntryKey(m_tmp1, tuple);
         return addEntryPrivate(tuple, m_tmp1);
     }
 
+    bool addEntries(const std::vector<const void*> &tuples)
+    {
+        if (m_entries->empty() == false) {
+            return TableIndex::addEntries(tuples);
+        }
+
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(tuples.size());
+        TableTuple tuple(m_tupleSchema);
+        for (size_t i = 0; i < tuples.size(); i++) {
+            tuple.move(const_cast<void*>(tuples[i]));
+            setEntryKey(m_tmp1, &tuple);
+            entries.push_back(std::pair<KeyType, const void*>(m_tmp1, tuples[i]));
+        }
+        // stable, so that the first of equal keys wins just like with addEntry()
+        EntryComparator comparator(m_entries->key_comp());
+        std::stable_sort(entries.begin(), entries.end(), comparator);
+        size_t count = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (count > 0 && comparator(entries[count - 1], entries[i]) == false) continue;
+            if (count != i) entries[count] = entries[i];
+            count++;
+        }
+        m_entries->bulk_load(entries.begin(), entries.begin() + count);
+        m_inserts += static_cast<int>(count);
+        return (count == entries.size());
+    }
+
     bool deleteEntry(const TableTuple* tuple)
     {
         m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
@@ -94,8 +125,8 @@ public:
         VOLT_TRACE("Do they ever replace Entry?\n");
         // this can probably be optimized
         m_tmp1.setFromTuple(oldTupleValue, column_indices_, m_keySchema);
-        m_tmp2.setFromTuple(newTupleValue, column_indices_, m_keySchema);
-        if (m_eq(m_tmp1, m_tmp2))
+        setEntryKey(m_tmp2, newTupleValue);
+        if (m_eq(m_tmp1, m_tmp2) && !includedValuesChanged(oldTupleValue, newTupleValue))
         {
             // no update is needed for this index
             return true;
@@ -111,7 +142,7 @@ public:
     
     bool setEntryToNewAddress(const TableTuple *tuple, const void* address, const void *oldAddress) {
         // set the key from the tuple
-        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        setEntryKey(m_tmp1, tuple);
         ++m_updates; 
         
         m_entries->erase(m_tmp1); 
@@ -195,11 +226,13 @@ public:
             if (m_keyIter == m_entries->end())
                 return TableTuple();
             retval.move(const_cast<void*>(m_keyIter->second));
+            m_lastKey = &m_keyIter.key();
             ++m_keyIter;
         } else {
             if (m_keyRIter == (typename MapType::const_reverse_iterator) m_entries->rend())
                 return TableTuple();
             retval.move(const_cast<void*>(m_keyRIter->second));
+            m_lastKey = &m_keyRIter.key();
             ++m_keyRIter;
         }
 
@@ -209,6 +242,9 @@ public:
     TableTuple nextValueAtKey()
     {
         TableTuple retval = m_match;
+        if (!m_match.isNullTuple()) {
+            m_lastKey = &m_keyIter.key();
+        }
         m_match.move(NULL);
         return retval;
     }
@@ -236,6 +272,17 @@ public:
         return !m_match.isNullTuple();
     }
 
+    bool supportsCoveringReads() const { return m_coveringReads; }
+
+    void copyCoveredValues(TableTuple *tuple) const
+    {
+        assert(m_coveringReads && m_lastKey != NULL);
+        m_lastKey->copyToTuple(tuple, column_indices_, m_keySchema, 0);
+        if (m_includeSchema != NULL) {
+            m_lastKey->copyToTuple(tuple, m_includeColumns, m_includeSchema, m_includeOffset);
+        }
+    }
+
     size_t getSize() const { return m_entries->size(); }
     int64_t getMemoryEstimate() const {
         /** Debug code
@@ -269,11 +316,39 @@ protected:
     BinaryTreeUniqueIndex(const TableIndexScheme &scheme) :
         TableIndex(scheme),
         m_begin(true),
-        m_eq(m_keySchema)
+        m_eq(m_keySchema),
+        m_includeOffset(NormalizedKeyEncoder::maxLength(m_keySchema)),
+        m_coveringReads(NormalizedKeyEncoder::decodable(m_keySchema)),
+        m_lastKey(NULL)
     {
         m_match = TableTuple(m_tupleSchema);
         m_allocator = new AllocatorType(&m_memoryEstimate);
         m_entries = new MapType(KeyComparator(m_keySchema), (*m_allocator));
+        // every key in the map is a copy of one of these
+        trackKeyMemory(m_tmp1, &m_memoryEstimate);
+        trackKeyMemory(m_tmp2, &m_memoryEstimate);
+    }
+
+    /** Orders (key, tuple) pairs by key for addEntries() */
+    struct EntryComparator {
+        EntryComparator(const KeyComparator &comparator) : m_comparator(comparator) {}
+        inline bool operator()(const std::pair<KeyType, const void*> &lhs,
+                               const std::pair<KeyType, const void*> &rhs) const {
+            return m_comparator(lhs.first, rhs.first);
+        }
+        KeyComparator m_comparator;
+    };
+
+    /**
+     * Build the key of an entry, with the included columns encoded
+     * behind the key columns
+     */
+    inline void setEntryKey(KeyType &key, const TableTuple *tuple)
+    {
+        key.setFromTuple(tuple, column_indices_, m_keySchema);
+        if (m_includeSchema != NULL) {
+            key.setIncludedValues(tuple, m_includeColumns, m_includeSchema, m_includeOffset);
+        }
     }
 
     inline bool addEntryPrivate(const TableTuple* tuple, const KeyType &key)
@@ -315,6 +390,13 @@ protected:
 
     // comparison stuff
     KeyEqualityChecker m_eq;
+
+    // the included columns follow the longest encoding of the key
+    const int32_t m_includeOffset;
+    // only numeric keys can be decoded for copyCoveredValues()
+    const bool m_coveringReads;
+    // key of the entry that was returned last, for copyCoveredValues()
+    const KeyType *m_lastKey;
 };
 
 }
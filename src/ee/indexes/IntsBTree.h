@@ -0,0 +1,723 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_INTSBTREE_H
+#define HSTORE_INTSBTREE_H
+
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+#include "boost/static_assert.hpp"
+
+#if defined(__SSE4_2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace voltdb {
+
+#define INTSBTREE_CACHE_LINE 64
+#define INTSBTREE_NODES_PER_SLAB 128
+#define INTSBTREE_MAX_DEPTH 32
+// Keys that prefetchPaths() walks down the tree together
+#define INTSBTREE_PREFETCH_GROUP 16
+
+/**
+ * Slab allocator for the nodes of one IntsBTree. Nodes are carved out of
+ * large cache-line aligned slabs, and released nodes are kept on a free
+ * list for reuse, so an index never calls malloc() per node. The number
+ * of bytes held by the slabs is added to the given memory counter.
+ */
+class IntsBTreeArena {
+public:
+    IntsBTreeArena(size_t nodeSize, int64_t *memorySize) :
+            m_nodeSize(nodeSize),
+            m_memorySize(memorySize),
+            m_current(NULL),
+            m_nextInSlab(INTSBTREE_NODES_PER_SLAB),
+            m_free(NULL) {
+        assert(m_nodeSize % INTSBTREE_CACHE_LINE == 0);
+    }
+
+    ~IntsBTreeArena() {
+        for (size_t i = 0; i < m_slabs.size(); i++) {
+            delete [] m_slabs[i];
+        } // FOR
+        *m_memorySize -= static_cast<int64_t>(m_slabs.size() * slabSize());
+    }
+
+    /** Return a zeroed, cache-line aligned node */
+    inline void* allocate() {
+        char *node = NULL;
+        if (m_free != NULL) {
+            node = m_free;
+            m_free = *reinterpret_cast<char**>(node);
+        } else {
+            if (m_nextInSlab == INTSBTREE_NODES_PER_SLAB) {
+                newSlab();
+            }
+            node = m_current + (m_nextInSlab++ * m_nodeSize);
+        }
+        ::memset(node, 0, m_nodeSize);
+        return (node);
+    }
+
+    inline void release(void *node) {
+        *reinterpret_cast<char**>(node) = m_free;
+        m_free = reinterpret_cast<char*>(node);
+    }
+
+private:
+    inline size_t slabSize() const {
+        return (m_nodeSize * INTSBTREE_NODES_PER_SLAB + INTSBTREE_CACHE_LINE);
+    }
+
+    void newSlab() {
+        char *slab = new char[slabSize()];
+        m_slabs.push_back(slab);
+        *m_memorySize += static_cast<int64_t>(slabSize());
+
+        uintptr_t start = reinterpret_cast<uintptr_t>(slab);
+        start = (start + INTSBTREE_CACHE_LINE - 1) & ~(static_cast<uintptr_t>(INTSBTREE_CACHE_LINE) - 1);
+        m_current = reinterpret_cast<char*>(start);
+        m_nextInSlab = 0;
+    }
+
+    const size_t m_nodeSize;
+    int64_t *m_memorySize;
+    std::vector<char*> m_slabs;
+    char *m_current;
+    size_t m_nextInSlab;
+    char *m_free;
+};
+
+/**
+ * Search the sorted array of the first count words for key (compared as
+ * unsigned integers). Sets less to the number of words that are < key and
+ * equal to the number that are == key.
+ *
+ * With SSE4.2 or AVX2 every word is compared at once and the result bits
+ * are counted, which has no branches to mispredict. This may read up to
+ * three words past count. SSE2 has no 64-bit compares, and emulating them
+ * costs more than it saves, so other builds use a branch-free binary
+ * search instead.
+ */
+static inline void intsBTreeSearchWords(const uint64_t *words, uint32_t count, uint64_t key,
+                                        uint32_t &less, uint32_t &equal) {
+#if defined(__AVX2__) || defined(__SSE4_2__)
+    uint64_t lessBits = 0;
+    uint64_t equalBits = 0;
+#if defined(__AVX2__)
+    const __m256i flip = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+    const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), flip);
+    for (uint32_t i = 0; i < count; i += 4) {
+        const __m256i w = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)), flip);
+        lessBits |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, w)))) << i;
+        equalBits |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(k, w)))) << i;
+    } // FOR
+#else
+    const __m128i flip = _mm_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+    const __m128i k = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(key)), flip);
+    for (uint32_t i = 0; i < count; i += 2) {
+        const __m128i w = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i)), flip);
+        lessBits |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, w)))) << i;
+        equalBits |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(k, w)))) << i;
+    } // FOR
+#endif
+    if (count < 64) {
+        const uint64_t mask = (static_cast<uint64_t>(1) << count) - 1;
+        lessBits &= mask;
+        equalBits &= mask;
+    }
+    less = static_cast<uint32_t>(__builtin_popcountll(lessBits));
+    equal = static_cast<uint32_t>(__builtin_popcountll(equalBits));
+#else
+    less = 0;
+    if (count > 0) {
+        const uint64_t *base = words;
+        uint32_t n = count;
+        while (n > 1) {
+            const uint32_t half = n / 2;
+            base = (base[half] < key ? base + half : base);
+            n -= half;
+        } // WHILE
+        less = static_cast<uint32_t>(base - words) + (*base < key ? 1 : 0);
+    }
+    equal = 0;
+    while (less + equal < count && words[less + equal] == key) {
+        equal++;
+    } // WHILE
+#endif
+}
+
+/**
+ * Cache-conscious B+tree over fixed-width integer keys of keyWords
+ * uint64_t words, compared lexicographically as unsigned values (the
+ * IntsKey encoding). Every node is a few cache lines, allocated from a
+ * per-tree IntsBTreeArena.
+ *
+ * Inside a node the keys are stored column-wise: words[w][i] is word w
+ * of the i-th key. That keeps the first word of all keys contiguous, so a
+ * node is searched on just that array (see intsBTreeSearchWords()), and
+ * only the run of keys that share the first word is compared further.
+ *
+ * Keys are unique. A non-unique index makes them unique by appending the
+ * tuple address as the last key word. Deletes never rebalance; nodes are
+ * only released once they become empty.
+ */
+template <std::size_t keyWords>
+class IntsBTree {
+public:
+    enum {
+        NODE_SIZE = (keyWords <= 2 ? 8 : 16) * INTSBTREE_CACHE_LINE,
+        // header is count + leaf flag, plus the sibling pointers in leaves
+        LEAF_SLOTS = ((NODE_SIZE - 24) / (keyWords * 8 + 8)) & ~3,
+        INNER_SLOTS = ((NODE_SIZE - 16) / (keyWords * 8 + 8)) & ~3
+    };
+
+private:
+    struct Node {
+        uint32_t count;
+        uint32_t leaf;
+    };
+
+    struct Leaf : public Node {
+        Leaf *prev;
+        Leaf *next;
+        uint64_t words[keyWords][LEAF_SLOTS];
+        const void *values[LEAF_SLOTS];
+    };
+
+    /**
+     * children[i] holds the keys k with words[i-1] <= k < words[i]
+     */
+    struct Inner : public Node {
+        uint64_t words[keyWords][INNER_SLOTS];
+        Node *children[INNER_SLOTS + 1];
+    };
+
+    BOOST_STATIC_ASSERT(sizeof(Leaf) <= NODE_SIZE);
+    BOOST_STATIC_ASSERT(sizeof(Inner) <= NODE_SIZE);
+    BOOST_STATIC_ASSERT(LEAF_SLOTS >= 4 && LEAF_SLOTS <= 64);
+    BOOST_STATIC_ASSERT(INNER_SLOTS >= 4 && INNER_SLOTS <= 64);
+
+public:
+    /**
+     * Position of one entry. Iterators are invalidated by any change to
+     * the tree.
+     */
+    class Iterator {
+    public:
+        Iterator() : m_leaf(NULL), m_position(0) {}
+        Iterator(Leaf *leaf, uint32_t position) : m_leaf(leaf), m_position(position) {}
+
+        inline bool atEnd() const {
+            return (m_leaf == NULL);
+        }
+        inline const void* value() const {
+            return (m_leaf->values[m_position]);
+        }
+        inline uint64_t word(std::size_t w) const {
+            return (m_leaf->words[w][m_position]);
+        }
+        inline void next() {
+            if (++m_position >= m_leaf->count) {
+                m_leaf = m_leaf->next;
+                m_position = 0;
+            }
+        }
+        inline void prev() {
+            if (m_position == 0) {
+                m_leaf = m_leaf->prev;
+                m_position = (m_leaf != NULL ? m_leaf->count - 1 : 0);
+            } else {
+                m_position--;
+            }
+        }
+        inline bool operator==(const Iterator &other) const {
+            return (m_leaf == other.m_leaf && m_position == other.m_position);
+        }
+
+    private:
+        Leaf *m_leaf;
+        uint32_t m_position;
+    };
+
+    IntsBTree(int64_t *memorySize) : m_arena(NODE_SIZE, memorySize), m_size(0) {
+        Leaf *root = newLeaf();
+        m_root = root;
+        m_head = root;
+        m_tail = root;
+    }
+
+    inline size_t size() const {
+        return (m_size);
+    }
+
+    /**
+     * Add the key. Returns false if it is already in the tree.
+     */
+    bool insert(const uint64_t *key, const void *value) {
+        Inner *path[INTSBTREE_MAX_DEPTH];
+        uint32_t pathIndex[INTSBTREE_MAX_DEPTH];
+        int depth = 0;
+        Leaf *leaf = descend(key, path, pathIndex, depth);
+
+        uint32_t position = rank(&leaf->words[0][0], LEAF_SLOTS, leaf->count, key, false);
+        if (position < leaf->count && compareAt(&leaf->words[0][0], LEAF_SLOTS, position, key) == 0) {
+            return (false);
+        }
+
+        if (leaf->count == LEAF_SLOTS) {
+            // Split in half and then insert into whichever side the key belongs
+            Leaf *right = newLeaf();
+            const uint32_t half = leaf->count / 2;
+            right->count = leaf->count - half;
+            for (std::size_t w = 0; w < keyWords; w++) {
+                ::memcpy(right->words[w], &leaf->words[w][half], right->count * sizeof(uint64_t));
+            } // FOR
+            ::memcpy(right->values, &leaf->values[half], right->count * sizeof(void*));
+            leaf->count = half;
+
+            right->prev = leaf;
+            right->next = leaf->next;
+            if (leaf->next != NULL) {
+                leaf->next->prev = right;
+            } else {
+                m_tail = right;
+            }
+            leaf->next = right;
+
+            if (position <= half) {
+                insertIntoLeaf(leaf, position, key, value);
+            } else {
+                insertIntoLeaf(right, position - half, key, value);
+            }
+
+            uint64_t separator[keyWords];
+            for (std::size_t w = 0; w < keyWords; w++) {
+                separator[w] = right->words[w][0];
+            } // FOR
+            insertIntoParent(path, pathIndex, depth, leaf, separator, right);
+        } else {
+            insertIntoLeaf(leaf, position, key, value);
+        }
+        m_size++;
+        return (true);
+    }
+
+    /**
+     * Remove the key. Returns false if it is not in the tree.
+     */
+    bool erase(const uint64_t *key) {
+        Inner *path[INTSBTREE_MAX_DEPTH];
+        uint32_t pathIndex[INTSBTREE_MAX_DEPTH];
+        int depth = 0;
+        Leaf *leaf = descend(key, path, pathIndex, depth);
+
+        uint32_t position = rank(&leaf->words[0][0], LEAF_SLOTS, leaf->count, key, false);
+        if (position >= leaf->count || compareAt(&leaf->words[0][0], LEAF_SLOTS, position, key) != 0) {
+            return (false);
+        }
+
+        const uint32_t tail = leaf->count - position - 1;
+        for (std::size_t w = 0; w < keyWords; w++) {
+            ::memmove(&leaf->words[w][position], &leaf->words[w][position + 1], tail * sizeof(uint64_t));
+        } // FOR
+        ::memmove(&leaf->values[position], &leaf->values[position + 1], tail * sizeof(void*));
+        leaf->count--;
+        m_size--;
+
+        if (leaf->count == 0 && depth > 0) {
+            if (leaf->prev != NULL) leaf->prev->next = leaf->next;
+            else m_head = leaf->next;
+            if (leaf->next != NULL) leaf->next->prev = leaf->prev;
+            else m_tail = leaf->prev;
+            m_arena.release(leaf);
+            removeFromParent(path, pathIndex, depth);
+        }
+        return (true);
+    }
+
+    /**
+     * Fill an empty tree with count keys (keyWords words each, one key
+     * after the other) that are sorted in ascending order without
+     * duplicates. The leaves are filled from left to right and every level
+     * of inner nodes is built on top of the one below, so no key is ever
+     * searched for or moved.
+     */
+    void bulkLoad(const uint64_t *keys, const void * const *values, size_t count) {
+        assert(m_size == 0);
+        if (count == 0) return;
+        m_arena.release(m_root);
+        m_head = NULL;
+        m_tail = NULL;
+
+        // Nodes of the level that is being built, with the smallest key
+        // below each of them (its separator in the parent)
+        std::vector<Node*> nodes;
+        std::vector<uint64_t> minimums;
+        const size_t numLeaves = (count + LEAF_SLOTS - 1) / LEAF_SLOTS;
+        nodes.reserve(numLeaves);
+        minimums.reserve(numLeaves * keyWords);
+        size_t remaining = count;
+        for (size_t i = 0; i < numLeaves; i++) {
+            // spread the keys evenly instead of leaving the last leaf nearly empty
+            Leaf *leaf = newLeaf();
+            leaf->count = static_cast<uint32_t>(remaining / (numLeaves - i));
+            for (uint32_t position = 0; position < leaf->count; position++) {
+                for (std::size_t w = 0; w < keyWords; w++) {
+                    leaf->words[w][position] = keys[w];
+                } // FOR
+                leaf->values[position] = *values++;
+                keys += keyWords;
+            } // FOR
+            remaining -= leaf->count;
+
+            leaf->prev = m_tail;
+            if (m_tail != NULL) {
+                m_tail->next = leaf;
+            } else {
+                m_head = leaf;
+            }
+            m_tail = leaf;
+            nodes.push_back(leaf);
+            for (std::size_t w = 0; w < keyWords; w++) {
+                minimums.push_back(leaf->words[w][0]);
+            } // FOR
+        } // FOR
+
+        while (nodes.size() > 1) {
+            const size_t numParents = (nodes.size() + INNER_SLOTS) / (INNER_SLOTS + 1);
+            std::vector<Node*> parents;
+            std::vector<uint64_t> parentMinimums;
+            parents.reserve(numParents);
+            parentMinimums.reserve(numParents * keyWords);
+            size_t child = 0;
+            for (size_t i = 0; i < numParents; i++) {
+                Inner *inner = newInner();
+                const size_t children = (nodes.size() - child) / (numParents - i);
+                inner->count = static_cast<uint32_t>(children - 1);
+                for (std::size_t w = 0; w < keyWords; w++) {
+                    parentMinimums.push_back(minimums[child * keyWords + w]);
+                } // FOR
+                for (size_t c = 0; c < children; c++, child++) {
+                    inner->children[c] = nodes[child];
+                    if (c == 0) continue;
+                    for (std::size_t w = 0; w < keyWords; w++) {
+                        inner->words[w][c - 1] = minimums[child * keyWords + w];
+                    } // FOR
+                } // FOR
+                parents.push_back(inner);
+            } // FOR
+            nodes.swap(parents);
+            minimums.swap(parentMinimums);
+        } // WHILE
+        m_root = nodes[0];
+        m_size = count;
+    }
+
+    /** The first entry that is >= key */
+    inline Iterator lowerBound(const uint64_t *key) const {
+        return (bound(key, false));
+    }
+
+    /** The first entry that is > key */
+    inline Iterator upperBound(const uint64_t *key) const {
+        return (bound(key, true));
+    }
+
+    /** The entry that is == key, or end() */
+    inline Iterator find(const uint64_t *key) const {
+        Iterator iter = bound(key, false);
+        if (iter.atEnd() == false && compareIterator(iter, key, keyWords) != 0) {
+            return (Iterator());
+        }
+        return (iter);
+    }
+
+    /**
+     * Walk down the tree for a batch of keys at once, one level at a time,
+     * and prefetch the node that each key visits next. The cache misses of
+     * a group of keys then overlap instead of being paid one lookup after
+     * another, and a following bound() for any of the keys finds its whole
+     * path in the cache. keys holds count keys of keyWords words each.
+     */
+    void prefetchPaths(const uint64_t *keys, std::size_t count) const {
+        const Node *nodes[INTSBTREE_PREFETCH_GROUP];
+        for (std::size_t start = 0; start < count; start += INTSBTREE_PREFETCH_GROUP) {
+            const std::size_t group = (count - start < INTSBTREE_PREFETCH_GROUP ?
+                                       count - start : INTSBTREE_PREFETCH_GROUP);
+            for (std::size_t i = 0; i < group; i++) {
+                nodes[i] = m_root;
+            } // FOR
+            // A node is only read in the pass after it was prefetched
+            bool descending = true;
+            while (descending) {
+                descending = false;
+                for (std::size_t i = 0; i < group; i++) {
+                    if (nodes[i]->leaf != 0) continue;
+                    const Inner *inner = static_cast<const Inner*>(nodes[i]);
+                    const uint64_t *key = keys + ((start + i) * keyWords);
+                    const uint32_t index = rank(&inner->words[0][0], INNER_SLOTS, inner->count, key, true);
+                    nodes[i] = inner->children[index];
+                    prefetch(nodes[i]);
+                    descending = true;
+                } // FOR
+            } // WHILE
+        } // FOR
+    }
+
+    inline Iterator begin() const {
+        return (m_size == 0 ? Iterator() : Iterator(m_head, 0));
+    }
+
+    /** The last entry, for iterating backwards with prev() */
+    inline Iterator rbegin() const {
+        return (m_size == 0 ? Iterator() : Iterator(m_tail, m_tail->count - 1));
+    }
+
+    inline Iterator end() const {
+        return (Iterator());
+    }
+
+    /**
+     * Compare the first 'words' words of the entry at iter with key
+     */
+    static inline int compareIterator(const Iterator &iter, const uint64_t *key, std::size_t words) {
+        for (std::size_t w = 0; w < words; w++) {
+            const uint64_t value = iter.word(w);
+            if (value != key[w]) {
+                return (value < key[w] ? -1 : 1);
+            }
+        } // FOR
+        return (0);
+    }
+
+private:
+    inline Leaf* newLeaf() {
+        Leaf *leaf = reinterpret_cast<Leaf*>(m_arena.allocate());
+        leaf->leaf = 1;
+        return (leaf);
+    }
+
+    inline Inner* newInner() {
+        Inner *inner = reinterpret_cast<Inner*>(m_arena.allocate());
+        inner->leaf = 0;
+        return (inner);
+    }
+
+    /**
+     * Compare the key at position in a column-wise key array with key
+     */
+    static inline int compareAt(const uint64_t *words, uint32_t slots, uint32_t position, const uint64_t *key) {
+        for (std::size_t w = 0; w < keyWords; w++) {
+            const uint64_t value = words[w * slots + position];
+            if (value != key[w]) {
+                return (value < key[w] ? -1 : 1);
+            }
+        } // FOR
+        return (0);
+    }
+
+    /**
+     * Number of keys in the node that are < key, or <= key if orEqual.
+     * Because the keys are sorted this is the lower (upper) bound position.
+     */
+    static inline uint32_t rank(const uint64_t *words, uint32_t slots, uint32_t count,
+                                const uint64_t *key, bool orEqual) {
+        uint32_t less, equal;
+        intsBTreeSearchWords(words, count, key[0], less, equal);
+        uint32_t position = less;
+        const uint32_t end = less + equal;
+        if (keyWords == 1) {
+            return (orEqual ? end : position);
+        }
+        // Only the keys that share the first word need a closer look
+        while (position < end) {
+            const int cmp = compareAt(words, slots, position, key);
+            if (cmp > 0 || (cmp == 0 && orEqual == false)) break;
+            position++;
+        } // WHILE
+        return (position);
+    }
+
+    /**
+     * Start loading all of a node's cache lines at once, so that the
+     * misses overlap instead of being paid one after another by the search
+     */
+    static inline void prefetch(const Node *node) {
+        const char *address = reinterpret_cast<const char*>(node);
+        for (int offset = 0; offset < NODE_SIZE; offset += INTSBTREE_CACHE_LINE) {
+            __builtin_prefetch(address + offset);
+        } // FOR
+    }
+
+    Leaf* descend(const uint64_t *key, Inner **path, uint32_t *pathIndex, int &depth) const {
+        Node *node = m_root;
+        depth = 0;
+        while (node->leaf == 0) {
+            Inner *inner = static_cast<Inner*>(node);
+            const uint32_t index = rank(&inner->words[0][0], INNER_SLOTS, inner->count, key, true);
+            assert(depth < INTSBTREE_MAX_DEPTH);
+            path[depth] = inner;
+            pathIndex[depth] = index;
+            depth++;
+            node = inner->children[index];
+            prefetch(node);
+        } // WHILE
+        return (static_cast<Leaf*>(node));
+    }
+
+    Iterator bound(const uint64_t *key, bool upper) const {
+        Inner *path[INTSBTREE_MAX_DEPTH];
+        uint32_t pathIndex[INTSBTREE_MAX_DEPTH];
+        int depth = 0;
+        Leaf *leaf = descend(key, path, pathIndex, depth);
+        uint32_t position = rank(&leaf->words[0][0], LEAF_SLOTS, leaf->count, key, upper);
+        if (position >= leaf->count) {
+            // Non-root leaves are never empty, so the next one has our answer
+            return (leaf->next != NULL ? Iterator(leaf->next, 0) : Iterator());
+        }
+        return (Iterator(leaf, position));
+    }
+
+    inline void insertIntoLeaf(Leaf *leaf, uint32_t position, const uint64_t *key, const void *value) {
+        const uint32_t tail = leaf->count - position;
+        for (std::size_t w = 0; w < keyWords; w++) {
+            ::memmove(&leaf->words[w][position + 1], &leaf->words[w][position], tail * sizeof(uint64_t));
+            leaf->words[w][position] = key[w];
+        } // FOR
+        ::memmove(&leaf->values[position + 1], &leaf->values[position], tail * sizeof(void*));
+        leaf->values[position] = value;
+        leaf->count++;
+    }
+
+    /**
+     * Add separator and right as the sibling that follows left, which is
+     * the child at path[depth-1]->children[pathIndex[depth-1]]
+     */
+    void insertIntoParent(Inner **path, uint32_t *pathIndex, int depth,
+                          Node *left, const uint64_t *separator, Node *right) {
+        if (depth == 0) {
+            Inner *root = newInner();
+            root->count = 1;
+            for (std::size_t w = 0; w < keyWords; w++) {
+                root->words[w][0] = separator[w];
+            } // FOR
+            root->children[0] = left;
+            root->children[1] = right;
+            m_root = root;
+            return;
+        }
+
+        Inner *parent = path[depth - 1];
+        const uint32_t index = pathIndex[depth - 1];
+        if (parent->count < INNER_SLOTS) {
+            const uint32_t tail = parent->count - index;
+            for (std::size_t w = 0; w < keyWords; w++) {
+                ::memmove(&parent->words[w][index + 1], &parent->words[w][index], tail * sizeof(uint64_t));
+                parent->words[w][index] = separator[w];
+            } // FOR
+            ::memmove(&parent->children[index + 2], &parent->children[index + 1], tail * sizeof(Node*));
+            parent->children[index + 1] = right;
+            parent->count++;
+            return;
+        }
+
+        // Full: lay out all INNER_SLOTS + 1 separators in order, keep the
+        // lower half, push the middle one up and move the rest to a new node
+        uint64_t words[keyWords][INNER_SLOTS + 1];
+        Node *children[INNER_SLOTS + 2];
+        const uint32_t total = INNER_SLOTS + 1;
+        for (std::size_t w = 0; w < keyWords; w++) {
+            ::memcpy(words[w], parent->words[w], index * sizeof(uint64_t));
+            words[w][index] = separator[w];
+            ::memcpy(&words[w][index + 1], &parent->words[w][index], (INNER_SLOTS - index) * sizeof(uint64_t));
+        } // FOR
+        ::memcpy(children, parent->children, (index + 1) * sizeof(Node*));
+        children[index + 1] = right;
+        ::memcpy(&children[index + 2], &parent->children[index + 1], (INNER_SLOTS - index) * sizeof(Node*));
+
+        const uint32_t middle = total / 2;
+        Inner *sibling = newInner();
+        parent->count = middle;
+        sibling->count = total - middle - 1;
+        uint64_t pushUp[keyWords];
+        for (std::size_t w = 0; w < keyWords; w++) {
+            ::memcpy(parent->words[w], words[w], middle * sizeof(uint64_t));
+            pushUp[w] = words[w][middle];
+            ::memcpy(sibling->words[w], &words[w][middle + 1], sibling->count * sizeof(uint64_t));
+        } // FOR
+        ::memcpy(parent->children, children, (middle + 1) * sizeof(Node*));
+        ::memcpy(sibling->children, &children[middle + 1], (sibling->count + 1) * sizeof(Node*));
+
+        insertIntoParent(path, pathIndex, depth - 1, parent, pushUp, sibling);
+    }
+
+    /**
+     * The child at path[depth-1]->children[pathIndex[depth-1]] was
+     * released, so drop it from its parent
+     */
+    void removeFromParent(Inner **path, uint32_t *pathIndex, int depth) {
+        Inner *parent = path[depth - 1];
+        const uint32_t index = pathIndex[depth - 1];
+        if (parent->count == 0) {
+            // That was its only child
+            assert(depth > 1);
+            m_arena.release(parent);
+            removeFromParent(path, pathIndex, depth - 1);
+            return;
+        }
+
+        // Drop the separator on the side of the removed child. The
+        // neighbour simply takes over its (now empty) key range.
+        const uint32_t separator = (index > 0 ? index - 1 : 0);
+        const uint32_t tail = parent->count - separator - 1;
+        for (std::size_t w = 0; w < keyWords; w++) {
+            ::memmove(&parent->words[w][separator], &parent->words[w][separator + 1], tail * sizeof(uint64_t));
+        } // FOR
+        ::memmove(&parent->children[index], &parent->children[index + 1],
+                  (parent->count - index) * sizeof(Node*));
+        parent->count--;
+
+        // Shrink the tree while the root only has a single child
+        while (m_root->leaf == 0 && m_root->count == 0) {
+            Inner *root = static_cast<Inner*>(m_root);
+            m_root = root->children[0];
+            m_arena.release(root);
+        } // WHILE
+    }
+
+    IntsBTreeArena m_arena;
+    Node *m_root;
+    Leaf *m_head;
+    Leaf *m_tail;
+    size_t m_size;
+};
+
+}
+
+#endif
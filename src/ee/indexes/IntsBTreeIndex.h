@@ -0,0 +1,396 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_INTSBTREEINDEX_H
+#define HSTORE_INTSBTREEINDEX_H
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "common/debuglog.h"
+#include "common/tabletuple.h"
+#include "indexes/tableindex.h"
+#include "indexes/indexkey.h"
+#include "indexes/IntsBTree.h"
+
+namespace voltdb {
+
+/**
+ * Tree index on integer-only keys (IntsKey) backed by an IntsBTree
+ * instead of stx::btree. Used for both unique and non-unique indexes. In
+ * a non-unique index every entry's key is extended with the tuple address,
+ * so that all the entries for one key are adjacent and a specific tuple
+ * can be found directly when it is deleted.
+ * @see TableIndex
+ */
+template<std::size_t keySize, bool unique>
+class IntsBTreeIndex : public TableIndex
+{
+    friend class TableIndexFactory;
+
+    enum { KEY_WORDS = keySize + (unique ? 0 : 1) };
+    typedef IntsBTree<KEY_WORDS> TreeType;
+    typedef typename TreeType::Iterator Iterator;
+
+public:
+
+    ~IntsBTreeIndex() {
+        delete m_entries;
+    };
+
+    bool addEntry(const TableTuple *tuple)
+    {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        return addEntryPrivate(tuple, m_tmp1);
+    }
+
+    bool addEntries(const std::vector<const void*> &tuples)
+    {
+        if (m_entries->size() > 0) {
+            return TableIndex::addEntries(tuples);
+        }
+
+        std::vector<BulkEntry> entries(tuples.size());
+        TableTuple tuple(m_tupleSchema);
+        for (size_t i = 0; i < tuples.size(); i++) {
+            tuple.move(const_cast<void*>(tuples[i]));
+            m_tmp1.setFromTuple(&tuple, column_indices_, m_keySchema);
+            setEntryKey(m_tmp1, tuples[i]);
+            ::memcpy(entries[i].words, m_search, sizeof(m_search));
+            entries[i].value = tuples[i];
+        }
+        // stable, so that a unique index keeps the first of equal keys
+        // just like addEntry() would have
+        std::stable_sort(entries.begin(), entries.end(), BulkEntryLess());
+
+        std::vector<uint64_t> keys;
+        std::vector<const void*> values;
+        keys.reserve(entries.size() * KEY_WORDS);
+        values.reserve(entries.size());
+        bool success = true;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (i > 0 && ::memcmp(entries[i - 1].words, entries[i].words, sizeof(m_search)) == 0) {
+                success = false;
+                continue;
+            }
+            keys.insert(keys.end(), entries[i].words, entries[i].words + KEY_WORDS);
+            values.push_back(entries[i].value);
+        }
+        m_entries->bulkLoad(keys.empty() ? NULL : &keys[0], values.empty() ? NULL : &values[0], values.size());
+        m_inserts += static_cast<int>(values.size());
+        return success;
+    }
+
+    bool deleteEntry(const TableTuple *tuple)
+    {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        return deleteEntryPrivate(tuple->address(), m_tmp1);
+    }
+
+    bool replaceEntry(const TableTuple *oldTupleValue,
+                      const TableTuple *newTupleValue)
+    {
+        m_tmp1.setFromTuple(oldTupleValue, column_indices_, m_keySchema);
+        m_tmp2.setFromTuple(newTupleValue, column_indices_, m_keySchema);
+        if (m_eq(m_tmp1, m_tmp2))
+        {
+            // no update is needed for this index
+            return true;
+        }
+
+        // Like BinaryTreeMultiMapIndex, the old entry of a non-unique
+        // index is found through the address of the new tuple
+        bool deleted = deleteEntryPrivate(newTupleValue->address(), m_tmp1);
+        bool inserted = addEntryPrivate(newTupleValue, m_tmp2);
+        --m_deletes;
+        --m_inserts;
+        ++m_updates;
+        return (deleted && inserted);
+    }
+
+    bool setEntryToNewAddress(const TableTuple *tuple, const void* address, const void *oldAddress) {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        ++m_updates;
+
+        setEntryKey(m_tmp1, oldAddress);
+        if (m_entries->erase(m_search) == false && !unique) {
+            VOLT_INFO("Tuple not found.");
+            return false;
+        }
+        setEntryKey(m_tmp1, address);
+        return m_entries->insert(m_search, address);
+    }
+
+    bool checkForIndexChange(const TableTuple *lhs, const TableTuple *rhs)
+    {
+        m_tmp1.setFromTuple(lhs, column_indices_, m_keySchema);
+        m_tmp2.setFromTuple(rhs, column_indices_, m_keySchema);
+        return !(m_eq(m_tmp1, m_tmp2));
+    }
+
+    bool exists(const TableTuple* values)
+    {
+        ++m_lookups;
+        m_tmp1.setFromTuple(values, column_indices_, m_keySchema);
+        setSearchKey(m_tmp1, 0);
+        Iterator iter = m_entries->lowerBound(m_search);
+        return (iter.atEnd() == false && TreeType::compareIterator(iter, m_tmp1.data, keySize) == 0);
+    }
+
+    bool moveToKey(const TableTuple *searchKey)
+    {
+        m_tmp1.setFromKey(searchKey);
+        return moveToKey(m_tmp1);
+    }
+
+    bool moveToTuple(const TableTuple *searchTuple)
+    {
+        m_tmp1.setFromTuple(searchTuple, column_indices_, m_keySchema);
+        return moveToKey(m_tmp1);
+    }
+
+    void moveToKeyOrGreater(const TableTuple *searchKey)
+    {
+        ++m_lookups;
+        m_begin = true;
+        m_tmp1.setFromKey(searchKey);
+        setSearchKey(m_tmp1, 0);
+        m_seqIter = m_entries->lowerBound(m_search);
+    }
+
+    void moveToGreaterThanKey(const TableTuple *searchKey)
+    {
+        ++m_lookups;
+        m_begin = true;
+        m_tmp1.setFromKey(searchKey);
+        setSearchKey(m_tmp1, UINT64_MAX);
+        m_seqIter = m_entries->upperBound(m_search);
+    }
+
+    void moveToEnd(bool begin)
+    {
+        ++m_lookups;
+        m_begin = begin;
+        m_seqIter = (begin ? m_entries->begin() : m_entries->rbegin());
+        m_keyIter = m_seqIter;
+    }
+
+    void prefetchKeys(const TableTuple *searchKeys, int count)
+    {
+        m_prefetchKeys.resize(static_cast<size_t>(count) * KEY_WORDS);
+        for (int i = 0; i < count; i++) {
+            m_tmp1.setFromKey(&searchKeys[i]);
+            setSearchKey(m_tmp1, 0);
+            ::memcpy(&m_prefetchKeys[i * KEY_WORDS], m_search, sizeof(m_search));
+        }
+        if (count > 0) {
+            m_entries->prefetchPaths(&m_prefetchKeys[0], count);
+        }
+    }
+
+    TableTuple nextValue()
+    {
+        TableTuple retval(m_tupleSchema);
+        if (m_seqIter.atEnd())
+            return TableTuple();
+        retval.move(const_cast<void*>(m_seqIter.value()));
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            m_lastKey.data[ii] = m_seqIter.word(ii);
+        }
+        if (m_begin)
+            m_seqIter.next();
+        else
+            m_seqIter.prev();
+        return retval;
+    }
+
+    TableTuple nextValueAtKey()
+    {
+        if (m_match.isNullTuple()) return m_match;
+        TableTuple retval = m_match;
+        m_lastKey = m_currentKey;
+        if (unique) {
+            m_match.move(NULL);
+        } else {
+            m_keyIter.next();
+            if (m_keyIter.atEnd() || TreeType::compareIterator(m_keyIter, m_currentKey.data, keySize) != 0)
+                m_match.move(NULL);
+            else
+                m_match.move(const_cast<void*>(m_keyIter.value()));
+        }
+        return retval;
+    }
+
+    bool advanceToNextKey()
+    {
+        if (unique) {
+            if (m_keyIter.atEnd() == false) {
+                if (m_begin)
+                    m_keyIter.next();
+                else
+                    m_keyIter.prev();
+            }
+        } else {
+            // Skip over the rest of the entries for the current key
+            setSearchKey(m_currentKey, UINT64_MAX);
+            m_keyIter = m_entries->upperBound(m_search);
+        }
+        if (m_keyIter.atEnd()) {
+            m_match.move(NULL);
+            return false;
+        }
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            m_currentKey.data[ii] = m_keyIter.word(ii);
+        }
+        m_match.move(const_cast<void*>(m_keyIter.value()));
+        return !m_match.isNullTuple();
+    }
+
+    bool supportsCoveringReads() const { return true; }
+
+    void copyCoveredValues(TableTuple *tuple) const
+    {
+        m_lastKey.copyToTuple(tuple, column_indices_, m_keySchema);
+    }
+
+    size_t getSize() const { return m_entries->size(); }
+
+    int64_t getMemoryEstimate() const {
+        return m_memoryEstimate;
+    }
+
+    std::string getTypeName() const { return (unique ? "IntsBTreeUniqueIndex" : "IntsBTreeMultiMapIndex"); };
+
+    std::string debug() const
+    {
+        std::ostringstream buffer;
+        buffer << TableIndex::debug() << std::endl;
+
+        for (Iterator i = m_entries->begin(); i.atEnd() == false; i.next()) {
+            TableTuple retval(m_tupleSchema);
+            retval.move(const_cast<void*>(i.value()));
+            buffer << retval.debugNoHeader() << std::endl;
+        }
+        std::string ret(buffer.str());
+        return (ret);
+    }
+
+protected:
+    IntsBTreeIndex(const TableIndexScheme &scheme) :
+        TableIndex(scheme),
+        m_begin(true),
+        m_eq(m_keySchema)
+    {
+        m_match = TableTuple(m_tupleSchema);
+        m_entries = new TreeType(&m_memoryEstimate);
+    }
+
+    /** A tree key and its tuple, collected by addEntries() */
+    struct BulkEntry {
+        uint64_t words[KEY_WORDS];
+        const void *value;
+    };
+
+    struct BulkEntryLess {
+        inline bool operator()(const BulkEntry &lhs, const BulkEntry &rhs) const {
+            for (std::size_t w = 0; w < KEY_WORDS; w++) {
+                if (lhs.words[w] != rhs.words[w]) {
+                    return (lhs.words[w] < rhs.words[w]);
+                }
+            }
+            return (false);
+        }
+    };
+
+    /**
+     * Build the tree key for an IntsKey. A non-unique index appends the
+     * tuple address (or 0 / UINT64_MAX to find the first or last entry of
+     * the key).
+     */
+    inline void setSearchKey(const IntsKey<keySize> &key, uint64_t address)
+    {
+        ::memcpy(m_search, key.data, keySize * sizeof(uint64_t));
+        if (!unique) {
+            m_search[KEY_WORDS - 1] = address;
+        }
+    }
+
+    inline void setEntryKey(const IntsKey<keySize> &key, const void *address)
+    {
+        setSearchKey(key, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address)));
+    }
+
+    inline bool addEntryPrivate(const TableTuple *tuple, const IntsKey<keySize> &key)
+    {
+        ++m_inserts;
+        setEntryKey(key, tuple->address());
+        return m_entries->insert(m_search, tuple->address());
+    }
+
+    inline bool deleteEntryPrivate(const void *address, const IntsKey<keySize> &key)
+    {
+        ++m_deletes;
+        setEntryKey(key, address);
+        return m_entries->erase(m_search);
+    }
+
+    bool moveToKey(const IntsKey<keySize> &key)
+    {
+        ++m_lookups;
+        m_begin = true;
+        m_currentKey = key;
+        setSearchKey(key, 0);
+        m_keyIter = m_entries->lowerBound(m_search);
+        if (m_keyIter.atEnd() || TreeType::compareIterator(m_keyIter, key.data, keySize) != 0) {
+            m_match.move(NULL);
+            return false;
+        }
+        m_match.move(const_cast<void*>(m_keyIter.value()));
+        return !m_match.isNullTuple();
+    }
+
+    TreeType *m_entries;
+    IntsKey<keySize> m_tmp1;
+    IntsKey<keySize> m_tmp2;
+    uint64_t m_search[KEY_WORDS];
+    // tree keys for prefetchKeys()
+    std::vector<uint64_t> m_prefetchKeys;
+
+    // iteration stuff
+    bool m_begin;
+    IntsKey<keySize> m_currentKey;
+    // key of the entry that was returned last, for copyCoveredValues()
+    IntsKey<keySize> m_lastKey;
+    Iterator m_keyIter;
+    Iterator m_seqIter;
+    TableTuple m_match;
+
+    // comparison stuff
+    IntsEqualityChecker<keySize> m_eq;
+};
+
+}
+
+#endif // HSTORE_INTSBTREEINDEX_H
@@ -0,0 +1,413 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_INTSHASHTABLE_H
+#define HSTORE_INTSHASHTABLE_H
+
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace voltdb {
+
+#define INTSHASHTABLE_GROUP_SIZE 16
+#define INTSHASHTABLE_MIN_CAPACITY 64
+// Groups moved from the old table to the new one on every insert/erase
+// while a resize is in progress
+#define INTSHASHTABLE_MIGRATE_GROUPS 4
+
+/**
+ * Flat open-addressing hash table from fixed-width integer keys (keySize
+ * uint64_t words, the IntsKey encoding) to tuple addresses. Keys must be
+ * unique.
+ *
+ * The layout follows the SwissTable design. Slots are split into groups
+ * of 16, and every slot has a one byte control word that is either EMPTY,
+ * DELETED, or the low 7 bits of the key's hash. A probe loads a whole
+ * group of control bytes and compares them to the hash with one SSE2
+ * compare, so only slots whose 7-bit hash matches are ever compared,
+ * and the key and value are stored inline in the slot.
+ *
+ * Growing the table never rehashes everything at once. A bigger table is
+ * allocated, and every following insert or erase moves a few groups of
+ * the old table into it. Lookups check the new table and then the old one
+ * until the old table has been drained.
+ */
+template <std::size_t keySize>
+class IntsHashTable {
+private:
+    struct Slot {
+        uint64_t key[keySize];
+        const void *value;
+    };
+
+    struct Table {
+        char *memory;
+        int8_t *control;
+        Slot *slots;
+        size_t capacity;
+        size_t groupMask;
+        // slots that are not EMPTY (live entries plus tombstones)
+        size_t used;
+        size_t live;
+    };
+
+    static const int8_t EMPTY = -128;
+    static const int8_t DELETED = -2;
+
+public:
+    IntsHashTable(int64_t *memorySize) : m_memorySize(memorySize), m_migrateGroup(0) {
+        ::memset(&m_old, 0, sizeof(Table));
+        allocate(m_current, INTSHASHTABLE_MIN_CAPACITY);
+    }
+
+    ~IntsHashTable() {
+        release(m_current);
+        release(m_old);
+    }
+
+    inline size_t size() const {
+        return (m_current.live + m_old.live);
+    }
+
+    inline size_t capacity() const {
+        return (m_current.capacity);
+    }
+
+    inline bool isResizing() const {
+        return (m_old.memory != NULL);
+    }
+
+    inline double loadFactor() const {
+        return (static_cast<double>(size()) / static_cast<double>(m_current.capacity));
+    }
+
+    /**
+     * Return the value stored for the key, or NULL if there is none
+     */
+    inline const void* find(const uint64_t *key) const {
+        const uint64_t hash = hashKey(key);
+        Slot *slot = findIn(m_current, key, hash);
+        if (slot == NULL && m_old.memory != NULL) {
+            slot = findIn(m_old, key, hash);
+        }
+        return (slot != NULL ? slot->value : NULL);
+    }
+
+    /**
+     * Prefetch what lookups of a batch of keys will read, in two rounds:
+     * first the control bytes of every key's first group, then the slots
+     * whose control byte matches. The misses of each round overlap. keys
+     * holds count keys of keySize words each.
+     */
+    void prefetch(const uint64_t *keys, size_t count) const {
+        for (size_t i = 0; i < count; i++) {
+            const size_t group = firstGroup(m_current, hashKey(keys + (i * keySize)));
+            __builtin_prefetch(m_current.control + (group * INTSHASHTABLE_GROUP_SIZE));
+        } // FOR
+        for (size_t i = 0; i < count; i++) {
+            const uint64_t hash = hashKey(keys + (i * keySize));
+            const size_t group = firstGroup(m_current, hash);
+            const uint32_t matches = matchByte(m_current.control + (group * INTSHASHTABLE_GROUP_SIZE), controlByte(hash));
+            if (matches != 0) {
+                __builtin_prefetch(&m_current.slots[(group * INTSHASHTABLE_GROUP_SIZE) + static_cast<size_t>(__builtin_ctz(matches))]);
+            }
+        } // FOR
+    }
+
+    /**
+     * Add the key. Returns false if it is already in the table.
+     */
+    bool insert(const uint64_t *key, const void *value) {
+        const uint64_t hash = hashKey(key);
+        if (findIn(m_current, key, hash) != NULL ||
+            (m_old.memory != NULL && findIn(m_old, key, hash) != NULL)) {
+            return (false);
+        }
+        if ((m_current.used + 1) * 8 > m_current.capacity * 7) {
+            startResize();
+        }
+        insertInto(m_current, key, value, hash);
+        if (m_old.memory != NULL) {
+            migrate(INTSHASHTABLE_MIGRATE_GROUPS);
+        }
+        return (true);
+    }
+
+    /**
+     * Change the value stored for the key. Returns false if there is none.
+     */
+    bool update(const uint64_t *key, const void *value) {
+        const uint64_t hash = hashKey(key);
+        Slot *slot = findIn(m_current, key, hash);
+        if (slot == NULL && m_old.memory != NULL) {
+            slot = findIn(m_old, key, hash);
+        }
+        if (slot == NULL) {
+            return (false);
+        }
+        slot->value = value;
+        return (true);
+    }
+
+    /**
+     * Remove the key. Returns false if it is not in the table.
+     */
+    bool erase(const uint64_t *key) {
+        const uint64_t hash = hashKey(key);
+        bool erased = eraseFrom(m_current, key, hash);
+        if (erased == false && m_old.memory != NULL) {
+            erased = eraseFrom(m_old, key, hash);
+        }
+        if (m_old.memory != NULL) {
+            migrate(INTSHASHTABLE_MIGRATE_GROUPS);
+        }
+        return (erased);
+    }
+
+    /**
+     * Make room for at least count entries right away. This is the only
+     * operation that moves every entry at once.
+     */
+    void reserve(size_t count) {
+        size_t needed = INTSHASHTABLE_MIN_CAPACITY;
+        while (needed * 7 < count * 8) {
+            needed *= 2;
+        } // WHILE
+        if (needed <= m_current.capacity) {
+            return;
+        }
+        finishResize();
+        m_old = m_current;
+        allocate(m_current, needed);
+        m_migrateGroup = 0;
+        finishResize();
+    }
+
+private:
+    static inline uint64_t hashKey(const uint64_t *key) {
+        uint64_t hash = 0;
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            hash = (hash ^ key[ii]) * 0x9E3779B97F4A7C15ULL;
+        } // FOR
+        // Fold the well-mixed high half of the product into the low bits
+        // that pick the control byte and the group
+        return (hash ^ (hash >> 32));
+    }
+
+    static inline int8_t controlByte(uint64_t hash) {
+        return (static_cast<int8_t>(hash & 0x7F));
+    }
+
+    /** Bit i is set if control byte i of the group equals value */
+    static inline uint32_t matchByte(const int8_t *group, int8_t value) {
+#ifdef __SSE2__
+        const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return (static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value)))));
+#else
+        uint32_t bits = 0;
+        for (int i = 0; i < INTSHASHTABLE_GROUP_SIZE; i++) {
+            bits |= static_cast<uint32_t>(group[i] == value) << i;
+        } // FOR
+        return (bits);
+#endif
+    }
+
+    /** Bit i is set if slot i of the group is EMPTY or DELETED */
+    static inline uint32_t matchFree(const int8_t *group) {
+#ifdef __SSE2__
+        const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return (static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmplt_epi8(control, _mm_set1_epi8(-1)))));
+#else
+        uint32_t bits = 0;
+        for (int i = 0; i < INTSHASHTABLE_GROUP_SIZE; i++) {
+            bits |= static_cast<uint32_t>(group[i] < -1) << i;
+        } // FOR
+        return (bits);
+#endif
+    }
+
+    static inline bool keyEquals(const Slot &slot, const uint64_t *key) {
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            if (slot.key[ii] != key[ii]) return (false);
+        } // FOR
+        return (true);
+    }
+
+    /**
+     * Visit the groups of the probe sequence for a hash. The triangular
+     * step visits every group once when the group count is a power of two.
+     */
+    static inline size_t firstGroup(const Table &table, uint64_t hash) {
+        return ((hash >> 7) & table.groupMask);
+    }
+
+    static Slot* findIn(const Table &table, const uint64_t *key, uint64_t hash) {
+        const int8_t h2 = controlByte(hash);
+        size_t group = firstGroup(table, hash);
+        for (size_t step = 0; step <= table.groupMask; ) {
+            const int8_t *control = table.control + (group * INTSHASHTABLE_GROUP_SIZE);
+            uint32_t matches = matchByte(control, h2);
+            while (matches != 0) {
+                const size_t index = (group * INTSHASHTABLE_GROUP_SIZE) + static_cast<size_t>(__builtin_ctz(matches));
+                if (keyEquals(table.slots[index], key)) {
+                    return (&table.slots[index]);
+                }
+                matches &= (matches - 1);
+            } // WHILE
+            if (matchByte(control, EMPTY) != 0) {
+                return (NULL);
+            }
+            group = (group + ++step) & table.groupMask;
+        } // FOR
+        return (NULL);
+    }
+
+    /**
+     * Put a key that is known not to be in the table into its first free
+     * slot. The caller makes sure that there is room.
+     */
+    static void insertInto(Table &table, const uint64_t *key, const void *value, uint64_t hash) {
+        size_t group = firstGroup(table, hash);
+        size_t step = 0;
+        uint32_t free = matchFree(table.control + (group * INTSHASHTABLE_GROUP_SIZE));
+        while (free == 0) {
+            group = (group + ++step) & table.groupMask;
+            free = matchFree(table.control + (group * INTSHASHTABLE_GROUP_SIZE));
+        } // WHILE
+        const size_t index = (group * INTSHASHTABLE_GROUP_SIZE) + static_cast<size_t>(__builtin_ctz(free));
+        if (table.control[index] == EMPTY) {
+            table.used++;
+        }
+        table.control[index] = controlByte(hash);
+        ::memcpy(table.slots[index].key, key, keySize * sizeof(uint64_t));
+        table.slots[index].value = value;
+        table.live++;
+    }
+
+    static bool eraseFrom(Table &table, const uint64_t *key, uint64_t hash) {
+        Slot *slot = findIn(table, key, hash);
+        if (slot == NULL) {
+            return (false);
+        }
+        const size_t index = static_cast<size_t>(slot - table.slots);
+        const int8_t *group = table.control + (index & ~static_cast<size_t>(INTSHASHTABLE_GROUP_SIZE - 1));
+        // If the group still has an EMPTY slot then no probe ever went past
+        // it, so the slot can become EMPTY instead of a tombstone
+        if (matchByte(group, EMPTY) != 0) {
+            table.control[index] = EMPTY;
+            table.used--;
+        } else {
+            table.control[index] = DELETED;
+        }
+        table.live--;
+        return (true);
+    }
+
+    void allocate(Table &table, size_t capacity) {
+        assert(capacity % INTSHASHTABLE_GROUP_SIZE == 0);
+        const size_t bytes = allocationSize(capacity);
+        table.memory = new char[bytes];
+        *m_memorySize += static_cast<int64_t>(bytes);
+
+        // control bytes first, aligned for the group loads, then the slots
+        uintptr_t start = reinterpret_cast<uintptr_t>(table.memory);
+        start = (start + 63) & ~static_cast<uintptr_t>(63);
+        table.control = reinterpret_cast<int8_t*>(start);
+        table.slots = reinterpret_cast<Slot*>(start + capacity);
+        ::memset(table.control, EMPTY, capacity);
+        table.capacity = capacity;
+        table.groupMask = (capacity / INTSHASHTABLE_GROUP_SIZE) - 1;
+        table.used = 0;
+        table.live = 0;
+    }
+
+    void release(Table &table) {
+        if (table.memory == NULL) return;
+        delete [] table.memory;
+        *m_memorySize -= static_cast<int64_t>(allocationSize(table.capacity));
+        ::memset(&table, 0, sizeof(Table));
+    }
+
+    static inline size_t allocationSize(size_t capacity) {
+        return (capacity + (capacity * sizeof(Slot)) + 64);
+    }
+
+    /**
+     * The current table is full: make it the old table and start moving
+     * its entries into a new one. The new table doubles in size, unless
+     * most of the used slots are tombstones.
+     */
+    void startResize() {
+        finishResize();
+        size_t capacity = m_current.capacity;
+        if (m_current.live * 2 >= m_current.capacity) {
+            capacity *= 2;
+        }
+        m_old = m_current;
+        allocate(m_current, capacity);
+        m_migrateGroup = 0;
+    }
+
+    void finishResize() {
+        if (m_old.memory != NULL) {
+            migrate(m_old.groupMask + 1);
+        }
+    }
+
+    void migrate(size_t groups) {
+        const size_t total = m_old.groupMask + 1;
+        for (size_t g = 0; g < groups && m_migrateGroup < total; g++, m_migrateGroup++) {
+            const size_t first = m_migrateGroup * INTSHASHTABLE_GROUP_SIZE;
+            for (size_t index = first; index < first + INTSHASHTABLE_GROUP_SIZE; index++) {
+                if (m_old.control[index] < 0) continue;
+                const Slot &slot = m_old.slots[index];
+                insertInto(m_current, slot.key, slot.value, hashKey(slot.key));
+                // A tombstone, so that probes for keys that have not been
+                // moved yet still run past this slot
+                m_old.control[index] = DELETED;
+                m_old.live--;
+            } // FOR
+        } // FOR
+        if (m_migrateGroup == total) {
+            assert(m_old.live == 0);
+            release(m_old);
+            m_migrateGroup = 0;
+        }
+    }
+
+    int64_t *m_memorySize;
+    Table m_current;
+    Table m_old;
+    size_t m_migrateGroup;
+};
+
+}
+
+#endif
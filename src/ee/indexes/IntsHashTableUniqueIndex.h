@@ -0,0 +1,176 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_INTSHASHTABLEUNIQUEINDEX_H
+#define HSTORE_INTSHASHTABLEUNIQUEINDEX_H
+
+#include <iostream>
+#include <vector>
+#include "common/debuglog.h"
+#include "common/tabletuple.h"
+#include "indexes/tableindex.h"
+#include "indexes/indexkey.h"
+#include "indexes/IntsHashTable.h"
+
+namespace voltdb {
+
+/**
+ * Unique hash index on integer-only keys (IntsKey) backed by a flat
+ * IntsHashTable instead of boost::unordered_map, so there is no heap node
+ * per entry and a lookup touches one group of control bytes and the slot.
+ * @see TableIndex
+ */
+template<std::size_t keySize>
+class IntsHashTableUniqueIndex : public TableIndex {
+    friend class TableIndexFactory;
+
+    typedef IntsHashTable<keySize> MapType;
+
+public:
+
+    ~IntsHashTableUniqueIndex() {
+        delete m_entries;
+    };
+
+    bool addEntry(const TableTuple *tuple) {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        return addEntryPrivate(tuple, m_tmp1);
+    }
+
+    bool deleteEntry(const TableTuple *tuple) {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        return deleteEntryPrivate(m_tmp1);
+    }
+
+    bool replaceEntry(const TableTuple *oldTupleValue, const TableTuple* newTupleValue) {
+        m_tmp1.setFromTuple(oldTupleValue, column_indices_, m_keySchema);
+        m_tmp2.setFromTuple(newTupleValue, column_indices_, m_keySchema);
+
+        if (m_eq(m_tmp1, m_tmp2)) return true; // no update is needed for this index
+
+        bool deleted = deleteEntryPrivate(m_tmp1);
+        bool inserted = addEntryPrivate(newTupleValue, m_tmp2);
+        --m_deletes;
+        --m_inserts;
+        ++m_updates;
+        return (deleted && inserted);
+    }
+
+    bool setEntryToNewAddress(const TableTuple *tuple, const void* address, const void *oldAddress) {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        ++m_updates;
+
+        // the slot is rewritten in place, so this never triggers a resize
+        return m_entries->update(m_tmp1.data, address);
+    }
+
+    bool checkForIndexChange(const TableTuple *lhs, const TableTuple *rhs) {
+        m_tmp1.setFromTuple(lhs, column_indices_, m_keySchema);
+        m_tmp2.setFromTuple(rhs, column_indices_, m_keySchema);
+        return !(m_eq(m_tmp1, m_tmp2));
+    }
+    bool exists(const TableTuple* values) {
+        ++m_lookups;
+        m_tmp1.setFromTuple(values, column_indices_, m_keySchema);
+        return (m_entries->find(m_tmp1.data) != NULL);
+    }
+    bool moveToKey(const TableTuple *searchKey) {
+        ++m_lookups;
+        m_tmp1.setFromKey(searchKey);
+        m_match.move(const_cast<void*>(m_entries->find(m_tmp1.data)));
+        return m_match.address() != NULL;
+    }
+    bool moveToTuple(const TableTuple *searchTuple) {
+        ++m_lookups;
+        m_tmp1.setFromTuple(searchTuple, column_indices_, m_keySchema);
+        m_match.move(const_cast<void*>(m_entries->find(m_tmp1.data)));
+        return m_match.address() != NULL;
+    }
+    void prefetchKeys(const TableTuple *searchKeys, int count) {
+        m_prefetchKeys.resize(static_cast<size_t>(count) * keySize);
+        for (int i = 0; i < count; i++) {
+            m_tmp1.setFromKey(&searchKeys[i]);
+            ::memcpy(&m_prefetchKeys[i * keySize], m_tmp1.data, sizeof(m_tmp1.data));
+        }
+        if (count > 0) {
+            m_entries->prefetch(&m_prefetchKeys[0], count);
+        }
+    }
+    TableTuple nextValueAtKey() {
+        TableTuple retval = m_match;
+        m_match.move(NULL);
+        return retval;
+    }
+
+    virtual void ensureCapacity(uint32_t capacity) {
+        m_entries->reserve(capacity);
+    }
+
+    size_t getSize() const { return m_entries->size(); }
+    int64_t getMemoryEstimate() const {
+        return m_memoryEstimate;
+    }
+    std::string getTypeName() const { return "IntsHashTableUniqueIndex"; };
+
+    // print out info about lookup usage
+    virtual void printReport() {
+        std::cout << "  Loadfactor: " << m_entries->loadFactor() << std::endl;
+    }
+
+protected:
+    IntsHashTableUniqueIndex(const TableIndexScheme &scheme) :
+        TableIndex(scheme),
+        m_eq(m_keySchema)
+    {
+        m_match = TableTuple(m_tupleSchema);
+        m_entries = new MapType(&m_memoryEstimate);
+    }
+
+    inline bool addEntryPrivate(const TableTuple *tuple, const IntsKey<keySize> &key) {
+        ++m_inserts;
+        return m_entries->insert(key.data, tuple->address());
+    }
+
+    inline bool deleteEntryPrivate(const IntsKey<keySize> &key) {
+        ++m_deletes;
+        return m_entries->erase(key.data);
+    }
+
+    MapType *m_entries;
+    IntsKey<keySize> m_tmp1;
+    IntsKey<keySize> m_tmp2;
+    // keys for prefetchKeys()
+    std::vector<uint64_t> m_prefetchKeys;
+
+    // iteration stuff
+    TableTuple m_match;
+
+    // comparison stuff
+    IntsEqualityChecker<keySize> m_eq;
+};
+
+}
+
+#endif // HSTORE_INTSHASHTABLEUNIQUEINDEX_H
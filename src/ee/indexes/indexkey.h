@@ -46,6 +46,7 @@
 #ifndef INDEXKEY_H
 #define INDEXKEY_H
 
+#include "common/ValueFactory.hpp"
 #include "common/ValuePeeker.hpp"
 #include "common/tabletuple.h"
 
@@ -294,6 +295,47 @@ public:
         }
     }
 
+    /*
+     * Inverse of setFromTuple. Sets the columns of the tuple that the key
+     * was built from to the values in the key.
+     */
+    inline void copyToTuple(TableTuple *tuple, const int *indices, const TupleSchema *keySchema) const {
+        const int columnCount = keySchema->columnCount();
+        int keyOffset = 0;
+        int intraKeyOffset = static_cast<int>(sizeof(uint64_t) - 1);
+        for (int ii = 0; ii < columnCount; ii++) {
+            switch(keySchema->columnType(ii)) {
+            case voltdb::VALUE_TYPE_BIGINT: {
+                const uint64_t keyValue = extractKeyValue<uint64_t>(keyOffset, intraKeyOffset);
+                tuple->setNValue(indices[ii], ValueFactory::getBigIntValue(
+                    convertUnsignedValueToSignedValue< int64_t, INT64_MAX>(keyValue)));
+                break;
+            }
+            case voltdb::VALUE_TYPE_INTEGER: {
+                const uint64_t keyValue = extractKeyValue<uint32_t>(keyOffset, intraKeyOffset);
+                tuple->setNValue(indices[ii], ValueFactory::getIntegerValue(
+                    convertUnsignedValueToSignedValue< int32_t, INT32_MAX>(keyValue)));
+                break;
+            }
+            case voltdb::VALUE_TYPE_SMALLINT: {
+                const uint64_t keyValue = extractKeyValue<uint16_t>(keyOffset, intraKeyOffset);
+                tuple->setNValue(indices[ii], ValueFactory::getSmallIntValue(
+                    convertUnsignedValueToSignedValue< int16_t, INT16_MAX>(keyValue)));
+                break;
+            }
+            case voltdb::VALUE_TYPE_TINYINT: {
+                const uint64_t keyValue = extractKeyValue<uint8_t>(keyOffset, intraKeyOffset);
+                tuple->setNValue(indices[ii], ValueFactory::getTinyIntValue(
+                    convertUnsignedValueToSignedValue< int8_t, INT8_MAX>(keyValue)));
+                break;
+            }
+            default:
+                throwFatalException( "We currently only support a specific set of column index sizes..." );
+                break;
+            }
+        }
+    }
+
     // actual location of data
     uint64_t data[keySize];
 
@@ -453,6 +495,506 @@ struct GenericHasher : std::unary_function<GenericKey<keySize>, std::size_t>
 };
 
 
+/*
+ * Normalized keys encode the columns of a key into bytes whose memcmp
+ * order is the order of the key values, so that comparing two keys costs
+ * a single memcmp whatever the mix of column types:
+ *
+ *  - integers and timestamps are stored big-endian with the sign bit
+ *    flipped (like IntsKey). NULL is the smallest value of the type, so it
+ *    already sorts first.
+ *  - doubles are stored big-endian with the sign bit flipped if positive
+ *    and all bits flipped if negative. -0.0 is stored as 0.0.
+ *  - decimals are stored as a 128-bit integer, like the integers.
+ *  - strings and varbinary start with 0x00 if NULL and 0x01 otherwise.
+ *    The bytes follow in groups of eight, each padded with zeros and
+ *    followed by a marker byte: 9 if more groups follow, otherwise the
+ *    number of bytes used in the group. This keeps a shorter string
+ *    ahead of a longer one that starts with the same bytes.
+ *
+ * Every column encoding is prefix-free, so the columns need no separator.
+ * A search key with fewer columns than the index leaves the rest of the
+ * key zeroed, which sorts before any value of the missing columns.
+ */
+class NormalizedKeyEncoder {
+public:
+    static const int32_t UNSUPPORTED = -1;
+
+    /**
+     * Return the length of the longest encoding of a key in the given key
+     * schema, or UNSUPPORTED if a column type cannot be encoded
+     */
+    static int32_t maxLength(const TupleSchema *keySchema) {
+        int32_t length = 0;
+        for (int ii = 0; ii < keySchema->columnCount(); ii++) {
+            switch (keySchema->columnType(ii)) {
+            case VALUE_TYPE_TINYINT:
+                length += 1;
+                break;
+            case VALUE_TYPE_SMALLINT:
+                length += 2;
+                break;
+            case VALUE_TYPE_INTEGER:
+                length += 4;
+                break;
+            case VALUE_TYPE_BIGINT:
+            case VALUE_TYPE_TIMESTAMP:
+            case VALUE_TYPE_DOUBLE:
+                length += 8;
+                break;
+            case VALUE_TYPE_DECIMAL:
+                length += 16;
+                break;
+            case VALUE_TYPE_VARCHAR:
+            case VALUE_TYPE_VARBINARY:
+                length += stringLength(keySchema->columnLength(ii));
+                break;
+            default:
+                return UNSUPPORTED;
+            }
+        }
+        return length;
+    }
+
+    /** Length of the encoding of one value */
+    static inline int32_t length(const NValue &value) {
+        switch (ValuePeeker::peekValueType(value)) {
+        case VALUE_TYPE_TINYINT:
+            return 1;
+        case VALUE_TYPE_SMALLINT:
+            return 2;
+        case VALUE_TYPE_INTEGER:
+            return 4;
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+        case VALUE_TYPE_DOUBLE:
+            return 8;
+        case VALUE_TYPE_DECIMAL:
+            return 16;
+        case VALUE_TYPE_VARCHAR:
+        case VALUE_TYPE_VARBINARY:
+            return (value.isNull() ? 1 : stringLength(ValuePeeker::peekObjectLength(value)));
+        default:
+            throwFatalException("Unsupported type '%d' for a normalized index key", ValuePeeker::peekValueType(value));
+        }
+    }
+
+    /**
+     * Write the encoding of the value at out and return the position right
+     * after it
+     */
+    static inline char* encode(char *out, const NValue &value) {
+        switch (ValuePeeker::peekValueType(value)) {
+        case VALUE_TYPE_TINYINT:
+            return putBigEndian(out, static_cast<uint8_t>(ValuePeeker::peekTinyInt(value)) ^ 0x80, 1);
+        case VALUE_TYPE_SMALLINT:
+            return putBigEndian(out, static_cast<uint16_t>(ValuePeeker::peekSmallInt(value)) ^ 0x8000, 2);
+        case VALUE_TYPE_INTEGER:
+            return putBigEndian(out, static_cast<uint32_t>(ValuePeeker::peekInteger(value)) ^ 0x80000000, 4);
+        case VALUE_TYPE_BIGINT:
+            return putBigEndian(out, static_cast<uint64_t>(ValuePeeker::peekBigInt(value)) ^ SIGN_BIT, 8);
+        case VALUE_TYPE_TIMESTAMP:
+            return putBigEndian(out, static_cast<uint64_t>(ValuePeeker::peekTimestamp(value)) ^ SIGN_BIT, 8);
+        case VALUE_TYPE_DOUBLE: {
+            double d = ValuePeeker::peekDouble(value);
+            if (d == 0.0) d = 0.0;
+            uint64_t bits;
+            ::memcpy(&bits, &d, sizeof(bits));
+            bits = ((bits & SIGN_BIT) ? ~bits : (bits ^ SIGN_BIT));
+            return putBigEndian(out, bits, 8);
+        }
+        case VALUE_TYPE_DECIMAL: {
+            const TTInt decimal = ValuePeeker::peekDecimal(value);
+            out = putBigEndian(out, static_cast<uint64_t>(decimal.table[1]) ^ SIGN_BIT, 8);
+            return putBigEndian(out, static_cast<uint64_t>(decimal.table[0]), 8);
+        }
+        case VALUE_TYPE_VARCHAR:
+        case VALUE_TYPE_VARBINARY: {
+            if (value.isNull()) {
+                *out++ = 0;
+                return out;
+            }
+            *out++ = 1;
+            const char *bytes = reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(value));
+            int32_t remaining = ValuePeeker::peekObjectLength(value);
+            do {
+                const int32_t count = (remaining < 8 ? remaining : 8);
+                ::memcpy(out, bytes, count);
+                ::memset(out + count, 0, 8 - count);
+                bytes += count;
+                remaining -= count;
+                out[8] = static_cast<char>(remaining > 0 ? 9 : count);
+                out += 9;
+            } while (remaining > 0);
+            return out;
+        }
+        default:
+            throwFatalException("Unsupported type '%d' for a normalized index key", ValuePeeker::peekValueType(value));
+        }
+    }
+
+    /**
+     * Return true if decode() can read back every column of the given
+     * schema. Only the fixed-width numeric encodings can be reversed
+     * without an allocation.
+     */
+    static bool decodable(const TupleSchema *schema) {
+        for (int ii = 0; ii < schema->columnCount(); ii++) {
+            switch (schema->columnType(ii)) {
+            case VALUE_TYPE_TINYINT:
+            case VALUE_TYPE_SMALLINT:
+            case VALUE_TYPE_INTEGER:
+            case VALUE_TYPE_BIGINT:
+            case VALUE_TYPE_TIMESTAMP:
+            case VALUE_TYPE_DOUBLE:
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Inverse of encode() for the types accepted by decodable(). Reads the
+     * value of the given type at in and returns the position right after it.
+     */
+    static inline const char* decode(const char *in, ValueType type, NValue *value) {
+        switch (type) {
+        case VALUE_TYPE_TINYINT:
+            *value = ValueFactory::getTinyIntValue(static_cast<int8_t>(getBigEndian(in, 1) ^ 0x80));
+            return in + 1;
+        case VALUE_TYPE_SMALLINT:
+            *value = ValueFactory::getSmallIntValue(static_cast<int16_t>(getBigEndian(in, 2) ^ 0x8000));
+            return in + 2;
+        case VALUE_TYPE_INTEGER:
+            *value = ValueFactory::getIntegerValue(static_cast<int32_t>(getBigEndian(in, 4) ^ 0x80000000));
+            return in + 4;
+        case VALUE_TYPE_BIGINT:
+            *value = ValueFactory::getBigIntValue(static_cast<int64_t>(getBigEndian(in, 8) ^ SIGN_BIT));
+            return in + 8;
+        case VALUE_TYPE_TIMESTAMP:
+            *value = ValueFactory::getTimestampValue(static_cast<int64_t>(getBigEndian(in, 8) ^ SIGN_BIT));
+            return in + 8;
+        case VALUE_TYPE_DOUBLE: {
+            uint64_t bits = getBigEndian(in, 8);
+            bits = ((bits & SIGN_BIT) ? (bits ^ SIGN_BIT) : ~bits);
+            double d;
+            ::memcpy(&d, &bits, sizeof(d));
+            *value = ValueFactory::getDoubleValue(d);
+            return in + 8;
+        }
+        default:
+            throwFatalException("Unsupported type '%d' for decoding a normalized index key", type);
+        }
+    }
+
+    /**
+     * Decode the columns of the schema, which are encoded one after the
+     * other at in, into the given columns of the tuple
+     */
+    static inline void decodeToTuple(const char *in, TableTuple *tuple, const int *indices,
+                                     const TupleSchema *schema) {
+        NValue value;
+        for (int ii = 0; ii < schema->columnCount(); ii++) {
+            in = decode(in, schema->columnType(ii), &value);
+            tuple->setNValue(indices[ii], value);
+        }
+    }
+
+private:
+    static const uint64_t SIGN_BIT = 0x8000000000000000ULL;
+
+    static inline uint64_t getBigEndian(const char *in, int bytes) {
+        uint64_t value = 0;
+        for (int ii = 0; ii < bytes; ii++) {
+            value = (value << 8) | static_cast<uint8_t>(in[ii]);
+        }
+        return value;
+    }
+
+    static inline int32_t stringLength(int32_t length) {
+        return (1 + 9 * (length > 8 ? (length + 7) / 8 : 1));
+    }
+
+    static inline char* putBigEndian(char *out, uint64_t value, int bytes) {
+        for (int ii = bytes - 1; ii >= 0; ii--) {
+            *out++ = static_cast<char>(value >> (ii * 8));
+        }
+        return out;
+    }
+};
+
+/**
+ * Index key of any column types that fits in keySize bytes when
+ * normalized. The unused bytes at the end are zero.
+ */
+template <std::size_t keySize>
+class NormalizedKey {
+public:
+    inline void setFromKey(const TableTuple *tuple) {
+        assert(tuple);
+        const int columnCount = tuple->getSchema()->columnCount();
+        char *out = data;
+        for (int ii = 0; ii < columnCount; ii++) {
+            out = NormalizedKeyEncoder::encode(out, tuple->getNValue(ii));
+        }
+        assert(out <= data + keySize);
+        ::memset(out, 0, keySize - static_cast<std::size_t>(out - data));
+    }
+
+    inline void setFromTuple(const TableTuple *tuple, const int *indices, const TupleSchema *keySchema) {
+        const int columnCount = keySchema->columnCount();
+        char *out = data;
+        for (int ii = 0; ii < columnCount; ii++) {
+            out = NormalizedKeyEncoder::encode(out, tuple->getNValue(indices[ii]));
+        }
+        assert(out <= data + keySize);
+        ::memset(out, 0, keySize - static_cast<std::size_t>(out - data));
+    }
+
+    /**
+     * Encode the included columns of an index behind the key, at offset
+     * (the longest encoding of the key columns). The comparators only
+     * look at the bytes before the offset, so these values are carried
+     * along without being part of the key. Call after setFromTuple().
+     */
+    inline void setIncludedValues(const TableTuple *tuple, const int *indices,
+                                  const TupleSchema *includeSchema, int32_t offset) {
+        char *out = data + offset;
+        for (int ii = 0; ii < includeSchema->columnCount(); ii++) {
+            out = NormalizedKeyEncoder::encode(out, tuple->getNValue(indices[ii]));
+        }
+        assert(out <= data + keySize);
+    }
+
+    /**
+     * Inverse of setFromTuple() (offset 0) and setIncludedValues() for
+     * decodable schemas
+     */
+    inline void copyToTuple(TableTuple *tuple, const int *indices,
+                            const TupleSchema *schema, int32_t offset) const {
+        NormalizedKeyEncoder::decodeToTuple(data + offset, tuple, indices, schema);
+    }
+
+    char data[keySize];
+};
+
+/**
+ * Compares the first maxLength(keySchema) bytes, which hold the key
+ * columns. Anything behind them is the included columns.
+ */
+template <std::size_t keySize>
+class NormalizedComparator {
+public:
+    NormalizedComparator(TupleSchema *keySchema) :
+        m_length(NormalizedKeyEncoder::maxLength(keySchema)) {}
+
+    inline bool operator()(const NormalizedKey<keySize> &lhs, const NormalizedKey<keySize> &rhs) const {
+        return ::memcmp(lhs.data, rhs.data, m_length) < 0;
+    }
+
+    std::size_t m_length;
+};
+
+template <std::size_t keySize>
+class NormalizedEqualityChecker {
+public:
+    NormalizedEqualityChecker(TupleSchema *keySchema) :
+        m_length(NormalizedKeyEncoder::maxLength(keySchema)) {}
+
+    inline bool operator()(const NormalizedKey<keySize> &lhs, const NormalizedKey<keySize> &rhs) const {
+        return ::memcmp(lhs.data, rhs.data, m_length) == 0;
+    }
+
+    std::size_t m_length;
+};
+
+#define NORMALIZED_KEY_PREFIX_LENGTH 48
+
+/**
+ * Normalized key for key schemas whose encoding can be longer than the
+ * largest fixed-size NormalizedKey (long strings). The first
+ * NORMALIZED_KEY_PREFIX_LENGTH bytes are kept inline, so most comparisons
+ * still end in one memcmp. A longer encoding is also copied in full to a
+ * buffer owned by the key, which is only read when the prefixes are equal.
+ * The buffers are counted in the memory estimate of the index, see
+ * trackMemory().
+ */
+class NormalizedOverflowKey {
+public:
+    NormalizedOverflowKey() : m_length(0), m_capacity(0), m_overflow(NULL), m_memory(NULL) {
+        ::memset(m_prefix, 0, NORMALIZED_KEY_PREFIX_LENGTH);
+    }
+
+    NormalizedOverflowKey(const NormalizedOverflowKey &other) :
+        m_length(0), m_capacity(0), m_overflow(NULL), m_memory(other.m_memory) {
+        assign(other);
+    }
+
+    ~NormalizedOverflowKey() {
+        release();
+    }
+
+    /**
+     * Add the bytes of the overflow buffers of this key, and of every key
+     * copied from it, to the given counter for as long as they are held
+     */
+    inline void trackMemory(int64_t *memory) {
+        assert(m_overflow == NULL);
+        m_memory = memory;
+    }
+
+    NormalizedOverflowKey& operator=(const NormalizedOverflowKey &other) {
+        if (this != &other) assign(other);
+        return *this;
+    }
+
+    inline void setFromKey(const TableTuple *tuple) {
+        assert(tuple);
+        const int columnCount = tuple->getSchema()->columnCount();
+        int32_t length = 0;
+        for (int ii = 0; ii < columnCount; ii++) {
+            length += NormalizedKeyEncoder::length(tuple->getNValue(ii));
+        }
+        char *out = reset(length);
+        for (int ii = 0; ii < columnCount; ii++) {
+            out = NormalizedKeyEncoder::encode(out, tuple->getNValue(ii));
+        }
+        finish();
+    }
+
+    inline void setFromTuple(const TableTuple *tuple, const int *indices, const TupleSchema *keySchema) {
+        const int columnCount = keySchema->columnCount();
+        int32_t length = 0;
+        for (int ii = 0; ii < columnCount; ii++) {
+            length += NormalizedKeyEncoder::length(tuple->getNValue(indices[ii]));
+        }
+        char *out = reset(length);
+        for (int ii = 0; ii < columnCount; ii++) {
+            out = NormalizedKeyEncoder::encode(out, tuple->getNValue(indices[ii]));
+        }
+        finish();
+    }
+
+    /** Included columns need a fixed-size key, see TableIndexFactory */
+    inline void setIncludedValues(const TableTuple *tuple, const int *indices,
+                                  const TupleSchema *includeSchema, int32_t offset) {
+        throwFatalException("Included columns are not supported for normalized keys this long");
+    }
+
+    inline void copyToTuple(TableTuple *tuple, const int *indices,
+                            const TupleSchema *schema, int32_t offset) const {
+        const char *in = (m_length > NORMALIZED_KEY_PREFIX_LENGTH ? m_overflow : m_prefix);
+        NormalizedKeyEncoder::decodeToTuple(in + offset, tuple, indices, schema);
+    }
+
+    /** memcmp-style comparison of the full encodings */
+    inline int compare(const NormalizedOverflowKey &other) const {
+        int diff = ::memcmp(m_prefix, other.m_prefix, NORMALIZED_KEY_PREFIX_LENGTH);
+        if (diff != 0 || (m_length <= NORMALIZED_KEY_PREFIX_LENGTH &&
+                          other.m_length <= NORMALIZED_KEY_PREFIX_LENGTH)) {
+            return diff;
+        }
+        const uint32_t common = (m_length < other.m_length ? m_length : other.m_length);
+        if (common > NORMALIZED_KEY_PREFIX_LENGTH) {
+            diff = ::memcmp(m_overflow + NORMALIZED_KEY_PREFIX_LENGTH,
+                            other.m_overflow + NORMALIZED_KEY_PREFIX_LENGTH,
+                            common - NORMALIZED_KEY_PREFIX_LENGTH);
+            if (diff != 0) return diff;
+        }
+        return (m_length < other.m_length ? -1 : (m_length > other.m_length ? 1 : 0));
+    }
+
+private:
+    /** Return where the encoding of a key of the given length goes */
+    inline char* reset(int32_t length) {
+        m_length = static_cast<uint32_t>(length);
+        if (m_length <= NORMALIZED_KEY_PREFIX_LENGTH) {
+            ::memset(m_prefix, 0, NORMALIZED_KEY_PREFIX_LENGTH);
+            return m_prefix;
+        }
+        reserve(m_length);
+        return m_overflow;
+    }
+
+    inline void finish() {
+        if (m_length > NORMALIZED_KEY_PREFIX_LENGTH) {
+            ::memcpy(m_prefix, m_overflow, NORMALIZED_KEY_PREFIX_LENGTH);
+        }
+    }
+
+    inline void reserve(uint32_t length) {
+        if (m_capacity < length) {
+            release();
+            m_overflow = new char[length];
+            m_capacity = length;
+            if (m_memory != NULL) *m_memory += length;
+        }
+    }
+
+    inline void release() {
+        if (m_overflow != NULL) {
+            delete [] m_overflow;
+            m_overflow = NULL;
+            if (m_memory != NULL) *m_memory -= m_capacity;
+            m_capacity = 0;
+        }
+    }
+
+    inline void assign(const NormalizedOverflowKey &other) {
+        // an empty slot in the index's nodes takes on the counter of the
+        // keys that are copied into it
+        if (m_memory == NULL) {
+            assert(m_overflow == NULL);
+            m_memory = other.m_memory;
+        }
+        ::memcpy(m_prefix, other.m_prefix, NORMALIZED_KEY_PREFIX_LENGTH);
+        m_length = other.m_length;
+        if (m_length > NORMALIZED_KEY_PREFIX_LENGTH) {
+            reserve(m_length);
+            ::memcpy(m_overflow, other.m_overflow, m_length);
+        }
+    }
+
+    char m_prefix[NORMALIZED_KEY_PREFIX_LENGTH];
+    uint32_t m_length;
+    uint32_t m_capacity;
+    // the whole encoding, only if it is longer than the prefix
+    char *m_overflow;
+    // where the bytes of m_overflow are counted, if anywhere
+    int64_t *m_memory;
+};
+
+/**
+ * Count the heap memory that keys copied from the given key hold in the
+ * given counter. Only NormalizedOverflowKeys hold any.
+ */
+template <typename KeyType>
+inline void trackKeyMemory(KeyType &key, int64_t *memory) {}
+
+inline void trackKeyMemory(NormalizedOverflowKey &key, int64_t *memory) {
+    key.trackMemory(memory);
+}
+
+class NormalizedOverflowComparator {
+public:
+    NormalizedOverflowComparator(TupleSchema *keySchema) {}
+
+    inline bool operator()(const NormalizedOverflowKey &lhs, const NormalizedOverflowKey &rhs) const {
+        return lhs.compare(rhs) < 0;
+    }
+};
+
+class NormalizedOverflowEqualityChecker {
+public:
+    NormalizedOverflowEqualityChecker(TupleSchema *keySchema) {}
+
+    inline bool operator()(const NormalizedOverflowKey &lhs, const NormalizedOverflowKey &rhs) const {
+        return lhs.compare(rhs) == 0;
+    }
+};
+
 /*
  * TupleKey is the all-purpose fallback key for indexes that can't be
  * better specialized. Each TupleKey wraps a pointer to a *persistent
@@ -65,6 +65,13 @@ TableIndex::TableIndex(const TableIndexScheme &scheme) : m_scheme(scheme), m_sta
         column_types_[i] = column_types_vector_[i];
     }
     m_keySchema = scheme.keySchema;
+    m_includeColumnsVector = scheme.includeColumns;
+    m_includeColumns = new int[m_includeColumnsVector.size() + 1];
+    for (size_t i = 0; i < m_includeColumnsVector.size(); ++i)
+    {
+        m_includeColumns[i] = m_includeColumnsVector[i];
+    }
+    m_includeSchema = scheme.includeSchema;
     // initialize all the counters to zero
     m_lookups = m_inserts = m_deletes = m_updates = 0;
 
@@ -80,7 +87,44 @@ TableIndex::~TableIndex()
 
     delete[] column_indices_;
     delete[] column_types_;
+    delete[] m_includeColumns;
     voltdb::TupleSchema::freeTupleSchema(m_keySchema);
+    if (m_includeSchema != NULL) {
+        voltdb::TupleSchema::freeTupleSchema(m_includeSchema);
+    }
+}
+
+bool TableIndex::coversColumn(int columnIndex) const
+{
+    for (int i = 0; i < colCount_; ++i) {
+        if (column_indices_[i] == columnIndex) return true;
+    }
+    for (size_t i = 0; i < m_includeColumnsVector.size(); ++i) {
+        if (m_includeColumns[i] == columnIndex) return true;
+    }
+    return false;
+}
+
+bool TableIndex::includedValuesChanged(const TableTuple *lhs, const TableTuple *rhs) const
+{
+    for (size_t i = 0; i < m_includeColumnsVector.size(); ++i) {
+        if (lhs->getNValue(m_includeColumns[i]).compare(rhs->getNValue(m_includeColumns[i])) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TableIndex::addEntries(const std::vector<const void*> &tuples)
+{
+    ensureCapacity(static_cast<uint32_t>(getSize() + tuples.size()));
+    TableTuple tuple(m_tupleSchema);
+    bool success = true;
+    for (size_t i = 0; i < tuples.size(); i++) {
+        tuple.move(const_cast<void*>(tuples[i]));
+        success = addEntry(&tuple) && success;
+    }
+    return success;
 }
 
 IndexStats* TableIndex::getIndexStats() {
@@ -65,7 +65,7 @@ namespace voltdb {
  */
 struct TableIndexScheme {
     TableIndexScheme() {
-        tupleSchema = keySchema = NULL;
+        tupleSchema = keySchema = includeSchema = NULL;
     }
     TableIndexScheme(std::string name, TableIndexType type, std::vector<int32_t> columnIndices,
                      std::vector<ValueType> columnTypes, bool unique, bool intsOnly,
@@ -73,6 +73,7 @@ struct TableIndexScheme {
         this->name = name; this->type = type; this->columnIndices = columnIndices;
         this->columnTypes = columnTypes; this->unique = unique; this->intsOnly = intsOnly;
         this->tupleSchema = tupleSchema; this->keySchema = NULL;
+        this->includeSchema = NULL;
     }
 
     std::string name;
@@ -83,6 +84,11 @@ struct TableIndexScheme {
     bool intsOnly;
     TupleSchema *tupleSchema;
     TupleSchema *keySchema;
+    // INCLUDE columns: stored in the entries next to the key, so that a
+    // scan that reads them doesn't need the tuple, but not part of the
+    // key. Only tree indexes keep them, see TableIndexFactory.
+    std::vector<int32_t> includeColumns;
+    TupleSchema *includeSchema;
 
 public:
     void setTree() {
@@ -132,6 +138,16 @@ public:
      */
     virtual bool addEntry(const TableTuple *tuple) = 0;
 
+    /**
+     * adds index entries for a batch of tuples, given by their addresses,
+     * as done when a table is bulk loaded. Tree indexes that are still
+     * empty override this to sort the keys once and build the tree bottom
+     * up. The default just calls addEntry() for each tuple.
+     *
+     * @return false if any of the entries could not be added
+     */
+    virtual bool addEntries(const std::vector<const void*> &tuples);
+
     /**
      * removes the index entry linked to given value (and tuple
      * pointer, if it's non-unique index).
@@ -240,6 +256,20 @@ public:
         throwFatalException("Invoked TableIndex virtual method moveToGreaterThanKey which has no implementation");
     };
 
+    /**
+     * Hint that moveToKey(), moveToKeyOrGreater() or moveToGreaterThanKey()
+     * will soon be called with each of the given search keys, like a join
+     * that probes the index for a batch of outer tuples does. An index
+     * that can find the memory of a lookup cheaply starts loading it for
+     * all the keys at once, so that the cache misses of the probes
+     * overlap. The default does nothing.
+     *
+     * @see searchKeys count search keys in this index's entry order
+     */
+    virtual void prefetchKeys(const TableTuple *searchKeys, int count)
+    {
+    }
+
     /**
      * This method moves to the beginning or the end of the indexes.
      * Use this with nextValue().
@@ -264,9 +294,31 @@ public:
         throwFatalException("Invoked TableIndex virtual method nextValue which has no implementation");
     };
 
+    /**
+     * Whether copyCoveredValues() is supported, so that a scan which only
+     * needs the key and included columns can be answered from the index
+     * entries without touching the tuples.
+     */
+    virtual bool supportsCoveringReads() const
+    {
+        return false;
+    }
+
+    /**
+     * Sets the key and included columns of the given tuple, which has the
+     * schema of the table, to the values in the entry that was returned
+     * last by nextValue() or nextValueAtKey(). The other columns are left
+     * untouched.
+     */
+    virtual void copyCoveredValues(TableTuple *tuple) const
+    {
+        throwFatalException("Invoked TableIndex virtual method copyCoveredValues which has no implementation");
+    }
+
     /**
      * @return true if lhs is different from rhs in this index, which
-     * means replaceEntry has to follow.
+     * means replaceEntry has to follow. Only the key columns count, a
+     * change of the included columns is picked up by replaceEntry.
      */
     virtual bool checkForIndexChange(const TableTuple *lhs,
                                      const TableTuple *rhs) = 0;
@@ -306,6 +358,16 @@ public:
         return m_keySchema;
     }
 
+    const std::vector<int>& getIncludedColumnIndices() const {
+        return m_includeColumnsVector;
+    }
+
+    /**
+     * @return true if the column of the table is a key or included
+     * column of this index
+     */
+    bool coversColumn(int columnIndex) const;
+
     virtual std::string debug() const;
     virtual std::string getTypeName() const = 0;
 
@@ -326,6 +388,9 @@ public:
 protected:
     TableIndex(const TableIndexScheme &scheme);
 
+    /** @return true if an included column differs between lhs and rhs */
+    bool includedValuesChanged(const TableTuple *lhs, const TableTuple *rhs) const;
+
     const TableIndexScheme m_scheme;
     TupleSchema* m_keySchema;
     std::string name_;
@@ -336,6 +401,11 @@ protected:
     bool is_unique_index_;
     int* column_indices_;
 
+    // INCLUDE columns, m_includeSchema is NULL if there are none
+    std::vector<int> m_includeColumnsVector;
+    int* m_includeColumns;
+    TupleSchema* m_includeSchema;
+
     // counters
     int m_lookups;
     int m_inserts;
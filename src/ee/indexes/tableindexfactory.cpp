@@ -55,6 +55,9 @@
 #include "indexes/BinaryTreeMultiMapIndex.h"
 #include "indexes/HashTableUniqueIndex.h"
 #include "indexes/HashTableMultiMapIndex.h"
+#include "indexes/IntsBTreeIndex.h"
+#include "indexes/IntsHashTableUniqueIndex.h"
+#include "indexes/ArtIndex.h"
 
 namespace voltdb {
 
@@ -82,6 +85,27 @@ namespace voltdb {
         if (keySize > sizeof(int64_t) * 4) {
             ints_only = false;
         }
+
+        // INCLUDE columns are encoded behind the key of a normalized tree
+        // index, so that they can be read back without the tuple
+        if (scheme.includeColumns.empty() == false) {
+            std::vector<voltdb::ValueType> includeColumnTypes;
+            std::vector<int32_t> includeColumnLengths;
+            std::vector<bool> includeColumnAllowNull(scheme.includeColumns.size(), true);
+            for (size_t i = 0; i < scheme.includeColumns.size(); ++i) {
+                includeColumnTypes.push_back(tupleSchema->columnType(scheme.includeColumns[i]));
+                includeColumnLengths.push_back(tupleSchema->columnLength(scheme.includeColumns[i]));
+            }
+            schemeCopy.includeSchema = voltdb::TupleSchema::createTupleSchema(includeColumnTypes, includeColumnLengths,
+                                                                                includeColumnAllowNull, true);
+            if (NormalizedKeyEncoder::decodable(schemeCopy.includeSchema) == false) {
+                voltdb::TupleSchema::freeTupleSchema(schemeCopy.includeSchema);
+                voltdb::TupleSchema::freeTupleSchema(keySchema);
+                throwFatalException("Index %s can only include integer, timestamp and float columns",
+                                    scheme.name.c_str());
+            }
+            ints_only = false;
+        }
         
         // a bit of a hack, this should be improved later
         if ((ints_only) && (unique) && (type == ARRAY_INDEX)) {
@@ -89,13 +113,13 @@ namespace voltdb {
         }
         if ((ints_only) && (type == BALANCED_TREE_INDEX) && (unique)) {
             if (keySize <= sizeof(uint64_t)) {
-                return new BinaryTreeUniqueIndex<IntsKey<1>, IntsComparator<1>, IntsEqualityChecker<1> >(schemeCopy);
+                return new IntsBTreeIndex<1, true>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 2) {
-                return new BinaryTreeUniqueIndex<IntsKey<2>, IntsComparator<2>, IntsEqualityChecker<2> >(schemeCopy);
+                return new IntsBTreeIndex<2, true>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 3) {
-                return new BinaryTreeUniqueIndex<IntsKey<3>, IntsComparator<3>, IntsEqualityChecker<3> >(schemeCopy);
+                return new IntsBTreeIndex<3, true>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 4) {
-                return new BinaryTreeUniqueIndex<IntsKey<4>, IntsComparator<4>, IntsEqualityChecker<4> >(schemeCopy);
+                return new IntsBTreeIndex<4, true>(schemeCopy);
             } else {
                 throwFatalException("We currently only support tree index on unique integer keys of size 32 bytes or smaller...");
             }
@@ -103,13 +127,13 @@ namespace voltdb {
 
         if ((ints_only) && (type == BALANCED_TREE_INDEX) && (!unique)) {
             if (keySize <= sizeof(uint64_t)) {
-                return new BinaryTreeMultiMapIndex<IntsKey<1>, IntsComparator<1>, IntsEqualityChecker<1> >(schemeCopy);
+                return new IntsBTreeIndex<1, false>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 2) {
-                return new BinaryTreeMultiMapIndex<IntsKey<2>, IntsComparator<2>, IntsEqualityChecker<2> >(schemeCopy);
+                return new IntsBTreeIndex<2, false>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 3) {
-                return new BinaryTreeMultiMapIndex<IntsKey<3>, IntsComparator<3>, IntsEqualityChecker<3> >(schemeCopy);
+                return new IntsBTreeIndex<3, false>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 4) {
-                return new BinaryTreeMultiMapIndex<IntsKey<4>, IntsComparator<4>, IntsEqualityChecker<4> >(schemeCopy);
+                return new IntsBTreeIndex<4, false>(schemeCopy);
             } else {
                 throwFatalException( "We currently only support tree index on non-unique integer keys of size 32 bytes or smaller..." );
             }
@@ -117,13 +141,13 @@ namespace voltdb {
         
         if ((ints_only) && (type == HASH_TABLE_INDEX) && (unique)) {
             if (keySize <= sizeof(uint64_t)) {
-                return new HashTableUniqueIndex<IntsKey<1>, IntsHasher<1>, IntsEqualityChecker<1> >(schemeCopy);
+                return new IntsHashTableUniqueIndex<1>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 2) {
-                return new HashTableUniqueIndex<IntsKey<2>, IntsHasher<2>, IntsEqualityChecker<2> >(schemeCopy);
+                return new IntsHashTableUniqueIndex<2>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 3) {
-                return new HashTableUniqueIndex<IntsKey<3>, IntsHasher<3>, IntsEqualityChecker<3> >(schemeCopy);
+                return new IntsHashTableUniqueIndex<3>(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 4) {
-                return new HashTableUniqueIndex<IntsKey<4>, IntsHasher<4>, IntsEqualityChecker<4> >(schemeCopy);
+                return new IntsHashTableUniqueIndex<4>(schemeCopy);
             } else {
                 throwFatalException( "We currently only support hash index on unique integer keys of size 32 bytes or smaller..." );
             }
@@ -143,6 +167,32 @@ namespace voltdb {
             }
         }
         
+        // everything else is compared through a normalized (memcmp) key
+        // that is as small as the longest possible key in this schema
+        int32_t normalizedLength = NormalizedKeyEncoder::maxLength(keySchema);
+        if (normalizedLength == NormalizedKeyEncoder::UNSUPPORTED) {
+            throwFatalException("Unsupported column type in the key of index %s", scheme.name.c_str());
+        }
+        if (schemeCopy.includeSchema != NULL) {
+            const int32_t includeLength = NormalizedKeyEncoder::maxLength(schemeCopy.includeSchema);
+            if (type == RADIX_TREE_INDEX || normalizedLength + includeLength > 256) {
+                VOLT_INFO("Not including columns in index %s: only supported for tree indexes "
+                          "with keys of 256 bytes or less", scheme.name.c_str());
+                voltdb::TupleSchema::freeTupleSchema(schemeCopy.includeSchema);
+                schemeCopy.includeSchema = NULL;
+                schemeCopy.includeColumns.clear();
+            } else {
+                normalizedLength += includeLength;
+            }
+        }
+
+        if (type == RADIX_TREE_INDEX) {
+            if (unique) {
+                return new ArtIndex<true>(schemeCopy);
+            }
+            return new ArtIndex<false>(schemeCopy);
+        }
+
         if (/*(type == BALANCED_TREE_INDEX) &&*/ (unique)) {
             if (type == HASH_TABLE_INDEX) {
                 VOLT_INFO("Producing a tree index for %s: "
@@ -150,34 +200,18 @@ namespace voltdb {
                           scheme.name.c_str());
             }
             
-            if (keySize <= 4) {
-                return new BinaryTreeUniqueIndex<GenericKey<4>, GenericComparator<4>, GenericEqualityChecker<4> >(schemeCopy);
-            } else if (keySize <= 8) {
-                return new BinaryTreeUniqueIndex<GenericKey<8>, GenericComparator<8>, GenericEqualityChecker<8> >(schemeCopy);
-            } else if (keySize <= 12) {
-                return new BinaryTreeUniqueIndex<GenericKey<12>, GenericComparator<12>, GenericEqualityChecker<12> >(schemeCopy);
-            } else if (keySize <= 16) {
-                return new BinaryTreeUniqueIndex<GenericKey<16>, GenericComparator<16>, GenericEqualityChecker<16> >(schemeCopy);
-            } else if (keySize <= 24) {
-                return new BinaryTreeUniqueIndex<GenericKey<24>, GenericComparator<24>, GenericEqualityChecker<24> >(schemeCopy);
-            } else if (keySize <= 32) {
-                return new BinaryTreeUniqueIndex<GenericKey<32>, GenericComparator<32>, GenericEqualityChecker<32> >(schemeCopy);
-            } else if (keySize <= 48) {
-                return new BinaryTreeUniqueIndex<GenericKey<48>, GenericComparator<48>, GenericEqualityChecker<48> >(schemeCopy);
-            } else if (keySize <= 64) {
-                return new BinaryTreeUniqueIndex<GenericKey<64>, GenericComparator<64>, GenericEqualityChecker<64> >(schemeCopy);
-            } else if (keySize <= 96) {
-                return new BinaryTreeUniqueIndex<GenericKey<96>, GenericComparator<96>, GenericEqualityChecker<96> >(schemeCopy);
-            } else if (keySize <= 128) {
-                return new BinaryTreeUniqueIndex<GenericKey<128>, GenericComparator<128>, GenericEqualityChecker<128> >(schemeCopy);
-            } else if (keySize <= 256) {
-                return new BinaryTreeUniqueIndex<GenericKey<256>, GenericComparator<256>, GenericEqualityChecker<256> >(schemeCopy);
-            } else if (keySize <= 512) {
-                return new BinaryTreeUniqueIndex<GenericKey<512>, GenericComparator<512>, GenericEqualityChecker<512> >(schemeCopy);
+            if (normalizedLength <= 16) {
+                return new BinaryTreeUniqueIndex<NormalizedKey<16>, NormalizedComparator<16>, NormalizedEqualityChecker<16> >(schemeCopy);
+            } else if (normalizedLength <= 32) {
+                return new BinaryTreeUniqueIndex<NormalizedKey<32>, NormalizedComparator<32>, NormalizedEqualityChecker<32> >(schemeCopy);
+            } else if (normalizedLength <= 64) {
+                return new BinaryTreeUniqueIndex<NormalizedKey<64>, NormalizedComparator<64>, NormalizedEqualityChecker<64> >(schemeCopy);
+            } else if (normalizedLength <= 128) {
+                return new BinaryTreeUniqueIndex<NormalizedKey<128>, NormalizedComparator<128>, NormalizedEqualityChecker<128> >(schemeCopy);
+            } else if (normalizedLength <= 256) {
+                return new BinaryTreeUniqueIndex<NormalizedKey<256>, NormalizedComparator<256>, NormalizedEqualityChecker<256> >(schemeCopy);
             } else {
-                throwFatalException( "We currently only support keys of up to 512 bytes when anti-caching is enabled..." );
-                
-                //return new BinaryTreeUniqueIndex<TupleKey, TupleKeyComparator, TupleKeyEqualityChecker>(schemeCopy);
+                return new BinaryTreeUniqueIndex<NormalizedOverflowKey, NormalizedOverflowComparator, NormalizedOverflowEqualityChecker>(schemeCopy);
             }
         }
         
@@ -188,34 +222,18 @@ namespace voltdb {
                           scheme.name.c_str());
             }
             
-            if (keySize <= 4) {
-                return new BinaryTreeMultiMapIndex<GenericKey<4>, GenericComparator<4>, GenericEqualityChecker<4> >(schemeCopy);
-            } else if (keySize <= 8) {
-                return new BinaryTreeMultiMapIndex<GenericKey<8>, GenericComparator<8>, GenericEqualityChecker<8> >(schemeCopy);
-            } else if (keySize <= 12) {
-                return new BinaryTreeMultiMapIndex<GenericKey<12>, GenericComparator<12>, GenericEqualityChecker<12> >(schemeCopy);
-            } else if (keySize <= 16) {
-                return new BinaryTreeMultiMapIndex<GenericKey<16>, GenericComparator<16>, GenericEqualityChecker<16> >(schemeCopy);
-            } else if (keySize <= 24) {
-                return new BinaryTreeMultiMapIndex<GenericKey<24>, GenericComparator<24>, GenericEqualityChecker<24> >(schemeCopy);
-            } else if (keySize <= 32) {
-                return new BinaryTreeMultiMapIndex<GenericKey<32>, GenericComparator<32>, GenericEqualityChecker<32> >(schemeCopy);
-            } else if (keySize <= 48) {
-                return new BinaryTreeMultiMapIndex<GenericKey<48>, GenericComparator<48>, GenericEqualityChecker<48> >(schemeCopy);
-            } else if (keySize <= 64) {
-                return new BinaryTreeMultiMapIndex<GenericKey<64>, GenericComparator<64>, GenericEqualityChecker<64> >(schemeCopy);
-            } else if (keySize <= 96) {
-                return new BinaryTreeMultiMapIndex<GenericKey<96>, GenericComparator<96>, GenericEqualityChecker<96> >(schemeCopy);
-            } else if (keySize <= 128) {
-                return new BinaryTreeMultiMapIndex<GenericKey<128>, GenericComparator<128>, GenericEqualityChecker<128> >(schemeCopy);
-            } else if (keySize <= 256) {
-                return new BinaryTreeMultiMapIndex<GenericKey<256>, GenericComparator<256>, GenericEqualityChecker<256> >(schemeCopy);
-            } else if (keySize <= 512) {
-                return new BinaryTreeMultiMapIndex<GenericKey<512>, GenericComparator<512>, GenericEqualityChecker<512> >(schemeCopy);
+            if (normalizedLength <= 16) {
+                return new BinaryTreeMultiMapIndex<NormalizedKey<16>, NormalizedComparator<16>, NormalizedEqualityChecker<16> >(schemeCopy);
+            } else if (normalizedLength <= 32) {
+                return new BinaryTreeMultiMapIndex<NormalizedKey<32>, NormalizedComparator<32>, NormalizedEqualityChecker<32> >(schemeCopy);
+            } else if (normalizedLength <= 64) {
+                return new BinaryTreeMultiMapIndex<NormalizedKey<64>, NormalizedComparator<64>, NormalizedEqualityChecker<64> >(schemeCopy);
+            } else if (normalizedLength <= 128) {
+                return new BinaryTreeMultiMapIndex<NormalizedKey<128>, NormalizedComparator<128>, NormalizedEqualityChecker<128> >(schemeCopy);
+            } else if (normalizedLength <= 256) {
+                return new BinaryTreeMultiMapIndex<NormalizedKey<256>, NormalizedComparator<256>, NormalizedEqualityChecker<256> >(schemeCopy);
             } else {
-                throwFatalException( "We currently only support keys of up to 512 bytes when anti-caching is enabled..." );
-                
-                //return new BinaryTreeMultiMapIndex<TupleKey, TupleKeyComparator, TupleKeyEqualityChecker>(schemeCopy);
+                return new BinaryTreeMultiMapIndex<NormalizedOverflowKey, NormalizedOverflowComparator, NormalizedOverflowEqualityChecker>(schemeCopy);
             }
         }
         
@@ -108,11 +108,37 @@ DistinctPlanNode::getDistinctColumnGuid() const
     return m_distinctColumnGuid;
 }
 
+void
+DistinctPlanNode::setDistinctColumns(const vector<int> &columns)
+{
+    m_distinctColumnIdxs = columns;
+    m_distinctColumnIdx = columns.empty() ? -1 : columns[0];
+}
+
+const vector<int>&
+DistinctPlanNode::getDistinctColumns() const
+{
+    return m_distinctColumnIdxs;
+}
+
+const vector<int>&
+DistinctPlanNode::getDistinctColumnGuids() const
+{
+    return m_distinctColumnGuids;
+}
+
 string
 DistinctPlanNode::debugInfo(const string &spacer) const
 {
     ostringstream buffer;
     buffer << spacer << "DistinctColumn[index=" << this->m_distinctColumnIdx << ", guid=" << this->m_distinctColumnGuid << "]\n";
+    if (m_distinctColumnGuids.size() > 1) {
+        buffer << spacer << "DistinctColumnGuids[";
+        for (int ctr = 0; ctr < (int) m_distinctColumnGuids.size(); ctr++) {
+            buffer << (ctr > 0 ? ", " : "") << m_distinctColumnGuids[ctr];
+        }
+        buffer << "]\n";
+    }
     buffer << spacer << "OutputColumns[" << m_outputColumnGuids.size()
            << "]:\n";
     for (int ctr = 0, cnt = (int) m_outputColumnGuids.size();
@@ -148,4 +174,21 @@ DistinctPlanNode::loadFromJSONObject(json_spirit::Object& obj,
                                       "Can't find DISTINCT_COLUMN_NAME value");
     }
     m_distinctColumnName = distinctColumnNameValue.get_str();
+
+    m_distinctColumnGuids.clear();
+    json_spirit::Value distinctColumnGuidsValue =
+        json_spirit::find_value( obj, "DISTINCT_COLUMN_GUIDS");
+    if (distinctColumnGuidsValue == json_spirit::Value::null)
+    {
+        m_distinctColumnGuids.push_back(m_distinctColumnGuid);
+    }
+    else
+    {
+        json_spirit::Array distinctColumnGuidsArray =
+            distinctColumnGuidsValue.get_array();
+        for (int ii = 0; ii < distinctColumnGuidsArray.size(); ii++)
+        {
+            m_distinctColumnGuids.push_back(distinctColumnGuidsArray[ii].get_int());
+        }
+    }
 }
@@ -74,6 +74,14 @@ public:
 
     int getDistinctColumnGuid() const;
 
+    /**
+     * The columns that tell the tuples apart. A single column unless the
+     * plan lists DISTINCT_COLUMN_GUIDS.
+     */
+    void setDistinctColumns(const std::vector<int> &columns);
+    const std::vector<int>& getDistinctColumns() const;
+    const std::vector<int>& getDistinctColumnGuids() const;
+
     std::string debugInfo(const std::string& spacer) const;
 
 protected:
@@ -87,6 +95,8 @@ protected:
     int m_distinctColumnIdx;
     int m_distinctColumnGuid;
     std::string m_distinctColumnName;
+    std::vector<int> m_distinctColumnIdxs;
+    std::vector<int> m_distinctColumnGuids;
 };
 
 }
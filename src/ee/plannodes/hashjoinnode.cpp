@@ -0,0 +1,140 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "hashjoinnode.h"
+
+#include "common/SerializableEEException.h"
+#include "expressions/abstractexpression.h"
+#include "storage/table.h"
+
+#include <sstream>
+
+using namespace json_spirit;
+using namespace std;
+using namespace voltdb;
+
+namespace {
+
+void loadExpressions(Object& obj, const char *name, vector<AbstractExpression*> &expressions)
+{
+    Value expressionsValue = find_value(obj, name);
+    if (expressionsValue == Value::null)
+    {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      string("HashJoinPlanNode::loadFromJSONObject:"
+                                             " Can't find ") + name);
+    }
+    Array expressionsArray = expressionsValue.get_array();
+    for (int ii = 0; ii < expressionsArray.size(); ii++)
+    {
+        Object expressionObject = expressionsArray[ii].get_obj();
+        expressions.push_back(AbstractExpression::buildExpressionTree(expressionObject));
+    }
+}
+
+}
+
+HashJoinPlanNode::HashJoinPlanNode(CatalogId id)
+  : AbstractJoinPlanNode(id)
+{
+    // Do nothing
+}
+
+HashJoinPlanNode::HashJoinPlanNode()
+  : AbstractJoinPlanNode()
+{
+    // Do nothing
+}
+
+HashJoinPlanNode::~HashJoinPlanNode()
+{
+    for (int ii = 0; ii < m_outerKeyExpressions.size(); ii++)
+    {
+        delete m_outerKeyExpressions[ii];
+    }
+    for (int ii = 0; ii < m_innerKeyExpressions.size(); ii++)
+    {
+        delete m_innerKeyExpressions[ii];
+    }
+    delete getOutputTable();
+    setOutputTable(NULL);
+}
+
+PlanNodeType HashJoinPlanNode::getPlanNodeType() const
+{
+    return PLAN_NODE_TYPE_HASHJOIN;
+}
+
+void HashJoinPlanNode::setOuterKeyExpressions(vector<AbstractExpression*> &exps)
+{
+    m_outerKeyExpressions = exps;
+}
+
+const vector<AbstractExpression*>& HashJoinPlanNode::getOuterKeyExpressions() const
+{
+    return m_outerKeyExpressions;
+}
+
+void HashJoinPlanNode::setInnerKeyExpressions(vector<AbstractExpression*> &exps)
+{
+    m_innerKeyExpressions = exps;
+}
+
+const vector<AbstractExpression*>& HashJoinPlanNode::getInnerKeyExpressions() const
+{
+    return m_innerKeyExpressions;
+}
+
+string HashJoinPlanNode::debugInfo(const string& spacer) const
+{
+    ostringstream buffer;
+    buffer << AbstractJoinPlanNode::debugInfo(spacer);
+    buffer << spacer << "OuterKeyExpressions[" << m_outerKeyExpressions.size() << "]\n";
+    for (int ii = 0; ii < m_outerKeyExpressions.size(); ii++)
+    {
+        buffer << m_outerKeyExpressions[ii]->debug(spacer + "  ");
+    }
+    buffer << spacer << "InnerKeyExpressions[" << m_innerKeyExpressions.size() << "]\n";
+    for (int ii = 0; ii < m_innerKeyExpressions.size(); ii++)
+    {
+        buffer << m_innerKeyExpressions[ii]->debug(spacer + "  ");
+    }
+    return (buffer.str());
+}
+
+void HashJoinPlanNode::loadFromJSONObject(Object& obj,
+                                          const catalog::Database* catalog_db)
+{
+    AbstractJoinPlanNode::loadFromJSONObject(obj, catalog_db);
+    loadExpressions(obj, "OUTER_KEY_EXPRESSIONS", m_outerKeyExpressions);
+    loadExpressions(obj, "INNER_KEY_EXPRESSIONS", m_innerKeyExpressions);
+    if (m_outerKeyExpressions.size() != m_innerKeyExpressions.size() ||
+        m_outerKeyExpressions.empty())
+    {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      "HashJoinPlanNode::loadFromJSONObject:"
+                                      " Mismatched join key expressions");
+    }
+}
@@ -0,0 +1,74 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREHASHJOINNODE_H
+#define HSTOREHASHJOINNODE_H
+
+#include <vector>
+#include "abstractjoinnode.h"
+
+namespace voltdb
+{
+
+class AbstractExpression;
+
+/**
+ * Equi-join that builds a hash table on one input and probes it with the
+ * other. The i-th outer key expression is compared with the i-th inner key
+ * expression. The join predicate, if any, is checked on every pair of
+ * tuples whose keys are equal.
+ */
+class HashJoinPlanNode : public AbstractJoinPlanNode
+{
+public:
+    HashJoinPlanNode(CatalogId id);
+    HashJoinPlanNode();
+    ~HashJoinPlanNode();
+
+    virtual PlanNodeType getPlanNodeType() const;
+
+    void setOuterKeyExpressions(std::vector<AbstractExpression*> &exps);
+    const std::vector<AbstractExpression*>& getOuterKeyExpressions() const;
+
+    void setInnerKeyExpressions(std::vector<AbstractExpression*> &exps);
+    const std::vector<AbstractExpression*>& getInnerKeyExpressions() const;
+
+    virtual std::string debugInfo(const std::string& spacer) const;
+
+protected:
+    friend AbstractPlanNode*
+        AbstractPlanNode::fromJSONObject(json_spirit::Object& obj,
+                                         const catalog::Database *catalog_db);
+
+    virtual void loadFromJSONObject(json_spirit::Object& obj,
+                                    const catalog::Database *catalog_db);
+
+    std::vector<AbstractExpression*> m_outerKeyExpressions;
+    std::vector<AbstractExpression*> m_innerKeyExpressions;
+};
+
+}
+
+#endif
@@ -81,6 +81,12 @@ voltdb::AbstractPlanNode* getEmptyPlanNode(voltdb::PlanNodeType type) {
             ret = new voltdb::NestLoopIndexPlanNode();
             break;
         // ------------------------------------------------------------------
+        // HashJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_HASHJOIN):
+            ret = new voltdb::HashJoinPlanNode();
+            break;
+        // ------------------------------------------------------------------
         // Update
         // ------------------------------------------------------------------
         case (voltdb::PLAN_NODE_TYPE_UPDATE):
@@ -193,6 +199,12 @@ std::string getTypeName(voltdb::PlanNodeType type) {
             ret = "NESTLOOPINDEX";
             break;
         // ------------------------------------------------------------------
+        // HashJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_HASHJOIN):
+            ret = "HASHJOIN";
+            break;
+        // ------------------------------------------------------------------
         // Update
         // ------------------------------------------------------------------
         case (voltdb::PLAN_NODE_TYPE_UPDATE):
@@ -51,10 +51,23 @@
 namespace voltdb {
 
 std::string UnionPlanNode::debugInfo(const std::string &spacer) const {
-    //
-    // Nothing for now...
-    //
-    return (std::string(""));
+    std::ostringstream buffer;
+    buffer << spacer << "UnionType[" << unionToString(m_unionType) << "]\n";
+    return (buffer.str());
+}
+
+void UnionPlanNode::loadFromJSONObject(json_spirit::Object &obj, const catalog::Database *catalog_db) {
+    json_spirit::Value unionTypeValue = json_spirit::find_value(obj, "UNION_TYPE");
+    if (unionTypeValue == json_spirit::Value::null) {
+        m_unionType = UNION_TYPE_UNION_ALL;
+        return;
+    }
+    m_unionType = stringToUnion(unionTypeValue.get_str());
+    if (m_unionType == UNION_TYPE_INVALID) {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      "UnionPlanNode::loadFromJSONObject:"
+                                      " Invalid UNION_TYPE value");
+    }
 }
 
 }
@@ -55,17 +55,27 @@ namespace voltdb {
  */
 class UnionPlanNode : public AbstractPlanNode {
     public:
-        UnionPlanNode(CatalogId id) : AbstractPlanNode(id) {
+        UnionPlanNode(CatalogId id) : AbstractPlanNode(id), m_unionType(UNION_TYPE_UNION_ALL) {
             // Do nothing
         }
-        UnionPlanNode() : AbstractPlanNode() {
+        UnionPlanNode() : AbstractPlanNode(), m_unionType(UNION_TYPE_UNION_ALL) {
             // Do nothing
         }
         virtual PlanNodeType getPlanNodeType() const { return (PLAN_NODE_TYPE_UNION); }
 
+        /**
+         * How the inputs are combined. Plans without a UNION_TYPE append
+         * all of them (UNION ALL).
+         */
+        UnionType getUnionType() const { return m_unionType; }
+        void setUnionType(UnionType union_type) { m_unionType = union_type; }
+
         std::string debugInfo(const std::string &spacer) const;
         friend AbstractPlanNode* AbstractPlanNode::fromJSONObject(json_spirit::Object &obj, const catalog::Database *catalog_db);
-        virtual void loadFromJSONObject(json_spirit::Object &obj, const catalog::Database *catalog_db) {}
+        virtual void loadFromJSONObject(json_spirit::Object &obj, const catalog::Database *catalog_db);
+
+    protected:
+        UnionType m_unionType;
 };
 
 }
@@ -0,0 +1,145 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include "common/debuglog.h"
+#include "common/tabletuple.h"
+#include "storage/ColumnarBlockStore.h"
+
+using namespace std;
+
+namespace voltdb {
+
+// Column arrays start (and are padded to) this boundary so that they can be
+// read with vector loads, including an AVX2 load that runs past the last slot
+#define COLUMNAR_ALIGNMENT 32
+
+static inline size_t alignColumnarOffset(size_t offset) {
+    return ((offset + COLUMNAR_ALIGNMENT - 1) & ~(static_cast<size_t>(COLUMNAR_ALIGNMENT) - 1));
+}
+
+ColumnarBlockStore::ColumnarBlockStore(const TupleSchema *schema, uint32_t tuplesPerBlock, uint32_t tupleLength) :
+        m_schema(schema),
+        m_tuplesPerBlock(tuplesPerBlock),
+        m_tupleLength(tupleLength),
+        m_columnOffsets(schema->columnCount(), -1),
+        m_refreshCount(0) {
+
+    size_t offset = alignColumnarOffset(m_tuplesPerBlock);
+    for (int i = 0, cnt = schema->columnCount(); i < cnt; i++) {
+        if (schema->columnIsInlined(i) == false) continue;
+        if (isColumnarType(schema->columnType(i)) == false) continue;
+
+        m_columnOffsets[i] = static_cast<int32_t>(offset);
+        m_columns.push_back(i);
+        offset = alignColumnarOffset(offset + m_tuplesPerBlock * schema->columnLength(i));
+    } // FOR
+    m_minipageSize = offset;
+    VOLT_DEBUG("Created ColumnarBlockStore with %d columnar columns [minipageSize=%ld]",
+               (int)m_columns.size(), (long)m_minipageSize);
+}
+
+ColumnarBlockStore::~ColumnarBlockStore() {
+    for (size_t i = 0; i < m_blocks.size(); i++) {
+        delete [] m_blocks[i];
+    } // FOR
+}
+
+bool ColumnarBlockStore::isColumnarType(ValueType type) {
+    switch (type) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+        case VALUE_TYPE_DOUBLE:
+            return (true);
+        default:
+            return (false);
+    } // SWITCH
+}
+
+void ColumnarBlockStore::markAllDirty() {
+    for (size_t i = 0; i < m_dirty.size(); i++) {
+        m_dirty[i] = true;
+    } // FOR
+}
+
+const char* ColumnarBlockStore::getBlock(int blockIndex, const char *rowData, uint32_t tupleCount) {
+    assert(blockIndex >= 0);
+    assert(tupleCount <= m_tuplesPerBlock);
+
+    size_t idx = static_cast<size_t>(blockIndex);
+    if (idx >= m_blocks.size()) {
+        m_blocks.resize(idx + 1, NULL);
+        m_dirty.resize(idx + 1, true);
+        m_builtTupleCounts.resize(idx + 1, 0);
+    }
+    if (m_blocks[idx] == NULL) {
+        m_blocks[idx] = new char[m_minipageSize];
+        ::memset(m_blocks[idx], 0, m_minipageSize);
+        m_dirty[idx] = true;
+    }
+
+    char *minipage = m_blocks[idx];
+    if (m_dirty[idx] || m_builtTupleCounts[idx] != tupleCount) {
+        refresh(minipage, rowData, tupleCount);
+        m_dirty[idx] = false;
+        m_builtTupleCounts[idx] = tupleCount;
+    }
+    return (minipage);
+}
+
+void ColumnarBlockStore::refresh(char *minipage, const char *rowData, uint32_t tupleCount) {
+    m_refreshCount++;
+
+    // Active flags. Slots past the end of the used region are inactive so
+    // that scans can always run over a full block.
+    TableTuple tuple(m_schema);
+    char *active = minipage;
+    for (uint32_t i = 0; i < tupleCount; i++) {
+        tuple.move(const_cast<char*>(rowData + (i * m_tupleLength)));
+        active[i] = static_cast<char>(tuple.isActive() ? 1 : 0);
+    } // FOR
+    if (tupleCount < m_tuplesPerBlock) {
+        ::memset(active + tupleCount, 0, m_tuplesPerBlock - tupleCount);
+    }
+
+    // Column arrays
+    for (size_t c = 0; c < m_columns.size(); c++) {
+        const int col = m_columns[c];
+        const uint32_t width = m_schema->columnLength(col);
+        const char *src = rowData + TUPLE_HEADER_SIZE + m_schema->columnOffset(col);
+        char *dest = minipage + m_columnOffsets[col];
+        for (uint32_t i = 0; i < tupleCount; i++) {
+            ::memcpy(dest, src, width);
+            dest += width;
+            src += m_tupleLength;
+        } // FOR
+    } // FOR
+}
+
+}
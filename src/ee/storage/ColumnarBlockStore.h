@@ -0,0 +1,136 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORE_COLUMNARBLOCKSTORE_H
+#define HSTORE_COLUMNARBLOCKSTORE_H
+
+#include <vector>
+#include "common/types.h"
+#include "common/TupleSchema.h"
+
+namespace voltdb {
+
+/**
+ * PAX (mini-columnar) layout of a table's storage blocks.
+ *
+ * For every row-major tuple block in Table::m_data we keep one minipage
+ * buffer that stores, for the same tuple slots, an "active" flag array
+ * followed by one contiguous array per fixed-width numeric column:
+ *
+ *   [ active[0..n) ][ col_a[0..n) ][ col_b[0..n) ] ...
+ *
+ * The row-major block stays the storage of record, so TableTuple, the
+ * TableIterator, indexes, serialization and the anti-cache keep working
+ * unchanged. Writes only flag the block as stale; the minipage is
+ * rebuilt from the rows the next time a scan asks for it. This keeps
+ * the OLTP write path to a single flag store while repeated scans over
+ * mostly-cold blocks read only the column arrays they need.
+ */
+class ColumnarBlockStore {
+public:
+    ColumnarBlockStore(const TupleSchema *schema, uint32_t tuplesPerBlock, uint32_t tupleLength);
+    ~ColumnarBlockStore();
+
+    /** Can columns of this type be stored in a minipage array? */
+    static bool isColumnarType(ValueType type);
+
+    /** Does this store keep a column array for the given column? */
+    inline bool hasColumn(int columnIndex) const {
+        return (m_columnOffsets[columnIndex] >= 0);
+    }
+
+    /** Number of bytes per value in the column array */
+    inline uint32_t columnWidth(int columnIndex) const {
+        return (m_schema->columnLength(columnIndex));
+    }
+
+    /** Number of bytes between two tuples in the row-major block */
+    inline uint32_t tupleLength() const {
+        return (m_tupleLength);
+    }
+
+    /** Flag the given block as stale */
+    inline void markDirty(int blockIndex) {
+        if (blockIndex >= 0 && blockIndex < static_cast<int>(m_dirty.size())) {
+            m_dirty[blockIndex] = true;
+        }
+        // Blocks that we have never built are implicitly stale
+    }
+
+    void markAllDirty();
+
+    /**
+     * Return the minipage buffer for the given block, rebuilding it from
+     * the row-major data if any tuple in the block changed since the
+     * last time it was built.
+     * @param rowData the row-major block
+     * @param tupleCount the number of slots in the block that are in use
+     */
+    const char* getBlock(int blockIndex, const char *rowData, uint32_t tupleCount);
+
+    /** One byte per tuple slot, non-zero if the tuple is active */
+    inline const char* activeFlags(const char *minipage) const {
+        return (minipage);
+    }
+
+    /** The contiguous value array for a column inside a minipage */
+    inline const char* columnData(const char *minipage, int columnIndex) const {
+        return (minipage + m_columnOffsets[columnIndex]);
+    }
+
+    /** Number of times a minipage had to be rebuilt from the rows */
+    inline int64_t getRefreshCount() const {
+        return (m_refreshCount);
+    }
+
+    /** Bytes of memory used by the minipages */
+    inline int64_t getMemorySize() const {
+        return (m_minipageSize * static_cast<int64_t>(m_blocks.size()));
+    }
+
+private:
+    void refresh(char *minipage, const char *rowData, uint32_t tupleCount);
+
+    const TupleSchema *m_schema;
+    const uint32_t m_tuplesPerBlock;
+    const uint32_t m_tupleLength;
+
+    /** Offset of each column's array inside a minipage, or -1 */
+    std::vector<int32_t> m_columnOffsets;
+    /** The columns that have an array, in minipage order */
+    std::vector<int> m_columns;
+    size_t m_minipageSize;
+
+    std::vector<char*> m_blocks;
+    std::vector<bool> m_dirty;
+    /** Number of slots in use when the minipage was last built */
+    std::vector<uint32_t> m_builtTupleCounts;
+
+    int64_t m_refreshCount;
+};
+
+}
+
+#endif
@@ -58,7 +58,7 @@ bool simplePairAddressToPairAddressComparator(const BlockPair a, const BlockPair
 CopyOnWriteContext::CopyOnWriteContext(Table *table, TupleSerializer *serializer, int32_t partitionId) :
              m_table(table),
              m_backedUpTuples(TableFactory::getCopiedTempTable(table->databaseId(), "COW of " + table->name(), table, NULL)),
-             m_serializer(serializer), m_pool(2097152, 320), m_blocks(m_table->m_data.size()),
+             m_serializer(serializer), m_pool(2097152, 320, BlockAllocator::getDefault()), m_blocks(m_table->m_data.size()),
              m_iterator(new CopyOnWriteIterator(table)),
              m_maxTupleLength(serializer->getMaxSerializedTupleSize(table->schema())),
              m_tuple(table->schema()), m_finishedTableScan(false), m_partitionId(partitionId),
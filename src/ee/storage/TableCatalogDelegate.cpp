@@ -273,6 +273,12 @@ TableCatalogDelegate::init(ExecutorContext *executorContext,
                                                  isExportEnabledForTable(catalogDatabase, table_id),
                                                  isTableExportOnly(catalogDatabase, table_id));
     }
+
+    // Keep a PAX copy of the numeric columns for tables that are mostly scanned
+    if (catalogTable.columnar()) {
+        VOLT_INFO("Enabling columnar blocks for table '%s'", catalogTable.name().c_str());
+        m_table->enableColumnarStore();
+    }
     
     #ifdef ANTICACHE
     // Create evicted table if anti-caching is enabled and this table is marked as evictable
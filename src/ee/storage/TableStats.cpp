@@ -38,6 +38,10 @@ vector<string> TableStats::generateTableStatsColumnNames() {
     columnNames.push_back("TUPLE_DATA_MEMORY");
     columnNames.push_back("STRING_DATA_MEMORY");
     columnNames.push_back("INDEX_MEMORY");
+    columnNames.push_back("TUPLE_BLOCKS");
+    columnNames.push_back("TUPLE_FREE_SLOTS");
+    columnNames.push_back("TUPLE_BLOCKS_RELEASED");
+    columnNames.push_back("TUPLE_HUGE_PAGE_BLOCKS");
     
     #ifdef ANTICACHE
     // ACTIVE
@@ -54,6 +58,13 @@ vector<string> TableStats::generateTableStatsColumnNames() {
     columnNames.push_back("ANTICACHE_TUPLES_READ");
     columnNames.push_back("ANTICACHE_BLOCKS_READ");
     columnNames.push_back("ANTICACHE_BYTES_READ");
+
+    // GLOBAL COMPRESSION
+    columnNames.push_back("ANTICACHE_BYTES_UNCOMPRESSED");
+    columnNames.push_back("ANTICACHE_BYTES_COMPRESSED");
+    columnNames.push_back("ANTICACHE_COMPRESSION_RATIO");
+    columnNames.push_back("ANTICACHE_COMPRESS_TIME");
+    columnNames.push_back("ANTICACHE_DECOMPRESS_TIME");
     #endif
     
     return columnNames;
@@ -72,6 +83,26 @@ void TableStats::populateTableStatsSchema(
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+
+    // TUPLE_BLOCKS
+    types.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+
+    // TUPLE_FREE_SLOTS
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // TUPLE_BLOCKS_RELEASED
+    types.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+
+    // TUPLE_HUGE_PAGE_BLOCKS
+    types.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
     
     #ifdef ANTICACHE
     // ANTICACHE_TUPLES_EVICTED
@@ -118,6 +149,31 @@ void TableStats::populateTableStatsSchema(
     types.push_back(VALUE_TYPE_BIGINT);
     columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
     allowNull.push_back(false);
+
+    // ANTICACHE_BYTES_UNCOMPRESSED
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // ANTICACHE_BYTES_COMPRESSED
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // ANTICACHE_COMPRESSION_RATIO
+    types.push_back(VALUE_TYPE_DOUBLE);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+    allowNull.push_back(false);
+
+    // ANTICACHE_COMPRESS_TIME
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // ANTICACHE_DECOMPRESS_TIME
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
     #endif
 }
 
@@ -153,7 +209,7 @@ TableStats::generateEmptyTableStatsTable()
 TableStats::TableStats(Table* table)
     : StatsSource(), m_table(table), m_lastTupleCount(0), m_lastTupleAccessCount(0),
       m_lastAllocatedTupleMemory(0), m_lastOccupiedTupleMemory(0),
-      m_lastStringDataMemory(0), m_lastIndexMemory(0)
+      m_lastStringDataMemory(0), m_lastIndexMemory(0), m_lastBlocksReleased(0)
 {
     #ifdef ANTICACHE
     m_lastTuplesEvicted = 0;
@@ -167,6 +223,11 @@ TableStats::TableStats(Table* table)
     m_lastTuplesRead = 0;
     m_lastBlocksRead = 0;
     m_lastBytesRead = 0;
+
+    m_lastBytesUncompressed = 0;
+    m_lastBytesCompressed = 0;
+    m_lastCompressMicros = 0;
+    m_lastDecompressMicros = 0;
     #endif
 }
 
@@ -223,6 +284,13 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
 
     index_mem_kb = index_mem / 1024;
 
+    // fragmentation: free slots left behind by deletes that compaction
+    // has not reclaimed yet
+    int32_t tupleBlocks = static_cast<int32_t>(m_table->allocatedBlockCount());
+    int64_t freeTupleSlots = m_table->freeTupleSlotCount();
+    int32_t blocksReleased = m_table->getBlocksReleased();
+    int32_t hugePageBlocks = m_table->getHugePageBlocks();
+
     #ifdef ANTICACHE
     int32_t tuplesEvicted = m_table->getTuplesEvicted();
     int32_t blocksEvicted = m_table->getBlocksEvicted();
@@ -235,6 +303,11 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     int32_t tuplesRead = m_table->getTuplesRead();
     int32_t blocksRead = m_table->getBlocksRead();
     int64_t bytesRead = m_table->getBytesRead();
+
+    int64_t bytesUncompressed = m_table->getBytesUncompressed();
+    int64_t bytesCompressed = m_table->getBytesCompressed();
+    int64_t compressMicros = m_table->getCompressMicros();
+    int64_t decompressMicros = m_table->getDecompressMicros();
     #endif
 
     if (interval()) {
@@ -256,6 +329,9 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         index_mem_kb =
             index_mem_kb - m_lastIndexMemory / 1024;
         m_lastIndexMemory = index_mem;
+
+        blocksReleased = blocksReleased - m_lastBlocksReleased;
+        m_lastBlocksReleased = m_table->getBlocksReleased();
         
         #ifdef ANTICACHE
         
@@ -288,6 +364,19 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         
         bytesRead = bytesRead - m_lastBytesRead;
         m_lastBytesRead = m_table->getBytesRead();
+
+        // GLOBAL COMPRESSION
+        bytesUncompressed = bytesUncompressed - m_lastBytesUncompressed;
+        m_lastBytesUncompressed = m_table->getBytesUncompressed();
+
+        bytesCompressed = bytesCompressed - m_lastBytesCompressed;
+        m_lastBytesCompressed = m_table->getBytesCompressed();
+
+        compressMicros = compressMicros - m_lastCompressMicros;
+        m_lastCompressMicros = m_table->getCompressMicros();
+
+        decompressMicros = decompressMicros - m_lastDecompressMicros;
+        m_lastDecompressMicros = m_table->getDecompressMicros();
         #endif
     }
 
@@ -327,6 +416,14 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue( StatsSource::m_columnName2Index["INDEX_MEMORY"],
                       ValueFactory::
                       getIntegerValue(static_cast<int32_t>(index_mem_kb)));
+    tuple->setNValue( StatsSource::m_columnName2Index["TUPLE_BLOCKS"],
+                      ValueFactory::getIntegerValue(tupleBlocks));
+    tuple->setNValue( StatsSource::m_columnName2Index["TUPLE_FREE_SLOTS"],
+                      ValueFactory::getBigIntValue(freeTupleSlots));
+    tuple->setNValue( StatsSource::m_columnName2Index["TUPLE_BLOCKS_RELEASED"],
+                      ValueFactory::getIntegerValue(blocksReleased));
+    tuple->setNValue( StatsSource::m_columnName2Index["TUPLE_HUGE_PAGE_BLOCKS"],
+                      ValueFactory::getIntegerValue(hugePageBlocks));
     
     #ifdef ANTICACHE
     tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_TUPLES_EVICTED"],
@@ -360,6 +457,20 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_BYTES_READ"],
                       ValueFactory::
                       getBigIntValue(static_cast<int64_t>(bytesRead)));
+
+    // GLOBAL COMPRESSION
+    tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_BYTES_UNCOMPRESSED"],
+                      ValueFactory::getBigIntValue(bytesUncompressed));
+    tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_BYTES_COMPRESSED"],
+                      ValueFactory::getBigIntValue(bytesCompressed));
+    tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_COMPRESSION_RATIO"],
+                      ValueFactory::
+                      getDoubleValue(bytesCompressed > 0 ?
+                                     (double)bytesUncompressed / (double)bytesCompressed : 0.0));
+    tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_COMPRESS_TIME"],
+                      ValueFactory::getBigIntValue(compressMicros));
+    tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_DECOMPRESS_TIME"],
+                      ValueFactory::getBigIntValue(decompressMicros));
     #endif
 }
 
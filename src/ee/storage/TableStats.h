@@ -112,6 +112,7 @@ private:
     int64_t m_lastOccupiedTupleMemory;
     int64_t m_lastStringDataMemory;
     int64_t m_lastIndexMemory;
+    int32_t m_lastBlocksReleased;
     
     #ifdef ANTICACHE
     // ACTIVE
@@ -128,6 +129,12 @@ private:
     int32_t m_lastTuplesRead;
     int32_t m_lastBlocksRead;
     int64_t m_lastBytesRead;
+
+    // GLOBAL COMPRESSION
+    int64_t m_lastBytesUncompressed;
+    int64_t m_lastBytesCompressed;
+    int64_t m_lastCompressMicros;
+    int64_t m_lastDecompressMicros;
     #endif
 };
 
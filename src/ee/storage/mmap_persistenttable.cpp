@@ -122,7 +122,7 @@ namespace voltdb {
     }
 
     /** Push into m_data **/
-    m_data.push_back(memory);
+    addBlock(memory);
 
     m_allocatedTuples += m_tuplesPerBlock;
   }
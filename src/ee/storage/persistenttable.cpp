@@ -43,9 +43,11 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <sstream>
 #include <cassert>
 #include <cstdio>
+#include <pthread.h>
 
 #include "boost/scoped_ptr.hpp"
 #include "storage/persistenttable.h"
@@ -97,11 +99,69 @@ TableTuple keyTuple;
 #define TABLE_BLOCKSIZE 2097152
 #define MAX_EVICTED_TUPLE_SIZE 2500
 
+/**
+ * Loads of at least this many tuples build the table's indexes on
+ * several threads (each index is still built by a single thread)
+ */
+#define PARALLEL_INDEX_BUILD_MIN_TUPLES 65536
+#define PARALLEL_INDEX_BUILD_MAX_THREADS 8
+
+namespace {
+
+/**
+ * Work shared by the threads of PersistentTable::populateIndexes(). Each
+ * thread keeps taking the next index that nobody is building yet.
+ */
+struct IndexBuildWork {
+    TableIndex **indexes;
+    int indexCount;
+    const std::vector<const void*> *tuples;
+    int next;
+    pthread_mutex_t lock;
+    std::string error;
+};
+
+void* buildIndexes(void *arg) {
+    IndexBuildWork *work = static_cast<IndexBuildWork*>(arg);
+    int i;
+    while ((i = __sync_fetch_and_add(&work->next, 1)) < work->indexCount) {
+        std::string error;
+        try {
+            // like addEntry() during a load, entries that violate a unique
+            // index are skipped
+            work->indexes[i]->addEntries(*work->tuples);
+        } catch (FatalException &e) {
+            error = e.m_reason;
+        } catch (std::exception &e) {
+            error = e.what();
+        }
+        if (error.empty() == false) {
+            pthread_mutex_lock(&work->lock);
+            if (work->error.empty()) work->error = work->indexes[i]->getName() + ": " + error;
+            pthread_mutex_unlock(&work->lock);
+        }
+    } // WHILE
+    return NULL;
+}
+
+/**
+ * Orders free tuple slots by their position in the table, highest first
+ */
+struct HigherTupleID {
+    Table *table;
+    HigherTupleID(Table *t) : table(t) {}
+    bool operator()(const char *lhs, const char *rhs) const {
+        return (table->getTupleID(lhs) > table->getTupleID(rhs));
+    }
+};
+
+}
+
 PersistentTable::PersistentTable(ExecutorContext *ctx, bool exportEnabled) :
     Table(TABLE_BLOCKSIZE,ctx->isMMAPEnabled()), m_executorContext(ctx), m_uniqueIndexes(NULL), m_uniqueIndexCount(0), m_allowNulls(NULL),
-    m_indexes(NULL), m_indexCount(0), m_pkeyIndex(NULL), m_wrapper(NULL),
+    m_indexes(NULL), m_indexCount(0), m_pkeyIndex(NULL), m_hasIncludedColumns(false), m_wrapper(NULL),
     m_tsSeqNo(0), stats_(this), m_exportEnabled(exportEnabled),
-    m_COWContext(NULL)
+    m_blockAllocator(BlockAllocator::getDefault()), m_COWContext(NULL)
 {
 
 #ifdef ANTICACHE
@@ -112,6 +172,9 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, bool exportEnabled) :
     m_newestTupleID = 0;
     m_oldestTupleID = 0;
     m_numTuplesInEvictionChain = 0;
+#ifdef ANTICACHE_CLOCK
+    m_clockHand = 0;
+#endif
     m_blockMerge = ctx->isBlockMerge();
     m_batchEvicted = false;
     m_read_pivot = 0;
@@ -132,9 +195,9 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, bool exportEnabled) :
 
 PersistentTable::PersistentTable(ExecutorContext *ctx, const std::string name, bool exportEnabled) :
     Table(TABLE_BLOCKSIZE,ctx->isMMAPEnabled()), m_executorContext(ctx), m_uniqueIndexes(NULL), m_uniqueIndexCount(0), m_allowNulls(NULL),
-    m_indexes(NULL), m_indexCount(0), m_pkeyIndex(NULL), m_wrapper(NULL),
+    m_indexes(NULL), m_indexCount(0), m_pkeyIndex(NULL), m_hasIncludedColumns(false), m_wrapper(NULL),
     m_tsSeqNo(0), stats_(this), m_exportEnabled(exportEnabled),
-    m_COWContext(NULL)
+    m_blockAllocator(BlockAllocator::getDefault()), m_COWContext(NULL)
 {
 
 #ifdef ANTICACHE
@@ -145,6 +208,9 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, const std::string name, b
     m_newestTupleID = 0;
     m_oldestTupleID = 0;
     m_numTuplesInEvictionChain = 0;
+#ifdef ANTICACHE_CLOCK
+    m_clockHand = 0;
+#endif
     m_blockMerge = ctx->isBlockMerge();
     m_batchEvicted = false;
     m_read_pivot = 0;
@@ -206,6 +272,35 @@ PersistentTable::~PersistentTable() {
     }
 
     delete m_wrapper;
+
+#ifndef MEMCHECK
+    // Hand the mapped blocks back here, the Table destructor only knows
+    // how to delete[] the others
+    if (m_executorContext->isMMAPEnabled() == false) {
+        for (std::vector<char*>::iterator iter = m_data.begin(); iter != m_data.end(); ++iter) {
+            if (m_blockAllocator->pageType(*iter) != BlockAllocator::PAGES_HEAP) {
+                releaseBlock(*iter);
+                *iter = NULL;
+            }
+        }
+    }
+#endif
+}
+
+void PersistentTable::releaseBlock(char *block) {
+#ifdef MEMCHECK
+    delete[] block;
+#else
+    BlockAllocator::PageType pageType = m_blockAllocator->pageType(block);
+    if (pageType == BlockAllocator::PAGES_HUGE || pageType == BlockAllocator::PAGES_TRANSPARENT_HUGE) {
+        m_hugePageBlocks--;
+    }
+    if (pageType == BlockAllocator::PAGES_HEAP) {
+        delete[] block;
+    } else {
+        m_blockAllocator->release(block, m_tableAllocationTargetSize);
+    }
+#endif
 }
 
 // ------------------------------------------------------------------
@@ -241,6 +336,19 @@ bool PersistentTable::isBatchEvicted(){
     return m_batchEvicted;
 }
 
+AntiCacheKeyFilter& PersistentTable::getEvictedKeyFilter() {
+    return m_evictedKeys;
+}
+
+bool PersistentTable::hasEvictedKeyFingerprints() {
+    return (m_pkeyIndex != NULL);
+}
+
+uint32_t PersistentTable::getEvictedKeyFingerprint(const TableTuple &tuple) {
+    assert(m_pkeyIndex != NULL);
+    return AntiCacheKeyFilter::fingerprint(tuple, m_pkeyIndex->getColumnIndices());
+}
+
 void PersistentTable::setNumTuplesInEvictionChain(int num_tuples)
 {
     m_numTuplesInEvictionChain = num_tuples; 
@@ -271,6 +379,18 @@ uint32_t PersistentTable::getOldestTupleID()
     return m_oldestTupleID; 
 }
 
+#ifdef ANTICACHE_CLOCK
+uint32_t PersistentTable::getClockHand()
+{
+    return m_clockHand;
+}
+
+void PersistentTable::setClockHand(uint32_t tuple_id)
+{
+    m_clockHand = tuple_id;
+}
+#endif
+
 AntiCacheDB* PersistentTable::getAntiCacheDB(int level)
 {
     return m_executorContext->getAntiCacheDB(level);
@@ -731,6 +851,9 @@ bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool u
     } else {
         target.copyForPersistentUpdate(source, getNVMEvictedTable()->getPool());
     }
+    if (m_columnarStore != NULL) {
+        markColumnarBlockDirty(target.address());
+    }
 
     ptuua->setNewTuple(target, pool);
 
@@ -741,7 +864,7 @@ bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool u
 
     // the planner should determine if this update can affect indexes.
     // if so, update the indexes here
-    if (updatesIndexes) {
+    if (updatesIndexes || m_hasIncludedColumns) {
         if (!tryUpdateOnAllIndexes(ptuua->getOldTuple(), target)) {
             throw ConstraintFailureException(this, ptuua->getOldTuple(),
                     target,
@@ -825,6 +948,9 @@ void PersistentTable::updateTupleForUndo(TableTuple &source, TableTuple &target,
     bool dirty = target.isDirty();
     // this is the actual in-place revert to the old version
     target.copy(source);
+    if (m_columnarStore != NULL) {
+        markColumnarBlockDirty(target.address());
+    }
     if (dirty) {
         target.setDirtyTrue();
     } else {
@@ -857,7 +983,7 @@ bool PersistentTable::deleteTuple(TableTuple &target, bool deleteAllocatedString
     assert(&target != &m_tempTuple);
 
 #ifdef ANTICACHE
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     AntiCacheEvictionManager* eviction_manager = m_executorContext->getAntiCacheEvictionManager();
     eviction_manager->removeTuple(this, &target); 
 #endif
@@ -1172,20 +1298,144 @@ void PersistentTable::processLoadedTuple(bool allowExport, TableTuple &tuple) {
     }
 }
 
+int64_t PersistentTable::compactTuples(int64_t maxBytes) {
+#ifdef MEMCHECK_NOFREELIST
+    return 0;
+#else
+    // Snapshot and recovery streams walk the table by position
+    if (m_COWContext.get() != NULL || m_recoveryContext.get() != NULL) {
+        return 0;
+    }
+    // MMAP tables carve their blocks out of one mapped file and have no
+    // way to give a block back
+    if (m_executorContext->isMMAPEnabled()) {
+        return 0;
+    }
+#if defined(ANTICACHE) && !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
+    // The eviction chain links tuples by their position in the table
+    if (m_evictedTable != NULL) {
+        return 0;
+    }
+#endif
+    // Not enough free slots to empty a block
+    if (m_holeFreeTuples.size() < m_tuplesPerBlock) {
+        return 0;
+    }
+
+    // Sort the free slots that were added since the last time and merge
+    // them with the rest, so that the free slots at the end of the table
+    // are at the front and the lowest ones at the back
+    HigherTupleID order(this);
+    std::vector<char*>::iterator sortedEnd = m_holeFreeTuples.begin() + m_sortedHoleCount;
+    if (sortedEnd != m_holeFreeTuples.end()) {
+        std::sort(sortedEnd, m_holeFreeTuples.end(), order);
+        std::inplace_merge(m_holeFreeTuples.begin(), sortedEnd, m_holeFreeTuples.end(), order);
+    }
+
+    // Free slots still in use are [front, back)
+    size_t front = 0;
+    size_t back = m_holeFreeTuples.size();
+    int64_t bytesMoved = 0;
+    TableTuple source(m_schema);
+    TableTuple target(m_schema);
+    while (m_usedTuples > 0 && bytesMoved + m_tupleLength <= maxBytes) {
+        // Only start on the last block if all of it can be moved
+        const uint32_t lastBlockTuples = m_usedTuples - ((m_usedTuples - 1) / m_tuplesPerBlock) * m_tuplesPerBlock;
+        if (back - front < lastBlockTuples) break;
+
+        source.move(dataPtrForTuple(static_cast<int>(m_usedTuples - 1)));
+        if (source.isActive() == false) {
+            // A free slot at the end only has to be dropped from the list
+            if (m_holeFreeTuples[front] != source.address()) break;
+            front++;
+            m_usedTuples--;
+            continue;
+        }
+
+        // Move the last tuple into the lowest free slot. Its strings move
+        // with it, and the indexes have to point to the new copy.
+        target.move(m_holeFreeTuples[--back]);
+        ::memcpy(target.address(), source.address(), m_tupleLength);
+        setEntryToNewAddressForAllIndexes(&target, target.address(), source.address());
+        source.setDeletedTrue();
+        if (m_columnarStore != NULL) {
+            markColumnarBlockDirty(target.address());
+            markColumnarBlockDirty(source.address());
+        }
+#ifdef ANTICACHE_CLOCK
+        // The reference bit goes with the tuple to its new id
+        if (clearReferenced(m_usedTuples - 1)) {
+            setReferenced(getTupleID(target.address()));
+        }
+#endif
+        m_usedTuples--;
+        m_tuplesCompacted++;
+        bytesMoved += m_tupleLength;
+    } // WHILE
+    m_holeFreeTuples.erase(m_holeFreeTuples.begin() + back, m_holeFreeTuples.end());
+    m_holeFreeTuples.erase(m_holeFreeTuples.begin(), m_holeFreeTuples.begin() + front);
+    m_sortedHoleCount = m_holeFreeTuples.size();
+
+    // Give back the blocks past the last tuple in use
+    while (m_data.empty() == false &&
+           (m_data.size() - 1) * m_tuplesPerBlock >= m_usedTuples) {
+        releaseBlock(removeLastBlock());
+        m_allocatedTuples -= m_tuplesPerBlock;
+#ifdef ANTICACHE_TIMESTAMPS_PRIME
+        m_evictPosition.pop_back();
+        m_stepPrime.pop_back();
+#endif
+        m_blocksReleased++;
+    } // WHILE
+
+    VOLT_DEBUG("Compacted table '%s': moved %ld bytes, %d blocks left, %d free slots",
+               m_name.c_str(), (long)bytesMoved, (int)m_data.size(), (int)m_holeFreeTuples.size());
+    return bytesMoved;
+#endif
+}
+
 /*
  * Implemented by persistent table and called by Table::loadTuplesFrom
  * to do add tuples to indexes
  */
 void PersistentTable::populateIndexes(int tupleCount) 
 {
-    // populate indexes. walk the contiguous memory in the inner loop.
-    for (int i = m_indexCount - 1; i >= 0;--i) {
-        TableIndex *index = m_indexes[i];
-        for (int j = 0; j < tupleCount; ++j) {
-            m_tmpTarget1.move(dataPtrForTuple((int) m_usedTuples + j));
-            index->addEntry(&m_tmpTarget1);
+    if (tupleCount == 0 || m_indexCount == 0) return;
+
+    // The tuples are already in the table, so every index gets the whole
+    // batch at once and can build itself from the sorted keys
+    std::vector<const void*> tuples(tupleCount);
+    for (int j = 0; j < tupleCount; ++j) {
+        tuples[j] = dataPtrForTuple((int) m_usedTuples + j);
+    }
+
+    IndexBuildWork work;
+    work.indexes = m_indexes;
+    work.indexCount = m_indexCount;
+    work.tuples = &tuples;
+    work.next = 0;
+    pthread_mutex_init(&work.lock, NULL);
+
+    // The indexes do not share any state, so big loads build them side by
+    // side. The calling thread builds indexes as well.
+    std::vector<pthread_t> threads;
+    if (tupleCount >= PARALLEL_INDEX_BUILD_MIN_TUPLES) {
+        const int numThreads = std::min(m_indexCount, PARALLEL_INDEX_BUILD_MAX_THREADS);
+        for (int i = 1; i < numThreads; i++) {
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, buildIndexes, &work) != 0) break;
+            threads.push_back(thread);
         }
     }
+    buildIndexes(&work);
+    for (size_t i = 0; i < threads.size(); i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&work.lock);
+
+    if (work.error.empty() == false) {
+        throwFatalException("Failed to build index %s", work.error.c_str());
+    }
 }
 
 size_t PersistentTable::appendToELBuffer(TableTuple &tuple, int64_t seqNo,
@@ -63,12 +63,16 @@
 #include "common/valuevector.h"
 #include "common/tabletuple.h"
 #include "common/Pool.hpp"
+#include "common/BlockAllocator.h"
 #include "storage/table.h"
 #include "storage/TupleStreamWrapper.h"
 #include "storage/TableStats.h"
 #include "storage/PersistentTableStats.h"
 #include "storage/CopyOnWriteContext.h"
 #include "storage/RecoveryContext.h"
+#ifdef ANTICACHE
+#include "anticache/AntiCacheKeyFilter.h"
+#endif
 
 
 namespace voltdb {
@@ -173,6 +177,15 @@ class PersistentTable : public Table {
     bool deleteTuple(TableTuple &tuple, bool freeAllocatedStrings);
     void deleteTupleForUndo(voltdb::TableTuple &tupleCopy, size_t elMark);
 
+    /*
+     * Move live tuples from the end of the table into the slots of deleted
+     * tuples and give the blocks at the end that become empty back to the
+     * allocator. Moves at most maxBytes of tuple data and returns how many
+     * bytes it moved. The tuples get new addresses, so this must not run
+     * while undo actions or iterators refer to them.
+     */
+    int64_t compactTuples(int64_t maxBytes);
+
     /*
      * Lookup the address of the tuple that is identical to the specified tuple.
      * Does a primary key lookup or table scan if necessary.
@@ -281,6 +294,14 @@ class PersistentTable : public Table {
     uint32_t getOldestTupleID();
     void setNumTuplesInEvictionChain(int num_tuples);
     int getNumTuplesInEvictionChain(); 
+#ifdef ANTICACHE_CLOCK
+    // needed for CLOCK eviction
+    inline void setReferenced(uint32_t tuple_id);
+    inline bool clearReferenced(uint32_t tuple_id);
+    inline bool isReferenced(uint32_t tuple_id) const;
+    uint32_t getClockHand();
+    void setClockHand(uint32_t tuple_id);
+#endif
     AntiCacheDB* getAntiCacheDB(int level);
     std::map<int32_t, int32_t> getUnevictedBlockIDs();
     std::vector<char*> getUnevictedBlocks();
@@ -310,6 +331,10 @@ class PersistentTable : public Table {
     void setTuplesRead(int32_t tuplesRead);
     void setBatchEvicted(bool batchEvicted);
     bool isBatchEvicted();
+    // filter over the primary keys of the tuples in the EvictedTable
+    AntiCacheKeyFilter& getEvictedKeyFilter();
+    bool hasEvictedKeyFingerprints();
+    uint32_t getEvictedKeyFingerprint(const TableTuple &tuple);
     void clearUnevictedBlocks();
     void clearMergeTupleOffsets();
     int64_t unevictTuple(ReferenceSerializeInput * in, int j, int merge_tuple_offset, bool blockMerge);
@@ -328,6 +353,9 @@ class PersistentTable : public Table {
 
 protected:
     virtual void allocateNextBlock();
+
+    /** Give a block from allocateNextBlock() back to where it came from */
+    void releaseBlock(char *block);
     
     size_t allocatedBlockCount() const {
         return m_data.size();
@@ -377,6 +405,9 @@ protected:
     TableIndex** m_indexes;
     int m_indexCount;
     TableIndex *m_pkeyIndex;
+    // an index stores INCLUDE columns, which the planner doesn't know about
+    // when it decides whether an update touches the indexes
+    bool m_hasIncludedColumns;
 
     // temporary for tuplestream stuff
     TupleStreamWrapper *m_wrapper;
@@ -403,6 +434,15 @@ protected:
     
     int m_numTuplesInEvictionChain;
     
+#ifdef ANTICACHE_CLOCK
+    // One reference bit per tuple slot, indexed by tuple id. An access
+    // only sets a bit here instead of writing to the tuple header.
+    std::vector<uint64_t> m_referenceBits;
+    uint32_t m_clockHand;
+#endif
+
+    AntiCacheKeyFilter m_evictedKeys;
+
     bool m_blockMerge;
     bool m_batchEvicted;
     
@@ -427,6 +467,9 @@ protected:
     // is Export enabled
     bool m_exportEnabled;
     
+    // Source of the tuple blocks
+    BlockAllocator *m_blockAllocator;
+
     // Snapshot stuff
     boost::scoped_ptr<CopyOnWriteContext> m_COWContext;
 
@@ -440,14 +483,52 @@ inline TableTuple& PersistentTable::getTempTupleInlined(TableTuple &source) {
     return m_tempTuple;
 }
  
+#ifdef ANTICACHE_CLOCK
+inline void PersistentTable::setReferenced(uint32_t tuple_id) {
+    size_t word = tuple_id >> 6;
+    if (word >= m_referenceBits.size()) {
+        m_referenceBits.resize(std::max(word + 1, (size_t)((allocatedTupleCount() + 63) >> 6)), 0);
+    }
+    const uint64_t mask = (uint64_t)1 << (tuple_id & 63);
+    // don't dirty the cache line of a tuple that is already referenced
+    if ((m_referenceBits[word] & mask) == 0) {
+        m_referenceBits[word] |= mask;
+    }
+}
+
+inline bool PersistentTable::clearReferenced(uint32_t tuple_id) {
+    size_t word = tuple_id >> 6;
+    const uint64_t mask = (uint64_t)1 << (tuple_id & 63);
+    if (word >= m_referenceBits.size() || (m_referenceBits[word] & mask) == 0) {
+        return false;
+    }
+    m_referenceBits[word] &= ~mask;
+    return true;
+}
+
+inline bool PersistentTable::isReferenced(uint32_t tuple_id) const {
+    size_t word = tuple_id >> 6;
+    return (word < m_referenceBits.size() &&
+            (m_referenceBits[word] & ((uint64_t)1 << (tuple_id & 63))) != 0);
+}
+#endif
+
 inline void PersistentTable::allocateNextBlock() {
 #ifdef MEMCHECK
     int bytes = m_schema->tupleLength() + TUPLE_HEADER_SIZE;
 #else
     int bytes = m_tableAllocationTargetSize;
 #endif
+#ifdef MEMCHECK
     char *memory = (char*)(new char[bytes]);
-    m_data.push_back(memory);
+#else
+    char *memory = m_blockAllocator->allocate(bytes);
+    BlockAllocator::PageType pageType = m_blockAllocator->pageType(memory);
+    if (pageType == BlockAllocator::PAGES_HUGE || pageType == BlockAllocator::PAGES_TRANSPARENT_HUGE) {
+        m_hugePageBlocks++;
+    }
+#endif
+    addBlock(memory);
 #ifdef ANTICACHE_TIMESTAMPS_PRIME
     m_evictPosition.push_back(0);
     m_stepPrime.push_back(-1);
@@ -55,6 +55,7 @@
 #include "common/FatalException.hpp"
 #include "indexes/tableindex.h"
 #include "storage/tableiterator.h"
+#include "storage/ColumnarBlockStore.h"
 #include "storage/persistenttable.h"
 
 using std::string;
@@ -72,8 +73,12 @@ Table::Table(int tableAllocationTargetSize) :
     m_tuplesPerBlock(0),
     m_tupleLength(0),
     m_nonInlinedMemorySize(0),
+    m_columnarStore(NULL),
     m_columnHeaderData(NULL),
     m_columnHeaderSize(-1),
+    m_tuplesCompacted(0),
+    m_blocksReleased(0),
+    m_hugePageBlocks(0),
     m_columnNames(NULL),
     m_databaseId(-1),
     m_name(""),
@@ -85,6 +90,9 @@ Table::Table(int tableAllocationTargetSize) :
     m_refcount(0),
     m_enableMMAP(false)
 {
+#ifndef MEMCHECK_NOFREELIST
+    m_sortedHoleCount = 0;
+#endif
     #ifdef ANTICACHE
     m_tuplesEvicted = 0;
     m_blocksEvicted = 0;
@@ -97,6 +105,11 @@ Table::Table(int tableAllocationTargetSize) :
     m_tuplesRead = 0;
     m_blocksRead = 0;
     m_bytesRead = 0;
+
+    m_bytesUncompressed = 0;
+    m_bytesCompressed = 0;
+    m_compressMicros = 0;
+    m_decompressMicros = 0;
     #endif
 }
 
@@ -111,8 +124,12 @@ Table::Table(int tableAllocationTargetSize, bool enableMMAP) :
     m_tuplesPerBlock(0),
     m_tupleLength(0),
     m_nonInlinedMemorySize(0),
+    m_columnarStore(NULL),
     m_columnHeaderData(NULL),
     m_columnHeaderSize(-1),
+    m_tuplesCompacted(0),
+    m_blocksReleased(0),
+    m_hugePageBlocks(0),
     m_columnNames(NULL),
     m_databaseId(-1),
     m_name(""),
@@ -124,6 +141,9 @@ Table::Table(int tableAllocationTargetSize, bool enableMMAP) :
     m_refcount(0),
     m_enableMMAP(enableMMAP)
 {
+#ifndef MEMCHECK_NOFREELIST
+    m_sortedHoleCount = 0;
+#endif
     #ifdef ANTICACHE
     m_tuplesEvicted = 0;
     m_blocksEvicted = 0;
@@ -136,6 +156,11 @@ Table::Table(int tableAllocationTargetSize, bool enableMMAP) :
     m_tuplesRead = 0;
     m_blocksRead = 0;
     m_bytesRead = 0;
+
+    m_bytesUncompressed = 0;
+    m_bytesCompressed = 0;
+    m_compressMicros = 0;
+    m_decompressMicros = 0;
     #endif
 }
 
@@ -155,6 +180,9 @@ Table::~Table() {
     delete[] reinterpret_cast<char*>(m_tempTuple.m_data);
     m_tempTuple.m_data = NULL;
 
+    delete m_columnarStore;
+    m_columnarStore = NULL;
+
     /*
      * The memcheck build uses the heap to allocate each tuple in order to
      * detect errors while accessing tuples as well as tuples storage pointers
@@ -174,6 +202,7 @@ Table::~Table() {
     m_allocatedTuplePointers.clear();
     m_deletedTuplePointers.clear();
     m_data.clear();
+    m_blockDirectory.clear();
 #else
     /** Clean only if MMAP is not enabled **/
     if(m_enableMMAP == false){
@@ -232,6 +261,7 @@ void Table::initializeWithColumns(TupleSchema *schema, const std::string* column
     m_deletedTupleCount = 0;
 #else
     m_holeFreeTuples.clear();//Why clear it. Shouldn't it be empty? Won't this leak?
+    m_sortedHoleCount = 0;
 #endif
 
     m_tupleLength = m_schema->tupleLength() + TUPLE_HEADER_SIZE;
@@ -248,6 +278,12 @@ void Table::initializeWithColumns(TupleSchema *schema, const std::string* column
     m_tmpTarget1 = TableTuple(m_schema);
     m_tmpTarget2 = TableTuple(m_schema);
 
+    // the minipage layout depends on the schema
+    if (m_columnarStore != NULL) {
+        delete m_columnarStore;
+        m_columnarStore = new ColumnarBlockStore(m_schema, m_tuplesPerBlock, m_tupleLength);
+    }
+
     onSetColumns(); // for more initialization
 }
 
@@ -266,8 +302,14 @@ void Table::nextFreeTuple(TableTuple *tuple) {
         VOLT_TRACE("GRABBED FREE TUPLE!\n");
         char* ret = m_holeFreeTuples.back();
         m_holeFreeTuples.pop_back();
+        if (m_sortedHoleCount > m_holeFreeTuples.size()) {
+            m_sortedHoleCount = m_holeFreeTuples.size();
+        }
         assert (m_columnCount == tuple->sizeInValues());
         tuple->move(ret);
+        if (m_columnarStore != NULL) {
+            markColumnarBlockDirty(ret);
+        }
         return;
     }
 #endif
@@ -282,10 +324,42 @@ void Table::nextFreeTuple(TableTuple *tuple) {
     assert (m_usedTuples < m_allocatedTuples);
     assert (m_columnCount == tuple->sizeInValues());
     tuple->move(dataPtrForTuple((int) m_usedTuples));
+    if (m_columnarStore != NULL) {
+        m_columnarStore->markDirty(m_usedTuples / m_tuplesPerBlock);
+    }
     ++m_usedTuples;
     //cout << "table::nextFreeTuple(" << reinterpret_cast<const void *>(this) << ") m_usedTuples == " << m_usedTuples << endl;
 }
 
+void Table::markColumnarBlockDirty(const char *tuple_address) {
+    assert(m_columnarStore != NULL);
+    int tupleId = getTupleID(tuple_address);
+    if (tupleId >= 0) {
+        m_columnarStore->markDirty(tupleId / m_tuplesPerBlock);
+    }
+}
+
+// ------------------------------------------------------------------
+// COLUMNAR (PAX) BLOCKS
+// ------------------------------------------------------------------
+void Table::enableColumnarStore() {
+    assert(m_schema != NULL);
+    if (m_columnarStore == NULL) {
+        m_columnarStore = new ColumnarBlockStore(m_schema, m_tuplesPerBlock, m_tupleLength);
+        VOLT_DEBUG("Enabled columnar storage for table '%s'", m_name.c_str());
+    }
+}
+
+const char* Table::getColumnarBlock(int blockIndex, char* &rowData, uint32_t &tupleCount) {
+    assert(m_columnarStore != NULL);
+    assert(blockIndex >= 0 && blockIndex < static_cast<int>(m_data.size()));
+    rowData = m_data[blockIndex];
+    uint32_t firstTuple = static_cast<uint32_t>(blockIndex) * m_tuplesPerBlock;
+    tupleCount = (m_usedTuples > firstTuple ? m_usedTuples - firstTuple : 0);
+    if (tupleCount > m_tuplesPerBlock) tupleCount = m_tuplesPerBlock;
+    return (m_columnarStore->getBlock(blockIndex, rowData, tupleCount));
+}
+
 // ------------------------------------------------------------------
 // COLUMNS
 // ------------------------------------------------------------------
@@ -46,7 +46,9 @@
 #ifndef HSTORETABLE_H
 #define HSTORETABLE_H
 
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 #ifdef MEMCHECK_NOFREELIST
 #include <set>
@@ -73,6 +75,7 @@ class ReadWriteSet;
 class SerializeInput;
 class SerializeOutput;
 class TableStats;
+class ColumnarBlockStore;
 class StatsSource;
 class StreamBlock;
 class Topend;
@@ -186,6 +189,18 @@ public:
         return m_usedTuples;
     }
     
+    /*
+     * Count of tuple slots below usedTupleCount() that were freed by deletes
+     * and have not been reused yet
+     */
+    int64_t freeTupleSlotCount() const {
+#ifdef MEMCHECK_NOFREELIST
+        return 0;
+#else
+        return static_cast<int64_t>(m_holeFreeTuples.size());
+#endif
+    }
+
     virtual int64_t allocatedTupleMemory() const {
         return allocatedBlockCount() * m_tableAllocationSize;
     }
@@ -209,7 +224,22 @@ public:
     inline void updateTupleAccessCount() {
         m_tupleAccesses++;
     }
+
+    inline void updateTupleAccessCount(int64_t accesses) {
+        m_tupleAccesses += static_cast<uint32_t>(accesses);
+    }
     
+    /**
+     * Tuples moved and blocks given back to the allocator by compaction
+     */
+    inline int64_t getTuplesCompacted() const { return (m_tuplesCompacted); }
+    inline int32_t getBlocksReleased() const { return (m_blocksReleased); }
+
+    /**
+     * Blocks currently backed by explicit or transparent huge pages
+     */
+    inline int32_t getHugePageBlocks() const { return (m_hugePageBlocks); }
+
     #ifdef ANTICACHE
     inline int32_t getTuplesEvicted() const { return (m_tuplesEvicted); }
     inline int32_t getBlocksEvicted() const { return (m_blocksEvicted); }
@@ -223,10 +253,54 @@ public:
     inline int32_t getBlocksRead() const { return (m_blocksRead); }
     inline int64_t getBytesRead()  const { return (m_bytesRead); }
 
+    inline int64_t getBytesUncompressed() const { return (m_bytesUncompressed); }
+    inline int64_t getBytesCompressed() const { return (m_bytesCompressed); }
+    inline int64_t getCompressMicros() const { return (m_compressMicros); }
+    inline int64_t getDecompressMicros() const { return (m_decompressMicros); }
+
+    /**
+     * Account for a block that went through the anti-cache codec
+     */
+    inline void recordCompression(int64_t bytesUncompressed, int64_t bytesCompressed, int64_t micros) {
+        m_bytesUncompressed += bytesUncompressed;
+        m_bytesCompressed += bytesCompressed;
+        m_compressMicros += micros;
+    }
+    inline void recordDecompression(int64_t micros) {
+        m_decompressMicros += micros;
+    }
+
     virtual std::vector<AntiCacheDB*> allACDBs() const;
     #endif
     
-    int getTupleID(const char* tuple_address); 
+    /**
+     * Returns the offset of the tuple at the given address within this table
+     * (i.e., the index that dataPtrForTuple() would map back to this address),
+     * or -1 if the address is not inside one of this table's blocks.
+     * This is a binary search over m_blockDirectory, not a scan of m_data.
+     */
+    int getTupleID(const char* tuple_address);
+
+    // ------------------------------------------------------------------
+    // COLUMNAR (PAX) BLOCKS
+    // ------------------------------------------------------------------
+    /**
+     * Keep a columnar copy of the fixed-width numeric columns for every
+     * block of this table. See ColumnarBlockStore.
+     */
+    void enableColumnarStore();
+    inline ColumnarBlockStore* columnarStore() const { return m_columnarStore; }
+
+    /**
+     * Returns the columnar minipage for the given block, rebuilding it if
+     * the block has changed. The row-major block and the number of slots
+     * in use in that block are returned through rowData and tupleCount.
+     * The table must have a columnar store.
+     */
+    const char* getColumnarBlock(int blockIndex, char* &rowData, uint32_t &tupleCount);
+
+    inline int blockCount() const { return static_cast<int>(m_data.size()); }
+    inline uint32_t tuplesPerBlock() const { return m_tuplesPerBlock; }
 
     // ------------------------------------------------------------------
     // COLUMNS
@@ -368,12 +442,35 @@ protected:
     char * dataPtrForTupleForced(const int index);
     virtual void allocateNextBlock();
 
+    /**
+     * Append a newly allocated block to m_data and record it in the block
+     * directory. Every allocateNextBlock() implementation must go through here.
+     */
+    void addBlock(char *block);
+
+    /**
+     * Remove the last block from m_data and the block directory.
+     * The caller is responsible for releasing the memory.
+     */
+    char* removeLastBlock();
+
+    /**
+     * Remove a block from the block directory without touching m_data.
+     */
+    void unregisterBlock(const char *block);
+
     /**
      * Normally this will return the tuple storage to the free list.
      * In the memcheck build it will return the storage to the heap.
      */
     void deleteTupleStorage(TableTuple &tuple);
 
+    /**
+     * Flag the columnar minipage of the block holding this tuple as stale.
+     * Must be called whenever a tuple's storage is written in place.
+     */
+    void markColumnarBlockDirty(const char *tuple_address);
+
     void initializeWithColumns(TupleSchema *schema, const std::string* columnNames, bool ownsTupleSchema);
     virtual void onSetColumns() {};
 
@@ -394,6 +491,16 @@ protected:
     // pointers to chunks of data
     std::vector<char*> m_data;
 
+    /**
+     * (block address, index in m_data) pairs kept sorted by address so that
+     * we can map a tuple address back to its block in O(log #blocks)
+     */
+    typedef std::pair<char*, int> BlockDirectoryEntry;
+    std::vector<BlockDirectoryEntry> m_blockDirectory;
+
+    // columnar copy of m_data, or NULL for row-only tables
+    ColumnarBlockStore *m_columnarStore;
+
     char *m_columnHeaderData;
     int32_t m_columnHeaderSize;
 
@@ -412,6 +519,12 @@ protected:
     int32_t m_tuplesRead;
     int32_t m_blocksRead;
     int64_t m_bytesRead;
+
+    // GLOBAL COMPRESSION
+    int64_t m_bytesUncompressed;
+    int64_t m_bytesCompressed;
+    int64_t m_compressMicros;
+    int64_t m_decompressMicros;
 #endif
 
 #ifdef ANTICACHE_TIMESTAMPS_PRIME
@@ -437,8 +550,22 @@ protected:
      * NOTE THAT THESE ARE NOT THE ONLY FREE TUPLES.
     */
     std::vector<char*> m_holeFreeTuples;
+
+    /**
+     * The first m_sortedHoleCount entries of m_holeFreeTuples are ordered
+     * by their position in the table, highest first. Compaction keeps them
+     * that way; deletes append unsorted entries after them.
+     */
+    size_t m_sortedHoleCount;
 #endif
 
+    // COMPACTION
+    int64_t m_tuplesCompacted;
+    int32_t m_blocksReleased;
+
+    // HUGE PAGES
+    int32_t m_hugePageBlocks;
+
     // schema
     std::string* m_columnNames; // array of string names
 
@@ -510,7 +637,7 @@ inline void Table::allocateNextBlock() {
     int bytes = m_tableAllocationTargetSize;
 #endif
     char *memory = (char*)(new char[bytes]);
-    m_data.push_back(memory);
+    addBlock(memory);
 #ifdef ANTICACHE_TIMESTAMPS_PRIME
     m_evictPosition.push_back(0);
     m_stepPrime.push_back(-1);
@@ -530,44 +657,55 @@ inline void Table::allocateNextBlock() {
     }
 }
     
+inline bool blockDirectoryAddressComparator(const char *address,
+                                            const std::pair<char*, int> &entry) {
+    return address < entry.first;
+}
+
+inline void Table::addBlock(char *block) {
+    BlockDirectoryEntry entry(block, static_cast<int>(m_data.size()));
+    m_data.push_back(block);
+    // Blocks usually come back from the allocator at increasing addresses,
+    // so this is almost always an append
+    std::vector<BlockDirectoryEntry>::iterator pos =
+        std::upper_bound(m_blockDirectory.begin(), m_blockDirectory.end(),
+                         block, blockDirectoryAddressComparator);
+    m_blockDirectory.insert(pos, entry);
+}
+
+inline void Table::unregisterBlock(const char *block) {
+    std::vector<BlockDirectoryEntry>::iterator pos =
+        std::upper_bound(m_blockDirectory.begin(), m_blockDirectory.end(),
+                         block, blockDirectoryAddressComparator);
+    if (pos != m_blockDirectory.begin() && (--pos)->first == block) {
+        m_blockDirectory.erase(pos);
+    }
+}
+
+inline char* Table::removeLastBlock() {
+    char *block = m_data.back();
+    m_data.pop_back();
+    unregisterBlock(block);
+    return block;
+}
+
 inline int Table::getTupleID(const char* tuple_address)
-{    
-    char* addr; 
-    int tuple_id = 0; 
-    
-    int tuple_size = m_schema->tupleLength() + TUPLE_HEADER_SIZE; 
-    long offset;
-    
-    for(int i = 0; i < m_data.size(); i++)  // iterate through blocks
-    {
-        addr = m_data[i]; 
-        
-        // tuple cannot be in this block, so increment id and skip to the next block
-        if((tuple_address < addr) || (tuple_address > (addr + (tuple_size*m_tuplesPerBlock)))
-           )
-        {
-            tuple_id += m_tuplesPerBlock; 
-            continue; 
-        }
+{
+    // Find the last block that starts at or before this address
+    std::vector<BlockDirectoryEntry>::const_iterator pos =
+        std::upper_bound(m_blockDirectory.begin(), m_blockDirectory.end(),
+                         tuple_address, blockDirectoryAddressComparator);
+    if (pos == m_blockDirectory.begin()) {
+        return -1; // no matching tuple was found
+    }
+    --pos;
 
-        offset = ((long)tuple_address - (long)addr) / tuple_size;
-        if (addr + offset * tuple_size == tuple_address)
-            return tuple_id + (int)offset;
-        
-        /*for(int j = 0; j < m_tuplesPerBlock; j++)  // iterate through tuples in a block
-        {
-            if(addr == tuple_address)
-            {
-                return tuple_id; 
-            }
-            
-            addr += tuple_size; // advance pointer to next tuple
-            tuple_id++; 
-        }*/
-        
+    const char *addr = pos->first;
+    long offset = (long)(tuple_address - addr) / m_tupleLength;
+    if (offset >= m_tuplesPerBlock || addr + offset * m_tupleLength != tuple_address) {
+        return -1; // not in this block or not aligned to a tuple
     }
-    
-    return -1; // no matching tuple was found
+    return pos->second * m_tuplesPerBlock + (int)offset;
 }
 
 #ifdef MEMCHECK_NOFREELIST
@@ -580,6 +718,7 @@ inline void Table::deleteTupleStorage(TableTuple &tuple) {
      * Delete the tuple so valgrind can catch future invalid access
      * and NULL out the reference in m_data so TableIterator can skip it.
      */
+    unregisterBlock(tuple.address());
     delete []tuple.address();
     for (std::vector<char*>::iterator iter = m_data.begin(); iter != m_data.end(); ++iter) {
         if (*iter == tuple.address()) {
@@ -595,6 +734,9 @@ inline void Table::deleteTupleStorage(TableTuple &tuple) {
     tuple.setDeletedTrue(); // does NOT free strings
     tuple.setEvictedFalse();
     tuple.setNVMEvictedFalse();
+    if (m_columnarStore != NULL) {
+        markColumnarBlockDirty(tuple.address());
+    }
 
     // add to the free list
     m_tupleCount--;
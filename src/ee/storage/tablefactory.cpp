@@ -289,11 +289,15 @@ void TableFactory::initConstraints(PersistentTable* table) {
 
     // count the unique indexes
     table->m_uniqueIndexCount = 0;
+    table->m_hasIncludedColumns = false;
     for (int i = 0; i < table->m_indexCount; ++i) {
         TableIndex *index = table->m_indexes[i];
         if (index->isUniqueIndex()) {
             table->m_uniqueIndexCount++;
         }
+        if (index->getIncludedColumnIndices().empty() == false) {
+            table->m_hasIncludedColumns = true;
+        }
     }
 
     if (table->m_uniqueIndexes)
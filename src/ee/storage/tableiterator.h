@@ -69,6 +69,12 @@ public:
      * We will first iterate over the nested instance and then continue with the parent
      */
     TableIterator(const Table *parent, TableIterator *nested, bool scanAllBlocks = false);
+
+    /**
+     * Iterate over the tuple slots [start, end) only, e.g. to split a scan
+     * across threads. start must be the first slot of a block.
+     */
+    TableIterator(const Table *parent, uint32_t start, uint32_t end);
     
     /**
      * Updates the given tuple so that it points to the next tuple in the table.
@@ -100,6 +106,8 @@ private:
     TableIterator *m_nestedIterator;
     
     uint32_t m_location;
+    // slots from here on are not scanned
+    uint32_t m_endLocation;
     uint32_t m_activeTuples;
     uint32_t m_foundTuples;
     uint32_t m_tupleLength;
@@ -111,7 +119,7 @@ private:
 inline TableIterator::TableIterator(const Table *parent, bool scanAllBlocks)
     : m_scanAllBlocksOrCountFoundTuples(scanAllBlocks),
       m_table(parent), m_dataPtr(NULL), m_nestedIterator(NULL), m_location(0),
-    m_activeTuples((int) m_table->m_tupleCount),
+    m_endLocation(UINT32_MAX), m_activeTuples((int) m_table->m_tupleCount),
     m_foundTuples(0), m_tupleLength(parent->m_tupleLength),
     m_tuplesPerBlock(parent->m_tuplesPerBlock), m_blockIndex(0), m_useNested(false)
     {}
@@ -120,10 +128,20 @@ inline TableIterator::TableIterator(const Table *parent, bool scanAllBlocks)
 inline TableIterator::TableIterator(const Table *parent, TableIterator *nested, bool scanAllBlocks)
     : m_scanAllBlocksOrCountFoundTuples(scanAllBlocks),
       m_table(parent), m_dataPtr(NULL), m_nestedIterator(nested), m_location(0),
-    m_activeTuples((int) m_table->m_tupleCount),
+    m_endLocation(UINT32_MAX), m_activeTuples((int) m_table->m_tupleCount),
     m_foundTuples(0), m_tupleLength(parent->m_tupleLength),
     m_tuplesPerBlock(parent->m_tuplesPerBlock), m_blockIndex(0), m_useNested(true)
     {}
+
+inline TableIterator::TableIterator(const Table *parent, uint32_t start, uint32_t end)
+    : m_scanAllBlocksOrCountFoundTuples(true),
+      m_table(parent), m_dataPtr(NULL), m_nestedIterator(NULL), m_location(start),
+    m_endLocation(end), m_activeTuples((int) m_table->m_tupleCount),
+    m_foundTuples(0), m_tupleLength(parent->m_tupleLength),
+    m_tuplesPerBlock(parent->m_tuplesPerBlock), m_blockIndex(0), m_useNested(false)
+    {
+        assert(start % m_tuplesPerBlock == 0);
+    }
     
 
 inline bool TableIterator::continuationPredicate() {
@@ -140,7 +158,7 @@ inline bool TableIterator::continuationPredicate() {
         /*
          * Scan until there are no more blocks to scan
          */
-        return m_location < m_table->m_usedTuples;
+        return m_location < m_table->m_usedTuples && m_location < m_endLocation;
     } else {
         /*
          * Scan until all active tuples have been found
@@ -156,6 +156,9 @@ inline void TempTable::insertTupleNonVirtual(TableTuple &source) {
 inline void TempTable::updateTupleNonVirtual(TableTuple &source, TableTuple &target) {
     // Copy the source tuple into the target
     target.copy(source);
+    if (m_columnarStore != NULL) {
+        markColumnarBlockDirty(target.address());
+    }
 }
 
 inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
@@ -197,8 +200,7 @@ inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
         //Chunks and individual tuples storage are the same in the memcheck build so
         //when doing memcheck call delete tuple storage to delete the chunk in order
         //to correctly update the metadata kept in the memcheck build
-        char* chunk = m_data.back();
-        m_data.pop_back();
+        char* chunk = removeLastBlock();
         m_allocatedTuples -= m_tuplesPerBlock;
         // if keeping track of fragment temp memory, decrease it here
         if (m_tempTableMemoryInBytes)
@@ -210,8 +212,7 @@ inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
         // deleteTupleStorage mutates m_tupleCount. Fix it explictly.
         m_tupleCount = 0;
 #elif defined(MEMCHECK)
-        char* chunk = m_data.back();
-        m_data.pop_back();
+        char* chunk = removeLastBlock();
         m_allocatedTuples -= m_tuplesPerBlock;
         if (m_tempTableMemoryInBytes) {
             (*m_tempTableMemoryInBytes) -= (m_schema->tupleLength() + TUPLE_HEADER_SIZE);
@@ -219,8 +220,7 @@ inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
         assert(chunk != NULL);
         delete[] chunk;
 #else
-        char* chunk = m_data.back();
-        m_data.pop_back();
+        char* chunk = removeLastBlock();
         m_allocatedTuples -= m_tuplesPerBlock;
         // if keeping track of fragment temp memory, decrease it here
         if (m_tempTableMemoryInBytes)
@@ -243,6 +243,9 @@ inline void TempTable::getNextFreeTupleInlined(TableTuple *tuple) {
     assert (m_usedTuples < m_allocatedTuples);
     assert (m_columnCount == tuple->sizeInValues());
     tuple->move(dataPtrForTuple((int) m_usedTuples));
+    if (m_columnarStore != NULL) {
+        markColumnarBlockDirty(tuple->address());
+    }
     ++m_usedTuples;
 }
 
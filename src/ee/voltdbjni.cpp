@@ -1021,6 +1021,48 @@ SHAREDLIB_JNIEXPORT jboolean JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeS
     return false;
 }
 
+/*
+ * Class:     org_voltdb_jni_ExecutionEngine
+ * Method:    nativeSetFragmentCompileThreshold
+ * Signature: (JJ)I
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeSetFragmentCompileThreshold
+  (JNIEnv *env, jobject obj, jlong engine_ptr, jlong threshold) {
+    VOLT_DEBUG("nativeSetFragmentCompileThreshold in C++ called");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    try {
+        engine->setFragmentCompileThreshold(static_cast<int64_t>(threshold));
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
+/*
+ * Class:     org_voltdb_jni_ExecutionEngine
+ * Method:    nativeSetParallelScans
+ * Signature: (JIJ)I
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeSetParallelScans
+  (JNIEnv *env, jobject obj, jlong engine_ptr, jint threads, jlong minTuples) {
+    VOLT_DEBUG("nativeSetParallelScans in C++ called");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    if (engine == NULL || threads < 1) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    try {
+        engine->setParallelScans(threads, static_cast<int64_t>(minTuples));
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
 /*
  * Class:     org_voltdb_jni_ExecutionEngine
  * Method:    nativeActivateTableStream
@@ -1454,7 +1496,10 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiC
         jint dbType,
         jboolean blocking,
         jlong maxSize,
-        jboolean blockMerge
+        jboolean blockMerge,
+        jint maxQueuedBlocks,
+        jint codecType,
+        jint dictionaryBlocks
         ) {
     
     VOLT_DEBUG("nativeAntiCacheInitialize() start");
@@ -1468,7 +1513,8 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiC
         std::string dbDirString(dbDirChars);
         env->ReleaseStringUTFChars(dbDir, dbDirChars);
         
-        engine->antiCacheInitialize(dbDirString, static_cast<AntiCacheDBType>(dbType), blocking, static_cast<int64_t>(blockSize),static_cast<int64_t>(maxSize), blockMerge);
+        engine->antiCacheInitialize(dbDirString, static_cast<AntiCacheDBType>(dbType), blocking, static_cast<int64_t>(blockSize),static_cast<int64_t>(maxSize), blockMerge, maxQueuedBlocks,
+                                    static_cast<AntiCacheCodecType>(codecType), dictionaryBlocks);
     } catch (FatalException e) {
         topend->crashVoltDB(e);
     }
@@ -103,6 +103,7 @@ import org.voltdb.jni.ExecutionEngineJNI;
 import org.voltdb.jni.MockExecutionEngine;
 import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.messaging.FastSerializer;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 import org.voltdb.types.SpecExecSchedulerPolicyType;
 import org.voltdb.types.SpeculationConflictCheckerType;
@@ -814,6 +815,9 @@ public class PartitionExecutor implements Runnable, Configurable, Shutdownable {
                // Initialize Anti-Cache
                 if (hstore_conf.site.anticache_enable) {
                     boolean blockMerge = hstore_conf.site.anticache_block_merge;
+                    int maxQueuedBlocks = hstore_conf.site.anticache_async_writes;
+                    AntiCacheCodecType codecType = AntiCacheCodecType.get(hstore_conf.site.anticache_compression);
+                    int dictionaryBlocks = hstore_conf.site.anticache_compression_dictionary;
                     if (!hstore_conf.site.anticache_enable_multilevel) {
                         File acFile = AntiCacheManager.getDatabaseDir(this, 0);
                         long blockSize = hstore_conf.site.anticache_block_size;
@@ -823,7 +827,7 @@ public class PartitionExecutor implements Runnable, Configurable, Shutdownable {
                         long dbSize = parseSize(hstore_conf.site.anticache_dbsize);
                         LOG.info(String.format("Creating AntiCacheDB type: %d blocking: %b blockmerge: %b blocksize: %d maxsize: %d @ %s (dbtype: %s)", 
                                   dbType.ordinal(), blocking, blockMerge, blockSize, dbSize, acFile.getAbsolutePath(), hstore_conf.site.anticache_dbtype));
-                        eeTemp.antiCacheInitialize(acFile, dbType, blocking, blockSize, dbSize, blockMerge);
+                        eeTemp.antiCacheInitialize(acFile, dbType, blocking, blockSize, dbSize, blockMerge, maxQueuedBlocks, codecType, dictionaryBlocks);
                     } else {
                     // if we are using multilevel, ignore single config options and parse string
                         String config = hstore_conf.site.anticache_levels;
@@ -848,7 +852,7 @@ public class PartitionExecutor implements Runnable, Configurable, Shutdownable {
                             LOG.info(String.format("Creating AntiCacheDB type: %d blocking: %b blockMerge: %b blocksize: %d maxsize: %d @ %s", 
                                   dbType.ordinal(), blocking, blockMerge, blockSize, maxSize, acFile.getAbsolutePath()));
                             if (i == 0) {
-                                eeTemp.antiCacheInitialize(acFile, dbType, blocking, blockSize, maxSize, blockMerge);
+                                eeTemp.antiCacheInitialize(acFile, dbType, blocking, blockSize, maxSize, blockMerge, maxQueuedBlocks, codecType, dictionaryBlocks);
                             } else {
                                 eeTemp.antiCacheAddDB(acFile, dbType, blocking, blockSize, maxSize, blockMerge);
                         
@@ -872,6 +876,15 @@ public class PartitionExecutor implements Runnable, Configurable, Shutdownable {
                     eeTemp.ARIESInitialize(dbFile, logFile);
                 }                            
                 
+                // Compiled plan fragments
+                eeTemp.setFragmentCompileThreshold(hstore_conf.site.exec_compile_threshold);
+                
+                // Parallel scans
+                if (hstore_conf.site.exec_parallel_scan_threads > 1) {
+                    eeTemp.setParallelScans(hstore_conf.site.exec_parallel_scan_threads,
+                                            hstore_conf.site.exec_parallel_scan_min_tuples);
+                }
+                
                 // Important: This has to be called *after* we initialize the anti-cache
                 //            and the storage information!
                 eeTemp.loadCatalog(catalogContext.catalog.serialize());
@@ -456,6 +456,35 @@ public final class HStoreConf {
             experimental=true
         )
         public boolean exec_readwrite_tracking;
+        
+        @ConfigProperty(
+            description="Number of times that a plan fragment has to be executed at a partition before " +
+                        "the ExecutionEngine compiles the predicates of its scans. " +
+                        "Zero compiles every plan fragment as soon as it is loaded and a negative value " +
+                        "turns compilation off.",
+            defaultInt=100,
+            experimental=true
+        )
+        public int exec_compile_threshold;
+        
+        @ConfigProperty(
+            description="Number of threads (including the PartitionExecutor's own thread) that the " +
+                        "ExecutionEngine splits the scan of a read-only, aggregating plan fragment across. " +
+                        "The partition stays locked while the fragment runs, so the other threads only " +
+                        "read. One thread keeps every plan fragment single-threaded. " +
+                        "See ${site.exec_parallel_scan_min_tuples}.",
+            defaultInt=1,
+            experimental=true
+        )
+        public int exec_parallel_scan_threads;
+        
+        @ConfigProperty(
+            description="Number of tuples that a plan fragment has to scan before the ExecutionEngine " +
+                        "splits the scan across ${site.exec_parallel_scan_threads} threads.",
+            defaultLong=1000000,
+            experimental=true
+        )
+        public long exec_parallel_scan_min_tuples;
 
         // ----------------------------------------------------------------------------
         // Speculative Execution Options
@@ -789,6 +818,34 @@ public final class HStoreConf {
         )
         public boolean anticache_block_merge;
 
+        @ConfigProperty(
+                description="Number of evicted blocks per anti-cache level that may wait to be written " +
+                            "out by a background thread while the partition goes on executing. " +
+                            "Zero writes every evicted block synchronously.",
+                defaultInt=0,
+                experimental=true
+        )
+        public int anticache_async_writes;
+
+        @ConfigProperty(
+                description="Codec that the anti-cache compresses evicted blocks with before they " +
+                            "are written out.",
+                defaultString="NONE",
+                experimental=true,
+                enumOptions="org.voltdb.types.AntiCacheCodecType"
+        )
+        public String anticache_compression;
+
+        @ConfigProperty(
+                description="Number of evicted blocks of each table that the anti-cache trains a " +
+                            "compression dictionary from. The blocks after these are compressed with " +
+                            "the table's dictionary. Zero compresses every block on its own. " +
+                            "See ${site.anticache_compression}.",
+                defaultInt=0,
+                experimental=true
+        )
+        public int anticache_compression_dictionary;
+
         @ConfigProperty(
             description="Enable the anti-cache counted merge-back feature. This requires that the system " +
             		    "is compiled with ${site.anticache_enable} set to true and " +
@@ -813,6 +870,15 @@ public final class HStoreConf {
             experimental=true
         )
         public boolean anticache_timestamps_prime;
+
+        @ConfigProperty(
+            description="Use a CLOCK eviction policy with a side array of reference bits instead of " +
+                        "the LRU chain or the timestamps in the tuple headers. This requires that the " +
+                        "system is compiled with ${site.anticache_enable} set to true.",
+            defaultBoolean=false,
+            experimental=true
+        )
+        public boolean anticache_clock;
         
         // ----------------------------------------------------------------------------
         // Storage MMAP Options
@@ -855,6 +921,20 @@ public final class HStoreConf {
         )
         public long storage_mmap_sync_frequency; 
 
+        // ----------------------------------------------------------------------------
+        // Storage Huge Page Options
+        // ----------------------------------------------------------------------------
+
+        @ConfigProperty(
+            description="Back table storage blocks with 2MB huge pages that are bound to the " +
+                        "NUMA node of each partition's core. Falls back to transparent huge pages " +
+                        "and then to regular pages when none are available. " +
+                        "This is a compile-time option for the EE.",
+            defaultBoolean=false,
+            experimental=true
+        )
+        public boolean storage_hugepages;
+
         // ----------------------------------------------------------------------------
         // ARIES Physical Recovery Options
         // ----------------------------------------------------------------------------
@@ -398,23 +398,29 @@ public abstract class PlanOptimizerUtil {
         // // the guid
         // node.setDistinctColumnGuid(new_pc.guid());
 
-        PlanColumn found = null;
-        for (Integer new_guid : node.getOutputColumnGUIDs()) {
-            PlanColumn new_pc = state.plannerContext.get(new_guid);
-            assert (new_pc != null);
-            if (new_pc.equals(orig_pc, true, true)) {
-                found = new_pc;
-                break;
-            }
+        List<Integer> new_guids = new ArrayList<Integer>();
+        for (Integer guid : node.getDistinctColumnGuids()) {
+            PlanColumn pc = state.plannerContext.get(guid);
+            assert (pc != null);
+            PlanColumn found = null;
+            for (Integer new_guid : node.getOutputColumnGUIDs()) {
+                PlanColumn new_pc = state.plannerContext.get(new_guid);
+                assert (new_pc != null);
+                if (new_pc.equals(pc, true, true)) {
+                    found = new_pc;
+                    break;
+                }
+            } // FOR
+            assert(found != null) :
+                "Failed to find DistinctColumn " + pc + " in " + node + " output columns";
+            new_guids.add(found.guid());
         } // FOR
-        assert(found != null) :
-            "Failed to find DistinctColumn " + orig_pc + " in " + node + " output columns";
-        node.setDistinctColumnGuid(found.guid());
+        node.setDistinctColumnGuids(new_guids);
 
         state.markDirty(node);
         if (debug.val)
             LOG.debug(String.format("Updated %s with proper distinct column guid: ORIG[%d] => NEW[%d]",
-                                    node, orig_guid, found.guid()));
+                                    node, orig_guid, node.getDistinctColumnGuid()));
 
         return (true);
     }
@@ -1203,8 +1209,8 @@ public abstract class PlanOptimizerUtil {
                 // DistinctPlanNode
                 // ---------------------------------------------------
                 else if (element instanceof DistinctPlanNode) {
-                    ctr++;
-                    col_guids.add(((DistinctPlanNode) element).getDistinctColumnGuid());
+                    ctr += ((DistinctPlanNode) element).getDistinctColumnGuids().size();
+                    col_guids.addAll(((DistinctPlanNode) element).getDistinctColumnGuids());
                 }
                 // ---------------------------------------------------
                 // OrderByPlanNode
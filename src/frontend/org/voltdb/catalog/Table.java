@@ -36,6 +36,7 @@ public class Table extends CatalogType {
     boolean m_mapreduce;
     boolean m_evictable;
     boolean m_batchEvicted;
+    boolean m_columnar;
 
     void setBaseValues(Catalog catalog, CatalogType parent, String path, String name) {
         super.setBaseValues(catalog, parent, path, name);
@@ -55,6 +56,7 @@ public class Table extends CatalogType {
         m_fields.put("mapreduce", m_mapreduce);
         m_fields.put("evictable", m_evictable);
         m_fields.put("batchEvicted", m_batchEvicted);
+        m_fields.put("columnar", m_columnar);
     }
 
     public void update() {
@@ -64,6 +66,7 @@ public class Table extends CatalogType {
         m_mapreduce = (Boolean) m_fields.get("mapreduce");
         m_evictable = (Boolean) m_fields.get("evictable");
         m_batchEvicted = (Boolean) m_fields.get("batchEvicted");
+        m_columnar = (Boolean) m_fields.get("columnar");
     }
 
     /** GETTER: The set of columns in the table */
@@ -142,6 +145,11 @@ public class Table extends CatalogType {
         return m_batchEvicted;
     }
 
+    /** GETTER: Should this table keep a columnar (PAX) copy of its numeric columns for scans? */
+    public boolean getColumnar() {
+        return m_columnar;
+    }
+
     /** SETTER: Is the table replicated? */
     public void setIsreplicated(boolean value) {
         m_isreplicated = value; m_fields.put("isreplicated", value);
@@ -182,4 +190,9 @@ public class Table extends CatalogType {
         m_batchEvicted = value; m_fields.put("batchEvicted", value);
     }
 
+    /** SETTER: Should this table keep a columnar (PAX) copy of its numeric columns for scans? */
+    public void setColumnar(boolean value) {
+        m_columnar = value; m_fields.put("columnar", value);
+    }
+
 }
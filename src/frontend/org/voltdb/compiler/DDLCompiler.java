@@ -432,7 +432,9 @@ public class DDLCompiler {
 
         // set the type of the index based on it's name (giant hack)
         String indexNameNoCase = name.toLowerCase();
-        if (indexNameNoCase.contains("tree"))
+        if (indexNameNoCase.contains("radix"))
+            index.setType(IndexType.RADIX_TREE.getValue());
+        else if (indexNameNoCase.contains("tree"))
             index.setType(IndexType.BALANCED_TREE.getValue());
         else if (indexNameNoCase.contains("array"))
             index.setType(IndexType.ARRAY.getValue());
@@ -496,6 +498,8 @@ public class DDLCompiler {
                         catalog_index.setType(IndexType.BALANCED_TREE.getValue());
                     if (constraintNameNoCase.contains("array"))
                         catalog_index.setType(IndexType.ARRAY.getValue());
+                    if (constraintNameNoCase.contains("radix"))
+                        catalog_index.setType(IndexType.RADIX_TREE.getValue());
                 }
             }
 
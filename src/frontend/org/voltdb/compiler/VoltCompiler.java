@@ -69,6 +69,7 @@ import org.voltdb.catalog.Table;
 import org.voltdb.catalog.User;
 import org.voltdb.catalog.UserRef;
 import org.voltdb.compiler.projectfile.ClassdependenciesType.Classdependency;
+import org.voltdb.compiler.projectfile.ColumnarsType.Columnar;
 import org.voltdb.compiler.projectfile.DatabaseType;
 import org.voltdb.compiler.projectfile.EvictablesType.Evictable;
 import org.voltdb.compiler.projectfile.ExportsType.Connector;
@@ -856,6 +857,18 @@ public class VoltCompiler {
             } // FOR
         }
 
+        // Mark tables that keep a columnar copy of their numeric columns
+        if (database.getColumnars() != null) {
+            for (Columnar c : database.getColumnars().getColumnar()) {
+                String tableName = c.getTable();
+                Table catalog_tbl = db.getTables().getIgnoreCase(tableName);
+                if (catalog_tbl == null) {
+                    throw new VoltCompilerException("Invalid columnar table name '" + tableName + "'");
+                }
+                catalog_tbl.setColumnar(true);
+            } // FOR
+        }
+
         // add vertical partitions
         if (database.getVerticalpartitions() != null) {
             for (Verticalpartition vp : database.getVerticalpartitions().getVerticalpartition()) {
@@ -221,6 +221,11 @@ public class VoltProjectBuilder {
     
     private final HashSet<String> m_batchEvictableTables = new HashSet<String>();
     
+    /**
+     * Columnar Tables
+     */
+    private final HashSet<String> m_columnarTables = new HashSet<String>();
+    
     /**
      * Prefetchable Queries
      * ProcedureName -> StatementName
@@ -490,6 +495,19 @@ public class VoltProjectBuilder {
         m_batchEvictableTables.add(tableName);
     }
 
+    // -------------------------------------------------------------------
+    // COLUMNAR TABLES
+    // -------------------------------------------------------------------
+    
+    /**
+     * Mark a table as columnar. The EE then keeps a column-major copy of the
+     * table's fixed-width numeric columns in every block for sequential scans
+     * @param tableName
+     */
+    public void markTableColumnar(String tableName) {
+        m_columnarTables.add(tableName);
+    }
+
     // -------------------------------------------------------------------
     // DEFERRABLE STATEMENTS
     // -------------------------------------------------------------------
@@ -1103,6 +1121,18 @@ public class VoltProjectBuilder {
                 table.setAttribute("table", tableName);
                 batchevictables.appendChild(table);
             }
+        }
+        // Columnar Tables
+        if (m_columnarTables.isEmpty() == false) {
+            final Element columnars = doc.createElement("columnars");
+            database.appendChild(columnars);
+            
+            // Table entries
+            for (String tableName : m_columnarTables) {
+                final Element table = doc.createElement("columnar");
+                table.setAttribute("table", tableName);
+                columnars.appendChild(table);
+            }
         }        
         // Vertical Partitions
         if (m_replicatedSecondaryIndexes.size() > 0) {
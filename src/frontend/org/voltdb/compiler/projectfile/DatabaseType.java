@@ -32,6 +32,7 @@ import javax.xml.bind.annotation.XmlType;
  *         &lt;element name="partitions" type="{}partitionsType" minOccurs="0"/>
  *         &lt;element name="evictables" type="{}evictablesType" minOccurs="0"/>
  *         &lt;element name="batchevictables" type="{}evictablesType" minOccurs="0"/>
+ *         &lt;element name="columnars" type="{}columnarsType" minOccurs="0"/>
  *         &lt;element name="verticalpartitions" type="{}verticalpartitionsType" minOccurs="0"/>
  *         &lt;element name="classdependencies" type="{}classdependenciesType" minOccurs="0"/>
  *         &lt;element name="exports" type="{}exportsType" minOccurs="0"/>
@@ -61,6 +62,7 @@ public class DatabaseType {
     protected PartitionsType partitions;
     protected EvictablesType evictables;
     protected EvictablesType batchevictables;
+    protected ColumnarsType columnars;
     protected VerticalpartitionsType verticalpartitions;
     protected ClassdependenciesType classdependencies;
     protected ExportsType exports;
@@ -238,6 +240,30 @@ public class DatabaseType {
         this.batchevictables = value;
     }
 
+    /**
+     * Gets the value of the columnars property.
+     * 
+     * @return
+     *     possible object is
+     *     {@link ColumnarsType }
+     *     
+     */
+    public ColumnarsType getColumnars() {
+        return columnars;
+    }
+
+    /**
+     * Sets the value of the columnars property.
+     * 
+     * @param value
+     *     allowed object is
+     *     {@link ColumnarsType }
+     *     
+     */
+    public void setColumnars(ColumnarsType value) {
+        this.columnars = value;
+    }
+
     /**
      * Gets the value of the verticalpartitions property.
      * 
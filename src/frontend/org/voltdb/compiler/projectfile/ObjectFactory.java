@@ -64,6 +64,14 @@ public class ObjectFactory {
         return new EvictablesType();
     }
 
+    /**
+     * Create an instance of {@link ColumnarsType }
+     * 
+     */
+    public ColumnarsType createColumnarsType() {
+        return new ColumnarsType();
+    }
+
     /**
      * Create an instance of {@link ClassdependenciesType }
      * 
@@ -184,6 +192,14 @@ public class ObjectFactory {
         return new EvictablesType.Evictable();
     }
 
+    /**
+     * Create an instance of {@link ColumnarsType.Columnar }
+     * 
+     */
+    public ColumnarsType.Columnar createColumnarsTypeColumnar() {
+        return new ColumnarsType.Columnar();
+    }
+
     /**
      * Create an instance of {@link ClassdependenciesType.Classdependency }
      * 
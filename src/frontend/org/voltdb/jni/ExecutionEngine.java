@@ -39,6 +39,7 @@ import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.utils.DBBPool.BBContainer;
 import org.voltdb.utils.LogKeys;
 import org.voltdb.utils.VoltLoggerFactory;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 
 import edu.brown.hstore.HStore;
@@ -381,6 +382,25 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      */
     abstract public boolean setLogLevels(long logLevels) throws EEException;
 
+    /**
+     * Set the number of times that a plan fragment has to be executed before
+     * the engine compiles its scan predicates. Zero compiles every plan fragment as
+     * soon as it is loaded and a negative value turns compilation off.
+     * @param threshold
+     * @throws EEException
+     */
+    abstract public void setFragmentCompileThreshold(long threshold) throws EEException;
+
+    /**
+     * Split the scans of read-only plan fragments that aggregate at least
+     * minTuples tuples across the given number of threads. One thread keeps
+     * every plan fragment single-threaded.
+     * @param threads
+     * @param minTuples
+     * @throws EEException
+     */
+    abstract public void setParallelScans(int threads, long minTuples) throws EEException;
+
     /**
      * This method should be called roughly every second. It allows the EE
      * to do periodic non-transactional work.
@@ -661,6 +681,21 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      */
     protected native boolean nativeSetLogLevels(long pointer, long logLevels);
 
+    /**
+     * @param pointer Pointer to an engine instance
+     * @param threshold Executions before a plan fragment is compiled
+     * @return error code
+     */
+    protected native int nativeSetFragmentCompileThreshold(long pointer, long threshold);
+
+    /**
+     * @param pointer Pointer to an engine instance
+     * @param threads Threads that a scan is split across
+     * @param minTuples Tuples that a fragment has to scan to be split
+     * @return error code
+     */
+    protected native int nativeSetParallelScans(long pointer, int threads, long minTuples);
+
     /**
      * Active a table stream of the specified type for a table.
      * @param pointer Pointer to an engine instance
@@ -799,9 +834,14 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      * @param blockSize TODO
      * @param maxSize
      * @param blockMerge
+     * @param maxQueuedBlocks Evicted blocks per level that may wait to be written
+     *                        by a background thread. Zero writes them synchronously.
+     * @param codecType Codec that evicted blocks are compressed with
+     * @param dictionaryBlocks Blocks of each table that its compression dictionary
+     *                         is trained from. Zero compresses without dictionaries.
      * @throws EEException
      */
-    public abstract void antiCacheInitialize(File dbDir, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge) throws EEException;
+    public abstract void antiCacheInitialize(File dbDir, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge, int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) throws EEException;
 
     /**
      * Initialize additional levels of anticaching DBs.
@@ -861,9 +901,12 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      * @param blocking
      * @param maxSize
      * @param blockMerge
+     * @param maxQueuedBlocks
+     * @param codecType
+     * @param dictionaryBlocks
      * @return
      */
-    protected native int nativeAntiCacheInitialize(long pointer, String dbDir, long blockSize, int dbtype, boolean blocking, long maxSize, boolean blockMerge);
+    protected native int nativeAntiCacheInitialize(long pointer, String dbDir, long blockSize, int dbtype, boolean blocking, long maxSize, boolean blockMerge, int maxQueuedBlocks, int codecType, int dictionaryBlocks);
 
     /** 
      * Adds new additional AntiCacheDB instances for multilevel anticaching. The database
@@ -49,6 +49,7 @@ import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.messaging.FastSerializer;
 import org.voltdb.utils.DBBPool.BBContainer;
 import org.voltdb.utils.NotImplementedException;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 
 import edu.brown.hstore.HStore;
@@ -1479,7 +1480,7 @@ public class ExecutionEngineIPC extends ExecutionEngine {
     }
     
     @Override
-    public void antiCacheInitialize(File dbFilePath, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge) throws EEException {
+    public void antiCacheInitialize(File dbFilePath, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge, int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) throws EEException {
         throw new NotImplementedException("Anti-Caching is disabled for IPC ExecutionEngine");
     }
 
@@ -1510,6 +1511,16 @@ public class ExecutionEngineIPC extends ExecutionEngine {
 	}
 
     
+    @Override
+    public void setFragmentCompileThreshold(long threshold) throws EEException {
+        throw new NotImplementedException("Compiled plan fragments are disabled for IPC ExecutionEngine");
+    }
+
+    @Override
+    public void setParallelScans(int threads, long minTuples) throws EEException {
+        throw new NotImplementedException("Parallel scans are disabled for IPC ExecutionEngine");
+    }
+
     @Override
     public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency) throws EEException {
         throw new NotImplementedException("Storage MMAP is disabled for IPC ExecutionEngine");
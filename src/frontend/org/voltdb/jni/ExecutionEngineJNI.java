@@ -39,6 +39,7 @@ import org.voltdb.export.ExportProtoMessage;
 import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.messaging.FastSerializer;
 import org.voltdb.messaging.FastSerializer.BufferGrowCallback;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 import org.voltdb.utils.DBBPool.BBContainer;
 
@@ -583,6 +584,24 @@ public class ExecutionEngineJNI extends ExecutionEngine {
         return nativeSetLogLevels( pointer, logLevels);
     }
 
+    @Override
+    public void setFragmentCompileThreshold(long threshold) throws EEException {
+        if (debug.val)
+            LOG.debug(String.format("Setting the fragment compile threshold at partition %d to %d",
+                      this.executor.getPartitionId(), threshold));
+        final int errorCode = nativeSetFragmentCompileThreshold(this.pointer, threshold);
+        checkErrorCode(errorCode);
+    }
+
+    @Override
+    public void setParallelScans(int threads, long minTuples) throws EEException {
+        if (debug.val)
+            LOG.debug(String.format("Splitting scans at partition %d across %d threads [minTuples=%d]",
+                      this.executor.getPartitionId(), threads, minTuples));
+        final int errorCode = nativeSetParallelScans(this.pointer, threads, minTuples);
+        checkErrorCode(errorCode);
+    }
+
     @Override
     public boolean activateTableStream(int tableId, TableStreamType streamType) {
         return nativeActivateTableStream( pointer, tableId, streamType.ordinal());
@@ -777,7 +796,7 @@ public class ExecutionEngineJNI extends ExecutionEngine {
     // ----------------------------------------------------------------------------
 
     @Override
-    public void antiCacheInitialize(File dbDir, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge) throws EEException {
+    public void antiCacheInitialize(File dbDir, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge, int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) throws EEException {
         assert(m_anticache == false);
 
         // TODO: Switch to LOG.debug
@@ -789,7 +808,7 @@ public class ExecutionEngineJNI extends ExecutionEngine {
             LOG.debug(String.format("AntiCacheDBType: %d", dbType.ordinal()));
         }
       
-        final int errorCode = nativeAntiCacheInitialize(this.pointer, dbDir.getAbsolutePath(), blockSize, dbType.ordinal(), blocking,  maxSize, blockMerge);
+        final int errorCode = nativeAntiCacheInitialize(this.pointer, dbDir.getAbsolutePath(), blockSize, dbType.ordinal(), blocking,  maxSize, blockMerge, maxQueuedBlocks, codecType.ordinal(), dictionaryBlocks);
         checkErrorCode(errorCode);
         m_anticache = true;
     }
@@ -31,6 +31,7 @@ import org.voltdb.exceptions.EEException;
 import org.voltdb.export.ExportProtoMessage;
 import org.voltdb.utils.NotImplementedException;
 import org.voltdb.utils.DBBPool.BBContainer;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 
 public class MockExecutionEngine extends ExecutionEngine {
@@ -200,7 +201,7 @@ public class MockExecutionEngine extends ExecutionEngine {
     }
     
     @Override
-    public void antiCacheInitialize(File dbFilePath, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge) throws EEException {
+    public void antiCacheInitialize(File dbFilePath, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge, int maxQueuedBlocks, AntiCacheCodecType codecType, int dictionaryBlocks) throws EEException {
         // TODO Auto-generated method stub
     }
     
@@ -232,6 +233,16 @@ public class MockExecutionEngine extends ExecutionEngine {
 	}
 
     
+    @Override
+    public void setFragmentCompileThreshold(long threshold) throws EEException {
+     // TODO Auto-generated method stub        
+    }
+
+    @Override
+    public void setParallelScans(int threads, long minTuples) throws EEException {
+     // TODO Auto-generated method stub        
+    }
+
     @Override
     public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency) throws EEException {
      // TODO Auto-generated method stub        
@@ -1140,7 +1140,14 @@ public class PlanAssembler {
                             (TupleValueExpression) rootExpr.getLeft();
 
                         if (((AggregateExpression)rootExpr).m_distinct) {
-                            root = addDistinctNode(root, nested);
+                            // the values only have to be distinct within
+                            // their group
+                            List<TupleValueExpression> distinctExprs = new ArrayList<TupleValueExpression>();
+                            for (ParsedSelectStmt.ParsedColInfo groupByCol : m_parsedSelect.groupByColumns) {
+                                distinctExprs.add((TupleValueExpression)(groupByCol.expression));
+                            }
+                            distinctExprs.add(nested);
+                            root = addDistinctNode(root, distinctExprs);
                         }
 
                         aggregateColumn =
@@ -1224,28 +1231,25 @@ public class PlanAssembler {
         // doesn't trigger the above aggregate conditions as it is neither grouped
         // nor does it have aggregate expressions
         if (aggNode == null && m_parsedSelect.distinct) {
-            // We currently can't handle DISTINCT of multiple columns.
-            // Throw a planner error if this is attempted.
-            if (m_parsedSelect.displayColumns.size() > 1)
-            {
-                throw new PlanningErrorException("Multiple DISTINCT columns currently unsupported");
-            }
+            // The distinct node tells the rows apart by all of the
+            // displayed columns at once
+            List<TupleValueExpression> colexprs = new ArrayList<TupleValueExpression>();
             for (ParsedSelectStmt.ParsedColInfo col : m_parsedSelect.displayColumns) {
                 if (col.expression instanceof TupleValueExpression)
                 {
-                    TupleValueExpression colexpr = (TupleValueExpression)(col.expression);
-                    root = addDistinctNode(root, colexpr);
-
-                    // aggregate handlers are expected to produce the required projection.
-                    // the other aggregates do this inherently but distinct may need a
-                    // projection node.
-                    root = addProjection(root);
+                    colexprs.add((TupleValueExpression)(col.expression));
                 }
                 else
                 {
                     throw new PlanningErrorException("DISTINCT of an expression currently unsupported");
                 }
             }
+            root = addDistinctNode(root, colexprs);
+
+            // aggregate handlers are expected to produce the required projection.
+            // the other aggregates do this inherently but distinct may need a
+            // projection node.
+            root = addProjection(root);
         }
 
         return root;
@@ -1254,14 +1258,26 @@ public class PlanAssembler {
     AbstractPlanNode addDistinctNode(AbstractPlanNode root,
                                      TupleValueExpression expr)
     {
-        DistinctPlanNode distinctNode = new DistinctPlanNode(m_context, getNextPlanNodeId());
-        distinctNode.setDistinctColumnName(expr.getColumnAlias());
+        List<TupleValueExpression> exprs = new ArrayList<TupleValueExpression>();
+        exprs.add(expr);
+        return addDistinctNode(root, exprs);
+    }
 
-        PlanColumn distinctColumn =
-            root.findMatchingOutputColumn(expr.getTableName(),
-                                          expr.getColumnName(),
-                                          expr.getColumnAlias());
-        distinctNode.setDistinctColumnGuid(distinctColumn.guid());
+    AbstractPlanNode addDistinctNode(AbstractPlanNode root,
+                                     List<TupleValueExpression> exprs)
+    {
+        DistinctPlanNode distinctNode = new DistinctPlanNode(m_context, getNextPlanNodeId());
+        distinctNode.setDistinctColumnName(exprs.get(0).getColumnAlias());
+
+        List<Integer> distinctColumnGuids = new ArrayList<Integer>();
+        for (TupleValueExpression expr : exprs) {
+            PlanColumn distinctColumn =
+                root.findMatchingOutputColumn(expr.getTableName(),
+                                              expr.getColumnName(),
+                                              expr.getColumnAlias());
+            distinctColumnGuids.add(distinctColumn.guid());
+        }
+        distinctNode.setDistinctColumnGuids(distinctColumnGuids);
 
         distinctNode.addAndLinkChild(root);
         distinctNode.updateOutputColumns(m_catalogDb);
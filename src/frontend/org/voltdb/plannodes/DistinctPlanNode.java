@@ -17,6 +17,10 @@
 
 package org.voltdb.plannodes;
 
+import java.util.ArrayList;
+import java.util.List;
+
+import org.json.JSONArray;
 import org.json.JSONException;
 import org.json.JSONObject;
 import org.json.JSONStringer;
@@ -32,7 +36,8 @@ public class DistinctPlanNode extends AbstractPlanNode {
 
     public enum Members {
         DISTINCT_COLUMN_GUID,
-        DISTINCT_COLUMN_NAME;
+        DISTINCT_COLUMN_NAME,
+        DISTINCT_COLUMN_GUIDS;
     }
 
     //
@@ -41,6 +46,8 @@ public class DistinctPlanNode extends AbstractPlanNode {
     //
     private int m_distinctColumnGuid;
     private String m_distinctColumnName;
+    // all of the columns that tell the tuples apart, starting with m_distinctColumnGuid
+    private List<Integer> m_distinctColumnGuids = new ArrayList<Integer>();
 
     public DistinctPlanNode(PlannerContext context, Integer id) {
         super(context, id);
@@ -56,6 +63,7 @@ public class DistinctPlanNode extends AbstractPlanNode {
         super.produceCopyForTransformation(copy);
         copy.m_distinctColumnGuid = m_distinctColumnGuid;
         copy.m_distinctColumnName = m_distinctColumnName;
+        copy.m_distinctColumnGuids = new ArrayList<Integer>(m_distinctColumnGuids);
         return copy;
     }
 
@@ -76,6 +84,25 @@ public class DistinctPlanNode extends AbstractPlanNode {
      */
     public void setDistinctColumnGuid(int distinctColumnGuid) {
         m_distinctColumnGuid = distinctColumnGuid;
+        m_distinctColumnGuids.clear();
+        m_distinctColumnGuids.add(distinctColumnGuid);
+    }
+
+    /**
+     * @return the GUIDs of all of the distinct columns
+     */
+    public List<Integer> getDistinctColumnGuids() {
+        return m_distinctColumnGuids;
+    }
+
+    /**
+     * @param distinctColumnGuids the GUIDs of the distinct columns, which
+     *        must not be empty
+     */
+    public void setDistinctColumnGuids(List<Integer> distinctColumnGuids) {
+        assert(distinctColumnGuids.isEmpty() == false);
+        m_distinctColumnGuid = distinctColumnGuids.get(0);
+        m_distinctColumnGuids = new ArrayList<Integer>(distinctColumnGuids);
     }
 
     /**
@@ -102,11 +129,25 @@ public class DistinctPlanNode extends AbstractPlanNode {
         super.toJSONString(stringer);
         stringer.key(Members.DISTINCT_COLUMN_GUID.name()).value(m_distinctColumnGuid);
         stringer.key(Members.DISTINCT_COLUMN_NAME.name()).value(m_distinctColumnName);
+        stringer.key(Members.DISTINCT_COLUMN_GUIDS.name()).array();
+        for (Integer guid : m_distinctColumnGuids) {
+            stringer.value(guid);
+        }
+        stringer.endArray();
     }
     
     @Override
     protected void loadFromJSONObject(JSONObject obj, Database db) throws JSONException {
         m_distinctColumnGuid = obj.getInt(Members.DISTINCT_COLUMN_GUID.name());
         m_distinctColumnName = obj.getString(Members.DISTINCT_COLUMN_NAME.name());
+        m_distinctColumnGuids.clear();
+        if (obj.has(Members.DISTINCT_COLUMN_GUIDS.name())) {
+            JSONArray guids = obj.getJSONArray(Members.DISTINCT_COLUMN_GUIDS.name());
+            for (int ii = 0; ii < guids.length(); ii++) {
+                m_distinctColumnGuids.add(guids.getInt(ii));
+            }
+        } else {
+            m_distinctColumnGuids.add(m_distinctColumnGuid);
+        }
     }
 }
@@ -0,0 +1,158 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+package org.voltdb.plannodes;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.json.JSONArray;
+import org.json.JSONException;
+import org.json.JSONObject;
+import org.json.JSONString;
+import org.json.JSONStringer;
+import org.voltdb.catalog.Database;
+import org.voltdb.expressions.AbstractExpression;
+import org.voltdb.planner.PlannerContext;
+import org.voltdb.types.PlanNodeType;
+
+/**
+ * Equi-join that the EE runs by building a hash table on the smaller of its
+ * two inputs. The i-th outer key expression is compared with the i-th inner
+ * key expression. The predicate, if any, is checked on every pair of tuples
+ * whose keys are equal.
+ */
+public class HashJoinPlanNode extends AbstractJoinPlanNode {
+
+    public enum Members {
+        OUTER_KEY_EXPRESSIONS,
+        INNER_KEY_EXPRESSIONS;
+    }
+
+    private List<AbstractExpression> m_outerKeyExpressions = new ArrayList<AbstractExpression>();
+    private List<AbstractExpression> m_innerKeyExpressions = new ArrayList<AbstractExpression>();
+
+    /**
+     * @param id
+     */
+    public HashJoinPlanNode(PlannerContext context, Integer id) {
+        super(context, id);
+    }
+
+    @Override
+    public PlanNodeType getPlanNodeType() {
+        return PlanNodeType.HASHJOIN;
+    }
+
+    @Override
+    public Object clone(boolean clone_children, boolean clone_inline) throws CloneNotSupportedException {
+        HashJoinPlanNode clone = (HashJoinPlanNode)super.clone(clone_children, clone_inline);
+        clone.m_outerKeyExpressions = new ArrayList<AbstractExpression>();
+        for (AbstractExpression exp : this.m_outerKeyExpressions) {
+            clone.m_outerKeyExpressions.add((AbstractExpression)exp.clone());
+        }
+        clone.m_innerKeyExpressions = new ArrayList<AbstractExpression>();
+        for (AbstractExpression exp : this.m_innerKeyExpressions) {
+            clone.m_innerKeyExpressions.add((AbstractExpression)exp.clone());
+        }
+        return (clone);
+    }
+
+    @Override
+    public boolean equals(Object obj) {
+        if ((obj instanceof HashJoinPlanNode) == false) {
+            return (false);
+        }
+        HashJoinPlanNode other = (HashJoinPlanNode)obj;
+        if (this.m_outerKeyExpressions.equals(other.m_outerKeyExpressions) == false) return (false);
+        if (this.m_innerKeyExpressions.equals(other.m_innerKeyExpressions) == false) return (false);
+        return super.equals(obj);
+    }
+
+    @Override
+    public void validate() throws Exception {
+        super.validate();
+
+        if (m_outerKeyExpressions.isEmpty()) {
+            throw new Exception("ERROR: There were no join key expressions defined for " + this);
+        }
+        if (m_outerKeyExpressions.size() != m_innerKeyExpressions.size()) {
+            throw new Exception("ERROR: The outer and inner join keys of " + this + " do not match up");
+        }
+        for (AbstractExpression exp : m_outerKeyExpressions) {
+            exp.validate();
+        }
+        for (AbstractExpression exp : m_innerKeyExpressions) {
+            exp.validate();
+        }
+    }
+
+    /**
+     * Add the join condition outer = inner
+     * @param outer expression over the outer (first) child's columns
+     * @param inner expression over the inner (second) child's columns
+     */
+    public void addJoinKey(AbstractExpression outer, AbstractExpression inner) {
+        m_outerKeyExpressions.add(outer);
+        m_innerKeyExpressions.add(inner);
+    }
+
+    public List<AbstractExpression> getOuterKeyExpressions() {
+        return m_outerKeyExpressions;
+    }
+
+    public List<AbstractExpression> getInnerKeyExpressions() {
+        return m_innerKeyExpressions;
+    }
+
+    @Override
+    public void toJSONString(JSONStringer stringer) throws JSONException {
+        super.toJSONString(stringer);
+        stringer.key(Members.OUTER_KEY_EXPRESSIONS.name()).array();
+        for (AbstractExpression ae : m_outerKeyExpressions) {
+            assert (ae instanceof JSONString);
+            stringer.value(ae);
+        }
+        stringer.endArray();
+        stringer.key(Members.INNER_KEY_EXPRESSIONS.name()).array();
+        for (AbstractExpression ae : m_innerKeyExpressions) {
+            assert (ae instanceof JSONString);
+            stringer.value(ae);
+        }
+        stringer.endArray();
+    }
+
+    @Override
+    protected void loadFromJSONObject(JSONObject obj, Database db) throws JSONException {
+        super.loadFromJSONObject(obj, db);
+        JSONArray outerKeys = obj.getJSONArray(Members.OUTER_KEY_EXPRESSIONS.name());
+        for (int ii = 0; ii < outerKeys.length(); ii++) {
+            m_outerKeyExpressions.add(AbstractExpression.fromJSONObject(outerKeys.getJSONObject(ii), db));
+        }
+        JSONArray innerKeys = obj.getJSONArray(Members.INNER_KEY_EXPRESSIONS.name());
+        for (int ii = 0; ii < innerKeys.length(); ii++) {
+            m_innerKeyExpressions.add(AbstractExpression.fromJSONObject(innerKeys.getJSONObject(ii), db));
+        }
+    }
+}
@@ -19,14 +19,23 @@ package org.voltdb.plannodes;
 
 import org.json.JSONException;
 import org.json.JSONObject;
+import org.json.JSONStringer;
 import org.voltdb.catalog.Database;
 import org.voltdb.planner.PlannerContext;
 import org.voltdb.types.PlanNodeType;
+import org.voltdb.types.UnionType;
 
 /**
  *
  */
 public class UnionPlanNode extends AbstractPlanNode {
+
+    public enum Members {
+        UNION_TYPE;
+    }
+
+    protected UnionType m_unionType = UnionType.UNION_ALL;
+
     /**
      * @param id
      */
@@ -39,6 +48,32 @@ public class UnionPlanNode extends AbstractPlanNode {
         return PlanNodeType.UNION;
     }
     
+    /**
+     * @return how the inputs are combined
+     */
+    public UnionType getUnionType() {
+        return m_unionType;
+    }
+
+    /**
+     * @param union_type how the inputs are combined
+     */
+    public void setUnionType(UnionType union_type) {
+        m_unionType = union_type;
+    }
+
     @Override
-    protected void loadFromJSONObject(JSONObject obj, Database db) throws JSONException {}
+    public void toJSONString(JSONStringer stringer) throws JSONException {
+        super.toJSONString(stringer);
+        stringer.key(Members.UNION_TYPE.name()).value(m_unionType.toString());
+    }
+
+    @Override
+    protected void loadFromJSONObject(JSONObject obj, Database db) throws JSONException {
+        if (obj.has(Members.UNION_TYPE.name())) {
+            m_unionType = UnionType.valueOf(obj.getString(Members.UNION_TYPE.name()));
+        } else {
+            m_unionType = UnionType.UNION_ALL;
+        }
+    }
 }
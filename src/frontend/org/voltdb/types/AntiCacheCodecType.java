@@ -0,0 +1,40 @@
+package org.voltdb.types;
+
+import java.util.EnumSet;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Codecs that the EE can compress evicted AntiCache blocks with.
+ * These have to match AntiCacheCodecType in the EE's common/types.h
+ */
+public enum AntiCacheCodecType {
+    /**
+     * Blocks are written as they are serialized
+     */
+    NONE,
+    /**
+     * Byte-oriented LZ77
+     */
+    LZ
+    ;
+
+    private static final Map<String, AntiCacheCodecType> name_lookup = new HashMap<String, AntiCacheCodecType>();
+    static {
+        for (AntiCacheCodecType vt : EnumSet.allOf(AntiCacheCodecType.class)) {
+            name_lookup.put(vt.name().toLowerCase(), vt);
+        }
+    } // STATIC
+
+    public static AntiCacheCodecType get(int idx) {
+        AntiCacheCodecType values[] = AntiCacheCodecType.values();
+        if (idx < 0 || idx >= values.length) {
+            return(null);
+        }
+        return (values[idx]);
+    }
+
+    public static AntiCacheCodecType get(String name) {
+        return AntiCacheCodecType.name_lookup.get(name.toLowerCase());
+    }
+}
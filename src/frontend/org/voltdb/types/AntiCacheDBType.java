@@ -24,7 +24,11 @@ public enum AntiCacheDBType {
     /**
      * NVM allocator-based store
      */
-    ALLOCATORNVM
+    ALLOCATORNVM,
+    /**
+     * Log-structured store of segment files
+     */
+    LOG
     ;
 
     private static final Map<String, AntiCacheDBType> name_lookup = new HashMap<String, AntiCacheDBType>();
@@ -29,7 +29,8 @@ public enum IndexType {
     BALANCED_TREE   (1),
     HASH_TABLE      (2),
     ARRAY           (3),
-    BTREE           (4);
+    BTREE           (4),
+    RADIX_TREE      (5);
 
     IndexType(int val) {
         assert (this.ordinal() == val) :
@@ -81,6 +82,8 @@ public enum IndexType {
                 return "_TREE";
             case ARRAY:
                 return "_ARRAY";
+            case RADIX_TREE:
+                return "_RADIX";
             case BTREE:
             case HASH_TABLE:
                 return "";
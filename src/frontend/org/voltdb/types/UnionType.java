@@ -0,0 +1,72 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2010 VoltDB L.L.C.
+ *
+ * VoltDB is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VoltDB is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+package org.voltdb.types;
+
+import java.util.EnumSet;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * How a UnionPlanNode combines its inputs
+ */
+public enum UnionType {
+    INVALID     (0), // For Parsing...
+    UNION       (1),
+    UNION_ALL   (2),
+    INTERSECT   (3),
+    EXCEPT      (4);
+
+    UnionType(int val) {
+        assert (this.ordinal() == val) :
+            "Enum element " + this.name() +
+            " in position " + this.ordinal() +
+            " instead of position " + val;
+    }
+
+    public int getValue() {
+        return this.ordinal();
+    }
+
+    protected static final Map<Integer, UnionType> idx_lookup = new HashMap<Integer, UnionType>();
+    protected static final Map<String, UnionType> name_lookup = new HashMap<String, UnionType>();
+    static {
+        for (UnionType vt : EnumSet.allOf(UnionType.class)) {
+            UnionType.idx_lookup.put(vt.ordinal(), vt);
+            UnionType.name_lookup.put(vt.name().toLowerCase().intern(), vt);
+        }
+    }
+
+    public static Map<Integer, UnionType> getIndexMap() {
+        return idx_lookup;
+    }
+
+    public static Map<String, UnionType> getNameMap() {
+        return name_lookup;
+    }
+
+    public static UnionType get(Integer idx) {
+        UnionType ret = UnionType.idx_lookup.get(idx);
+        return (ret == null ? UnionType.INVALID : ret);
+    }
+
+    public static UnionType get(String name) {
+        UnionType ret = UnionType.name_lookup.get(name.toLowerCase().intern());
+        return (ret == null ? UnionType.INVALID : ret);
+    }
+
+}
@@ -0,0 +1,237 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/debuglog.h"
+#include "anticache/AntiCacheCompressor.h"
+
+using namespace std;
+using namespace voltdb;
+
+/**
+ * A serialized block of order history tuples: the block header (one
+ * table), then tuples that repeat most of their VARCHARs
+ */
+static string orderBlock(int first, int count) {
+    string block("\0\0\0\1\0\0\0\6ORDERS\0\0\0\0", 18);
+    static const char* statuses[] = { "PENDING", "SHIPPED", "DELIVERED", "RETURNED" };
+    char tuple[256];
+    for (int i = first; i < first + count; i++) {
+        int length = snprintf(tuple, sizeof(tuple),
+                              "ORDER-%08d|CUSTOMER-%05d|%s|2014-%02d-%02d|Standard ground shipping, leave at front door|",
+                              i, (i * 7919) % 20000, statuses[i % 4], 1 + i % 12, 1 + i % 28);
+        block.append(tuple, length);
+    }
+    return block;
+}
+
+static string randomBlock(int size) {
+    string block(size, '\0');
+    for (int i = 4; i < size; i++) {
+        block[i] = (char)(rand() & 0xFF);
+    }
+    return block;
+}
+
+class AntiCacheCompressorTest : public Test {
+public:
+    AntiCacheCompressorTest() {
+        srand(1);
+    }
+
+    /**
+     * Compress and decompress a buffer, returning the compressed size
+     */
+    long roundTrip(const string &data, const string &dict = string()) {
+        vector<char> packed(m_codec.maxCompressedSize((long)data.size()));
+        long packedSize = m_codec.compress(data.data(), (long)data.size(), &packed[0],
+                                           dict.data(), (long)dict.size());
+        EXPECT_TRUE(packedSize <= (long)packed.size());
+
+        vector<char> raw(data.size() + 1);
+        EXPECT_TRUE(m_codec.decompress(&packed[0], packedSize, &raw[0], (long)data.size(),
+                                       dict.data(), (long)dict.size()));
+        EXPECT_EQ(0, memcmp(data.data(), &raw[0], data.size()));
+        return packedSize;
+    }
+
+    LZAntiCacheCodec m_codec;
+};
+
+TEST_F(AntiCacheCompressorTest, LZRoundTrip) {
+    roundTrip(string());
+    roundTrip(string("x"));
+    roundTrip(string("short block"));
+    roundTrip(randomBlock(100));
+
+    // a long run is one overlapping match
+    string run(100000, 'a');
+    ASSERT_TRUE(roundTrip(run) < 1000);
+
+    string orders = orderBlock(0, 5000);
+    long packedSize = roundTrip(orders);
+    VOLT_INFO("order block: %ld -> %ld bytes", (long)orders.size(), packedSize);
+    ASSERT_TRUE(packedSize * 3 < (long)orders.size());
+
+    // random data only grows a little
+    string random = randomBlock(65536);
+    ASSERT_TRUE(roundTrip(random) <= m_codec.maxCompressedSize(65536));
+}
+
+TEST_F(AntiCacheCompressorTest, LZCorruptBlock) {
+    string orders = orderBlock(0, 1000);
+    vector<char> packed(m_codec.maxCompressedSize((long)orders.size()));
+    long packedSize = m_codec.compress(orders.data(), (long)orders.size(), &packed[0], NULL, 0);
+
+    vector<char> raw(orders.size());
+    ASSERT_TRUE(m_codec.decompress(&packed[0], packedSize, &raw[0], (long)orders.size(), NULL, 0));
+    // truncated
+    ASSERT_FALSE(m_codec.decompress(&packed[0], packedSize / 2, &raw[0], (long)orders.size(), NULL, 0));
+    // wrong size
+    ASSERT_FALSE(m_codec.decompress(&packed[0], packedSize, &raw[0], (long)orders.size() - 1, NULL, 0));
+}
+
+TEST_F(AntiCacheCompressorTest, LZDictionary) {
+    vector<string> samples;
+    for (int i = 0; i < 4; i++) {
+        samples.push_back(orderBlock(i * 1000, 1000));
+    }
+    string dict = AntiCacheCompressor::trainDictionary(samples, AntiCacheCompressor::DICTIONARY_SIZE);
+    ASSERT_TRUE(dict.size() > 0);
+    ASSERT_TRUE((long)dict.size() <= AntiCacheCompressor::DICTIONARY_SIZE);
+
+    // a small block has little to refer back to on its own
+    string orders = orderBlock(100000, 20);
+    long plainSize = roundTrip(orders);
+    long dictSize = roundTrip(orders, dict);
+    VOLT_INFO("small block: %ld -> %ld bytes, %ld with the dictionary",
+              (long)orders.size(), plainSize, dictSize);
+    ASSERT_TRUE(dictSize < plainSize);
+
+    // the block can't be read without its dictionary
+    vector<char> packed(m_codec.maxCompressedSize((long)orders.size()));
+    long packedSize = m_codec.compress(orders.data(), (long)orders.size(), &packed[0],
+                                       dict.data(), (long)dict.size());
+    vector<char> raw(orders.size());
+    ASSERT_FALSE(m_codec.decompress(&packed[0], packedSize, &raw[0], (long)orders.size(), NULL, 0));
+
+    // nothing repeats in random samples
+    samples.clear();
+    samples.push_back(randomBlock(65536));
+    ASSERT_EQ(0, AntiCacheCompressor::trainDictionary(samples, AntiCacheCompressor::DICTIONARY_SIZE).size());
+}
+
+TEST_F(AntiCacheCompressorTest, PackBlocks) {
+    AntiCacheCompressor compressor;
+    int64_t micros = 0;
+    string orders = orderBlock(0, 5000);
+
+    // no codec, no compression
+    long size = (long)orders.size();
+    char* packed = compressor.pack("ORDERS", orders.data(), size, micros);
+    ASSERT_EQ((long)orders.size(), size);
+    ASSERT_FALSE(AntiCacheCompressor::isPacked(packed, size));
+    ASSERT_EQ(0, memcmp(orders.data(), packed, size));
+    delete [] packed;
+
+    compressor.setCodec(ANTICACHE_CODEC_LZ, 0);
+    size = (long)orders.size();
+    packed = compressor.pack("ORDERS", orders.data(), size, micros);
+    ASSERT_TRUE(size * 3 < (long)orders.size());
+    ASSERT_TRUE(AntiCacheCompressor::isPacked(packed, size));
+    ASSERT_TRUE(micros >= 0);
+
+    // still readable once compression is turned off
+    compressor.setCodec(ANTICACHE_CODEC_NONE, 0);
+    char* raw = compressor.unpack(packed, size, micros);
+    ASSERT_EQ((long)orders.size(), size);
+    ASSERT_EQ(0, memcmp(orders.data(), raw, size));
+    delete [] raw;
+    delete [] packed;
+
+    // random blocks are kept as they are
+    compressor.setCodec(ANTICACHE_CODEC_LZ, 0);
+    string random = randomBlock(65536);
+    size = (long)random.size();
+    packed = compressor.pack("ORDERS", random.data(), size, micros);
+    ASSERT_EQ((long)random.size(), size);
+    ASSERT_FALSE(AntiCacheCompressor::isPacked(packed, size));
+    raw = compressor.unpack(packed, size, micros);
+    ASSERT_EQ(0, memcmp(random.data(), raw, size));
+    delete [] raw;
+    delete [] packed;
+}
+
+TEST_F(AntiCacheCompressorTest, TrainDictionaryPerTable) {
+    const int dictionaryBlocks = 3;
+    AntiCacheCompressor compressor;
+    compressor.setCodec(ANTICACHE_CODEC_LZ, dictionaryBlocks);
+    int64_t micros = 0;
+
+    // the first blocks of a table are only sampled
+    vector<string> blocks;
+    vector<string> packedBlocks;
+    for (int i = 0; i < dictionaryBlocks + 2; i++) {
+        if (i < dictionaryBlocks) {
+            ASSERT_TRUE(compressor.getDictionary("ORDERS") == NULL);
+        }
+        blocks.push_back(orderBlock(i * 1000, (i < dictionaryBlocks ? 1000 : 20)));
+        long size = (long)blocks.back().size();
+        char* packed = compressor.pack("ORDERS", blocks.back().data(), size, micros);
+        packedBlocks.push_back(string(packed, size));
+        delete [] packed;
+    }
+    const string* dict = compressor.getDictionary("ORDERS");
+    ASSERT_TRUE(dict != NULL);
+    ASSERT_TRUE(dict->size() > 0);
+    ASSERT_TRUE(compressor.getDictionary("CUSTOMERS") == NULL);
+
+    for (int i = 0; i < (int)blocks.size(); i++) {
+        long size = (long)packedBlocks[i].size();
+        char* raw = compressor.unpack(packedBlocks[i].data(), size, micros);
+        ASSERT_EQ((long)blocks[i].size(), size);
+        ASSERT_EQ(0, memcmp(blocks[i].data(), raw, size));
+        delete [] raw;
+    }
+
+    // the small blocks after training beat compressing them on their own
+    AntiCacheCompressor plain;
+    plain.setCodec(ANTICACHE_CODEC_LZ, 0);
+    long size = (long)blocks.back().size();
+    char* packed = plain.pack("ORDERS", blocks.back().data(), size, micros);
+    delete [] packed;
+    VOLT_INFO("small block: %ld bytes, %ld with the dictionary",
+              size, (long)packedBlocks.back().size());
+    ASSERT_TRUE((long)packedBlocks.back().size() < size);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
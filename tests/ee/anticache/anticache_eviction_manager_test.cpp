@@ -46,6 +46,7 @@
 #include "boost/scoped_ptr.hpp"
 
 #include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheKeyFilter.h"
 
 #define BLOCK_SIZE 1024000
 #define MAX_SIZE 1024000000
@@ -111,7 +112,7 @@ public:
     }
     
     
-    void initTable(bool allowInlineStrings) {
+    void initTable(bool allowInlineStrings, bool withPrimaryKey = false) {
         m_tableSchema = voltdb::TupleSchema::createTupleSchema(m_tableSchemaTypes,
                                                                m_tableSchemaColumnSizes,
                                                                m_tableSchemaAllowNull,
@@ -140,13 +141,21 @@ public:
         primaryKeyIndexScheme.keySchema = m_primaryKeyIndexSchema;
         secondaryIndexScheme.keySchema = m_primaryKeyIndexSchema;
         std::vector<voltdb::TableIndexScheme> indexes;
-        indexes.push_back(primaryKeyIndexScheme);
-        indexes.push_back(secondaryIndexScheme);
-        
-        m_table = dynamic_cast<voltdb::PersistentTable*>(voltdb::TableFactory::getPersistentTable
-                                                         (0, m_engine->getExecutorContext(), "Foo",
-                                                          m_tableSchema, &m_columnNames[0], indexes, 0,
-                                                          false, false));
+        if (withPrimaryKey) {
+            indexes.push_back(secondaryIndexScheme);
+            m_table = dynamic_cast<voltdb::PersistentTable*>(voltdb::TableFactory::getPersistentTable
+                                                             (0, m_engine->getExecutorContext(), "Foo",
+                                                              m_tableSchema, &m_columnNames[0], primaryKeyIndexScheme,
+                                                              indexes, 0, false, false));
+        } else {
+            indexes.push_back(primaryKeyIndexScheme);
+            indexes.push_back(secondaryIndexScheme);
+
+            m_table = dynamic_cast<voltdb::PersistentTable*>(voltdb::TableFactory::getPersistentTable
+                                                             (0, m_engine->getExecutorContext(), "Foo",
+                                                              m_tableSchema, &m_columnNames[0], indexes, 0,
+                                                              false, false));
+        }
                 
         TupleSchema *evictedSchema = TupleSchema::createEvictedTupleSchema();
                 
@@ -348,7 +357,7 @@ TEST_F(AntiCacheEvictionManagerTest, FullBackingStore) {
 
  
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
 TEST_F(AntiCacheEvictionManagerTest, GetTupleID)
 {
     initTable(true); 
@@ -571,7 +580,7 @@ TEST_F(AntiCacheEvictionManagerTest, DeleteMultipleTuples)
 //     ASSERT_EQ(oldest_tuple_id, m_table->getNewestTupleID()); 
 //   
 // }
-#else
+#elif defined(ANTICACHE_TIMESTAMPS)
 TEST_F(AntiCacheEvictionManagerTest, GetTupleTimeStamp)
 {
     initTable(true); 
@@ -628,6 +637,86 @@ TEST_F(AntiCacheEvictionManagerTest, TestEvictionOrder)
     cleanupTable();
 }
 
+#else
+TEST_F(AntiCacheEvictionManagerTest, ReferenceBits)
+{
+    initTable(true); 
+
+    // the header only holds the flags
+    ASSERT_EQ(1, TUPLE_HEADER_SIZE);
+
+    TableTuple tuple = m_table->tempTuple();
+
+    tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+    tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+    m_table->insertTuple(tuple);
+
+    // get the tuple that was just inserted
+    tuple = m_table->lookupTuple(tuple); 
+    int tuple_id = m_table->getTupleID(tuple.address());
+
+    // an insert references the tuple
+    ASSERT_TRUE(m_table->isReferenced(tuple_id));
+
+    // an unevicted tuple goes back cold
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    eviction_manager->updateUnevictedTuple(m_table, &tuple);
+    ASSERT_FALSE(m_table->isReferenced(tuple_id));
+
+    // and an access references it again
+    eviction_manager->updateTuple(m_table, &tuple, false);
+    ASSERT_TRUE(m_table->isReferenced(tuple_id));
+
+    cleanupTable(); 
+}
+
+TEST_F(AntiCacheEvictionManagerTest, TestEvictionOrder)
+{
+    int num_tuples = 100; 
+
+    initTable(true); 
+
+    TableTuple tuple = m_table->tempTuple();
+
+    for(int i = 0; i < num_tuples; i++) // insert tuples
+    {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+        tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+        m_table->insertTuple(tuple);
+    }
+
+    // every tuple is referenced, so the hand goes all the way around
+    // clearing the bits and then stops at the first tuple
+    {
+        EvictionIterator itr(m_table); 
+        ASSERT_TRUE(itr.hasNext());
+        ASSERT_TRUE(itr.next(tuple));
+        ASSERT_EQ(0, m_table->getTupleID(tuple.address()));
+    }
+
+    // touch the tuples right after the hand, the first one it
+    // finds after them is the victim
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    TableIterator itr1(m_table);
+    itr1.next(tuple);
+    for(int i = 1; i < num_tuples / 2; i++)
+    {
+        itr1.next(tuple);
+        eviction_manager->updateTuple(m_table, &tuple, false);
+    }
+    {
+        EvictionIterator itr(m_table); 
+        ASSERT_TRUE(itr.next(tuple));
+        ASSERT_EQ(num_tuples / 2, m_table->getTupleID(tuple.address()));
+
+        // the touched tuples lost their bits on the way
+        for(int i = 1; i < num_tuples / 2; i++)
+            ASSERT_FALSE(m_table->isReferenced(i));
+    }
+
+    cleanupTable();
+}
+
 #endif
 TEST_F(AntiCacheEvictionManagerTest, TestSetEntryToNewAddress)
 {
@@ -722,6 +811,121 @@ TEST_F(AntiCacheEvictionManagerTest, UpdateIndexPerformance)
     cleanupTable();
 }
 
+TEST_F(AntiCacheEvictionManagerTest, AccessPerformance)
+{
+    int num_tuples = 100000;
+    int num_accesses = 100000;
+    int num_victims = 10000;
+
+    struct timeval start, end;
+    double mtime;
+
+    initTable(true); 
+
+    TableTuple tuple = m_table->tempTuple();
+
+    for(int i = 0; i < num_tuples; i++) // insert tuples
+    {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+        tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+        m_table->insertTuple(tuple);
+    }
+
+    std::vector<char*> addresses;
+    TableIterator itr1(m_table);
+    while(itr1.next(tuple))
+        addresses.push_back(tuple.address());
+
+    std::vector<char*> accessed(num_accesses);
+    for(int i = 0; i < num_accesses; i++)
+        accessed[i] = addresses[rand() % num_tuples];
+
+    // the cost of tracking an access depends on the eviction policy
+    // the engine was compiled with
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    TableTuple touched(m_table->schema());
+    gettimeofday(&start, NULL);
+    for(int i = 0; i < num_accesses; i++)
+    {
+        touched.move(accessed[i]);
+        eviction_manager->updateTuple(m_table, &touched, false);
+    }
+    gettimeofday(&end, NULL);
+    mtime = (double)(end.tv_sec - start.tv_sec) * 1000 + (double)(end.tv_usec - start.tv_usec) / 1000;
+    VOLT_INFO("total time for %d accesses: %f milliseconds", num_accesses, mtime);
+
+    // and so does picking the tuples to evict
+    int victims = 0;
+    gettimeofday(&start, NULL);
+    {
+        EvictionIterator itr(m_table); 
+#ifdef ANTICACHE_TIMESTAMPS
+        itr.reserve((int64_t)num_victims * (m_tableSchema->tupleLength() + TUPLE_HEADER_SIZE));
+#endif
+        while(victims < num_victims && itr.hasNext() && itr.next(tuple))
+            victims++;
+    }
+    gettimeofday(&end, NULL);
+    mtime = (double)(end.tv_sec - start.tv_sec) * 1000 + (double)(end.tv_usec - start.tv_usec) / 1000;
+    VOLT_INFO("total time to pick %d eviction victims: %f milliseconds", victims, mtime);
+    ASSERT_GT(victims, 0);
+
+    cleanupTable();
+}
+
+TEST_F(AntiCacheEvictionManagerTest, EvictedKeyFilter)
+{
+    int num_tuples = 100000;
+
+    initTable(true, true);
+    ASSERT_TRUE(m_table->hasEvictedKeyFingerprints());
+    string temp = tempdir.name();
+    m_engine->antiCacheInitialize(temp, ANTICACHEDB_LOG, false, BLOCK_SIZE, MAX_SIZE, true, 0, ANTICACHE_CODEC_NONE, 0);
+
+    TableTuple tuple = m_table->tempTuple();
+    for(int i = 0; i < num_tuples; i++) // insert tuples
+    {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+        tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+        m_table->insertTuple(tuple);
+    }
+
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    ASSERT_TRUE(eviction_manager->evictBlockToDisk(m_table, BLOCK_SIZE, 1));
+    AntiCacheKeyFilter &filter = m_table->getEvictedKeyFilter();
+    ASSERT_GT(m_table->getTuplesEvicted(), 0);
+    ASSERT_LT(m_table->getTuplesEvicted(), num_tuples);
+    ASSERT_EQ(m_table->getTuplesEvicted(), filter.getKeyCount());
+
+    TableTuple evicted_tuple(m_table->getEvictedTable()->schema());
+    TableIterator evicted_itr(m_table->getEvictedTable());
+    ASSERT_TRUE(evicted_itr.next(evicted_tuple));
+    int32_t block_id = ValuePeeker::peekInteger(evicted_tuple.getNValue(0));
+
+    std::set<int32_t> in_memory;
+    TableIterator itr(m_table);
+    while(itr.next(tuple))
+        in_memory.insert(ValuePeeker::peekInteger(tuple.getNValue(0)));
+
+    // Every evicted key is in the filter of its block, and the keys that
+    // are still in memory are almost never in the summary
+    int false_positives = 0;
+    for(int i = 0; i < num_tuples; i++)
+    {
+        uint32_t fingerprint = AntiCacheKeyFilter::fingerprint(
+            std::vector<NValue>(1, ValueFactory::getIntegerValue(i)));
+        if (in_memory.find(i) == in_memory.end()) {
+            ASSERT_TRUE(filter.mayContain(fingerprint));
+            ASSERT_TRUE(filter.mayContain(block_id, fingerprint));
+        } else if (filter.mayContain(fingerprint)) {
+            false_positives++;
+        }
+    }
+    VOLT_INFO("%d false positives out of %d keys in memory", false_positives, (int)in_memory.size());
+    ASSERT_LT(false_positives, (int)in_memory.size() / 100);
+
+    cleanupTable();
+}
 
 int main() {
     return TestSuite::globalInstance()->runAll();
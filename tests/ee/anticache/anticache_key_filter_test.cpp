@@ -0,0 +1,220 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/debuglog.h"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "anticache/AntiCacheKeyFilter.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define KEYS_PER_BLOCK 1000
+
+class AntiCacheKeyFilterTest : public Test {
+public:
+    static uint32_t keyFingerprint(int64_t key) {
+        vector<NValue> values(1, ValueFactory::getBigIntValue(key));
+        return AntiCacheKeyFilter::fingerprint(values);
+    }
+
+    /**
+     * Add blocks with KEYS_PER_BLOCK keys each, starting from key 0
+     */
+    void addBlocks(int numBlocks) {
+        for (int block_id = 0; block_id < numBlocks; block_id++) {
+            vector<uint32_t> fingerprints;
+            for (int i = 0; i < KEYS_PER_BLOCK; i++) {
+                fingerprints.push_back(keyFingerprint(block_id * KEYS_PER_BLOCK + i));
+            }
+            m_filter.addBlock(block_id, fingerprints);
+        }
+    }
+
+    /**
+     * Count the keys from the given range that the summary lets through
+     */
+    int countMatches(int64_t first, int64_t count) {
+        int matches = 0;
+        for (int64_t key = first; key < first + count; key++) {
+            if (m_filter.mayContain(keyFingerprint(key))) matches++;
+        }
+        return matches;
+    }
+
+    AntiCacheKeyFilter m_filter;
+};
+
+TEST_F(AntiCacheKeyFilterTest, EmptyFilter) {
+    ASSERT_FALSE(m_filter.mayContain(keyFingerprint(1)));
+    ASSERT_TRUE(m_filter.mayContain(7, keyFingerprint(1)));
+    ASSERT_EQ(0, m_filter.getKeyCount());
+}
+
+TEST_F(AntiCacheKeyFilterTest, EvictedKeys) {
+    int num_blocks = 100;
+    addBlocks(num_blocks);
+    ASSERT_EQ(num_blocks * KEYS_PER_BLOCK, m_filter.getKeyCount());
+
+    // No false negatives
+    ASSERT_EQ(num_blocks * KEYS_PER_BLOCK, countMatches(0, num_blocks * KEYS_PER_BLOCK));
+    for (int block_id = 0; block_id < num_blocks; block_id++) {
+        ASSERT_TRUE(m_filter.hasBlock(block_id));
+        ASSERT_TRUE(m_filter.mayContain(block_id, keyFingerprint(block_id * KEYS_PER_BLOCK)));
+        ASSERT_FALSE(m_filter.mayContain(block_id, keyFingerprint((block_id + 1) * KEYS_PER_BLOCK)));
+    }
+
+    // Keys that were never evicted are almost always turned down
+    int probes = 100000;
+    int false_positives = countMatches(num_blocks * KEYS_PER_BLOCK, probes);
+    VOLT_INFO("%d false positives out of %d", false_positives, probes);
+    ASSERT_TRUE(false_positives < probes / 100);
+}
+
+TEST_F(AntiCacheKeyFilterTest, MergeKeys) {
+    int num_blocks = 100;
+    addBlocks(num_blocks);
+    int rebuilds = m_filter.getSummaryRebuilds();
+
+    // Merge back one tuple from the first block, then the rest of the
+    // first half of the blocks
+    vector<uint32_t> fingerprints(1, keyFingerprint(0));
+    m_filter.removeKeys(0, fingerprints);
+    ASSERT_FALSE(m_filter.mayContain(0, keyFingerprint(0)));
+    ASSERT_TRUE(m_filter.mayContain(0, keyFingerprint(1)));
+    for (int block_id = 0; block_id < num_blocks / 2; block_id++) {
+        m_filter.removeBlock(block_id);
+        ASSERT_FALSE(m_filter.hasBlock(block_id));
+    }
+    ASSERT_EQ(num_blocks / 2 * KEYS_PER_BLOCK, m_filter.getKeyCount());
+    ASSERT_EQ(num_blocks / 2 * KEYS_PER_BLOCK,
+              countMatches(num_blocks / 2 * KEYS_PER_BLOCK, num_blocks / 2 * KEYS_PER_BLOCK));
+
+    // Once most of the summary is stale it is rebuilt without the merged
+    // keys
+    m_filter.removeBlock(num_blocks / 2);
+    ASSERT_TRUE(m_filter.mayContain(keyFingerprint(num_blocks * KEYS_PER_BLOCK - 1)));
+    ASSERT_TRUE(m_filter.getSummaryRebuilds() > rebuilds);
+    ASSERT_TRUE(countMatches(0, num_blocks / 2 * KEYS_PER_BLOCK) < num_blocks / 2 * KEYS_PER_BLOCK / 100);
+
+    for (int block_id = num_blocks / 2 + 1; block_id < num_blocks; block_id++) {
+        m_filter.removeBlock(block_id);
+    }
+    ASSERT_EQ(0, m_filter.getKeyCount());
+    ASSERT_EQ(0, countMatches(0, num_blocks * KEYS_PER_BLOCK));
+}
+
+TEST_F(AntiCacheKeyFilterTest, UnfilteredBlocks) {
+    addBlocks(1);
+    m_filter.addUnfilteredBlock(42);
+    ASSERT_TRUE(m_filter.mayContain(keyFingerprint(KEYS_PER_BLOCK)));
+    ASSERT_TRUE(m_filter.mayContain(42, keyFingerprint(KEYS_PER_BLOCK)));
+
+    // A migrated block is still unfiltered
+    m_filter.renameBlock(42, 43);
+    ASSERT_TRUE(m_filter.mayContain(keyFingerprint(KEYS_PER_BLOCK)));
+    m_filter.removeBlock(42);
+    ASSERT_TRUE(m_filter.mayContain(keyFingerprint(KEYS_PER_BLOCK)));
+
+    m_filter.removeBlock(43);
+    ASSERT_FALSE(m_filter.mayContain(keyFingerprint(KEYS_PER_BLOCK)));
+    ASSERT_TRUE(m_filter.mayContain(keyFingerprint(0)));
+}
+
+TEST_F(AntiCacheKeyFilterTest, RenameBlock) {
+    addBlocks(2);
+    m_filter.renameBlock(1, 0x10000001);
+    ASSERT_FALSE(m_filter.hasBlock(1));
+    ASSERT_TRUE(m_filter.hasBlock(0x10000001));
+    ASSERT_TRUE(m_filter.mayContain(0x10000001, keyFingerprint(KEYS_PER_BLOCK)));
+    ASSERT_FALSE(m_filter.mayContain(0x10000001, keyFingerprint(0)));
+    ASSERT_EQ(2 * KEYS_PER_BLOCK, m_filter.getKeyCount());
+}
+
+TEST_F(AntiCacheKeyFilterTest, SerializeFingerprints) {
+    vector<uint32_t> fingerprints;
+    for (int i = 0; i < KEYS_PER_BLOCK; i++) {
+        fingerprints.push_back(keyFingerprint(i));
+    }
+    int size = AntiCacheKeyFilter::serializedSize(KEYS_PER_BLOCK);
+    vector<char> buffer(size + 4);
+    ReferenceSerializeOutput out(&buffer[0], size + 4);
+    out.writeInt(1234);
+    AntiCacheKeyFilter::serializeTo(out, fingerprints);
+    ASSERT_EQ(size + 4, (int)out.size());
+
+    ReferenceSerializeInput in(&buffer[0], size + 4);
+    ASSERT_EQ(1234, in.readInt());
+    vector<uint32_t> read;
+    ASSERT_TRUE(AntiCacheKeyFilter::deserializeFrom(in, read));
+    ASSERT_TRUE(read == fingerprints);
+
+    // A block without keys
+    ReferenceSerializeInput other(&buffer[0], size + 4);
+    read.clear();
+    ASSERT_FALSE(AntiCacheKeyFilter::deserializeFrom(other, read));
+}
+
+TEST_F(AntiCacheKeyFilterTest, TupleFingerprint) {
+    vector<ValueType> types;
+    vector<int32_t> sizes;
+    vector<bool> allow_null(3, false);
+    types.push_back(VALUE_TYPE_INTEGER);   sizes.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    types.push_back(VALUE_TYPE_VARCHAR);   sizes.push_back(16);
+    types.push_back(VALUE_TYPE_TINYINT);   sizes.push_back(NValue::getTupleStorageSize(VALUE_TYPE_TINYINT));
+    TupleSchema *schema = TupleSchema::createTupleSchema(types, sizes, allow_null, true);
+
+    vector<char> data(schema->tupleLength() + TUPLE_HEADER_SIZE);
+    TableTuple tuple(&data[0], schema);
+    tuple.setNValue(0, ValueFactory::getIntegerValue(7));
+    NValue name = ValueFactory::getStringValue("warehouse");
+    tuple.setNValue(1, name);
+    tuple.setNValue(2, ValueFactory::getTinyIntValue(3));
+
+    // The key from a predicate has to be cast to the column types first
+    vector<int> columns;
+    columns.push_back(2);
+    columns.push_back(1);
+    vector<NValue> key;
+    key.push_back(ValueFactory::getBigIntValue(3).castAs(VALUE_TYPE_TINYINT));
+    key.push_back(name);
+    ASSERT_EQ(AntiCacheKeyFilter::fingerprint(tuple, columns), AntiCacheKeyFilter::fingerprint(key));
+
+    key[0] = ValueFactory::getBigIntValue(4).castAs(VALUE_TYPE_TINYINT);
+    ASSERT_NE(AntiCacheKeyFilter::fingerprint(tuple, columns), AntiCacheKeyFilter::fingerprint(key));
+
+    name.free();
+    TupleSchema::freeTupleSchema(schema);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
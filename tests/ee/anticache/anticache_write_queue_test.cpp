@@ -0,0 +1,374 @@
+/* Copyright (C) 2012 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheWriteQueue.h"
+#include "anticache/FullBackingStoreException.h"
+#include "anticache/NVMAntiCacheDB.h"
+#include "anticache/UnknownBlockAccessException.h"
+
+using namespace std;
+using namespace voltdb;
+using stupidunit::ChTempDir;
+
+#define BLOCK_SIZE 524288
+#define MAX_BLOCKS 64
+
+/**
+ * A block returned by TestAntiCacheDB
+ */
+class TestAntiCacheBlock : public AntiCacheBlock {
+public:
+    TestAntiCacheBlock(uint32_t blockId, const string &data) : AntiCacheBlock(blockId) {
+        m_block = new char[data.size()];
+        memcpy(m_block, data.data(), data.size());
+        m_size = static_cast<int32_t>(data.size());
+        m_buf = NULL;
+        m_payload.blockId = blockId;
+        m_payload.tableName = "FAKE";
+        m_payload.data = m_block;
+        m_payload.size = m_size;
+        m_blockType = ANTICACHEDB_NVM;
+    }
+    ~TestAntiCacheBlock() {
+        delete [] m_block;
+    }
+};
+
+/**
+ * An AntiCacheDB in memory whose writes can be held up until the test
+ * lets them through
+ */
+class TestAntiCacheDB : public AntiCacheDB {
+public:
+    TestAntiCacheDB(bool blockMerge) :
+        AntiCacheDB(NULL, ".", BLOCK_SIZE, BLOCK_SIZE * MAX_BLOCKS),
+        m_open(true), m_flushes(0), m_reads(0), m_failedBlockId(0) {
+        m_dbType = ANTICACHEDB_NVM;
+        setBlockMerge(blockMerge);
+        pthread_mutex_init(&m_mutex, NULL);
+        pthread_cond_init(&m_opened, NULL);
+    }
+
+    ~TestAntiCacheDB() {
+        open();
+        setAsyncWrites(0);
+        pthread_cond_destroy(&m_opened);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    uint32_t nextBlockId() {
+        return (++m_nextBlockId);
+    }
+
+    void writeBlock(const std::string tableName, uint32_t blockId, const int tupleCount,
+                    const char* data, const long size, const int evictedBytes) {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_open) {
+            pthread_cond_wait(&m_opened, &m_mutex);
+        }
+        pthread_mutex_unlock(&m_mutex);
+        if (blockId == m_failedBlockId || getFreeBlocks() == 0) {
+            throw FullBackingStoreException(blockId, 0);
+        }
+        m_blocks[blockId] = string(data, size);
+        m_writeOrder.push_back(blockId);
+        m_totalBlocks++;
+    }
+
+    AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate) {
+        map<uint32_t, string>::iterator it = m_blocks.find(blockId);
+        if (it == m_blocks.end()) {
+            throw UnknownBlockAccessException(blockId);
+        }
+        m_reads++;
+        AntiCacheBlock* block = new TestAntiCacheBlock(blockId, it->second);
+        if (isBlockMerge() || isMigrate) {
+            m_blocks.erase(it);
+            m_totalBlocks--;
+        }
+        return block;
+    }
+
+    bool validateBlock(uint32_t blockId) {
+        return m_blocks.find(blockId) != m_blocks.end();
+    }
+
+    void flushBlocks() {
+        m_flushes++;
+    }
+
+    /** Hold up the writes from now on */
+    void close() {
+        pthread_mutex_lock(&m_mutex);
+        m_open = false;
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void open() {
+        pthread_mutex_lock(&m_mutex);
+        m_open = true;
+        pthread_cond_broadcast(&m_opened);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    bool m_open;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_opened;
+    map<uint32_t, string> m_blocks;
+    vector<uint32_t> m_writeOrder;
+    int m_flushes;
+    int m_reads;
+    uint32_t m_failedBlockId;
+
+protected:
+    void shutdownDB() {}
+};
+
+static string payload(uint32_t blockId) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "block %u of evicted tuples", blockId);
+    return string(buffer);
+}
+
+/** Submit a block with the payload for its id */
+static void submit(AntiCacheDB *db, uint32_t blockId) {
+    const string data = payload(blockId);
+    char* copy = new char[data.size()];
+    memcpy(copy, data.data(), data.size());
+    db->submitBlock("FAKE", blockId, 1, copy, static_cast<long>(data.size()), 1);
+}
+
+static string contents(AntiCacheBlock *block) {
+    string data(block->getData(), block->getSize());
+    delete block;
+    return data;
+}
+
+/** Let the writes of the database through after a while */
+static void* openLater(void *arg) {
+    usleep(50000);
+    static_cast<TestAntiCacheDB*>(arg)->open();
+    return NULL;
+}
+
+class AntiCacheWriteQueueTest : public Test {
+public:
+    AntiCacheWriteQueueTest() {}
+};
+
+/**
+ * Submitting a block does not wait for it to be written, and a block
+ * that is read back while still queued is never written
+ */
+TEST_F(AntiCacheWriteQueueTest, WritesInBackground) {
+    TestAntiCacheDB db(true);
+    db.setAsyncWrites(4);
+    db.close();
+    for (uint32_t blockId = 1; blockId <= 3; blockId++) {
+        submit(&db, blockId);
+    }
+    AntiCacheWriteQueue *queue = db.getWriteQueue();
+    ASSERT_TRUE(queue != NULL);
+    EXPECT_EQ(3, queue->getQueuedBlocks());
+    // the block being written is up to the database
+    EXPECT_TRUE(db.getFreeBlocks() >= MAX_BLOCKS - 3);
+    EXPECT_TRUE(db.getFreeBlocks() <= MAX_BLOCKS - 2);
+    EXPECT_EQ(0, (int)db.m_blocks.size());
+    for (uint32_t blockId = 1; blockId <= 3; blockId++) {
+        EXPECT_TRUE(db.hasBlock(blockId));
+    }
+
+    // the writer holds on to block 1, blocks 2 and 3 are still waiting
+    EXPECT_EQ(payload(3), contents(db.fetchBlock(3, false)));
+    EXPECT_EQ(1, queue->getQueueHits());
+
+    db.open();
+    db.drainWrites();
+    EXPECT_FALSE(db.hasBlock(3));
+    EXPECT_EQ(0, queue->getQueuedBlocks());
+    ASSERT_EQ(2, (int)db.m_writeOrder.size());
+    EXPECT_EQ(1, db.m_writeOrder[0]);
+    EXPECT_EQ(2, db.m_writeOrder[1]);
+    EXPECT_TRUE(db.m_flushes >= 1);
+    EXPECT_EQ(MAX_BLOCKS - 2, db.getFreeBlocks());
+    EXPECT_EQ(0, db.m_reads);
+
+    int32_t blocks;
+    int64_t totalMicros, maxMicros;
+    queue->getWriteLatency(&blocks, &totalMicros, &maxMicros);
+    EXPECT_EQ(2, blocks);
+    EXPECT_TRUE(maxMicros <= totalMicros);
+    queue->getWriteLatency(&blocks, &totalMicros, &maxMicros);
+    EXPECT_EQ(0, blocks);
+
+    EXPECT_EQ(payload(1), contents(db.fetchBlock(1, false)));
+    EXPECT_EQ(1, db.m_reads);
+}
+
+/**
+ * Reading the block that is being written waits for the write and then
+ * reads it from the database
+ */
+TEST_F(AntiCacheWriteQueueTest, ReadWhileWriting) {
+    TestAntiCacheDB db(true);
+    db.setAsyncWrites(4);
+    db.close();
+    submit(&db, 1);
+    // give the writer time to pick up the block
+    while (db.getWriteQueue()->getQueuedBlocks() != 1) {
+        usleep(1000);
+    }
+    usleep(10000);
+
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, openLater, &db));
+    EXPECT_EQ(payload(1), contents(db.fetchBlock(1, false)));
+    pthread_join(thread, NULL);
+    EXPECT_EQ(1, db.m_reads);
+    EXPECT_EQ(0, db.getWriteQueue()->getQueueHits());
+    EXPECT_FALSE(db.hasBlock(1));
+}
+
+/**
+ * A full queue holds up the next block until the writer catches up, and
+ * the blocks are written in the order they were submitted
+ */
+TEST_F(AntiCacheWriteQueueTest, FullQueue) {
+    TestAntiCacheDB db(true);
+    db.setAsyncWrites(2);
+    for (uint32_t blockId = 1; blockId <= 50; blockId++) {
+        submit(&db, blockId);
+        EXPECT_TRUE(db.getWriteQueue()->getQueuedBlocks() <= 3);
+    }
+    db.drainWrites();
+    ASSERT_EQ(50, (int)db.m_writeOrder.size());
+    for (uint32_t blockId = 1; blockId <= 50; blockId++) {
+        EXPECT_EQ(blockId, db.m_writeOrder[blockId - 1]);
+        EXPECT_EQ(payload(blockId), db.m_blocks[blockId]);
+    }
+}
+
+/**
+ * The queued blocks do not count twice against the free space of the
+ * database once they are being written
+ */
+TEST_F(AntiCacheWriteQueueTest, FillDatabase) {
+    TestAntiCacheDB db(true);
+    db.setAsyncWrites(4);
+    for (uint32_t blockId = 1; blockId <= MAX_BLOCKS; blockId++) {
+        submit(&db, blockId);
+    }
+    db.drainWrites();
+    EXPECT_EQ(0, db.getWriteQueue()->getFailedWrites());
+    EXPECT_EQ(MAX_BLOCKS, (int)db.m_blocks.size());
+    EXPECT_EQ(0, db.getFreeBlocks());
+}
+
+/**
+ * With tuple merge a block read from the queue is a copy, and it is
+ * still written afterwards
+ */
+TEST_F(AntiCacheWriteQueueTest, TupleMerge) {
+    TestAntiCacheDB db(false);
+    db.setAsyncWrites(4);
+    db.close();
+    submit(&db, 1);
+    submit(&db, 2);
+    EXPECT_EQ(payload(2), contents(db.fetchBlock(2, false)));
+    EXPECT_TRUE(db.hasBlock(2));
+    db.open();
+    db.drainWrites();
+    EXPECT_EQ(2, (int)db.m_blocks.size());
+    EXPECT_EQ(payload(2), db.m_blocks[2]);
+}
+
+/**
+ * A block that cannot be written stays in memory and can still be read
+ */
+TEST_F(AntiCacheWriteQueueTest, FailedWrite) {
+    TestAntiCacheDB db(true);
+    db.m_failedBlockId = 2;
+    db.setAsyncWrites(4);
+    for (uint32_t blockId = 1; blockId <= 3; blockId++) {
+        submit(&db, blockId);
+    }
+    db.drainWrites();
+    EXPECT_EQ(1, db.getWriteQueue()->getFailedWrites());
+    EXPECT_EQ(2, (int)db.m_blocks.size());
+    EXPECT_TRUE(db.hasBlock(2));
+    EXPECT_EQ(payload(2), contents(db.fetchBlock(2, false)));
+    EXPECT_FALSE(db.hasBlock(2));
+}
+
+/**
+ * Turning the queue off writes out what is left, and submitBlock() goes
+ * back to writing synchronously
+ */
+TEST_F(AntiCacheWriteQueueTest, Synchronous) {
+    TestAntiCacheDB db(true);
+    db.setAsyncWrites(4);
+    submit(&db, 1);
+    db.setAsyncWrites(0);
+    EXPECT_TRUE(db.getWriteQueue() == NULL);
+    EXPECT_EQ(1, (int)db.m_blocks.size());
+    submit(&db, 2);
+    EXPECT_EQ(2, (int)db.m_blocks.size());
+    EXPECT_EQ(payload(2), contents(db.fetchBlock(2, false)));
+}
+
+/**
+ * The NVM store hands out a new block id for every block even though it
+ * only writes them later
+ */
+TEST_F(AntiCacheWriteQueueTest, NVM) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new NVMAntiCacheDB(NULL, ".", BLOCK_SIZE, BLOCK_SIZE * MAX_BLOCKS);
+    anticache->setAsyncWrites(8);
+    vector<uint32_t> blockIds;
+    for (int i = 0; i < 20; i++) {
+        uint32_t blockId = anticache->nextBlockId();
+        if (i > 0) ASSERT_NE(blockIds.back(), blockId);
+        blockIds.push_back(blockId);
+        submit(anticache, blockId);
+    }
+    for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(payload(blockIds[i]), contents(anticache->fetchBlock(blockIds[i], false)));
+    }
+    anticache->drainWrites();
+    EXPECT_EQ(0, anticache->getNumBlocks());
+    delete anticache;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -28,6 +28,8 @@
 #include "anticache/AntiCacheDB.h"
 #include "anticache/BerkeleyAntiCacheDB.h"
 #include "anticache/NVMAntiCacheDB.h"
+#include "anticache/LogAntiCacheDB.h"
+#include "anticache/UnknownBlockAccessException.h"
 
 using namespace std;
 using namespace voltdb;
@@ -280,6 +282,178 @@ TEST_F(AntiCacheDBTest, NVMCheckCapacity) {
 
 
 
+TEST_F(AntiCacheDBTest, LogReadBlock) {
+    ChTempDir tempdir;
+
+    AntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+
+    string tableName("FAKE");
+    string payload("Test Read");
+    uint32_t blockId = anticache->nextBlockId();
+    anticache->writeBlock(tableName,
+                         blockId,
+                         1,
+                         const_cast<char*>(payload.data()),
+                         static_cast<int>(payload.size())+1,
+                         1);
+    anticache->flushBlocks();
+    ASSERT_TRUE(anticache->validateBlock(blockId));
+
+    AntiCacheBlock* block = anticache->readBlock(blockId, 0);
+    ASSERT_EQ(block->getTableName(), tableName);
+    ASSERT_EQ(block->getBlockId(), blockId);
+    ASSERT_EQ(block->getSize(), static_cast<long>(payload.size() + 1));
+    ASSERT_EQ(0, payload.compare(block->getData()));
+    ASSERT_FALSE(anticache->validateBlock(blockId));
+
+    delete block;
+    delete anticache;
+}
+
+TEST_F(AntiCacheDBTest, LogCheckCapacity) {
+    ChTempDir tempdir;
+
+    AntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, BLOCK_SIZE*2);
+    anticache->setBlockMerge(false);
+    string tableName("FAKE");
+    string payload("Test Capacity");
+    for (int i = 0; i < 2; i++) {
+        anticache->writeBlock(tableName,
+                             anticache->nextBlockId(),
+                             1,
+                             const_cast<char*>(payload.data()),
+                             static_cast<int>(payload.size())+1,
+                             1);
+    }
+    ASSERT_EQ(anticache->getNumBlocks(), 2);
+    ASSERT_EQ(anticache->getFreeBlocks(), 0);
+    ASSERT_EQ(anticache->getBlocksEvicted(), 2);
+
+    bool full = false;
+    try {
+        anticache->writeBlock(tableName, anticache->nextBlockId(), 1,
+                              const_cast<char*>(payload.data()),
+                              static_cast<int>(payload.size())+1, 1);
+    } catch (FullBackingStoreException &e) {
+        full = true;
+    }
+    ASSERT_TRUE(full);
+
+    // with tuple merge the block stays where it is
+    AntiCacheBlock* block = anticache->readBlock(0, 0);
+    ASSERT_EQ(0, payload.compare(block->getData()));
+    ASSERT_TRUE(anticache->validateBlock(0));
+    ASSERT_EQ(anticache->getNumBlocks(), 2);
+    delete block;
+
+    // a migrated block leaves the database
+    block = anticache->readBlock(1, 1);
+    ASSERT_FALSE(anticache->validateBlock(1));
+    ASSERT_EQ(anticache->getNumBlocks(), 1);
+    ASSERT_EQ(anticache->getFreeBlocks(), 1);
+    ASSERT_EQ(anticache->getBlocksUnevicted(), 1);
+    delete block;
+
+    delete anticache;
+}
+
+/** Write a block whose contents depend on its id */
+static void writeLogBlock(AntiCacheDB* anticache, uint32_t blockId, int size) {
+    string data(size, (char)('a' + blockId % 26));
+    anticache->writeBlock("FAKE", blockId, 1, data.data(), size, size);
+}
+
+static bool isLogBlock(AntiCacheBlock* block, uint32_t blockId, int size) {
+    return (block->getBlockId() == blockId && block->getSize() == size &&
+            string(block->getData(), size) == string(size, (char)('a' + blockId % 26)));
+}
+
+TEST_F(AntiCacheDBTest, LogReadBlocks) {
+    ChTempDir tempdir;
+
+    AntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    for (uint32_t i = 0; i < 6; i++) {
+        writeLogBlock(anticache, anticache->nextBlockId(), 5000 + (int)i);
+    }
+
+    // an unknown block fails the whole batch before anything is read
+    vector<uint32_t> blockIds;
+    blockIds.push_back(4);
+    blockIds.push_back(99);
+    vector<AntiCacheBlock*> blocks;
+    bool unknown = false;
+    try {
+        anticache->readBlocks(blockIds, 0, blocks);
+    } catch (UnknownBlockAccessException &e) {
+        unknown = true;
+    }
+    ASSERT_TRUE(unknown);
+    ASSERT_TRUE(blocks.empty());
+    ASSERT_TRUE(anticache->validateBlock(4));
+
+    blockIds.clear();
+    blockIds.push_back(4);
+    blockIds.push_back(1);
+    blockIds.push_back(2);
+    blockIds.push_back(5);
+    anticache->readBlocks(blockIds, 0, blocks);
+    ASSERT_EQ(4, (int)blocks.size());
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(isLogBlock(blocks[i], blockIds[i], 5000 + (int)blockIds[i]));
+        ASSERT_FALSE(anticache->validateBlock(blockIds[i]));
+        delete blocks[i];
+    }
+    ASSERT_TRUE(anticache->validateBlock(0));
+    ASSERT_TRUE(anticache->validateBlock(3));
+    ASSERT_EQ(anticache->getNumBlocks(), 2);
+    ASSERT_EQ(anticache->getBlocksUnevicted(), 4);
+
+    delete anticache;
+}
+
+TEST_F(AntiCacheDBTest, LogCleanSegments) {
+    ChTempDir tempdir;
+
+    // every block takes up 8KB of the log, so a segment holds SEGMENT_BLOCKS of them
+    const int blockSize = 8192 - 64;
+    const int size = 8000;
+    const int segmentBlocks = LogAntiCacheDB::SEGMENT_BLOCKS;
+    LogAntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", blockSize, (long)blockSize * 100);
+    for (int i = 0; i < 2 * segmentBlocks + 1; i++) {
+        writeLogBlock(anticache, anticache->nextBlockId(), size);
+    }
+    ASSERT_EQ(3, anticache->getNumSegments());
+    ASSERT_EQ((int64_t)(2 * segmentBlocks + 1) * 8192, anticache->getLogSize());
+
+    // the first segment is left with one block, which gets moved (the
+    // cleaner thread may already have moved some of the others)
+    for (uint32_t blockId = 1; blockId < (uint32_t)segmentBlocks; blockId++) {
+        delete anticache->readBlock(blockId, 0);
+    }
+    anticache->cleanSegments();
+    ASSERT_EQ(2, anticache->getNumSegments());
+    ASSERT_TRUE(anticache->validateBlock(0));
+    ASSERT_TRUE(anticache->getLogSize() < (int64_t)(2 * segmentBlocks + 1) * 8192);
+
+    // a segment without any blocks left goes away right away
+    for (uint32_t blockId = segmentBlocks; blockId < 2 * (uint32_t)segmentBlocks; blockId++) {
+        AntiCacheBlock* block = anticache->readBlock(blockId, 0);
+        ASSERT_TRUE(isLogBlock(block, blockId, size));
+        delete block;
+    }
+    ASSERT_EQ(1, anticache->getNumSegments());
+
+    AntiCacheBlock* block = anticache->readBlock(0, 0);
+    ASSERT_TRUE(isLogBlock(block, 0, size));
+    delete block;
+    block = anticache->readBlock(2 * segmentBlocks, 0);
+    ASSERT_TRUE(isLogBlock(block, 2 * segmentBlocks, size));
+    delete block;
+    ASSERT_EQ(anticache->getNumBlocks(), 0);
+
+    delete anticache;
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,143 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+#include "harness.h"
+#include "common/BlockAllocator.h"
+#include "common/Pool.hpp"
+
+using namespace std;
+using namespace voltdb;
+
+static const size_t HUGE_PAGE = HugePageBlockAllocator::HUGE_PAGE_SIZE;
+
+class BlockAllocatorTest : public Test {
+public:
+    BlockAllocatorTest() {}
+
+    /** Bytes the allocator has mapped, whatever pages it got */
+    static int64_t mappedBytes(const HugePageBlockAllocator &allocator) {
+        return ((allocator.getHugePages() + allocator.getTransparentHugePages()) * static_cast<int64_t>(HUGE_PAGE) +
+                allocator.getSmallPageBytes());
+    }
+
+    static bool isMapped(BlockAllocator::PageType type) {
+        return (type == BlockAllocator::PAGES_SMALL ||
+                type == BlockAllocator::PAGES_TRANSPARENT_HUGE ||
+                type == BlockAllocator::PAGES_HUGE);
+    }
+};
+
+/**
+ * Table sized blocks are mapped on huge page boundaries, whichever kind of
+ * pages the machine can give, and the stats follow them
+ */
+TEST_F(BlockAllocatorTest, TableBlocks) {
+    HugePageBlockAllocator allocator;
+    vector<char*> blocks;
+    vector<size_t> sizes;
+    int64_t expected = 0;
+    for (int i = 0; i < 4; i++) {
+        // the last one needs two huge pages
+        const size_t bytes = (i < 3 ? HUGE_PAGE : HUGE_PAGE + HUGE_PAGE / 2);
+        char *block = allocator.allocate(bytes);
+        ASSERT_TRUE(block != NULL);
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(block) % HUGE_PAGE);
+        ASSERT_TRUE(isMapped(allocator.pageType(block)));
+        memset(block, i + 1, bytes);
+        blocks.push_back(block);
+        sizes.push_back(bytes);
+        expected += (i < 3 ? 1 : 2) * static_cast<int64_t>(HUGE_PAGE);
+    }
+    ASSERT_EQ(expected, mappedBytes(allocator));
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (size_t offset = 0; offset < sizes[i]; offset += 4096) {
+            ASSERT_EQ(static_cast<char>(i + 1), blocks[i][offset]);
+        }
+        allocator.release(blocks[i], sizes[i]);
+    }
+    ASSERT_EQ(0, allocator.getHugePages());
+    ASSERT_EQ(0, allocator.getTransparentHugePages());
+    ASSERT_EQ(0, allocator.getSmallPageBytes());
+}
+
+/**
+ * Without the explicit pool the blocks fall back to transparent or regular
+ * pages and no failures are counted
+ */
+TEST_F(BlockAllocatorTest, NoExplicitHugePages) {
+    HugePageBlockAllocator allocator(false);
+    char *block = allocator.allocate(HUGE_PAGE);
+    ASSERT_TRUE(allocator.pageType(block) != BlockAllocator::PAGES_HUGE);
+    ASSERT_TRUE(isMapped(allocator.pageType(block)));
+    ASSERT_EQ(0, allocator.getHugePages());
+    ASSERT_EQ(0, allocator.getHugePageFailures());
+    ASSERT_EQ(static_cast<int64_t>(HUGE_PAGE), mappedBytes(allocator));
+    allocator.release(block, HUGE_PAGE);
+    ASSERT_EQ(0, mappedBytes(allocator));
+}
+
+/**
+ * Blocks smaller than a huge page come from the heap and are not counted
+ */
+TEST_F(BlockAllocatorTest, SmallBlocks) {
+    HugePageBlockAllocator allocator;
+    char *block = allocator.allocate(64 * 1024);
+    memset(block, 0, 64 * 1024);
+    ASSERT_EQ(BlockAllocator::PAGES_HEAP, allocator.pageType(block));
+    ASSERT_EQ(0, mappedBytes(allocator));
+    allocator.release(block, 64 * 1024);
+}
+
+/**
+ * A pool gets its chunks, including the oversize ones, from its allocator
+ * and gives them all back
+ */
+TEST_F(BlockAllocatorTest, PoolChunks) {
+    HugePageBlockAllocator allocator;
+    {
+        Pool pool(HUGE_PAGE, 2, &allocator);
+        ASSERT_EQ(static_cast<int64_t>(HUGE_PAGE), mappedBytes(allocator));
+        for (int i = 0; i < 5; i++) {
+            memset(pool.allocate(HUGE_PAGE / 2), i, HUGE_PAGE / 2);
+        }
+        ASSERT_EQ(static_cast<int64_t>(3 * HUGE_PAGE), mappedBytes(allocator));
+
+        // only maxChunkCount chunks survive a purge
+        pool.purge();
+        ASSERT_EQ(static_cast<int64_t>(2 * HUGE_PAGE), mappedBytes(allocator));
+
+        memset(pool.allocate(HUGE_PAGE + 1), 0, HUGE_PAGE + 1);
+        ASSERT_EQ(static_cast<int64_t>(4 * HUGE_PAGE), mappedBytes(allocator));
+    }
+    ASSERT_EQ(0, mappedBytes(allocator));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
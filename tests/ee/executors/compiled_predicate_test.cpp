@@ -0,0 +1,235 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "executors/compiledpredicate.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define NUM_TUPLES 2000
+#define NUM_COLUMNS 7
+
+static const ExpressionType COMPARISONS[] = {
+    EXPRESSION_TYPE_COMPARE_EQUAL,
+    EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+    EXPRESSION_TYPE_COMPARE_LESSTHAN,
+    EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+    EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+    EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO
+};
+
+class CompiledPredicateTest : public Test {
+public:
+    CompiledPredicateTest() {
+        srand(0);
+        // (BIG BIGINT, INT INTEGER, SMALL SMALLINT, TINY TINYINT,
+        //  DBL DOUBLE, TS TIMESTAMP, STR VARCHAR(16))
+        string names[NUM_COLUMNS] = { "BIG", "INT", "SMALL", "TINY", "DBL", "TS", "STR" };
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_BIGINT);
+        types.push_back(VALUE_TYPE_INTEGER);
+        types.push_back(VALUE_TYPE_SMALLINT);
+        types.push_back(VALUE_TYPE_TINYINT);
+        types.push_back(VALUE_TYPE_DOUBLE);
+        types.push_back(VALUE_TYPE_TIMESTAMP);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        vector<int32_t> lengths;
+        for (int i = 0; i < NUM_COLUMNS - 1; i++) {
+            lengths.push_back(NValue::getTupleStorageSize(types[i]));
+        }
+        lengths.push_back(16);
+        vector<bool> allowNull(NUM_COLUMNS, true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        m_table = TableFactory::getTempTable(0, "T", schema, names, NULL);
+
+        // Small values so that every comparison has matches on both
+        // sides, and one in ten of each column is NULL
+        TableTuple &tuple = m_table->tempTuple();
+        for (int row = 0; row < NUM_TUPLES; row++) {
+            for (int col = 0; col < NUM_COLUMNS - 1; col++) {
+                const int value = rand() % 21 - 10;
+                if (rand() % 10 == 0) {
+                    tuple.setNValue(col, NValue::getNullValue(types[col]));
+                } else if (types[col] == VALUE_TYPE_DOUBLE) {
+                    tuple.setNValue(col, ValueFactory::getDoubleValue(value / 2.0));
+                } else {
+                    tuple.setNValue(col, ValueFactory::getBigIntValue(value).castAs(types[col]));
+                }
+            }
+            NValue str = ValueFactory::getStringValue("abc");
+            tuple.setNValue(NUM_COLUMNS - 1, str);
+            m_table->insertTuple(tuple);
+            str.free();
+        }
+    }
+
+    ~CompiledPredicateTest() {
+        delete m_table;
+    }
+
+    AbstractExpression* column(int idx) {
+        return new TupleValueExpression(idx, "T", "C");
+    }
+
+    /**
+     * Compile and bind the predicate, and check that it agrees with the
+     * AbstractExpression tree on every tuple of the table. The predicate
+     * must already have had its parameters substituted.
+     */
+    void check(const AbstractExpression *predicate) {
+        CompiledPredicate compiled;
+        ASSERT_TRUE(compiled.compile(predicate, m_table->schema()));
+        ASSERT_TRUE(compiled.bind());
+        int matches = 0;
+        TableIterator iter = m_table->tableIterator();
+        TableTuple tuple(m_table->schema());
+        while (iter.next(tuple)) {
+            const bool expected = predicate->eval(&tuple, NULL).isTrue();
+            ASSERT_EQ(expected, compiled.eval(tuple));
+            if (expected) matches++;
+        }
+        ASSERT_TRUE(matches >= 0 && matches <= NUM_TUPLES);
+    }
+
+    Table *m_table;
+};
+
+/**
+ * Every comparison on every numeric column, against integer, double and
+ * NULL constants on either side, gives the same answer as NValue
+ */
+TEST_F(CompiledPredicateTest, Comparisons) {
+    vector<NValue> constants;
+    constants.push_back(ValueFactory::getBigIntValue(3));
+    constants.push_back(ValueFactory::getIntegerValue(-4));
+    constants.push_back(ValueFactory::getTinyIntValue(0));
+    constants.push_back(ValueFactory::getBigIntValue(100000));
+    constants.push_back(ValueFactory::getDoubleValue(2.5));
+    constants.push_back(ValueFactory::getDoubleValue(-3.0));
+    constants.push_back(NValue::getNullValue(VALUE_TYPE_BIGINT));
+    constants.push_back(NValue::getNullValue(VALUE_TYPE_DOUBLE));
+
+    for (int col = 0; col < NUM_COLUMNS - 1; col++) {
+        for (int op = 0; op < sizeof(COMPARISONS) / sizeof(COMPARISONS[0]); op++) {
+            for (int c = 0; c < constants.size(); c++) {
+                AbstractExpression *left = comparisonFactory(COMPARISONS[op], column(col),
+                                                             constantValueFactory(constants[c]));
+                check(left);
+                delete left;
+                AbstractExpression *right = comparisonFactory(COMPARISONS[op],
+                                                              constantValueFactory(constants[c]),
+                                                              column(col));
+                check(right);
+                delete right;
+            }
+        }
+    }
+}
+
+/**
+ * Conjunctions over parameters pick up new values on every bind()
+ */
+TEST_F(CompiledPredicateTest, Parameters) {
+    // (INT > ? AND DBL <= ?) OR TINY = ?
+    AbstractExpression *predicate = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR,
+        conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHAN, column(1), parameterValueFactory(0)),
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO, column(4), parameterValueFactory(1))),
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL, column(3), parameterValueFactory(2)));
+
+    CompiledPredicate compiled;
+    ASSERT_TRUE(compiled.compile(predicate, m_table->schema()));
+    for (int round = 0; round < 5; round++) {
+        NValueArray params(3);
+        params[0] = ValueFactory::getIntegerValue(round - 2);
+        params[1] = (round % 2 == 0 ? ValueFactory::getDoubleValue(round - 1.5) :
+                                      ValueFactory::getBigIntValue(round));
+        params[2] = ValueFactory::getBigIntValue(round);
+        predicate->substitute(params);
+        check(predicate);
+    }
+
+    // A parameter that cannot be compared on the tuple storage has to
+    // go through the AbstractExpression tree
+    NValueArray params(3);
+    params[0] = ValueFactory::getIntegerValue(0);
+    params[1] = ValueFactory::getDecimalValueFromString("1.5");
+    params[2] = ValueFactory::getBigIntValue(0);
+    predicate->substitute(params);
+    ASSERT_FALSE(compiled.bind());
+    delete predicate;
+}
+
+/**
+ * Anything but numeric column comparisons against constants is left to
+ * the AbstractExpression tree
+ */
+TEST_F(CompiledPredicateTest, Unsupported) {
+    CompiledPredicate compiled;
+    ASSERT_FALSE(compiled.compile(NULL, m_table->schema()));
+
+    // a VARCHAR column (the constant expression frees its string)
+    AbstractExpression *predicate = comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL, column(6),
+                                                      constantValueFactory(ValueFactory::getStringValue("abc")));
+    ASSERT_FALSE(compiled.compile(predicate, m_table->schema()));
+    ASSERT_FALSE(compiled.isCompiled());
+    delete predicate;
+
+    // two columns
+    predicate = comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN, column(0), column(1));
+    ASSERT_FALSE(compiled.compile(predicate, m_table->schema()));
+    delete predicate;
+
+    // arithmetic, even under a conjunction that could otherwise be compiled
+    predicate = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL, column(0),
+                          constantValueFactory(ValueFactory::getBigIntValue(1))),
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL,
+                          operatorFactory(EXPRESSION_TYPE_OPERATOR_PLUS, column(1),
+                                          constantValueFactory(ValueFactory::getBigIntValue(1))),
+                          constantValueFactory(ValueFactory::getBigIntValue(2))));
+    ASSERT_FALSE(compiled.compile(predicate, m_table->schema()));
+    delete predicate;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
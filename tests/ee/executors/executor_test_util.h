@@ -0,0 +1,108 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef EXECUTOR_TEST_UTIL_H__
+#define EXECUTOR_TEST_UTIL_H__
+
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "common/NValue.hpp"
+#include "common/types.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/aggregatenode.h"
+#include "storage/table.h"
+
+/**
+ * Stands in for a child plan node that has already filled its output table
+ */
+class InputPlanNode : public voltdb::AbstractPlanNode {
+public:
+    InputPlanNode(voltdb::Table *table) : voltdb::AbstractPlanNode() {
+        m_outputTable = table;
+        for (int i = 0; i < table->columnCount(); i++) {
+            m_outputColumnGuids.push_back(i);
+        }
+    }
+    ~InputPlanNode() { delete m_outputTable; }
+    voltdb::PlanNodeType getPlanNodeType() const { return voltdb::PLAN_NODE_TYPE_MATERIALIZE; }
+    int getColumnIndexFromGuid(int guid, const catalog::Database *db) const { return guid; }
+    std::string debugInfo(const std::string &spacer) const { return spacer; }
+protected:
+    void loadFromJSONObject(json_spirit::Object &obj, const catalog::Database *catalog_db) {}
+};
+
+/**
+ * A HASHAGGREGATE node put together column by column, the way the planner
+ * would describe it
+ */
+class TestAggregatePlanNode : public voltdb::AggregatePlanNode {
+public:
+    TestAggregatePlanNode() : voltdb::AggregatePlanNode(voltdb::PLAN_NODE_TYPE_HASHAGGREGATE) {}
+
+    /** Output column copied from the input, usually a group by column */
+    void passThrough(int inputColumn, voltdb::ValueType type) {
+        addOutputColumn(type, inputColumn);
+    }
+
+    void aggregate(voltdb::ExpressionType aggregateType, int inputColumn, voltdb::ValueType outputType) {
+        m_aggregateOutputColumns.push_back(static_cast<int>(m_outputColumnTypes.size()));
+        addOutputColumn(outputType, -1);
+        m_aggregates.push_back(aggregateType);
+        m_aggregateColumnNames.push_back("A");
+        m_aggregateColumnGuids.push_back(inputColumn);
+    }
+
+    void groupBy(int inputColumn) {
+        m_groupByColumns.push_back(inputColumn);
+    }
+
+private:
+    void addOutputColumn(voltdb::ValueType type, int inputColumn) {
+        char name[16];
+        snprintf(name, sizeof(name), "C%d", (int)m_outputColumnTypes.size());
+        m_outputColumnNames.push_back(name);
+        m_outputColumnTypes.push_back(type);
+        m_outputColumnSizes.push_back(voltdb::NValue::getTupleStorageSize(type));
+        m_outputColumnGuids.push_back(inputColumn);
+    }
+};
+
+/** Seconds since start */
+static inline double elapsed(const struct timeval &start) {
+    struct timeval end;
+    gettimeofday(&end, NULL);
+    return (static_cast<double>(end.tv_sec - start.tv_sec) +
+            static_cast<double>(end.tv_usec - start.tv_usec) / 1000000.0);
+}
+
+/** Whether a generated value should be NULL, about one in oneIn times */
+static inline bool isNull(int oneIn = 20) {
+    return (rand() % oneIn == 0);
+}
+
+#endif
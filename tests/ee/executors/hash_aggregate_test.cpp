@@ -0,0 +1,340 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/debuglog.h"
+#include "executors/executor_test_util.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/SQLException.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/executors.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/aggregatenode.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define NUM_GROUPING_ROWS 20000
+
+// columns of the input table
+enum { G1, G2, T, V, D, S };
+
+typedef AggregateExecutor<PLAN_NODE_TYPE_HASHAGGREGATE> HashAggregateExecutor;
+typedef multiset<string> AggregateResult;
+
+class HashAggregateTest : public Test {
+public:
+    HashAggregateTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+    }
+
+    ~HashAggregateTest() {
+        delete m_engine;
+    }
+
+    /**
+     * T(G1 INTEGER, G2 SMALLINT, T TINYINT, V BIGINT, D FLOAT, S VARCHAR(8))
+     * with G1 in [0, groups) and about one value in twenty NULL
+     */
+    Table* inputTable(int rows, int groups) {
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_INTEGER);
+        types.push_back(VALUE_TYPE_SMALLINT);
+        types.push_back(VALUE_TYPE_TINYINT);
+        types.push_back(VALUE_TYPE_BIGINT);
+        types.push_back(VALUE_TYPE_DOUBLE);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        vector<int32_t> lengths;
+        for (int i = 0; i < types.size() - 1; i++) {
+            lengths.push_back(NValue::getTupleStorageSize(types[i]));
+        }
+        lengths.push_back(8);
+        vector<bool> allowNull(types.size(), true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        string names[6] = { "G1", "G2", "T", "V", "D", "S" };
+        Table *table = TableFactory::getTempTable(0, "T", schema, names, &m_memory);
+
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < rows; i++) {
+            tuple.setNValue(G1, isNull() ? NValue::getNullValue(VALUE_TYPE_INTEGER) :
+                                           ValueFactory::getIntegerValue(rand() % groups));
+            tuple.setNValue(G2, isNull() ? NValue::getNullValue(VALUE_TYPE_SMALLINT) :
+                                           ValueFactory::getSmallIntValue(static_cast<int16_t>(rand() % 5 - 2)));
+            tuple.setNValue(T, isNull() ? NValue::getNullValue(VALUE_TYPE_TINYINT) :
+                                          ValueFactory::getTinyIntValue(static_cast<int8_t>(rand() % 200 - 100)));
+            tuple.setNValue(V, isNull() ? NValue::getNullValue(VALUE_TYPE_BIGINT) :
+                                          ValueFactory::getBigIntValue((int64_t)rand() * 1000 - 500000));
+            tuple.setNValue(D, isNull() ? NValue::getNullValue(VALUE_TYPE_DOUBLE) :
+                                          ValueFactory::getDoubleValue((rand() % 100000) / 16.0 - 1000));
+            char name[8];
+            snprintf(name, sizeof(name), "s%d", rand() % 7);
+            NValue value = ValueFactory::getStringValue(name);
+            tuple.setNValue(S, value);
+            table->insertTuple(tuple);
+            value.free();
+        }
+        return table;
+    }
+
+    /** Distinct values of G1, or of (G1, G2) */
+    static size_t countGroups(Table *input, bool composite) {
+        set<pair<string, string> > groups;
+        TableIterator iter(input);
+        TableTuple tuple(input->schema());
+        while (iter.next(tuple)) {
+            groups.insert(make_pair(tuple.getNValue(G1).debug(),
+                                    composite ? tuple.getNValue(G2).debug() : string()));
+        }
+        return groups.size();
+    }
+
+    /**
+     * Run the node over the input and return its rows. The typed
+     * aggregation is used if typed is set and the node allows it.
+     */
+    AggregateResult aggregate(TestAggregatePlanNode *node, Table *input, bool typed, bool *usedTyped,
+                              double *seconds = NULL) {
+        InputPlanNode child(input);
+        node->addChild(&child);
+        HashAggregateExecutor *executor = new HashAggregateExecutor(m_engine, node);
+        node->setExecutor(executor);
+        executor->setTypedAggregation(typed);
+        AggregateResult result;
+        try {
+            if (executor->init(m_engine, NULL, &m_memory)) {
+                *usedTyped = executor->usesTypedAggregation();
+                struct timeval start;
+                gettimeofday(&start, NULL);
+                const bool executed = executor->execute(NValueArray(), NULL);
+                if (seconds != NULL) {
+                    *seconds = elapsed(start);
+                }
+                if (executed) {
+                    TableIterator iter(node->getOutputTable());
+                    TableTuple tuple(node->getOutputTable()->schema());
+                    while (iter.next(tuple)) {
+                        result.insert(tuple.debugNoHeader());
+                    }
+                }
+            }
+        } catch (...) {
+            child.setOutputTable(NULL);
+            delete node;
+            throw;
+        }
+        // the caller keeps the input
+        child.setOutputTable(NULL);
+        delete node;
+        return result;
+    }
+
+    /**
+     * Check that the typed aggregation is used and gives the same rows as
+     * the generic one
+     */
+    void checkTyped(TestAggregatePlanNode *typedNode, TestAggregatePlanNode *genericNode,
+                    Table *input, size_t expectedGroups) {
+        bool usedTyped = false;
+        AggregateResult typed = aggregate(typedNode, input, true, &usedTyped);
+        ASSERT_TRUE(usedTyped);
+        AggregateResult generic = aggregate(genericNode, input, false, &usedTyped);
+        ASSERT_FALSE(usedTyped);
+        delete input;
+        ASSERT_EQ(expectedGroups, typed.size());
+        ASSERT_EQ(generic.size(), typed.size());
+        ASSERT_TRUE(generic == typed);
+    }
+
+    VoltDBEngine *m_engine;
+    int m_memory;
+};
+
+/** SELECT G1, <every aggregate> FROM T GROUP BY G1 */
+static TestAggregatePlanNode* everyAggregate(bool groupBy) {
+    TestAggregatePlanNode *node = new TestAggregatePlanNode();
+    if (groupBy) {
+        node->passThrough(G1, VALUE_TYPE_INTEGER);
+        node->groupBy(G1);
+    }
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT_STAR, S, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_AVG, V, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MIN, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, T, VALUE_TYPE_TINYINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, T, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_AVG, T, VALUE_TYPE_INTEGER);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT, D, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, D, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_AVG, D, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MIN, D, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, D, VALUE_TYPE_DOUBLE);
+    return node;
+}
+
+/**
+ * Every supported aggregate over a single integer group key, with NULL
+ * keys and values
+ */
+TEST_F(HashAggregateTest, SingleKey) {
+    Table *input = inputTable(20000, 3000);
+    checkTyped(everyAggregate(true), everyAggregate(true), input, countGroups(input, false));
+}
+
+/** SELECT G2, G1, SUM(T), MAX(V), COUNT(*) FROM T GROUP BY G2, G1 */
+static TestAggregatePlanNode* compositeKey() {
+    TestAggregatePlanNode *node = new TestAggregatePlanNode();
+    node->passThrough(G2, VALUE_TYPE_SMALLINT);
+    node->passThrough(G1, VALUE_TYPE_INTEGER);
+    node->groupBy(G2);
+    node->groupBy(G1);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, T, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT_STAR, S, VALUE_TYPE_BIGINT);
+    return node;
+}
+
+/**
+ * A composite group key, with enough groups to grow the hash table
+ */
+TEST_F(HashAggregateTest, CompositeKey) {
+    Table *input = inputTable(30000, 50);
+    checkTyped(compositeKey(), compositeKey(), input, countGroups(input, true));
+}
+
+/**
+ * Without a GROUP BY there is a single row, even for an empty input
+ */
+TEST_F(HashAggregateTest, NoGroupBy) {
+    checkTyped(everyAggregate(false), everyAggregate(false), inputTable(5000, 10), 1);
+    checkTyped(everyAggregate(false), everyAggregate(false), inputTable(0, 10), 1);
+    checkTyped(everyAggregate(true), everyAggregate(true), inputTable(0, 10), 0);
+}
+
+/**
+ * Keys and aggregates that the typed aggregation does not handle use the
+ * generic one
+ */
+TEST_F(HashAggregateTest, Fallback) {
+    bool usedTyped = true;
+    TestAggregatePlanNode *node = new TestAggregatePlanNode();
+    node->passThrough(S, VALUE_TYPE_VARCHAR);
+    node->groupBy(S);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, V, VALUE_TYPE_BIGINT);
+    Table *input = inputTable(1000, 10);
+    EXPECT_EQ(7, aggregate(node, input, true, &usedTyped).size());
+    EXPECT_FALSE(usedTyped);
+
+    usedTyped = true;
+    node = new TestAggregatePlanNode();
+    node->passThrough(G1, VALUE_TYPE_INTEGER);
+    node->groupBy(G1);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, S, VALUE_TYPE_VARCHAR);
+    EXPECT_EQ(11, aggregate(node, input, true, &usedTyped).size());
+    EXPECT_FALSE(usedTyped);
+    delete input;
+}
+
+/**
+ * A BIGINT sum that overflows fails like it does with NValue::op_add()
+ */
+TEST_F(HashAggregateTest, Overflow) {
+    for (int typed = 0; typed < 2; typed++) {
+        Table *input = inputTable(0, 1);
+        TableTuple &tuple = input->tempTuple();
+        for (int i = 0; i < 3; i++) {
+            tuple.setNValue(G1, ValueFactory::getIntegerValue(1));
+            tuple.setNValue(V, ValueFactory::getBigIntValue(INT64_MAX / 2));
+            input->insertTuple(tuple);
+        }
+        TestAggregatePlanNode *node = new TestAggregatePlanNode();
+        node->passThrough(G1, VALUE_TYPE_INTEGER);
+        node->groupBy(G1);
+        node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, V, VALUE_TYPE_BIGINT);
+        bool thrown = false;
+        bool usedTyped = false;
+        try {
+            aggregate(node, input, typed == 1, &usedTyped);
+        } catch (SQLException &e) {
+            thrown = true;
+        }
+        EXPECT_TRUE(thrown);
+        delete input;
+    }
+}
+
+/**
+ * The typed and the generic hash aggregation over a few group counts, from
+ * a handful of groups to about one group per row. The time each one takes
+ * is logged at the INFO level.
+ */
+TEST_F(HashAggregateTest, GroupCounts) {
+    const int rows = NUM_GROUPING_ROWS;
+    const int groupCounts[3] = { 10, 1000, 100000 };
+    for (int g = 0; g < 3; g++) {
+        Table *input = inputTable(rows, groupCounts[g]);
+        const size_t expectedGroups = countGroups(input, false);
+        double seconds[2];
+        AggregateResult results[2];
+        for (int typed = 1; typed >= 0; typed--) {
+            // SELECT G1, COUNT(*), SUM(V), AVG(D), MAX(T) FROM T GROUP BY G1
+            TestAggregatePlanNode *node = new TestAggregatePlanNode();
+            node->passThrough(G1, VALUE_TYPE_INTEGER);
+            node->groupBy(G1);
+            node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT_STAR, S, VALUE_TYPE_BIGINT);
+            node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, V, VALUE_TYPE_BIGINT);
+            node->aggregate(EXPRESSION_TYPE_AGGREGATE_AVG, D, VALUE_TYPE_DOUBLE);
+            node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, T, VALUE_TYPE_TINYINT);
+            bool usedTyped;
+            results[typed] = aggregate(node, input, typed == 1, &usedTyped, &seconds[typed]);
+            ASSERT_EQ(typed == 1, usedTyped);
+        }
+        delete input;
+        ASSERT_EQ(expectedGroups, results[1].size());
+        ASSERT_TRUE(results[0] == results[1]);
+        VOLT_INFO("%d rows into %d groups: typed %.6f s, generic %.6f s",
+                  rows, (int)expectedGroups, seconds[1], seconds[0]);
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,266 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "harness.h"
+#include "executors/executor_test_util.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/SQLException.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/hashjoinexecutor.h"
+#include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/hashjoinnode.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+// (ID, NULL-padded inner W) pairs of a join result
+typedef multiset<pair<int64_t, int64_t> > JoinResult;
+static const int64_t NULL_W = -1;
+
+class HashJoinTest : public Test {
+public:
+    HashJoinTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+    }
+
+    ~HashJoinTest() {
+        delete m_engine;
+    }
+
+    /**
+     * Outer table O(ID BIGINT, K INTEGER) with the given join keys, where
+     * a negative key stands for NULL
+     */
+    Table* outerTable(const vector<int> &keys) {
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_BIGINT);
+        types.push_back(VALUE_TYPE_INTEGER);
+        string names[2] = { "ID", "K" };
+        Table *table = createTable("O", types, names);
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < keys.size(); i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+            tuple.setNValue(1, keys[i] < 0 ? NValue::getNullValue(VALUE_TYPE_INTEGER) : ValueFactory::getIntegerValue(keys[i]));
+            table->insertTuple(tuple);
+        }
+        return table;
+    }
+
+    /**
+     * Inner table I(K BIGINT, W BIGINT). W is the position of the row.
+     */
+    Table* innerTable(const vector<int> &keys) {
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_BIGINT);
+        types.push_back(VALUE_TYPE_BIGINT);
+        string names[2] = { "K", "W" };
+        Table *table = createTable("I", types, names);
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < keys.size(); i++) {
+            tuple.setNValue(0, keys[i] < 0 ? NValue::getNullValue(VALUE_TYPE_BIGINT) : ValueFactory::getBigIntValue(keys[i]));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(i));
+            table->insertTuple(tuple);
+        }
+        return table;
+    }
+
+    Table* createTable(const string &name, const vector<ValueType> &types, string *names) {
+        vector<int32_t> lengths;
+        for (int i = 0; i < types.size(); i++) {
+            lengths.push_back(NValue::getTupleStorageSize(types[i]));
+        }
+        vector<bool> allowNull(types.size(), true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        return TableFactory::getTempTable(0, name, schema, names, &m_memory);
+    }
+
+    /**
+     * Join O and I on O.K = I.K and, if maxDistance is not negative, on
+     * (I.W - O.ID) / ?0 <= maxDistance with ?0 = 1. If failFirst is set,
+     * the join is first executed with ?0 = 0, which throws while probing.
+     */
+    JoinResult hashJoin(const vector<int> &outerKeys, const vector<int> &innerKeys,
+                        JoinType joinType, int maxDistance, bool failFirst = false) {
+        InputPlanNode outer(outerTable(outerKeys));
+        InputPlanNode inner(innerTable(innerKeys));
+        HashJoinPlanNode *node = new HashJoinPlanNode(AbstractPlanNode::getNextPlanNodeId());
+        node->addChild(&outer);
+        node->addChild(&inner);
+        node->setJoinType(joinType);
+        vector<AbstractExpression*> keys(1, new TupleValueExpression(1, "O", "K"));
+        node->setOuterKeyExpressions(keys);
+        keys[0] = new TupleValueExpression(0, "I", "K");
+        node->setInnerKeyExpressions(keys);
+        if (maxDistance >= 0) {
+            AbstractExpression *distance =
+                operatorFactory(EXPRESSION_TYPE_OPERATOR_DIVIDE,
+                                operatorFactory(EXPRESSION_TYPE_OPERATOR_MINUS,
+                                                new TupleValueExpression(1, "I", "W"),
+                                                new TupleValueExpression(0, "O", "ID")),
+                                parameterValueFactory(0));
+            node->setPredicate(comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO, distance,
+                                                 constantValueFactory(ValueFactory::getBigIntValue(maxDistance))));
+        }
+
+        HashJoinExecutor *executor = new HashJoinExecutor(m_engine, node);
+        node->setExecutor(executor);
+        JoinResult result;
+        NValueArray params(1);
+        bool initialized = executor->init(m_engine, NULL, &m_memory);
+        if (initialized && failFirst) {
+            params[0] = ValueFactory::getBigIntValue(0);
+            bool thrown = false;
+            try {
+                executor->execute(params, NULL);
+            } catch (SQLException &ex) {
+                thrown = true;
+            }
+            EXPECT_TRUE(thrown);
+        }
+        params[0] = ValueFactory::getBigIntValue(1);
+        if (initialized && executor->execute(params, NULL)) {
+            // run it twice to check that nothing is left over from the first
+            // time, unless that was the one that failed
+            if (!failFirst) {
+                executor->execute(params, NULL);
+            }
+
+            TableIterator iter(node->getOutputTable());
+            TableTuple tuple(node->getOutputTable()->schema());
+            while (iter.next(tuple)) {
+                NValue w = tuple.getNValue(3);
+                result.insert(make_pair(ValuePeeker::peekBigInt(tuple.getNValue(0)),
+                                        w.isNull() ? NULL_W : ValuePeeker::peekBigInt(w)));
+            }
+        }
+        delete node;
+        return result;
+    }
+
+    /** What a nested loop would produce */
+    static JoinResult nestLoopJoin(const vector<int> &outerKeys, const vector<int> &innerKeys,
+                                   JoinType joinType, int maxDistance) {
+        JoinResult result;
+        for (int o = 0; o < outerKeys.size(); o++) {
+            bool match = false;
+            for (int i = 0; i < innerKeys.size(); i++) {
+                if (outerKeys[o] >= 0 && outerKeys[o] == innerKeys[i] &&
+                    (maxDistance < 0 || i - o <= maxDistance)) {
+                    result.insert(make_pair<int64_t, int64_t>(o, i));
+                    match = true;
+                }
+            }
+            if (!match && joinType == JOIN_TYPE_LEFT) {
+                result.insert(make_pair<int64_t, int64_t>(o, NULL_W));
+            }
+        }
+        return result;
+    }
+
+    /** Random keys in [0, range) with about one in ten NULL */
+    static vector<int> randomKeys(int count, int range) {
+        vector<int> keys;
+        for (int i = 0; i < count; i++) {
+            keys.push_back(rand() % 10 == 0 ? -1 : rand() % range);
+        }
+        return keys;
+    }
+
+    void checkJoin(const vector<int> &outerKeys, const vector<int> &innerKeys,
+                   JoinType joinType, int maxDistance, bool failFirst = false) {
+        JoinResult expected = nestLoopJoin(outerKeys, innerKeys, joinType, maxDistance);
+        JoinResult actual = hashJoin(outerKeys, innerKeys, joinType, maxDistance, failFirst);
+        ASSERT_TRUE(expected.size() > 0);
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(expected == actual);
+    }
+
+    VoltDBEngine *m_engine;
+    int m_memory;
+};
+
+/**
+ * Inner joins with duplicate and NULL keys, building on either side
+ */
+TEST_F(HashJoinTest, InnerJoin) {
+    // the inner table is smaller and gets built on
+    checkJoin(randomKeys(500, 50), randomKeys(200, 50), JOIN_TYPE_INNER, -1);
+    // the outer table is smaller and gets built on
+    checkJoin(randomKeys(200, 50), randomKeys(500, 50), JOIN_TYPE_INNER, -1);
+}
+
+/**
+ * Outer tuples without a match are padded with NULLs, whichever side the
+ * hash table is built on
+ */
+TEST_F(HashJoinTest, LeftJoin) {
+    checkJoin(randomKeys(500, 100), randomKeys(200, 100), JOIN_TYPE_LEFT, -1);
+    checkJoin(randomKeys(200, 100), randomKeys(500, 100), JOIN_TYPE_LEFT, -1);
+
+    // nothing matches
+    checkJoin(randomKeys(10, 1), vector<int>(20, 2), JOIN_TYPE_LEFT, -1);
+    checkJoin(vector<int>(10, 1), vector<int>(), JOIN_TYPE_LEFT, -1);
+}
+
+/**
+ * The join predicate filters pairs with equal keys. A left join keeps the
+ * outer tuples whose matches were all filtered out.
+ */
+TEST_F(HashJoinTest, Predicate) {
+    checkJoin(randomKeys(300, 20), randomKeys(300, 20), JOIN_TYPE_INNER, 10);
+    checkJoin(randomKeys(100, 20), randomKeys(300, 20), JOIN_TYPE_LEFT, 10);
+    checkJoin(randomKeys(300, 20), randomKeys(100, 20), JOIN_TYPE_LEFT, 10);
+}
+
+/**
+ * An execution that throws while probing leaves nothing behind for the
+ * next one
+ */
+TEST_F(HashJoinTest, FailedExecution) {
+    checkJoin(randomKeys(300, 20), randomKeys(100, 20), JOIN_TYPE_INNER, 10, true);
+    checkJoin(randomKeys(100, 20), randomKeys(300, 20), JOIN_TYPE_LEFT, 10, true);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,384 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "harness.h"
+#include "executors/executor_test_util.h"
+#include "common/debuglog.h"
+#include "common/executorcontext.hpp"
+#include "common/DummyUndoQuantum.hpp"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/nestloopindexexecutor.h"
+#include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
+#include "indexes/tableindex.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/indexscannode.h"
+#include "plannodes/nestloopindexnode.h"
+#include "storage/persistenttable.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+// Outer rows in the Benchmark test
+#define BENCHMARK_ROWS 10000
+
+/**
+ * A join node with the output column guids that the planner would have
+ * handed over in its JSON
+ */
+class JoinPlanNode : public NestLoopIndexPlanNode {
+public:
+    JoinPlanNode(int columns) : NestLoopIndexPlanNode(AbstractPlanNode::getNextPlanNodeId()) {
+        for (int i = 0; i < columns; i++) {
+            AbstractPlanNode::m_outputColumnGuids.push_back(i);
+        }
+    }
+};
+
+// (ID, NULL-padded inner W) pairs of a join result
+typedef multiset<pair<int64_t, int64_t> > JoinResult;
+static const int64_t NULL_W = -1;
+
+class NestLoopIndexTest : public Test {
+public:
+    NestLoopIndexTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+        m_undo = new DummyUndoQuantum();
+        m_context = new ExecutorContext(0, 0, m_undo, NULL, false, 0, "", 0);
+    }
+
+    ~NestLoopIndexTest() {
+        delete m_context;
+        delete m_undo;
+        delete m_engine;
+    }
+
+    static TupleSchema* schema(ValueType first, ValueType second) {
+        vector<ValueType> types;
+        types.push_back(first);
+        types.push_back(second);
+        vector<int32_t> lengths;
+        for (int i = 0; i < types.size(); i++) {
+            lengths.push_back(NValue::getTupleStorageSize(types[i]));
+        }
+        vector<bool> allowNull(types.size(), true);
+        return TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+    }
+
+    /**
+     * Outer table O(ID BIGINT, K INTEGER) with the given join keys, where
+     * a negative key stands for NULL
+     */
+    Table* outerTable(const vector<int> &keys) {
+        string names[2] = { "ID", "K" };
+        Table *table = TableFactory::getTempTable(0, "O", schema(VALUE_TYPE_BIGINT, VALUE_TYPE_INTEGER),
+                                                  names, &m_memory);
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < keys.size(); i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+            tuple.setNValue(1, keys[i] < 0 ? NValue::getNullValue(VALUE_TYPE_INTEGER) : ValueFactory::getIntegerValue(keys[i]));
+            table->insertTuple(tuple);
+        }
+        return table;
+    }
+
+    /**
+     * Inner table I(K BIGINT, W BIGINT) with index IDX on K. W is the
+     * position of the row and the primary key. A unique index needs
+     * unique keys.
+     */
+    PersistentTable* innerTable(const vector<int> &keys, TableIndexType type, bool unique, bool intsOnly) {
+        string names[2] = { "K", "W" };
+        TupleSchema *tupleSchema = schema(VALUE_TYPE_BIGINT, VALUE_TYPE_BIGINT);
+        vector<TableIndexScheme> indexes;
+        indexes.push_back(TableIndexScheme("IDX", type, vector<int32_t>(1, 0),
+                                           vector<ValueType>(1, VALUE_TYPE_BIGINT),
+                                           unique, intsOnly, tupleSchema));
+        TableIndexScheme pkey("PK", BALANCED_TREE_INDEX, vector<int32_t>(1, 1),
+                              vector<ValueType>(1, VALUE_TYPE_BIGINT), true, true, tupleSchema);
+        Table *table = TableFactory::getPersistentTable(0, m_context, "I", tupleSchema, names,
+                                                        pkey, indexes, 0, false, false);
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < keys.size(); i++) {
+            tuple.setNValue(0, keys[i] < 0 ? NValue::getNullValue(VALUE_TYPE_BIGINT) : ValueFactory::getBigIntValue(keys[i]));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(i));
+            table->insertTuple(tuple);
+        }
+        return dynamic_cast<PersistentTable*>(table);
+    }
+
+    /**
+     * Join O and I through IDX with the given lookup on O.K. GTE lookups
+     * stop at I.K > O.K + range.
+     */
+    JoinResult indexJoin(const vector<int> &outerKeys, PersistentTable *inner,
+                         IndexLookupType lookupType, int range, JoinType joinType,
+                         int batchSize, bool sortProbes, double *seconds = NULL,
+                         int64_t *rangeProbesReused = NULL) {
+        m_memory = 0;
+        InputPlanNode outer(outerTable(outerKeys));
+        JoinPlanNode *node = new JoinPlanNode(4);
+        node->addChild(&outer);
+        node->setJoinType(joinType);
+
+        IndexScanPlanNode *scan = new IndexScanPlanNode(AbstractPlanNode::getNextPlanNodeId());
+        scan->setTargetTable(inner);
+        scan->setTargetTableName("I");
+        scan->setTargetIndexName("IDX");
+        scan->setLookupType(lookupType);
+        vector<AbstractExpression*> keys(1, new TupleValueExpression(1, "O", "K"));
+        scan->setSearchKeyExpressions(keys);
+        if (lookupType != INDEX_LOOKUP_TYPE_EQ) {
+            AbstractExpression *limit =
+                operatorFactory(EXPRESSION_TYPE_OPERATOR_PLUS,
+                                new TupleValueExpression(1, "O", "K"),
+                                constantValueFactory(ValueFactory::getBigIntValue(range)));
+            scan->setEndExpression(comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                                     new TupleValueExpression(2, "I", "K"), limit));
+        }
+        node->addInlinePlanNode(scan);
+
+        NestLoopIndexExecutor *executor = new NestLoopIndexExecutor(m_engine, node);
+        node->setExecutor(executor);
+        executor->setBatchSize(batchSize);
+        executor->setSortProbes(sortProbes);
+        JoinResult result;
+        if (executor->init(m_engine, NULL, &m_memory)) {
+            struct timeval start;
+            gettimeofday(&start, NULL);
+            bool success = executor->execute(NValueArray(), NULL);
+            if (seconds != NULL) {
+                *seconds = elapsed(start);
+            }
+            if (rangeProbesReused != NULL) {
+                *rangeProbesReused = executor->getRangeProbesReused();
+            }
+            if (success) {
+                TableIterator iter(node->getOutputTable());
+                TableTuple tuple(node->getOutputTable()->schema());
+                while (iter.next(tuple)) {
+                    NValue w = tuple.getNValue(3);
+                    result.insert(make_pair(ValuePeeker::peekBigInt(tuple.getNValue(0)),
+                                            w.isNull() ? NULL_W : ValuePeeker::peekBigInt(w)));
+                }
+            }
+        }
+        delete node;
+        return result;
+    }
+
+    /** What a nested loop over all pairs would produce */
+    static JoinResult nestLoopJoin(const vector<int> &outerKeys, const vector<int> &innerKeys,
+                                   IndexLookupType lookupType, int range, JoinType joinType) {
+        JoinResult result;
+        for (int o = 0; o < outerKeys.size(); o++) {
+            bool match = false;
+            for (int i = 0; i < innerKeys.size(); i++) {
+                if (outerKeys[o] < 0 || innerKeys[i] < 0) continue;
+                const bool found = (lookupType == INDEX_LOOKUP_TYPE_EQ ? innerKeys[i] == outerKeys[o] :
+                                    lookupType == INDEX_LOOKUP_TYPE_GT ? innerKeys[i] > outerKeys[o] :
+                                    innerKeys[i] >= outerKeys[o]);
+                if (found && (lookupType == INDEX_LOOKUP_TYPE_EQ || innerKeys[i] <= outerKeys[o] + range)) {
+                    result.insert(make_pair<int64_t, int64_t>(o, i));
+                    match = true;
+                }
+            }
+            if (!match && joinType == JOIN_TYPE_LEFT) {
+                result.insert(make_pair<int64_t, int64_t>(o, NULL_W));
+            }
+        }
+        return result;
+    }
+
+    /** Random keys in [0, range), with about one in ten NULL if asked */
+    static vector<int> randomKeys(int count, int range, bool nulls) {
+        vector<int> keys;
+        for (int i = 0; i < count; i++) {
+            keys.push_back(nulls && rand() % 10 == 0 ? -1 : rand() % range);
+        }
+        return keys;
+    }
+
+    /** 0 .. count-1 in random order */
+    static vector<int> uniqueKeys(int count) {
+        vector<int> keys;
+        for (int i = 0; i < count; i++) {
+            keys.push_back(i);
+        }
+        for (int i = count; i > 1; i--) {
+            swap(keys[i - 1], keys[rand() % i]);
+        }
+        return keys;
+    }
+
+    /**
+     * The batched join, with and without sorted probes, and the one that
+     * probes for every outer tuple on its own all give what the nested
+     * loop gives
+     */
+    void checkJoin(const vector<int> &outerKeys, const vector<int> &innerKeys,
+                   TableIndexType type, bool unique, bool intsOnly,
+                   IndexLookupType lookupType, int range, JoinType joinType) {
+        PersistentTable *inner = innerTable(innerKeys, type, unique, intsOnly);
+        JoinResult expected = nestLoopJoin(outerKeys, innerKeys, lookupType, range, joinType);
+        ASSERT_TRUE(expected.size() > 0);
+        const int batchSizes[] = { 1, 7, NESTLOOPINDEX_BATCH_SIZE };
+        for (int b = 0; b < 6; b++) {
+            JoinResult actual = indexJoin(outerKeys, inner, lookupType, range, joinType,
+                                          batchSizes[b / 2], (b % 2 == 1));
+            ASSERT_EQ(expected.size(), actual.size());
+            ASSERT_TRUE(expected == actual);
+        }
+        delete inner;
+    }
+
+    VoltDBEngine *m_engine;
+    DummyUndoQuantum *m_undo;
+    ExecutorContext *m_context;
+    int m_memory;
+};
+
+/**
+ * EQ probes into every kind of index, with duplicate outer keys that are
+ * answered from the previous probe
+ */
+TEST_F(NestLoopIndexTest, EqualityLookup) {
+    const vector<int> outerKeys = randomKeys(1000, 300, true);
+    const vector<int> innerKeys = uniqueKeys(200);
+    checkJoin(outerKeys, innerKeys, BALANCED_TREE_INDEX, true, true, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, innerKeys, BALANCED_TREE_INDEX, true, false, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, innerKeys, HASH_TABLE_INDEX, true, true, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, innerKeys, HASH_TABLE_INDEX, true, false, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_LEFT);
+
+    // 1:N
+    const vector<int> duplicateKeys = randomKeys(600, 100, false);
+    checkJoin(outerKeys, duplicateKeys, BALANCED_TREE_INDEX, false, true, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, duplicateKeys, BALANCED_TREE_INDEX, false, false, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_LEFT);
+    checkJoin(outerKeys, duplicateKeys, HASH_TABLE_INDEX, false, true, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_LEFT);
+    checkJoin(outerKeys, duplicateKeys, RADIX_TREE_INDEX, false, false, INDEX_LOOKUP_TYPE_EQ, 0, JOIN_TYPE_INNER);
+}
+
+/**
+ * Range probes that stop at the end expression
+ */
+TEST_F(NestLoopIndexTest, RangeLookup) {
+    const vector<int> outerKeys = randomKeys(500, 300, true);
+    const vector<int> innerKeys = randomKeys(600, 300, false);
+    checkJoin(outerKeys, innerKeys, BALANCED_TREE_INDEX, false, true, INDEX_LOOKUP_TYPE_GTE, 3, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, innerKeys, BALANCED_TREE_INDEX, false, true, INDEX_LOOKUP_TYPE_GT, 3, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, innerKeys, BALANCED_TREE_INDEX, false, false, INDEX_LOOKUP_TYPE_GTE, 5, JOIN_TYPE_INNER);
+    checkJoin(outerKeys, innerKeys, RADIX_TREE_INDEX, false, false, INDEX_LOOKUP_TYPE_GT, 2, JOIN_TYPE_INNER);
+
+    // probes in key order carry on from the one before
+    PersistentTable *inner = innerTable(innerKeys, BALANCED_TREE_INDEX, false, true);
+    int64_t reused = 0;
+    indexJoin(outerKeys, inner, INDEX_LOOKUP_TYPE_GTE, 3, JOIN_TYPE_INNER,
+              NESTLOOPINDEX_BATCH_SIZE, true, NULL, &reused);
+    ASSERT_TRUE(reused > 0);
+    indexJoin(outerKeys, inner, INDEX_LOOKUP_TYPE_GTE, 3, JOIN_TYPE_INNER, 1, false, NULL, &reused);
+    ASSERT_EQ(0, reused);
+    delete inner;
+}
+
+/**
+ * 1:N joins against a non-unique tree index and a unique hash index
+ * (N = 1), and a range join whose ranges overlap, probing one outer tuple
+ * at a time, in batches and in sorted batches. All three give the same
+ * result.
+ */
+TEST_F(NestLoopIndexTest, Benchmark) {
+    const char *names[3] = { "tree 1:2", "hash 1:1", "tree range" };
+    vector<int> randomOuterKeys;
+    for (int i = 0; i < BENCHMARK_ROWS; i++) {
+        randomOuterKeys.push_back(rand() % BENCHMARK_ROWS);
+    }
+    // the range join gets its outer rows in key order, as from a scan of
+    // another index
+    vector<int> sortedOuterKeys(randomOuterKeys);
+    sort(sortedOuterKeys.begin(), sortedOuterKeys.end());
+    for (int kind = 0; kind < 3; kind++) {
+        const vector<int> &outerKeys = (kind == 2 ? sortedOuterKeys : randomOuterKeys);
+        vector<int> innerKeys;
+        if (kind == 0) {
+            for (int i = 0; i < BENCHMARK_ROWS * 2; i++) {
+                innerKeys.push_back(i % BENCHMARK_ROWS);
+            }
+        } else {
+            innerKeys = uniqueKeys(BENCHMARK_ROWS);
+        }
+        PersistentTable *inner = innerTable(innerKeys, kind == 1 ? HASH_TABLE_INDEX : BALANCED_TREE_INDEX,
+                                            kind == 1, true);
+        const IndexLookupType lookupType = (kind == 2 ? INDEX_LOOKUP_TYPE_GTE : INDEX_LOOKUP_TYPE_EQ);
+        const int range = (kind == 2 ? 4 : 0);
+
+        // one at a time, batched, and batched in key order
+        double seconds[3];
+        JoinResult results[3];
+        int64_t reused = 0;
+        for (int mode = 0; mode < 3; mode++) {
+            results[mode] = indexJoin(outerKeys, inner, lookupType, range, JOIN_TYPE_INNER,
+                                      (mode == 0 ? 1 : NESTLOOPINDEX_BATCH_SIZE), (mode == 2),
+                                      &seconds[mode], &reused);
+        }
+        size_t expected = 0;
+        for (int i = 0; i < BENCHMARK_ROWS; i++) {
+            expected += (kind == 0 ? 2 : kind == 1 ? 1 :
+                         min(outerKeys[i] + range, BENCHMARK_ROWS - 1) - outerKeys[i] + 1);
+        }
+        ASSERT_EQ(expected, results[0].size());
+        ASSERT_TRUE(results[0] == results[1]);
+        ASSERT_TRUE(results[0] == results[2]);
+        if (kind == 2) {
+            ASSERT_TRUE(reused > 0);
+        }
+        VOLT_INFO("%d outer rows, %s: single %.3f s, batched %.3f s, sorted %.3f s",
+                  BENCHMARK_ROWS, names[kind], seconds[0], seconds[1], seconds[2]);
+        delete inner;
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,294 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "executors/executor_test_util.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/orderbyexecutor.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/limitnode.h"
+#include "plannodes/orderbynode.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+// columns of the input table
+enum { ID, SCORE, NAME, RATING };
+
+/** A row of the input table. NULLs are flagged. */
+struct Row {
+    int64_t id;
+    bool scoreNull;
+    int32_t score;
+    bool nameNull;
+    string name;
+    double rating;
+};
+
+/** Sort order of a reference sort, over rows */
+class RowComparer {
+public:
+    RowComparer(const vector<int> &columns, const vector<SortDirectionType> &dirs) :
+        m_columns(columns), m_dirs(dirs) {}
+
+    bool operator()(const Row &a, const Row &b) const {
+        for (size_t i = 0; i < m_columns.size(); i++) {
+            int cmp = compare(a, b, m_columns[i]);
+            if (cmp != 0) {
+                return (m_dirs[i] == SORT_DIRECTION_TYPE_ASC ? cmp < 0 : cmp > 0);
+            }
+        }
+        return false;
+    }
+
+private:
+    static int compare(const Row &a, const Row &b, int column) {
+        switch (column) {
+        case ID:
+            return (a.id < b.id ? -1 : (a.id > b.id ? 1 : 0));
+        case SCORE:
+            if (a.scoreNull || b.scoreNull) return (int)b.scoreNull - (int)a.scoreNull;
+            return (a.score < b.score ? -1 : (a.score > b.score ? 1 : 0));
+        case NAME:
+            if (a.nameNull || b.nameNull) return (int)b.nameNull - (int)a.nameNull;
+            return a.name.compare(b.name);
+        default:
+            return (a.rating < b.rating ? -1 : (a.rating > b.rating ? 1 : 0));
+        }
+    }
+
+    vector<int> m_columns;
+    vector<SortDirectionType> m_dirs;
+};
+
+class OrderByTest : public Test {
+public:
+    OrderByTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+    }
+
+    ~OrderByTest() {
+        delete m_engine;
+        for (size_t i = 0; i < m_strings.size(); i++) {
+            m_strings[i].free();
+        }
+    }
+
+    /**
+     * Random rows with duplicate scores, names and ratings. The names are
+     * longer than a sort key prefix and about one score and one name in
+     * ten is NULL.
+     */
+    static vector<Row> randomRows(int count) {
+        vector<Row> rows;
+        for (int i = 0; i < count; i++) {
+            Row row;
+            row.id = i;
+            row.scoreNull = (rand() % 10 == 0);
+            row.score = (rand() % 200) - 100;
+            row.nameNull = (rand() % 10 == 0);
+            char name[64];
+            snprintf(name, sizeof(name), "a rather long player name %03d", rand() % 300);
+            row.name = (rand() % 20 == 0 ? string(name, 3) : string(name));
+            row.rating = (rand() % 1000 - 500) / 8.0;
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    /** T(ID BIGINT, SCORE INTEGER, NAME VARCHAR(64), RATING FLOAT) */
+    Table* inputTable(const vector<Row> &rows) {
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        types.push_back(VALUE_TYPE_BIGINT); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        types.push_back(VALUE_TYPE_INTEGER); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        types.push_back(VALUE_TYPE_VARCHAR); lengths.push_back(64);
+        types.push_back(VALUE_TYPE_DOUBLE); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+        vector<bool> allowNull(4, true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        string names[4] = { "ID", "SCORE", "NAME", "RATING" };
+        Table *table = TableFactory::getTempTable(0, "T", schema, names, &m_memory);
+
+        TableTuple &tuple = table->tempTuple();
+        for (size_t i = 0; i < rows.size(); i++) {
+            tuple.setNValue(ID, ValueFactory::getBigIntValue(rows[i].id));
+            tuple.setNValue(SCORE, rows[i].scoreNull ? NValue::getNullValue(VALUE_TYPE_INTEGER) :
+                                                      ValueFactory::getIntegerValue(rows[i].score));
+            if (rows[i].nameNull) {
+                tuple.setNValue(NAME, NValue::getNullValue(VALUE_TYPE_VARCHAR));
+            } else {
+                // the temp table keeps pointing to the string
+                m_strings.push_back(ValueFactory::getStringValue(rows[i].name));
+                tuple.setNValue(NAME, m_strings.back());
+            }
+            tuple.setNValue(RATING, ValueFactory::getDoubleValue(rows[i].rating));
+            table->insertTuple(tuple);
+        }
+        return table;
+    }
+
+    /**
+     * Ids of the rows in the order the executor puts them. A negative
+     * limit means no inline LIMIT node.
+     */
+    vector<int64_t> orderBy(const vector<Row> &rows, const vector<int> &columns,
+                            const vector<SortDirectionType> &dirs, int limit, int offset) {
+        InputPlanNode input(inputTable(rows));
+        OrderByPlanNode *node = new OrderByPlanNode(AbstractPlanNode::getNextPlanNodeId());
+        node->addChild(&input);
+        vector<string> names;
+        for (size_t i = 0; i < columns.size(); i++) {
+            names.push_back(input.getOutputTable()->columnName(columns[i]));
+            node->getSortColumnGuids().push_back(columns[i]);
+        }
+        node->setSortColumnNames(names);
+        vector<SortDirectionType> directions(dirs);
+        node->setSortDirections(directions);
+        if (limit >= 0) {
+            LimitPlanNode *limitNode = new LimitPlanNode(AbstractPlanNode::getNextPlanNodeId());
+            limitNode->setLimit(limit);
+            limitNode->setOffset(offset);
+            node->addInlinePlanNode(limitNode);
+        }
+
+        OrderByExecutor *executor = new OrderByExecutor(m_engine, node);
+        node->setExecutor(executor);
+        vector<int64_t> ids;
+        if (executor->init(m_engine, NULL, &m_memory) &&
+            executor->execute(NValueArray(), NULL)) {
+            TableIterator iter(node->getOutputTable());
+            TableTuple tuple(node->getOutputTable()->schema());
+            while (iter.next(tuple)) {
+                ids.push_back(ValuePeeker::peekBigInt(tuple.getNValue(ID)));
+            }
+        }
+        delete node;
+        return ids;
+    }
+
+    /** What a full sort of the rows gives */
+    static vector<int64_t> reference(vector<Row> rows, const vector<int> &columns,
+                                     const vector<SortDirectionType> &dirs, int limit, int offset) {
+        sort(rows.begin(), rows.end(), RowComparer(columns, dirs));
+        vector<int64_t> ids;
+        for (size_t i = offset; i < rows.size() && (limit < 0 || ids.size() < (size_t)limit); i++) {
+            ids.push_back(rows[i].id);
+        }
+        return ids;
+    }
+
+    /**
+     * Sort on the given columns, then on the id so that the order is total
+     */
+    void checkOrderBy(const vector<Row> &rows, const vector<int> &columns,
+                      const vector<SortDirectionType> &dirs, int limit, int offset) {
+        vector<int> allColumns(columns);
+        vector<SortDirectionType> allDirs(dirs);
+        allColumns.push_back(ID);
+        allDirs.push_back(SORT_DIRECTION_TYPE_ASC);
+        vector<int64_t> expected = reference(rows, allColumns, allDirs, limit, offset);
+        vector<int64_t> actual = orderBy(rows, allColumns, allDirs, limit, offset);
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(expected == actual);
+    }
+
+    VoltDBEngine *m_engine;
+    int m_memory;
+    vector<NValue> m_strings;
+};
+
+/**
+ * Full sorts on each column type, ascending and descending
+ */
+TEST_F(OrderByTest, FullSort) {
+    vector<Row> rows = randomRows(2000);
+    const int columns[3] = { SCORE, NAME, RATING };
+    for (int i = 0; i < 3; i++) {
+        checkOrderBy(rows, vector<int>(1, columns[i]), vector<SortDirectionType>(1, SORT_DIRECTION_TYPE_ASC), -1, 0);
+        checkOrderBy(rows, vector<int>(1, columns[i]), vector<SortDirectionType>(1, SORT_DIRECTION_TYPE_DESC), -1, 0);
+    }
+}
+
+/**
+ * Several sort columns in mixed directions, with keys that do not fit
+ * in the sort key prefix
+ */
+TEST_F(OrderByTest, MultipleColumns) {
+    vector<Row> rows = randomRows(2000);
+    vector<int> columns;
+    vector<SortDirectionType> dirs;
+    columns.push_back(SCORE); dirs.push_back(SORT_DIRECTION_TYPE_DESC);
+    columns.push_back(NAME); dirs.push_back(SORT_DIRECTION_TYPE_ASC);
+    checkOrderBy(rows, columns, dirs, -1, 0);
+
+    columns.clear(); dirs.clear();
+    columns.push_back(NAME); dirs.push_back(SORT_DIRECTION_TYPE_DESC);
+    columns.push_back(RATING); dirs.push_back(SORT_DIRECTION_TYPE_ASC);
+    columns.push_back(SCORE); dirs.push_back(SORT_DIRECTION_TYPE_DESC);
+    checkOrderBy(rows, columns, dirs, -1, 0);
+}
+
+/**
+ * ORDER BY with LIMIT and OFFSET keeps only the top rows
+ */
+TEST_F(OrderByTest, LimitOffset) {
+    vector<Row> rows = randomRows(5000);
+    vector<int> columns;
+    vector<SortDirectionType> dirs;
+    columns.push_back(SCORE); dirs.push_back(SORT_DIRECTION_TYPE_DESC);
+    columns.push_back(RATING); dirs.push_back(SORT_DIRECTION_TYPE_ASC);
+
+    checkOrderBy(rows, columns, dirs, 20, 0);
+    checkOrderBy(rows, columns, dirs, 20, 100);
+    checkOrderBy(rows, columns, dirs, 1, 0);
+    checkOrderBy(rows, vector<int>(1, NAME), vector<SortDirectionType>(1, SORT_DIRECTION_TYPE_ASC), 50, 10);
+    // no rows wanted
+    checkOrderBy(rows, columns, dirs, 0, 0);
+    // more rows wanted than there are
+    checkOrderBy(rows, columns, dirs, 4990, 5);
+    checkOrderBy(rows, columns, dirs, 10000, 0);
+    checkOrderBy(rows, columns, dirs, 10, 6000);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,353 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "harness.h"
+#include "common/debuglog.h"
+#include "executors/executor_test_util.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/SQLException.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/executors.h"
+#include "executors/compiledpredicate.h"
+#include "executors/parallelaggregation.h"
+#include "executors/typedhashaggregator.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/aggregatenode.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+/** Threads used whenever a test turns the parallel scans on */
+#define TEST_THREADS 4
+
+// columns of the input table
+enum { G, V, D };
+
+typedef AggregateExecutor<PLAN_NODE_TYPE_HASHAGGREGATE> HashAggregateExecutor;
+typedef multiset<string> AggregateResult;
+
+class ParallelAggregateTest : public Test {
+public:
+    ParallelAggregateTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+    }
+
+    ~ParallelAggregateTest() {
+        delete m_engine;
+    }
+
+    /**
+     * T(G INTEGER, V BIGINT, D FLOAT) with G in [0, groups) and about one
+     * value in twenty NULL. The doubles are multiples of 1/16, so their
+     * sums are exact whatever order they are added in.
+     */
+    Table* inputTable(int rows, int groups) {
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_INTEGER);
+        types.push_back(VALUE_TYPE_BIGINT);
+        types.push_back(VALUE_TYPE_DOUBLE);
+        vector<int32_t> lengths;
+        for (int i = 0; i < types.size(); i++) {
+            lengths.push_back(NValue::getTupleStorageSize(types[i]));
+        }
+        vector<bool> allowNull(types.size(), true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        string names[3] = { "G", "V", "D" };
+        Table *table = TableFactory::getTempTable(0, "T", schema, names, &m_memory);
+
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < rows; i++) {
+            tuple.setNValue(G, isNull() ? NValue::getNullValue(VALUE_TYPE_INTEGER) :
+                                          ValueFactory::getIntegerValue(rand() % groups));
+            tuple.setNValue(V, isNull() ? NValue::getNullValue(VALUE_TYPE_BIGINT) :
+                                          ValueFactory::getBigIntValue((int64_t)rand() * 1000 - 500000));
+            tuple.setNValue(D, isNull() ? NValue::getNullValue(VALUE_TYPE_DOUBLE) :
+                                          ValueFactory::getDoubleValue((rand() % 100000) / 16.0 - 1000));
+            table->insertTuple(tuple);
+        }
+        return table;
+    }
+
+    /**
+     * Run the node over the input with the given number of threads and
+     * return its rows
+     */
+    AggregateResult aggregate(TestAggregatePlanNode *node, Table *input, int threads,
+                              double *seconds = NULL) {
+        m_engine->setParallelScans(threads, 0);
+        InputPlanNode child(input);
+        node->addChild(&child);
+        HashAggregateExecutor *executor = new HashAggregateExecutor(m_engine, node);
+        node->setExecutor(executor);
+        AggregateResult result;
+        try {
+            if (executor->init(m_engine, NULL, &m_memory)) {
+                EXPECT_TRUE(executor->usesTypedAggregation());
+                struct timeval start;
+                gettimeofday(&start, NULL);
+                const bool executed = executor->execute(NValueArray(), NULL);
+                if (seconds != NULL) {
+                    *seconds = elapsed(start);
+                }
+                if (executed) {
+                    result = rows(node->getOutputTable());
+                }
+            }
+        } catch (...) {
+            child.setOutputTable(NULL);
+            delete node;
+            throw;
+        }
+        // the caller keeps the input
+        child.setOutputTable(NULL);
+        delete node;
+        return result;
+    }
+
+    /**
+     * Check that the node gives the same rows with and without the
+     * parallel scans
+     */
+    void checkParallel(TestAggregatePlanNode *parallelNode, TestAggregatePlanNode *serialNode,
+                       Table *input, size_t expectedGroups) {
+        double seconds[2];
+        AggregateResult parallel = aggregate(parallelNode, input, TEST_THREADS, &seconds[0]);
+        AggregateResult serial = aggregate(serialNode, input, 1, &seconds[1]);
+        VOLT_INFO("%ld rows into %d groups: %d threads %.6f s, 1 thread %.6f s",
+                  (long)input->activeTupleCount(), (int)serial.size(), TEST_THREADS, seconds[0], seconds[1]);
+        delete input;
+        ASSERT_EQ(expectedGroups, parallel.size());
+        ASSERT_EQ(serial.size(), parallel.size());
+        ASSERT_TRUE(serial == parallel);
+    }
+
+    static AggregateResult rows(Table *table) {
+        AggregateResult result;
+        TableIterator iter(table);
+        TableTuple tuple(table->schema());
+        while (iter.next(tuple)) {
+            result.insert(tuple.debugNoHeader());
+        }
+        return result;
+    }
+
+    static size_t countGroups(Table *input) {
+        set<string> groups;
+        TableIterator iter(input);
+        TableTuple tuple(input->schema());
+        while (iter.next(tuple)) {
+            groups.insert(tuple.getNValue(G).debug());
+        }
+        return groups.size();
+    }
+
+    VoltDBEngine *m_engine;
+    int m_memory;
+};
+
+/** SELECT G, <every aggregate> FROM T GROUP BY G */
+static TestAggregatePlanNode* everyAggregate(bool groupBy) {
+    TestAggregatePlanNode *node = new TestAggregatePlanNode();
+    if (groupBy) {
+        node->passThrough(G, VALUE_TYPE_INTEGER);
+        node->groupBy(G);
+    }
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT_STAR, G, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_AVG, V, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MIN, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, V, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT, D, VALUE_TYPE_BIGINT);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, D, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_AVG, D, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MIN, D, VALUE_TYPE_DOUBLE);
+    node->aggregate(EXPRESSION_TYPE_AGGREGATE_MAX, D, VALUE_TYPE_DOUBLE);
+    return node;
+}
+
+/**
+ * A few groups that every thread sees, and more groups than tuples in a
+ * morsel, give the same rows as a single-threaded scan
+ */
+TEST_F(ParallelAggregateTest, GroupBy) {
+    Table *input = inputTable(200000, 10);
+    checkParallel(everyAggregate(true), everyAggregate(true), input, countGroups(input));
+    input = inputTable(200000, 100000);
+    checkParallel(everyAggregate(true), everyAggregate(true), input, countGroups(input));
+}
+
+/**
+ * Without a GROUP BY there is a single row, even for an input with fewer
+ * blocks than threads or no tuples at all
+ */
+TEST_F(ParallelAggregateTest, NoGroupBy) {
+    checkParallel(everyAggregate(false), everyAggregate(false), inputTable(100000, 10), 1);
+    checkParallel(everyAggregate(false), everyAggregate(false), inputTable(100, 10), 1);
+    checkParallel(everyAggregate(false), everyAggregate(false), inputTable(0, 10), 1);
+    checkParallel(everyAggregate(true), everyAggregate(true), inputTable(0, 10), 0);
+}
+
+/**
+ * Only the tuples that satisfy the compiled predicate are aggregated, but
+ * every tuple is counted as scanned
+ */
+TEST_F(ParallelAggregateTest, Predicate) {
+    Table *input = inputTable(100000, 1000);
+    // V > 0 AND D <= 2000.0
+    AbstractExpression *predicate = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                          new TupleValueExpression(V, "T", "V"),
+                          constantValueFactory(ValueFactory::getBigIntValue(0))),
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                          new TupleValueExpression(D, "T", "D"),
+                          constantValueFactory(ValueFactory::getDoubleValue(2000.0))));
+    CompiledPredicate compiled;
+    ASSERT_TRUE(compiled.compile(predicate, input->schema()));
+    ASSERT_TRUE(compiled.bind());
+
+    vector<int> groupBy(1, G);
+    vector<ExpressionType> aggregates;
+    aggregates.push_back(EXPRESSION_TYPE_AGGREGATE_COUNT_STAR);
+    aggregates.push_back(EXPRESSION_TYPE_AGGREGATE_SUM);
+    aggregates.push_back(EXPRESSION_TYPE_AGGREGATE_MAX);
+    vector<int> columns;
+    columns.push_back(G);
+    columns.push_back(V);
+    columns.push_back(D);
+    vector<int> outputColumns;
+    outputColumns.push_back(1);
+    outputColumns.push_back(2);
+    outputColumns.push_back(3);
+    vector<pair<int, int> > passThrough(1, pair<int, int>(0, G));
+
+    vector<ValueType> types;
+    types.push_back(VALUE_TYPE_INTEGER);
+    types.push_back(VALUE_TYPE_BIGINT);
+    types.push_back(VALUE_TYPE_BIGINT);
+    types.push_back(VALUE_TYPE_DOUBLE);
+    vector<int32_t> lengths;
+    for (int i = 0; i < types.size(); i++) {
+        lengths.push_back(NValue::getTupleStorageSize(types[i]));
+    }
+    vector<bool> allowNull(types.size(), true);
+    string names[4] = { "G", "C", "S", "M" };
+
+    // the same tuples fed one by one on this thread
+    TypedHashAggregator serial;
+    ASSERT_TRUE(serial.init(input->schema(), groupBy, aggregates, columns));
+    serial.reset();
+    int matches = 0;
+    TableIterator iter(input);
+    TableTuple tuple(input->schema());
+    while (iter.next(tuple)) {
+        if (predicate->eval(&tuple, NULL).isTrue()) {
+            serial.add(tuple.address());
+            matches++;
+        }
+    }
+    serial.flush();
+    Table *serialOutput = TableFactory::getTempTable(0, "S",
+        TupleSchema::createTupleSchema(types, lengths, allowNull, true), names, &m_memory);
+    ASSERT_TRUE(serial.finish(serialOutput, outputColumns, passThrough));
+    ASSERT_TRUE(matches > 0 && matches < input->activeTupleCount());
+
+    TypedHashAggregator parallel;
+    ASSERT_TRUE(parallel.init(input->schema(), groupBy, aggregates, columns));
+    int64_t scanned = 0;
+    ASSERT_TRUE(ParallelAggregation::execute(parallel, input, &compiled, TEST_THREADS, &scanned));
+    EXPECT_EQ(input->activeTupleCount(), scanned);
+    Table *parallelOutput = TableFactory::getTempTable(0, "P",
+        TupleSchema::createTupleSchema(types, lengths, allowNull, true), names, &m_memory);
+    ASSERT_TRUE(parallel.finish(parallelOutput, outputColumns, passThrough));
+
+    AggregateResult expected = rows(serialOutput);
+    AggregateResult actual = rows(parallelOutput);
+    EXPECT_EQ(countGroups(input), expected.size());
+    EXPECT_TRUE(expected == actual);
+    delete serialOutput;
+    delete parallelOutput;
+    delete predicate;
+    delete input;
+}
+
+/**
+ * A BIGINT sum that overflows fails like it does on a single thread,
+ * whether it overflows within a morsel or only once the partial sums of
+ * the threads are added up
+ */
+TEST_F(ParallelAggregateTest, Overflow) {
+    for (int spread = 0; spread < 2; spread++) {
+        Table *input = inputTable(0, 1);
+        TableTuple &tuple = input->tempTuple();
+        for (int i = 0; i < 3; i++) {
+            tuple.setNValue(G, ValueFactory::getIntegerValue(1));
+            tuple.setNValue(V, ValueFactory::getBigIntValue(INT64_MAX / 2));
+            tuple.setNValue(D, ValueFactory::getDoubleValue(0));
+            input->insertTuple(tuple);
+            // put the other ones in later morsels
+            for (int j = 0; spread == 1 && j < 50000; j++) {
+                tuple.setNValue(G, ValueFactory::getIntegerValue(2));
+                tuple.setNValue(V, ValueFactory::getBigIntValue(j));
+                input->insertTuple(tuple);
+            }
+        }
+        TestAggregatePlanNode *node = new TestAggregatePlanNode();
+        node->passThrough(G, VALUE_TYPE_INTEGER);
+        node->groupBy(G);
+        node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, V, VALUE_TYPE_BIGINT);
+        bool thrown = false;
+        try {
+            aggregate(node, input, TEST_THREADS);
+        } catch (SQLException &e) {
+            thrown = true;
+        }
+        EXPECT_TRUE(thrown);
+        delete input;
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,309 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "executors/executor_test_util.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/executors.h"
+#include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/aggregatenode.h"
+#include "plannodes/limitnode.h"
+#include "plannodes/projectionnode.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+// columns of the input table
+enum { ID, V, NAME };
+
+/**
+ * A projection put together column by column
+ */
+class TestProjectionPlanNode : public ProjectionPlanNode {
+public:
+    void project(AbstractExpression *expression, ValueType type) {
+        char name[16];
+        snprintf(name, sizeof(name), "C%d", (int)m_outputColumnNames.size());
+        m_outputColumnGuids.push_back(static_cast<int>(m_outputColumnNames.size()));
+        m_outputColumnNames.push_back(name);
+        m_outputColumnTypes.push_back(type);
+        m_outputColumnSizes.push_back(type == VALUE_TYPE_VARCHAR ? 32 : NValue::getTupleStorageSize(type));
+        m_outputColumnExpressions.push_back(expression);
+    }
+};
+
+typedef AggregateExecutor<PLAN_NODE_TYPE_HASHAGGREGATE> HashAggregateExecutor;
+
+class PipelineTest : public Test {
+public:
+    PipelineTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+    }
+
+    ~PipelineTest() {
+        clear();
+        delete m_engine;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < m_nodes.size(); i++) {
+            delete m_nodes[i];
+        }
+        m_nodes.clear();
+        m_executors.clear();
+    }
+
+    /** T(ID BIGINT, V INTEGER, NAME VARCHAR(32)) with V in [0, 50) */
+    Table* inputTable(int rows) {
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        types.push_back(VALUE_TYPE_BIGINT); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        types.push_back(VALUE_TYPE_INTEGER); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        types.push_back(VALUE_TYPE_VARCHAR); lengths.push_back(32);
+        vector<bool> allowNull(3, true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        string names[3] = { "ID", "V", "NAME" };
+        Table *table = TableFactory::getTempTable(0, "T", schema, names, &m_memory);
+
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < rows; i++) {
+            tuple.setNValue(ID, ValueFactory::getBigIntValue(i));
+            tuple.setNValue(V, ValueFactory::getIntegerValue(rand() % 50));
+            char name[32];
+            snprintf(name, sizeof(name), "name %d", rand() % 1000);
+            NValue value = ValueFactory::getStringValue(name);
+            tuple.setNValue(NAME, value);
+            table->insertTuple(tuple);
+            value.free();
+        }
+        return table;
+    }
+
+    /** Put a node with its executor on top of the plan built so far */
+    AbstractPlanNode* add(AbstractPlanNode *node, AbstractExecutor *executor) {
+        if (!m_nodes.empty()) {
+            node->addChild(m_nodes.back());
+            m_nodes.back()->getParents().push_back(node);
+        }
+        node->setExecutor(executor);
+        m_nodes.push_back(node);
+        if (executor != NULL) {
+            EXPECT_TRUE(executor->init(m_engine, NULL, &m_memory));
+            m_executors.push_back(executor);
+        }
+        return node;
+    }
+
+    void addInput(int rows) {
+        add(new InputPlanNode(inputTable(rows)), NULL);
+    }
+
+    /** SELECT ID, V * 2, NAME */
+    void addProjection() {
+        TestProjectionPlanNode *node = new TestProjectionPlanNode();
+        node->project(new TupleValueExpression(ID, "T", "ID"), VALUE_TYPE_BIGINT);
+        node->project(operatorFactory(EXPRESSION_TYPE_OPERATOR_MULTIPLY,
+                                                      new TupleValueExpression(V, "T", "V"),
+                                                      constantValueFactory(ValueFactory::getBigIntValue(2))),
+                      VALUE_TYPE_BIGINT);
+        node->project(new TupleValueExpression(NAME, "T", "NAME"), VALUE_TYPE_VARCHAR);
+        add(node, new ProjectionExecutor(m_engine, node));
+    }
+
+    void addLimit(int limit, int offset) {
+        LimitPlanNode *node = new LimitPlanNode(AbstractPlanNode::getNextPlanNodeId());
+        node->setLimit(limit);
+        node->setOffset(offset);
+        add(node, new LimitExecutor(m_engine, node));
+    }
+
+    /** SELECT V, SUM(ID), COUNT(*) FROM input GROUP BY V */
+    void addAggregate() {
+        TestAggregatePlanNode *node = new TestAggregatePlanNode();
+        node->passThrough(V, VALUE_TYPE_INTEGER);
+        node->groupBy(V);
+        node->aggregate(EXPRESSION_TYPE_AGGREGATE_SUM, ID, VALUE_TYPE_BIGINT);
+        node->aggregate(EXPRESSION_TYPE_AGGREGATE_COUNT_STAR, ID, VALUE_TYPE_BIGINT);
+        add(node, new HashAggregateExecutor(m_engine, node));
+    }
+
+    /**
+     * Execute the plan bottom up the way the engine does and return the
+     * rows of the top node. With pipelined set, the executors first
+     * choose which children to pull their input from.
+     */
+    vector<string> execute(bool pipelined) {
+        if (pipelined) {
+            for (size_t i = 0; i < m_executors.size(); i++) {
+                m_executors[i]->initPipelines();
+            }
+        }
+        vector<string> rows;
+        for (size_t i = 0; i < m_executors.size(); i++) {
+            if (m_executors[i]->isPipelined()) {
+                continue;
+            }
+            if (!m_executors[i]->execute(NValueArray(), NULL)) {
+                return rows;
+            }
+        }
+        Table *output = m_nodes.back()->getOutputTable();
+        TableIterator iter(output);
+        TableTuple tuple(output->schema());
+        while (iter.next(tuple)) {
+            rows.push_back(values(tuple));
+        }
+        return rows;
+    }
+
+    /** The values of a row, without the addresses of its strings */
+    static string values(const TableTuple &tuple) {
+        string row;
+        for (int i = 0; i < tuple.sizeInValues(); i++) {
+            const NValue value = tuple.getNValue(i);
+            if (ValuePeeker::peekValueType(value) == VALUE_TYPE_VARCHAR && !value.isNull()) {
+                row += string(static_cast<const char*>(ValuePeeker::peekObjectValue(value)),
+                              ValuePeeker::peekObjectLength(value));
+            } else {
+                row += value.debug();
+            }
+            row += "|";
+        }
+        return row;
+    }
+
+    /** Whether the executor at the given position in the plan is pipelined */
+    bool isPipelined(int position) {
+        return m_nodes[position]->getExecutor()->isPipelined();
+    }
+
+    /** Tuples left in the output table of the node at the given position */
+    int64_t outputTuples(int position) {
+        return m_nodes[position]->getOutputTable()->activeTupleCount();
+    }
+
+    VoltDBEngine *m_engine;
+    int m_memory;
+    // bottom up, the input first
+    vector<AbstractPlanNode*> m_nodes;
+    vector<AbstractExecutor*> m_executors;
+};
+
+/**
+ * Projection -> Limit -> Projection gives the same rows in the same order
+ * when the lower two hand their tuples up without filling their output
+ * tables
+ */
+TEST_F(PipelineTest, ProjectionLimit) {
+    const int limits[4][2] = { { 300, 50 }, { 0, 0 }, { 5000, 0 }, { 10, 4000 } };
+    for (int i = 0; i < 4; i++) {
+        srand(i);
+        addInput(3000);
+        addProjection();
+        addLimit(limits[i][0], limits[i][1]);
+        addProjection();
+        vector<string> expected = execute(false);
+        ASSERT_FALSE(isPipelined(1));
+        clear();
+
+        srand(i);
+        addInput(3000);
+        addProjection();
+        addLimit(limits[i][0], limits[i][1]);
+        addProjection();
+        vector<string> actual = execute(true);
+        ASSERT_TRUE(isPipelined(1));
+        ASSERT_TRUE(isPipelined(2));
+        ASSERT_FALSE(isPipelined(3));
+        ASSERT_EQ(0, outputTuples(1));
+        ASSERT_EQ(0, outputTuples(2));
+        clear();
+
+        const int rows = (limits[i][1] > 3000 ? 0 : min(limits[i][0], 3000 - limits[i][1]));
+        ASSERT_EQ(rows, expected.size());
+        ASSERT_TRUE(expected == actual);
+    }
+}
+
+/**
+ * An aggregate keeps pointing at its input tuples, so it only pulls from
+ * children whose tuples stay valid. A limit over a materialized table
+ * qualifies, a projection that reuses one tuple for its output does not.
+ */
+TEST_F(PipelineTest, AggregateInput) {
+    srand(1);
+    addInput(5000);
+    addLimit(4000, 100);
+    addAggregate();
+    vector<string> materialized = execute(false);
+    clear();
+
+    srand(1);
+    addInput(5000);
+    addLimit(4000, 100);
+    addAggregate();
+    vector<string> pipelined = execute(true);
+    ASSERT_TRUE(isPipelined(1));
+    ASSERT_EQ(0, outputTuples(1));
+    clear();
+    ASSERT_EQ(50, materialized.size());
+    ASSERT_TRUE(multiset<string>(materialized.begin(), materialized.end()) ==
+                multiset<string>(pipelined.begin(), pipelined.end()));
+
+    addInput(5000);
+    addProjection();
+    addLimit(4000, 100);
+    addAggregate();
+    pipelined = execute(true);
+    // the projection is pipelined into the limit, but the limit then hands
+    // out the projection's tuples and so is materialized
+    ASSERT_TRUE(isPipelined(1));
+    ASSERT_FALSE(isPipelined(2));
+    ASSERT_EQ(4000, outputTuples(2));
+    ASSERT_EQ(50, pipelined.size());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,360 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/debuglog.h"
+#include "executors/executor_test_util.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "execution/VoltDBEngine.h"
+#include "executors/distinctexecutor.h"
+#include "executors/unionexecutor.h"
+#include "plannodes/abstractplannode.h"
+#include "plannodes/distinctnode.h"
+#include "plannodes/unionnode.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define NUM_DISTINCT_ROWS 20000
+
+/**
+ * A DISTINCT node over the given input columns, the way the planner would
+ * describe it with DISTINCT_COLUMN_GUIDS
+ */
+class TestDistinctPlanNode : public DistinctPlanNode {
+public:
+    TestDistinctPlanNode(const vector<int> &columns, int columnCount)
+        : DistinctPlanNode(AbstractPlanNode::getNextPlanNodeId()) {
+        m_distinctColumnGuid = columns[0];
+        m_distinctColumnGuids = columns;
+        for (int i = 0; i < columnCount; i++) {
+            m_outputColumnGuids.push_back(i);
+        }
+    }
+};
+
+// columns of the input table
+enum { A, B, C };
+
+// the rows of a result as the debug strings of their columns
+typedef vector<string> Row;
+
+class SetOperationsTest : public Test {
+public:
+    SetOperationsTest() : m_memory(0) {
+        srand(0);
+        m_engine = new VoltDBEngine();
+        m_engine->initialize(0, 0, 0, 0, "");
+    }
+
+    ~SetOperationsTest() {
+        delete m_engine;
+    }
+
+    /**
+     * T(A INTEGER, B VARCHAR(12), C BIGINT) with A in [0, range), B one of
+     * a few strings, C the position of the row if ids is set and in
+     * [0, range) otherwise, and about one value in ten NULL
+     */
+    Table* inputTable(int rows, int range, bool ids) {
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_INTEGER);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        types.push_back(VALUE_TYPE_BIGINT);
+        vector<int32_t> lengths;
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        lengths.push_back(12);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> allowNull(types.size(), true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        string names[3] = { "A", "B", "C" };
+        Table *table = TableFactory::getTempTable(0, "T", schema, names, &m_memory);
+
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < rows; i++) {
+            tuple.setNValue(A, isNull(10) ? NValue::getNullValue(VALUE_TYPE_INTEGER) :
+                                          ValueFactory::getIntegerValue(rand() % range));
+            char name[12];
+            // "" and "s" are prefixes of the others
+            snprintf(name, sizeof(name), "%.*s", rand() % 4, "sss");
+            NValue value = isNull(10) ? NValue::getNullValue(VALUE_TYPE_VARCHAR) : ValueFactory::getStringValue(name);
+            tuple.setNValue(B, value);
+            tuple.setNValue(C, ids ? ValueFactory::getBigIntValue(i) :
+                               isNull(10) ? NValue::getNullValue(VALUE_TYPE_BIGINT) :
+                                          ValueFactory::getBigIntValue(rand() % range));
+            table->insertTuple(tuple);
+            value.free();
+        }
+        return table;
+    }
+
+    static Row row(const TableTuple &tuple, const vector<int> &columns) {
+        Row result;
+        for (int i = 0; i < columns.size(); i++) {
+            NValue value = tuple.getNValue(columns[i]);
+            if (value.isNull()) {
+                result.push_back("NULL");
+            } else if (ValuePeeker::peekValueType(value) == VALUE_TYPE_VARCHAR) {
+                // debug() would add the address of the string
+                result.push_back("'" + string(static_cast<char*>(ValuePeeker::peekObjectValue(value)),
+                                              ValuePeeker::peekObjectLength(value)) + "'");
+            } else {
+                result.push_back(value.debug());
+            }
+        }
+        return result;
+    }
+
+    static vector<Row> rows(Table *table, const vector<int> &columns) {
+        vector<Row> result;
+        TableIterator iter(table);
+        TableTuple tuple(table->schema());
+        while (iter.next(tuple)) {
+            result.push_back(row(tuple, columns));
+        }
+        return result;
+    }
+
+    static vector<int> allColumns() {
+        vector<int> columns;
+        columns.push_back(A);
+        columns.push_back(B);
+        columns.push_back(C);
+        return columns;
+    }
+
+    /** SELECT DISTINCT over the given columns of the input, whole rows */
+    vector<Row> distinct(Table *input, const vector<int> &columns, double *seconds = NULL) {
+        InputPlanNode child(input);
+        TestDistinctPlanNode *node = new TestDistinctPlanNode(columns, input->columnCount());
+        node->addChild(&child);
+        DistinctExecutor *executor = new DistinctExecutor(m_engine, node);
+        node->setExecutor(executor);
+        vector<Row> result;
+        if (executor->init(m_engine, NULL, &m_memory)) {
+            struct timeval start;
+            gettimeofday(&start, NULL);
+            bool success = executor->execute(NValueArray(), NULL);
+            if (seconds != NULL) {
+                *seconds = elapsed(start);
+            }
+            if (success) {
+                result = rows(node->getOutputTable(), allColumns());
+            }
+        }
+        delete node;
+        // the input goes with the child
+        return result;
+    }
+
+    /** The union node of the given type over the inputs, which it deletes */
+    vector<Row> setOperation(UnionType type, const vector<Table*> &inputs) {
+        vector<InputPlanNode*> children;
+        UnionPlanNode *node = new UnionPlanNode(AbstractPlanNode::getNextPlanNodeId());
+        node->setUnionType(type);
+        for (int i = 0; i < inputs.size(); i++) {
+            children.push_back(new InputPlanNode(inputs[i]));
+            node->addChild(children.back());
+        }
+        UnionExecutor *executor = new UnionExecutor(m_engine, node);
+        node->setExecutor(executor);
+        vector<Row> result;
+        if (executor->init(m_engine, NULL, &m_memory) &&
+            executor->execute(NValueArray(), NULL)) {
+            result = rows(node->getOutputTable(), allColumns());
+        }
+        delete node;
+        for (int i = 0; i < children.size(); i++) {
+            delete children[i];
+        }
+        return result;
+    }
+
+    /**
+     * The rows of the input whose columns were not seen in an earlier row,
+     * in input order
+     */
+    static vector<Row> firstOccurrences(Table *input, const vector<int> &columns) {
+        set<Row> seen;
+        vector<Row> result;
+        TableIterator iter(input);
+        TableTuple tuple(input->schema());
+        while (iter.next(tuple)) {
+            if (seen.insert(row(tuple, columns)).second) {
+                result.push_back(row(tuple, allColumns()));
+            }
+        }
+        return result;
+    }
+
+    VoltDBEngine *m_engine;
+    int m_memory;
+};
+
+/**
+ * DISTINCT on one column and on several, with NULLs and strings that are
+ * prefixes of each other, keeps the first row of every key in input order
+ */
+TEST_F(SetOperationsTest, Distinct) {
+    const int columnLists[4][3] = { { A, -1, -1 }, { B, -1, -1 }, { A, B, -1 }, { B, A, C } };
+    for (int l = 0; l < 4; l++) {
+        vector<int> columns;
+        for (int c = 0; c < 3 && columnLists[l][c] >= 0; c++) {
+            columns.push_back(columnLists[l][c]);
+        }
+        Table *input = inputTable(3000, 50, true);
+        vector<Row> expected = firstOccurrences(input, columns);
+        vector<Row> actual = distinct(input, columns);
+        ASSERT_TRUE(expected.size() > 1);
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(expected == actual);
+    }
+}
+
+/**
+ * UNION ALL, UNION, INTERSECT and EXCEPT of three inputs with many rows in
+ * common give what sets of the rows give
+ */
+TEST_F(SetOperationsTest, UnionIntersectExcept) {
+    const UnionType types[4] = { UNION_TYPE_UNION_ALL, UNION_TYPE_UNION,
+                                 UNION_TYPE_INTERSECT, UNION_TYPE_EXCEPT };
+    for (int t = 0; t < 4; t++) {
+        srand(t);
+        vector<Table*> inputs;
+        vector<vector<Row> > inputRows;
+        for (int i = 0; i < 3; i++) {
+            // the later inputs leave out some of the rows of the first
+            inputs.push_back(inputTable(i == 0 ? 2000 : 300, 6, false));
+            inputRows.push_back(rows(inputs.back(), allColumns()));
+        }
+
+        multiset<Row> expected;
+        if (types[t] == UNION_TYPE_UNION_ALL) {
+            for (int i = 0; i < 3; i++) {
+                expected.insert(inputRows[i].begin(), inputRows[i].end());
+            }
+        } else if (types[t] == UNION_TYPE_UNION) {
+            set<Row> all;
+            for (int i = 0; i < 3; i++) {
+                all.insert(inputRows[i].begin(), inputRows[i].end());
+            }
+            expected.insert(all.begin(), all.end());
+        } else {
+            set<Row> first(inputRows[0].begin(), inputRows[0].end());
+            for (set<Row>::iterator it = first.begin(); it != first.end(); it++) {
+                bool inAll = true, inAny = false;
+                for (int i = 1; i < 3; i++) {
+                    bool found = (find(inputRows[i].begin(), inputRows[i].end(), *it) != inputRows[i].end());
+                    inAll = inAll && found;
+                    inAny = inAny || found;
+                }
+                if (types[t] == UNION_TYPE_INTERSECT ? inAll : !inAny) {
+                    expected.insert(*it);
+                }
+            }
+        }
+
+        vector<Row> result = setOperation(types[t], inputs);
+        multiset<Row> actual(result.begin(), result.end());
+        ASSERT_TRUE(expected.size() > 0);
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(expected == actual);
+    }
+}
+
+/**
+ * Plans from before UNION_TYPE existed still append their inputs
+ */
+TEST_F(SetOperationsTest, UnionTypeFromJSON) {
+    json_spirit::Object obj;
+    UnionPlanNode node(AbstractPlanNode::getNextPlanNodeId());
+    node.setUnionType(UNION_TYPE_EXCEPT);
+    node.loadFromJSONObject(obj, NULL);
+    ASSERT_EQ(UNION_TYPE_UNION_ALL, node.getUnionType());
+
+    obj.push_back(json_spirit::Pair("UNION_TYPE", unionToString(UNION_TYPE_INTERSECT)));
+    node.loadFromJSONObject(obj, NULL);
+    ASSERT_EQ(UNION_TYPE_INTERSECT, node.getUnionType());
+}
+
+/**
+ * DISTINCT on a BIGINT column and on (A, B) for few and for many keys, next
+ * to the std::set of NValues that the executor used to keep. The time each
+ * one takes is logged at the INFO level.
+ */
+TEST_F(SetOperationsTest, DistinctKeyCounts) {
+    const int rows = NUM_DISTINCT_ROWS;
+    const int ranges[2] = { 1000, rows };
+    for (int r = 0; r < 2; r++) {
+        m_memory = 0;
+        Table *input = inputTable(rows, ranges[r], false);
+        struct timeval start;
+        gettimeofday(&start, NULL);
+        set<NValue, NValue::ltNValue> found;
+        TableIterator iter(input);
+        TableTuple tuple(input->schema());
+        while (iter.next(tuple)) {
+            found.insert(tuple.getNValue(C));
+        }
+        double treeSeconds = elapsed(start);
+        size_t treeCount = found.size();
+        found.clear();
+
+        double hashSeconds, compositeSeconds;
+        size_t hashCount = distinct(input, vector<int>(1, C), &hashSeconds).size();
+        ASSERT_EQ(treeCount, hashCount);
+
+        vector<int> composite;
+        composite.push_back(A);
+        composite.push_back(B);
+        input = inputTable(rows, ranges[r], false);
+        vector<Row> all = SetOperationsTest::rows(input, composite);
+        const size_t expectedComposite = set<Row>(all.begin(), all.end()).size();
+        size_t compositeCount = distinct(input, composite, &compositeSeconds).size();
+        ASSERT_EQ(expectedComposite, compositeCount);
+        VOLT_INFO("%d rows into %d keys: hash %.6f s, std::set %.6f s; (A, B) into %d keys %.6f s",
+                  rows, (int)hashCount, hashSeconds, treeSeconds, (int)compositeCount, compositeSeconds);
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
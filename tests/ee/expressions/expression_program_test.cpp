@@ -0,0 +1,295 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/expressionprogram.h"
+#include "expressions/expressionutil.h"
+#include "expressions/tuplevalueexpression.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define NUM_TUPLES 500
+
+class ExpressionProgramTest : public Test {
+public:
+    ExpressionProgramTest() {
+        srand(0);
+        m_outer = createTable("O");
+        m_inner = createTable("I");
+    }
+
+    ~ExpressionProgramTest() {
+        delete m_outer;
+        delete m_inner;
+    }
+
+    /**
+     * (A BIGINT, B INTEGER, C DOUBLE, D DECIMAL, S VARCHAR(8)) with small
+     * values and one NULL in ten
+     */
+    Table* createTable(const string &name) {
+        string names[5] = { "A", "B", "C", "D", "S" };
+        vector<ValueType> types;
+        types.push_back(VALUE_TYPE_BIGINT);
+        types.push_back(VALUE_TYPE_INTEGER);
+        types.push_back(VALUE_TYPE_DOUBLE);
+        types.push_back(VALUE_TYPE_DECIMAL);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        vector<int32_t> lengths;
+        for (int i = 0; i < 4; i++) {
+            lengths.push_back(NValue::getTupleStorageSize(types[i]));
+        }
+        lengths.push_back(8);
+        vector<bool> allowNull(5, true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        Table *table = TableFactory::getTempTable(0, name, schema, names, NULL);
+
+        const char *strings[4] = { "a", "b", "c", "d" };
+        TableTuple &tuple = table->tempTuple();
+        for (int row = 0; row < NUM_TUPLES; row++) {
+            const int value = rand() % 11 - 5;
+            tuple.setNValue(0, rand() % 10 == 0 ? NValue::getNullValue(VALUE_TYPE_BIGINT) :
+                                                  ValueFactory::getBigIntValue(value));
+            tuple.setNValue(1, rand() % 10 == 0 ? NValue::getNullValue(VALUE_TYPE_INTEGER) :
+                                                  ValueFactory::getIntegerValue(rand() % 11 - 5));
+            tuple.setNValue(2, rand() % 10 == 0 ? NValue::getNullValue(VALUE_TYPE_DOUBLE) :
+                                                  ValueFactory::getDoubleValue((rand() % 21 - 10) / 4.0));
+            char decimal[16];
+            snprintf(decimal, sizeof(decimal), "%d.5", value);
+            tuple.setNValue(3, ValueFactory::getDecimalValueFromString(decimal));
+            NValue str = ValueFactory::getStringValue(strings[rand() % 4]);
+            tuple.setNValue(4, str);
+            table->insertTuple(tuple);
+            str.free();
+        }
+        return table;
+    }
+
+    AbstractExpression* column(int idx, int tuple = 0) {
+        TupleValueExpression *tve = new TupleValueExpression(idx, "T", "C");
+        tve->setTupleIndex(tuple);
+        return tve;
+    }
+
+    AbstractExpression* constant(int64_t value) {
+        return constantValueFactory(ValueFactory::getBigIntValue(value));
+    }
+
+    /**
+     * The program gives the same value as the tree for every pair of
+     * outer and inner tuples. The program gets the parameters passed in,
+     * the tree has them substituted.
+     */
+    void check(AbstractExpression *expression, const NValueArray &params, bool join) {
+        ExpressionProgram program;
+        ASSERT_TRUE(program.compile(expression, m_outer->schema(), m_inner->schema()));
+        expression->substitute(params);
+
+        TableTuple outer(m_outer->schema());
+        TableTuple inner(m_inner->schema());
+        TableIterator outerIter = m_outer->tableIterator();
+        int trues = 0;
+        int rows = 0;
+        while (outerIter.next(outer)) {
+            TableIterator innerIter = m_inner->tableIterator();
+            while (innerIter.next(inner)) {
+                const NValue expected = expression->eval(&outer, &inner);
+                const NValue actual = program.eval(&outer, &inner, params);
+                ASSERT_EQ(ValuePeeker::peekValueType(expected), ValuePeeker::peekValueType(actual));
+                if (ValuePeeker::peekValueType(expected) == VALUE_TYPE_BOOLEAN) {
+                    ASSERT_EQ(expected.isTrue(), actual.isTrue());
+                    ASSERT_EQ(expected.isTrue(), program.evalPredicate(&outer, &inner, params));
+                    if (expected.isTrue()) trues++;
+                } else {
+                    ASSERT_EQ(expected.isNull(), actual.isNull());
+                    ASSERT_EQ(0, expected.compare(actual));
+                }
+                // single table expressions only need one inner tuple
+                if (!join) break;
+            }
+            rows++;
+        }
+        ASSERT_EQ(NUM_TUPLES, rows);
+        ASSERT_TRUE(trues < NUM_TUPLES * NUM_TUPLES);
+    }
+
+    Table *m_outer;
+    Table *m_inner;
+};
+
+/**
+ * Comparisons, conjunctions and NOT over columns of all types, constants
+ * and parameters
+ */
+TEST_F(ExpressionProgramTest, Predicates) {
+    NValueArray params(3);
+    params[0] = ValueFactory::getIntegerValue(2);
+    params[1] = ValueFactory::getDoubleValue(-1.25);
+    params[2] = ValueFactory::getStringValue("b");
+
+    // A > ? AND (C <= ? OR S = ?)
+    AbstractExpression *expression = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHAN, column(0), parameterValueFactory(0)),
+        conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO, column(2), parameterValueFactory(1)),
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL, column(4), parameterValueFactory(2))));
+    check(expression, params, false);
+    delete expression;
+
+    // NOT (D >= B) OR (B <> 3 AND A < C)
+    expression = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR,
+        operatorFactory(EXPRESSION_TYPE_OPERATOR_NOT,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, column(3), column(1)), NULL),
+        conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_NOTEQUAL, column(1), constant(3)),
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN, column(0), column(2))));
+    check(expression, params, false);
+    delete expression;
+    params[2].free();
+}
+
+/**
+ * Arithmetic on both sides of a comparison, and on its own
+ */
+TEST_F(ExpressionProgramTest, Arithmetic) {
+    NValueArray params(2);
+    params[0] = ValueFactory::getBigIntValue(3);
+    params[1] = ValueFactory::getDoubleValue(0.5);
+
+    // (A + B) * ? >= C / 2 - ?
+    AbstractExpression *expression = comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+        operatorFactory(EXPRESSION_TYPE_OPERATOR_MULTIPLY,
+            operatorFactory(EXPRESSION_TYPE_OPERATOR_PLUS, column(0), column(1)),
+            parameterValueFactory(0)),
+        operatorFactory(EXPRESSION_TYPE_OPERATOR_MINUS,
+            operatorFactory(EXPRESSION_TYPE_OPERATOR_DIVIDE, column(2), constant(2)),
+            parameterValueFactory(1)));
+    check(expression, params, false);
+    delete expression;
+
+    // D - A * 2
+    expression = operatorFactory(EXPRESSION_TYPE_OPERATOR_MINUS, column(3),
+        operatorFactory(EXPRESSION_TYPE_OPERATOR_MULTIPLY, column(0), constant(2)));
+    check(expression, params, false);
+    delete expression;
+
+    // a bare column
+    expression = column(2);
+    check(expression, params, false);
+    delete expression;
+}
+
+/**
+ * A join predicate reads the columns of both tuples
+ */
+TEST_F(ExpressionProgramTest, Join) {
+    NValueArray params(1);
+    params[0] = ValueFactory::getIntegerValue(1);
+
+    // O.A = I.B + ? AND O.S <> I.S
+    AbstractExpression *expression = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL, column(0, 0),
+            operatorFactory(EXPRESSION_TYPE_OPERATOR_PLUS, column(1, 1), parameterValueFactory(0))),
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_NOTEQUAL, column(4, 0), column(4, 1)));
+    check(expression, params, true);
+    delete expression;
+}
+
+/**
+ * The same program picks up new parameters on every call without the
+ * tree being substituted
+ */
+TEST_F(ExpressionProgramTest, ParametersPerExecution) {
+    AbstractExpression *expression =
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN, column(0), parameterValueFactory(0));
+    ExpressionProgram program;
+    ASSERT_TRUE(program.compile(expression, m_outer->schema()));
+
+    TableTuple tuple(m_outer->schema());
+    TableIterator iter = m_outer->tableIterator();
+    ASSERT_TRUE(iter.next(tuple));
+    while (tuple.isNull(0)) {
+        ASSERT_TRUE(iter.next(tuple));
+    }
+    const int64_t value = ValuePeeker::peekBigInt(tuple.getNValue(0));
+    NValueArray params(1);
+    params[0] = ValueFactory::getBigIntValue(value + 1);
+    ASSERT_TRUE(program.evalPredicate(&tuple, NULL, params));
+    params[0] = ValueFactory::getBigIntValue(value);
+    ASSERT_FALSE(program.evalPredicate(&tuple, NULL, params));
+    delete expression;
+}
+
+/**
+ * Unsupported expressions and trees that need too many registers are
+ * left to the tree
+ */
+TEST_F(ExpressionProgramTest, Unsupported) {
+    ExpressionProgram program;
+    ASSERT_FALSE(program.compile(NULL, m_outer->schema()));
+
+    // the second tuple without a schema for it
+    AbstractExpression *expression =
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL, column(0, 0), column(0, 1));
+    ASSERT_FALSE(program.compile(expression, m_outer->schema()));
+    ASSERT_FALSE(program.isCompiled());
+    ASSERT_TRUE(program.compile(expression, m_outer->schema(), m_inner->schema()));
+    delete expression;
+
+    // A + (A + (A + ...)) nests deeper than there are registers
+    expression = column(0);
+    for (int i = 0; i < ExpressionProgram::MAX_REGISTERS; i++) {
+        expression = operatorFactory(EXPRESSION_TYPE_OPERATOR_PLUS, column(0), expression);
+    }
+    ASSERT_FALSE(program.compile(expression, m_outer->schema()));
+    delete expression;
+
+    // but the same depth nested to the left only needs two
+    expression = column(0);
+    for (int i = 0; i < ExpressionProgram::MAX_REGISTERS; i++) {
+        expression = operatorFactory(EXPRESSION_TYPE_OPERATOR_PLUS, expression, column(0));
+    }
+    ASSERT_TRUE(program.compile(expression, m_outer->schema()));
+    ASSERT_EQ(ExpressionProgram::MAX_REGISTERS, program.size());
+    delete expression;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,387 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/common.h"
+#include "common/debuglog.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/TupleSchema.h"
+#include "common/tabletuple.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+#include "indexes/ArtTree.h"
+
+#define NUM_TUPLES 4000
+#define NUM_PREFIX_TUPLES 20000
+
+using namespace std;
+using namespace voltdb;
+
+class ArtIndexTest : public Test {
+public:
+    ArtIndexTest() : m_memory(0), m_schema(NULL) {
+        srand(0);
+    }
+
+    ~ArtIndexTest() {
+        for (size_t i = 0; i < m_tuples.size(); i++) {
+            delete[] m_tuples[i];
+        }
+        if (m_schema != NULL) {
+            TupleSchema::freeTupleSchema(m_schema);
+        }
+    }
+
+    /** Keys with long shared prefixes, like most string keys in practice */
+    static string randomString(int maxLength) {
+        static const char *prefixes[] = { "", "customer#", "http://www.example.com/", "http://www.example.com/user/" };
+        string value(prefixes[rand() % 4]);
+        const int length = rand() % 6;
+        for (int i = 0; i < length; i++) {
+            value += static_cast<char>('a' + rand() % 3);
+        }
+        if (static_cast<int>(value.size()) > maxLength) {
+            value.resize(maxLength);
+        }
+        return value;
+    }
+
+    static inline double elapsed(const struct timeval &start) {
+        struct timeval end;
+        gettimeofday(&end, NULL);
+        return (static_cast<double>(end.tv_sec - start.tv_sec) +
+                static_cast<double>(end.tv_usec - start.tv_usec) / 1000000.0);
+    }
+
+    /** (VARCHAR(stringLength), INTEGER) table with inlined strings */
+    void initSchema(int stringLength) {
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        vector<bool> allowNull(2, true);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        lengths.push_back(stringLength);
+        types.push_back(VALUE_TYPE_INTEGER);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        m_schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+    }
+
+    TableIndex* createIndex(TableIndexType type, bool unique) {
+        vector<int32_t> columnIndices;
+        vector<ValueType> columnTypes;
+        columnIndices.push_back(0);
+        columnIndices.push_back(1);
+        columnTypes.push_back(VALUE_TYPE_VARCHAR);
+        columnTypes.push_back(VALUE_TYPE_INTEGER);
+        TableIndexScheme scheme("idx", type, columnIndices, columnTypes, unique, false, m_schema);
+        return TableIndexFactory::getInstance(scheme);
+    }
+
+    TableTuple newTuple(const string &str, int32_t num) {
+        char *data = new char[m_schema->tupleLength() + TUPLE_HEADER_SIZE];
+        ::memset(data, 0, m_schema->tupleLength() + TUPLE_HEADER_SIZE);
+        m_tuples.push_back(data);
+        TableTuple tuple(data, m_schema);
+        NValue value = ValueFactory::getStringValue(str);
+        tuple.setNValue(0, value);
+        value.free();
+        tuple.setNValue(1, ValueFactory::getIntegerValue(num));
+        return tuple;
+    }
+
+    /** Search key with the given columns set and the rest NULL */
+    static void setKey(TableTuple &key, const string *str, const int32_t *num) {
+        key.setAllNulls();
+        if (str != NULL) {
+            NValue value = ValueFactory::getStringValue(*str);
+            key.setNValue(0, value);
+            value.free();
+        }
+        if (num != NULL) {
+            key.setNValue(1, ValueFactory::getIntegerValue(*num));
+        }
+    }
+
+    static string describe(const TableTuple &tuple) {
+        char buffer[32];
+        const NValue str = tuple.getNValue(0);
+        snprintf(buffer, sizeof(buffer), "|%d", ValuePeeker::peekInteger(tuple.getNValue(1)));
+        return (string(static_cast<const char*>(ValuePeeker::peekObjectValue(str)),
+                       ValuePeeker::peekObjectLength(str)) + buffer);
+    }
+
+    /** Everything nextValue() returns, as strings */
+    static vector<string> drain(TableIndex *index, int limit) {
+        vector<string> result;
+        TableTuple tuple;
+        while (limit-- > 0 && !(tuple = index->nextValue()).isNullTuple()) {
+            result.push_back(describe(tuple));
+        }
+        return result;
+    }
+
+    /** Everything nextValueAtKey() returns, as strings */
+    static vector<string> drainAtKey(TableIndex *index) {
+        vector<string> result;
+        TableTuple tuple;
+        while (!(tuple = index->nextValueAtKey()).isNullTuple()) {
+            result.push_back(describe(tuple));
+        }
+        return result;
+    }
+
+    /**
+     * Runs the lookups IndexScanExecutor does against an ART index and a
+     * tree index that hold the same tuples
+     */
+    void compareIndexes(TableIndex *art, TableIndex *tree) {
+        ASSERT_EQ(tree->getSize(), art->getSize());
+        char *keyData[2];
+        TableTuple keys[2];
+        for (int i = 0; i < 2; i++) {
+            const TupleSchema *keySchema = (i == 0 ? art : tree)->getKeySchema();
+            keyData[i] = new char[keySchema->tupleLength() + TUPLE_HEADER_SIZE];
+            keys[i] = TableTuple(keyData[i], keySchema);
+        }
+
+        for (int i = 0; i < 300; i++) {
+            string str = randomString(24);
+            int32_t num = rand() % 20;
+            const bool partial = (i % 3 == 0);
+            for (int k = 0; k < 2; k++) {
+                setKey(keys[k], &str, partial ? NULL : &num);
+            }
+
+            if (partial == false) {
+                ASSERT_EQ(tree->moveToKey(&keys[1]), art->moveToKey(&keys[0]));
+                ASSERT_TRUE(drainAtKey(tree) == drainAtKey(art));
+            }
+
+            tree->moveToKeyOrGreater(&keys[1]);
+            art->moveToKeyOrGreater(&keys[0]);
+            ASSERT_TRUE(drain(tree, 50) == drain(art, 50));
+
+            tree->moveToGreaterThanKey(&keys[1]);
+            art->moveToGreaterThanKey(&keys[0]);
+            ASSERT_TRUE(drain(tree, 50) == drain(art, 50));
+        }
+
+        for (int k = 0; k < 2; k++) {
+            tree->moveToEnd(k == 0);
+            art->moveToEnd(k == 0);
+            ASSERT_TRUE(drain(tree, NUM_TUPLES) == drain(art, NUM_TUPLES));
+        }
+
+        for (int i = 0; i < 2; i++) {
+            delete[] keyData[i];
+        }
+    }
+
+    int64_t m_memory;
+    TupleSchema *m_schema;
+    vector<char*> m_tuples;
+};
+
+/**
+ * Random inserts and deletes against a std::map, checking point lookups,
+ * bounds and iteration in both directions
+ */
+TEST_F(ArtIndexTest, TreeOperations) {
+    ArtTree *tree = new ArtTree(&m_memory);
+    map<string, const void*> expected;
+
+    for (int i = 0; i < 30000; i++) {
+        // a terminator byte keeps the keys prefix-free, like the normalized keys
+        string key = randomString(64) + '\0';
+        const void *value = reinterpret_cast<const void*>(static_cast<uintptr_t>(i + 1));
+        const unsigned char *bytes = reinterpret_cast<const unsigned char*>(key.data());
+        const uint32_t length = static_cast<uint32_t>(key.size());
+        if (rand() % 3 == 0) {
+            ASSERT_EQ(expected.erase(key) == 1, tree->erase(bytes, length));
+        } else {
+            bool inserted = expected.insert(make_pair(key, value)).second;
+            ASSERT_EQ(inserted, tree->insert(bytes, length, value));
+        }
+        ASSERT_EQ(expected.size(), tree->size());
+
+        string probe = randomString(64);
+        const unsigned char *probeBytes = reinterpret_cast<const unsigned char*>(probe.data());
+        const uint32_t probeLength = static_cast<uint32_t>(probe.size());
+        map<string, const void*>::const_iterator lower = expected.lower_bound(probe);
+        ArtTree::Iterator iter = tree->lowerBound(probeBytes, probeLength);
+        for (int j = 0; j < 5 && lower != expected.end(); j++, lower++, iter.next()) {
+            ASSERT_FALSE(iter.atEnd());
+            ASSERT_EQ(lower->second, iter.value());
+        }
+        ASSERT_EQ(lower == expected.end(), iter.atEnd());
+        map<string, const void*>::const_iterator upper = expected.upper_bound(key);
+        iter = tree->upperBound(bytes, length);
+        ASSERT_EQ(upper == expected.end(), iter.atEnd());
+        if (upper != expected.end()) {
+            ASSERT_EQ(upper->second, iter.value());
+        }
+        map<string, const void*>::const_iterator found = expected.find(key);
+        ASSERT_EQ(found == expected.end() ? NULL : found->second, tree->find(bytes, length));
+    }
+
+    ArtTree::Iterator iter = tree->begin();
+    for (map<string, const void*>::const_iterator i = expected.begin(); i != expected.end(); i++) {
+        ASSERT_FALSE(iter.atEnd());
+        ASSERT_EQ(i->first, string(reinterpret_cast<const char*>(iter.key()), iter.keyLength()));
+        iter.next();
+    }
+    ASSERT_TRUE(iter.atEnd());
+    iter = tree->rbegin();
+    for (map<string, const void*>::reverse_iterator i = expected.rbegin(); i != expected.rend(); i++) {
+        ASSERT_FALSE(iter.atEnd());
+        ASSERT_EQ(i->second, iter.value());
+        iter.prev();
+    }
+    ASSERT_TRUE(iter.atEnd());
+
+    for (map<string, const void*>::const_iterator i = expected.begin(); i != expected.end(); i++) {
+        ASSERT_TRUE(tree->erase(reinterpret_cast<const unsigned char*>(i->first.data()),
+                                static_cast<uint32_t>(i->first.size())));
+    }
+    EXPECT_EQ(0, tree->size());
+    EXPECT_TRUE(tree->begin().atEnd());
+    EXPECT_EQ(0, m_memory);
+    delete tree;
+}
+
+/**
+ * Unique and non-unique ART indexes must answer every IndexScanExecutor
+ * lookup like the tree index, also after deletes and tuple moves
+ */
+TEST_F(ArtIndexTest, MatchesTreeIndex) {
+    initSchema(24);
+    for (int u = 0; u < 2; u++) {
+        const bool unique = (u == 0);
+        TableIndex *art = createIndex(RADIX_TREE_INDEX, unique);
+        TableIndex *tree = createIndex(BALANCED_TREE_INDEX, unique);
+        ASSERT_EQ(string(unique ? "ArtUniqueIndex" : "ArtMultiMapIndex"), art->getTypeName());
+
+        vector<TableTuple> tuples;
+        for (int i = 0; i < NUM_TUPLES; i++) {
+            TableTuple tuple = newTuple(randomString(24), rand() % 20);
+            if (i % 50 == 0) {
+                tuple.setNValue(1, NValue::getNullValue(VALUE_TYPE_INTEGER));
+            }
+            const bool inserted = tree->addEntry(&tuple);
+            ASSERT_EQ(inserted, art->addEntry(&tuple));
+            ASSERT_TRUE(art->exists(&tuple));
+            if (inserted) tuples.push_back(tuple);
+        }
+        compareIndexes(art, tree);
+
+        // move some tuples to new storage, delete others
+        for (size_t i = 0; i < tuples.size(); i++) {
+            if (i % 4 == 0) {
+                ASSERT_TRUE(tree->deleteEntry(&tuples[i]));
+                ASSERT_TRUE(art->deleteEntry(&tuples[i]));
+                ASSERT_FALSE(unique && art->exists(&tuples[i]));
+            } else if (i % 4 == 1) {
+                TableTuple moved = newTuple("", 0);
+                moved.copy(tuples[i]);
+                ASSERT_TRUE(tree->setEntryToNewAddress(&moved, moved.address(), tuples[i].address()));
+                ASSERT_TRUE(art->setEntryToNewAddress(&moved, moved.address(), tuples[i].address()));
+            }
+        }
+        compareIndexes(art, tree);
+
+        delete art;
+        delete tree;
+    }
+}
+
+/**
+ * The ART index next to the tree index on URL-like keys that share most of
+ * their bytes. Both must find the same entries; the time and memory each
+ * one takes are logged at the INFO level.
+ */
+TEST_F(ArtIndexTest, SharedPrefixKeys) {
+    initSchema(60);
+    vector<TableTuple> tuples;
+    for (int i = 0; i < NUM_PREFIX_TUPLES; i++) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "http://www.example.com/user/%08d/profile", rand() % 100000000);
+        tuples.push_back(newTuple(buffer, i % 4));
+    }
+    const char *names[3] = { "insert", "lookup", "scan" };
+    const TableIndexType types[2] = { BALANCED_TREE_INDEX, RADIX_TREE_INDEX };
+    double seconds[2][3];
+    int64_t memory[2];
+    size_t found[2] = { 0, 0 };
+    struct timeval start;
+
+    for (int t = 0; t < 2; t++) {
+        TableIndex *index = createIndex(types[t], true);
+        char *keyData = new char[index->getKeySchema()->tupleLength() + TUPLE_HEADER_SIZE];
+        TableTuple key(keyData, index->getKeySchema());
+
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_PREFIX_TUPLES; i++) {
+            index->addEntry(&tuples[i]);
+        }
+        seconds[t][0] = elapsed(start);
+        memory[t] = index->getMemoryEstimate();
+
+        gettimeofday(&start, NULL);
+        for (int i = NUM_PREFIX_TUPLES - 1; i >= 0; i--) {
+            found[t] += index->moveToTuple(&tuples[i]);
+        }
+        seconds[t][1] = elapsed(start);
+
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_PREFIX_TUPLES; i += 100) {
+            key.setNValue(0, tuples[i].getNValue(0));
+            key.setNValue(1, tuples[i].getNValue(1));
+            index->moveToKeyOrGreater(&key);
+            for (int j = 0; j < 100 && !index->nextValue().isNullTuple(); j++) found[t]++;
+        }
+        seconds[t][2] = elapsed(start);
+
+        delete[] keyData;
+        delete index;
+    }
+
+    EXPECT_TRUE(found[0] > NUM_PREFIX_TUPLES);
+    EXPECT_EQ(found[0], found[1]);
+    for (int op = 0; op < 3; op++) {
+        VOLT_INFO("%s of %d keys: tree %.6f s, ART %.6f s", names[op], NUM_PREFIX_TUPLES, seconds[0][op], seconds[1][op]);
+    }
+    VOLT_INFO("memory: tree %ld bytes, ART %ld bytes", (long)memory[0], (long)memory[1]);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,218 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <vector>
+#include "harness.h"
+#include "common/common.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/TupleSchema.h"
+#include "common/tabletuple.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+
+#define NUM_TUPLES 1000
+
+using namespace std;
+using namespace voltdb;
+
+/**
+ * Index-only reads: copyCoveredValues() has to give back the key and
+ * included columns of the entry that was returned last
+ */
+class CoveringIndexTest : public Test {
+public:
+    CoveringIndexTest() : m_schema(NULL), m_coveredData(NULL) {
+        srand(0);
+        // (BIGINT, INTEGER, DOUBLE, VARCHAR(16))
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        vector<bool> allowNull(4, true);
+        types.push_back(VALUE_TYPE_BIGINT);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        types.push_back(VALUE_TYPE_INTEGER);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        types.push_back(VALUE_TYPE_DOUBLE);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+        types.push_back(VALUE_TYPE_VARCHAR);
+        lengths.push_back(16);
+        m_schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+
+        m_coveredData = new char[m_schema->tupleLength() + TUPLE_HEADER_SIZE];
+        ::memset(m_coveredData, 0, m_schema->tupleLength() + TUPLE_HEADER_SIZE);
+        m_covered = TableTuple(m_coveredData, m_schema);
+    }
+
+    ~CoveringIndexTest() {
+        for (size_t i = 0; i < m_tuples.size(); i++) {
+            delete[] m_tuples[i];
+        }
+        delete[] m_coveredData;
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    TableIndex* createIndex(const vector<int32_t> &columns, const vector<int32_t> &included,
+                            bool unique, bool intsOnly) {
+        vector<ValueType> columnTypes;
+        for (size_t i = 0; i < columns.size(); i++) {
+            columnTypes.push_back(m_schema->columnType(columns[i]));
+        }
+        TableIndexScheme scheme("idx", BALANCED_TREE_INDEX, columns, columnTypes, unique, intsOnly, m_schema);
+        scheme.includeColumns = included;
+        return TableIndexFactory::getInstance(scheme);
+    }
+
+    TableTuple newTuple(int64_t a, int32_t b, double c) {
+        char *data = new char[m_schema->tupleLength() + TUPLE_HEADER_SIZE];
+        ::memset(data, 0, m_schema->tupleLength() + TUPLE_HEADER_SIZE);
+        m_tuples.push_back(data);
+        TableTuple tuple(data, m_schema);
+        tuple.setNValue(0, ValueFactory::getBigIntValue(a));
+        tuple.setNValue(1, ValueFactory::getIntegerValue(b));
+        tuple.setNValue(2, ValueFactory::getDoubleValue(c));
+        NValue value = ValueFactory::getStringValue("x");
+        tuple.setNValue(3, value);
+        value.free();
+        return tuple;
+    }
+
+    /** Random tuples with a NULL now and then, added to the index */
+    vector<TableTuple> fill(TableIndex *index) {
+        vector<TableTuple> tuples;
+        for (int i = 0; i < NUM_TUPLES; i++) {
+            TableTuple tuple = newTuple(rand() % 100 - 50, i, static_cast<double>(rand() % 2001 - 1000) / 4.0);
+            if (i % 50 == 0) {
+                tuple.setNValue(2, NValue::getNullValue(VALUE_TYPE_DOUBLE));
+            }
+            if (i % 70 == 0) {
+                tuple.setNValue(0, NValue::getNullValue(VALUE_TYPE_BIGINT));
+            }
+            EXPECT_TRUE(index->addEntry(&tuple));
+            tuples.push_back(tuple);
+        }
+        return tuples;
+    }
+
+    /**
+     * Walk the whole index and check that the covered columns read from
+     * the entries match the tuples they point to
+     */
+    int checkScan(TableIndex *index, const vector<int32_t> &columns, bool forward) {
+        int count = 0;
+        index->moveToEnd(forward);
+        TableTuple tuple;
+        while (!(tuple = index->nextValue()).isNullTuple()) {
+            index->copyCoveredValues(&m_covered);
+            for (size_t i = 0; i < columns.size(); i++) {
+                EXPECT_EQ(0, tuple.getNValue(columns[i]).compare(m_covered.getNValue(columns[i])));
+            }
+            count++;
+        }
+        return count;
+    }
+
+    TupleSchema *m_schema;
+    vector<char*> m_tuples;
+    char *m_coveredData;
+    TableTuple m_covered;
+};
+
+TEST_F(CoveringIndexTest, IntsKey) {
+    vector<int32_t> columns;
+    columns.push_back(0);
+    columns.push_back(1);
+    TableIndex *index = createIndex(columns, vector<int32_t>(), true, true);
+    ASSERT_TRUE(index->supportsCoveringReads());
+    EXPECT_TRUE(index->coversColumn(1));
+    EXPECT_FALSE(index->coversColumn(2));
+
+    vector<TableTuple> tuples = fill(index);
+    EXPECT_EQ(NUM_TUPLES, checkScan(index, columns, true));
+    EXPECT_EQ(NUM_TUPLES, checkScan(index, columns, false));
+
+    for (int i = 0; i < NUM_TUPLES; i += 7) {
+        ASSERT_TRUE(index->moveToTuple(&tuples[i]));
+        TableTuple tuple = index->nextValueAtKey();
+        ASSERT_EQ(tuples[i].address(), tuple.address());
+        index->copyCoveredValues(&m_covered);
+        EXPECT_EQ(0, tuples[i].getNValue(0).compare(m_covered.getNValue(0)));
+        EXPECT_EQ(0, tuples[i].getNValue(1).compare(m_covered.getNValue(1)));
+    }
+    delete index;
+}
+
+TEST_F(CoveringIndexTest, IncludedColumns) {
+    vector<int32_t> columns;
+    columns.push_back(0);
+    vector<int32_t> included;
+    included.push_back(2);
+    vector<int32_t> covered(columns);
+    covered.push_back(2);
+
+    for (int unique = 0; unique < 2; unique++) {
+        vector<int32_t> key(columns);
+        if (unique) {
+            key.push_back(1);
+            covered.push_back(1);
+        }
+        TableIndex *index = createIndex(key, included, unique == 1, true);
+        ASSERT_TRUE(index->supportsCoveringReads());
+        EXPECT_TRUE(index->coversColumn(2));
+        EXPECT_FALSE(index->coversColumn(3));
+
+        vector<TableTuple> tuples = fill(index);
+        EXPECT_EQ(NUM_TUPLES, checkScan(index, covered, true));
+        EXPECT_EQ(NUM_TUPLES, checkScan(index, covered, false));
+
+        // an update of an included column has to reach the index, even
+        // though the key stays the same
+        for (int i = 0; i < NUM_TUPLES; i += 3) {
+            TableTuple before = newTuple(0, 0, 0.0);
+            before.copy(tuples[i]);
+            tuples[i].setNValue(2, ValueFactory::getDoubleValue(static_cast<double>(i)));
+            EXPECT_FALSE(index->checkForIndexChange(&before, &tuples[i]));
+            ASSERT_TRUE(index->replaceEntry(&before, &tuples[i]));
+        }
+        EXPECT_EQ(NUM_TUPLES, index->getSize());
+        EXPECT_EQ(NUM_TUPLES, checkScan(index, covered, true));
+        delete index;
+    }
+}
+
+TEST_F(CoveringIndexTest, StringKey) {
+    vector<int32_t> columns;
+    columns.push_back(3);
+    TableIndex *index = createIndex(columns, vector<int32_t>(), false, false);
+    // strings can't be decoded from the key without an allocation
+    EXPECT_FALSE(index->supportsCoveringReads());
+    EXPECT_TRUE(index->coversColumn(3));
+    delete index;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
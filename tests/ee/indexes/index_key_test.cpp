@@ -21,6 +21,8 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
+#include <cstdlib>
 #include "harness.h"
 #include "indexes/indexkey.h"
 #include "common/NValue.hpp"
@@ -34,6 +36,86 @@ class IndexKeyTest : public Test {
     public:
         IndexKeyTest() {}
 
+        /**
+         * Random value of the given column type. Strings only use a few
+         * letters so that many of them share prefixes.
+         */
+        static NValue randomValue(ValueType type, int32_t length) {
+            if (rand() % 8 == 0) {
+                return NValue::getNullValue(type);
+            }
+            switch (type) {
+            case VALUE_TYPE_TINYINT:
+                return ValueFactory::getTinyIntValue(static_cast<int8_t>(rand() % 255 - 127));
+            case VALUE_TYPE_INTEGER:
+                return ValueFactory::getIntegerValue(rand() % 2001 - 1000);
+            case VALUE_TYPE_BIGINT:
+                return ValueFactory::getBigIntValue((static_cast<int64_t>(rand()) << 31) * (rand() % 2 ? 1 : -1));
+            case VALUE_TYPE_DOUBLE:
+                return ValueFactory::getDoubleValue(static_cast<double>(rand() % 2001 - 1000) / 8.0);
+            case VALUE_TYPE_DECIMAL: {
+                char buffer[64];
+                snprintf(buffer, sizeof(buffer), "%d.%03d", rand() % 2001 - 1000, rand() % 1000);
+                return ValueFactory::getDecimalValueFromString(buffer);
+            }
+            case VALUE_TYPE_VARCHAR: {
+                std::string value(static_cast<size_t>(rand() % (length + 1)), 'a');
+                // long strings often share a prefix longer than the part of
+                // a NormalizedOverflowKey that is kept inline
+                const size_t shared = (length > 64 && rand() % 2 ? std::min(value.size(), static_cast<size_t>(60)) : 0);
+                for (size_t i = shared; i < value.size(); i++) {
+                    value[i] = static_cast<char>('a' + rand() % 3);
+                }
+                return ValueFactory::getStringValue(value);
+            }
+            default:
+                return NValue::getNullValue(type);
+            }
+        }
+
+        /**
+         * Check that the normalized keys of random tuples sort exactly like
+         * the tuples themselves
+         */
+        template <typename KeyType, typename ComparatorType, typename EqualityType>
+        void checkNormalizedOrder(const std::vector<ValueType> &columnTypes,
+                                         const std::vector<int32_t> &columnLengths) {
+            std::vector<bool> columnAllowNull(columnTypes.size(), true);
+            TupleSchema *keySchema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+            ComparatorType comparator(keySchema);
+            EqualityType equality(keySchema);
+
+            const int count = 200;
+            std::vector<char*> storage;
+            std::vector<KeyType> keys(count);
+            std::vector<NValue> strings;
+            for (int i = 0; i < count; i++) {
+                TableTuple tuple(keySchema);
+                storage.push_back(new char[tuple.tupleLength()]);
+                tuple.move(storage.back());
+                for (int col = 0; col < keySchema->columnCount(); col++) {
+                    NValue value = randomValue(columnTypes[col], columnLengths[col]);
+                    tuple.setNValue(col, value);
+                    if (columnTypes[col] == VALUE_TYPE_VARCHAR) strings.push_back(value);
+                }
+                keys[i].setFromKey(&tuple);
+            }
+
+            for (int i = 0; i < count; i++) {
+                TableTuple lhs(storage[i], keySchema);
+                KeyType copy(keys[i]);
+                for (int j = 0; j < count; j++) {
+                    TableTuple rhs(storage[j], keySchema);
+                    const int expected = lhs.compare(rhs);
+                    ASSERT_EQ(expected < 0, comparator(copy, keys[j]));
+                    ASSERT_EQ(expected == 0, equality(copy, keys[j]));
+                }
+            }
+
+            for (int i = 0; i < count; i++) delete [] storage[i];
+            for (size_t i = 0; i < strings.size(); i++) strings[i].free();
+            TupleSchema::freeTupleSchema(keySchema);
+        }
 };
 
 TEST_F(IndexKeyTest, Int64KeyTest) {
@@ -468,6 +550,118 @@ TEST_F(IndexKeyTest, Int64Packing2Int32sWithSecondNull) {
     voltdb::TupleSchema::freeTupleSchema(keySchema);
 }
 
+TEST_F(IndexKeyTest, NormalizedKeyMaxLength) {
+    std::vector<ValueType> columnTypes;
+    std::vector<int32_t> columnLengths;
+    columnTypes.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    columnTypes.push_back(VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(16);
+    std::vector<bool> columnAllowNull(columnTypes.size(), true);
+    TupleSchema *keySchema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+
+    // 4 bytes for the integer, a null flag plus two groups of 8 bytes and
+    // a marker for the string
+    EXPECT_EQ(4 + 1 + 9 + 9, NormalizedKeyEncoder::maxLength(keySchema));
+
+    TableTuple tuple(keySchema);
+    tuple.move(new char[tuple.tupleLength()]);
+    tuple.setNValue(0, ValueFactory::getIntegerValue(7));
+    NValue value = ValueFactory::getStringValue("abcdefghi");
+    tuple.setNValue(1, value);
+    NormalizedKey<32> key;
+    key.setFromKey(&tuple);
+    const char expected[32] = { (char)0x80, 0, 0, 7, 1,
+                                'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 9,
+                                'i', 0, 0, 0, 0, 0, 0, 0, 1 };
+    EXPECT_EQ(0, ::memcmp(expected, key.data, sizeof(expected)));
+
+    delete [] tuple.address();
+    value.free();
+    TupleSchema::freeTupleSchema(keySchema);
+}
+
+TEST_F(IndexKeyTest, NormalizedKeyOrder) {
+    srand(0);
+    std::vector<ValueType> columnTypes;
+    std::vector<int32_t> columnLengths;
+    columnTypes.push_back(VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(12);
+    columnTypes.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    columnTypes.push_back(VALUE_TYPE_TINYINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_TINYINT));
+    checkNormalizedOrder<NormalizedKey<32>, NormalizedComparator<32>, NormalizedEqualityChecker<32> >(columnTypes, columnLengths);
+
+    columnTypes.clear();
+    columnLengths.clear();
+    columnTypes.push_back(VALUE_TYPE_DOUBLE);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+    columnTypes.push_back(VALUE_TYPE_DECIMAL);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DECIMAL));
+    columnTypes.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    checkNormalizedOrder<NormalizedKey<32>, NormalizedComparator<32>, NormalizedEqualityChecker<32> >(columnTypes, columnLengths);
+}
+
+TEST_F(IndexKeyTest, NormalizedOverflowKeyOrder) {
+    srand(0);
+    std::vector<ValueType> columnTypes;
+    std::vector<int32_t> columnLengths;
+    columnTypes.push_back(VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(300);
+    columnTypes.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    columnTypes.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    checkNormalizedOrder<NormalizedOverflowKey, NormalizedOverflowComparator, NormalizedOverflowEqualityChecker>(columnTypes, columnLengths);
+}
+
+TEST_F(IndexKeyTest, NormalizedOverflowKeyMemory) {
+    std::vector<ValueType> columnTypes(1, VALUE_TYPE_VARCHAR);
+    std::vector<int32_t> columnLengths(1, 300);
+    std::vector<bool> columnAllowNull(1, true);
+    TupleSchema *keySchema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    TableTuple tuple(keySchema);
+    tuple.move(new char[tuple.tupleLength()]);
+    NValue longValue = ValueFactory::getStringValue(std::string(200, 'a'));
+    NValue shortValue = ValueFactory::getStringValue("a");
+
+    int64_t memory = 0;
+    {
+        NormalizedOverflowKey key;
+        key.trackMemory(&memory);
+        tuple.setNValue(0, longValue);
+        key.setFromKey(&tuple);
+        const int64_t length = memory;
+        ASSERT_TRUE(length > NORMALIZED_KEY_PREFIX_LENGTH);
+
+        // copies are counted too, including the ones into empty keys
+        NormalizedOverflowKey copy(key);
+        std::vector<NormalizedOverflowKey> slots(2);
+        slots[0] = key;
+        slots[1] = copy;
+        ASSERT_EQ(4 * length, memory);
+
+        // a shorter key keeps the buffer
+        tuple.setNValue(0, shortValue);
+        key.setFromKey(&tuple);
+        ASSERT_EQ(4 * length, memory);
+    }
+    ASSERT_EQ(0, memory);
+
+    // keys that are not tracked are not counted
+    NormalizedOverflowKey untracked;
+    tuple.setNValue(0, longValue);
+    untracked.setFromKey(&tuple);
+    ASSERT_EQ(0, memory);
+
+    delete [] tuple.address();
+    longValue.free();
+    shortValue.free();
+    TupleSchema::freeTupleSchema(keySchema);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,342 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <vector>
+#include "harness.h"
+#include "common/common.h"
+#include "common/debuglog.h"
+#include "common/TupleSchema.h"
+#include "indexes/indexkey.h"
+#include "indexes/allocatortracker.h"
+#include "indexes/IntsBTree.h"
+#include "stx/btree_map.h"
+
+#define NUM_KEYS 20000
+
+using namespace std;
+using namespace voltdb;
+
+class IntsBTreeTest : public Test {
+public:
+    IntsBTreeTest() : m_memory(0) {
+        srand(0);
+    }
+
+    static inline uint64_t randomWord() {
+        return ((static_cast<uint64_t>(rand()) << 33) ^ (static_cast<uint64_t>(rand()) << 11) ^
+                static_cast<uint64_t>(rand()));
+    }
+
+    static inline double elapsed(const struct timeval &start) {
+        struct timeval end;
+        gettimeofday(&end, NULL);
+        return (static_cast<double>(end.tv_sec - start.tv_sec) +
+                static_cast<double>(end.tv_usec - start.tv_usec) / 1000000.0);
+    }
+
+    int64_t m_memory;
+};
+
+/**
+ * Single word keys against a std::set, including keys that only differ in
+ * the sign bit and enough deletes to empty out whole leaves
+ */
+TEST_F(IntsBTreeTest, SingleWordKeys) {
+    IntsBTree<1> *tree = new IntsBTree<1>(&m_memory);
+    set<uint64_t> expected;
+    const void *value = reinterpret_cast<const void*>(0x1234);
+
+    for (int i = 0; i < 20000; i++) {
+        uint64_t key[1] = { randomWord() % 5000 };
+        if (i % 3 == 0) key[0] |= 0x8000000000000000ULL;
+        bool inserted = expected.insert(key[0]).second;
+        ASSERT_EQ(inserted, tree->insert(key, value));
+    }
+    ASSERT_EQ(expected.size(), tree->size());
+    EXPECT_TRUE(m_memory > 0);
+
+    for (int round = 0; round < 3; round++) {
+        // Full forward and backward scans
+        set<uint64_t>::const_iterator e = expected.begin();
+        for (IntsBTree<1>::Iterator it = tree->begin(); it.atEnd() == false; it.next(), ++e) {
+            ASSERT_TRUE(e != expected.end());
+            ASSERT_EQ(*e, it.word(0));
+        }
+        ASSERT_TRUE(e == expected.end());
+        set<uint64_t>::const_reverse_iterator r = expected.rbegin();
+        for (IntsBTree<1>::Iterator it = tree->rbegin(); it.atEnd() == false; it.prev(), ++r) {
+            ASSERT_TRUE(r != expected.rend());
+            ASSERT_EQ(*r, it.word(0));
+        }
+        ASSERT_TRUE(r == expected.rend());
+
+        // Bounds
+        for (int i = 0; i < 2000; i++) {
+            uint64_t key[1] = { randomWord() % 5000 };
+            if (i % 2 == 0) key[0] |= 0x8000000000000000ULL;
+            set<uint64_t>::const_iterator lower = expected.lower_bound(key[0]);
+            set<uint64_t>::const_iterator upper = expected.upper_bound(key[0]);
+            IntsBTree<1>::Iterator treeLower = tree->lowerBound(key);
+            IntsBTree<1>::Iterator treeUpper = tree->upperBound(key);
+            ASSERT_EQ(lower == expected.end(), treeLower.atEnd());
+            ASSERT_EQ(upper == expected.end(), treeUpper.atEnd());
+            if (lower != expected.end()) ASSERT_EQ(*lower, treeLower.word(0));
+            if (upper != expected.end()) ASSERT_EQ(*upper, treeUpper.word(0));
+            ASSERT_EQ(expected.find(key[0]) != expected.end(), tree->find(key).atEnd() == false);
+        }
+
+        // Remove most of the keys, and all of them in the last round
+        vector<uint64_t> keys(expected.begin(), expected.end());
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (round < 2 && i % 4 == 0) continue;
+            uint64_t key[1] = { keys[i] };
+            ASSERT_TRUE(tree->erase(key));
+            ASSERT_FALSE(tree->erase(key));
+            expected.erase(keys[i]);
+        }
+        ASSERT_EQ(expected.size(), tree->size());
+    }
+    ASSERT_TRUE(tree->begin().atEnd());
+    ASSERT_TRUE(tree->rbegin().atEnd());
+
+    // The tree is still usable once it is empty
+    uint64_t key[1] = { 42 };
+    ASSERT_TRUE(tree->insert(key, value));
+    ASSERT_FALSE(tree->find(key).atEnd());
+    ASSERT_EQ(value, tree->find(key).value());
+    delete tree;
+    ASSERT_EQ(0, m_memory);
+}
+
+/**
+ * Three word keys where many keys share the leading words, like the
+ * entries of a non-unique index (key, key, tuple address)
+ */
+TEST_F(IntsBTreeTest, MultiWordKeys) {
+    typedef vector<uint64_t> Key;
+    IntsBTree<3> *tree = new IntsBTree<3>(&m_memory);
+    map<Key, const void*> expected;
+
+    for (int i = 0; i < 30000; i++) {
+        Key key(3);
+        key[0] = randomWord() % 4;
+        key[1] = randomWord() % 8;
+        key[2] = randomWord();
+        const void *value = reinterpret_cast<const void*>(static_cast<uintptr_t>(i + 1));
+        bool inserted = expected.insert(make_pair(key, value)).second;
+        ASSERT_EQ(inserted, tree->insert(&key[0], value));
+        if (i % 5 == 0) {
+            // delete something that is there
+            Key victim = expected.begin()->first;
+            if (i % 10 == 0) victim = expected.rbegin()->first;
+            ASSERT_TRUE(tree->erase(&victim[0]));
+            expected.erase(victim);
+        }
+    }
+    ASSERT_EQ(expected.size(), tree->size());
+
+    map<Key, const void*>::const_iterator e = expected.begin();
+    for (IntsBTree<3>::Iterator it = tree->begin(); it.atEnd() == false; it.next(), ++e) {
+        ASSERT_TRUE(e != expected.end());
+        ASSERT_EQ(e->first[0], it.word(0));
+        ASSERT_EQ(e->first[1], it.word(1));
+        ASSERT_EQ(e->first[2], it.word(2));
+        ASSERT_EQ(e->second, it.value());
+    }
+    ASSERT_TRUE(e == expected.end());
+
+    // Prefix searches, the way the index looks for the first and the last
+    // entry of a key
+    for (uint64_t a = 0; a < 5; a++) {
+        for (uint64_t b = 0; b < 9; b++) {
+            Key first(3), last(3);
+            first[0] = last[0] = a;
+            first[1] = last[1] = b;
+            first[2] = 0;
+            last[2] = UINT64_MAX;
+            map<Key, const void*>::const_iterator lower = expected.lower_bound(first);
+            map<Key, const void*>::const_iterator upper = expected.upper_bound(last);
+            IntsBTree<3>::Iterator treeLower = tree->lowerBound(&first[0]);
+            IntsBTree<3>::Iterator treeUpper = tree->upperBound(&last[0]);
+            ASSERT_EQ(lower == expected.end(), treeLower.atEnd());
+            ASSERT_EQ(upper == expected.end(), treeUpper.atEnd());
+            if (lower != expected.end()) ASSERT_EQ(lower->second, treeLower.value());
+            if (upper != expected.end()) ASSERT_EQ(upper->second, treeUpper.value());
+        }
+    }
+    delete tree;
+}
+
+/**
+ * A bulk loaded tree must be the same as one built by inserts, for sizes
+ * around the leaf and inner node capacities, and keep working afterwards
+ */
+TEST_F(IntsBTreeTest, BulkLoad) {
+    typedef IntsBTree<2> TreeType;
+    const size_t sizes[] = { 0, 1, 5, TreeType::LEAF_SLOTS, TreeType::LEAF_SLOTS + 1,
+                             TreeType::LEAF_SLOTS * (TreeType::INNER_SLOTS + 1) + 1, 100000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const size_t count = sizes[s];
+        vector<uint64_t> keys;
+        vector<const void*> values;
+        map<vector<uint64_t>, const void*> expected;
+        for (size_t i = 0; i < count; i++) {
+            // even second words, so that there is room to insert in between
+            keys.push_back(i / 7);
+            keys.push_back((i % 7) * 2);
+            values.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(i + 1)));
+            expected[vector<uint64_t>(keys.end() - 2, keys.end())] = values.back();
+        }
+        TreeType *tree = new TreeType(&m_memory);
+        tree->bulkLoad(count == 0 ? NULL : &keys[0], count == 0 ? NULL : &values[0], count);
+        ASSERT_EQ(count, tree->size());
+
+        for (int i = 0; i < 2000; i++) {
+            vector<uint64_t> key(2);
+            key[0] = randomWord() % (count / 7 + 2);
+            key[1] = randomWord() % 14;
+            const void *value = reinterpret_cast<const void*>(static_cast<uintptr_t>(count + i + 1));
+            if (i % 3 == 0) {
+                ASSERT_EQ(expected.erase(key) == 1, tree->erase(&key[0]));
+            } else {
+                bool inserted = expected.insert(make_pair(key, value)).second;
+                ASSERT_EQ(inserted, tree->insert(&key[0], value));
+            }
+        }
+        ASSERT_EQ(expected.size(), tree->size());
+
+        map<vector<uint64_t>, const void*>::const_iterator e = expected.begin();
+        for (TreeType::Iterator it = tree->begin(); it.atEnd() == false; it.next(), ++e) {
+            ASSERT_TRUE(e != expected.end());
+            ASSERT_EQ(e->first[0], it.word(0));
+            ASSERT_EQ(e->first[1], it.word(1));
+            ASSERT_EQ(e->second, it.value());
+            ASSERT_TRUE(tree->find(&e->first[0]) == it);
+        }
+        ASSERT_TRUE(e == expected.end());
+        map<vector<uint64_t>, const void*>::const_reverse_iterator r = expected.rbegin();
+        for (TreeType::Iterator it = tree->rbegin(); it.atEnd() == false; it.prev(), ++r) {
+            ASSERT_TRUE(r != expected.rend());
+            ASSERT_EQ(r->second, it.value());
+        }
+        ASSERT_TRUE(r == expected.rend());
+        delete tree;
+    }
+    EXPECT_EQ(0, m_memory);
+}
+
+/**
+ * Run the same operations against the stx::btree_map that the BinaryTree
+ * indexes use, with the same IntsKey, comparator and tracking allocator
+ */
+TEST_F(IntsBTreeTest, CompareWithStx) {
+    typedef h_index::AllocatorTracker<pair<const IntsKey<1>, const void*> > AllocatorType;
+    typedef stx::btree_map<IntsKey<1>, const void*, IntsComparator<1>,
+                           stx::btree_default_map_traits<IntsKey<1>, const void*>, AllocatorType> MapType;
+
+    vector<IntsKey<1> > keys(NUM_KEYS);
+    for (int i = 0; i < NUM_KEYS; i++) {
+        keys[i].data[0] = randomWord();
+    }
+    const void *value = reinterpret_cast<const void*>(0x1234);
+    struct timeval start;
+    double seconds[2][4];
+    size_t found[2] = { 0, 0 };
+    int64_t memory[2] = { 0, 0 };
+
+    // stx
+    {
+        AllocatorType allocator(&memory[0]);
+        MapType *stx = new MapType(IntsComparator<1>(NULL), allocator);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            stx->insert(pair<IntsKey<1>, const void*>(keys[i], value));
+        }
+        seconds[0][0] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = NUM_KEYS - 1; i >= 0; i--) {
+            found[0] += (stx->find(keys[i]) != stx->end());
+        }
+        seconds[0][1] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i += 100) {
+            MapType::const_iterator it = stx->lower_bound(keys[i]);
+            for (int j = 0; j < 100 && it != stx->end(); j++, ++it) found[0] += (it->second != NULL);
+        }
+        seconds[0][2] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            stx->erase(keys[i]);
+        }
+        seconds[0][3] = elapsed(start);
+        delete stx;
+    }
+
+    // IntsBTree
+    {
+        IntsBTree<1> *tree = new IntsBTree<1>(&memory[1]);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            tree->insert(keys[i].data, value);
+        }
+        seconds[1][0] = elapsed(start);
+        int64_t peak = memory[1];
+        gettimeofday(&start, NULL);
+        for (int i = NUM_KEYS - 1; i >= 0; i--) {
+            found[1] += (tree->find(keys[i].data).atEnd() == false);
+        }
+        seconds[1][1] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i += 100) {
+            IntsBTree<1>::Iterator it = tree->lowerBound(keys[i].data);
+            for (int j = 0; j < 100 && it.atEnd() == false; j++, it.next()) found[1] += (it.value() != NULL);
+        }
+        seconds[1][2] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            tree->erase(keys[i].data);
+        }
+        seconds[1][3] = elapsed(start);
+        EXPECT_EQ(0, tree->size());
+        delete tree;
+        memory[1] = peak;
+    }
+
+    EXPECT_TRUE(found[0] > NUM_KEYS);
+    EXPECT_EQ(found[0], found[1]);
+    const char *names[4] = { "insert", "find", "scan", "erase" };
+    for (int op = 0; op < 4; op++) {
+        VOLT_INFO("%s of %d keys: stx %.6f s, IntsBTree %.6f s", names[op], NUM_KEYS, seconds[0][op], seconds[1][op]);
+    }
+    VOLT_INFO("IntsBTree peak memory: %ld bytes", (long)memory[1]);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,274 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include "harness.h"
+#include "common/common.h"
+#include "common/debuglog.h"
+#include "common/TupleSchema.h"
+#include "indexes/indexkey.h"
+#include "indexes/allocatortracker.h"
+#include "indexes/IntsHashTable.h"
+#include "boost/unordered_map.hpp"
+
+#define NUM_KEYS 20000
+
+using namespace std;
+using namespace voltdb;
+
+class IntsHashTableTest : public Test {
+public:
+    IntsHashTableTest() : m_memory(0) {
+        srand(0);
+    }
+
+    static inline uint64_t randomWord() {
+        return ((static_cast<uint64_t>(rand()) << 33) ^ (static_cast<uint64_t>(rand()) << 11) ^
+                static_cast<uint64_t>(rand()));
+    }
+
+    static inline const void* toValue(uint64_t i) {
+        return reinterpret_cast<const void*>(static_cast<uintptr_t>(i + 1));
+    }
+
+    static inline double elapsed(const struct timeval &start) {
+        struct timeval end;
+        gettimeofday(&end, NULL);
+        return (static_cast<double>(end.tv_sec - start.tv_sec) +
+                static_cast<double>(end.tv_usec - start.tv_usec) / 1000000.0);
+    }
+
+    int64_t m_memory;
+};
+
+/**
+ * Random inserts, updates and deletes of two word keys against a std::map.
+ * The key range is small so that the same keys keep coming back after
+ * being deleted, which leaves tombstones behind in the table.
+ */
+TEST_F(IntsHashTableTest, RandomOperations) {
+    IntsHashTable<2> *table = new IntsHashTable<2>(&m_memory);
+    map<pair<uint64_t, uint64_t>, const void*> expected;
+
+    for (int i = 0; i < 200000; i++) {
+        uint64_t key[2] = { randomWord() % 100, randomWord() % 500 };
+        pair<uint64_t, uint64_t> mapKey(key[0], key[1]);
+        switch (rand() % 4) {
+            case 0:
+            case 1: {
+                bool inserted = expected.insert(make_pair(mapKey, toValue(i))).second;
+                ASSERT_EQ(inserted, table->insert(key, toValue(i)));
+                break;
+            }
+            case 2: {
+                ASSERT_EQ(expected.erase(mapKey) == 1, table->erase(key));
+                break;
+            }
+            default: {
+                bool exists = (expected.find(mapKey) != expected.end());
+                if (exists) expected[mapKey] = toValue(i);
+                ASSERT_EQ(exists, table->update(key, toValue(i)));
+            }
+        }
+        ASSERT_EQ(expected.size(), table->size());
+    }
+
+    for (uint64_t a = 0; a < 100; a++) {
+        for (uint64_t b = 0; b < 500; b++) {
+            uint64_t key[2] = { a, b };
+            map<pair<uint64_t, uint64_t>, const void*>::const_iterator it = expected.find(make_pair(a, b));
+            ASSERT_TRUE(table->find(key) == (it == expected.end() ? NULL : it->second));
+        }
+    }
+    EXPECT_TRUE(table->loadFactor() <= 0.875);
+
+    delete table;
+    EXPECT_EQ(0, m_memory);
+}
+
+/**
+ * A resize moves a bounded number of entries per operation, every key
+ * can still be found while both tables are live, and the old table is
+ * gone long before the new one fills up
+ */
+TEST_F(IntsHashTableTest, IncrementalResize) {
+    IntsHashTable<1> *table = new IntsHashTable<1>(&m_memory);
+    uint64_t next = 0;
+    int resizes = 0;
+
+    while (table->capacity() < 100000) {
+        size_t capacity = table->capacity();
+        uint64_t key[1] = { next };
+        ASSERT_TRUE(table->insert(key, toValue(next)));
+        next++;
+        if (table->capacity() == capacity) continue;
+
+        // the new table has just been started, but a table with only a
+        // few groups is drained by the same insert
+        resizes++;
+        ASSERT_TRUE(table->isResizing() || capacity <= 64);
+        uint64_t started = next;
+        while (table->isResizing()) {
+            key[0] = next;
+            ASSERT_TRUE(table->insert(key, toValue(next)));
+            next++;
+            // half way through, everything must still be reachable
+            if (next - started == capacity / 128) {
+                for (uint64_t i = 0; i < next; i++) {
+                    key[0] = i;
+                    ASSERT_TRUE(table->find(key) == toValue(i));
+                }
+            }
+        }
+        EXPECT_TRUE(next - started <= capacity / 32);
+        EXPECT_EQ(capacity * 2, table->capacity());
+    }
+    EXPECT_TRUE(resizes > 5);
+    EXPECT_EQ(next, table->size());
+
+    for (uint64_t i = 0; i < next; i++) {
+        uint64_t key[1] = { i };
+        ASSERT_TRUE(table->find(key) == toValue(i));
+    }
+
+    // reserve() does all of its work right away
+    table->reserve(table->capacity() * 4);
+    EXPECT_FALSE(table->isResizing());
+    for (uint64_t i = 0; i < next; i++) {
+        uint64_t key[1] = { i };
+        ASSERT_TRUE(table->erase(key));
+    }
+    EXPECT_EQ(0, table->size());
+
+    delete table;
+    EXPECT_EQ(0, m_memory);
+}
+
+/**
+ * The memory estimate is exactly the size of the live allocations: one
+ * control byte plus one slot (the key words and the tuple pointer) per
+ * entry of capacity, plus the alignment padding
+ */
+TEST_F(IntsHashTableTest, MemoryEstimate) {
+    IntsHashTable<3> *table = new IntsHashTable<3>(&m_memory);
+    const int64_t slotSize = 1 + 3 * sizeof(uint64_t) + sizeof(void*);
+    EXPECT_EQ(static_cast<int64_t>(table->capacity()) * slotSize + 64, m_memory);
+
+    for (uint64_t i = 0; i < 10000; i++) {
+        uint64_t key[3] = { i, i * 7, i * 13 };
+        table->insert(key, toValue(i));
+        int64_t expected = static_cast<int64_t>(table->capacity()) * slotSize + 64;
+        if (table->isResizing()) {
+            expected += static_cast<int64_t>(table->capacity() / 2) * slotSize + 64;
+        }
+        ASSERT_EQ(expected, m_memory);
+    }
+
+    delete table;
+    EXPECT_EQ(0, m_memory);
+}
+
+/**
+ * Run the same operations against the boost::unordered_map that
+ * HashTableUniqueIndex uses for the same keys
+ */
+TEST_F(IntsHashTableTest, CompareWithBoost) {
+    typedef h_index::AllocatorTracker<pair<const IntsKey<1>, const void*> > AllocatorType;
+    typedef boost::unordered_map<IntsKey<1>, const void*, IntsHasher<1>, IntsEqualityChecker<1>, AllocatorType> MapType;
+
+    vector<IntsKey<1> > keys(NUM_KEYS);
+    for (int i = 0; i < NUM_KEYS; i++) {
+        keys[i].data[0] = randomWord();
+    }
+    const void *value = reinterpret_cast<const void*>(0x1234);
+    struct timeval start;
+    double seconds[2][3];
+    size_t found[2] = { 0, 0 };
+    int64_t memory[2] = { 0, 0 };
+
+    // boost
+    {
+        AllocatorType allocator(&memory[0]);
+        MapType *boost = new MapType(100, IntsHasher<1>(NULL), IntsEqualityChecker<1>(NULL), allocator);
+        boost->max_load_factor(.75f);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            boost->insert(pair<IntsKey<1>, const void*>(keys[i], value));
+        }
+        seconds[0][0] = elapsed(start);
+        int64_t peak = memory[0];
+        gettimeofday(&start, NULL);
+        for (int i = NUM_KEYS - 1; i >= 0; i--) {
+            found[0] += (boost->find(keys[i]) != boost->end());
+        }
+        seconds[0][1] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            boost->erase(keys[i]);
+        }
+        seconds[0][2] = elapsed(start);
+        delete boost;
+        memory[0] = peak;
+    }
+
+    // IntsHashTable
+    {
+        IntsHashTable<1> *table = new IntsHashTable<1>(&memory[1]);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            table->insert(keys[i].data, value);
+        }
+        seconds[1][0] = elapsed(start);
+        int64_t peak = memory[1];
+        gettimeofday(&start, NULL);
+        for (int i = NUM_KEYS - 1; i >= 0; i--) {
+            found[1] += (table->find(keys[i].data) != NULL);
+        }
+        seconds[1][1] = elapsed(start);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            table->erase(keys[i].data);
+        }
+        seconds[1][2] = elapsed(start);
+        EXPECT_EQ(0, table->size());
+        delete table;
+        memory[1] = peak;
+    }
+
+    EXPECT_EQ(NUM_KEYS, found[0]);
+    EXPECT_EQ(found[0], found[1]);
+    const char *names[3] = { "insert", "find", "erase" };
+    for (int op = 0; op < 3; op++) {
+        VOLT_INFO("%s of %d keys: boost %.6f s, IntsHashTable %.6f s", names[op], NUM_KEYS, seconds[0][op], seconds[1][op]);
+    }
+    VOLT_INFO("memory: boost %ld bytes, IntsHashTable %ld bytes", (long)memory[0], (long)memory[1]);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
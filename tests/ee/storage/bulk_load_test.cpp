@@ -0,0 +1,300 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/debuglog.h"
+#include "common/executorcontext.hpp"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/serializeio.h"
+#include "common/DummyUndoQuantum.hpp"
+#include "storage/table.h"
+#include "storage/persistenttable.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define NUM_RESTORE_ROWS 20000
+
+class BulkLoadTest : public Test {
+public:
+    BulkLoadTest() {
+        srand(0);
+        m_undo = new DummyUndoQuantum();
+        m_context = new ExecutorContext(0, 0, m_undo, NULL, false, 0, "", 0);
+
+        // (ID BIGINT, NAME VARCHAR(32), GRP INTEGER)
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        vector<bool> allowNull(3, false);
+        types.push_back(VALUE_TYPE_BIGINT); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        types.push_back(VALUE_TYPE_VARCHAR); lengths.push_back(32);
+        types.push_back(VALUE_TYPE_INTEGER); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        m_schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        for (int i = 0; i < 3; i++) {
+            m_columnNames[i] = string("C") + static_cast<char>('0' + i);
+        }
+
+        // primary key on ID, unique tree on NAME, non-unique tree on GRP
+        m_pkeyScheme = scheme("pkey", 0, VALUE_TYPE_BIGINT, true, true);
+        m_indexSchemes.push_back(scheme("name", 1, VALUE_TYPE_VARCHAR, true, false));
+        m_indexSchemes.push_back(scheme("grp", 2, VALUE_TYPE_INTEGER, false, true));
+    }
+
+    ~BulkLoadTest() {
+        for (size_t i = 0; i < m_tables.size(); i++) {
+            delete m_tables[i];
+        }
+        delete m_context;
+        delete m_undo;
+        TupleSchema::freeTupleSchema(m_schema);
+    }
+
+    TableIndexScheme scheme(string name, int column, ValueType type, bool unique, bool intsOnly) {
+        vector<int32_t> columns(1, column);
+        vector<ValueType> types(1, type);
+        return TableIndexScheme(name, BALANCED_TREE_INDEX, columns, types, unique, intsOnly, m_schema);
+    }
+
+    PersistentTable* createTable() {
+        Table *table = TableFactory::getPersistentTable(0, m_context, "T", TupleSchema::createTupleSchema(m_schema),
+                                                        m_columnNames, m_pkeyScheme, m_indexSchemes, 0,
+                                                        false, false);
+        m_tables.push_back(table);
+        return dynamic_cast<PersistentTable*>(table);
+    }
+
+    static string name(int64_t id) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "customer#%012ld", (long)id);
+        return string(buffer);
+    }
+
+    /** Rows with the given ids in random order, serialized like a snapshot */
+    void serializeRows(int64_t first, int64_t count, CopySerializeOutput &out) {
+        vector<int64_t> ids;
+        for (int64_t id = first; id < first + count; id++) {
+            ids.push_back(id);
+        }
+        for (size_t i = ids.size(); i > 1; i--) {
+            swap(ids[i - 1], ids[rand() % i]);
+        }
+        serializeRows(ids, out);
+    }
+
+    /** Rows with the given ids in that order. The ids may repeat. */
+    void serializeRows(const vector<int64_t> &ids, CopySerializeOutput &out) {
+        int memory = 0;
+        TempTable *source = TableFactory::getTempTable(0, "SOURCE", TupleSchema::createTupleSchema(m_schema),
+                                                       m_columnNames, &memory);
+        m_tables.push_back(source);
+        TableTuple &tuple = source->tempTuple();
+        for (size_t i = 0; i < ids.size(); i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(ids[i]));
+            NValue value = ValueFactory::getStringValue(name(ids[i]));
+            tuple.setNValue(1, value);
+            value.free();
+            tuple.setNValue(2, ValueFactory::getIntegerValue(static_cast<int32_t>(ids[i] % 100)));
+            source->insertTuple(tuple);
+        }
+        source->serializeTo(out);
+    }
+
+    static void load(Table *table, const CopySerializeOutput &out) {
+        ReferenceSerializeInput in(out.data() + sizeof(int32_t), out.size() - sizeof(int32_t));
+        table->loadTuplesFrom(false, in, NULL);
+    }
+
+    /** Every row can be found through every index, and the scans are ordered */
+    void checkIndexes(PersistentTable *table, int64_t rows) {
+        ASSERT_EQ(rows, table->activeTupleCount());
+        vector<TableIndex*> indexes = table->allIndexes();
+        ASSERT_EQ(3, indexes.size());
+        for (size_t i = 0; i < indexes.size(); i++) {
+            ASSERT_EQ(rows, indexes[i]->getSize());
+        }
+
+        TableIterator iter(table);
+        TableTuple tuple(table->schema());
+        while (iter.next(tuple)) {
+            for (size_t i = 0; i < indexes.size(); i++) {
+                ASSERT_TRUE(indexes[i]->exists(&tuple));
+            }
+            ASSERT_TRUE(table->primaryKeyIndex()->moveToTuple(&tuple));
+            ASSERT_EQ(tuple.address(), table->primaryKeyIndex()->nextValueAtKey().address());
+        }
+
+        for (size_t i = 0; i < indexes.size(); i++) {
+            const int column = indexes[i]->getColumnIndices()[0];
+            indexes[i]->moveToEnd(true);
+            TableTuple previous;
+            int64_t count = 0;
+            while (!(tuple = indexes[i]->nextValue()).isNullTuple()) {
+                if (count++ > 0) {
+                    ASSERT_TRUE(previous.getNValue(column).compare(tuple.getNValue(column)) <= 0);
+                }
+                previous = tuple;
+            }
+            ASSERT_EQ(rows, count);
+        }
+    }
+
+    static inline double elapsed(const struct timeval &start) {
+        struct timeval end;
+        gettimeofday(&end, NULL);
+        return (static_cast<double>(end.tv_sec - start.tv_sec) +
+                static_cast<double>(end.tv_usec - start.tv_usec) / 1000000.0);
+    }
+
+    UndoQuantum *m_undo;
+    ExecutorContext *m_context;
+    TupleSchema *m_schema;
+    string m_columnNames[3];
+    TableIndexScheme m_pkeyScheme;
+    vector<TableIndexScheme> m_indexSchemes;
+    vector<Table*> m_tables;
+};
+
+/**
+ * Loading into empty indexes goes through the bulk build, and a second
+ * load into the now filled indexes adds the entries one by one
+ */
+TEST_F(BulkLoadTest, LoadTwice) {
+    CopySerializeOutput first, second;
+    serializeRows(0, 70000, first);
+    serializeRows(70000, 5000, second);
+
+    PersistentTable *table = createTable();
+    load(table, first);
+    checkIndexes(table, 70000);
+    load(table, second);
+    checkIndexes(table, 75000);
+}
+
+/**
+ * A load with rows that violate a unique index keeps the first of them in
+ * that index, like inserting the entries one at a time does
+ */
+TEST_F(BulkLoadTest, DuplicateKeys) {
+    vector<int64_t> ids;
+    for (int64_t id = 0; id < 100; id++) {
+        ids.push_back(id);
+        if (id % 10 == 0) {
+            ids.push_back(id);
+        }
+    }
+    CopySerializeOutput out;
+    serializeRows(ids, out);
+
+    // into empty indexes
+    PersistentTable *table = createTable();
+    load(table, out);
+    EXPECT_EQ(110, table->activeTupleCount());
+    EXPECT_EQ(100, table->primaryKeyIndex()->getSize());
+    EXPECT_EQ(100, table->index("name")->getSize());
+    EXPECT_EQ(110, table->index("grp")->getSize());
+
+    TableIterator iter(table);
+    TableTuple tuple(table->schema());
+    int64_t expected = 0;
+    while (iter.next(tuple)) {
+        const int64_t id = ValuePeeker::peekBigInt(tuple.getNValue(0));
+        ASSERT_TRUE(table->primaryKeyIndex()->moveToTuple(&tuple));
+        TableTuple entry = table->primaryKeyIndex()->nextValueAtKey();
+        if (id == expected) {
+            ASSERT_EQ(tuple.address(), entry.address());
+            expected++;
+        } else {
+            ASSERT_TRUE(tuple.address() != entry.address());
+        }
+    }
+    ASSERT_EQ(100, expected);
+
+    // into indexes that already have the keys
+    load(table, out);
+    EXPECT_EQ(220, table->activeTupleCount());
+    EXPECT_EQ(100, table->primaryKeyIndex()->getSize());
+    EXPECT_EQ(220, table->index("grp")->getSize());
+}
+
+/**
+ * Restore a table with three indexes from its serialized form and add the
+ * same tuples to fresh copies of each index one at a time. The indexes must
+ * end up the same size; the time each way takes is logged at the INFO level.
+ */
+TEST_F(BulkLoadTest, MatchesPerTupleInserts) {
+    const int64_t rows = NUM_RESTORE_ROWS;
+    CopySerializeOutput out;
+    serializeRows(0, rows, out);
+
+    struct timeval start;
+    gettimeofday(&start, NULL);
+    PersistentTable *table = createTable();
+    load(table, out);
+    const double restore = elapsed(start);
+    ASSERT_EQ(rows, table->activeTupleCount());
+
+    // what each index did before: one addEntry() per tuple
+    vector<const void*> tuples;
+    TableIterator iter(table);
+    TableTuple tuple(table->schema());
+    while (iter.next(tuple)) {
+        tuples.push_back(tuple.address());
+    }
+    vector<TableIndex*> indexes = table->allIndexes();
+    double perTuple = 0;
+    for (size_t i = 0; i < indexes.size(); i++) {
+        TableIndex *index = TableIndexFactory::getInstance(indexes[i]->getScheme());
+        gettimeofday(&start, NULL);
+        for (size_t j = 0; j < tuples.size(); j++) {
+            tuple.move(const_cast<void*>(tuples[j]));
+            index->addEntry(&tuple);
+        }
+        perTuple += elapsed(start);
+        EXPECT_EQ(indexes[i]->getSize(), index->getSize());
+        delete index;
+    }
+
+    VOLT_INFO("restore of %ld rows with %d indexes: %.3f s, index entries added one at a time: %.3f s",
+              (long)rows, (int)indexes.size(), restore, perTuple);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,147 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * Checks the columnar SeqScan filter against a plain scan. The same
+ * predicate is evaluated over the same table with:
+ *
+ *   (1) a TableIterator and AbstractExpression::eval() per tuple
+ *   (2) the ColumnarScanFilter with its scalar loops
+ *   (3) the ColumnarScanFilter with its SIMD kernels
+ *
+ * The test fails if the three disagree on the result. The time each one
+ * takes is logged at the INFO level.
+ */
+
+#include <sys/time.h>
+#include "harness.h"
+#include "common/common.h"
+#include "common/debuglog.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/expressions.h"
+#include "expressions/expressionutil.h"
+#include "executors/columnarscanfilter.h"
+#include "storage/table.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+#define NUM_TUPLES 20000
+
+using namespace voltdb;
+
+class ColumnarScanTest : public Test {
+public:
+    ColumnarScanTest() {
+        std::string columnNames[4] = { "id", "val_int", "val_double", "val_tiny" };
+        std::vector<ValueType> columnTypes;
+        columnTypes.push_back(VALUE_TYPE_BIGINT);
+        columnTypes.push_back(VALUE_TYPE_INTEGER);
+        columnTypes.push_back(VALUE_TYPE_DOUBLE);
+        columnTypes.push_back(VALUE_TYPE_TINYINT);
+        std::vector<int32_t> columnLengths;
+        std::vector<bool> columnAllowNull;
+        for (int ctr = 0; ctr < 4; ctr++) {
+            columnLengths.push_back(NValue::getTupleStorageSize(columnTypes[ctr]));
+            columnAllowNull.push_back(true);
+        }
+        TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+        m_table = TableFactory::getTempTable(1000, "columnar_table", schema, columnNames, NULL);
+        m_table->enableColumnarStore();
+
+        srand(0);
+        for (int64_t i = 0; i < NUM_TUPLES; ++i) {
+            TableTuple &tuple = m_table->tempTuple();
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+            tuple.setNValue(1, ValueFactory::getIntegerValue(rand() % 1000));
+            tuple.setNValue(2, ValueFactory::getDoubleValue(static_cast<double>(rand() % 10000) / 10.0));
+            tuple.setNValue(3, ValueFactory::getTinyIntValue(static_cast<int8_t>(rand() % 100)));
+            m_table->insertTuple(tuple);
+        }
+    }
+
+    ~ColumnarScanTest() {
+        delete m_table;
+    }
+
+    /**
+     * Scan the table with the given predicate and return the number of matches
+     */
+    int64_t scan(AbstractExpression *predicate, int mode, const char *name) {
+        struct timeval start, end;
+        TableTuple tuple(m_table->schema());
+        int64_t matches = 0;
+
+        gettimeofday(&start, NULL);
+        if (mode == 0) {
+            TableIterator iterator = m_table->tableIterator();
+            while (iterator.next(tuple)) {
+                if (predicate->eval(&tuple, NULL).isTrue()) matches++;
+            }
+        } else {
+            ColumnarScanFilter filter;
+            filter.setVectorized(mode == 2);
+            if (filter.init(m_table, predicate) == false) return (-1);
+            while (filter.next(tuple)) matches++;
+        }
+        gettimeofday(&end, NULL);
+
+        double seconds = static_cast<double>(end.tv_sec - start.tv_sec) +
+                         static_cast<double>(end.tv_usec - start.tv_usec) / 1000000.0;
+        VOLT_INFO("%s scan of %d tuples: %.6f s [matches=%ld]", name, NUM_TUPLES, seconds, (long)matches);
+        return (matches);
+    }
+
+    Table *m_table;
+};
+
+TEST_F(ColumnarScanTest, FilterModes) {
+    // WHERE val_int < 100 AND val_double >= 250.0 AND val_tiny <> 7
+    AbstractExpression *predicate = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+        conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                              new TupleValueExpression(1, std::string("columnar_table"), std::string("val_int")),
+                              constantValueFactory(ValueFactory::getBigIntValue(100))),
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                              new TupleValueExpression(2, std::string("columnar_table"), std::string("val_double")),
+                              constantValueFactory(ValueFactory::getDoubleValue(250.0)))),
+        comparisonFactory(EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                          new TupleValueExpression(3, std::string("columnar_table"), std::string("val_tiny")),
+                          constantValueFactory(ValueFactory::getBigIntValue(7))));
+
+    int64_t expected = scan(predicate, 0, "row");
+    int64_t scalar = scan(predicate, 1, "columnar");
+    int64_t vectorized = scan(predicate, 2, "simd");
+    EXPECT_TRUE(expected > 0);
+    EXPECT_EQ(expected, scalar);
+    EXPECT_EQ(expected, vectorized);
+    delete predicate;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
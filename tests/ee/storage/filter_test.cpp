@@ -58,6 +58,7 @@
 #include "expressions/abstractexpression.h"
 #include "expressions/expressions.h"
 #include "expressions/expressionutil.h"
+#include "executors/columnarscanfilter.h"
 #include "storage/temptable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
@@ -322,9 +323,142 @@ TEST_F(FilterTest, SubstituteFilter) {
     delete predicate;
 }
 
+/*
+ * Scan the table with a ColumnarScanFilter and make sure that we get
+ * back exactly the tuples that the expression itself would accept
+ */
+static bool checkColumnarFilter(Table *table, AbstractExpression *predicate, int &count, bool vectorized = true) {
+    std::vector<char*> expected;
+    TableIterator iter = table->tableIterator();
+    TableTuple match(table->schema());
+    while (iter.next(match)) {
+        if (predicate->eval(&match, NULL).isTrue()) {
+            expected.push_back(match.address());
+        }
+    }
+
+    ColumnarScanFilter filter;
+    filter.setVectorized(vectorized);
+    if (filter.init(table, predicate) == false) {
+        return (false);
+    }
+    std::vector<char*> actual;
+    while (filter.next(match)) {
+        actual.push_back(match.address());
+    }
+    count = static_cast<int>(actual.size());
+    return (expected == actual && filter.getScannedCount() == table->activeTupleCount());
+}
+
+TEST_F(FilterTest, ColumnarFilter) {
+    std::string columnNames[4] = { "id", "val_int", "val_double", "val_tiny" };
+    std::vector<voltdb::ValueType> columnTypes;
+    columnTypes.push_back(voltdb::VALUE_TYPE_BIGINT);
+    columnTypes.push_back(voltdb::VALUE_TYPE_INTEGER);
+    columnTypes.push_back(voltdb::VALUE_TYPE_DOUBLE);
+    columnTypes.push_back(voltdb::VALUE_TYPE_TINYINT);
+    std::vector<int32_t> columnLengths;
+    std::vector<bool> columnAllowNull;
+    for (int ctr = 0; ctr < 4; ctr++) {
+        columnLengths.push_back(NValue::getTupleStorageSize(columnTypes[ctr]));
+        columnAllowNull.push_back(true);
+    }
+    TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    Table *columnar = TableFactory::getTempTable(1000, "columnar_table", schema, columnNames, NULL);
+    columnar->enableColumnarStore();
+    ASSERT_TRUE(columnar->columnarStore() != NULL);
+
+    for (int round = 0; round < 2; round++) {
+        // The second round reuses the same blocks with different values,
+        // so stale column arrays would give us the wrong answer
+        columnar->deleteAllTuples(true);
+        for (int64_t i = 1; i <= TUPLES; ++i) {
+            TableTuple &tuple = columnar->tempTuple();
+            tuple.setNValue(0, ValueFactory::getBigIntValue(i + round));
+            if (i % 10 == 0) {
+                tuple.setNValue(1, NValue::getNullValue(VALUE_TYPE_INTEGER));
+                tuple.setNValue(2, NValue::getNullValue(VALUE_TYPE_DOUBLE));
+            } else {
+                tuple.setNValue(1, ValueFactory::getIntegerValue(static_cast<int32_t>((i * 7 + round) % 100)));
+                tuple.setNValue(2, ValueFactory::getDoubleValue(static_cast<double>(i) / 4.0));
+            }
+            tuple.setNValue(3, ValueFactory::getTinyIntValue(static_cast<int8_t>(i % 5)));
+            columnar->insertTuple(tuple);
+        }
+
+        const ExpressionType ops[] = { EXPRESSION_TYPE_COMPARE_EQUAL,
+                                       EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                       EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                       EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                       EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                       EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO };
+        for (int op = 0; op < 6; op++) {
+            for (int col = 0; col < 4; col++) {
+                for (int reversed = 0; reversed < 2; reversed++) {
+                    // Compare against an integer, a double, an out-of-range
+                    // integer and a NULL constant
+                    for (int kind = 0; kind < 4; kind++) {
+                        NValue constant;
+                        switch (kind) {
+                            case 0: constant = ValueFactory::getBigIntValue(3); break;
+                            case 1: constant = ValueFactory::getDoubleValue(42.25); break;
+                            case 2: constant = ValueFactory::getBigIntValue(-5000000000LL); break;
+                            default: constant = NValue::getNullValue(VALUE_TYPE_BIGINT); break;
+                        }
+                        AbstractExpression *tve = new TupleValueExpression(col, std::string("columnar_table"), columnNames[col]);
+                        AbstractExpression *cve = constantValueFactory(constant);
+                        AbstractExpression *predicate = (reversed ? comparisonFactory(ops[op], cve, tve) :
+                                                                    comparisonFactory(ops[op], tve, cve));
+                        int count = 0;
+                        EXPECT_TRUE(checkColumnarFilter(columnar, predicate, count, true));
+                        EXPECT_TRUE(checkColumnarFilter(columnar, predicate, count, false));
+                        delete predicate;
+                    }
+                }
+            }
+        }
+
+        // WHERE val_int = $1
+        AbstractExpression *predicate = comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                                          new TupleValueExpression(1, std::string("columnar_table"), columnNames[1]),
+                                                          parameterValueFactory(0));
+        NValueArray params(1);
+        params[0] = ValueFactory::getBigIntValue(35);
+        predicate->substitute(params);
+        int count = 0;
+        EXPECT_TRUE(checkColumnarFilter(columnar, predicate, count));
+        EXPECT_TRUE(count > 0);
+        delete predicate;
+
+        // WHERE (val_int > 20 AND val_double <= 300.5) OR val_tiny = 4 OR id < 10
+        AbstractExpression *left = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                              new TupleValueExpression(1, std::string("columnar_table"), columnNames[1]),
+                              constantValueFactory(ValueFactory::getBigIntValue(20))),
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                              new TupleValueExpression(2, std::string("columnar_table"), columnNames[2]),
+                              constantValueFactory(ValueFactory::getDoubleValue(300.5))));
+        AbstractExpression *right = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR,
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL,
+                              new TupleValueExpression(3, std::string("columnar_table"), columnNames[3]),
+                              constantValueFactory(ValueFactory::getBigIntValue(4))),
+            comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                              constantValueFactory(ValueFactory::getBigIntValue(10)),
+                              new TupleValueExpression(0, std::string("columnar_table"), columnNames[0])));
+        predicate = conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR, left, right);
+        EXPECT_TRUE(checkColumnarFilter(columnar, predicate, count, true));
+        EXPECT_TRUE(count > 0);
+        EXPECT_TRUE(checkColumnarFilter(columnar, predicate, count, false));
+        delete predicate;
+    }
+
+    delete columnar;
+}
+
 int main() {
     int ret = TestSuite::globalInstance()->runAll();
     FilterTest::releaseAll();// will be eventually done as its smart pointer, but safer is better.
     return ret;
 }
 
+
@@ -0,0 +1,332 @@
+/* Copyright (C) 2013 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "common/executorcontext.hpp"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "common/DummyUndoQuantum.hpp"
+#include "storage/table.h"
+#include "storage/persistenttable.h"
+#include "storage/mmap_persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "indexes/tableindex.h"
+
+using namespace std;
+using namespace voltdb;
+
+class TableCompactionTest : public Test {
+public:
+    TableCompactionTest() {
+        srand(0);
+        m_undo = new DummyUndoQuantum();
+        m_context = new ExecutorContext(0, 0, m_undo, NULL, false, 0, "", 0);
+        m_table = createTable("T");
+    }
+
+    ~TableCompactionTest() {
+        delete m_table;
+        delete m_context;
+        delete m_undo;
+    }
+
+    PersistentTable* createTable(const string &name) {
+        // (ID BIGINT, NAME VARCHAR(64), GRP INTEGER, PAD VARCHAR(60))
+        // NAME is stored outside of the tuple, PAD inside
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        vector<bool> allowNull(4, false);
+        types.push_back(VALUE_TYPE_BIGINT); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        types.push_back(VALUE_TYPE_VARCHAR); lengths.push_back(64);
+        types.push_back(VALUE_TYPE_INTEGER); lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        types.push_back(VALUE_TYPE_VARCHAR); lengths.push_back(60);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+        string columnNames[4] = { "ID", "NAME", "GRP", "PAD" };
+
+        // unique primary key on ID and a non-unique index on GRP
+        vector<int32_t> pkeyColumns(1, 0);
+        vector<ValueType> pkeyTypes(1, VALUE_TYPE_BIGINT);
+        TableIndexScheme pkey("pkey", BALANCED_TREE_INDEX, pkeyColumns, pkeyTypes, true, true, schema);
+        vector<int32_t> grpColumns(1, 2);
+        vector<ValueType> grpTypes(1, VALUE_TYPE_INTEGER);
+        vector<TableIndexScheme> indexes;
+        indexes.push_back(TableIndexScheme("grp", BALANCED_TREE_INDEX, grpColumns, grpTypes, false, true, schema));
+
+        Table *table = TableFactory::getPersistentTable(0, m_context, name, schema, columnNames,
+                                                        pkey, indexes, 0, false, false);
+        return dynamic_cast<PersistentTable*>(table);
+    }
+
+    void insert(int64_t id) {
+        TableTuple &tuple = m_table->tempTuple();
+        tuple.setNValue(0, ValueFactory::getBigIntValue(id));
+        char name[64];
+        snprintf(name, sizeof(name), "a name that does not fit inline #%ld", (long)id);
+        // the temp tuple points to the string until the insert copies it
+        NValue value = ValueFactory::getStringValue(name);
+        tuple.setNValue(1, value);
+        tuple.setNValue(2, ValueFactory::getIntegerValue(static_cast<int32_t>(id % 10)));
+        NValue pad = ValueFactory::getStringValue("padding");
+        tuple.setNValue(3, pad);
+        pad.free();
+        ASSERT_TRUE(m_table->insertTuple(tuple));
+        value.free();
+    }
+
+    /** Delete every tuple whose id is not kept */
+    void deleteAllBut(const set<int64_t> &kept) {
+        TableIterator iter(m_table);
+        TableTuple tuple(m_table->schema());
+        vector<int64_t> ids;
+        while (iter.next(tuple)) {
+            int64_t id = ValuePeeker::peekBigInt(tuple.getNValue(0));
+            if (kept.find(id) == kept.end()) ids.push_back(id);
+        }
+        for (size_t i = 0; i < ids.size(); i++) {
+            TableTuple found = lookup(ids[i]);
+            ASSERT_FALSE(found.isNullTuple());
+            ASSERT_TRUE(m_table->deleteTuple(found, true));
+        }
+    }
+
+    TableTuple lookup(int64_t id) {
+        TableIndex *pkey = m_table->primaryKeyIndex();
+        TableTuple key(pkey->getKeySchema());
+        char buffer[64];
+        key.move(buffer);
+        key.setNValue(0, ValueFactory::getBigIntValue(id));
+        if (pkey->moveToKey(&key) == false) return TableTuple();
+        return pkey->nextValueAtKey();
+    }
+
+    /** The table holds exactly the kept tuples and both indexes find them */
+    void checkTuples(const set<int64_t> &kept) {
+        ASSERT_EQ(kept.size(), m_table->activeTupleCount());
+        ASSERT_EQ(kept.size(), m_table->primaryKeyIndex()->getSize());
+        TableIndex *grp = m_table->index("grp");
+        ASSERT_EQ(kept.size(), grp->getSize());
+
+        set<int64_t> seen;
+        TableIterator iter(m_table);
+        TableTuple tuple(m_table->schema());
+        while (iter.next(tuple)) {
+            int64_t id = ValuePeeker::peekBigInt(tuple.getNValue(0));
+            ASSERT_TRUE(kept.find(id) != kept.end());
+            ASSERT_TRUE(seen.insert(id).second);
+            ASSERT_EQ(tuple.address(), lookup(id).address());
+            char name[64];
+            snprintf(name, sizeof(name), "a name that does not fit inline #%ld", (long)id);
+            NValue value = ValueFactory::getStringValue(name);
+            ASSERT_EQ(0, value.compare(tuple.getNValue(1)));
+            value.free();
+
+            // the non-unique index has an entry for this address
+            ASSERT_TRUE(grp->moveToTuple(&tuple));
+            bool found = false;
+            TableTuple entry;
+            while (!(entry = grp->nextValueAtKey()).isNullTuple()) {
+                found = found || (entry.address() == tuple.address());
+            }
+            ASSERT_TRUE(found);
+        }
+        ASSERT_EQ(kept.size(), seen.size());
+    }
+
+    UndoQuantum *m_undo;
+    ExecutorContext *m_context;
+    PersistentTable *m_table;
+};
+
+/**
+ * After a purge the tuples left at the end of the table move into the
+ * free slots and the empty blocks are released
+ */
+TEST_F(TableCompactionTest, ReleasesBlocks) {
+    const int64_t rows = 200000;
+    for (int64_t id = 0; id < rows; id++) {
+        insert(id);
+    }
+    const int blocks = m_table->blockCount();
+    ASSERT_TRUE(blocks > 4);
+
+    // keep one tuple in twenty
+    set<int64_t> kept;
+    for (int64_t id = 0; id < rows; id += 20) {
+        kept.insert(id);
+    }
+    deleteAllBut(kept);
+    ASSERT_EQ(rows - kept.size(), m_table->freeTupleSlotCount());
+    ASSERT_EQ(blocks, m_table->blockCount());
+
+    ASSERT_TRUE(m_table->compactTuples(INT64_MAX) > 0);
+    checkTuples(kept);
+    const int needed = static_cast<int>((kept.size() + m_table->tuplesPerBlock() - 1) / m_table->tuplesPerBlock());
+    ASSERT_EQ(needed, m_table->blockCount());
+    ASSERT_EQ(blocks - needed, m_table->getBlocksReleased());
+    ASSERT_TRUE(m_table->freeTupleSlotCount() < m_table->tuplesPerBlock());
+
+    // nothing left to do
+    ASSERT_EQ(0, m_table->compactTuples(INT64_MAX));
+
+    // the table keeps working
+    for (int64_t id = rows; id < rows + 5000; id++) {
+        insert(id);
+        kept.insert(id);
+    }
+    checkTuples(kept);
+}
+
+/**
+ * A small budget compacts the table over several calls, and deletes in
+ * between add new free slots
+ */
+TEST_F(TableCompactionTest, Incremental) {
+    const int64_t rows = 60000;
+    for (int64_t id = 0; id < rows; id++) {
+        insert(id);
+    }
+    set<int64_t> kept;
+    for (int64_t id = 0; id < rows; id++) {
+        if (rand() % 4 == 0) kept.insert(id);
+    }
+    deleteAllBut(kept);
+
+    const int64_t budget = 64 * 1024;
+    int calls = 0;
+    int64_t moved;
+    while ((moved = m_table->compactTuples(budget)) > 0) {
+        ASSERT_TRUE(moved <= budget);
+        checkTuples(kept);
+        calls++;
+
+        // delete a few more tuples along the way
+        if (calls % 3 == 0 && kept.size() > 100) {
+            set<int64_t> fewer;
+            int i = 0;
+            for (set<int64_t>::iterator iter = kept.begin(); iter != kept.end(); iter++) {
+                if (i++ % 10 != 0) fewer.insert(*iter);
+            }
+            deleteAllBut(fewer);
+            kept = fewer;
+        }
+    }
+    ASSERT_TRUE(calls > 1);
+    checkTuples(kept);
+    ASSERT_TRUE(m_table->freeTupleSlotCount() < m_table->tuplesPerBlock());
+    // the free slots left over may still span one extra block
+    const int needed = static_cast<int>((kept.size() + m_table->tuplesPerBlock() - 1) / m_table->tuplesPerBlock());
+    ASSERT_TRUE(m_table->blockCount() <= needed + 1);
+    ASSERT_TRUE(m_table->getBlocksReleased() > 0);
+}
+
+/**
+ * Deleting everything gives back every block
+ */
+TEST_F(TableCompactionTest, EmptyTable) {
+    for (int64_t id = 0; id < 30000; id++) {
+        insert(id);
+    }
+    deleteAllBut(set<int64_t>());
+    ASSERT_EQ(0, m_table->compactTuples(INT64_MAX));
+    ASSERT_EQ(0, m_table->blockCount());
+    ASSERT_EQ(0, m_table->freeTupleSlotCount());
+
+    set<int64_t> kept;
+    for (int64_t id = 0; id < 100; id++) {
+        insert(id);
+        kept.insert(id);
+    }
+    checkTuples(kept);
+}
+
+#ifdef STORAGE_MMAP
+/**
+ * The blocks of an MMAP table are carved out of its mapped file and cannot
+ * be given back, so its tuples stay where they are
+ */
+TEST_F(TableCompactionTest, MMAPTable) {
+    delete m_table;
+    string dir("/tmp");
+    m_context->enableMMAP(dir, 256 * 1024 * 1024, 0);
+    m_table = createTable("T_COMPACTION");
+    ASSERT_TRUE(dynamic_cast<MMAP_PersistentTable*>(m_table) != NULL);
+
+    const int64_t rows = 60000;
+    for (int64_t id = 0; id < rows; id++) {
+        insert(id);
+    }
+    const int blocks = m_table->blockCount();
+    set<int64_t> kept;
+    for (int64_t id = 0; id < rows; id += 20) {
+        kept.insert(id);
+    }
+    deleteAllBut(kept);
+
+    ASSERT_EQ(0, m_table->compactTuples(INT64_MAX));
+    ASSERT_EQ(blocks, m_table->blockCount());
+    ASSERT_EQ(0, m_table->getBlocksReleased());
+    checkTuples(kept);
+}
+#endif
+
+#ifdef ANTICACHE_CLOCK
+/**
+ * A tuple that moves keeps its CLOCK reference bit
+ */
+TEST_F(TableCompactionTest, MovesReferenceBits) {
+    const int64_t rows = 60000;
+    for (int64_t id = 0; id < rows; id++) {
+        insert(id);
+    }
+    set<int64_t> kept;
+    for (int64_t id = 0; id < rows; id += 20) {
+        kept.insert(id);
+        if (id % 40 == 0) {
+            m_table->setReferenced(m_table->getTupleID(lookup(id).address()));
+        }
+    }
+    deleteAllBut(kept);
+
+    ASSERT_TRUE(m_table->compactTuples(INT64_MAX) > 0);
+    checkTuples(kept);
+    for (set<int64_t>::iterator iter = kept.begin(); iter != kept.end(); iter++) {
+        int tupleId = m_table->getTupleID(lookup(*iter).address());
+        ASSERT_EQ(*iter % 40 == 0, m_table->isReferenced(tupleId));
+    }
+}
+#endif
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -260,6 +260,41 @@ TEST_F(TableTest, TupleUpdate) {
     }
 
 }
+
+TEST_F(TableTest, TupleID) {
+    //
+    // Tuples come out of the iterator in storage order, so the position of
+    // each tuple in the scan should be the same as its tuple id
+    //
+    voltdb::TableIterator iterator = this->table->tableIterator();
+    voltdb::TableTuple tuple(table->schema());
+    int expected_id = 0;
+    while (iterator.next(tuple)) {
+        ASSERT_EQ(expected_id, this->table->getTupleID(tuple.address()));
+        expected_id++;
+    }
+    ASSERT_EQ(NUM_OF_TUPLES, expected_id);
+
+    //
+    // Addresses that are not the start of one of our tuples
+    //
+    char other[64];
+    EXPECT_EQ(-1, this->table->getTupleID(other));
+    iterator = this->table->tableIterator();
+    ASSERT_TRUE(iterator.next(tuple));
+    EXPECT_EQ(-1, this->table->getTupleID(tuple.address() + 1));
+
+    //
+    // Blocks released by deleteAllTuples() must drop out of the directory
+    //
+    voltdb::TableTuple last(table->schema());
+    iterator = this->table->tableIterator();
+    while (iterator.next(tuple)) {
+        last.move(tuple.address());
+    }
+    this->table->deleteAllTuples(true);
+    EXPECT_EQ(-1, this->table->getTupleID(last.address()));
+}
 /* deleteTuple in TempTable is not supported for performance reason.
 TEST_F(TableTest, TupleDelete) {
     //
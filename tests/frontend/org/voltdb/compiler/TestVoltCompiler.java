@@ -101,6 +101,53 @@ public class TestVoltCompiler extends BaseTestCase {
         }
     }
 
+    public void testColumnarTables() throws IOException {
+        String schemaPath = "";
+        try {
+            final URL url = TPCCClient.class.getResource("tpcc-ddl.sql");
+            schemaPath = URLDecoder.decode(url.getPath(), "UTF-8");
+        } catch (final UnsupportedEncodingException e) {
+            e.printStackTrace();
+            System.exit(-1);
+        }
+
+        VoltProjectBuilder builder = new VoltProjectBuilder("testvoltcompiler");
+
+        builder.addProcedures(org.voltdb.compiler.procedures.TPCCTestProc.class);
+        builder.addSchema(schemaPath);
+        builder.markTableColumnar("stock");
+        try {
+            assertTrue(builder.compile("/tmp/columnar_tables_test.jar"));
+            final String catalogContents =
+                JarReader.readFileFromJarfile("/tmp/columnar_tables_test.jar", "catalog.txt");
+
+            // This is what the EE gets in loadCatalog()
+            final Catalog cat = new Catalog();
+            cat.execute(catalogContents);
+            final Database db = cat.getClusters().get("cluster").getDatabases().get("database");
+            final Table stock = db.getTables().get("STOCK");
+            assertTrue(stock.getColumnar());
+            assertTrue(catalogContents.contains("set " + stock.getPath() + " columnar true"));
+            for (Table catalog_tbl : db.getTables()) {
+                if (catalog_tbl != stock) assertFalse(catalog_tbl.getName(), catalog_tbl.getColumnar());
+            } // FOR
+        } finally {
+            final File jar = new File("/tmp/columnar_tables_test.jar");
+            jar.delete();
+        }
+
+        builder = new VoltProjectBuilder("testvoltcompiler");
+        builder.addProcedures(org.voltdb.compiler.procedures.TPCCTestProc.class);
+        builder.addSchema(schemaPath);
+        builder.markTableColumnar("nonsense");
+        try {
+            assertFalse(builder.compile("/tmp/columnar_tables_test.jar"));
+        } finally {
+            final File jar = new File("/tmp/columnar_tables_test.jar");
+            jar.delete();
+        }
+    }
+
     // TestELTSuite tests most of these options end-to-end; however need to test
     // that a disabled connector is really disabled and that auth data is correct.
     public void testELTSetting() throws IOException {